@@ -21,6 +21,7 @@
  */
 
 #include "gstCamera.h"
+#include "gstPipelineManager.h"
 
 #include "cudaColorspace.h"
 #include "filesystem.h"
@@ -44,6 +45,8 @@ gstCamera::gstCamera( const videoOptions& options ) : videoSource(options)
 	mFormatYUV = IMAGE_UNKNOWN;
 	
 	mBufferManager = new gstBufferManager(&mOptions);
+
+	initReadyFD();
 }
 
 
@@ -66,6 +69,7 @@ gstCamera::~gstCamera()
 
 	if( mPipeline != NULL )
 	{
+		gstPipelineManager::Unregister(mPipeline);
 		gst_object_unref(mPipeline);
 		mPipeline = NULL;
 	}
@@ -599,8 +603,12 @@ bool gstCamera::init()
 		return false;
 	}
 
-	// add watch for messages (disabled when we poll the bus ourselves, instead of gmainloop)
-	//gst_bus_add_watch(mBus, (GstBusFunc)gst_message_print, NULL);
+	// dispatch the bus messages from the shared pipeline manager thread
+	if( !gstPipelineManager::Register(mPipeline, mOptions.resource.string.c_str()) )
+	{
+		LogError(LOG_GSTREAMER "gstCamera failed to register pipeline with gstPipelineManager\n");
+		return false;
+	}
 
 	// get the appsrc
 	GstElement* appsinkElement = gst_bin_get_by_name(GST_BIN(pipeline), "mysink");
@@ -655,7 +663,6 @@ GstFlowReturn gstCamera::onBuffer(_GstAppSink* sink, void* user_data)
 	gstCamera* dec = (gstCamera*)user_data;
 	
 	dec->checkBuffer();
-	dec->checkMsgBus();
 	
 	return GST_FLOW_OK;
 }
@@ -704,6 +711,7 @@ void gstCamera::checkBuffer()
 	}
 	
 	mOptions.frameCount++;
+	notifyReady();
 	release_return;
 }
 
@@ -735,7 +743,9 @@ bool gstCamera::Capture( void** output, imageFormat format, uint64_t timeout, in
 	}
 	else if( result == 0 )
 	{
-		LogWarning(LOG_GSTREAMER "gstCamera::Capture() -- a timeout occurred waiting for the next image buffer\n");
+		if( timeout > 0 )	// polling with a timeout of 0 is expected to come up empty
+			LogWarning(LOG_GSTREAMER "gstCamera::Capture() -- a timeout occurred waiting for the next image buffer\n");
+
 		RETURN_STATUS(TIMEOUT);
 	}
 
@@ -759,6 +769,8 @@ bool gstCamera::Open()
 	if( mStreaming )
 		return true;
 
+	const timespec openStart = timestamp();
+
 	// transition pipline to STATE_PLAYING
 	LogInfo(LOG_GSTREAMER "opening gstCamera for streaming, transitioning pipeline to GST_STATE_PLAYING\n");
 	
@@ -785,9 +797,11 @@ bool gstCamera::Open()
 		return false;
 	}
 
-	checkMsgBus();
-	usleep(100*1000);
-	checkMsgBus();
+	// wait for the pipeline to finish the state change (instead of always sleeping for 100ms)
+	gst_element_get_state(mPipeline, NULL, NULL, 100 * GST_MSECOND);
+
+	gst_startup_phase(GST_STARTUP_PREROLL, openStart);
+	gst_startup_report();
 
 	mStreaming = true;
 	return true;
@@ -808,23 +822,7 @@ void gstCamera::Close()
 		LogError(LOG_GSTREAMER "gstCamera failed to set pipeline state to PLAYING (error %u)\n", result);
 
 	usleep(250*1000);	
-	checkMsgBus();
 	mStreaming = false;
 	LogInfo(LOG_GSTREAMER "gstCamera -- pipeline stopped\n");
 }
 
-// checkMsgBus
-void gstCamera::checkMsgBus()
-{
-	while(true)
-	{
-		GstMessage* msg = gst_bus_pop(mBus);
-
-		if( !msg )
-			break;
-
-		gst_message_print(mBus, msg, this);
-		gst_message_unref(msg);
-	}
-}
-
@@ -209,7 +209,6 @@ private:
 	bool discover();
 	bool buildLaunchStr();
 
-	void checkMsgBus();
 	void checkBuffer();
 	
 	bool matchCaps( GstCaps* caps );
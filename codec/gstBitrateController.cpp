@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gstBitrateController.h"
+#include "gstEncoder.h"
+
+#include "timespec.h"
+#include "logging.h"
+
+#include <string.h>
+
+
+// constructor
+gstBitrateController::gstBitrateController( gstEncoder* encoder, uint32_t minBitRate, uint32_t maxBitRate )
+{
+	mEncoder       = encoder;
+	mMinBitRate    = minBitRate;
+	mMaxBitRate    = maxBitRate;
+	mLastUpdate    = 0;
+	mBaseRoundTrip = 0.0f;
+
+	memset(&mStats, 0, sizeof(gstReceiverStats));
+
+	const std::string labels = Metrics::Label("uri", encoder->GetResource().string.c_str());
+
+	mBitRateMetric    = Metrics::Gauge("jetson_encoder_bitrate_target", "Bitrate that the encoder is set to (in bits per second)", labels.c_str());
+	mPacketLossMetric = Metrics::Gauge("jetson_encoder_bitrate_packet_loss", "Worst fraction of packets lost reported by the receivers", labels.c_str());
+	mRoundTripMetric  = Metrics::Gauge("jetson_encoder_bitrate_round_trip_seconds", "Worst round-trip time reported by the receivers", labels.c_str());
+	mIncreaseMetric   = Metrics::Counter("jetson_encoder_bitrate_increases_total", "Number of times the bitrate was raised", labels.c_str());
+	mDecreaseMetric   = Metrics::Counter("jetson_encoder_bitrate_decreases_total", "Number of times the bitrate was lowered", labels.c_str());
+
+	mBitRateMetric->Set(encoder->GetBitRate());
+
+	LogVerbose(LOG_GSTREAMER "gstEncoder -- adapting bitrate between %u and %u bps\n", minBitRate, maxBitRate);
+}
+
+
+// destructor
+gstBitrateController::~gstBitrateController()
+{
+	Metrics::Release(mBitRateMetric);
+	Metrics::Release(mPacketLossMetric);
+	Metrics::Release(mRoundTripMetric);
+	Metrics::Release(mIncreaseMetric);
+	Metrics::Release(mDecreaseMetric);
+}
+
+
+// Update
+bool gstBitrateController::Update()
+{
+	const uint64_t now = apptime_nano();
+
+	if( mLastUpdate != 0 && (now - mLastUpdate) < Interval )
+		return false;
+
+	mLastUpdate = now;
+
+	// keep the current bitrate while nobody is reporting
+	if( !QueryStats(GST_ELEMENT(mEncoder->GetPipeline()), &mStats) )
+		return false;
+
+	mPacketLossMetric->Set(mStats.packetLoss);
+	mRoundTripMetric->Set(mStats.roundTrip / 1000.0);
+
+	// the base round-trip time follows the lowest one, and slowly rises
+	// so that a lasting change in the network path is eventually accepted
+	if( mBaseRoundTrip <= 0.0f || mStats.roundTrip < mBaseRoundTrip )
+		mBaseRoundTrip = mStats.roundTrip;
+	else
+		mBaseRoundTrip += (mStats.roundTrip - mBaseRoundTrip) * 0.02f;
+
+	const bool roundTripRising = (mBaseRoundTrip > 0.0f) && (mStats.roundTrip > mBaseRoundTrip * 1.5f + 20.0f);
+
+	const uint32_t prevBitRate = mEncoder->GetBitRate();
+	float bitRate = prevBitRate;
+
+	if( mStats.packetLoss > 0.1f )
+		bitRate *= 1.0f - 0.5f * mStats.packetLoss;
+	else if( roundTripRising )
+		bitRate *= 0.85f;
+	else if( mStats.packetLoss < 0.02f )
+		bitRate *= 1.08f;
+
+	if( bitRate < mMinBitRate )
+		bitRate = mMinBitRate;
+	else if( bitRate > mMaxBitRate )
+		bitRate = mMaxBitRate;
+
+	const uint32_t newBitRate = (uint32_t)bitRate;
+
+	if( newBitRate == prevBitRate )
+		return false;
+
+	if( !mEncoder->SetBitRate(newBitRate) )
+		return false;
+
+	LogVerbose(LOG_GSTREAMER "gstEncoder -- %s bitrate from %u to %u bps (packet loss %.1f%%, round-trip %.1f ms, %u receivers)\n",
+			 (newBitRate > prevBitRate) ? "raised" : "lowered", prevBitRate, newBitRate,
+			 mStats.packetLoss * 100.0f, mStats.roundTrip, mStats.receivers);
+
+	if( newBitRate > prevBitRate )
+		mIncreaseMetric->Increment();
+	else
+		mDecreaseMetric->Increment();
+
+	mBitRateMetric->Set(newBitRate);
+	return true;
+}
+
+
+// readSessionStats
+static void readSessionStats( GstElement* session, gstReceiverStats* stats )
+{
+	GstStructure* sessionStats = NULL;
+	g_object_get(session, "stats", &sessionStats, NULL);
+
+	if( !sessionStats )
+		return;
+
+	// the report blocks from the receivers are kept with each source in the session
+	const GValue* sources = gst_structure_get_value(sessionStats, "source-stats");
+
+G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+	if( sources != NULL && G_VALUE_HOLDS(sources, G_TYPE_VALUE_ARRAY) )
+	{
+		GValueArray* array = (GValueArray*)g_value_get_boxed(sources);
+
+		for( guint n=0; array != NULL && n < array->n_values; n++ )
+		{
+			const GstStructure* source = gst_value_get_structure(g_value_array_get_nth(array, n));
+			gboolean haveRB = FALSE;
+
+			if( !source || !gst_structure_get_boolean(source, "have-rb", &haveRB) || !haveRB )
+				continue;
+
+			guint fractionLost = 0;	// fixed-point 8-bit fraction
+			guint roundTrip = 0;	// 1/65536 of a second
+
+			gst_structure_get_uint(source, "rb-fractionlost", &fractionLost);
+			gst_structure_get_uint(source, "rb-round-trip", &roundTrip);
+
+			const float packetLoss = fractionLost / 256.0f;
+			const float roundTripMs = roundTrip * 1000.0f / 65536.0f;
+
+			if( packetLoss > stats->packetLoss )
+				stats->packetLoss = packetLoss;
+
+			if( roundTripMs > stats->roundTrip )
+				stats->roundTrip = roundTripMs;
+
+			stats->receivers++;
+		}
+	}
+G_GNUC_END_IGNORE_DEPRECATIONS
+
+	gst_structure_free(sessionStats);
+}
+
+
+// QueryStats
+bool gstBitrateController::QueryStats( GstElement* pipeline, gstReceiverStats* stats )
+{
+	if( !pipeline || !stats )
+		return false;
+
+	memset(stats, 0, sizeof(gstReceiverStats));
+
+	// the RTSP server adds the pipeline to the media's pipeline, which holds the rtpbin
+	GstObject* top = GST_OBJECT(gst_object_ref(pipeline));
+
+	while( true )
+	{
+		GstObject* parent = gst_object_get_parent(top);
+
+		if( !parent )
+			break;
+
+		gst_object_unref(top);
+		top = parent;
+	}
+
+	if( !GST_IS_BIN(top) )
+	{
+		gst_object_unref(top);
+		return false;
+	}
+
+	// find the rtpsession elements (inside of rtpbin and webrtcbin)
+	GstIterator* iter = gst_bin_iterate_recurse(GST_BIN(top));
+	GValue item = G_VALUE_INIT;
+	bool done = false;
+
+	while( !done )
+	{
+		switch( gst_iterator_next(iter, &item) )
+		{
+			case GST_ITERATOR_OK:
+			{
+				GstElement* element = GST_ELEMENT(g_value_get_object(&item));
+				GstElementFactory* factory = gst_element_get_factory(element);
+
+				if( factory != NULL && strcmp(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), "rtpsession") == 0 )
+					readSessionStats(element, stats);
+
+				g_value_reset(&item);
+				break;
+			}
+			case GST_ITERATOR_RESYNC:
+			{
+				// the elements changed (like a WebRTC peer connecting), so start over
+				gst_iterator_resync(iter);
+				memset(stats, 0, sizeof(gstReceiverStats));
+				break;
+			}
+			default:
+				done = true;
+				break;
+		}
+	}
+
+	g_value_unset(&item);
+	gst_iterator_free(iter);
+	gst_object_unref(top);
+
+	return (stats->receivers > 0);
+}
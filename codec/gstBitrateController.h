@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __GSTREAMER_BITRATE_CONTROLLER_H__
+#define __GSTREAMER_BITRATE_CONTROLLER_H__
+
+#include "gstUtility.h"
+#include "metrics.h"
+
+
+// Forward declarations
+class gstEncoder;
+
+
+/**
+ * Receiver statistics gathered from the RTCP receiver reports of a pipeline.
+ * @ingroup codec
+ */
+struct gstReceiverStats
+{
+	uint32_t receivers;	/**< Number of receivers that have sent a report */
+	float    packetLoss;	/**< Worst fraction of packets lost since the previous report (between 0 and 1) */
+	float    roundTrip;	/**< Worst round-trip time (in milliseconds) */
+};
+
+
+/**
+ * Adapts the bitrate of a gstEncoder to the network conditions reported by its clients.
+ *
+ * The RTCP receiver reports are read from the `rtpsession` elements of the pipeline, which
+ * both `webrtcbin` (one per WebRTC peer) and the RTSP server media contain.  The worst packet
+ * loss and round-trip time across all the receivers are used:
+ *
+ *   - the bitrate is lowered if the packet loss is over 10% or the round-trip time is rising
+ *   - the bitrate is raised by 8% if the packet loss is under 2% and the round-trip time is steady
+ *   - otherwise the bitrate is kept the same
+ *
+ * The bitrate always stays between the minimum and the maximum (the bitrate the encoder
+ * was configured with), and it's only changed when there are receivers reporting.
+ * It's applied with gstEncoder::SetBitRate(), so the pipeline isn't restarted.
+ * The decisions are exported as `jetson_encoder_bitrate_*` metrics, labeled by the encoder URI.
+ *
+ * The controller is created by gstEncoder when videoOptions::minBitRate is set (`--min-bitrate=N`),
+ * and it's updated from gstEncoder::Render(), so it runs on the same thread as the encoder.
+ *
+ * @ingroup codec
+ */
+class gstBitrateController
+{
+public:
+	/**
+	 * Create a controller for an encoder.
+	 * @param encoder the encoder that gets its bitrate set.
+	 * @param minBitRate the lowest bitrate that's used (in bits per second).
+	 * @param maxBitRate the highest bitrate that's used (in bits per second).
+	 */
+	gstBitrateController( gstEncoder* encoder, uint32_t minBitRate, uint32_t maxBitRate );
+
+	/**
+	 * Destructor
+	 */
+	~gstBitrateController();
+
+	/**
+	 * Read the receiver statistics and adjust the bitrate, at most once per Interval.
+	 * @returns true if the bitrate was changed.
+	 */
+	bool Update();
+
+	/**
+	 * Return the receiver statistics from the last update.
+	 */
+	inline const gstReceiverStats& GetStats() const	{ return mStats; }
+
+	/**
+	 * Read the RTCP receiver statistics from all of the `rtpsession` elements in a pipeline.
+	 * This also looks in the bins that contain the pipeline (like the RTSP server media).
+	 * @returns false if none of the receivers have sent a report.
+	 */
+	static bool QueryStats( GstElement* pipeline, gstReceiverStats* stats );
+
+	/**
+	 * How often the bitrate gets adjusted (in nanoseconds).
+	 */
+	static const uint64_t Interval = 1000000000;
+
+protected:
+	gstEncoder* mEncoder;
+
+	uint32_t mMinBitRate;
+	uint32_t mMaxBitRate;
+	uint64_t mLastUpdate;
+	float    mBaseRoundTrip;	// lowest round-trip time seen (in milliseconds)
+
+	gstReceiverStats mStats;
+
+	MetricGauge*   mBitRateMetric;
+	MetricGauge*   mPacketLossMetric;
+	MetricGauge*   mRoundTripMetric;
+	MetricCounter* mIncreaseMetric;
+	MetricCounter* mDecreaseMetric;
+};
+
+#endif
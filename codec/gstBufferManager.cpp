@@ -55,13 +55,26 @@ gstBufferManager::gstBufferManager( videoOptions* options )
 #endif
 	
 	mBufferRGB.SetThreaded(false);
+
+	// report the frame flow for this stream
+	const std::string labels = Metrics::Label("uri", mOptions->resource.string.c_str());
+
+	mReceivedMetric  = Metrics::Counter("jetson_buffer_frames_received_total", "Number of frames received from the GStreamer pipeline", labels.c_str());
+	mDeliveredMetric = Metrics::Counter("jetson_buffer_frames_delivered_total", "Number of frames returned to the application", labels.c_str());
+	mTimeoutMetric   = Metrics::Counter("jetson_buffer_timeouts_total", "Number of times the application timed out waiting for a frame", labels.c_str());
+	mWaitMetric      = Metrics::Histogram("jetson_buffer_wait_seconds", "Time the application waited for a new frame", labels.c_str());
+
+	mBufferYUV.EnableMetrics((labels + "," + Metrics::Label("ring", "yuv")).c_str());
 }
 
 
 // destructor
 gstBufferManager::~gstBufferManager()
 {
-	
+	Metrics::Release(mReceivedMetric);
+	Metrics::Release(mDeliveredMetric);
+	Metrics::Release(mTimeoutMetric);
+	Metrics::Release(mWaitMetric);
 }
 
 
@@ -137,6 +150,16 @@ bool gstBufferManager::Enqueue( GstBuffer* gstBuffer, GstCaps* gstCaps )
 	mOptions->width = width;
 	mOptions->height = height;
 
+	// fill in the framerate if it wasn't known before the pipeline started (e.g. discovery was skipped)
+	if( mOptions->frameRate == 0 )
+	{
+		int framerate_num   = 0;
+		int framerate_denom = 0;
+
+		if( gst_structure_get_fraction(gstCapsStruct, "framerate", &framerate_num, &framerate_denom) && framerate_num > 0 && framerate_denom > 0 )
+			mOptions->frameRate = float(framerate_num) / float(framerate_denom);
+	}
+
 	// verify format 
 	if( mFrameCount == 0 )
 	{
@@ -286,6 +309,7 @@ bool gstBufferManager::Enqueue( GstBuffer* gstBuffer, GstCaps* gstCaps )
 
 	mWaitEvent.Wake();
 	mFrameCount++;
+	mReceivedMetric->Increment();
 	
 #if GST_CHECK_VERSION(1,0,0)
 	gst_buffer_unmap(gstBuffer, &map);
@@ -295,12 +319,47 @@ bool gstBufferManager::Enqueue( GstBuffer* gstBuffer, GstCaps* gstCaps )
 }
 
 
+// Flush
+void gstBufferManager::Flush()
+{
+	// Dequeue() only reads the latest buffer after the event is raised
+	mWaitEvent.Reset();
+
+#ifdef ENABLE_NVMM
+	mNvmmMutex.Lock();
+	
+	if( mNvmmEGL != NULL )
+	{
+		NvDestroyEGLImage(NULL, mNvmmEGL);
+		
+		if( mNvmmReleaseFD )
+			NvReleaseFd(mNvmmFD);
+	}
+	
+	mNvmmFD = -1;
+	mNvmmEGL = NULL;
+	mNvmmReleaseFD = false;
+	
+	mNvmmMutex.Unlock();
+#endif
+}
+
+
 // Dequeue
 int gstBufferManager::Dequeue( void** output, imageFormat format, uint64_t timeout, cudaStream_t stream )
 {
 	// wait until a new frame is recieved
+	const timespec waitStart = timestamp();
+
 	if( !mWaitEvent.Wait(timeout) )
+	{
+		if( timeout > 0 )
+			mTimeoutMetric->Increment();
+
 		return 0;
+	}
+
+	mWaitMetric->ObserveSince(waitStart);
 
 	void* latestYUV = NULL;
 	
@@ -427,6 +486,7 @@ int gstBufferManager::Dequeue( void** output, imageFormat format, uint64_t timeo
 	if ( format == IMAGE_UNKNOWN )
 	{
 		*output = latestYUV;
+		mDeliveredMetric->Increment();
 		return 1;
 	}
 
@@ -455,6 +515,7 @@ int gstBufferManager::Dequeue( void** output, imageFormat format, uint64_t timeo
 	}
 
 	*output = nextRGB;
+	mDeliveredMetric->Increment();
 	return 1;
 }
 
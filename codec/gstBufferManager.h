@@ -29,6 +29,7 @@
 #include "Event.h"
 #include "Mutex.h"
 #include "RingBuffer.h"
+#include "metrics.h"
 
 
 #ifdef ENABLE_NVMM
@@ -81,6 +82,12 @@ public:
 	 */
 	int Dequeue( void** output, imageFormat format, uint64_t timeout=UINT64_MAX, cudaStream_t stream=0 );
 
+	/**
+	 * Discard the frames that have been recieved but not yet dequeued (i.e. after seeking),
+	 * so that the next call to Dequeue() waits for a new frame.
+	 */
+	void Flush();
+
 	/**
 	 * Get timestamp of the latest dequeued frame.
 	 */
@@ -108,6 +115,11 @@ protected:
 	videoOptions* mOptions;    /**< Options of the gstDecoder / gstCamera object */			
 	uint64_t	  mFrameCount; /**< Total number of frames that have been recieved */
 	bool 	      mNvmmUsed;   /**< Is NVMM memory actually used by the stream? */
+
+	MetricCounter*   mReceivedMetric;  /**< Number of frames recieved from appsink */
+	MetricCounter*   mDeliveredMetric; /**< Number of frames returned from Dequeue() */
+	MetricCounter*   mTimeoutMetric;   /**< Number of times Dequeue() timed out */
+	MetricHistogram* mWaitMetric;      /**< Time spent waiting in Dequeue() for new frames */
 	
 #ifdef ENABLE_NVMM
 	Mutex  mNvmmMutex;
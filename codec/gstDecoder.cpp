@@ -21,17 +21,25 @@
  */
 
 #include "gstDecoder.h"
+#include "gstPipelineManager.h"
 #include "gstWebRTC.h"
 
 #include "cudaColorspace.h"
 #include "filesystem.h"
+#include "timespec.h"
 #include "logging.h"
+#include "Mutex.h"
 
 #include <gst/app/gstappsink.h>
 #include <gst/pbutils/pbutils.h>
 
+#include <map>
 #include <sstream>
+#include <algorithm>
+#include <fcntl.h>
+#include <limits.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <string.h>
 #include <strings.h>
 
@@ -100,9 +108,23 @@ gstDecoder::gstDecoder( const videoOptions& options ) : videoSource(options)
 	mCustomRate = false;
 	mEOS        = false;
 	mLoopCount  = 1;
+	mDuration   = 0;
+	mPosition   = 0;
+	mOpenFrames = 0;
+	mOpenTime   = timeZero();
+	
+	mGopLength   = 0;
+	mGopFrames   = 0;
+	mGopCounting = false;
+	mStrideNext  = 0;
+	
+	mSeekFlushing = false;
+	mSeekTarget   = 0;
 	
 	mBufferManager = new gstBufferManager(&mOptions);
 	
+	initReadyFD();
+
 	mWebRTCServer = NULL;
 	mWebRTCConnected = false;
 }
@@ -142,6 +164,7 @@ void gstDecoder::destroyPipeline()
 
 	if( mPipeline != NULL )
 	{
+		gstPipelineManager::Unregister(mPipeline);
 		gst_element_set_state(mPipeline, GST_STATE_NULL);
 		gst_object_unref(mPipeline);
 		mPipeline = NULL;
@@ -213,6 +236,8 @@ bool gstDecoder::init()
 		mCustomRate = true;
 
 	// discover resource stats
+	const timespec startTime = timestamp();
+	
 	if( !discover() )
 	{
 		if( mOptions.resource.protocol == "rtp" || mOptions.resource.protocol == "webrtc" )
@@ -235,6 +260,14 @@ bool gstDecoder::init()
 		}
 	}
 	
+	const timespec discoverTime = timestamp();
+	
+	if( mOptions.stride > 1 && mOptions.resource.protocol != "file" )
+	{
+		LogWarning(LOG_GSTREAMER "gstDecoder -- --input-stride is only supported for video files, ignoring it for %s\n", mOptions.resource.protocol.c_str());
+		mOptions.stride = 1;
+	}
+	
 	// build pipeline string
 	if( !buildLaunchStr() )
 	{
@@ -249,6 +282,12 @@ bool gstDecoder::init()
 		return false;
 	}
 	
+	const timespec pipelineTime = timestamp();
+	
+	LogInfo(LOG_GSTREAMER "gstDecoder -- startup took %.2f ms (discovery %.2f ms, pipeline %.2f ms)\n", 
+		   timeDouble(timeDiff(startTime, pipelineTime)), timeDouble(timeDiff(startTime, discoverTime)), 
+		   timeDouble(timeDiff(discoverTime, pipelineTime)));
+	
 	// create server for WebRTC streams
 	if( mOptions.resource.protocol == "webrtc" )
 	{
@@ -297,8 +336,12 @@ bool gstDecoder::initPipeline()
 		return false;
 	}
 
-	// add watch for messages (disabled when we poll the bus ourselves, instead of gmainloop)
-	//gst_bus_add_watch(mBus, (GstBusFunc)gst_message_print, NULL);
+	// dispatch the bus messages from the shared pipeline manager thread
+	if( !gstPipelineManager::Register(mPipeline, mOptions.resource.string.c_str()) )
+	{
+		LogError(LOG_GSTREAMER "gstDecoder -- failed to register pipeline with gstPipelineManager\n");
+		return false;
+	}
 
 	// get the appsrc
 	GstElement* appsinkElement = gst_bin_get_by_name(GST_BIN(pipeline), "mysink");
@@ -325,6 +368,52 @@ bool gstDecoder::initPipeline()
 #endif
 	
 	gst_app_sink_set_callbacks(mAppSink, &cb, (void*)this, NULL);
+	
+	// probe the appsink's input for the flushes from seeking
+	GstPad* sinkPad = gst_element_get_static_pad(appsinkElement, "sink");
+	
+	if( sinkPad != NULL )
+	{
+		gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_EVENT_FLUSH, onFlushProbe, this, NULL);
+		gst_object_unref(sinkPad);
+	}
+	
+	// probe the decoder's input to track (or filter) keyframes
+	GstElement* decoder = gst_bin_get_by_name(GST_BIN(pipeline), "decoder");
+	
+	if( decoder != NULL )
+	{
+		GstPad* pad = gst_element_get_static_pad(decoder, "sink");
+		
+		if( pad != NULL )
+		{
+			gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, onDecoderProbe, this, NULL);
+			gst_object_unref(pad);
+		}
+		
+		// drop the frames in between the stride before they get converted
+		if( mOptions.stride > 1 )
+		{
+			pad = gst_element_get_static_pad(decoder, "src");
+		
+			if( pad != NULL )
+			{
+				gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, onStrideProbe, this, NULL);
+				gst_object_unref(pad);
+			}
+		}
+		
+		gst_object_unref(decoder);
+	}
+	else
+	{
+		if( mOptions.keyframesOnly )
+			LogWarning(LOG_GSTREAMER "gstDecoder -- couldn't find decoder element, --input-keyframes-only will be ignored\n");
+		
+		if( mOptions.stride > 1 )
+			LogWarning(LOG_GSTREAMER "gstDecoder -- couldn't find decoder element, --input-stride will be ignored\n");
+	}
+	
 	return true;
 }
 
@@ -363,6 +452,229 @@ static GstDiscovererVideoInfo* findVideoStreamInfo( GstDiscovererStreamInfo* inf
 }
 
 
+//
+// The discovery cache is a text file with one line per video file:
+//
+//   <size> <mtime> <codec> <width> <height> <framerate> <duration> <container> <path>
+//
+// Entries are keyed by the absolute path, and are only used while the size and
+// modification time of the file still match.  New entries get appended to the
+// end of the file, and the latest entry for a path takes precedence.
+//
+struct discoveryCacheEntry
+{
+	uint64_t size;
+	uint64_t mtime;
+	videoOptions::Codec codec;
+	uint32_t width;
+	uint32_t height;
+	float frameRate;
+	uint64_t duration;
+	std::string container;
+};
+
+static std::map<std::string, discoveryCacheEntry> gDiscoveryCache;
+static bool  gDiscoveryCacheLoaded = false;
+static Mutex gDiscoveryCacheMutex;
+
+
+// discoveryCachePath
+static std::string discoveryCachePath()
+{
+	const char* path = getenv("JETSON_UTILS_DISCOVERY_CACHE");
+	
+	if( path != NULL )
+		return path;	// an empty string disables the cache
+	
+	const char* dir = getenv("XDG_CACHE_HOME");
+	
+	if( dir != NULL && strlen(dir) > 0 )
+		return pathJoin(dir, "jetson-utils/gst-discovery.cache");
+	
+	dir = getenv("HOME");
+	
+	if( dir != NULL && strlen(dir) > 0 )
+		return pathJoin(dir, ".cache/jetson-utils/gst-discovery.cache");
+	
+	return "";
+}
+
+
+// discoveryFileStat
+static bool discoveryFileStat( const std::string& path, uint64_t* size, uint64_t* mtime )
+{
+	struct stat fileStat;
+	
+	if( stat(path.c_str(), &fileStat) != 0 )
+		return false;
+	
+	*size  = fileStat.st_size;
+	*mtime = uint64_t(fileStat.st_mtim.tv_sec) * uint64_t(1000000000) + uint64_t(fileStat.st_mtim.tv_nsec);
+	
+	return true;
+}
+
+
+// discoveryCacheLoad (the cache mutex should be locked)
+static void discoveryCacheLoad( const std::string& cachePath )
+{
+	if( gDiscoveryCacheLoaded )
+		return;
+	
+	gDiscoveryCacheLoaded = true;
+	
+	FILE* file = fopen(cachePath.c_str(), "r");
+	
+	if( !file )
+		return;
+	
+	char*  line = NULL;
+	size_t lineSize = 0;
+	size_t numLines = 0;
+	
+	while( getline(&line, &lineSize, file) > 0 )
+	{
+		unsigned long long size = 0;
+		unsigned long long mtime = 0;
+		unsigned long long duration = 0;
+		
+		char codec[32];
+		char container[128];
+		
+		discoveryCacheEntry entry;
+		int pathOffset = 0;
+		
+		numLines++;
+		
+		if( sscanf(line, "%llu %llu %31s %u %u %f %llu %127s %n", &size, &mtime, codec, &entry.width, &entry.height, 
+				 &entry.frameRate, &duration, container, &pathOffset) != 8 || pathOffset <= 0 )
+		{
+			continue;	// skip malformed entries
+		}
+		
+		std::string path = line + pathOffset;
+		
+		while( path.size() > 0 && (path[path.size()-1] == '\n' || path[path.size()-1] == '\r') )
+			path.erase(path.size()-1);
+		
+		if( path.size() == 0 )
+			continue;
+		
+		entry.size      = size;
+		entry.mtime     = mtime;
+		entry.duration  = duration;
+		entry.codec     = videoOptions::CodecFromStr(codec);
+		entry.container = (strcmp(container, "none") != 0) ? container : "";
+		
+		gDiscoveryCache[path] = entry;
+	}
+	
+	free(line);
+	fclose(file);
+	
+	LogVerbose(LOG_GSTREAMER "gstDecoder -- loaded %zu discovery cache entries from %s\n", gDiscoveryCache.size(), cachePath.c_str());
+	
+	// compact the file when it's mostly made up of stale entries
+	if( numLines < 1024 || numLines < gDiscoveryCache.size() * 2 )
+		return;
+	
+	std::ostringstream tmpPath;
+	tmpPath << cachePath << ".tmp." << getpid();
+	
+	file = fopen(tmpPath.str().c_str(), "w");
+	
+	if( !file )
+		return;
+	
+	for( std::map<std::string, discoveryCacheEntry>::const_iterator iter=gDiscoveryCache.begin(); iter != gDiscoveryCache.end(); iter++ )
+	{
+		const discoveryCacheEntry& entry = iter->second;
+		
+		fprintf(file, "%llu %llu %s %u %u %f %llu %s %s\n", (unsigned long long)entry.size, (unsigned long long)entry.mtime,
+			   videoOptions::CodecToStr(entry.codec), entry.width, entry.height, entry.frameRate, (unsigned long long)entry.duration,
+			   entry.container.size() > 0 ? entry.container.c_str() : "none", iter->first.c_str());
+	}
+	
+	if( fclose(file) != 0 || rename(tmpPath.str().c_str(), cachePath.c_str()) != 0 )
+		unlink(tmpPath.str().c_str());
+}
+
+
+// discoveryCacheLookup
+static bool discoveryCacheLookup( const std::string& path, uint64_t size, uint64_t mtime, discoveryCacheEntry* entryOut )
+{
+	const std::string cachePath = discoveryCachePath();
+	
+	if( cachePath.size() == 0 )
+		return false;
+	
+	gDiscoveryCacheMutex.Lock();
+	discoveryCacheLoad(cachePath);
+	
+	std::map<std::string, discoveryCacheEntry>::const_iterator iter = gDiscoveryCache.find(path);
+	const bool found = (iter != gDiscoveryCache.end() && iter->second.size == size && iter->second.mtime == mtime);
+	
+	if( found )
+		*entryOut = iter->second;
+	
+	gDiscoveryCacheMutex.Unlock();
+	return found;
+}
+
+
+// discoveryCacheStore
+static void discoveryCacheStore( const std::string& path, const discoveryCacheEntry& entry )
+{
+	const std::string cachePath = discoveryCachePath();
+	
+	if( cachePath.size() == 0 )
+		return;
+	
+	gDiscoveryCacheMutex.Lock();
+	
+	gDiscoveryCache[path] = entry;
+	
+	// create the cache directory if needed
+	const std::string cacheDir = pathDir(cachePath);
+	
+	for( size_t n=1; n < cacheDir.size(); n++ )
+	{
+		if( cacheDir[n] == '/' )
+			mkdir(cacheDir.substr(0, n).c_str(), 0755);
+	}
+	
+	mkdir(cacheDir.c_str(), 0755);
+	
+	// append the entry as a single write, so that concurrent processes don't interleave lines
+	char line[PATH_MAX + 256];
+	
+	const int length = snprintf(line, sizeof(line), "%llu %llu %s %u %u %f %llu %s %s\n", 
+						   (unsigned long long)entry.size, (unsigned long long)entry.mtime,
+						   videoOptions::CodecToStr(entry.codec), entry.width, entry.height, entry.frameRate, 
+						   (unsigned long long)entry.duration, entry.container.size() > 0 ? entry.container.c_str() : "none", 
+						   path.c_str());
+	
+	if( length > 0 && length < (int)sizeof(line) )
+	{
+		const int fd = open(cachePath.c_str(), O_WRONLY|O_CREAT|O_APPEND, 0644);
+		
+		if( fd >= 0 )
+		{
+			if( write(fd, line, length) != length )
+				LogWarning(LOG_GSTREAMER "gstDecoder -- failed to write to discovery cache %s\n", cachePath.c_str());
+			
+			close(fd);
+		}
+		else
+		{
+			LogWarning(LOG_GSTREAMER "gstDecoder -- failed to open discovery cache %s\n", cachePath.c_str());
+		}
+	}
+	
+	gDiscoveryCacheMutex.Unlock();
+}
+
+
 // discover
 bool gstDecoder::discover()
 {
@@ -370,6 +682,72 @@ bool gstDecoder::discover()
 	if( mOptions.resource.protocol == "rtp" || mOptions.resource.protocol == "webrtc" )
 		return false;
 
+	// skip discovery if the caller already provided the stream's properties
+	if( mOptions.discovery == videoOptions::DISCOVERY_SKIP )
+	{
+		if( mOptions.codec != videoOptions::CODEC_UNKNOWN && mOptions.width != 0 && mOptions.height != 0 )
+		{
+			LogVerbose(LOG_GSTREAMER "gstDecoder -- skipping discovery (codec=%s width=%u height=%u)\n", videoOptions::CodecToStr(mOptions.codec), mOptions.width, mOptions.height);
+			
+			// the provided size/rate are taken to be the stream's own, so don't rescale or rate-limit
+			mCustomSize = false;
+			mCustomRate = false;
+			
+			return true;
+		}
+		
+		LogWarning(LOG_GSTREAMER "gstDecoder -- skipping discovery requires --input-codec, --input-width, and --input-height to be set\n");
+		LogWarning(LOG_GSTREAMER "gstDecoder -- running discovery on %s instead\n", mOptions.resource.location.c_str());
+	}
+	
+	// check the cache for video files that have already been discovered
+	const bool useCache = (mOptions.discovery == videoOptions::DISCOVERY_CACHE && mOptions.resource.protocol == "file");
+	const std::string path = absolutePath(mOptions.resource.location);
+	
+	uint64_t fileSize = 0;
+	uint64_t fileTime = 0;
+	
+	discoveryCacheEntry entry;
+	DiscoveryInfo info;
+	
+	if( useCache && discoveryFileStat(path, &fileSize, &fileTime) && discoveryCacheLookup(path, fileSize, fileTime, &entry) )
+	{
+		LogVerbose(LOG_GSTREAMER "gstDecoder -- using cached discovery results for %s\n", path.c_str());
+		
+		info.codec     = entry.codec;
+		info.width     = entry.width;
+		info.height    = entry.height;
+		info.frameRate = entry.frameRate;
+		info.duration  = entry.duration;
+		info.container = entry.container;
+	}
+	else
+	{
+		if( !discoverProbe(info) )
+			return false;
+		
+		if( useCache && fileSize > 0 )
+		{
+			entry.size      = fileSize;
+			entry.mtime     = fileTime;
+			entry.codec     = info.codec;
+			entry.width     = info.width;
+			entry.height    = info.height;
+			entry.frameRate = info.frameRate;
+			entry.duration  = info.duration;
+			entry.container = info.container;
+			
+			discoveryCacheStore(path, entry);
+		}
+	}
+	
+	return discoverApply(info);
+}
+
+
+// discoverProbe
+bool gstDecoder::discoverProbe( DiscoveryInfo& info )
+{
 	// create a new discovery interface
 	GError* err = NULL;
 	GstDiscoverer* discoverer = gst_discoverer_new(5 * GST_SECOND, &err);
@@ -380,20 +758,27 @@ bool gstDecoder::discover()
 		return false;
 	}
 	
-	GstDiscovererInfo* info = gst_discoverer_discover_uri(discoverer,
+	GstDiscovererInfo* discoveryInfo = gst_discoverer_discover_uri(discoverer,
                              mOptions.resource.string.c_str(), &err);
     
-	if( !info || err != NULL )
+	g_object_unref(discoverer);
+	
+	if( !discoveryInfo || err != NULL )
 	{
-		LogError(LOG_GSTREAMER "gstDecoder -- %s\n", err->message);
+		LogError(LOG_GSTREAMER "gstDecoder -- %s\n", err != NULL ? err->message : "failed to discover resource");
+		
+		if( discoveryInfo != NULL )
+			gst_discoverer_info_unref(discoveryInfo);
+		
 		return false;
 	}
 	
-	GstDiscovererStreamInfo* rootStream = gst_discoverer_info_get_stream_info(info);
+	GstDiscovererStreamInfo* rootStream = gst_discoverer_info_get_stream_info(discoveryInfo);
 	
 	if( !rootStream )
 	{
 		LogError(LOG_GSTREAMER "gstDecoder -- failed to discover stream info\n");
+		gst_discoverer_info_unref(discoveryInfo);
 		return false;
 	}
 
@@ -403,12 +788,82 @@ bool gstDecoder::discover()
 	if( !videoInfo )
 	{
 		LogError(LOG_GSTREAMER "gstDecoder -- failed to discover any video streams\n");
+		gst_discoverer_info_unref(discoveryInfo);
+		return false;
+	}
+	
+	// retrieve video resolution and framerate
+	info.width     = gst_discoverer_video_info_get_width(videoInfo);
+	info.height    = gst_discoverer_video_info_get_height(videoInfo);
+	info.frameRate = float(gst_discoverer_video_info_get_framerate_num(videoInfo)) / float(gst_discoverer_video_info_get_framerate_denom(videoInfo));
+	info.duration  = gst_discoverer_info_get_duration(discoveryInfo);
+	info.codec     = videoOptions::CODEC_UNKNOWN;
+	
+	if( !GST_CLOCK_TIME_IS_VALID(info.duration) )
+		info.duration = 0;
+	
+	// retrieve the container type
+	if( GST_IS_DISCOVERER_CONTAINER_INFO(rootStream) )
+	{
+		GstCaps* containerCaps = gst_discoverer_stream_info_get_caps(rootStream);
+		
+		if( containerCaps != NULL )
+		{
+			if( gst_caps_get_size(containerCaps) > 0 )
+				info.container = gst_structure_get_name(gst_caps_get_structure(containerCaps, 0));
+			
+			gst_caps_unref(containerCaps);
+		}
+	}
+
+	// retrieve video caps
+	GstCaps* caps = gst_discoverer_stream_info_get_caps(streamInfo);
+	
+	if( !caps )
+	{
+		LogError(LOG_GSTREAMER "gstDecoder -- failed to discover video caps\n");
+		gst_discoverer_info_unref(discoveryInfo);
 		return false;
 	}
 	
-	// retrieve video resolution
-	guint width  = gst_discoverer_video_info_get_width(videoInfo);
-	guint height = gst_discoverer_video_info_get_height(videoInfo);
+	gchar* capsStr = gst_caps_to_string(caps);
+	const std::string videoCaps = capsStr;
+	
+	g_free(capsStr);
+	gst_caps_unref(caps);
+	gst_discoverer_info_unref(discoveryInfo);
+	
+	LogVerbose(LOG_GSTREAMER "gstDecoder -- discovered video caps:  %s\n", videoCaps.c_str());
+
+	// parse codec
+	if( videoCaps.find("video/x-h264") != std::string::npos )
+		info.codec = videoOptions::CODEC_H264;
+	else if( videoCaps.find("video/x-h265") != std::string::npos )
+		info.codec = videoOptions::CODEC_H265;
+	else if( videoCaps.find("video/x-vp8") != std::string::npos )
+		info.codec = videoOptions::CODEC_VP8;
+	else if( videoCaps.find("video/x-vp9") != std::string::npos )
+		info.codec = videoOptions::CODEC_VP9;
+	else if( videoCaps.find("image/jpeg") != std::string::npos )
+		info.codec = videoOptions::CODEC_MJPEG;
+	else if( videoCaps.find("video/mpeg") != std::string::npos )
+	{
+		if( videoCaps.find("mpegversion=(int)4") != std::string::npos )
+			info.codec = videoOptions::CODEC_MPEG4;
+		else if( videoCaps.find("mpegversion=(int)2") != std::string::npos )
+			info.codec = videoOptions::CODEC_MPEG2;
+	}
+	
+	return true;
+}
+
+
+// discoverApply
+bool gstDecoder::discoverApply( const DiscoveryInfo& info )
+{
+	guint width  = info.width;
+	guint height = info.height;
+	
 	if( mOptions.flipMethod == videoOptions::FLIP_CLOCKWISE || mOptions.flipMethod == videoOptions::FLIP_COUNTERCLOCKWISE
 		|| mOptions.flipMethod == videoOptions::FLIP_UPPER_LEFT_DIAGONAL || mOptions.flipMethod == videoOptions::FLIP_UPPER_RIGHT_DIAGONAL )
 	{
@@ -417,12 +872,13 @@ bool gstDecoder::discover()
 		height = prevWidth;
 	}
 	
-	const float framerate_num   = gst_discoverer_video_info_get_framerate_num(videoInfo);
-	const float framerate_denom = gst_discoverer_video_info_get_framerate_denom(videoInfo);
-	const float framerate       = framerate_num / framerate_denom;
+	const float framerate = info.frameRate;
 
 	LogVerbose(LOG_GSTREAMER "gstDecoder -- discovered video resolution: %ux%u  (framerate %f Hz)\n", width, height, framerate);
 	
+	if( info.container.size() > 0 || info.duration > 0 )
+		LogVerbose(LOG_GSTREAMER "gstDecoder -- discovered container:  %s  (duration %.3f seconds)\n", info.container.size() > 0 ? info.container.c_str() : "none", double(info.duration) * 1e-9);
+	
 	// disable re-scaling if the user's custom size matches the feed's
 	if( mCustomSize && mOptions.width == width && mOptions.height == height )
 		mCustomSize = false;
@@ -446,37 +902,12 @@ bool gstDecoder::discover()
 		mOptions.frameRate = framerate;
 	}
 
-	// retrieve video caps
-	GstCaps* caps = gst_discoverer_stream_info_get_caps(streamInfo);
-	
-	if( !caps )
-	{
-		LogError(LOG_GSTREAMER "gstDecoder -- failed to discover video caps\n");
-		return false;
-	}
+	mDuration  = info.duration;
+	mContainer = info.container;
 	
-	const std::string videoCaps = gst_caps_to_string(caps);
-	
-	LogVerbose(LOG_GSTREAMER "gstDecoder -- discovered video caps:  %s\n", videoCaps.c_str());
-
-	// parse codec
-	if( videoCaps.find("video/x-h264") != std::string::npos )
-		mOptions.codec = videoOptions::CODEC_H264;
-	else if( videoCaps.find("video/x-h265") != std::string::npos )
-		mOptions.codec = videoOptions::CODEC_H265;
-	else if( videoCaps.find("video/x-vp8") != std::string::npos )
-		mOptions.codec = videoOptions::CODEC_VP8;
-	else if( videoCaps.find("video/x-vp9") != std::string::npos )
-		mOptions.codec = videoOptions::CODEC_VP9;
-	else if( videoCaps.find("image/jpeg") != std::string::npos )
-		mOptions.codec = videoOptions::CODEC_MJPEG;
-	else if( videoCaps.find("video/mpeg") != std::string::npos )
-	{
-		if( videoCaps.find("mpegversion=(int)4") != std::string::npos )
-			mOptions.codec = videoOptions::CODEC_MPEG4;
-		else if( videoCaps.find("mpegversion=(int)2") != std::string::npos )
-			mOptions.codec = videoOptions::CODEC_MPEG2;
-	}
+	// set the codec
+	if( info.codec != videoOptions::CODEC_UNKNOWN )
+		mOptions.codec = info.codec;
 
 	if( mOptions.codec == videoOptions::CODEC_UNKNOWN )
 	{
@@ -492,8 +923,6 @@ bool gstDecoder::discover()
 		return false;
 	}
 
-	// TODO free other resources
-	//g_free(discoverer);
 	return true;
 }
 
@@ -556,6 +985,14 @@ bool gstDecoder::buildLaunchStr()
 			ss << "flvdemux ! ";
 		else if( uri.extension == "avi" )
 			ss << "avidemux ! ";
+		else if( mContainer == "video/x-matroska" || mContainer == "video/webm" )
+			ss << "matroskademux ! ";	// fall back to the discovered container for other extensions
+		else if( mContainer == "video/quicktime" )
+			ss << "qtdemux ! ";
+		else if( mContainer == "video/x-flv" )
+			ss << "flvdemux ! ";
+		else if( mContainer == "video/x-msvideo" )
+			ss << "avidemux ! ";
 		else if( uri.extension != "h264" && uri.extension != "h265" )
 		{
 			LogError(LOG_GSTREAMER "gstDecoder -- unsupported video file extension (%s)\n", uri.extension.c_str());
@@ -723,7 +1160,7 @@ bool gstDecoder::buildLaunchStr()
 	// add the app sink
 	ss << "appsink name=mysink";
 
-	if( uri.protocol != "file" )
+	if( uri.protocol != "file" || mOptions.keyframesOnly )
 		ss << " sync=false"; // wait-on-eos=false;   // this can improve realtime network streaming, but also causes videos to playback as fast as possible
 
 	mLaunchStr = ss.str();
@@ -748,6 +1185,7 @@ void gstDecoder::onEOS( _GstAppSink* sink, void* user_data )
 
 	dec->mEOS = true;	
 	dec->mStreaming = dec->isLooping();
+	dec->notifyReady();
 }
 
 
@@ -775,7 +1213,6 @@ GstFlowReturn gstDecoder::onPreroll( _GstAppSink* sink, void* user_data )
 	gst_sample_unref(gstSample);
 #endif
 
-	dec->checkMsgBus();
 	return GST_FLOW_OK;
 }
 
@@ -791,7 +1228,6 @@ GstFlowReturn gstDecoder::onBuffer( _GstAppSink* sink, void* user_data )
 	gstDecoder* dec = (gstDecoder*)user_data;
 	
 	dec->checkBuffer();
-	dec->checkMsgBus();
 	
 	return GST_FLOW_OK;
 }
@@ -855,6 +1291,14 @@ void gstDecoder::checkBuffer()
 	}
 #endif
 	
+	// drop frames that were decoded before a seek flushed the pipeline,
+	// and the frames before the target of an accurate seek
+	if( __atomic_load_n(&mSeekFlushing, __ATOMIC_ACQUIRE) )
+		release_return;
+	
+	if( GST_BUFFER_PTS_IS_VALID(gstBuffer) && GST_BUFFER_PTS(gstBuffer) < __atomic_load_n(&mSeekTarget, __ATOMIC_RELAXED) )
+		release_return;
+	
 	const uint32_t width = mOptions.width;
 	const uint32_t height = mOptions.height;
 	
@@ -881,6 +1325,7 @@ void gstDecoder::checkBuffer()
 	}
 	
 	mOptions.frameCount++;
+	notifyReady();
 	release_return;
 }
 
@@ -916,16 +1361,167 @@ bool gstDecoder::Capture( void** output, imageFormat format, uint64_t timeout, i
 	}
 	else if( result == 0 )
 	{
-		LogWarning(LOG_GSTREAMER "gstDecoder::Capture() -- a timeout occurred waiting for the next image buffer\n");
+		if( timeout > 0 )	// polling with a timeout of 0 is expected to come up empty
+			LogWarning(LOG_GSTREAMER "gstDecoder::Capture() -- a timeout occurred waiting for the next image buffer\n");
+
 		RETURN_STATUS(TIMEOUT);
 	}
 		
 	mLastTimestamp = mBufferManager->GetLastTimestamp();
 	mRawFormat = mBufferManager->GetRawFormat();
 	
+	// check if the frame was decoded from a keyframe
+	mKeyframeMutex.Lock();
+	mLastKeyframe = (std::find(mKeyframes.begin(), mKeyframes.end(), mLastTimestamp) != mKeyframes.end());
+	mKeyframeMutex.Unlock();
+	
+	// the position is the next frame to be captured (the stride skips over the ones in between)
+	if( mOptions.frameRate > 0 )
+		mPosition = mLastTimestamp + (std::max(mOptions.stride, 1u) * 1000000000.0) / mOptions.frameRate;
+	
+	// the frames in between the stride are dropped by onStrideProbe(), but when the stride
+	// spans multiple GOPs it's faster to jump to the nearest keyframe instead of decoding them
+	if( mOptions.stride > 1 && mOptions.frameRate > 0 )
+	{
+		const uint64_t next = mLastTimestamp + (mOptions.stride * 1000000000.0) / mOptions.frameRate;
+		
+		mKeyframeMutex.Lock();
+		const uint32_t gopLength = mGopLength;
+		mKeyframeMutex.Unlock();
+		
+		if( mDuration > 0 && next >= mDuration )
+		{
+			mEOS = true;	// the next Capture() will loop or close the stream
+			mStreaming = isLooping();
+			notifyReady();
+		}
+		else if( gopLength > 0 && mOptions.stride >= gopLength * 2 )
+		{
+			seek(next, false);
+		}
+	}
+	
 	RETURN_STATUS(OK);
 }
 
+
+// seekFlags
+static GstSeekFlags seekFlags( bool accurate, bool keyframesOnly )
+{
+	int flags = GST_SEEK_FLAG_FLUSH;
+	
+	if( keyframesOnly )
+	{
+	#if GST_CHECK_VERSION(1,6,0)
+		flags |= GST_SEEK_FLAG_TRICKMODE | GST_SEEK_FLAG_TRICKMODE_KEY_UNITS;
+	#endif
+		accurate = false;	// only keyframes get decoded, so snap to them
+	}
+	
+	if( accurate )
+		flags |= GST_SEEK_FLAG_ACCURATE;
+	else
+		flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE;
+	
+	return (GstSeekFlags)flags;
+}
+
+
+// Seek
+bool gstDecoder::Seek( uint64_t position, SeekFormat format, bool accurate )
+{
+	if( mOptions.resource.protocol != "file" )
+	{
+		LogError(LOG_GSTREAMER "gstDecoder -- seeking is only supported for video files (%s)\n", mOptions.resource.string.c_str());
+		return false;
+	}
+	
+	// convert frame indices to timestamps
+	uint64_t timestamp = position;
+	
+	if( format == SEEK_FRAME )
+	{
+		if( mOptions.frameRate <= 0 )
+		{
+			LogError(LOG_GSTREAMER "gstDecoder -- seeking by frame requires the framerate of the video to be known\n");
+			return false;
+		}
+		
+		timestamp = (position * 1000000000.0) / mOptions.frameRate;
+	}
+	
+	if( mDuration > 0 && timestamp >= mDuration )
+	{
+		LogError(LOG_GSTREAMER "gstDecoder -- can't seek to %.3f seconds (the video is %.3f seconds long)\n", timestamp * 1e-9, mDuration * 1e-9);
+		return false;
+	}
+	
+	// the pipeline needs to be prerolled before it can seek
+	if( !mStreaming && !mEOS )
+	{
+		if( !Open() )
+			return false;
+		
+		gst_element_get_state(mPipeline, NULL, NULL, 5 * GST_SECOND);
+	}
+	
+	return seek(timestamp, accurate);
+}
+
+
+// seek
+bool gstDecoder::seek( uint64_t timestamp, bool accurate )
+{
+	// drop the pending frame and any that arrive until the seek has flushed the pipeline,
+	// before seeking so that a frame from the new position doesn't get thrown away
+	__atomic_store_n(&mSeekFlushing, true, __ATOMIC_RELEASE);
+	mBufferManager->Flush();
+	
+	// accurate seeks keep the frame at the target (allowing half a frame for rounding)
+	uint64_t target = 0;
+	
+	if( accurate && !mOptions.keyframesOnly && mOptions.frameRate > 0 )
+		target = timestamp - std::min(timestamp, uint64_t(0.5 * 1000000000.0 / mOptions.frameRate));
+	
+	__atomic_store_n(&mSeekTarget, target, __ATOMIC_RELAXED);
+	__atomic_store_n(&mStrideNext, 0, __ATOMIC_RELAXED);
+	
+	const bool result = gst_element_seek(mPipeline, 1.0, GST_FORMAT_TIME, seekFlags(accurate, mOptions.keyframesOnly),
+								  GST_SEEK_TYPE_SET, timestamp,
+								  GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+	
+	if( !result )
+	{
+		LogError(LOG_GSTREAMER "gstDecoder -- failed to seek stream to %.3f seconds\n", timestamp * 1e-9);
+		__atomic_store_n(&mSeekFlushing, false, __ATOMIC_RELEASE);
+		return false;
+	}
+	
+	// don't count a partial GOP
+	mKeyframeMutex.Lock();
+	mGopCounting = false;
+	mKeyframeMutex.Unlock();
+	
+	mPosition = timestamp;
+	mEOS = false;
+	mStreaming = true;
+	
+	return true;
+}
+
+
+// GetPosition
+uint64_t gstDecoder::GetPosition( SeekFormat format ) const
+{
+	if( format == SEEK_TIME )
+		return mPosition;
+	
+	if( mOptions.frameRate <= 0 )
+		return mOptions.frameCount;
+	
+	return (mPosition * mOptions.frameRate) / 1000000000.0 + 0.5;
+}
+
 #if 0
 static void queryPipelineState( GstElement* pipeline )
 {
@@ -954,7 +1550,7 @@ bool gstDecoder::Open()
 			GstEvent *seek_event = NULL;
 
 			const bool seek = gst_element_seek(mPipeline, 1.0, GST_FORMAT_TIME,
-						                    (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT),
+						                    seekFlags(false, mOptions.keyframesOnly),
 						                    GST_SEEK_TYPE_SET, 0LL,
 						                    GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE );
 
@@ -967,7 +1563,11 @@ bool gstDecoder::Open()
 			LogWarning(LOG_GSTREAMER "gstDecoder -- seeking stream to beginning (loop %zu of %i)\n", mLoopCount+1, mOptions.loop);
 
 			mLoopCount++;
+			mPosition = 0;
 			mEOS = false;
+			
+			__atomic_store_n(&mStrideNext, 0, __ATOMIC_RELAXED);
+			__atomic_store_n(&mSeekTarget, 0, __ATOMIC_RELAXED);
 		}
 		else
 		{
@@ -979,6 +1579,8 @@ bool gstDecoder::Open()
 	if( mStreaming || (mWebRTCServer != NULL && !mWebRTCConnected) )  // with WebRTC, don't start the pipeline until peer connected
 		return true;
 
+	const timespec openStart = timestamp();
+
 	// transition pipline to STATE_PLAYING
 	LogInfo(LOG_GSTREAMER "opening gstDecoder for streaming, transitioning pipeline to GST_STATE_PLAYING\n");
 	
@@ -1005,10 +1607,24 @@ bool gstDecoder::Open()
 		return false;
 	}
 
-	checkMsgBus();
-	usleep(100 * 1000);
-	checkMsgBus();
+	// wait for the pipeline to finish the state change (instead of always sleeping for 100ms)
+	gst_element_get_state(mPipeline, NULL, NULL, 100 * GST_MSECOND);
+
+	gst_startup_phase(GST_STARTUP_PREROLL, openStart);
+	gst_startup_report();
 
+	mOpenTime = timestamp();
+	mOpenFrames = mBufferManager->GetFrameCount();
+	
+	// enable trick-mode so the demuxer only sends keyframes (the decoder probe drops the rest otherwise)
+	if( mOptions.keyframesOnly && mOptions.resource.protocol == "file" )
+	{
+		gst_element_get_state(mPipeline, NULL, NULL, 5 * GST_SECOND);
+		
+		if( !seek(mPosition, false) )
+			LogWarning(LOG_GSTREAMER "gstDecoder -- failed to enable keyframe trick-mode, non-keyframes will be dropped before decoding\n");
+	}
+	
 	mStreaming = true;
 	return true;
 }
@@ -1029,25 +1645,121 @@ void gstDecoder::Close()
 		LogError(LOG_GSTREAMER "gstDecoder -- failed to stop pipeline (error %u)\n", result);
 
 	usleep(250*1000);
-	checkMsgBus();
 	mStreaming = false;
 	LogInfo(LOG_GSTREAMER "gstDecoder -- pipeline stopped\n");
+	
+	if( mOpenTime.tv_sec != 0 || mOpenTime.tv_nsec != 0 )
+	{
+		LogInfo(LOG_GSTREAMER "gstDecoder -- decoded %llu %s in %.2f seconds (%.1f FPS)\n", 
+			   (unsigned long long)(mBufferManager->GetFrameCount() - mOpenFrames), mOptions.keyframesOnly ? "keyframes" : "frames",
+			   timeDouble(timeDiff(mOpenTime, timestamp())) * 0.001, GetDecodeRate());
+	}
 }
 
 
-// checkMsgBus
-void gstDecoder::checkMsgBus()
+// GetDecodeRate
+float gstDecoder::GetDecodeRate() const
 {
-	while(true)
-	{
-		GstMessage* msg = gst_bus_pop(mBus);
+	if( mOpenTime.tv_sec == 0 && mOpenTime.tv_nsec == 0 )
+		return 0.0f;
+	
+	const double elapsed = timeDouble(timeDiff(mOpenTime, timestamp()));	// milliseconds
+	
+	if( elapsed <= 0.0 )
+		return 0.0f;
+	
+	return (mBufferManager->GetFrameCount() - mOpenFrames) * 1000.0 / elapsed;
+}
 
-		if( !msg )
-			break;
 
-		gst_message_print(mBus, msg, this);
-		gst_message_unref(msg);
+// onDecoderProbe
+GstPadProbeReturn gstDecoder::onDecoderProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data )
+{
+	if( !user_data )
+		return GST_PAD_PROBE_OK;
+	
+	gstDecoder* dec = (gstDecoder*)user_data;
+	GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	
+	if( !buffer )
+		return GST_PAD_PROBE_OK;
+	
+	// skip decoding of non-keyframes if requested
+	if( GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT) )
+	{
+		if( dec->mOptions.keyframesOnly )
+			return GST_PAD_PROBE_DROP;
+		
+		dec->mKeyframeMutex.Lock();
+		dec->mGopFrames++;
+		dec->mKeyframeMutex.Unlock();
+		
+		return GST_PAD_PROBE_OK;
+	}
+	
+	dec->mKeyframeMutex.Lock();
+	
+	// measure the GOP length between consecutive keyframes (used to decide if the stride seeks)
+	if( dec->mGopCounting && !dec->mOptions.keyframesOnly )
+		dec->mGopLength = dec->mGopFrames + 1;
+	
+	dec->mGopFrames = 0;
+	dec->mGopCounting = true;
+	
+	// remember the timestamps of recent keyframes, to match against the decoded frames
+	if( GST_BUFFER_PTS_IS_VALID(buffer) )
+	{
+		dec->mKeyframes.push_back(GST_BUFFER_PTS(buffer));
+		
+		if( dec->mKeyframes.size() > 64 )
+			dec->mKeyframes.pop_front();
 	}
+	
+	dec->mKeyframeMutex.Unlock();
+	return GST_PAD_PROBE_OK;
+}
+
+
+// onStrideProbe
+GstPadProbeReturn gstDecoder::onStrideProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data )
+{
+	if( !user_data )
+		return GST_PAD_PROBE_OK;
+	
+	gstDecoder* dec = (gstDecoder*)user_data;
+	GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	
+	if( !buffer || !GST_BUFFER_PTS_IS_VALID(buffer) || dec->mOptions.frameRate <= 0 )
+		return GST_PAD_PROBE_OK;
+	
+	const uint64_t pts = GST_BUFFER_PTS(buffer);
+	const uint64_t next = __atomic_load_n(&dec->mStrideNext, __ATOMIC_RELAXED);
+	
+	if( pts < next )
+		return GST_PAD_PROBE_DROP;
+	
+	// keep this frame, and allow half a frame of jitter in the timestamp of the next one
+	const double period = 1000000000.0 / dec->mOptions.frameRate;
+	__atomic_store_n(&dec->mStrideNext, pts + uint64_t((dec->mOptions.stride - 0.5) * period), __ATOMIC_RELAXED);
+	
+	return GST_PAD_PROBE_OK;
+}
+
+
+// onFlushProbe
+GstPadProbeReturn gstDecoder::onFlushProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data )
+{
+	if( !user_data )
+		return GST_PAD_PROBE_OK;
+	
+	gstDecoder* dec = (gstDecoder*)user_data;
+	GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+	
+	// the frames after FLUSH_STOP are from the new position
+	if( event != NULL && GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP )
+		__atomic_store_n(&dec->mSeekFlushing, false, __ATOMIC_RELEASE);
+	
+	return GST_PAD_PROBE_OK;
 }
 
 
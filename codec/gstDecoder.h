@@ -28,6 +28,8 @@
 
 #include "videoSource.h"
 
+#include <deque>
+
 
 // Forward declarations
 class WebRTCServer;
@@ -85,6 +87,20 @@ public:
 	 */
 	virtual void Close();
 
+	/**
+	 * Seek the video file to a frame index or timestamp.  Accurate seeks decode
+	 * from the previous keyframe up to the requested frame, while non-accurate
+	 * seeks snap to the keyframe before it.  Only file:// resources can seek.
+	 * @see videoSource::Seek()
+	 */
+	virtual bool Seek( uint64_t position, SeekFormat format=SEEK_FRAME, bool accurate=true );
+
+	/**
+	 * Return the frame index (or timestamp) of the next frame to be captured.
+	 * @see videoSource::GetPosition()
+	 */
+	virtual uint64_t GetPosition( SeekFormat format=SEEK_FRAME ) const;
+
 	/**
 	 * Return true if End Of Stream (EOS) has been reached.
 	 * In the context of gstDecoder, EOS means that playback 
@@ -124,17 +140,46 @@ public:
 	 */
 	static bool IsSupportedExtension( const char* ext );
 
+	/**
+	 * Return the duration of the stream (in nanoseconds), or 0 if it's unknown
+	 * (for example with live network streams, or if discovery was skipped).
+	 */
+	inline uint64_t GetDuration() const		{ return mDuration; }
+
+	/**
+	 * Return the average number of frames per second that the decoder has
+	 * output since the stream was opened.  With `--input-keyframes-only`,
+	 * this is the rate that keyframes are being scanned at.
+	 */
+	float GetDecodeRate() const;
+
 protected:
+	/**
+	 * Stream properties that are found by discover(), and cached on disk for video files.
+	 * The width and height are before any flip method has been applied.
+	 */
+	struct DiscoveryInfo
+	{
+		videoOptions::Codec codec;
+		uint32_t width;
+		uint32_t height;
+		float frameRate;
+		uint64_t duration;		// nanoseconds
+		std::string container;	// caps name of the container (e.g. video/quicktime)
+	};
+
 	gstDecoder( const videoOptions& options );
 	
-	void checkMsgBus();
 	void checkBuffer();
 	bool buildLaunchStr();
 	bool discover();
+	bool discoverProbe( DiscoveryInfo& info );
+	bool discoverApply( const DiscoveryInfo& info );
 	
 	bool init();
 	bool initPipeline();
 	void destroyPipeline();
+	bool seek( uint64_t timestamp, bool accurate );
 	
 	inline bool isLooping() const { return (mOptions.loop < 0) || ((mOptions.loop > 0) && (mLoopCount < mOptions.loop)); }
 
@@ -144,6 +189,15 @@ protected:
 	static GstFlowReturn onPreroll(_GstAppSink* sink, void* user_data);
 	static GstFlowReturn onBuffer(_GstAppSink* sink, void* user_data);
 
+	// decoder input probe (tracks keyframes)
+	static GstPadProbeReturn onDecoderProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data );
+
+	// decoder output probe (drops the frames in between the stride)
+	static GstPadProbeReturn onStrideProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data );
+
+	// appsink input probe (tracks when a seek has flushed the old frames)
+	static GstPadProbeReturn onFlushProbe( GstPad* pad, GstPadProbeInfo* info, void* user_data );
+
 	// WebRTC callbacks
 	static void onWebsocketMessage( WebRTCPeer* peer, const char* message, size_t message_size, void* user_data );
 
@@ -157,6 +211,21 @@ protected:
 	bool		  mCustomRate;
 	bool        mEOS;
 	size_t	  mLoopCount;
+	uint64_t    mDuration;
+	uint64_t    mPosition;
+	timespec    mOpenTime;
+	uint64_t    mOpenFrames;
+	
+	std::deque<uint64_t> mKeyframes;	// timestamps of keyframes sent to the decoder
+	Mutex mKeyframeMutex;
+	
+	uint32_t mGopLength;	// frames from one keyframe to the next (0 if unknown)
+	uint32_t mGopFrames;	// frames sent to the decoder since the last keyframe
+	bool     mGopCounting;	// false until a keyframe is seen after opening or seeking
+	uint64_t mStrideNext;	// timestamp of the next frame kept by the stride
+	bool     mSeekFlushing;	// frames reaching the appsink are from before the seek, until it's flushed
+	uint64_t mSeekTarget;	// frames before this timestamp are dropped after an accurate seek
+	std::string mContainer;
 		
 	gstBufferManager* mBufferManager;
 	
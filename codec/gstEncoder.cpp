@@ -21,6 +21,8 @@
  */
 
 #include "gstEncoder.h"
+#include "gstBitrateController.h"
+#include "gstPipelineManager.h"
 #include "gstWebRTC.h"
 
 #include "RTSPServer.h"
@@ -31,6 +33,7 @@
 #include "logging.h"
 
 #include "cudaColorspace.h"
+#include "cudaResize.h"
 
 #define GST_USE_UNSTABLE_API
 #include <gst/webrtc/webrtc.h>
@@ -79,8 +82,24 @@ gstEncoder::gstEncoder( const videoOptions& options ) : videoOutput(options)
 	mRTSPServer   = NULL;
 	mWebRTCServer = NULL;
 	mNeedData     = false;
+	mScaleWidth   = 0;
+	mScaleHeight  = 0;
+	mCapsWidth    = 0;
+	mCapsHeight   = 0;
+	mMaxRate      = 0;
+	mLastEncode   = 0;
+
+	mBitrateController = NULL;
 
 	mBufferYUV.SetThreaded(false);
+	mBufferScaled.SetThreaded(false);
+
+	const std::string labels = Metrics::Label("uri", mOptions.resource.string.c_str());
+
+	mBytesMetric    = Metrics::Counter("jetson_encoder_input_bytes_total", "Number of bytes of raw video pushed into the encoder", labels.c_str());
+	mErrorsMetric   = Metrics::Counter("jetson_encoder_push_errors_total", "Number of times pushing a frame into the encoder failed", labels.c_str());
+	mRestartsMetric = Metrics::Counter("jetson_encoder_restarts_total", "Number of times the encoder pipeline was restarted", labels.c_str());
+	mPushMetric     = Metrics::Histogram("jetson_encoder_push_seconds", "Time taken to copy a frame into the encoder pipeline", labels.c_str());
 }
 
 
@@ -101,7 +120,18 @@ gstEncoder::~gstEncoder()
 		mWebRTCServer = NULL;
 	}
 	
+	if( mBitrateController != NULL )
+	{
+		delete mBitrateController;
+		mBitrateController = NULL;
+	}
+
 	destroyPipeline();
+
+	Metrics::Release(mBytesMetric);
+	Metrics::Release(mErrorsMetric);
+	Metrics::Release(mRestartsMetric);
+	Metrics::Release(mPushMetric);
 }
 
 
@@ -122,6 +152,7 @@ void gstEncoder::destroyPipeline()
 
 	if( mPipeline != NULL )
 	{
+		gstPipelineManager::Unregister(mPipeline);
 		gst_element_set_state(mPipeline, GST_STATE_NULL);
 		gst_object_unref(mPipeline);
 		mPipeline = NULL;
@@ -214,8 +245,12 @@ bool gstEncoder::initPipeline()
 		return false;
 	}
 	
-	// add watch for messages (disabled when we poll the bus ourselves, instead of gmainloop)
-	//gst_bus_add_watch(mBus, (GstBusFunc)gst_message_print, NULL);
+	// dispatch the bus messages from the shared pipeline manager thread
+	if( !gstPipelineManager::Register(mPipeline, mOptions.resource.string.c_str()) )
+	{
+		LogError(LOG_GSTREAMER "gstEncoder -- failed to register pipeline with gstPipelineManager\n");
+		return false;
+	}
 
 	// get the appsrc element
 	GstElement* appsrcElement = gst_bin_get_by_name(GST_BIN(pipeline), "mysource");
@@ -274,6 +309,19 @@ bool gstEncoder::init()
 		mWebRTCServer->AddRoute(mOptions.resource.path.c_str(), onWebsocketMessage, this, WEBRTC_VIDEO|WEBRTC_SEND|WEBRTC_PUBLIC|WEBRTC_MULTI_CLIENT);
 	}		
 
+	// adapt the bitrate from the receiver reports of the RTSP/WebRTC clients
+	if( mOptions.minBitRate > 0 )
+	{
+		if( mRTSPServer == NULL && mWebRTCServer == NULL )
+			LogWarning(LOG_GSTREAMER "gstEncoder -- adaptive bitrate is only supported for RTSP and WebRTC outputs\n");
+		else if( mOptions.codec == videoOptions::CODEC_MJPEG )
+			LogWarning(LOG_GSTREAMER "gstEncoder -- adaptive bitrate isn't supported for MJPEG\n");
+		else if( mOptions.minBitRate >= mOptions.bitRate )
+			LogWarning(LOG_GSTREAMER "gstEncoder -- the minimum bitrate (%u) should be lower than the bitrate (%u), disabling adaptive bitrate\n", mOptions.minBitRate, mOptions.bitRate);
+		else
+			mBitrateController = new gstBitrateController(this, mOptions.minBitRate, mOptions.bitRate);
+	}
+
 	return true;
 }
 	
@@ -285,14 +333,14 @@ bool gstEncoder::buildCapsStr()
 
 #if GST_CHECK_VERSION(1,0,0)
 	ss << "video/x-raw";
-	ss << ", width=" << GetWidth();
-	ss << ", height=" << GetHeight();
+	ss << ", width=" << mCapsWidth;
+	ss << ", height=" << mCapsHeight;
 	ss << ", format=(string)I420";
 	ss << ", framerate=" << (int)mOptions.frameRate << "/1";
 #else
 	ss << "video/x-raw-yuv";
-	ss << ",width=" << GetWidth();
-	ss << ",height=" << GetHeight();
+	ss << ",width=" << mCapsWidth;
+	ss << ",height=" << mCapsHeight;
 	ss << ",format=(fourcc)I420";
 	ss << ",framerate=" << (int)mOptions.frameRate << "/1";
 #endif
@@ -521,6 +569,8 @@ bool gstEncoder::encodeYUV( void* buffer, size_t size )
 		return true;
 	}*/
 
+	const timespec pushStart = timestamp();
+
 	// construct the buffer caps for this size image
 	if( !mBufferCaps )
 	{
@@ -599,6 +649,7 @@ bool gstEncoder::encodeYUV( void* buffer, size_t size )
 			break;
 		}
 		
+		mErrorsMetric->Increment();
 		LogError(LOG_GSTREAMER "gstEncoder -- an error occurred pushing appsrc buffer (result=%i '%s')\n", (int)ret, gst_flow_get_name(ret));
 		
 		// check to make sure the pipeline is still playing (some pipelines like RTSP server may disconnect)
@@ -610,6 +661,7 @@ bool gstEncoder::encodeYUV( void* buffer, size_t size )
 			LogError(LOG_GSTREAMER "gstEncoder -- pipeline is in the '%s' state, restarting pipeline...\n", gst_element_state_get_name(state));
 			
 			mStreaming = false;
+			mRestartsMetric->Increment();
 			
 			if( !Open() )
 			{
@@ -619,7 +671,101 @@ bool gstEncoder::encodeYUV( void* buffer, size_t size )
 		}
 	}
 	
-	checkMsgBus();
+	mBytesMetric->Increment(size);
+	mPushMetric->ObserveSince(pushStart);
+
+	return true;
+}
+
+
+// scaleSize
+void gstEncoder::scaleSize( uint32_t width, uint32_t height, uint32_t* scaleWidth, uint32_t* scaleHeight ) const
+{
+	// the scaled size keeps the aspect ratio if only one dimension was set
+	if( mScaleWidth == 0 && mScaleHeight == 0 )
+	{
+		*scaleWidth  = width;
+		*scaleHeight = height;
+	}
+	else if( mScaleWidth == 0 )
+	{
+		*scaleWidth  = (width * mScaleHeight) / height;
+		*scaleHeight = mScaleHeight;
+	}
+	else if( mScaleHeight == 0 )
+	{
+		*scaleWidth  = mScaleWidth;
+		*scaleHeight = (height * mScaleWidth) / width;
+	}
+	else
+	{
+		*scaleWidth  = mScaleWidth;
+		*scaleHeight = mScaleHeight;
+	}
+
+	// I420 needs even dimensions
+	*scaleWidth  = (*scaleWidth + 1) & ~1;
+	*scaleHeight = (*scaleHeight + 1) & ~1;
+}
+
+
+// canRenegotiate
+bool gstEncoder::canRenegotiate() const
+{
+	// the CPU encoders and RTP payloaders can renegotiate the caps mid-stream
+	const URI& uri = GetResource();
+
+	return mOptions.codecType == videoOptions::CODEC_CPU && mOptions.save.path.length() == 0 &&
+		  (uri.protocol == "rtp" || uri.protocol == "rtsp" || uri.protocol == "webrtc");
+}
+
+
+// reconfigure
+bool gstEncoder::reconfigure( uint32_t width, uint32_t height )
+{
+	LogVerbose(LOG_GSTREAMER "gstEncoder -- encoded resolution changing from (%ux%u) to (%ux%u)\n", mCapsWidth, mCapsHeight, width, height);
+
+	// encodeYUV() will set the new caps on appsrc
+	gst_caps_unref(mBufferCaps);
+	mBufferCaps = NULL;
+
+	mCapsWidth  = width;
+	mCapsHeight = height;
+
+	if( canRenegotiate() )
+		return true;
+
+	/*// nvbufsurface: NvBufSurfaceCopy: buffer param mismatch
+	GstElement* vidconv = gst_bin_get_by_name(GST_BIN(mPipeline), "vidconv");
+	GstElement* encoder = gst_bin_get_by_name(GST_BIN(mPipeline), "encoder");
+	
+	if( vidconv != NULL && encoder != NULL )
+	{
+		gst_element_set_state(mAppSrc, GST_STATE_NULL);
+		gst_element_set_state(vidconv, GST_STATE_NULL);
+		gst_element_set_state(encoder, GST_STATE_NULL);
+		gst_element_set_state(mAppSrc, GST_STATE_PLAYING);
+		gst_element_set_state(vidconv, GST_STATE_PLAYING);
+		gst_element_set_state(encoder, GST_STATE_PLAYING);
+		gst_object_unref(vidconv);
+		gst_object_unref(encoder);
+		usleep(500*1000);
+	}*/
+
+	// the hardware encoders and file muxers need the pipeline rebuilt
+	if( mRTSPServer != NULL || mWebRTCServer != NULL )
+		LogWarning(LOG_GSTREAMER "gstEncoder -- restarting the pipeline for the new resolution will disconnect the RTSP/WebRTC clients\n");
+
+	destroyPipeline();
+
+	mStreaming = false;
+	
+	if( !initPipeline() || !Open() )
+	{
+		LogError(LOG_GSTREAMER "failed to re-initialize encoder with new dimensions (%ux%u)\n", width, height);
+		return false;
+	}
+
 	return true;
 }
 
@@ -631,6 +777,10 @@ bool gstEncoder::Render( void* image, uint32_t width, uint32_t height, imageForm
 	if( mWebRTCServer != NULL && !mWebRTCServer->IsThreaded() )
 		mWebRTCServer->ProcessRequests();	
 	
+	// adapt the bitrate to the receiver reports
+	if( mBitrateController != NULL && mStreaming )
+		mBitrateController->Update();
+
 	// increment frame counter
 	mOptions.frameCount += 1;
 		
@@ -645,40 +795,6 @@ bool gstEncoder::Render( void* image, uint32_t width, uint32_t height, imageForm
 		
 		mOptions.width  = width;
 		mOptions.height = height;
-
-		if( mBufferCaps != NULL )
-		{
-			gst_object_unref(mBufferCaps);
-			mBufferCaps = NULL;
-			
-			destroyPipeline();
-		
-			mStreaming = false;
-			
-			if( !initPipeline() || !Open() )
-			{
-				LogError(LOG_GSTREAMER "failed to re-initialize encoder with new dimensions (%ux%u)\n", width, height);
-				return false;
-			}
-		}
-		
-		/*// nvbufsurface: NvBufSurfaceCopy: buffer param mismatch
-		GstElement* vidconv = gst_bin_get_by_name(GST_BIN(mPipeline), "vidconv");
-		GstElement* encoder = gst_bin_get_by_name(GST_BIN(mPipeline), "encoder");
-		
-		if( vidconv != NULL && encoder != NULL )
-		{
-			gst_element_set_state(mAppSrc, GST_STATE_NULL);
-			gst_element_set_state(vidconv, GST_STATE_NULL);
-			gst_element_set_state(encoder, GST_STATE_NULL);
-			gst_element_set_state(mAppSrc, GST_STATE_PLAYING);
-			gst_element_set_state(vidconv, GST_STATE_PLAYING);
-			gst_element_set_state(encoder, GST_STATE_PLAYING);
-			gst_object_unref(vidconv);
-			gst_object_unref(encoder);
-			usleep(500*1000);
-			checkMsgBus();
-		}*/
 	}
 
 	// error checking / return
@@ -688,8 +804,70 @@ bool gstEncoder::Render( void* image, uint32_t width, uint32_t height, imageForm
 		const bool substreams_success = videoOutput::Render(image, width, height, format); \
 		return enc_success & substreams_success;
 
+	// limit the rate that frames are encoded at
+	if( mMaxRate > 0 )
+	{
+		const uint64_t now = apptime_nano();
+		const uint64_t period = uint64_t(1e9f / mMaxRate);
+
+		if( mLastEncode != 0 && now < mLastEncode + period )
+		{
+			enc_success = true;
+			render_end();
+		}
+
+		// advance by the period so the average rate isn't quantized to the input's frames,
+		// but resync if it fell more than a period behind (like after the input stalled)
+		mLastEncode += period;
+
+		if( now - mLastEncode > period )
+			mLastEncode = now;
+	}
+
+	// change the caps if the encoded resolution changed
+	uint32_t encodeWidth  = width;
+	uint32_t encodeHeight = height;
+
+	scaleSize(width, height, &encodeWidth, &encodeHeight);
+
+	if( mBufferCaps != NULL && (encodeWidth != mCapsWidth || encodeHeight != mCapsHeight) )
+	{
+		if( !reconfigure(encodeWidth, encodeHeight) )
+		{
+			enc_success = false;
+			render_end();
+		}
+	}
+
+	mCapsWidth  = encodeWidth;
+	mCapsHeight = encodeHeight;
+
+	// scale the image if needed
+	void* encodeImage = image;
+
+	if( encodeWidth != width || encodeHeight != height )
+	{
+		const size_t scaledSize = imageFormatSize(format, encodeWidth, encodeHeight);
+
+		if( !mBufferScaled.Alloc(2, scaledSize, 0) )
+		{
+			LogError(LOG_GSTREAMER "gstEncoder -- failed to allocate buffers (%zu bytes each)\n", scaledSize);
+			enc_success = false;
+			render_end();
+		}
+
+		encodeImage = mBufferScaled.Next(RingBuffer::Write);
+
+		if( CUDA_FAILED(cudaResize(image, width, height, encodeImage, encodeWidth, encodeHeight, format, FILTER_LINEAR, stream)) )
+		{
+			LogError(LOG_GSTREAMER "gstEncoder::Render() -- failed to scale image from (%ux%u) to (%ux%u)\n", width, height, encodeWidth, encodeHeight);
+			enc_success = false;
+			render_end();
+		}
+	}
+
 	// allocate color conversion buffer
-	const size_t i420Size = imageFormatSize(IMAGE_I420, width, height);
+	const size_t i420Size = imageFormatSize(IMAGE_I420, encodeWidth, encodeHeight);
 
 	if( !mBufferYUV.Alloc(2, i420Size, RingBuffer::ZeroCopy) )
 	{
@@ -701,7 +879,7 @@ bool gstEncoder::Render( void* image, uint32_t width, uint32_t height, imageForm
 	// perform colorspace conversion
 	void* nextYUV = mBufferYUV.Next(RingBuffer::Write);
 
-	if( CUDA_FAILED(cudaConvertColor(image, format, nextYUV, IMAGE_I420, width, height, stream)) )
+	if( CUDA_FAILED(cudaConvertColor(encodeImage, format, nextYUV, IMAGE_I420, encodeWidth, encodeHeight, stream)) )
 	{
 		LogError(LOG_GSTREAMER "gstEncoder::Render() -- unsupported image format (%s)\n", imageFormatToStr(format));
 		LogError(LOG_GSTREAMER "                        supported formats are:\n");
@@ -727,12 +905,120 @@ bool gstEncoder::Render( void* image, uint32_t width, uint32_t height, imageForm
 }
 
 
+// SetBitRate
+bool gstEncoder::SetBitRate( uint32_t bitRate )
+{
+	if( bitRate == 0 )
+		return false;
+
+	if( mOptions.codec == videoOptions::CODEC_MJPEG )
+	{
+		LogError(LOG_GSTREAMER "gstEncoder -- the bitrate can't be set for MJPEG\n");
+		return false;
+	}
+
+	// without a pipeline, the bitrate gets used when it's created
+	if( !mPipeline )
+	{
+		mOptions.bitRate = bitRate;
+		return true;
+	}
+
+	GstElement* encoder = gst_bin_get_by_name(GST_BIN(mPipeline), "encoder");
+
+	if( !encoder )
+	{
+		LogError(LOG_GSTREAMER "gstEncoder -- failed to find the encoder element in the pipeline\n");
+		return false;
+	}
+
+	// the CPU encoders use different names and units for the bitrate (see buildLaunchStr())
+	const char* property = "bitrate";
+	uint32_t value = bitRate;
+
+	if( mOptions.codecType == videoOptions::CODEC_CPU )
+	{
+		if( mOptions.codec == videoOptions::CODEC_H264 || mOptions.codec == videoOptions::CODEC_H265 )
+			value = bitRate / 1000;	// x264enc/x265enc bitrates are in kbits
+		else
+			property = "target-bitrate";
+	}
+
+	GParamSpec* param = g_object_class_find_property(G_OBJECT_GET_CLASS(encoder), property);
+	bool result = false;
+
+	if( !param )
+	{
+		LogError(LOG_GSTREAMER "gstEncoder -- the encoder element doesn't have the '%s' property\n", property);
+	}
+	else if( mStreaming && !(param->flags & GST_PARAM_MUTABLE_PLAYING) )
+	{
+		LogWarning(LOG_GSTREAMER "gstEncoder -- the encoder's '%s' property can't be changed while playing,\n", property);
+		LogWarning(LOG_GSTREAMER "              keeping the bitrate at %u bps\n", mOptions.bitRate);
+	}
+	else
+	{
+		if( G_IS_PARAM_SPEC_INT(param) )
+			g_object_set(encoder, property, (gint)value, NULL);
+		else
+			g_object_set(encoder, property, (guint)value, NULL);
+
+		mOptions.bitRate = bitRate;
+		LogVerbose(LOG_GSTREAMER "gstEncoder -- set bitrate to %u bps\n", bitRate);
+		result = true;
+	}
+
+	gst_object_unref(encoder);
+	return result;
+}
+
+
+// SetFrameRate
+bool gstEncoder::SetFrameRate( float frameRate )
+{
+	if( frameRate < 0 )
+		return false;
+
+	mMaxRate = frameRate;
+	mLastEncode = 0;	// restart the schedule at the new rate
+
+	// the caps keep the frame rate the pipeline was created with until they're renegotiated,
+	// but the buffers are timestamped when they're pushed so the stream plays at this rate
+	if( frameRate > 0 )
+		mOptions.frameRate = frameRate;
+
+	LogVerbose(LOG_GSTREAMER "gstEncoder -- limiting frame rate to %g fps\n", frameRate);
+	return true;
+}
+
+
+// SetResolution
+bool gstEncoder::SetResolution( uint32_t width, uint32_t height )
+{
+	// the RTSP route and WebRTC peers are linked to the pipeline, so it can't be rebuilt under them
+	if( (mRTSPServer != NULL || mWebRTCServer != NULL) && !canRenegotiate() )
+	{
+		LogError(LOG_GSTREAMER "gstEncoder -- can't change the resolution of %s streams with the %s encoder (it needs the pipeline restarted)\n",
+			    GetResource().protocol.c_str(), videoOptions::CodecTypeToStr(mOptions.codecType));
+		return false;
+	}
+
+	mScaleWidth  = width;
+	mScaleHeight = height;
+
+	LogVerbose(LOG_GSTREAMER "gstEncoder -- encoding at resolution (%ux%u)\n", width, height);
+	return true;
+}
+
+
 // Open
 bool gstEncoder::Open()
 {
 	if( mStreaming )
 		return true;
 
+	const timespec openStart = timestamp();
+
 	// transition pipline to STATE_PLAYING
 	LogInfo(LOG_GSTREAMER "gstEncoder -- starting pipeline, transitioning to GST_STATE_PLAYING\n");
 
@@ -761,9 +1047,11 @@ bool gstEncoder::Open()
 		return false;
 	}
 
-	checkMsgBus();
-	usleep(100 * 1000);
-	checkMsgBus();
+	// wait for the pipeline to finish the state change (instead of always sleeping for 100ms)
+	gst_element_get_state(mPipeline, NULL, NULL, 100 * GST_MSECOND);
+
+	gst_startup_phase(GST_STARTUP_PREROLL, openStart);
+	gst_startup_report();
 
 	mStreaming = true;
 	return true;
@@ -796,28 +1084,11 @@ void gstEncoder::Close()
 		LogError(LOG_GSTREAMER "gstEncoder -- failed to set pipeline state to NULL (error %u)\n", result);
 
 	sleep(1);
-	checkMsgBus();	
 	mStreaming = false;
 	LogInfo(LOG_GSTREAMER "gstEncoder -- pipeline stopped\n");
 }
 
 
-// checkMsgBus
-void gstEncoder::checkMsgBus()
-{
-	while(true)
-	{
-		GstMessage* msg = gst_bus_pop(mBus);
-
-		if( !msg )
-			break;
-
-		gst_message_print(mBus, msg, this);
-		gst_message_unref(msg);
-	}
-}
-
-
 // onWebsocketMessage
 void gstEncoder::onWebsocketMessage( WebRTCPeer* peer, const char* message, size_t message_size, void* user_data )
 {
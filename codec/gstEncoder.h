@@ -26,11 +26,13 @@
 #include "gstUtility.h"
 #include "videoOutput.h"
 #include "RingBuffer.h"
+#include "metrics.h"
 
 
 // Forward declarations
 class RTSPServer;
 class WebRTCServer;
+class gstBitrateController;
 struct WebRTCPeer;
 
 
@@ -90,6 +92,47 @@ public:
 	 */
 	virtual void Close();
 
+	/**
+	 * Change the target bitrate of the encoder while it's running (in bits per second).
+	 * The encoder element's property is set directly, so the pipeline isn't restarted.
+	 * If the encoder doesn't have the property or doesn't support changing it while
+	 * playing, false is returned and the bitrate is left unchanged (GetBitRate() keeps
+	 * returning the bitrate that the encoder is running at).
+	 */
+	bool SetBitRate( uint32_t bitRate );
+
+	/**
+	 * Return the target bitrate of the encoder (in bits per second).
+	 */
+	inline uint32_t GetBitRate() const				{ return mOptions.bitRate; }
+
+	/**
+	 * Limit the rate that frames are encoded at (in frames per second).
+	 * Frames that are rendered faster than this are skipped by the encoder
+	 * (but still passed on to the sub-streams).  Set to 0 to encode every frame.
+	 */
+	bool SetFrameRate( float frameRate );
+
+	/**
+	 * Scale the frames to a different resolution before they're encoded.
+	 * If only the width or height is set (and the other is 0), the aspect ratio is kept.
+	 * Set both to 0 to encode the frames at the size they're rendered at.
+	 *
+	 * The caps are renegotiated with the CPU encoders when streaming over RTP/RTSP/WebRTC.
+	 * The hardware encoders and file muxers can't change resolution mid-stream, so with
+	 * those the pipeline gets restarted with the new resolution on the next frame, but
+	 * only for files and RTP streams.  Restarting it would disconnect RTSP and WebRTC
+	 * clients, so for RTSP/WebRTC outputs with a hardware encoder (or with --output-save)
+	 * this fails, returning false and leaving the resolution unchanged.
+	 */
+	bool SetResolution( uint32_t width, uint32_t height );
+
+	/**
+	 * Return the adaptive bitrate controller, or NULL if it isn't enabled
+	 * (it gets enabled with videoOptions::minBitRate)
+	 */
+	inline gstBitrateController* GetBitrateController() const	{ return mBitrateController; }
+
 	/**
 	 * Return the GStreamer pipeline object.
 	 */
@@ -137,10 +180,12 @@ protected:
 	bool initPipeline();
 	void destroyPipeline();
 	
-	void checkMsgBus();
 	bool buildCapsStr();
 	bool buildLaunchStr();
 	bool encodeYUV( void* buffer, size_t size );
+	bool canRenegotiate() const;
+	bool reconfigure( uint32_t width, uint32_t height );
+	void scaleSize( uint32_t width, uint32_t height, uint32_t* scaleWidth, uint32_t* scaleHeight ) const;
 	
 	// appsrc callbacks
 	static void onNeedData( GstElement* pipeline, uint32_t size, void* user_data );
@@ -159,9 +204,24 @@ protected:
 	std::string  mLaunchStr;
 
 	RingBuffer mBufferYUV;
+	RingBuffer mBufferScaled;
+
+	uint32_t mScaleWidth;		// resolution set with SetResolution() (0 to use the input size)
+	uint32_t mScaleHeight;
+	uint32_t mCapsWidth;		// resolution of the frames being encoded
+	uint32_t mCapsHeight;
+	float    mMaxRate;		// frame rate set with SetFrameRate() (0 for no limit)
+	uint64_t mLastEncode;		// time that the last encoded frame was scheduled for (in nanoseconds)
+	
+	gstBitrateController* mBitrateController;
 	
 	RTSPServer*   mRTSPServer;
 	WebRTCServer* mWebRTCServer;
+
+	MetricCounter*   mBytesMetric;
+	MetricCounter*   mErrorsMetric;
+	MetricCounter*   mRestartsMetric;
+	MetricHistogram* mPushMetric;
 };
  
  
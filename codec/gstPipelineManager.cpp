@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gstPipelineManager.h"
+
+#include "metrics.h"
+#include "Thread.h"
+#include "Mutex.h"
+#include "logging.h"
+
+#include <vector>
+#include <pthread.h>
+
+
+// a registered pipeline
+struct gstPipelineManager::Pipeline
+{
+	GstElement*       element;
+	GSource*          watch;
+	std::string       name;
+	Callback          callback;
+	void*             user_data;
+	bool              removed;		// set by Unregister(), so that the callback isn't called again
+	bool              dispatching;	// a message is being printed or passed to the callback
+	gstPipelineHealth health;
+
+	MetricCounter* errorsMetric;
+	MetricCounter* qosMetric;
+	MetricGauge*   latencyMetric;
+	MetricGauge*   stateMetric;
+};
+
+
+// registered pipelines (protected by gPipelineMutex, which isn't held while the callbacks run)
+static std::vector<gstPipelineManager::Pipeline*> gPipelines;
+static Mutex gPipelineMutex;
+
+// signalled (with gPipelineMutex) when a pipeline is done dispatching a message
+static pthread_cond_t gDispatchCond = PTHREAD_COND_INITIALIZER;
+
+static GMainContext* gPipelineContext = NULL;
+static GMainLoop*    gPipelineLoop    = NULL;
+static Thread*       gPipelineThread  = NULL;
+
+
+// init
+bool gstPipelineManager::init()
+{
+	if( gPipelineThread != NULL )
+		return true;
+
+	if( !gstreamerInit() )
+	{
+		LogError(LOG_GSTREAMER "failed to initialize gstreamer API\n");
+		return false;
+	}
+
+	gPipelineContext = g_main_context_new();
+	gPipelineLoop    = g_main_loop_new(gPipelineContext, false);
+
+	if( !gPipelineContext || !gPipelineLoop )
+	{
+		LogError(LOG_GSTREAMER "gstPipelineManager -- failed to create GMainLoop instance\n");
+		return false;
+	}
+
+	gPipelineThread = new Thread();
+
+	if( !gPipelineThread->Start(runThread) )
+	{
+		LogError(LOG_GSTREAMER "gstPipelineManager -- failed to start thread\n");
+
+		delete gPipelineThread;
+		gPipelineThread = NULL;
+
+		return false;
+	}
+
+	return true;
+}
+
+
+// runThread
+void* gstPipelineManager::runThread( void* user_data )
+{
+	LogVerbose(LOG_GSTREAMER "gstPipelineManager -- thread running\n");
+
+	g_main_context_push_thread_default(gPipelineContext);
+	g_main_loop_run(gPipelineLoop);
+	g_main_context_pop_thread_default(gPipelineContext);
+
+	LogVerbose(LOG_GSTREAMER "gstPipelineManager -- thread stopped\n");
+	return 0;
+}
+
+
+// GetContext
+GMainContext* gstPipelineManager::GetContext()
+{
+	gPipelineMutex.Lock();
+	const bool result = init();
+	gPipelineMutex.Unlock();
+
+	return result ? gPipelineContext : NULL;
+}
+
+
+// releasePipeline (GDestroyNotify for the watch's callback data, called after the last dispatch)
+static void releasePipeline( void* user_data )
+{
+	gstPipelineManager::Pipeline* pipeline = (gstPipelineManager::Pipeline*)user_data;
+
+	Metrics::Release(pipeline->errorsMetric);
+	Metrics::Release(pipeline->qosMetric);
+	Metrics::Release(pipeline->latencyMetric);
+	Metrics::Release(pipeline->stateMetric);
+
+	gst_object_unref(pipeline->element);
+	delete pipeline;
+}
+
+
+// Register
+bool gstPipelineManager::Register( GstElement* element, const char* name, Callback callback, void* user_data )
+{
+	if( !element )
+		return false;
+
+	if( !name )
+		name = GST_ELEMENT_NAME(element);
+
+	GstBus* bus = gst_element_get_bus(element);
+
+	if( !bus )
+	{
+		LogError(LOG_GSTREAMER "gstPipelineManager -- failed to retrieve GstBus from pipeline '%s'\n", name);
+		return false;
+	}
+
+	gPipelineMutex.Lock();
+
+	if( !init() )
+	{
+		gPipelineMutex.Unlock();
+		gst_object_unref(bus);
+		return false;
+	}
+
+	if( find(element) != NULL )
+	{
+		LogError(LOG_GSTREAMER "gstPipelineManager -- pipeline '%s' is already registered\n", name);
+		gPipelineMutex.Unlock();
+		gst_object_unref(bus);
+		return false;
+	}
+
+	const std::string labels = Metrics::Label("pipeline", name);
+
+	Pipeline* pipeline = new Pipeline();
+
+	pipeline->element   = (GstElement*)gst_object_ref(element);
+	pipeline->name      = name;
+	pipeline->callback  = callback;
+	pipeline->user_data = user_data;
+	pipeline->removed   = false;
+	pipeline->dispatching = false;
+
+	pipeline->health.state       = GST_STATE_NULL;
+	pipeline->health.eos         = false;
+	pipeline->health.errors      = 0;
+	pipeline->health.warnings    = 0;
+	pipeline->health.qosEvents   = 0;
+	pipeline->health.jitter      = 0.0;
+	pipeline->health.latency     = 0.0;
+	pipeline->health.lastMessage = timeZero();
+
+	pipeline->errorsMetric  = Metrics::Counter("jetson_pipeline_errors_total", "Number of error messages posted by the pipeline", labels.c_str());
+	pipeline->qosMetric     = Metrics::Counter("jetson_pipeline_qos_events_total", "Number of QoS messages (dropped or late buffers) posted by the pipeline", labels.c_str());
+	pipeline->latencyMetric = Metrics::Gauge("jetson_pipeline_latency_seconds", "Minimum latency of the pipeline", labels.c_str());
+	pipeline->stateMetric   = Metrics::Gauge("jetson_pipeline_state", "State of the pipeline (0=pending, 1=NULL, 2=READY, 3=PAUSED, 4=PLAYING)", labels.c_str());
+
+	pipeline->stateMetric->Set(GST_STATE_NULL);
+
+	// dispatch the bus messages from the manager's thread
+	pipeline->watch = gst_bus_create_watch(bus);
+
+	g_source_set_callback(pipeline->watch, (GSourceFunc)onBusMessage, pipeline, releasePipeline);
+	g_source_attach(pipeline->watch, gPipelineContext);
+
+	gPipelines.push_back(pipeline);
+
+	LogVerbose(LOG_GSTREAMER "gstPipelineManager -- registered pipeline '%s' (%zu pipelines)\n", name, gPipelines.size());
+	gPipelineMutex.Unlock();
+
+	gst_object_unref(bus);
+	return true;
+}
+
+
+// Unregister
+void gstPipelineManager::Unregister( GstElement* element )
+{
+	if( !element )
+		return;
+
+	gPipelineMutex.Lock();
+
+	Pipeline* pipeline = find(element);
+
+	if( !pipeline )
+	{
+		gPipelineMutex.Unlock();
+		return;
+	}
+
+	for( size_t n=0; n < gPipelines.size(); n++ )
+	{
+		if( gPipelines[n] == pipeline )
+		{
+			gPipelines.erase(gPipelines.begin() + n);
+			break;
+		}
+	}
+
+	LogVerbose(LOG_GSTREAMER "gstPipelineManager -- unregistered pipeline '%s' (%zu pipelines)\n", pipeline->name.c_str(), gPipelines.size());
+
+	// the pipeline is freed by releasePipeline() once GLib is done with the watch
+	pipeline->removed = true;
+
+	// wait for the callback to return (unless this was called from a callback,
+	// in which case the manager's thread isn't dispatching any other pipeline)
+	if( !g_main_context_is_owner(gPipelineContext) )
+	{
+		while( pipeline->dispatching )
+			pthread_cond_wait(&gDispatchCond, gPipelineMutex.GetID());
+	}
+
+	GSource* watch = pipeline->watch;
+
+	g_source_destroy(watch);
+	gPipelineMutex.Unlock();
+
+	g_source_unref(watch);
+}
+
+
+// find
+gstPipelineManager::Pipeline* gstPipelineManager::find( GstElement* element )
+{
+	const size_t numPipelines = gPipelines.size();
+
+	for( size_t n=0; n < numPipelines; n++ )
+	{
+		if( gPipelines[n]->element == element )
+			return gPipelines[n];
+	}
+
+	return NULL;
+}
+
+
+// GetHealth
+bool gstPipelineManager::GetHealth( GstElement* element, gstPipelineHealth* health )
+{
+	if( !element || !health )
+		return false;
+
+	gPipelineMutex.Lock();
+
+	Pipeline* pipeline = find(element);
+
+	if( pipeline != NULL )
+		*health = pipeline->health;
+
+	gPipelineMutex.Unlock();
+	return (pipeline != NULL);
+}
+
+
+// GetHealth
+bool gstPipelineManager::GetHealth( const char* name, gstPipelineHealth* health )
+{
+	if( !name || !health )
+		return false;
+
+	gPipelineMutex.Lock();
+
+	Pipeline* pipeline = NULL;
+
+	for( size_t n=0; n < gPipelines.size(); n++ )
+	{
+		if( gPipelines[n]->name == name )
+		{
+			pipeline = gPipelines[n];
+			break;
+		}
+	}
+
+	if( pipeline != NULL )
+		*health = pipeline->health;
+
+	gPipelineMutex.Unlock();
+	return (pipeline != NULL);
+}
+
+
+// GetNumPipelines
+uint32_t gstPipelineManager::GetNumPipelines()
+{
+	gPipelineMutex.Lock();
+	const uint32_t numPipelines = gPipelines.size();
+	gPipelineMutex.Unlock();
+
+	return numPipelines;
+}
+
+
+// queryLatency
+static double queryLatency( GstElement* element )
+{
+	GstQuery* query = gst_query_new_latency();
+	double latency = -1.0;
+
+	if( gst_element_query(element, query) )
+	{
+		gboolean live = false;
+		GstClockTime minLatency = 0;
+		GstClockTime maxLatency = 0;
+
+		gst_query_parse_latency(query, &live, &minLatency, &maxLatency);
+
+		if( GST_CLOCK_TIME_IS_VALID(minLatency) )
+			latency = double(minLatency) / double(GST_MSECOND);
+	}
+
+	gst_query_unref(query);
+	return latency;
+}
+
+
+// onBusMessage
+gboolean gstPipelineManager::onBusMessage( GstBus* bus, GstMessage* message, void* user_data )
+{
+	Pipeline* pipeline = (Pipeline*)user_data;
+
+	gPipelineMutex.Lock();
+
+	if( pipeline->removed )
+	{
+		gPipelineMutex.Unlock();
+		return false;
+	}
+
+	bool checkLatency = false;
+
+	gstPipelineHealth& health = pipeline->health;
+	health.lastMessage = timestamp();
+
+	switch( GST_MESSAGE_TYPE(message) )
+	{
+		case GST_MESSAGE_ERROR:
+		{
+			GError* err = NULL;
+			gst_message_parse_error(message, &err, NULL);
+
+			health.errors++;
+			health.lastError = (err != NULL) ? err->message : "unknown error";
+
+			pipeline->errorsMetric->Increment();
+
+			if( err != NULL )
+				g_error_free(err);
+
+			break;
+		}
+		case GST_MESSAGE_WARNING:
+		{
+			health.warnings++;
+			break;
+		}
+		case GST_MESSAGE_EOS:
+		{
+			health.eos = true;
+			break;
+		}
+		case GST_MESSAGE_STATE_CHANGED:
+		{
+			if( GST_MESSAGE_SRC(message) == GST_OBJECT(pipeline->element) )
+			{
+				GstState newState = GST_STATE_NULL;
+				gst_message_parse_state_changed(message, NULL, &newState, NULL);
+
+				health.state = newState;
+				pipeline->stateMetric->Set(newState);
+
+				if( newState == GST_STATE_PLAYING )
+					health.eos = false;
+			}
+
+			break;
+		}
+		case GST_MESSAGE_QOS:
+		{
+			gint64 jitter = 0;
+			gst_message_parse_qos_values(message, &jitter, NULL, NULL);
+
+			health.qosEvents++;
+			health.jitter = double(jitter) / double(GST_MSECOND);
+
+			pipeline->qosMetric->Increment();
+			break;
+		}
+		case GST_MESSAGE_LATENCY:
+		case GST_MESSAGE_ASYNC_DONE:
+		{
+			checkLatency = true;
+			break;
+		}
+		default:
+			break;
+	}
+
+	// the rest runs without the lock, so that a slow pipeline doesn't stall the others
+	// and the callback can use the manager (Unregister() waits for it to return)
+	pipeline->dispatching = true;
+	gPipelineMutex.Unlock();
+
+	double latency = -1.0;
+
+	if( checkLatency )
+	{
+		// an element's latency changed, so redistribute it (this is what GstPipeline expects the application to do)
+		if( GST_MESSAGE_TYPE(message) == GST_MESSAGE_LATENCY )
+			gst_bin_recalculate_latency(GST_BIN(pipeline->element));
+
+		latency = queryLatency(pipeline->element);
+	}
+
+	gst_message_print(bus, message, pipeline->user_data);
+
+	if( pipeline->callback != NULL )
+		pipeline->callback(message, pipeline->user_data);
+
+	gPipelineMutex.Lock();
+
+	if( latency >= 0.0 )
+	{
+		health.latency = latency;
+		pipeline->latencyMetric->Set(latency / 1000.0);
+	}
+
+	pipeline->dispatching = false;
+	pthread_cond_broadcast(&gDispatchCond);
+
+	const bool removed = pipeline->removed;
+	gPipelineMutex.Unlock();
+
+	return !removed;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __GSTREAMER_PIPELINE_MANAGER_H__
+#define __GSTREAMER_PIPELINE_MANAGER_H__
+
+#include "gstUtility.h"
+
+#include <string>
+
+
+/**
+ * Health of a pipeline that's registered with gstPipelineManager,
+ * which is updated from the messages posted on the pipeline's bus.
+ * @ingroup codec
+ */
+struct gstPipelineHealth
+{
+	GstState    state;		/**< Current state of the pipeline */
+	bool        eos;			/**< True if the pipeline posted end-of-stream */
+	uint32_t    errors;		/**< Number of error messages */
+	uint32_t    warnings;		/**< Number of warning messages */
+	uint64_t    qosEvents;	/**< Number of QoS messages (buffers that were dropped or late) */
+	double      jitter;		/**< Jitter reported by the last QoS message (in milliseconds, negative when early) */
+	double      latency;		/**< Minimum latency of the pipeline from the last latency query (in milliseconds) */
+	timespec    lastMessage;	/**< Time of the last message from the pipeline */
+	std::string lastError;	/**< Text of the last error message */
+};
+
+
+/**
+ * Service that dispatches the bus messages of all the GStreamer pipelines from
+ * a single GLib main context thread, instead of each pipeline polling its own bus.
+ *
+ * gstDecoder, gstEncoder and gstCamera register their pipelines when they're created.
+ * The messages are printed (like gst_message_print()), used to keep track of the
+ * health of each pipeline, and passed to an optional callback for each pipeline.
+ * The health is also exported as `jetson_pipeline_*` metrics, labeled by pipeline name.
+ *
+ * The thread is started when the first pipeline is registered.  Callbacks are run
+ * from that thread, so they should return quickly, but they aren't run under the
+ * manager's lock and can call Register(), Unregister() and GetHealth().
+ * After Unregister() returns, the pipeline's callback won't be called.
+ *
+ * @ingroup codec
+ */
+class gstPipelineManager
+{
+public:
+	/**
+	 * Function that's called from the manager's thread for each message on a pipeline's bus.
+	 */
+	typedef void (*Callback)( GstMessage* message, void* user_data );
+
+	/**
+	 * Start dispatching the messages of a pipeline.
+	 * @param pipeline the pipeline (a reference is held until it's unregistered).
+	 * @param name name of the pipeline, used in the metrics and GetHealth() (for example, its URI).
+	 * @param callback optional function to call for each message.
+	 * @param user_data pointer that's passed to the callback.
+	 */
+	static bool Register( GstElement* pipeline, const char* name, Callback callback=NULL, void* user_data=NULL );
+
+	/**
+	 * Stop dispatching the messages of a pipeline.
+	 * This waits for its callback to return, if it's running on another thread
+	 * (when it's called from a callback, it returns without waiting).
+	 */
+	static void Unregister( GstElement* pipeline );
+
+	/**
+	 * Retrieve the health of a registered pipeline.
+	 * @returns false if the pipeline isn't registered.
+	 */
+	static bool GetHealth( GstElement* pipeline, gstPipelineHealth* health );
+
+	/**
+	 * Retrieve the health of a registered pipeline by its name.
+	 * @returns false if there isn't a pipeline registered with that name.
+	 */
+	static bool GetHealth( const char* name, gstPipelineHealth* health );
+
+	/**
+	 * Return the number of registered pipelines.
+	 */
+	static uint32_t GetNumPipelines();
+
+	/**
+	 * Return the GLib main context that the manager's thread runs.
+	 * Other sources (like timers) can be attached to it, so they run on the same thread.
+	 */
+	static GMainContext* GetContext();
+
+	/**
+	 * A registered pipeline.
+	 * @internal
+	 */
+	struct Pipeline;
+
+protected:
+	static bool init();
+	static Pipeline* find( GstElement* pipeline );
+	static void* runThread( void* user_data );
+	static gboolean onBusMessage( GstBus* bus, GstMessage* message, void* user_data );
+};
+
+#endif
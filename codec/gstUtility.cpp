@@ -25,11 +25,17 @@
 
 #include "NvInfer.h"
 #include "logging.h"
+#include "metrics.h"
+#include "Thread.h"
+#include "Mutex.h"
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <strings.h>
 #include <algorithm>
+#include <map>
+#include <string>
 
 
 //---------------------------------------------------------------------------------------------
@@ -204,20 +210,29 @@ void rilog_debug_function(GstDebugCategory* category, GstDebugLevel level,
 }
 
 
+static Mutex gstreamer_mutex;
+static bool  gstreamer_initialized = false;
+
+
 // gstreamerInit
 bool gstreamerInit()
 {
-	static bool gstreamer_initialized = false;
+	gstreamer_mutex.Lock();
 
 	if( gstreamer_initialized )
+	{
+		gstreamer_mutex.Unlock();
 		return true;
+	}
 
+	const timespec start = timestamp();
 	int argc = 0;
 	//char* argv[] = { "none" };
 
 	if( !gst_init_check(&argc, NULL, NULL) )
 	{
 		LogError(LOG_GSTREAMER "failed to initialize gstreamer library with gst_init()\n");
+		gstreamer_mutex.Unlock();
 		return false;
 	}
 
@@ -229,20 +244,219 @@ bool gstreamerInit()
 	LogInfo(LOG_GSTREAMER "initialized gstreamer, version %u.%u.%u.%u\n", ver[0], ver[1], ver[2], ver[3]);
 
 
-	// debugging
+	// debugging (rilog_debug_function only prints warnings and errors, with LogVerbose)
 	gst_debug_remove_log_function(gst_debug_log_default);
 	
-	if( true )
+	if( Log::GetLevel() >= Log::VERBOSE )
 	{
 		gst_debug_add_log_function(rilog_debug_function, NULL, NULL);
 
 		gst_debug_set_active(true);
 		gst_debug_set_colored(false);
+
+		// skip formatting the messages that would be filtered anyway (unless $GST_DEBUG was set)
+		if( !getenv("GST_DEBUG") )
+			gst_debug_set_default_threshold(GST_LEVEL_WARNING);
+	}
+	else
+	{
+		gst_debug_set_active(false);
 	}
 	
+	gstreamer_mutex.Unlock();
+	gst_startup_phase(GST_STARTUP_INIT, start);
+
 	return true;
 }
 
+
+// elements whose plugins are loaded by gstreamerPrewarm()
+static const char* gst_prewarm_elements[] = 
+{
+	"appsrc", "appsink", "queue", "tee", "capsfilter", "videoconvert", "videoscale", "videorate",
+	"filesrc", "filesink", "v4l2src", "rtspsrc", "udpsrc", "udpsink",
+	"h264parse", "h265parse", "qtdemux", "matroskademux", "qtmux", "matroskamux",
+	"rtph264depay", "rtph265depay", "rtph264pay", "rtph265pay",
+#if defined(__aarch64__)
+	"nvvidconv", "nvarguscamerasrc",
+#endif
+	NULL
+};
+
+
+// gst_prewarm_thread
+static void* gst_prewarm_thread( void* user_data )
+{
+	if( !gstreamerInit() )
+		return NULL;
+
+	const timespec start = timestamp();
+	uint32_t numLoaded = 0;
+
+	for( uint32_t n=0; gst_prewarm_elements[n] != NULL; n++ )
+	{
+		if( gst_element_available(gst_prewarm_elements[n]) )
+			numLoaded++;
+	}
+
+	// the default decoders and encoders
+	const videoOptions::Codec codecs[] = { videoOptions::CODEC_H264, videoOptions::CODEC_H265 };
+
+	for( uint32_t n=0; n < sizeof(codecs) / sizeof(codecs[0]); n++ )
+	{
+		videoOptions::CodecType decoderType = gst_default_codec();
+		videoOptions::CodecType encoderType = gst_default_codec();
+
+		if( gst_element_available(gst_select_decoder(codecs[n], decoderType)) )
+			numLoaded++;
+
+		if( gst_element_available(gst_select_encoder(codecs[n], encoderType)) )
+			numLoaded++;
+	}
+
+	LogVerbose(LOG_GSTREAMER "pre-warmed %u elements in %.1f ms\n", numLoaded, timeDouble(timeDiff(start, timestamp())));
+	return NULL;
+}
+
+
+// gstreamerPrewarm
+bool gstreamerPrewarm()
+{
+	static Thread* thread = NULL;	// runs once (and isn't joined, it's a background task)
+
+	gstreamer_mutex.Lock();
+
+	if( thread != NULL )
+	{
+		gstreamer_mutex.Unlock();
+		return true;
+	}
+
+	thread = new Thread();
+	gstreamer_mutex.Unlock();
+
+	if( !thread->Start(gst_prewarm_thread) )
+	{
+		LogError(LOG_GSTREAMER "failed to start the plugin pre-warming thread\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+// gst_element_available
+bool gst_element_available( const char* name )
+{
+	static std::map<std::string, bool> cache;
+
+	if( !name || !gstreamerInit() )
+		return false;
+
+	gstreamer_mutex.Lock();
+
+	const std::map<std::string, bool>::const_iterator cached = cache.find(name);
+
+	if( cached != cache.end() )
+	{
+		const bool available = cached->second;
+		gstreamer_mutex.Unlock();
+		return available;
+	}
+
+	gstreamer_mutex.Unlock();
+
+	// load the plugin now, so that the pipeline doesn't have to when it's created
+	const timespec start = timestamp();
+
+	GstElementFactory* factory = gst_element_factory_find(name);
+	bool available = false;
+
+	if( factory != NULL )
+	{
+		GstPluginFeature* loaded = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+
+		if( loaded != NULL )
+		{
+			available = true;
+			gst_object_unref(loaded);
+		}
+
+		gst_object_unref(factory);
+	}
+
+	gst_startup_phase(GST_STARTUP_REGISTRY, start);
+
+	gstreamer_mutex.Lock();
+	cache[name] = available;
+	gstreamer_mutex.Unlock();
+
+	return available;
+}
+
+
+//---------------------------------------------------------------------------------------------
+static const char* gst_startup_phase_names[] = { "init", "registry", "select", "preroll" };
+
+static double gst_startup_times[GST_STARTUP_PHASES] = { 0 };	// in milliseconds
+static bool   gst_startup_reported = false;
+
+
+// gst_startup_phase
+void gst_startup_phase( gstStartupPhase phase, const timespec& start )
+{
+	static MetricHistogram* metrics[GST_STARTUP_PHASES] = { NULL };
+
+	if( phase >= GST_STARTUP_PHASES )
+		return;
+
+	const double elapsed = timeDouble(timeDiff(start, timestamp()));
+
+	gstreamer_mutex.Lock();
+
+	gst_startup_times[phase] += elapsed;
+
+	if( !metrics[phase] )
+		metrics[phase] = Metrics::Histogram("jetson_gstreamer_startup_seconds", "Time taken by each phase of GStreamer startup", 
+									 Metrics::Label("phase", gst_startup_phase_names[phase]).c_str());
+
+	gstreamer_mutex.Unlock();
+
+	metrics[phase]->Observe(elapsed / 1000.0);
+}
+
+
+// gst_startup_report
+void gst_startup_report()
+{
+	gstreamer_mutex.Lock();
+
+	if( gst_startup_reported )
+	{
+		gstreamer_mutex.Unlock();
+		return;
+	}
+
+	double times[GST_STARTUP_PHASES];
+	double total = 0.0;
+
+	for( uint32_t n=0; n < GST_STARTUP_PHASES; n++ )
+	{
+		times[n] = gst_startup_times[n];
+		total += times[n];
+	}
+
+	gst_startup_reported = true;
+	gstreamer_mutex.Unlock();
+
+	LogVerbose(LOG_GSTREAMER "startup timing (ms):\n");
+
+	for( uint32_t n=0; n < GST_STARTUP_PHASES; n++ )
+		LogVerbose(LOG_GSTREAMER "   %-10s %8.1f\n", gst_startup_phase_names[n], times[n]);
+
+	LogVerbose(LOG_GSTREAMER "   %-10s %8.1f\n", "total", total);
+}
+
 //---------------------------------------------------------------------------------------------
 static void gst_print_one_tag(const GstTagList * list, const gchar * tag, gpointer user_data)
 {
@@ -436,8 +650,8 @@ bool gst_build_filesink( const URI& uri, videoOptions::Codec codec, std::ostring
 }
 
 
-// gst_select_decoder
-const char* gst_select_decoder( videoOptions::Codec codec, videoOptions::CodecType& type )
+// select_decoder
+static const char* select_decoder( videoOptions::Codec codec, videoOptions::CodecType& type )
 {
 #if defined(__aarch64__)
 #if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 4)
@@ -510,7 +724,7 @@ const char* gst_select_decoder( videoOptions::Codec codec, videoOptions::CodecTy
 
 
 // check for hardware-accelerated encoder support
-static bool gst_query_hw_encoder()
+static bool gst_probe_hw_encoder()
 {
 #if defined(__aarch64__)
 	std::string board = readFile("/proc/device-tree/model");
@@ -537,9 +751,16 @@ static bool gst_query_hw_encoder()
 #endif
 }
 
+// the board doesn't change, so it only gets probed once
+static bool gst_query_hw_encoder()
+{
+	static const bool has_hw_encoder = gst_probe_hw_encoder();
+	return has_hw_encoder;
+}
 
-// gst_select_encoder
-const char* gst_select_encoder( videoOptions::Codec codec, videoOptions::CodecType& type )
+
+// select_encoder
+static const char* select_encoder( videoOptions::Codec codec, videoOptions::CodecType& type )
 {
 #if defined(__aarch64__)
 #if NV_TENSORRT_MAJOR > 8 || (NV_TENSORRT_MAJOR == 8 && NV_TENSORRT_MINOR >= 4)
@@ -619,6 +840,58 @@ const char* gst_select_encoder( videoOptions::Codec codec, videoOptions::CodecTy
 }
 
 
+// gst_select_decoder
+const char* gst_select_decoder( videoOptions::Codec codec, videoOptions::CodecType& type )
+{
+	const timespec start = timestamp();
+	const char* decoder = select_decoder(codec, type);
+
+	gst_startup_phase(GST_STARTUP_SELECT, start);
+
+	// revert to the CPU decoder if the hardware decoder's plugin isn't installed
+	if( decoder != NULL && type != videoOptions::CODEC_CPU && !gst_element_available(decoder) )
+	{
+		videoOptions::CodecType cpuType = videoOptions::CODEC_CPU;
+		const char* cpuDecoder = select_decoder(codec, cpuType);
+
+		if( cpuDecoder != NULL && gst_element_available(cpuDecoder) )
+		{
+			LogWarning(LOG_GSTREAMER "gstDecoder -- %s element not found, reverting to CPU decoder (%s)\n", decoder, cpuDecoder);
+			decoder = cpuDecoder;
+			type = cpuType;
+		}
+	}
+
+	return decoder;
+}
+
+
+// gst_select_encoder
+const char* gst_select_encoder( videoOptions::Codec codec, videoOptions::CodecType& type )
+{
+	const timespec start = timestamp();
+	const char* encoder = select_encoder(codec, type);
+
+	gst_startup_phase(GST_STARTUP_SELECT, start);
+
+	// revert to the CPU encoder if the hardware encoder's plugin isn't installed
+	if( encoder != NULL && type != videoOptions::CODEC_CPU && !gst_element_available(encoder) )
+	{
+		videoOptions::CodecType cpuType = videoOptions::CODEC_CPU;
+		const char* cpuEncoder = select_encoder(codec, cpuType);
+
+		if( cpuEncoder != NULL && gst_element_available(cpuEncoder) )
+		{
+			LogWarning(LOG_GSTREAMER "gstEncoder -- %s element not found, reverting to CPU encoder (%s)\n", encoder, cpuEncoder);
+			encoder = cpuEncoder;
+			type = cpuType;
+		}
+	}
+
+	return encoder;
+}
+
+
 // gst_default_codec_type
 videoOptions::CodecType gst_default_codec()
 {
@@ -27,6 +27,7 @@
 #include <sstream>
 
 #include "videoOptions.h"
+#include "timespec.h"
 #include "NvInfer.h"
 
 
@@ -39,11 +40,64 @@
 
 /**
  * gstreamerInit
+ *
+ * Initializes GStreamer the first time it's called (it's safe to call from multiple threads).
+ * GStreamer's debug messages are only forwarded to the log when the log level is `VERBOSE`
+ * or higher - otherwise the GStreamer debug system is disabled, so that the debug macros
+ * in the elements don't cost anything while streaming.
+ *
  * @internal
  * @ingroup codec
  */
 bool gstreamerInit();
 
+/**
+ * gstreamerPrewarm
+ *
+ * Initialize GStreamer and load the plugins of the commonly-used elements (sources, sinks,
+ * parsers and the default decoders/encoders) in a background thread, so that the first
+ * pipeline doesn't have to wait for them.  Call this early during application startup,
+ * before creating videoSource or videoOutput streams.  It only runs once.
+ *
+ * @ingroup codec
+ */
+bool gstreamerPrewarm();
+
+/**
+ * Phases of GStreamer startup that are timed and printed by gst_startup_report()
+ * @internal
+ * @ingroup codec
+ */
+enum gstStartupPhase
+{
+	GST_STARTUP_INIT = 0,	/**< gst_init() and reading the plugin registry */
+	GST_STARTUP_REGISTRY,	/**< loading plugins of the elements (from gstreamerPrewarm() or gst_element_available()) */
+	GST_STARTUP_SELECT,		/**< selecting the decoder/encoder elements and probing the hardware */
+	GST_STARTUP_PREROLL,	/**< transitioning the pipelines to PLAYING when streams are opened */
+	GST_STARTUP_PHASES
+};
+
+/**
+ * gst_startup_phase (adds the time since start to the phase)
+ * @internal
+ * @ingroup codec
+ */
+void gst_startup_phase( gstStartupPhase phase, const timespec& start );
+
+/**
+ * gst_startup_report (logs the startup timing the first time a stream is ready)
+ * @internal
+ * @ingroup codec
+ */
+void gst_startup_report();
+
+/**
+ * gst_element_available (checks the registry for an element factory, the result is cached)
+ * @internal
+ * @ingroup codec
+ */
+bool gst_element_available( const char* name );
+
 /**
  * gst_message_print
  * @internal
@@ -94,7 +148,7 @@ bool gst_build_filesink( const URI& uri, videoOptions::Codec codec, std::ostring
 const char* gst_select_decoder( videoOptions::Codec codec, videoOptions::CodecType& type );
 
 /**
- * gst_select_decoder
+ * gst_select_encoder
  * @internal
  * @ingroup codec
  */
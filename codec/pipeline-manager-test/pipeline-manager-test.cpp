@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gstPipelineManager.h"
+
+#include "timespec.h"
+#include "logging.h"
+#include "commandLine.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+
+
+int usage()
+{
+	printf("usage: pipeline-manager-test [--help] [--pipelines=N] [--frames=N] [--timeout=SECONDS]\n\n");
+	printf("Check that gstPipelineManager dispatches the messages of many pipelines from one thread.\n");
+	printf("N videotestsrc pipelines are registered with the manager:  all but one of them stream\n");
+	printf("a number of frames until EOS, and the last one fails caps negotiation with an error.\n");
+	printf("The state, EOS, errors and latency must reach gstPipelineManager::GetHealth(),\n");
+	printf("every callback must run on the manager's thread, and the callbacks must be able\n");
+	printf("to call GetHealth() themselves (returns 1 on failure).\n\n");
+	printf("optional arguments:\n");
+	printf("  --pipelines=N     number of pipelines to run (default is 4, the minimum is 2)\n");
+	printf("  --frames=N        number of frames each pipeline streams before EOS (default is 60)\n");
+	printf("  --timeout=SEC     number of seconds to wait for the pipelines (default is 10)\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// a pipeline under test, and what its callback saw
+struct testPipeline
+{
+	GstElement* pipeline;
+	std::string name;
+	bool expectError;
+
+	uint32_t messages;
+	uint32_t wrongThread;	// messages that were dispatched from another thread
+	bool     sawPlaying;
+	bool     sawEOS;
+	bool     sawError;
+	bool     sawHealth;		// GetHealth() could be called from the callback
+
+	pthread_t thread;		// thread that the callback last ran on
+};
+
+
+// the manager's main context
+static GMainContext* gManagerContext = NULL;
+
+
+// callback for each message on a pipeline's bus
+static void onMessage( GstMessage* message, void* user_data )
+{
+	testPipeline* test = (testPipeline*)user_data;
+
+	test->messages++;
+	test->thread = pthread_self();
+
+	// the manager's thread owns its main context while it's dispatching
+	if( !g_main_context_is_owner(gManagerContext) )
+		test->wrongThread++;
+
+	switch( GST_MESSAGE_TYPE(message) )
+	{
+		case GST_MESSAGE_EOS:
+		case GST_MESSAGE_ERROR:
+		{
+			// the callback can use the manager (the health was updated before it's called)
+			gstPipelineHealth health;
+
+			if( gstPipelineManager::GetHealth(test->pipeline, &health) )
+				test->sawHealth = (GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS) ? health.eos : (health.errors > 0);
+
+			if( GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS )
+				test->sawEOS = true;
+			else
+				test->sawError = true;
+
+			break;
+		}
+		case GST_MESSAGE_STATE_CHANGED:
+		{
+			if( GST_MESSAGE_SRC(message) == GST_OBJECT(test->pipeline) )
+			{
+				GstState newState = GST_STATE_NULL;
+				gst_message_parse_state_changed(message, NULL, &newState, NULL);
+
+				if( newState == GST_STATE_PLAYING )
+					test->sawPlaying = true;
+			}
+
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+
+// create and register a pipeline
+static bool startPipeline( testPipeline* test, uint32_t frames )
+{
+	std::ostringstream ss;
+
+	ss << "videotestsrc is-live=true num-buffers=" << frames << " ! ";
+
+	// the capsfilters link, but can't agree on a format once the stream starts
+	if( test->expectError )
+		ss << "capsfilter caps=video/x-raw,format=RGB ! capsfilter caps=video/x-raw,format=I420 ! ";
+	else
+		ss << "video/x-raw,width=320,height=240,framerate=30/1 ! ";
+
+	ss << "fakesink sync=true";
+
+	GError* err = NULL;
+	test->pipeline = gst_parse_launch(ss.str().c_str(), &err);
+
+	if( err != NULL )
+	{
+		LogError("pipeline-manager-test:  failed to create pipeline '%s'\n", test->name.c_str());
+		LogError("pipeline-manager-test:     (%s)\n", err->message);
+		g_error_free(err);
+		return false;
+	}
+
+	if( !gstPipelineManager::Register(test->pipeline, test->name.c_str(), onMessage, test) )
+	{
+		LogError("pipeline-manager-test:  failed to register pipeline '%s'\n", test->name.c_str());
+		return false;
+	}
+
+	if( gst_element_set_state(test->pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE && !test->expectError )
+	{
+		LogError("pipeline-manager-test:  failed to start pipeline '%s'\n", test->name.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+// check if a pipeline has finished (by EOS or by error)
+static bool isFinished( testPipeline* test )
+{
+	gstPipelineHealth health;
+
+	if( !gstPipelineManager::GetHealth(test->pipeline, &health) )
+		return true;
+
+	return test->expectError ? (health.errors > 0) : health.eos;
+}
+
+
+// check the health and callbacks of a pipeline (after it was unregistered, so the callback isn't running)
+static bool checkPipeline( testPipeline* test, const gstPipelineHealth& health, pthread_t mainThread )
+{
+	bool result = true;
+
+	#define check(condition, format, ...)	\
+		if( !(condition) ) { LogError("pipeline-manager-test:  '%s' " format, test->name.c_str(), ##__VA_ARGS__); result = false; }
+
+	if( test->expectError )
+	{
+		check(health.errors > 0, "didn't report its error in GetHealth()\n");
+		check(health.lastError.length() > 0, "didn't report the text of its error in GetHealth()\n");
+		check(!health.eos, "reported EOS in GetHealth() after failing\n");
+		check(test->sawError, "didn't pass its error to the callback\n");
+	}
+	else
+	{
+		check(health.state == GST_STATE_PLAYING, "is in state %s instead of PLAYING\n", gst_element_state_get_name(health.state));
+		check(health.eos, "didn't report EOS in GetHealth()\n");
+		check(health.errors == 0, "reported %u errors in GetHealth() (%s)\n", health.errors, health.lastError.c_str());
+		check(health.latency > 0.0, "didn't report the latency of the live source in GetHealth()\n");
+		check(test->sawPlaying, "didn't pass its state change to PLAYING to the callback\n");
+		check(test->sawEOS, "didn't pass its EOS to the callback\n");
+	}
+
+	check(test->sawHealth, "couldn't get its health from the callback\n");
+	check(test->messages > 0, "didn't have any messages passed to the callback\n");
+	check(test->wrongThread == 0, "had %u of %u callbacks run outside of the manager's thread\n", test->wrongThread, test->messages);
+	check(test->messages == 0 || !pthread_equal(test->thread, mainThread), "had its callback run on the main thread\n");
+
+	#undef check
+
+	if( result )
+		LogSuccess("pipeline-manager-test:  '%s' passed (%u messages, latency %.1f ms, %s)\n", test->name.c_str(), test->messages,
+				 health.latency, test->expectError ? health.lastError.c_str() : "EOS");
+
+	return result;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	const uint32_t numPipelines = cmdLine.GetUnsignedInt("pipelines", 4);
+	const uint32_t numFrames = cmdLine.GetUnsignedInt("frames", 60);
+	const float timeout = cmdLine.GetFloat("timeout", 10.0f);
+
+	if( numPipelines < 2 || numFrames == 0 )
+		return usage();
+
+	if( !gstreamerInit() )
+	{
+		LogError("pipeline-manager-test:  failed to initialize gstreamer\n");
+		return 1;
+	}
+
+	// this starts the manager's thread
+	gManagerContext = gstPipelineManager::GetContext();
+
+	if( !gManagerContext )
+	{
+		LogError("pipeline-manager-test:  failed to start the pipeline manager\n");
+		return 1;
+	}
+
+
+	/*
+	 * start the pipelines (the last one fails with an error)
+	 */
+	std::vector<testPipeline*> tests;
+	int result = 0;
+
+	for( uint32_t n=0; n < numPipelines; n++ )
+	{
+		testPipeline* test = new testPipeline();
+
+		std::ostringstream name;
+		name << "pipeline-manager-test-" << n;
+
+		test->pipeline    = NULL;
+		test->name        = name.str();
+		test->expectError = (n == numPipelines - 1);
+		test->messages    = 0;
+		test->wrongThread = 0;
+		test->sawPlaying  = false;
+		test->sawEOS      = false;
+		test->sawError    = false;
+		test->sawHealth   = false;
+
+		tests.push_back(test);
+
+		if( !startPipeline(test, numFrames) )
+			result = 1;
+	}
+
+	if( gstPipelineManager::GetNumPipelines() != numPipelines )
+	{
+		LogError("pipeline-manager-test:  %u of %u pipelines are registered with the manager\n", gstPipelineManager::GetNumPipelines(), numPipelines);
+		result = 1;
+	}
+
+
+	/*
+	 * wait for all of the pipelines to finish
+	 */
+	const timespec begin = timestamp();
+
+	while( result == 0 )
+	{
+		bool finished = true;
+
+		for( size_t n=0; n < tests.size(); n++ )
+			finished = finished && isFinished(tests[n]);
+
+		if( finished )
+			break;
+
+		if( timeFloat(timeDiff(begin, timestamp())) > timeout * 1000.0f )
+		{
+			LogError("pipeline-manager-test:  timed out after %.1f seconds waiting for the pipelines to finish\n", timeout);
+			result = 1;
+			break;
+		}
+
+		usleep(10 * 1000);
+	}
+
+	LogInfo("pipeline-manager-test:  %zu pipelines finished in %.2fs\n", tests.size(), timeFloat(timeDiff(begin, timestamp())) * 0.001f);
+
+
+	/*
+	 * check what reached the manager and the callbacks, and destroy the pipelines
+	 */
+	const pthread_t mainThread = pthread_self();
+
+	for( size_t n=0; n < tests.size(); n++ )
+	{
+		testPipeline* test = tests[n];
+		gstPipelineHealth health;
+
+		if( !gstPipelineManager::GetHealth(test->name.c_str(), &health) )
+		{
+			LogError("pipeline-manager-test:  '%s' isn't registered with the manager\n", test->name.c_str());
+			result = 1;
+		}
+		else
+		{
+			gstPipelineManager::Unregister(test->pipeline);	// waits for the callback to return
+
+			if( !checkPipeline(test, health, mainThread) )
+				result = 1;
+		}
+
+		if( test->pipeline != NULL )
+		{
+			gst_element_set_state(test->pipeline, GST_STATE_NULL);
+			gst_object_unref(test->pipeline);
+		}
+
+		delete test;
+	}
+
+	if( gstPipelineManager::GetNumPipelines() != 0 )
+	{
+		LogError("pipeline-manager-test:  %u pipelines are still registered after unregistering them\n", gstPipelineManager::GetNumPipelines());
+		result = 1;
+	}
+
+	LogInfo("pipeline-manager-test:  %s\n", (result == 0) ? "passed" : "failed");
+	return result;
+}
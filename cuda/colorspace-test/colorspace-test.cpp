@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaColorspace.h"
+#include "cudaMappedMemory.h"
+
+#include "logging.h"
+#include "commandLine.h"
+
+#include <algorithm>
+
+#include <string.h>
+#include <math.h>
+
+
+int usage()
+{
+	printf("usage: colorspace-test [--help] [--width=W] [--height=H]\n\n");
+	printf("Check the 16-bit RGB/grayscale and NV16/P010/P016 conversions of cudaConvertColor().\n");
+	printf("Each conversion is run on the GPU with cudaConvertColor(), and on the CPU with\n");
+	printf("cudaConvertColorCPU(), and both are compared against a straightforward per-pixel\n");
+	printf("reference implementation (returns 1 on failure).  Same-format conversions must\n");
+	printf("return a copy of the input.\n\n");
+	printf("optional arguments:\n");
+	printf("  --width=W         width of the test images (default is 320)\n");
+	printf("  --height=H        height of the test images (default is 240)\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+/*
+ * Reference implementation of the conversions, written from the definitions of the
+ * formats instead of sharing the code of the kernels.  The samples are normalized to
+ * [0,1] (the float formats are in [0,255], like uint8), and integers are rounded.
+ */
+static double sampleMax( imageFormat format )
+{
+	return (imageFormatBaseType(format) == IMAGE_UINT16) ? 65535.0 : 255.0;
+}
+
+static size_t sampleSize( imageFormat format )
+{
+	const imageBaseType type = imageFormatBaseType(format);
+
+	if( type == IMAGE_UINT16 )
+		return sizeof(uint16_t);
+	else if( type == IMAGE_FLOAT )
+		return sizeof(float);
+
+	return sizeof(uint8_t);
+}
+
+static double loadSample( const void* row, imageFormat format, size_t index )
+{
+	const imageBaseType type = imageFormatBaseType(format);
+
+	if( type == IMAGE_UINT8 )
+		return ((const uint8_t*)row)[index];
+	else if( type == IMAGE_UINT16 )
+		return ((const uint16_t*)row)[index];
+
+	return ((const float*)row)[index];
+}
+
+static void storeSample( void* row, imageFormat format, size_t index, double value )
+{
+	const imageBaseType type = imageFormatBaseType(format);
+	const double maxValue = sampleMax(format);
+
+	value *= maxValue;
+
+	if( type == IMAGE_FLOAT )
+	{
+		((float*)row)[index] = value;
+		return;
+	}
+
+	value = floor(value + 0.5);
+
+	if( value < 0.0 )
+		value = 0.0;
+	else if( value > maxValue )
+		value = maxValue;
+
+	if( type == IMAGE_UINT8 )
+		((uint8_t*)row)[index] = value;
+	else
+		((uint16_t*)row)[index] = value;
+}
+
+// store a normalized RGBA pixel in any of the RGB/BGR/grayscale formats
+static void storePixel( void* row, imageFormat format, size_t x, const double rgba[4] )
+{
+	const size_t channels = imageFormatChannels(format);
+
+	if( imageFormatIsGray(format) )
+	{
+		storeSample(row, format, x, rgba[0] * 0.2989 + rgba[1] * 0.5870 + rgba[2] * 0.1140);
+		return;
+	}
+
+	const bool bgr = imageFormatIsBGR(format);
+
+	storeSample(row, format, x * channels + 0, rgba[bgr ? 2 : 0]);
+	storeSample(row, format, x * channels + 1, rgba[1]);
+	storeSample(row, format, x * channels + 2, rgba[bgr ? 0 : 2]);
+
+	if( channels == 4 )
+		storeSample(row, format, x * channels + 3, rgba[3]);
+}
+
+// RGB/BGR/grayscale to RGB/BGR/grayscale
+static void referenceRGB( const cudaImageView& input, const cudaImageView& output )
+{
+	const size_t channels = imageFormatChannels(input.format);
+	const double inputMax = sampleMax(input.format);
+	const bool bgr = imageFormatIsBGR(input.format);
+
+	for( size_t y=0; y < input.height; y++ )
+	{
+		for( size_t x=0; x < input.width; x++ )
+		{
+			double rgba[4] = { 0, 0, 0, 1 };
+
+			for( size_t c=0; c < channels; c++ )
+				rgba[c] = loadSample(input.Row<void>(y), input.format, x * channels + c) / inputMax;
+
+			if( channels == 1 )
+				rgba[1] = rgba[2] = rgba[0];
+			else if( bgr )
+				std::swap(rgba[0], rgba[2]);
+
+			storePixel(output.Row<void>(y), output.format, x, rgba);
+		}
+	}
+}
+
+// NV12, NV16, P010 and P016 to RGB/RGBA (full-range BT.601)
+static void referenceSemiPlanar( const cudaImageView& input, const cudaImageView& output )
+{
+	const double inputMax = sampleMax(input.format);
+	const double chromaOffset = (inputMax + 1.0) / 2.0;
+	const bool subsampleY = (input.format != IMAGE_NV16);
+
+	for( size_t y=0; y < input.height; y++ )
+	{
+		const void* luma = input.Row<void>(y);
+		const void* chroma = input.Row<void>(input.height + (subsampleY ? y / 2 : y));
+
+		for( size_t x=0; x < input.width; x++ )
+		{
+			const double Y = loadSample(luma, input.format, x) / inputMax;
+			const double U = (loadSample(chroma, input.format, x / 2 * 2) - chromaOffset) / inputMax;
+			const double V = (loadSample(chroma, input.format, x / 2 * 2 + 1) - chromaOffset) / inputMax;
+
+			double rgba[4] = { Y + 1.402 * V, Y - 0.344 * U - 0.714 * V, Y + 1.772 * U, 1.0 };
+
+			for( int c=0; c < 3; c++ )
+				rgba[c] = fmin(fmax(rgba[c], 0.0), 1.0);
+
+			storePixel(output.Row<void>(y), output.format, x, rgba);
+		}
+	}
+}
+
+
+// compare an output against the reference, allowing one step of rounding
+static bool compareImage( const cudaImageView& output, const cudaImageView& reference, const char* name, const char* device )
+{
+	const imageBaseType type = imageFormatBaseType(output.format);
+	const size_t samples = output.RowSize() / sampleSize(output.format);
+	const size_t rows = cudaImageView::Rows(output.format, output.height);
+
+	const double tolerance = (type == IMAGE_FLOAT) ? 0.01 : 1.0;
+	double maxDiff = 0.0;
+
+	for( size_t y=0; y < rows; y++ )
+	{
+		for( size_t n=0; n < samples; n++ )
+		{
+			const double diff = fabs(loadSample(output.Row<void>(y), output.format, n) - loadSample(reference.Row<void>(y), reference.format, n));
+
+			if( diff > maxDiff )
+				maxDiff = diff;
+		}
+	}
+
+	if( maxDiff > tolerance )
+	{
+		LogError("colorspace-test:  %s on the %s differs from the reference (max difference %g)\n", name, device, maxDiff);
+		return false;
+	}
+
+	return true;
+}
+
+
+// test a conversion on the GPU and CPU
+static bool testConvert( imageFormat inputFormat, imageFormat outputFormat, size_t width, size_t height )
+{
+	void* input = NULL;
+	void* outputGPU = NULL;
+	void* outputCPU = NULL;
+	void* reference = NULL;
+
+	char name[256];
+	sprintf(name, "%s -> %s", imageFormatToStr(inputFormat), imageFormatToStr(outputFormat));
+
+	if( !cudaAllocMapped(&input, width, height, inputFormat) || !cudaAllocMapped(&outputGPU, width, height, outputFormat) ||
+	    !cudaAllocMapped(&outputCPU, width, height, outputFormat) || !cudaAllocMapped(&reference, width, height, outputFormat) )
+	{
+		LogError("colorspace-test:  failed to allocate %s images\n", name);
+
+		CUDA_FREE_HOST(input);
+		CUDA_FREE_HOST(outputGPU);
+		CUDA_FREE_HOST(outputCPU);
+		CUDA_FREE_HOST(reference);
+
+		return false;
+	}
+
+	const cudaImageView inputView(input, width, height, inputFormat);
+	const cudaImageView referenceView(reference, width, height, outputFormat);
+
+	// fill the input with a pattern that covers the range of the samples
+	const size_t inputSize = imageFormatSize(inputFormat, width, height);
+	const imageBaseType inputType = imageFormatBaseType(inputFormat);
+
+	for( size_t n=0; n < inputSize / sampleSize(inputFormat); n++ )
+	{
+		if( inputType == IMAGE_FLOAT )
+			((float*)input)[n] = (n * 37 + n / 11) % 256;
+		else if( inputType == IMAGE_UINT16 )
+			((uint16_t*)input)[n] = (n * 7919 + n / 11) % 65536;
+		else
+			((uint8_t*)input)[n] = (n * 37 + n / 11) % 256;
+	}
+
+	if( inputFormat == outputFormat )
+		memcpy(reference, input, inputSize);
+	else if( cudaImageView::IsSemiPlanar(inputFormat) )
+		referenceSemiPlanar(inputView, referenceView);
+	else
+		referenceRGB(inputView, referenceView);
+
+	bool result = true;
+
+	// GPU
+	if( CUDA_FAILED(cudaConvertColor(input, inputFormat, outputGPU, outputFormat, width, height)) || CUDA_FAILED(cudaDeviceSynchronize()) )
+	{
+		LogError("colorspace-test:  cudaConvertColor() failed for %s\n", name);
+		result = false;
+	}
+	else if( !compareImage(cudaImageView(outputGPU, width, height, outputFormat), referenceView, name, "GPU") )
+	{
+		result = false;
+	}
+
+	// CPU
+	if( !cudaConvertColorCPU(inputView, cudaImageView(outputCPU, width, height, outputFormat)) )
+	{
+		LogError("colorspace-test:  cudaConvertColorCPU() failed for %s\n", name);
+		result = false;
+	}
+	else if( !compareImage(cudaImageView(outputCPU, width, height, outputFormat), referenceView, name, "CPU") )
+	{
+		result = false;
+	}
+
+	if( result )
+		LogSuccess("colorspace-test:  %s passed\n", name);
+
+	CUDA_FREE_HOST(input);
+	CUDA_FREE_HOST(outputGPU);
+	CUDA_FREE_HOST(outputCPU);
+	CUDA_FREE_HOST(reference);
+
+	return result;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	const int width = cmdLine.GetInt("width", 320);
+	const int height = cmdLine.GetInt("height", 240);
+
+	// the semi-planar formats need even dimensions
+	if( width <= 0 || height <= 0 || (width % 2) != 0 || (height % 2) != 0 )
+	{
+		LogError("colorspace-test:  the width and height need to be even\n");
+		return usage();
+	}
+
+
+	/*
+	 * run each conversion
+	 */
+	const imageFormat conversions[][2] = {
+		// 16-bit RGB/grayscale to 8-bit and float
+		{ IMAGE_RGB16, IMAGE_RGB8 },
+		{ IMAGE_RGB16, IMAGE_RGBA8 },
+		{ IMAGE_RGB16, IMAGE_BGR8 },
+		{ IMAGE_RGB16, IMAGE_RGB32F },
+		{ IMAGE_RGB16, IMAGE_GRAY16 },
+		{ IMAGE_RGBA16, IMAGE_RGBA32F },
+		{ IMAGE_RGBA16, IMAGE_RGB16 },
+		{ IMAGE_GRAY16, IMAGE_RGB8 },
+		{ IMAGE_GRAY16, IMAGE_GRAY32F },
+
+		// 8-bit and float to 16-bit RGB/grayscale
+		{ IMAGE_RGB8, IMAGE_RGB16 },
+		{ IMAGE_RGBA8, IMAGE_RGBA16 },
+		{ IMAGE_BGR8, IMAGE_RGB16 },
+		{ IMAGE_GRAY8, IMAGE_GRAY16 },
+		{ IMAGE_RGB8, IMAGE_GRAY16 },
+		{ IMAGE_RGB32F, IMAGE_RGB16 },
+		{ IMAGE_RGBA32F, IMAGE_RGBA16 },
+
+		// semi-planar YUV to RGB/RGBA
+		{ IMAGE_NV12, IMAGE_RGB16 },
+		{ IMAGE_NV16, IMAGE_RGB8 },
+		{ IMAGE_NV16, IMAGE_RGBA32F },
+		{ IMAGE_NV16, IMAGE_RGB16 },
+		{ IMAGE_P010, IMAGE_RGB8 },
+		{ IMAGE_P010, IMAGE_RGBA16 },
+		{ IMAGE_P016, IMAGE_RGB32F },
+		{ IMAGE_P016, IMAGE_RGBA8 },
+
+		// same-format copies
+		{ IMAGE_RGB16, IMAGE_RGB16 },
+		{ IMAGE_RGBA16, IMAGE_RGBA16 },
+		{ IMAGE_GRAY16, IMAGE_GRAY16 },
+		{ IMAGE_NV12, IMAGE_NV12 },
+		{ IMAGE_NV16, IMAGE_NV16 },
+		{ IMAGE_P010, IMAGE_P010 },
+		{ IMAGE_P016, IMAGE_P016 }
+	};
+
+	const uint32_t numConversions = sizeof(conversions) / sizeof(conversions[0]);
+	uint32_t numFailed = 0;
+
+	for( uint32_t n=0; n < numConversions; n++ )
+	{
+		if( !testConvert(conversions[n][0], conversions[n][1], width, height) )
+			numFailed++;
+	}
+
+	if( numFailed > 0 )
+		LogError("colorspace-test:  %u of %u conversions failed\n", numFailed, numConversions);
+	else
+		LogSuccess("colorspace-test:  all %u conversions passed\n", numConversions);
+
+	return (numFailed > 0) ? 1 : 0;
+}
@@ -33,11 +33,12 @@
  * The alpha blending of the `src` and `dst` pixels is
  * computed by the equation: `dst * dst.w + src * (1.0 - dst.w)`
  *
- * @note cudaAlphaBlend() is for use inside of other CUDA kernels.
+ * @note cudaAlphaBlend() is for use inside of other CUDA kernels,
+ *       and can also be called from host code for CPU implementations.
  * @ingroup cuda
  */
 template<typename T1, typename T2>
-__device__ inline T1 cudaAlphaBlend( const T1& src, const T2& dst )
+__device__ __host__ inline T1 cudaAlphaBlend( const T1& src, const T2& dst )
 {
 	const float alph = dst.w / 255.0f;
 	const float inva = 1.0f - alph;
@@ -1708,7 +1708,7 @@ float4* cudaColormapPalette( cudaColormapType colormap )
 template<typename T, cudaFilterMode filter>
 __global__ void gpuColormapPalette( float4* palette, float* input, int input_width, int input_height,
 							 T* output, int output_width, int output_height, 
-							 float multiplier, float min_value )
+							 float multiplier, float min_value, const cudaImageStats* stats )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -1716,6 +1716,15 @@ __global__ void gpuColormapPalette( float4* palette, float* input, int input_wid
 	if( x >= output_width || y >= output_height )
 		return;
 
+	// auto-range from the image stats
+	if( stats != NULL )
+	{
+		const float span = stats->range.y - stats->range.x;
+
+		multiplier = (span > 0.0f) ? 255.0f / span : 0.0f;
+		min_value  = stats->range.x;
+	}
+
 	const float pixel = cudaFilterPixel<filter>(input, x, y, input_width, input_height, output_width, output_height);
 	const float value = fmaxf(fminf((pixel - min_value) * multiplier, 255.0f), 0.0f); // __saturatef(pixel - min_value) * 255.0f; 
 
@@ -1727,7 +1736,7 @@ __global__ void gpuColormapPalette( float4* palette, float* input, int input_wid
 template<typename T, cudaFilterMode filter, cudaDataFormat format>
 __global__ void gpuColormapFlow( float2* input, int input_width, int input_height,
 						   T* output, int output_width, int output_height, 
-						   float max_value )
+						   float max_value, const cudaImageStats* stats )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -1735,6 +1744,10 @@ __global__ void gpuColormapFlow( float2* input, int input_width, int input_heigh
 	if( x >= output_width || y >= output_height )
 		return;
 
+	// auto-range from the image stats
+	if( stats != NULL )
+		max_value = fmaxf(fabs(stats->range.x), fabs(stats->range.y));
+
 	const float2 pixel = cudaFilterPixel<filter, format>(input, x, y, input_width, input_height, output_width, output_height);
 	const float2 value = pixel / max_value;
 
@@ -1770,12 +1783,12 @@ __global__ void gpuColormapNone( T* input, int input_width, int input_height,
 
 
 
-// cudaColormap
-cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
-					 void* output, size_t output_width, size_t output_height,
-					 const float2& input_range, cudaDataFormat input_format,
-					 imageFormat output_format, cudaColormapType colormap, 
-					 cudaFilterMode filter,  cudaStream_t stream )
+// launchColormap
+static cudaError_t launchColormap( float* input, size_t input_width, size_t input_height,
+						     void* output, size_t output_width, size_t output_height,
+						     const float2& input_range, const cudaImageStats* input_stats,
+						     cudaDataFormat input_format, imageFormat output_format, 
+						     cudaColormapType colormap, cudaFilterMode filter, cudaStream_t stream )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -1809,7 +1822,7 @@ cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
 			gpuColormapPalette<type, filterMode><<<gridDim, blockDim, 0, stream>>>( \
 								palette, input, input_width, input_height, \
 								(type*)output, output_width, output_height, \
-								multiplier, input_range.x);
+								multiplier, input_range.x, input_stats);
 
 		#define colormapKernel(type) \
 		{ \
@@ -1846,7 +1859,7 @@ cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
 			gpuColormapFlow<type, filterMode, layout><<<gridDim, blockDim, 0, stream>>>( \
 										 (float2*)input, input_width, input_height, \
 										 (type*)output, output_width, output_height, \
-										 max_value);
+										 max_value, input_stats);
 
 		#define flowKernel(type) \
 		{ \
@@ -1940,6 +1953,62 @@ cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
 }
 
 
+// cudaColormap
+cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
+					 void* output, size_t output_width, size_t output_height,
+					 const float2& input_range, cudaDataFormat input_format,
+					 imageFormat output_format, cudaColormapType colormap, 
+					 cudaFilterMode filter,  cudaStream_t stream )
+{
+	return launchColormap(input, input_width, input_height, output, output_width, output_height,
+					  input_range, NULL, input_format, output_format, colormap, filter, stream);
+}
+
+
+// cudaColormap (auto-range)
+cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
+					 void* output, size_t output_width, size_t output_height,
+					 const cudaImageStats* input_stats, cudaDataFormat input_format,
+					 imageFormat output_format, cudaColormapType colormap, 
+					 cudaFilterMode filter,  cudaStream_t stream )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( input_width == 0 || output_width == 0 || input_height == 0 || output_height == 0 )
+		return cudaErrorInvalidValue;
+
+	// compute the stats if they weren't provided (flow fields have 2 values per pixel)
+	if( !input_stats && colormap != COLORMAP_NONE )
+	{
+		cudaImageStats* stats = cudaReduceStatsBuffer();
+
+		if( !stats )
+			return cudaErrorMemoryAllocation;
+
+		const size_t values_per_pixel = (colormap == COLORMAP_FLOW) ? 2 : 1;
+
+		CUDA_ASSERT(cudaReduceStats(input, input_width * values_per_pixel, input_height, IMAGE_GRAY32F, stats, stream));
+		input_stats = stats;
+	}
+
+	return launchColormap(input, input_width, input_height, output, output_width, output_height,
+					  make_float2(0,255), input_stats, input_format, output_format, colormap, filter, stream);
+}
+
+
+// cudaColormap (auto-range)
+cudaError_t cudaColormap( float* input, void* output, size_t width, size_t height,
+					 const cudaImageStats* input_stats, cudaDataFormat input_format,
+					 imageFormat output_format, cudaColormapType colormap,
+					 cudaStream_t stream)
+{
+	return cudaColormap(input, width, height, output, width, height,
+					input_stats, input_format, output_format, 
+					colormap, FILTER_POINT, stream);
+}
+
+
 // cudaColormap
 cudaError_t cudaColormap( float* input, void* output, size_t width, size_t height,
 					 const float2& input_range, cudaDataFormat input_format,
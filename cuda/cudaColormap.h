@@ -25,6 +25,7 @@
 
 
 #include "cudaFilterMode.h"
+#include "cudaReduce.h"
 #include "imageFormat.h"
 
 
@@ -145,6 +146,44 @@ cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
 					 cudaFilterMode filter=FILTER_LINEAR,
 					 cudaStream_t stream=0 );
 
+/**
+ * Apply a colormap from an input image or vector field to RGB/RGBA, using the range
+ * of values that's found in the input (auto-ranging) instead of a fixed input range.
+ * If the input and output dimensions differ, this function will rescale the image
+ * using bilinear or nearest-point interpolation as set by the `filter` mode.
+ * @param input_stats statistics of the input from cudaReduceStats(), in device or mapped memory.
+ *                    If `NULL`, they'll be computed first into an internal buffer on the GPU.
+ * @param colormap the colormap to apply (@see cudaColormapType)
+ * @param filter the interpolation mode used for rescaling.
+ * @param format layout of multi-channel input data (HWC or CHW).
+ * @ingroup colormap
+ */
+cudaError_t cudaColormap( float* input, size_t input_width, size_t input_height,
+					 void* output, size_t output_width, size_t output_height,
+					 const cudaImageStats* input_stats,
+					 cudaDataFormat input_format=FORMAT_DEFAULT,
+					 imageFormat output_format=IMAGE_UNKNOWN,
+                          cudaColormapType colormap=COLORMAP_DEFAULT,
+					 cudaFilterMode filter=FILTER_LINEAR,
+					 cudaStream_t stream=0 );
+
+/**
+ * Apply a colormap from an input image or vector field to RGB/RGBA, using the range
+ * of values that's found in the input (auto-ranging) instead of a fixed input range.
+ * @param input_stats statistics of the input from cudaReduceStats(), in device or mapped memory.
+ *                    If `NULL`, they'll be computed first into an internal buffer on the GPU.
+ * @param colormap the colormap to apply (@see cudaColormapType)
+ * @param format layout of multi-channel input data (HWC or CHW). 
+ * @ingroup colormap
+ */
+cudaError_t cudaColormap( float* input, void* output,
+					 size_t width, size_t height,
+					 const cudaImageStats* input_stats,
+					 cudaDataFormat input_format=FORMAT_DEFAULT,
+					 imageFormat output_format=IMAGE_UNKNOWN,
+                     cudaColormapType colormap=COLORMAP_DEFAULT,
+					 cudaStream_t stream=0 );
+
 /**
  * Initialize the colormap palettes by allocating them in CUDA memory.
  * @note cudaColormapInit() is automatically called the first time
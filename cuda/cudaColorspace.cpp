@@ -37,6 +37,29 @@ cudaError_t cudaConvertColor( void* input, imageFormat inputFormat,
 						      const float2& pixel_range, 
 						      cudaStream_t stream ) 
 {
+	// same-format conversions are a copy (this includes the semi-planar and 16-bit formats)
+	if( inputFormat == outputFormat )
+		return CUDA(cudaMemcpyAsync(output, input, imageFormatSize(inputFormat, width, height), cudaMemcpyDeviceToDevice, stream));
+
+	// semi-planar 4:2:2 and 16-bit YUV, or NV12 to 16-bit RGB
+	if( inputFormat == IMAGE_NV16 || inputFormat == IMAGE_P010 || inputFormat == IMAGE_P016 ||
+	   (inputFormat == IMAGE_NV12 && imageFormatBaseType(outputFormat) == IMAGE_UINT16) )
+	{
+		return CUDA(cudaYUVSemiPlanarToRGB(cudaImageView(input, width, height, inputFormat), 
+								     cudaImageView(output, width, height, outputFormat), stream));
+	}
+
+	// 16-bit RGB/grayscale to or from any of the RGB/BGR/grayscale formats
+	if( imageFormatBaseType(inputFormat) == IMAGE_UINT16 || imageFormatBaseType(outputFormat) == IMAGE_UINT16 )
+	{
+		if( (imageFormatIsRGB(inputFormat) || imageFormatIsBGR(inputFormat) || imageFormatIsGray(inputFormat)) &&
+		    (imageFormatIsRGB(outputFormat) || imageFormatIsBGR(outputFormat) || imageFormatIsGray(outputFormat)) )
+		{
+			return CUDA(cudaRGBToRGB(cudaImageView(input, width, height, inputFormat), 
+								cudaImageView(output, width, height, outputFormat), pixel_range, stream));
+		}
+	}
+
 	if( inputFormat == IMAGE_NV12 )
 	{
 		if( outputFormat == IMAGE_RGB8 )
@@ -357,3 +380,66 @@ cudaError_t cudaConvertColor( void* input, imageFormat inputFormat,
 						 
 
 
+// cudaConvertColor (image view)
+cudaError_t cudaConvertColor( const cudaImageView& input, const cudaImageView& output,
+                              const float2& pixel_range, cudaStream_t stream )
+{
+	if( !input.IsValid() || !output.IsValid() )
+	{
+		LogError(LOG_CUDA "cudaConvertColor() -- invalid image view (NULL pointer, zero size, or pitch smaller than a row)\n");
+		return cudaErrorInvalidValue;
+	}
+
+	if( input.width != output.width || input.height != output.height )
+	{
+		LogError(LOG_CUDA "cudaConvertColor() -- input and output views must have the same dimensions (%zux%zu vs %zux%zu)\n", input.width, input.height, output.width, output.height);
+		return cudaErrorInvalidValue;
+	}
+
+	// tightly-packed views can use any of the conversions
+	if( input.IsPacked() && output.IsPacked() )
+		return cudaConvertColor(input.ptr, input.format, output.ptr, output.format, input.width, input.height, pixel_range, stream);
+
+	if( input.format == output.format && input.format != IMAGE_I420 && input.format != IMAGE_YV12 )
+		return cudaImageCopy(input, output, stream);
+	
+	if( input.format == IMAGE_NV12 && imageFormatBaseType(output.format) != IMAGE_UINT16 )
+		return CUDA(cudaNV12ToRGB(input, output, stream));
+	else if( cudaImageView::IsSemiPlanar(input.format) )
+		return CUDA(cudaYUVSemiPlanarToRGB(input, output, stream));
+	else if( input.format == IMAGE_YUYV || input.format == IMAGE_YVYU || input.format == IMAGE_UYVY )
+		return CUDA(cudaYUYVToRGB(input, output, stream));
+	else if( (imageFormatIsRGB(input.format) || imageFormatIsBGR(input.format) || imageFormatIsGray(input.format)) &&
+		    (imageFormatIsRGB(output.format) || imageFormatIsBGR(output.format) || imageFormatIsGray(output.format)) )
+		return CUDA(cudaRGBToRGB(input, output, pixel_range, stream));
+
+	LogError(LOG_CUDA "cudaConvertColor() -- unsupported conversion between pitched image views (%s -> %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+	return cudaErrorInvalidValue;
+}
+
+
+// cudaConvertColorCPU (image view)
+bool cudaConvertColorCPU( const cudaImageView& input, const cudaImageView& output, const float2& pixel_range )
+{
+	if( !input.IsValid() || !output.IsValid() )
+		return false;
+
+	if( input.width != output.width || input.height != output.height )
+		return false;
+
+	if( input.format == output.format && input.format != IMAGE_I420 && input.format != IMAGE_YV12 )
+	{
+		const size_t rowSize = input.RowSize();
+		const size_t rows = cudaImageView::Rows(input.format, input.height);
+
+		for( size_t y=0; y < rows; y++ )
+			memcpy(output.Row<uint8_t>(y), input.Row<uint8_t>(y), rowSize);
+
+		return true;
+	}
+
+	if( cudaImageView::IsSemiPlanar(input.format) )
+		return cudaYUVSemiPlanarToRGBCPU(input, output);
+
+	return cudaRGBToRGBCPU(input, output, pixel_range);
+}
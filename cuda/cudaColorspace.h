@@ -25,6 +25,7 @@
 
 #include "cudaUtility.h"
 #include "imageFormat.h"
+#include "cudaImageView.h"
 
 
 /**
@@ -40,8 +41,14 @@
  *
  *     - The YUV formats don't support BGR/BGRA or grayscale (RGB/RGBA only)
  *     - YUV NV12, YUYV, YVYU, and UYVY can only be converted to RGB/RGBA (not from)
+ *     - YUV NV16, P010, and P016 can only be converted to RGB/RGBA (uint8, uint16 or float)
+ *     - Any format can be converted to itself, which copies the image
  *     - Bayer formats can only be converted to RGB8 (`uchar3`) and RGBA8 (`uchar4`)
  *
+ * The 16-bit formats (`IMAGE_RGB16`, `IMAGE_RGBA16`, `IMAGE_GRAY16`) can be converted to
+ * and from the other RGB/RGBA, BGR/BGRA, and grayscale formats, where the pixel values
+ * are rescaled between `[0,65535]` and `[0,255]`.
+ *
  * @param input CUDA device pointer to the input image
  * @param inputFormat format enum of the input image
  * @param output CUDA device pointer to the input image
@@ -76,6 +83,8 @@ cudaError_t cudaConvertColor( void* input, imageFormat inputFormat,
  *
  *     - The YUV formats don't support BGR/BGRA or grayscale (RGB/RGBA only)
  *     - YUV NV12, YUYV, YVYU, and UYVY can only be converted to RGB/RGBA (not from)
+ *     - YUV NV16, P010, and P016 can only be converted to RGB/RGBA (uint8, uint16 or float)
+ *     - Any format can be converted to itself, which copies the image
  *     - Bayer formats can only be converted to RGB8 (`uchar3`) and RGBA8 (`uchar4`)
  *
  * @param input CUDA device pointer to the input image
@@ -92,6 +101,41 @@ cudaError_t cudaConvertColor( void* input, imageFormat inputFormat,
                               size_t width, size_t height,
                               cudaStream_t stream );
                               
+/**
+ * Convert between two image views using the GPU, where the views can have
+ * padded rows with different pitches (or reference an ROI of a larger image).
+ *
+ * If both views are tightly packed, this is the same as the other versions of
+ * cudaConvertColor().  Otherwise, the following conversions support pitched views:
+ *
+ *     - Between RGB/RGBA, BGR/BGRA, and grayscale (uint8, uint16 or float)
+ *     - YUYV, YVYU, and UYVY to RGB/RGBA (uint8 or float)
+ *     - NV12, NV16, P010, and P016 to RGB/RGBA (uint8, uint16 or float)
+ *     - Any format except I420/YV12 to the same format (the rows are copied)
+ *
+ * The input and output views should have the same width and height.
+ *
+ * @param pixel_range for floating-point to 8-bit conversions, specifies the range of pixel intensities
+ *                    in the input image that get normalized to `[0,255]` (see above).
+ * @ingroup colorspace
+ */
+cudaError_t cudaConvertColor( const cudaImageView& input, const cudaImageView& output,
+                              const float2& pixel_range=make_float2(0,255),
+                              cudaStream_t stream=0 );
+
+/**
+ * Convert between two image views on the CPU, as a reference implementation of
+ * cudaConvertColor().  This supports conversions between RGB/RGBA, BGR/BGRA, and
+ * grayscale (uint8, uint16 or float), semi-planar YUV (NV12, NV16, P010, P016) to
+ * RGB/RGBA, along with copies between views of the same format.
+ * The views should be in CPU-accessible memory (e.g. mapped memory).
+ *
+ * @returns true on success, or false on an invalid view or unsupported conversion.
+ * @ingroup colorspace
+ */
+bool cudaConvertColorCPU( const cudaImageView& input, const cudaImageView& output,
+                          const float2& pixel_range=make_float2(0,255) );
+
 /**
  * Convert between to image formats using the GPU.
  *
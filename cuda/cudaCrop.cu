@@ -143,5 +143,60 @@ cudaError_t cudaCrop( void* input, void* output, const int4& roi, size_t inputWi
 }
 
 
+//-----------------------------------------------------------------------------------
+static bool validateCrop( const cudaImageView& input, const cudaImageView& output, const int4& roi, const cudaImageView& inputROI, const char* function )
+{
+	if( !input.IsValid() || !output.IsValid() )
+	{
+		LogError(LOG_CUDA "%s -- invalid image view (NULL pointer, zero size, or pitch smaller than a row)\n", function);
+		return false;
+	}
+
+	if( input.format != output.format )
+	{
+		LogError(LOG_CUDA "%s -- input and output views must have the same format (%s vs %s)\n", function, imageFormatToStr(input.format), imageFormatToStr(output.format));
+		return false;
+	}
+
+	if( !inputROI.IsValid() )
+	{
+		LogError(LOG_CUDA "%s -- invalid ROI (%i, %i) (%i, %i) for %zux%zu %s image\n", function, roi.x, roi.y, roi.z, roi.w, input.width, input.height, imageFormatToStr(input.format));
+		return false;
+	}
+
+	if( inputROI.width != output.width || inputROI.height != output.height )
+	{
+		LogError(LOG_CUDA "%s -- the output view (%zux%zu) should have the same dimensions as the ROI (%zux%zu)\n", function, output.width, output.height, inputROI.width, inputROI.height);
+		return false;
+	}
+
+	return true;
+}
+
+// cudaCrop (image view)
+cudaError_t cudaCrop( const cudaImageView& input, const cudaImageView& output, const int4& roi, cudaStream_t stream )
+{
+	const cudaImageView inputROI = input.Crop(roi);
+
+	if( !validateCrop(input, output, roi, inputROI, "cudaCrop()") )
+		return cudaErrorInvalidValue;
 
+	// the ROI is a strided view into the input, so it can be copied directly
+	return cudaImageCopy(inputROI, output, stream);
+}
+
+// cudaCropCPU (image view)
+bool cudaCropCPU( const cudaImageView& input, const cudaImageView& output, const int4& roi )
+{
+	const cudaImageView inputROI = input.Crop(roi);
+
+	if( !validateCrop(input, output, roi, inputROI, "cudaCropCPU()") )
+		return false;
 
+	const size_t rowSize = inputROI.RowSize();
+
+	for( size_t y=0; y < output.height; y++ )
+		memcpy(output.Row<uint8_t>(y), inputROI.Row<uint8_t>(y), rowSize);
+
+	return true;
+}
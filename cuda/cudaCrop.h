@@ -26,6 +26,7 @@
 
 #include "cudaUtility.h"
 #include "imageFormat.h"
+#include "cudaImageView.h"
 
 
 /**
@@ -192,5 +193,27 @@ cudaError_t cudaCrop( float4* input, float4* output, const int4& roi, size_t inp
 cudaError_t cudaCrop( void* input, void* output, const int4& roi, size_t inputWidth, size_t inputHeight, imageFormat format, cudaStream_t stream=0 );
 
 
+/**
+ * Crop an image view to the specified region of interest (ROI).
+ *
+ * If the cropped image can be processed in-place, cudaImageView::Crop() returns a view
+ * of the ROI without copying any data.  This function copies the ROI into the output
+ * view (which can have a different pitch than the input), and supports any format
+ * that isn't planar YUV.  The output view should have the same format and dimensions
+ * as the ROI.  For 4:2:2 formats (YUYV, YVYU, UYVY), the ROI's left and right edges
+ * must be aligned to even pixel coordinates.
+ *
+ * @ingroup crop
+ */
+cudaError_t cudaCrop( const cudaImageView& input, const cudaImageView& output, const int4& roi, cudaStream_t stream=0 );
+
+/**
+ * Crop an image view on the CPU, as a reference implementation of cudaCrop().
+ * The input and output views should be in CPU-accessible memory (e.g. mapped memory).
+ * @returns true on success, false on an invalid view or ROI.
+ * @ingroup crop
+ */
+bool cudaCropCPU( const cudaImageView& input, const cudaImageView& output, const int4& roi );
+
 #endif
 
@@ -22,6 +22,7 @@
 
 #include "cudaDraw.h"
 #include "cudaAlphaBlend.cuh"
+#include "cudaMappedMemory.h"
 
 
 // TODO for rect/fill/line
@@ -109,7 +110,7 @@ cudaError_t cudaDrawCircle( void* input, void* output, size_t width, size_t heig
 // Line drawing (find if the distance to the line <= line_width)
 // Distance from point to line segment - https://stackoverflow.com/a/1501725
 //----------------------------------------------------------------------------
-inline __device__ float lineDistanceSquared(float x, float y, float x1, float y1, float x2, float y2) 
+inline __device__ __host__ float lineDistanceSquared(float x, float y, float x1, float y1, float x2, float y2) 
 {
 	const float d = dist2(x1, y1, x2, y2);
 	const float t = ((x-x1) * (x2-x1) + (y-y1) * (y2-y1)) / d;
@@ -282,3 +283,473 @@ cudaError_t cudaDrawRect( void* input, void* output, size_t width, size_t height
 	
 	return cudaGetLastError();
 }
+
+
+
+//----------------------------------------------------------------------------
+// Batched drawing (the image is binned into tiles, and each CUDA block
+// blends the commands that overlap its tile in the order they were added)
+//----------------------------------------------------------------------------
+enum DrawCommandType
+{
+	DRAW_CIRCLE = 0,
+	DRAW_LINE,
+	DRAW_RECT
+};
+
+struct __align__(16) DrawCommand
+{
+	float4 color;	// RGBA color of the shape (0-255)
+	float4 coords;	// circle (cx, cy), line (x1, y1, x2, y2), rect (left, top, right, bottom)
+	int4   bbox;	// bounding box of the pixels that the shape can cover (right/bottom are exclusive)
+	float  param;	// circle radius^2 or line width^2
+	int    type;	// DrawCommandType
+};
+
+
+// drawCommandTest (returns true if the pixel is covered by the shape)
+inline __device__ __host__ bool drawCommandTest( const DrawCommand& cmd, int x, int y )
+{
+	if( cmd.type == DRAW_CIRCLE )
+	{
+		const int dx = x - (int)cmd.coords.x;
+		const int dy = y - (int)cmd.coords.y;
+
+		return (dx * dx + dy * dy < cmd.param);
+	}
+	else if( cmd.type == DRAW_LINE )
+	{
+		return (lineDistanceSquared(x, y, cmd.coords.x, cmd.coords.y, cmd.coords.z, cmd.coords.w) <= cmd.param);
+	}
+	else if( cmd.type == DRAW_RECT )
+	{
+		return (x >= cmd.coords.x && x < cmd.coords.z && y >= cmd.coords.y && y < cmd.coords.w);
+	}
+
+	return false;
+}
+
+template<typename T>
+__global__ void gpuDrawList( T* img, int imgWidth, int imgHeight, const DrawCommand* commands, const uint4* tiles, const uint32_t* indices )
+{
+	const uint4 tile = tiles[blockIdx.x];	// (offset, count, tile_x, tile_y)
+
+	const int x = tile.z * cudaDrawList::TileSize + threadIdx.x;
+	const int y = tile.w * cudaDrawList::TileSize + threadIdx.y;
+
+	if( x >= imgWidth || y >= imgHeight )
+		return;
+
+	const int idx = y * imgWidth + x;
+
+	T px = img[idx];
+	bool covered = false;
+
+	for( uint32_t n=0; n < tile.y; n++ )
+	{
+		const DrawCommand& cmd = commands[indices[tile.x + n]];
+
+		if( drawCommandTest(cmd, x, y) )
+		{
+			px = cudaAlphaBlend(px, cmd.color);
+			covered = true;
+		}
+	}
+
+	if( covered )
+		img[idx] = px;
+}
+
+template<typename T>
+static void cpuDrawList( T* img, int imgWidth, int imgHeight, const DrawCommand* commands, uint32_t numCommands )
+{
+	for( uint32_t n=0; n < numCommands; n++ )
+	{
+		const DrawCommand& cmd = commands[n];
+
+		const int left   = MAX(cmd.bbox.x, 0);
+		const int top    = MAX(cmd.bbox.y, 0);
+		const int right  = MIN(cmd.bbox.z, imgWidth);
+		const int bottom = MIN(cmd.bbox.w, imgHeight);
+
+		for( int y=top; y < bottom; y++ )
+		{
+			for( int x=left; x < right; x++ )
+			{
+				if( !drawCommandTest(cmd, x, y) )
+					continue;
+
+				const int idx = y * imgWidth + x;
+				img[idx] = cudaAlphaBlend(img[idx], cmd.color);
+			}
+		}
+	}
+}
+
+
+// constructor
+cudaDrawList::cudaDrawList()
+{
+	mCommandsCPU = NULL;
+	mCommandsGPU = NULL;
+	mNumCommands = 0;
+	mMaxCommands = 0;
+
+	mBinsCPU  = NULL;
+	mBinsGPU  = NULL;
+	mBinsSize = 0;
+	mNumTiles = 0;
+
+	mBinsEvent   = NULL;
+	mBinsPending = false;
+}
+
+
+// destructor
+cudaDrawList::~cudaDrawList()
+{
+	if( mBinsEvent != NULL )
+	{
+		CUDA(cudaEventSynchronize(mBinsEvent));
+		CUDA(cudaEventDestroy(mBinsEvent));
+	}
+
+	CUDA_FREE_HOST(mCommandsCPU);
+	CUDA_FREE_HOST(mBinsCPU);
+}
+
+
+// Create
+cudaDrawList* cudaDrawList::Create( uint32_t maxCommands )
+{
+	if( maxCommands == 0 )
+		return NULL;
+
+	cudaDrawList* list = new cudaDrawList();
+
+	if( !cudaAllocMapped(&list->mCommandsCPU, &list->mCommandsGPU, sizeof(DrawCommand) * maxCommands) )
+	{
+		LogError(LOG_CUDA "cudaDrawList::Create() -- failed to allocate command buffer for %u commands\n", maxCommands);
+		delete list;
+		return NULL;
+	}
+
+	if( CUDA_FAILED(cudaEventCreateWithFlags(&list->mBinsEvent, cudaEventDisableTiming)) )
+	{
+		LogError(LOG_CUDA "cudaDrawList::Create() -- failed to create CUDA event\n");
+		delete list;
+		return NULL;
+	}
+
+	list->mMaxCommands = maxCommands;
+	return list;
+}
+
+
+// addCommand
+bool cudaDrawList::addCommand( int type, const float4& coords, float param, const float4& color )
+{
+	if( mNumCommands >= mMaxCommands )
+	{
+		LogError(LOG_CUDA "cudaDrawList -- exceeded the maximum number of commands (%u)\n", mMaxCommands);
+		return false;
+	}
+
+	DrawCommand* cmd = ((DrawCommand*)mCommandsCPU) + mNumCommands;
+
+	cmd->color  = color;
+	cmd->coords = coords;
+	cmd->param  = param;
+	cmd->type   = type;
+
+	if( type == DRAW_CIRCLE )
+	{
+		const float radius = sqrtf(param);
+
+		cmd->bbox = make_int4(floorf(coords.x - radius), floorf(coords.y - radius), 
+						  ceilf(coords.x + radius) + 1, ceilf(coords.y + radius) + 1);
+	}
+	else if( type == DRAW_LINE )
+	{
+		const float line_width = sqrtf(param);
+
+		cmd->bbox = make_int4(floorf(MIN(coords.x, coords.z) - line_width), floorf(MIN(coords.y, coords.w) - line_width),
+						  ceilf(MAX(coords.x, coords.z) + line_width) + 1, ceilf(MAX(coords.y, coords.w) + line_width) + 1);
+	}
+	else
+	{
+		cmd->bbox = make_int4(coords.x, coords.y, coords.z, coords.w);
+	}
+
+	mNumCommands++;
+	return true;
+}
+
+
+// AddCircle
+bool cudaDrawList::AddCircle( int cx, int cy, float radius, const float4& color )
+{
+	if( radius <= 0 )
+		return false;
+
+	return addCommand(DRAW_CIRCLE, make_float4(cx, cy, 0, 0), radius * radius, color);
+}
+
+
+// AddLine
+bool cudaDrawList::AddLine( int x1, int y1, int x2, int y2, const float4& color, float line_width )
+{
+	if( line_width <= 0 )
+		return false;
+
+	// lines < 2 pixels in length are skipped (same as cudaDrawLine)
+	if( dist(x1,y1,x2,y2) < 2.0 )
+		return true;
+
+	return addCommand(DRAW_LINE, make_float4(x1, y1, x2, y2), line_width * line_width, color);
+}
+
+
+// AddRect
+bool cudaDrawList::AddRect( int left, int top, int right, int bottom, const float4& color, const float4& line_color, float line_width )
+{
+	// make sure the coordinates are ordered
+	if( left > right )
+	{
+		const int swap = left;
+		left = right;
+		right = swap;
+	}
+	
+	if( top > bottom )
+	{
+		const int swap = top;
+		top = bottom;
+		bottom = swap;
+	}
+
+	if( right - left <= 0 || bottom - top <= 0 )
+	{
+		LogError(LOG_CUDA "cudaDrawList::AddRect() -- rect had width/height <= 0  left=%i top=%i right=%i bottom=%i\n", left, top, right, bottom);
+		return false;
+	}
+
+	const bool has_fill = color.w > 0;
+	const bool has_outline = line_color.w > 0 && line_width > 0;
+
+	// check that the fill and outline will fit, so that partial rects aren't drawn
+	if( mNumCommands + (has_fill ? 1 : 0) + (has_outline ? 4 : 0) > mMaxCommands )
+	{
+		LogError(LOG_CUDA "cudaDrawList -- exceeded the maximum number of commands (%u)\n", mMaxCommands);
+		return false;
+	}
+
+	if( has_fill )
+		addCommand(DRAW_RECT, make_float4(left, top, right, bottom), 0.0f, color);
+
+	if( has_outline )
+	{
+		AddLine(left, top, right, top, line_color, line_width);
+		AddLine(right, top, right, bottom, line_color, line_width);
+		AddLine(right, bottom, left, bottom, line_color, line_width);
+		AddLine(left, bottom, left, top, line_color, line_width);
+	}
+
+	return true;
+}
+
+
+// binCommands
+bool cudaDrawList::binCommands( size_t width, size_t height )
+{
+	const DrawCommand* commands = (DrawCommand*)mCommandsCPU;
+
+	const int tilesX = iDivUp(width, TileSize);
+	const int tilesY = iDivUp(height, TileSize);
+
+	mTileCounts.assign(tilesX * tilesY, 0);
+
+	// find the range of tiles covered by each command
+	#define TILE_RANGE(cmd) \
+		const int tx0 = MAX(cmd.bbox.x, 0) / (int)TileSize; \
+		const int ty0 = MAX(cmd.bbox.y, 0) / (int)TileSize; \
+		const int tx1 = (MIN(cmd.bbox.z, (int)width) - 1) / (int)TileSize; \
+		const int ty1 = (MIN(cmd.bbox.w, (int)height) - 1) / (int)TileSize;
+
+	// count the number of commands that overlap each tile
+	uint32_t numIndices = 0;
+
+	for( uint32_t n=0; n < mNumCommands; n++ )
+	{
+		TILE_RANGE(commands[n]);
+
+		if( commands[n].bbox.z <= 0 || commands[n].bbox.w <= 0 )
+			continue;
+
+		for( int ty=ty0; ty <= ty1; ty++ )
+		{
+			for( int tx=tx0; tx <= tx1; tx++ )
+			{
+				mTileCounts[ty * tilesX + tx]++;
+				numIndices++;
+			}
+		}
+	}
+
+	uint32_t numTiles = 0;
+
+	for( size_t n=0; n < mTileCounts.size(); n++ )
+	{
+		if( mTileCounts[n] > 0 )
+			numTiles++;
+	}
+
+	mNumTiles = numTiles;
+
+	if( numTiles == 0 )
+		return true;
+
+	// allocate the tile bins (grow only)
+	const size_t size = numTiles * sizeof(uint4) + numIndices * sizeof(uint32_t);
+
+	if( size > mBinsSize )
+	{
+		CUDA_FREE_HOST(mBinsCPU);
+		mBinsSize = 0;
+
+		if( !cudaAllocMapped((void**)&mBinsCPU, (void**)&mBinsGPU, size * 2, false) )
+			return false;
+
+		mBinsSize = size * 2;
+	}
+
+	uint4* tiles = (uint4*)mBinsCPU;
+	uint32_t* indices = mBinsCPU + numTiles * 4;
+
+	// assign each active tile its offset in the index list, and
+	// replace the per-tile counts with the tile's slot in the list
+	uint32_t offset = 0;
+	uint32_t slot = 0;
+
+	for( size_t n=0; n < mTileCounts.size(); n++ )
+	{
+		if( mTileCounts[n] == 0 )
+			continue;
+
+		tiles[slot] = make_uint4(offset, 0, n % tilesX, n / tilesX);
+		offset += mTileCounts[n];
+		mTileCounts[n] = slot++;
+	}
+
+	// fill the index lists (the commands remain in the order they were added)
+	for( uint32_t n=0; n < mNumCommands; n++ )
+	{
+		TILE_RANGE(commands[n]);
+
+		if( commands[n].bbox.z <= 0 || commands[n].bbox.w <= 0 )
+			continue;
+
+		for( int ty=ty0; ty <= ty1; ty++ )
+		{
+			for( int tx=tx0; tx <= tx1; tx++ )
+			{
+				uint4& tile = tiles[mTileCounts[ty * tilesX + tx]];
+				indices[tile.x + tile.y] = n;
+				tile.y++;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// Render
+cudaError_t cudaDrawList::Render( void* input, void* output, size_t width, size_t height, imageFormat format, cudaStream_t stream )
+{
+	if( !input || !output || width == 0 || height == 0 )
+		return cudaErrorInvalidValue;
+
+	if( format != IMAGE_RGB8 && format != IMAGE_RGBA8 && format != IMAGE_RGB32F && format != IMAGE_RGBA32F )
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaDrawList::Render()", format);
+		return cudaErrorInvalidValue;
+	}
+
+	// if the input and output images are different, copy the input to the output
+	// this is because we only launch the kernel over the tiles that have shapes
+	if( input != output )
+		CUDA(cudaMemcpyAsync(output, input, imageFormatSize(format, width, height), cudaMemcpyDeviceToDevice, stream));
+
+	if( mNumCommands == 0 )
+		return cudaSuccess;
+
+	// the bins are in mapped memory, so wait for the previous Render() to
+	// finish reading them on the GPU before they get rewritten or freed
+	if( mBinsPending )
+	{
+		const cudaError_t error = CUDA(cudaEventSynchronize(mBinsEvent));
+
+		if( error != cudaSuccess )
+			return error;
+
+		mBinsPending = false;
+	}
+
+	if( !binCommands(width, height) )
+		return cudaErrorMemoryAllocation;
+
+	if( mNumTiles == 0 )
+		return cudaSuccess;
+
+	// launch kernel
+	const dim3 blockDim(TileSize, TileSize);
+	const dim3 gridDim(mNumTiles);
+
+	#define LAUNCH_DRAW_LIST(type) \
+		gpuDrawList<type><<<gridDim, blockDim, 0, stream>>>((type*)output, width, height, (DrawCommand*)mCommandsGPU, (uint4*)mBinsGPU, mBinsGPU + mNumTiles * 4)
+
+	if( format == IMAGE_RGB8 )
+		LAUNCH_DRAW_LIST(uchar3);
+	else if( format == IMAGE_RGBA8 )
+		LAUNCH_DRAW_LIST(uchar4);
+	else if( format == IMAGE_RGB32F )
+		LAUNCH_DRAW_LIST(float3); 
+	else if( format == IMAGE_RGBA32F )
+		LAUNCH_DRAW_LIST(float4);
+
+	const cudaError_t error = cudaGetLastError();
+
+	if( error != cudaSuccess )
+		return error;
+
+	// mark when the kernel is done with the bins
+	mBinsPending = true;
+	return CUDA(cudaEventRecord(mBinsEvent, stream));
+}
+
+
+// RenderCPU
+bool cudaDrawList::RenderCPU( void* image, size_t width, size_t height, imageFormat format )
+{
+	if( !image || width == 0 || height == 0 )
+		return false;
+
+	const DrawCommand* commands = (DrawCommand*)mCommandsCPU;
+
+	if( format == IMAGE_RGB8 )
+		cpuDrawList<uchar3>((uchar3*)image, width, height, commands, mNumCommands);
+	else if( format == IMAGE_RGBA8 )
+		cpuDrawList<uchar4>((uchar4*)image, width, height, commands, mNumCommands);
+	else if( format == IMAGE_RGB32F )
+		cpuDrawList<float3>((float3*)image, width, height, commands, mNumCommands);
+	else if( format == IMAGE_RGBA32F )
+		cpuDrawList<float4>((float4*)image, width, height, commands, mNumCommands);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaDrawList::RenderCPU()", format);
+		return false;
+	}
+
+	return true;
+}
@@ -27,6 +27,8 @@
 #include "cudaUtility.h"
 #include "imageFormat.h"
 
+#include <vector>
+
 
 /**
  * cudaDrawCircle
@@ -160,4 +162,132 @@ cudaError_t cudaDrawRect( T* image, size_t width, size_t height,
 	return cudaDrawRect(image, image, width, height, imageFormatFromType<T>(), left, top, right, bottom, color, line_color, line_width, stream); 
 }
 
+
+/**
+ * Batched list of drawing commands (circles, lines, and rects) that are recorded
+ * on the CPU and then rasterized together with a single CUDA kernel launch.
+ *
+ * Drawing hundreds of shapes with the individual cudaDrawCircle(), cudaDrawLine(),
+ * and cudaDrawRect() functions costs one kernel launch per shape.  Instead, the
+ * shapes can be queued with the Add*() functions and then drawn with Render().
+ * The image is divided into tiles, and each tile is processed by one CUDA block
+ * that blends the shapes overlapping it in the order that they were added.
+ *
+ * There is also a CPU implementation in RenderCPU() that produces the same output,
+ * which can be used for testing or when the image resides in CPU-only memory.
+ *
+ * @ingroup drawing
+ */
+class cudaDrawList
+{
+public:
+	/**
+	 * Create a new draw list that can hold up to the specified number of commands.
+	 * The command buffer is allocated in mapped CPU/GPU memory.
+	 */
+	static cudaDrawList* Create( uint32_t maxCommands=4096 );
+
+	/**
+	 * Destructor
+	 */
+	~cudaDrawList();
+
+	/**
+	 * Queue a filled circle centered at (cx,cy) with the specified radius.
+	 * @returns false if the command buffer is full or the radius is <= 0
+	 */
+	bool AddCircle( int cx, int cy, float radius, const float4& color );
+
+	/**
+	 * Queue a line from (x1,y1) to (x2,y2) with the specified color and width.
+	 * @returns false if the command buffer is full or the line width is <= 0
+	 */
+	bool AddLine( int x1, int y1, int x2, int y2, const float4& color, float line_width=1.0f );
+
+	/**
+	 * Queue a rect with the specified fill color and optional outline.
+	 * If the alpha of the fill color is 0, the rect won't be filled, and if
+	 * the alpha of the line color is 0, the outline won't be drawn.
+	 * @returns false if the command buffer is full or the rect has no area
+	 */
+	bool AddRect( int left, int top, int right, int bottom, const float4& color,
+	              const float4& line_color=make_float4(0,0,0,0), float line_width=1.0f );
+
+	/**
+	 * Rasterize all of the queued commands into the image with one kernel launch.
+	 * The image should be in GPU-accessible memory and can be in-place (input == output).
+	 * If the input and output are different, the input is first copied to the output.
+	 *
+	 * The list can be rendered more than once (i.e. into images of different sizes)
+	 * without synchronizing in between, because the tile bins aren't rewritten until
+	 * the previous Render() has finished on the GPU.
+	 *
+	 * @note the command buffer is shared with the GPU, so Clear() shouldn't be
+	 *       called until the stream has been synchronized after Render().
+	 */
+	cudaError_t Render( void* input, void* output, size_t width, size_t height, imageFormat format, cudaStream_t stream=0 );
+
+	/**
+	 * Rasterize all of the queued commands into the image with one kernel launch.
+	 */
+	inline cudaError_t Render( void* image, size_t width, size_t height, imageFormat format, cudaStream_t stream=0 )		{ return Render(image, image, width, height, format, stream); }
+
+	/**
+	 * Rasterize all of the queued commands into the image with one kernel launch.
+	 */
+	template<typename T> cudaError_t Render( T* image, size_t width, size_t height, cudaStream_t stream=0 )			{ return Render(image, image, width, height, imageFormatFromType<T>(), stream); }
+
+	/**
+	 * Rasterize all of the queued commands into an in-place image using the CPU.
+	 * The image should be in CPU-accessible memory (i.e. from cudaAllocMapped() or malloc()).
+	 * The result matches that of Render(), and the command buffer isn't modified.
+	 */
+	bool RenderCPU( void* image, size_t width, size_t height, imageFormat format );
+
+	/**
+	 * Rasterize all of the queued commands into an in-place image using the CPU.
+	 */
+	template<typename T> bool RenderCPU( T* image, size_t width, size_t height )		{ return RenderCPU(image, width, height, imageFormatFromType<T>()); }
+
+	/**
+	 * Remove all of the queued commands.
+	 */
+	inline void Clear()							{ mNumCommands = 0; }
+
+	/**
+	 * Return the number of queued commands.
+	 */
+	inline uint32_t GetNumCommands() const			{ return mNumCommands; }
+
+	/**
+	 * Return the maximum number of commands that can be queued.
+	 */
+	inline uint32_t GetMaxCommands() const			{ return mMaxCommands; }
+
+	/**
+	 * The size (in pixels) of the square tiles that the image is binned into.
+	 */
+	static const uint32_t TileSize = 16;
+
+protected:
+	cudaDrawList();
+
+	bool addCommand( int type, const float4& coords, float param, const float4& color );
+	bool binCommands( size_t width, size_t height );
+
+	void*    mCommandsCPU;
+	void*    mCommandsGPU;
+	uint32_t mNumCommands;
+	uint32_t mMaxCommands;
+
+	uint32_t* mBinsCPU;		// per-tile (offset, count, tile_x, tile_y) followed by the command indices
+	uint32_t* mBinsGPU;
+	size_t    mBinsSize;
+	uint32_t  mNumTiles;		// the number of tiles that have commands
+	cudaEvent_t mBinsEvent;	// recorded after the kernel that reads the bins
+	bool        mBinsPending;	// mBinsEvent was recorded and may not have completed
+
+	std::vector<uint32_t> mTileCounts;
+};
+
 #endif
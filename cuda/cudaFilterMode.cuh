@@ -172,6 +172,90 @@ __device__ inline T cudaFilterPixel( T* input, int x, int y,
 }
 
 
+/**
+ * CUDA device function for reading a pixel from an image with padded rows,
+ * where the pitch is the stride between the start of each row (in bytes).
+ * @ingroup cudaFilter
+ */
+template<typename T>
+__device__ __host__ inline T cudaReadPixelPitched( T* input, int x, int y, size_t pitch )
+{
+	return ((T*)((uint8_t*)input + y * pitch))[x];
+}
+
+/**
+ * Sample a pixel with bilinear or point filtering from an image with padded rows.
+ * This is the same as cudaFilterPixel(), except that rows are addressed by the pitch
+ * (in bytes) instead of the width, and it can also be called from host code.
+ *
+ * @param input pointer to the image
+ * @param pitch the stride between rows of the image (in bytes)
+ * @param x desired x-coordinate to sample
+ * @param y desired y-coordinate to sample
+ * @param width width of the input image
+ * @param height height of the input image
+ *
+ * @returns the filtered pixel from the input image
+ * @ingroup cudaFilter
+ */ 
+template<cudaFilterMode filter, typename T>
+__device__ __host__ inline T cudaFilterPixelPitched( T* input, size_t pitch, float x, float y, int width, int height )
+{
+	if( filter == FILTER_POINT )
+	{
+		return cudaReadPixelPitched(input, int(x), int(y), pitch);
+	}
+	else // FILTER_LINEAR
+	{
+		const float bx = x - 0.5f;
+		const float by = y - 0.5f;
+
+		const float cx = bx < 0.0f ? 0.0f : bx;
+		const float cy = by < 0.0f ? 0.0f : by;
+
+		const int x1 = int(cx);
+		const int y1 = int(cy);
+			
+		const int x2 = x1 >= width - 1 ? x1 : x1 + 1;	// bounds check
+		const int y2 = y1 >= height - 1 ? y1 : y1 + 1;
+		
+		const T samples[4] = {
+			cudaReadPixelPitched(input, x1, y1, pitch),
+			cudaReadPixelPitched(input, x2, y1, pitch),
+			cudaReadPixelPitched(input, x1, y2, pitch),
+			cudaReadPixelPitched(input, x2, y2, pitch) };
+
+		// compute bilinear weights
+		const float x1d = cx - float(x1);
+		const float y1d = cy - float(y1);
+
+		const float x1f = 1.0f - x1d;
+		const float y1f = 1.0f - y1d;
+
+		const float x2f = 1.0f - x1f;
+		const float y2f = 1.0f - y1f;
+
+		return samples[0] * (x1f * y1f) + samples[1] * (x2f * y1f) + samples[2] * (x1f * y2f) + samples[3] * (x2f * y2f);
+	}
+}
+
+/**
+ * Sample a pixel with bilinear or point filtering from an image with padded rows,
+ * given the coordinates in the output image (as in cudaFilterPixel()).
+ * @ingroup cudaFilter
+ */ 
+template<cudaFilterMode filter, typename T>
+__device__ __host__ inline T cudaFilterPixelPitched( T* input, size_t pitch, int x, int y,
+						             int input_width, int input_height,
+						             int output_width, int output_height )
+{
+	const float px = float(x) / float(output_width) * float(input_width);
+	const float py = float(y) / float(output_height) * float(input_height);
+
+	return cudaFilterPixelPitched<filter>(input, pitch, px, py, input_width, input_height);
+}
+
+
 #endif
 
 
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CUDA_IMAGE_VIEW_H__
+#define __CUDA_IMAGE_VIEW_H__
+
+
+#include "cudaUtility.h"
+#include "imageFormat.h"
+
+
+/**
+ * Descriptor of an image in memory whose rows may be padded, for example
+ * from cudaMallocPitch(), NVMM surfaces, or V4L2 buffers with `bytesperline`.
+ *
+ * The pitch is the stride between the start of consecutive rows (in bytes),
+ * and must be at least the size of a tightly-packed row.  A view can also
+ * reference a region-of-interest inside of a larger image (see Crop()), which
+ * allows the ROI to be processed in-place without first copying it out.
+ *
+ * For the semi-planar formats (NV12, NV16, P010 and P016), the pitch applies to
+ * both the luma and chroma planes, and the interleaved UV plane starts at
+ * `ptr + pitch * height`.  The other planar 4:2:0 formats (I420 and YV12)
+ * only support packed views.
+ *
+ * cudaImageView is accepted by cudaResize(), cudaCrop(), cudaOverlay(), and
+ * cudaConvertColor(), along with their CPU reference implementations.
+ *
+ * @ingroup cudaMemory
+ */
+struct cudaImageView
+{
+	void*       ptr;		/**< Pointer to the first pixel of the image */
+	size_t      width;	/**< Width of the image (in pixels) */
+	size_t      height;	/**< Height of the image (in pixels) */
+	size_t      pitch;	/**< Stride between rows (in bytes) */
+	imageFormat format;	/**< Format of the image */
+
+	/**
+	 * Create an empty (invalid) view.
+	 */
+	inline cudaImageView() : ptr(NULL), width(0), height(0), pitch(0), format(IMAGE_UNKNOWN)	{ }
+
+	/**
+	 * Create a view of a tightly-packed image.
+	 */
+	inline cudaImageView( void* image, size_t image_width, size_t image_height, imageFormat image_format )
+		: ptr(image), width(image_width), height(image_height), pitch(PackedPitch(image_format, image_width)), format(image_format)	{ }
+
+	/**
+	 * Create a view of an image with the specified row pitch (in bytes).
+	 */
+	inline cudaImageView( void* image, size_t image_width, size_t image_height, size_t image_pitch, imageFormat image_format )
+		: ptr(image), width(image_width), height(image_height), pitch(image_pitch), format(image_format)	{ }
+
+	/**
+	 * Return the size of each pixel (in bytes), or 0 for planar formats.
+	 */
+	inline size_t PixelSize() const			{ return PixelSize(format); }
+
+	/**
+	 * Return the size of a tightly-packed row (in bytes).
+	 */
+	inline size_t RowSize() const			{ return PackedPitch(format, width); }
+
+	/**
+	 * Return the number of bytes spanned by the image, including the padding.
+	 */
+	inline size_t Size() const				{ return pitch * Rows(format, height); }
+
+	/**
+	 * Return true if the rows are tightly packed (i.e. there is no padding).
+	 */
+	inline bool IsPacked() const				{ return pitch == RowSize(); }
+
+	/**
+	 * Return true if the view is non-empty and the pitch spans a complete row.
+	 */
+	inline bool IsValid() const				{ return ptr != NULL && width > 0 && height > 0 && format != IMAGE_UNKNOWN && pitch >= RowSize(); }
+
+	/**
+	 * Return a pointer to the start of row `y`.
+	 */
+	template<typename T> inline T* Row( size_t y ) const	{ return (T*)((uint8_t*)ptr + y * pitch); }
+
+	/**
+	 * Return a view of the region-of-interest `(left, top, right, bottom)`
+	 * that references the same memory (no data is copied).  The pitch of the
+	 * returned view is the same as this image.  If the ROI is out-of-bounds or
+	 * the format can't be sub-divided (i.e. planar YUV), an invalid view is returned.
+	 */
+	inline cudaImageView Crop( const int4& roi ) const
+	{
+		const size_t pixelSize = PixelSize();
+
+		if( pixelSize == 0 || roi.x < 0 || roi.y < 0 || roi.z <= roi.x || roi.w <= roi.y || roi.z > (int)width || roi.w > (int)height )
+			return cudaImageView();
+
+		if( (format == IMAGE_YUYV || format == IMAGE_YVYU || format == IMAGE_UYVY) && (roi.x % 2 != 0 || roi.z % 2 != 0) )
+			return cudaImageView();	// 4:2:2 macropixels span two pixels
+
+		return cudaImageView(Row<uint8_t>(roi.y) + roi.x * pixelSize, roi.z - roi.x, roi.w - roi.y, pitch, format);
+	}
+
+	/**
+	 * Return the size of each pixel in the format (in bytes), or 0 for planar formats.
+	 */
+	static inline size_t PixelSize( imageFormat format )
+	{
+		if( format == IMAGE_I420 || format == IMAGE_YV12 || format == IMAGE_UNKNOWN || IsSemiPlanar(format) )
+			return 0;
+
+		return imageFormatDepth(format) / 8;
+	}
+
+	/**
+	 * Return the size of a tightly-packed row in the format (in bytes).
+	 * For planar and semi-planar formats, this is the size of a row in the luma plane.
+	 */
+	static inline size_t PackedPitch( imageFormat format, size_t width )
+	{
+		if( format == IMAGE_I420 || format == IMAGE_YV12 || format == IMAGE_NV12 || format == IMAGE_NV16 )
+			return width;
+
+		if( format == IMAGE_P010 || format == IMAGE_P016 )
+			return width * sizeof(uint16_t);
+
+		return width * PixelSize(format);
+	}
+
+	/**
+	 * Return the number of rows spanned by the luma and chroma planes of a
+	 * semi-planar image, or the height of the image for the other formats.
+	 */
+	static inline size_t Rows( imageFormat format, size_t height )
+	{
+		if( format == IMAGE_NV12 || format == IMAGE_P010 || format == IMAGE_P016 )
+			return height + height / 2;
+		else if( format == IMAGE_NV16 )
+			return height * 2;
+
+		return height;
+	}
+
+	/**
+	 * Return true if the format has a luma plane followed by an interleaved UV plane.
+	 */
+	static inline bool IsSemiPlanar( imageFormat format )
+	{
+		return (format == IMAGE_NV12 || format == IMAGE_NV16 || format == IMAGE_P010 || format == IMAGE_P016);
+	}
+};
+
+
+/**
+ * Copy the pixels from one view to another of the same format and size,
+ * adding or removing the row padding along the way (with cudaMemcpy2DAsync).
+ * @ingroup cudaMemory
+ */
+inline cudaError_t cudaImageCopy( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream=0 )
+{
+	if( !input.IsValid() || !output.IsValid() )
+		return cudaErrorInvalidValue;
+
+	if( input.format != output.format || input.width != output.width || input.height != output.height )
+		return cudaErrorInvalidValue;
+
+	if( input.format == IMAGE_I420 || input.format == IMAGE_YV12 )
+	{
+		if( !input.IsPacked() || !output.IsPacked() )
+			return cudaErrorInvalidValue;
+
+		return CUDA(cudaMemcpyAsync(output.ptr, input.ptr, imageFormatSize(input.format, input.width, input.height), cudaMemcpyDeviceToDevice, stream));
+	}
+
+	return CUDA(cudaMemcpy2DAsync(output.ptr, output.pitch, input.ptr, input.pitch, input.RowSize(), cudaImageView::Rows(input.format, input.height), cudaMemcpyDeviceToDevice, stream));
+}
+
+
+#endif
+
@@ -662,6 +662,29 @@ inline __host__ __device__ void operator+=(uchar4 &a, uchar b)
     a.w += b;
 }
 
+inline __host__ __device__ ushort3 operator+(ushort3 a, ushort3 b)
+{
+    return make_ushort3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+inline __host__ __device__ void operator+=(ushort3 &a, ushort3 b)
+{
+    a.x += b.x;
+    a.y += b.y;
+    a.z += b.z;
+}
+
+inline __host__ __device__ ushort4 operator+(ushort4 a, ushort4 b)
+{
+    return make_ushort4(a.x + b.x, a.y + b.y, a.z + b.z,  a.w + b.w);
+}
+inline __host__ __device__ void operator+=(ushort4 &a, ushort4 b)
+{
+    a.x += b.x;
+    a.y += b.y;
+    a.z += b.z;
+    a.w += b.w;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // subtract
 ////////////////////////////////////////////////////////////////////////////////
@@ -1233,6 +1256,37 @@ inline __host__ __device__ void operator*=(uchar4 &a, float b)
     a.w *= b;
 }
 
+inline __host__ __device__ ushort3 operator*(ushort3 a, float b)
+{
+    return make_ushort3(a.x * b, a.y * b, a.z * b);
+}
+inline __host__ __device__ ushort3 operator*(float b, ushort3 a)
+{
+    return make_ushort3(b * a.x, b * a.y, b * a.z);
+}
+inline __host__ __device__ void operator*=(ushort3 &a, float b)
+{
+    a.x *= b;
+    a.y *= b;
+    a.z *= b;
+}
+
+inline __host__ __device__ ushort4 operator*(ushort4 a, float b)
+{
+    return make_ushort4(a.x * b, a.y * b, a.z * b,  a.w * b);
+}
+inline __host__ __device__ ushort4 operator*(float b, ushort4 a)
+{
+    return make_ushort4(b * a.x, b * a.y, b * a.z,  b * a.w);
+}
+inline __host__ __device__ void operator*=(ushort4 &a, float b)
+{
+    a.x *= b;
+    a.y *= b;
+    a.z *= b;
+    a.w *= b;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // divide
 ////////////////////////////////////////////////////////////////////////////////
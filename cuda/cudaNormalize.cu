@@ -158,3 +158,91 @@ cudaError_t cudaNormalize( void* input,  const float2& input_range,
 }
 
 
+//-----------------------------------------------------------------------------------
+template <typename T>
+__global__ void gpuNormalizeAuto( T* input, T* output, int width, int height, 
+                                  const cudaImageStats* stats, float2 output_range )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	// the range is read from device memory, so it never leaves the GPU
+	const float2 input_range = stats->range;
+	const float  input_span  = input_range.y - input_range.x;
+	const float  scale = (input_span > 0.0f) ? (output_range.y - output_range.x) / input_span : 0.0f;
+
+	const float4 px = cast_vec<float4>(input[y * width + x]);
+
+	#define rescale_auto(v) (output_range.x + (v - input_range.x) * scale)
+
+	output[y * width + x] = make_vec<T>(rescale_auto(px.x),
+								 rescale_auto(px.y),
+								 rescale_auto(px.z),
+								 px.w);
+}
+
+template <>
+__global__ void gpuNormalizeAuto( float* input, float* output, int width, int height, 
+                                  const cudaImageStats* stats, float2 output_range )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	const float2 input_range = stats->range;
+	const float  input_span  = input_range.y - input_range.x;
+	const float  scale = (input_span > 0.0f) ? (output_range.y - output_range.x) / input_span : 0.0f;
+
+	output[y * width + x] = rescale_auto(input[y * width + x]);
+}
+
+// cudaNormalize (auto-range)
+cudaError_t cudaNormalize( void* input, const cudaImageStats* input_stats,
+                           void* output, const float2& output_range,
+                           size_t width, size_t height, imageFormat format,
+                           cudaStream_t stream )
+{
+	if( !input || !output )
+		return cudaErrorInvalidDevicePointer;
+
+	if( width == 0 || height == 0  )
+		return cudaErrorInvalidValue;
+
+	// compute the stats if they weren't provided
+	if( !input_stats )
+	{
+		cudaImageStats* stats = cudaReduceStatsBuffer();
+
+		if( !stats )
+			return cudaErrorMemoryAllocation;
+
+		CUDA_ASSERT(cudaReduceStats(input, width, height, format, stats, stream));
+		input_stats = stats;
+	}
+
+	// launch kernel
+	const dim3 blockDim(32,8);
+	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height,blockDim.y));
+
+	#define LAUNCH_NORMALIZE_AUTO(type) \
+		gpuNormalizeAuto<type><<<gridDim, blockDim, 0, stream>>>((type*)input, (type*)output, width, height, input_stats, output_range)
+
+	if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		LAUNCH_NORMALIZE_AUTO(float3);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		LAUNCH_NORMALIZE_AUTO(float4);
+	else if( format == IMAGE_GRAY32F )
+		LAUNCH_NORMALIZE_AUTO(float);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaNormalize()", format);
+		return cudaErrorInvalidValue;
+	}
+
+	return CUDA(cudaGetLastError());
+}
@@ -25,6 +25,7 @@
 
 
 #include "cudaUtility.h"
+#include "cudaReduce.h"
 #include "imageFormat.h"
 
 
@@ -77,6 +78,25 @@ cudaError_t cudaNormalize( void* input,  const float2& input_range,
                            size_t width, size_t height, imageFormat format,
                            cudaStream_t stream=0 );
 
+/**
+ * Normalize the pixel intensities of an image to the output range, using the range
+ * of pixel values that's found in the input image (auto-ranging).  The minimum value 
+ * of the color channels maps to `output_range.x`, and the maximum to `output_range.y`.
+ * The alpha channel (if any) is left unchanged.
+ *
+ * @param input_stats statistics of the input image from cudaReduceStats(), in device
+ *                    or mapped memory.  These remain on the GPU, so the range doesn't 
+ *                    need to be read back by the CPU.  If `NULL`, the statistics will
+ *                    be computed first with cudaReduceStats() into an internal buffer.
+ * @param output_range the desired range of pixel values of the output image (e.g. `[0,255]`)
+ * @param format the image format - valid formats are gray32f, rgb32f/bgr32f, and rgba32f/bgra32f.
+ * @ingroup normalization
+ */
+cudaError_t cudaNormalize( void* input,  const cudaImageStats* input_stats,
+                           void* output, const float2& output_range,
+                           size_t width, size_t height, imageFormat format,
+                           cudaStream_t stream=0 );
+
 
 #endif
 
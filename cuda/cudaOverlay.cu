@@ -26,7 +26,7 @@
 
 // cudaOverlay
 template<typename T>
-__global__ void gpuOverlay( T* input, int inputWidth, int inputHeight, T* output, int outputWidth, int outputHeight, int x0, int y0 ) 
+__global__ void gpuOverlay( T* input, size_t inputPitch, int inputWidth, int inputHeight, T* output, size_t outputPitch, int outputWidth, int outputHeight, int x0, int y0 ) 
 {
 	const int input_x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int input_y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -37,11 +37,11 @@ __global__ void gpuOverlay( T* input, int inputWidth, int inputHeight, T* output
 	if( input_x >= inputWidth || input_y >= inputHeight || x >= outputWidth || y >= outputHeight )
 		return;
 
-	output[y * outputWidth + x] = input[input_y * inputWidth + input_x];
+	((T*)((uint8_t*)output + y * outputPitch))[x] = ((T*)((uint8_t*)input + input_y * inputPitch))[input_x];
 }
 
 template<typename T>
-__global__ void gpuOverlayAlpha( T* input, int inputWidth, int inputHeight, T* output, int outputWidth, int outputHeight, int x0, int y0 ) 
+__global__ void gpuOverlayAlpha( T* input, size_t inputPitch, int inputWidth, int inputHeight, T* output, size_t outputPitch, int outputWidth, int outputHeight, int x0, int y0 ) 
 {
 	const int input_x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int input_y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -52,37 +52,54 @@ __global__ void gpuOverlayAlpha( T* input, int inputWidth, int inputHeight, T* o
 	if( input_x >= inputWidth || input_y >= inputHeight || x >= outputWidth || y >= outputHeight )
 		return;
 
-	output[y * outputWidth + x] = cudaAlphaBlend(output[y * outputWidth + x], input[input_y * inputWidth + input_x]);
+	T* out = (T*)((uint8_t*)output + y * outputPitch) + x;
+	*out = cudaAlphaBlend(*out, ((T*)((uint8_t*)input + input_y * inputPitch))[input_x]);
 }
 
-cudaError_t cudaOverlay( void* input, size_t inputWidth, size_t inputHeight,
-                         void* output, size_t outputWidth, size_t outputHeight,
-                         imageFormat format, int x, int y, cudaStream_t stream )
+// validateOverlay
+static bool validateOverlay( const cudaImageView& input, const cudaImageView& output, int x, int y, int* overlayWidth, int* overlayHeight )
 {
-	if( !input || !output || inputWidth == 0 || inputHeight == 0 || outputWidth == 0 || outputHeight == 0 )
-		return cudaErrorInvalidValue;
-	
-	if( x < 0 || y < 0 || x >= outputWidth || y >= outputHeight )
-		return cudaErrorInvalidValue;
+	if( !input.IsValid() || !output.IsValid() || input.format != output.format )
+		return false;
 	
-	if( !imageFormatIsRGB(format) && !imageFormatIsBGR(format) && !imageFormatIsGray(format) )
-		return cudaErrorInvalidValue;
+	if( x < 0 || y < 0 || x >= output.width || y >= output.height )
+		return false;
 	
-	int overlayWidth = inputWidth;
-	int overlayHeight = inputHeight;
+	if( !imageFormatIsRGB(input.format) && !imageFormatIsBGR(input.format) && !imageFormatIsGray(input.format) )
+		return false;
+
+	if( imageFormatBaseType(input.format) == IMAGE_UINT16 )
+		return false;	// 16-bit formats aren't supported
+
+	*overlayWidth = input.width;
+	*overlayHeight = input.height;
+
+	if( x + *overlayWidth >= output.width )
+		*overlayWidth = output.width - x;
+
+	if( y + *overlayHeight >= output.height )
+		*overlayHeight = output.height - y;
+
+	return true;
+}
 
-	if( x + overlayWidth >= outputWidth )
-		overlayWidth = outputWidth - x;
+// cudaOverlay (image view)
+cudaError_t cudaOverlay( const cudaImageView& input, const cudaImageView& output, int x, int y, cudaStream_t stream )
+{
+	int overlayWidth = 0;
+	int overlayHeight = 0;
 
-	if( y + overlayHeight >= outputHeight )
-		overlayHeight = outputHeight - y;
+	if( !validateOverlay(input, output, x, y, &overlayWidth, &overlayHeight) )
+		return cudaErrorInvalidValue;
 	
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(overlayWidth,blockDim.x), iDivUp(overlayHeight,blockDim.y));
 
 	#define launch_overlay(kernel, type)	\
-		kernel<type><<<gridDim, blockDim, 0, stream>>>((type*)input, inputWidth, inputHeight, (type*)output, outputWidth, outputHeight, x, y)
+		kernel<type><<<gridDim, blockDim, 0, stream>>>((type*)input.ptr, input.pitch, input.width, input.height, (type*)output.ptr, output.pitch, output.width, output.height, x, y)
 	
+	const imageFormat format = input.format;
+
 	if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
 		launch_overlay(gpuOverlay, uchar3);
 	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
@@ -98,6 +115,64 @@ cudaError_t cudaOverlay( void* input, size_t inputWidth, size_t inputHeight,
 	
 	return CUDA(cudaGetLastError());
 }	
+
+// cudaOverlay
+cudaError_t cudaOverlay( void* input, size_t inputWidth, size_t inputHeight,
+                         void* output, size_t outputWidth, size_t outputHeight,
+                         imageFormat format, int x, int y, cudaStream_t stream )
+{
+	return cudaOverlay(cudaImageView(input, inputWidth, inputHeight, format), 
+				    cudaImageView(output, outputWidth, outputHeight, format),
+				    x, y, stream);
+}
+
+// cpuOverlay
+template<typename T>
+static void cpuOverlay( const cudaImageView& input, const cudaImageView& output, int x0, int y0, int overlayWidth, int overlayHeight )
+{
+	for( int y=0; y < overlayHeight; y++ )
+		memcpy(output.Row<T>(y + y0) + x0, input.Row<T>(y), overlayWidth * sizeof(T));
+}
+
+template<typename T>
+static void cpuOverlayAlpha( const cudaImageView& input, const cudaImageView& output, int x0, int y0, int overlayWidth, int overlayHeight )
+{
+	for( int y=0; y < overlayHeight; y++ )
+	{
+		T* in  = input.Row<T>(y);
+		T* out = output.Row<T>(y + y0) + x0;
+
+		for( int x=0; x < overlayWidth; x++ )
+			out[x] = cudaAlphaBlend(out[x], in[x]);
+	}
+}
+
+// cudaOverlayCPU (image view)
+bool cudaOverlayCPU( const cudaImageView& input, const cudaImageView& output, int x, int y )
+{
+	int overlayWidth = 0;
+	int overlayHeight = 0;
+
+	if( !validateOverlay(input, output, x, y, &overlayWidth, &overlayHeight) )
+		return false;
+
+	const imageFormat format = input.format;
+
+	if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		cpuOverlay<uchar3>(input, output, x, y, overlayWidth, overlayHeight);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		cpuOverlayAlpha<uchar4>(input, output, x, y, overlayWidth, overlayHeight);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		cpuOverlay<float3>(input, output, x, y, overlayWidth, overlayHeight);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		cpuOverlayAlpha<float4>(input, output, x, y, overlayWidth, overlayHeight);
+	else if( format == IMAGE_GRAY8 )
+		cpuOverlay<uint8_t>(input, output, x, y, overlayWidth, overlayHeight);
+	else if( format == IMAGE_GRAY32F )
+		cpuOverlay<float>(input, output, x, y, overlayWidth, overlayHeight);
+
+	return true;
+}
 							 
 							 
 //----------------------------------------------------------------------------						 
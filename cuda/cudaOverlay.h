@@ -26,6 +26,7 @@
 
 #include "cudaUtility.h"
 #include "imageFormat.h"
+#include "cudaImageView.h"
 
 
 /**
@@ -65,6 +66,24 @@ cudaError_t cudaOverlay( T* input, const int2& inputDims,
 { 
 	return cudaOverlay(input, inputDims.x, inputDims.y, output, outputDims.x, outputDims.y, imageFormatFromType<T>(), x, y, stream); 
 }
+
+/**
+ * Overlay the input view onto the output view at location (x,y)
+ * The views can have padded rows, so for example the input could be an ROI of
+ * another image.  They must have the same format (grayscale, RGB/BGR, RGBA/BGRA).
+ * If the composted image doesn't entirely fit in the output, it will be cropped.
+ * If the images have an alpha channel, they will be alpha blended.
+ * @ingroup overlay
+ */
+cudaError_t cudaOverlay( const cudaImageView& input, const cudaImageView& output, int x, int y, cudaStream_t stream=0 );
+
+/**
+ * Overlay the input view onto the output view on the CPU, as a reference
+ * implementation of cudaOverlay().  The views should be in CPU-accessible memory.
+ * @returns true on success, false on an invalid view, location, or format.
+ * @ingroup overlay
+ */
+bool cudaOverlayCPU( const cudaImageView& input, const cudaImageView& output, int x, int y );
 		
 		
 /**
@@ -27,9 +27,16 @@
 #include "glBuffer.h"
 #include "glCamera.h"
 
+#include "Thread.h"
+#include "Event.h"
+
+#include "filesystem.h"
 #include "mat33.h"
 #include "logging.h"
 
+#include <unordered_map>
+#include <math.h>
+
 
 // constructor
 cudaPointCloud::cudaPointCloud()
@@ -47,12 +54,38 @@ cudaPointCloud::cudaPointCloud()
 	mHasRGB         = false;
 	mHasNewPoints	 = false;
 	mHasCalibration = false;
+
+	mSaveThread  = NULL;
+	mSaveEvent   = NULL;
+	mSaveDone    = NULL;
+	mSaveMutex   = NULL;
+	mSaveFormat  = FILE_DEFAULT;
+	mSaveHasRGB  = false;
+	mSavePending = false;
+	mSaveResult  = true;
+	mSaveStop    = false;
 }
 
 
 // destructor
 cudaPointCloud::~cudaPointCloud()
 {
+	if( mSaveThread != NULL )
+	{
+		WaitSave();
+
+		mSaveStop = true;
+		mSaveEvent->Wake();
+		mSaveThread->Stop(true);
+
+		delete mSaveThread;
+		mSaveThread = NULL;
+	}
+
+	SAFE_DELETE(mSaveEvent);
+	SAFE_DELETE(mSaveDone);
+	SAFE_DELETE(mSaveMutex);
+
 	if( mDepthResize != NULL )
 	{
 		CUDA(cudaFree(mDepthResize));
@@ -314,14 +347,142 @@ bool cudaPointCloud::SetCalibration( const char* filename )
 }
 
 
-// Save
-bool cudaPointCloud::Save( const char* filename )
+// lzfCompress (LZF format compatible with liblzf, as used by PCL for binary_compressed)
+static uint32_t lzfCompress( const uint8_t* input, uint32_t inputSize, uint8_t* output, uint32_t outputSize )
 {
-	if( !filename || mNumPoints == 0 || !mPointsCPU )
-		return false;
+	const uint32_t HashLog  = 14;
+	const uint32_t HashSize = (1 << HashLog);
+	const int      MaxLiteral = (1 << 5);
+	const uint32_t MaxOffset  = (1 << 13);
+	const uint32_t MaxRef     = (1 << 8) + (1 << 3);
+
+	#define LZF_HASH(h)  ((((h) >> (3*8 - HashLog)) - (h) * 5) & (HashSize - 1))
+
+	if( inputSize == 0 )
+		return 0;
+
+	std::vector<const uint8_t*> hashTable(HashSize, (const uint8_t*)NULL);
+
+	const uint8_t* ip = input;
+	const uint8_t* inputEnd = input + inputSize;
+
+	uint8_t* op = output;
+	uint8_t* outputEnd = output + outputSize;
+
+	int lit = 0;		// number of literals in the current run
+	op++;			// reserve the control byte of the first literal run
+
+	uint32_t hval = (inputSize > 1) ? ((ip[0] << 8) | ip[1]) : 0;
+
+	while( inputSize > 2 && ip < inputEnd - 2 )
+	{
+		hval = (hval << 8) | ip[2];
+
+		const uint8_t** slot = &hashTable[LZF_HASH(hval)];
+		const uint8_t* ref = *slot;
+		*slot = ip;
+
+		if( ref != NULL && uint32_t(ip - ref - 1) < MaxOffset && ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2] )
+		{
+			const uint32_t off = ip - ref - 1;
+
+			// back-reference match
+			uint32_t len = 2;
+			uint32_t maxlen = inputEnd - ip - len;
+
+			if( maxlen > MaxRef )
+				maxlen = MaxRef;
+
+			if( op + 4 >= outputEnd )
+				return 0;
+
+			// close the literal run (or reclaim its control byte if empty)
+			op[-lit-1] = lit - 1;
+			op -= !lit;
+
+			do
+				len++;
+			while( len < maxlen && ref[len] == ip[len] );
+
+			len -= 2;
+			ip++;
+
+			if( len < 7 )
+			{
+				*op++ = (off >> 8) + (len << 5);
+			}
+			else
+			{
+				*op++ = (off >> 8) + (7 << 5);
+				*op++ = len - 7;
+			}
+
+			*op++ = off;
+
+			lit = 0;
+			op++;
+
+			ip += len + 1;
+
+			if( ip >= inputEnd - 2 )
+				break;
+
+			hval = (ip[0] << 8) | ip[1];
+		}
+		else
+		{
+			// literal byte
+			if( op >= outputEnd )
+				return 0;
+
+			lit++;
+			*op++ = *ip++;
+
+			if( lit == MaxLiteral )
+			{
+				op[-lit-1] = lit - 1;
+				lit = 0;
+				op++;
+			}
+		}
+	}
+
+	// copy the remaining bytes as literals
+	while( ip < inputEnd )
+	{
+		if( op >= outputEnd )
+			return 0;
+
+		lit++;
+		*op++ = *ip++;
+
+		if( lit == MaxLiteral )
+		{
+			op[-lit-1] = lit - 1;
+			lit = 0;
+			op++;
+		}
+	}
+
+	op[-lit-1] = lit - 1;
+	op -= !lit;
+
+	return op - output;
+}
+
+
+// pack the color into 24 bits
+static inline uint32_t packRGB( const uchar3& color )
+{
+	return (uint32_t(color.x) << 16 | uint32_t(color.y) << 8 | uint32_t(color.z));
+}
 
+
+// savePCD
+bool cudaPointCloud::savePCD( const char* filename, const Vertex* points, uint32_t numPoints, bool hasRGB, FileFormat format )
+{
 	// open the PCD file
-	FILE* file = fopen(filename, "w");
+	FILE* file = fopen(filename, "wb");
 
 	if( !file )
 	{
@@ -329,59 +490,408 @@ bool cudaPointCloud::Save( const char* filename )
 		return false;
 	}
 
+	// use a large stdio buffer to reduce the number of write syscalls
+	const size_t bufferSize = 4 * 1024 * 1024;
+	setvbuf(file, NULL, _IOFBF, bufferSize);
+
 	// write the PCD header
 	fprintf(file, "# .PCD v0.7 - Point Cloud Data file format\n");
 	fprintf(file, "VERSION 0.7\n");
 
-	if( mHasRGB )
+	if( hasRGB )
 	{
 		fprintf(file, "FIELDS x y z rgb\n");
 		fprintf(file, "SIZE 4 4 4 4\n");
 		fprintf(file, "TYPE F F F U\n");
+		fprintf(file, "COUNT 1 1 1 1\n");
 	}
 	else
 	{
 		fprintf(file, "FIELDS x y z\n");
 		fprintf(file, "SIZE 4 4 4\n");
 		fprintf(file, "TYPE F F F\n");
+		fprintf(file, "COUNT 1 1 1\n");
 	}
 
-	fprintf(file, "COUNT 1 1 1 1\n");
-	fprintf(file, "WIDTH %u\n", mNumPoints);
+	fprintf(file, "WIDTH %u\n", numPoints);
 	fprintf(file, "HEIGHT 1\n");
 	fprintf(file, "VIEWPOINT 0 0 0 1 0 0 0\n");
-	fprintf(file, "POINTS %u\n", mNumPoints);
-	fprintf(file, "DATA ascii\n");
+	fprintf(file, "POINTS %u\n", numPoints);
+
+	bool result = true;
+
+	if( format == PCD_ASCII )
+	{
+		fprintf(file, "DATA ascii\n");
+
+		// write out points to the PCD file
+		for( size_t n=0; n < numPoints; n++ )
+		{
+			const Vertex* point = points + n;
+
+			if( hasRGB )
+				fprintf(file, "%f %f %f %u\n", point->pos.x, point->pos.y, point->pos.z, packRGB(point->color));
+			else
+				fprintf(file, "%f %f %f\n", point->pos.x, point->pos.y, point->pos.z);
+		}
+	}
+	else if( format == PCD_BINARY )
+	{
+		fprintf(file, "DATA binary\n");
+
+		// convert the points into records in chunks, and write each chunk at once
+		const uint32_t numFields = hasRGB ? 4 : 3;
+		const uint32_t chunkPoints = 65536;
+
+		std::vector<uint32_t> chunk(chunkPoints * numFields);
+
+		for( uint32_t n=0; n < numPoints && result; n += chunkPoints )
+		{
+			const uint32_t count = (numPoints - n < chunkPoints) ? (numPoints - n) : chunkPoints;
+			uint32_t* record = chunk.data();
+
+			for( uint32_t i=0; i < count; i++ )
+			{
+				const Vertex* point = points + n + i;
+
+				memcpy(record, &point->pos, sizeof(float3));
+
+				if( hasRGB )
+					record[3] = packRGB(point->color);
+
+				record += numFields;
+			}
+
+			result = (fwrite(chunk.data(), sizeof(uint32_t) * numFields, count, file) == count);
+		}
+	}
+	else if( format == PCD_BINARY_COMPRESSED )
+	{
+		fprintf(file, "DATA binary_compressed\n");
+
+		// binary_compressed stores each field contiguously (x x x... y y y...)
+		const uint32_t numFields = hasRGB ? 4 : 3;
+		const uint32_t uncompressedSize = numPoints * numFields * sizeof(uint32_t);
+		const uint32_t compressedMax = uncompressedSize + uncompressedSize / 16 + 64;
+
+		std::vector<uint32_t> fields(numPoints * numFields);
+		std::vector<uint8_t> compressed(compressedMax);
+
+		for( uint32_t n=0; n < numPoints; n++ )
+		{
+			const Vertex* point = points + n;
+
+			memcpy(&fields[n], &point->pos.x, sizeof(float));
+			memcpy(&fields[numPoints + n], &point->pos.y, sizeof(float));
+			memcpy(&fields[numPoints * 2 + n], &point->pos.z, sizeof(float));
+
+			if( hasRGB )
+				fields[numPoints * 3 + n] = packRGB(point->color);
+		}
+
+		const uint32_t compressedSize = lzfCompress((uint8_t*)fields.data(), uncompressedSize, compressed.data(), compressedMax);
+
+		if( compressedSize == 0 )
+		{
+			LogError(LOG_CUDA "cudaPointCloud::Save() -- failed to compress %s\n", filename);
+			result = false;
+		}
+		else
+		{
+			result = (fwrite(&compressedSize, sizeof(uint32_t), 1, file) == 1) &&
+				    (fwrite(&uncompressedSize, sizeof(uint32_t), 1, file) == 1) &&
+				    (fwrite(compressed.data(), 1, compressedSize, file) == compressedSize);
+		}
+	}
+	else
+	{
+		LogError(LOG_CUDA "cudaPointCloud::Save() -- invalid PCD format (%i)\n", (int)format);
+		result = false;
+	}
+
+	if( fclose(file) != 0 )
+		result = false;
+
+	if( !result )
+		LogError(LOG_CUDA "cudaPointCloud::Save() -- failed to write %s\n", filename);
+
+	return result;
+}
+
+
+// savePLY
+bool cudaPointCloud::savePLY( const char* filename, const Vertex* points, uint32_t numPoints )
+{
+	static_assert(sizeof(Vertex) == 16, "cudaPointCloud::Vertex should be packed into 16 bytes");
+
+	FILE* file = fopen(filename, "wb");
+
+	if( !file )
+	{
+		LogError(LOG_CUDA "cudaPointCloud::Save() -- failed to create %s\n", filename);
+		return false;
+	}
+
+	// the PLY properties are in the same order as the Vertex struct,
+	// so the points can be written directly with one large write
+	fprintf(file, "ply\n");
+	fprintf(file, "format binary_little_endian 1.0\n");
+	fprintf(file, "element vertex %u\n", numPoints);
+	fprintf(file, "property float x\n");
+	fprintf(file, "property float y\n");
+	fprintf(file, "property float z\n");
+	fprintf(file, "property uchar red\n");
+	fprintf(file, "property uchar green\n");
+	fprintf(file, "property uchar blue\n");
+	fprintf(file, "property uchar class\n");
+	fprintf(file, "end_header\n");
+
+	bool result = (fwrite(points, sizeof(Vertex), numPoints, file) == numPoints);
+
+	if( fclose(file) != 0 )
+		result = false;
+
+	if( !result )
+		LogError(LOG_CUDA "cudaPointCloud::Save() -- failed to write %s\n", filename);
+
+	return result;
+}
+
+
+// Save
+bool cudaPointCloud::Save( const char* filename, FileFormat format )
+{
+	if( !filename || mNumPoints == 0 || !mPointsCPU )
+		return false;
+
+	if( format == FILE_DEFAULT )
+		format = fileHasExtension(filename, "ply") ? PLY_BINARY : PCD_ASCII;
 
 	// wait for the GPU to finish any processing
 	CUDA(cudaDeviceSynchronize());
 
-	// write out points to the PCD file
-	for( size_t n=0; n < mNumPoints; n++ )
-	{
-		Vertex* point = GetData(n);
+	if( format == PLY_BINARY )
+		return savePLY(filename, mPointsCPU, mNumPoints);
+
+	return savePCD(filename, mPointsCPU, mNumPoints, mHasRGB, format);
+}
 
-		// output XYZ coordinates
-		fprintf(file, "%f %f %f", point->pos.x, point->pos.y, point->pos.z);
 
-		// output RGB color
-		if( mHasRGB )
+// SaveAsync
+bool cudaPointCloud::SaveAsync( const char* filename, FileFormat format )
+{
+	if( !filename || mNumPoints == 0 || !mPointsCPU )
+		return false;
+
+	if( !mSaveThread )
+	{
+		mSaveEvent  = new Event();
+		mSaveDone   = new Event();
+		mSaveMutex  = new Mutex();
+		mSaveThread = new Thread();
+
+		if( !mSaveThread->Start(saveThread, this) )
 		{
-			// pack the color into 24 bits
-			const uint32_t rgb_packed = (uint32_t(point->color.x) << 16 |
-	      					         uint32_t(point->color.y) << 8 | 
-							         uint32_t(point->color.z));
-		
-			fprintf(file, " %u", rgb_packed);
+			LogError(LOG_CUDA "cudaPointCloud::SaveAsync() -- failed to start background thread\n");
+			
+			delete mSaveThread;
+			mSaveThread = NULL;
+
+			return false;
 		}
+	}
+
+	// wait for the previous save to finish with the buffer
+	WaitSave();
+
+	if( format == FILE_DEFAULT )
+		format = fileHasExtension(filename, "ply") ? PLY_BINARY : PCD_ASCII;
+
+	// wait for the GPU to finish any processing
+	CUDA(cudaDeviceSynchronize());
+
+	// copy the points, so that the point cloud can be used again
+	mSaveBuffer.assign(mPointsCPU, mPointsCPU + mNumPoints);
+
+	mSaveMutex->Lock();
+	mSaveFilename = filename;
+	mSaveFormat   = format;
+	mSaveHasRGB   = mHasRGB;
+	mSavePending  = true;
+	mSaveMutex->Unlock();
+
+	mSaveEvent->Wake();
+	return true;
+}
+
 
-		fprintf(file, "\n");
+// WaitSave
+bool cudaPointCloud::WaitSave()
+{
+	if( !mSaveThread )
+		return true;
+
+	while( true )
+	{
+		mSaveMutex->Lock();
+		const bool pending = mSavePending;
+		const bool result  = mSaveResult;
+		mSaveMutex->Unlock();
+
+		if( !pending )
+			return result;
+
+		mSaveDone->Wait();
 	}
-		
-	fclose(file);
+}
+
+
+// saveThread
+void* cudaPointCloud::saveThread( void* user_data )
+{
+	cudaPointCloud* cloud = (cudaPointCloud*)user_data;
+
+	while( true )
+	{
+		cloud->mSaveEvent->Wait();
+
+		if( cloud->mSaveStop )
+			break;
+
+		// the buffer isn't touched by the main thread while a save is pending
+		bool result = false;
+
+		if( cloud->mSaveFormat == PLY_BINARY )
+			result = savePLY(cloud->mSaveFilename.c_str(), cloud->mSaveBuffer.data(), cloud->mSaveBuffer.size());
+		else
+			result = savePCD(cloud->mSaveFilename.c_str(), cloud->mSaveBuffer.data(), cloud->mSaveBuffer.size(), cloud->mSaveHasRGB, cloud->mSaveFormat);
+
+		cloud->mSaveMutex->Lock();
+		cloud->mSaveResult  = result;
+		cloud->mSavePending = false;
+		cloud->mSaveMutex->Unlock();
+
+		cloud->mSaveDone->Wake();
+	}
+
+	return NULL;
+}
+
+
+// DownsampleStride
+bool cudaPointCloud::DownsampleStride( uint32_t stride )
+{
+	if( stride == 0 || !mPointsCPU )
+		return false;
+
+	if( stride == 1 || mNumPoints == 0 )
+		return true;
+
+	// wait for the GPU to finish any processing
+	CUDA(cudaDeviceSynchronize());
+
+	uint32_t numPoints = 0;
+
+	for( uint32_t n=0; n < mNumPoints; n += stride )
+		mPointsCPU[numPoints++] = mPointsCPU[n];
+
+	mNumPoints = numPoints;
+	mHasNewPoints = true;
+
 	return true;
 }
 
 
+// DownsampleVoxel
+bool cudaPointCloud::DownsampleVoxel( float voxelSize )
+{
+	if( voxelSize <= 0.0f || !mPointsCPU )
+		return false;
+
+	if( mNumPoints == 0 )
+		return true;
+
+	// wait for the GPU to finish any processing
+	CUDA(cudaDeviceSynchronize());
+
+	struct Voxel
+	{
+		float3 pos;
+		uint3  color;
+		uint32_t count;
+		uint8_t  classID;
+	};
+
+	const float invSize = 1.0f / voxelSize;
+	const int64_t keyRange = (1 << 20);	// 21 bits per axis, centered at zero
+
+	std::unordered_map<uint64_t, uint32_t> voxelMap;
+	std::vector<Voxel> voxels;
 
+	voxelMap.reserve(mNumPoints / 4);
 
+	// accumulate the points in each voxel
+	for( uint32_t n=0; n < mNumPoints; n++ )
+	{
+		const Vertex& point = mPointsCPU[n];
+
+		if( !isfinite(point.pos.x) || !isfinite(point.pos.y) || !isfinite(point.pos.z) )
+			continue;
+
+		const int64_t vx = (int64_t)floorf(point.pos.x * invSize) + keyRange;
+		const int64_t vy = (int64_t)floorf(point.pos.y * invSize) + keyRange;
+		const int64_t vz = (int64_t)floorf(point.pos.z * invSize) + keyRange;
+
+		if( vx < 0 || vy < 0 || vz < 0 || vx >= keyRange * 2 || vy >= keyRange * 2 || vz >= keyRange * 2 )
+			continue;
+
+		const uint64_t key = (uint64_t(vx) << 42) | (uint64_t(vy) << 21) | uint64_t(vz);
+		const auto result = voxelMap.insert(std::make_pair(key, (uint32_t)voxels.size()));
+
+		if( result.second )
+		{
+			Voxel voxel;
+
+			voxel.pos     = point.pos;
+			voxel.color   = make_uint3(point.color.x, point.color.y, point.color.z);
+			voxel.count   = 1;
+			voxel.classID = point.classID;
+
+			voxels.push_back(voxel);
+		}
+		else
+		{
+			Voxel& voxel = voxels[result.first->second];
+
+			voxel.pos.x += point.pos.x;
+			voxel.pos.y += point.pos.y;
+			voxel.pos.z += point.pos.z;
+
+			voxel.color.x += point.color.x;
+			voxel.color.y += point.color.y;
+			voxel.color.z += point.color.z;
+
+			voxel.count++;
+		}
+	}
+
+	// replace the points with the voxel centroids
+	const uint32_t numVoxels = voxels.size();
+
+	for( uint32_t n=0; n < numVoxels; n++ )
+	{
+		const Voxel& voxel = voxels[n];
+		const float scale = 1.0f / voxel.count;
+
+		mPointsCPU[n].pos = make_float3(voxel.pos.x * scale, voxel.pos.y * scale, voxel.pos.z * scale);
+		mPointsCPU[n].color = make_uchar3(voxel.color.x / voxel.count, voxel.color.y / voxel.count, voxel.color.z / voxel.count);
+		mPointsCPU[n].classID = voxel.classID;
+	}
+
+	LogVerbose(LOG_CUDA "cudaPointCloud::DownsampleVoxel() -- downsampled %u points to %u points (voxel size %f)\n", mNumPoints, numVoxels, voxelSize);
+
+	mNumPoints = numVoxels;
+	mHasNewPoints = true;
+
+	return true;
+}
@@ -26,10 +26,16 @@
 
 #include "cudaUtility.h"
 
+#include <string>
+#include <vector>
+
 
 // forward declarations
 class glBuffer;
 class glCamera;
+class Thread;
+class Event;
+class Mutex;
 
 
 /**
@@ -63,6 +69,18 @@ public:
 
 	} __attribute__((packed));
 
+	/**
+	 * File formats that the point cloud can be saved in.
+	 */
+	enum FileFormat
+	{
+		FILE_DEFAULT = 0,		/**< Binary PLY for files ending in .ply, otherwise ASCII PCD */
+		PCD_ASCII,			/**< PCD with the points stored as text */
+		PCD_BINARY,			/**< PCD with the points stored as binary records */
+		PCD_BINARY_COMPRESSED,	/**< PCD with the fields stored separately and LZF-compressed */
+		PLY_BINARY			/**< Little-endian binary PLY (x, y, z, red, green, blue, class) */
+	};
+
 	/**
 	 * Create
 	 */
@@ -144,9 +162,38 @@ public:
 	bool Render();
 
 	/**
-	 * Save point cloud to PCD file.
+	 * Save point cloud to PCD or PLY file.
+	 * The points are written from CPU memory using large buffered writes.
+	 */
+	bool Save( const char* filename, FileFormat format=FILE_DEFAULT );
+
+	/**
+	 * Save point cloud to PCD or PLY file from a background thread.
+	 * The points are copied before this function returns, so the point cloud
+	 * can be modified again by Extract() while the file is still being written.
+	 * If a previous save is still in progress, this will wait for it to finish.
+	 */
+	bool SaveAsync( const char* filename, FileFormat format=FILE_DEFAULT );
+
+	/**
+	 * Wait for any background saves from SaveAsync() to complete.
+	 * @returns false if the last background save failed.
 	 */
-	bool Save( const char* filename );
+	bool WaitSave();
+
+	/**
+	 * Downsample the point cloud by averaging the points inside each cell of a voxel grid.
+	 * The positions and colors of the points in each voxel are averaged together,
+	 * and non-finite points are removed.  This operates on the CPU, after Extract().
+	 * @param voxelSize the length of each side of the voxels (in the same units as depth)
+	 */
+	bool DownsampleVoxel( float voxelSize );
+
+	/**
+	 * Downsample the point cloud by keeping every N-th point.
+	 * This operates on the CPU, after Extract().
+	 */
+	bool DownsampleStride( uint32_t stride );
 
 	/**
 	 * Set the intrinsic camera calibration.
@@ -168,6 +215,10 @@ protected:
 
 	bool allocBufferGL();
 	bool allocDepthResize( size_t size );
+
+	static bool savePCD( const char* filename, const Vertex* points, uint32_t numPoints, bool hasRGB, FileFormat format );
+	static bool savePLY( const char* filename, const Vertex* points, uint32_t numPoints );
+	static void* saveThread( void* user_data );
 	
 	Vertex* mPointsCPU;
 	Vertex* mPointsGPU;
@@ -187,6 +238,21 @@ protected:
 	bool mHasRGB;
 	bool mHasNewPoints;
 	bool mHasCalibration;
+
+	// background saving
+	Thread* mSaveThread;
+	Event*  mSaveEvent;
+	Event*  mSaveDone;
+	Mutex*  mSaveMutex;
+
+	std::vector<Vertex> mSaveBuffer;
+	std::string mSaveFilename;
+	FileFormat  mSaveFormat;
+	
+	bool mSaveHasRGB;
+	bool mSavePending;
+	bool mSaveResult;
+	bool mSaveStop;
 };
 
 #endif
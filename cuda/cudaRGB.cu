@@ -22,6 +22,9 @@
 
 #include "cudaRGB.h"
 #include "cudaVector.h"
+#include "cudaImageView.h"
+
+#include "logging.h"
 
 
 //-----------------------------------------------------------------------------------
@@ -275,3 +278,226 @@ cudaError_t cudaRGBA32ToRGBA8( float4* srcDev, uchar4* dstDev, size_t width, siz
 	else
 		return launchRGBToRGB_Norm<float4, uchar4, false>(srcDev, dstDev, width, height, inputRange, stream);
 }
+
+
+//-----------------------------------------------------------------------------------
+// RGB/BGR/grayscale conversion between image views with padded rows
+//-----------------------------------------------------------------------------------
+static inline __device__ __host__ float4 loadRGBA( uint8_t px, float default_alpha )	{ return make_float4(px, px, px, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( float px, float default_alpha )		{ return make_float4(px, px, px, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( uchar3 px, float default_alpha )	{ return make_float4(px.x, px.y, px.z, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( uchar4 px, float default_alpha )	{ return make_float4(px.x, px.y, px.z, px.w); }
+static inline __device__ __host__ float4 loadRGBA( float3 px, float default_alpha )	{ return make_float4(px.x, px.y, px.z, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( float4 px, float default_alpha )	{ return px; }
+static inline __device__ __host__ float4 loadRGBA( ushort px, float default_alpha )	{ return make_float4(px, px, px, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( ushort3 px, float default_alpha )	{ return make_float4(px.x, px.y, px.z, default_alpha); }
+static inline __device__ __host__ float4 loadRGBA( ushort4 px, float default_alpha )	{ return make_float4(px.x, px.y, px.z, px.w); }
+
+// integer outputs are rounded and clamped to the range of the type
+static inline __device__ __host__ float roundPixel( float value, float max_value )	{ return fminf(fmaxf(value + 0.5f, 0.0f), max_value); }
+static inline __device__ __host__ float grayPixel( const float4& px )			{ return px.x * 0.2989f + px.y * 0.5870f + px.z * 0.1140f; }
+
+template<typename T> inline __device__ __host__ T storeRGBA( const float4& px )		{ return make_vec<T>(px.x, px.y, px.z, px.w); }
+
+template<> inline __device__ __host__ float storeRGBA( const float4& px )			{ return grayPixel(px); }
+template<> inline __device__ __host__ uint8_t storeRGBA( const float4& px )		{ return roundPixel(grayPixel(px), 255.0f); }
+template<> inline __device__ __host__ ushort storeRGBA( const float4& px )			{ return roundPixel(grayPixel(px), 65535.0f); }
+
+template<> inline __device__ __host__ uchar3 storeRGBA( const float4& px )			{ return make_uchar3(roundPixel(px.x, 255.0f), roundPixel(px.y, 255.0f), roundPixel(px.z, 255.0f)); }
+template<> inline __device__ __host__ uchar4 storeRGBA( const float4& px )			{ return make_uchar4(roundPixel(px.x, 255.0f), roundPixel(px.y, 255.0f), roundPixel(px.z, 255.0f), roundPixel(px.w, 255.0f)); }
+template<> inline __device__ __host__ ushort3 storeRGBA( const float4& px )		{ return make_ushort3(roundPixel(px.x, 65535.0f), roundPixel(px.y, 65535.0f), roundPixel(px.z, 65535.0f)); }
+template<> inline __device__ __host__ ushort4 storeRGBA( const float4& px )		{ return make_ushort4(roundPixel(px.x, 65535.0f), roundPixel(px.y, 65535.0f), roundPixel(px.z, 65535.0f), roundPixel(px.w, 65535.0f)); }
+
+// convertRGBA (one pixel, shared between the GPU and CPU implementations)
+template<typename T_in, typename T_out>
+inline __device__ __host__ T_out convertRGBA( const T_in& in, bool swapRedBlue, float min_pixel_value, float scaling_factor, float default_alpha )
+{
+	float4 px = loadRGBA(in, default_alpha);
+
+	if( swapRedBlue )
+		px = make_float4(px.z, px.y, px.x, px.w);
+
+	px.x = (px.x - min_pixel_value) * scaling_factor;
+	px.y = (px.y - min_pixel_value) * scaling_factor;
+	px.z = (px.z - min_pixel_value) * scaling_factor;
+	px.w = (px.w - min_pixel_value) * scaling_factor;
+
+	return storeRGBA<T_out>(px);
+}
+
+template<typename T_in, typename T_out>
+__global__ void RGBToRGB_Pitched( T_in* srcImage, size_t srcPitch, T_out* dstImage, size_t dstPitch, int width, int height,
+						    bool swapRedBlue, float min_pixel_value, float scaling_factor, float default_alpha )
+{
+	const int x = (blockIdx.x * blockDim.x) + threadIdx.x;
+	const int y = (blockIdx.y * blockDim.y) + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	const T_in px = ((T_in*)((uint8_t*)srcImage + y * srcPitch))[x];
+	((T_out*)((uint8_t*)dstImage + y * dstPitch))[x] = convertRGBA<T_in, T_out>(px, swapRedBlue, min_pixel_value, scaling_factor, default_alpha);
+}
+
+// rgbConvertParams
+struct rgbConvertParams
+{
+	bool  swapRedBlue;
+	float minPixelValue;
+	float scalingFactor;
+	float defaultAlpha;
+};
+
+static rgbConvertParams rgbConvertSetup( imageFormat inputFormat, imageFormat outputFormat, const float2& pixelRange )
+{
+	rgbConvertParams params;
+
+	// swap the channels between RGB <-> BGR, and so BGR is weighted as RGB for grayscale
+	params.swapRedBlue = (imageFormatIsRGB(inputFormat) && imageFormatIsBGR(outputFormat)) ||
+					 (imageFormatIsBGR(inputFormat) && (imageFormatIsRGB(outputFormat) || imageFormatIsGray(outputFormat)));
+
+	// float <-> float conversions keep the original pixel values
+	const imageBaseType inputType = imageFormatBaseType(inputFormat);
+	const imageBaseType outputType = imageFormatBaseType(outputFormat);
+
+	if( inputType == IMAGE_FLOAT && outputType == IMAGE_FLOAT )
+	{
+		params.minPixelValue = 0.0f;
+		params.scalingFactor = 1.0f;
+		params.defaultAlpha  = 255.0f;
+		return params;
+	}
+
+	// otherwise rescale from the input range to the output range, where float
+	// inputs use the pixel range and float outputs use [0,255] like uint8
+	float2 inputRange = make_float2(0.0f, 255.0f);
+	float  outputMax  = 255.0f;
+
+	if( inputType == IMAGE_FLOAT )
+		inputRange = pixelRange;
+	else if( inputType == IMAGE_UINT16 )
+		inputRange.y = 65535.0f;
+
+	if( outputType == IMAGE_UINT16 )
+		outputMax = 65535.0f;
+
+	params.minPixelValue = inputRange.x;
+	params.scalingFactor = outputMax / (inputRange.y - inputRange.x);
+	params.defaultAlpha  = inputRange.y;
+
+	return params;
+}
+
+template<typename T_in, typename T_out> 
+static cudaError_t launchRGBToRGB_Pitched( const cudaImageView& input, const cudaImageView& output, const float2& pixelRange, cudaStream_t stream )
+{
+	const rgbConvertParams params = rgbConvertSetup(input.format, output.format, pixelRange);
+
+	const dim3 blockDim(32,8,1);
+	const dim3 gridDim(iDivUp(input.width,blockDim.x), iDivUp(input.height,blockDim.y), 1);
+
+	RGBToRGB_Pitched<T_in, T_out><<<gridDim, blockDim, 0, stream>>>((T_in*)input.ptr, input.pitch, (T_out*)output.ptr, output.pitch, 
+											       input.width, input.height, params.swapRedBlue, params.minPixelValue, 
+											       params.scalingFactor, params.defaultAlpha);
+	
+	return CUDA(cudaGetLastError());
+}
+
+template<typename T_in, typename T_out> 
+static bool cpuRGBToRGB_Pitched( const cudaImageView& input, const cudaImageView& output, const float2& pixelRange )
+{
+	const rgbConvertParams params = rgbConvertSetup(input.format, output.format, pixelRange);
+
+	for( size_t y=0; y < input.height; y++ )
+	{
+		const T_in* in = input.Row<T_in>(y);
+		T_out* out = output.Row<T_out>(y);
+
+		for( size_t x=0; x < input.width; x++ )
+			out[x] = convertRGBA<T_in, T_out>(in[x], params.swapRedBlue, params.minPixelValue, params.scalingFactor, params.defaultAlpha);
+	}
+
+	return true;
+}
+
+// dispatch on the output type, and then on the input type
+#define RGB_VIEW_DISPATCH(function, input_type, ...)											\
+	if( output.format == IMAGE_RGB8 || output.format == IMAGE_BGR8 )							\
+		return function<input_type, uchar3>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_RGBA8 || output.format == IMAGE_BGRA8 )						\
+		return function<input_type, uchar4>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_RGB32F || output.format == IMAGE_BGR32F )					\
+		return function<input_type, float3>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_RGBA32F || output.format == IMAGE_BGRA32F )					\
+		return function<input_type, float4>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_GRAY8 )												\
+		return function<input_type, uint8_t>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_GRAY32F )											\
+		return function<input_type, float>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_RGB16 )												\
+		return function<input_type, ushort3>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_RGBA16 )											\
+		return function<input_type, ushort4>(input, output, __VA_ARGS__);						\
+	else if( output.format == IMAGE_GRAY16 )											\
+		return function<input_type, ushort>(input, output, __VA_ARGS__);
+
+#define RGB_VIEW_DISPATCH_INPUT(function, ...)												\
+	if( input.format == IMAGE_RGB8 || input.format == IMAGE_BGR8 )								\
+		{ RGB_VIEW_DISPATCH(function, uchar3, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_RGBA8 || input.format == IMAGE_BGRA8 )						\
+		{ RGB_VIEW_DISPATCH(function, uchar4, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_RGB32F || input.format == IMAGE_BGR32F )						\
+		{ RGB_VIEW_DISPATCH(function, float3, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_RGBA32F || input.format == IMAGE_BGRA32F )					\
+		{ RGB_VIEW_DISPATCH(function, float4, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_GRAY8 )												\
+		{ RGB_VIEW_DISPATCH(function, uint8_t, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_GRAY32F )											\
+		{ RGB_VIEW_DISPATCH(function, float, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_RGB16 )												\
+		{ RGB_VIEW_DISPATCH(function, ushort3, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_RGBA16 )												\
+		{ RGB_VIEW_DISPATCH(function, ushort4, __VA_ARGS__); }								\
+	else if( input.format == IMAGE_GRAY16 )												\
+		{ RGB_VIEW_DISPATCH(function, ushort, __VA_ARGS__); }
+
+static bool validateRGBView( const cudaImageView& input, const cudaImageView& output, const char* function )
+{
+	if( !input.IsValid() || !output.IsValid() )
+	{
+		LogError(LOG_CUDA "%s -- invalid image view (NULL pointer, zero size, or pitch smaller than a row)\n", function);
+		return false;
+	}
+
+	if( input.width != output.width || input.height != output.height )
+	{
+		LogError(LOG_CUDA "%s -- input and output views must have the same dimensions (%zux%zu vs %zux%zu)\n", function, input.width, input.height, output.width, output.height);
+		return false;
+	}
+
+	return true;
+}
+
+// cudaRGBToRGB (image view)
+cudaError_t cudaRGBToRGB( const cudaImageView& input, const cudaImageView& output, const float2& pixelRange, cudaStream_t stream )
+{
+	if( !validateRGBView(input, output, "cudaRGBToRGB()") )
+		return cudaErrorInvalidValue;
+
+	RGB_VIEW_DISPATCH_INPUT(launchRGBToRGB_Pitched, pixelRange, stream);
+
+	LogError(LOG_CUDA "cudaRGBToRGB() -- unsupported image formats (%s -> %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+	return cudaErrorInvalidValue;
+}
+
+// cudaRGBToRGBCPU (image view)
+bool cudaRGBToRGBCPU( const cudaImageView& input, const cudaImageView& output, const float2& pixelRange )
+{
+	if( !validateRGBView(input, output, "cudaRGBToRGBCPU()") )
+		return false;
+
+	RGB_VIEW_DISPATCH_INPUT(cpuRGBToRGB_Pitched, pixelRange);
+
+	LogError(LOG_CUDA "cudaRGBToRGBCPU() -- unsupported image formats (%s -> %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+	return false;
+}
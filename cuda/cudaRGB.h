@@ -25,6 +25,7 @@
 
 
 #include "cudaUtility.h"
+#include "cudaImageView.h"
 
 
 
@@ -246,4 +247,40 @@ cudaError_t cudaRGBA32ToRGBA8( float4* input, uchar4* output, size_t width, size
 
 ///@}
 
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name RGB/BGR/grayscale image views with padded rows
+/// @see cudaConvertColor() from cudaColorspace.h for automated format conversion
+/// @ingroup colorspace
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Convert between any of the RGB/RGBA, BGR/BGRA, and grayscale formats (uint8, uint16 or float),
+ * where the input and output are image views that can have different row pitches.
+ * The red and blue channels are swapped when converting between RGB and BGR.
+ *
+ * Pixel values are rescaled between the range of each type, which is [0,255] for
+ * uint8, [0,65535] for uint16, and [0,255] for float outputs (float inputs use the
+ * pixelRange).  Integer outputs are rounded and clamped.  Conversions between two
+ * float formats keep the original values.
+ *
+ * @param pixelRange specifies the floating-point pixel value range of the input image, 
+ *                   which is used to rescale the fixed-point pixel outputs to [0,255]
+ *                   for uint8 or [0,65535] for uint16.  It's only used for float inputs.
+ */
+cudaError_t cudaRGBToRGB( const cudaImageView& input, const cudaImageView& output,
+                          const float2& pixelRange=make_float2(0,255), cudaStream_t stream=0 );
+
+/**
+ * Convert between RGB/RGBA, BGR/BGRA, and grayscale image views on the CPU,
+ * as a reference implementation of cudaRGBToRGB().  The views should be in
+ * CPU-accessible memory (e.g. mapped memory).
+ */
+bool cudaRGBToRGBCPU( const cudaImageView& input, const cudaImageView& output,
+                      const float2& pixelRange=make_float2(0,255) );
+
+///@}
+
 #endif
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaReduce.h"
+#include "cudaVector.h"
+
+#include <float.h>
+
+
+// reductions are performed by a fixed-size grid of blocks, followed by one block
+// that combines the partial results (so that no floating-point atomics are needed)
+#define REDUCE_THREADS 256
+#define REDUCE_BLOCKS  256
+
+// the maximum number of histogram bins (per channel)
+#define HISTOGRAM_MAX_BINS 1024
+
+
+// partial result of each block
+struct ReducePartial
+{
+	float4 min;
+	float4 max;
+	double sum[4];
+	double sumsq[4];
+};
+
+// internal buffers for the partial results and the auto-ranging stats
+static ReducePartial*  gReducePartials = NULL;
+static cudaImageStats* gReduceStats = NULL;
+
+
+// reduceLoad (convert a pixel to float4, with unused channels set to zero)
+inline __device__ __host__ float4 reduceLoad( uchar v )		{ return make_float4(v, 0, 0, 0); }
+inline __device__ __host__ float4 reduceLoad( float v )		{ return make_float4(v, 0, 0, 0); }
+inline __device__ __host__ float4 reduceLoad( uchar3 v )		{ return make_float4(v.x, v.y, v.z, 0); }
+inline __device__ __host__ float4 reduceLoad( uchar4 v )		{ return make_float4(v.x, v.y, v.z, v.w); }
+inline __device__ __host__ float4 reduceLoad( float3 v )		{ return make_float4(v.x, v.y, v.z, 0); }
+inline __device__ __host__ float4 reduceLoad( float4 v )		{ return make_float4(v.x, v.y, v.z, v.w); }
+
+// reducePixel (read the i-th pixel of an image, which can have padded rows)
+template<typename T, bool Pitched>
+inline __device__ T reducePixel( const T* input, size_t i, size_t width, size_t pitch )
+{
+	if( !Pitched )
+		return input[i];
+
+	const size_t y = i / width;
+	return ((const T*)((const uint8_t*)input + y * pitch))[i - y * width];
+}
+
+// histogramBin (map a value to a histogram bin, with out-of-range values clamped)
+inline __device__ __host__ int histogramBin( float value, int bins, float offset, float scale )
+{
+	const int bin = (int)((value - offset) * scale);
+	return (bin < 0) ? 0 : ((bin >= bins) ? bins - 1 : bin);
+}
+
+
+//----------------------------------------------------------------------------
+// Stats reduction (min/max/mean/stddev)
+//----------------------------------------------------------------------------
+__device__ inline void reduceCombine( ReducePartial& a, const ReducePartial& b )
+{
+	a.min = make_float4(fminf(a.min.x, b.min.x), fminf(a.min.y, b.min.y), fminf(a.min.z, b.min.z), fminf(a.min.w, b.min.w));
+	a.max = make_float4(fmaxf(a.max.x, b.max.x), fmaxf(a.max.y, b.max.y), fmaxf(a.max.z, b.max.z), fmaxf(a.max.w, b.max.w));
+
+	for( int c=0; c < 4; c++ )
+	{
+		a.sum[c] += b.sum[c];
+		a.sumsq[c] += b.sumsq[c];
+	}
+}
+
+__device__ inline void reduceBlock( ReducePartial* shared )
+{
+	for( unsigned int s=blockDim.x/2; s > 0; s >>= 1 )
+	{
+		if( threadIdx.x < s )
+			reduceCombine(shared[threadIdx.x], shared[threadIdx.x + s]);
+
+		__syncthreads();
+	}
+}
+
+template<typename T, bool Pitched>
+__global__ void gpuReduceStats( T* input, size_t width, size_t pitch, size_t numPixels, ReducePartial* partials )
+{
+	__shared__ ReducePartial shared[REDUCE_THREADS];
+
+	float4 vmin  = make_float4(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+	float4 vmax  = make_float4(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+	float4 sum   = make_float4(0,0,0,0);
+	float4 sumsq = make_float4(0,0,0,0);
+
+	// each thread accumulates a strided subset of the pixels
+	for( size_t i=blockIdx.x * blockDim.x + threadIdx.x; i < numPixels; i += blockDim.x * gridDim.x )
+	{
+		const float4 px = reduceLoad(reducePixel<T, Pitched>(input, i, width, pitch));
+
+		vmin = make_float4(fminf(vmin.x, px.x), fminf(vmin.y, px.y), fminf(vmin.z, px.z), fminf(vmin.w, px.w));
+		vmax = make_float4(fmaxf(vmax.x, px.x), fmaxf(vmax.y, px.y), fmaxf(vmax.z, px.z), fmaxf(vmax.w, px.w));
+
+		sum   = sum + px;
+		sumsq = sumsq + px * px;
+	}
+
+	ReducePartial& p = shared[threadIdx.x];
+
+	p.min = vmin;
+	p.max = vmax;
+
+	p.sum[0] = sum.x;  p.sumsq[0] = sumsq.x;
+	p.sum[1] = sum.y;  p.sumsq[1] = sumsq.y;
+	p.sum[2] = sum.z;  p.sumsq[2] = sumsq.z;
+	p.sum[3] = sum.w;  p.sumsq[3] = sumsq.w;
+
+	__syncthreads();
+	reduceBlock(shared);
+
+	if( threadIdx.x == 0 )
+		partials[blockIdx.x] = shared[0];
+}
+
+__global__ void gpuReduceStatsFinal( ReducePartial* partials, int numPartials, size_t numPixels, int channels, cudaImageStats* stats )
+{
+	__shared__ ReducePartial shared[REDUCE_THREADS];
+
+	ReducePartial& p = shared[threadIdx.x];
+
+	if( threadIdx.x < numPartials )
+	{
+		p = partials[threadIdx.x];
+	}
+	else
+	{
+		p.min = make_float4(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+		p.max = make_float4(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		for( int c=0; c < 4; c++ )
+		{
+			p.sum[c] = 0.0;
+			p.sumsq[c] = 0.0;
+		}
+	}
+
+	__syncthreads();
+	reduceBlock(shared);
+
+	if( threadIdx.x != 0 )
+		return;
+
+	const ReducePartial& r = shared[0];
+	
+	float mean[4];
+	float stddev[4];
+
+	for( int c=0; c < 4; c++ )
+	{
+		const double m = r.sum[c] / numPixels;
+		mean[c] = m;
+		stddev[c] = sqrt(fmax(r.sumsq[c] / numPixels - m * m, 0.0));
+	}
+
+	stats->min    = r.min;
+	stats->max    = r.max;
+	stats->mean   = make_float4(mean[0], mean[1], mean[2], mean[3]);
+	stats->stddev = make_float4(stddev[0], stddev[1], stddev[2], stddev[3]);
+	stats->count  = numPixels;
+
+	// the range across the color channels
+	float2 range = make_float2(r.min.x, r.max.x);
+
+	if( channels > 1 )
+		range = make_float2(fminf(range.x, r.min.y), fmaxf(range.y, r.max.y));
+
+	if( channels > 2 )
+		range = make_float2(fminf(range.x, r.min.z), fmaxf(range.y, r.max.z));
+
+	stats->range = range;
+
+	// zero the unused channels
+	if( channels < 4 )
+	{
+		stats->min.w = stats->max.w = stats->mean.w = stats->stddev.w = 0.0f;
+
+		if( channels < 3 )
+		{
+			stats->min.z = stats->max.z = stats->mean.z = stats->stddev.z = 0.0f;
+			stats->min.y = stats->max.y = stats->mean.y = stats->stddev.y = 0.0f;
+		}
+	}
+}
+
+// the number of color channels (excluding alpha) that are used for the range
+static inline int reduceColorChannels( imageFormat format )
+{
+	const int channels = imageFormatChannels(format);
+	return (channels > 3) ? 3 : channels;
+}
+
+// cudaReduceStats (image view)
+cudaError_t cudaReduceStats( const cudaImageView& input, cudaImageStats* stats, cudaStream_t stream )
+{
+	if( !input.ptr || !stats )
+		return cudaErrorInvalidDevicePointer;
+
+	if( !input.IsValid() )
+		return cudaErrorInvalidValue;
+
+	if( !gReducePartials )
+		CUDA_ASSERT(cudaMalloc(&gReducePartials, sizeof(ReducePartial) * REDUCE_BLOCKS));
+
+	const imageFormat format = input.format;
+	const size_t numPixels = input.width * input.height;
+	const int numBlocks = (int)((numPixels + REDUCE_THREADS - 1) / REDUCE_THREADS < REDUCE_BLOCKS ? (numPixels + REDUCE_THREADS - 1) / REDUCE_THREADS : REDUCE_BLOCKS);
+
+	// the packed kernel doesn't need to find the row of each pixel
+	#define LAUNCH_REDUCE_STATS(type) \
+		if( input.IsPacked() ) \
+			gpuReduceStats<type, false><<<numBlocks, REDUCE_THREADS, 0, stream>>>((type*)input.ptr, input.width, input.pitch, numPixels, gReducePartials); \
+		else \
+			gpuReduceStats<type, true><<<numBlocks, REDUCE_THREADS, 0, stream>>>((type*)input.ptr, input.width, input.pitch, numPixels, gReducePartials)
+
+	if( format == IMAGE_GRAY8 )
+		LAUNCH_REDUCE_STATS(uchar);
+	else if( format == IMAGE_GRAY32F )
+		LAUNCH_REDUCE_STATS(float);
+	else if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		LAUNCH_REDUCE_STATS(uchar3);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		LAUNCH_REDUCE_STATS(uchar4);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		LAUNCH_REDUCE_STATS(float3);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		LAUNCH_REDUCE_STATS(float4);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaReduceStats()", format);
+		return cudaErrorInvalidValue;
+	}
+
+	gpuReduceStatsFinal<<<1, REDUCE_THREADS, 0, stream>>>(gReducePartials, numBlocks, numPixels, reduceColorChannels(format), stats);
+
+	return CUDA(cudaGetLastError());
+}
+
+// cudaReduceStats
+cudaError_t cudaReduceStats( void* input, size_t width, size_t height, imageFormat format, cudaImageStats* stats, cudaStream_t stream )
+{
+	return cudaReduceStats(cudaImageView(input, width, height, format), stats, stream);
+}
+
+
+// cudaReduceStatsBuffer
+cudaImageStats* cudaReduceStatsBuffer()
+{
+	if( !gReduceStats && CUDA_FAILED(cudaMalloc(&gReduceStats, sizeof(cudaImageStats))) )
+		return NULL;
+
+	return gReduceStats;
+}
+
+
+//----------------------------------------------------------------------------
+// Stats reduction (CPU)
+// The samples are accumulated into a number of independent lanes that is a
+// multiple of the pixel stride, so that each lane always holds the same channel
+// and the inner loop can be vectorized by the compiler.
+//----------------------------------------------------------------------------
+template<typename T, int Stride>
+static void cpuReduceStats( const T* input, size_t numPixels, int channels, cudaImageStats* stats )
+{
+	const int Lanes = Stride * 8;
+
+	float  vmin[Lanes];
+	float  vmax[Lanes];
+	double sum[Lanes];
+	double sumsq[Lanes];
+
+	for( int j=0; j < Lanes; j++ )
+	{
+		vmin[j] = FLT_MAX;
+		vmax[j] = -FLT_MAX;
+		sum[j] = 0.0;
+		sumsq[j] = 0.0;
+	}
+
+	const size_t numSamples = numPixels * Stride;
+	const size_t numVector = numSamples - (numSamples % Lanes);
+
+	for( size_t i=0; i < numVector; i += Lanes )
+	{
+		for( int j=0; j < Lanes; j++ )
+		{
+			const float v = input[i+j];
+
+			vmin[j] = (v < vmin[j]) ? v : vmin[j];
+			vmax[j] = (v > vmax[j]) ? v : vmax[j];
+
+			sum[j] += v;
+			sumsq[j] += double(v) * double(v);
+		}
+	}
+
+	for( size_t i=numVector; i < numSamples; i++ )
+	{
+		const int j = i % Lanes;
+		const float v = input[i];
+
+		vmin[j] = (v < vmin[j]) ? v : vmin[j];
+		vmax[j] = (v > vmax[j]) ? v : vmax[j];
+
+		sum[j] += v;
+		sumsq[j] += double(v) * double(v);
+	}
+
+	// combine the lanes of each channel
+	float  cmin[4]   = {0,0,0,0};
+	float  cmax[4]   = {0,0,0,0};
+	float  cmean[4]  = {0,0,0,0};
+	float  cstd[4]   = {0,0,0,0};
+
+	for( int c=0; c < Stride; c++ )
+	{
+		float  lmin = FLT_MAX;
+		float  lmax = -FLT_MAX;
+		double lsum = 0.0;
+		double lsumsq = 0.0;
+
+		for( int j=c; j < Lanes; j += Stride )
+		{
+			lmin = (vmin[j] < lmin) ? vmin[j] : lmin;
+			lmax = (vmax[j] > lmax) ? vmax[j] : lmax;
+
+			lsum += sum[j];
+			lsumsq += sumsq[j];
+		}
+
+		const double mean = lsum / numPixels;
+
+		cmin[c]  = lmin;
+		cmax[c]  = lmax;
+		cmean[c] = mean;
+		cstd[c]  = sqrt(fmax(lsumsq / numPixels - mean * mean, 0.0));
+	}
+
+	stats->min    = make_float4(cmin[0], cmin[1], cmin[2], cmin[3]);
+	stats->max    = make_float4(cmax[0], cmax[1], cmax[2], cmax[3]);
+	stats->mean   = make_float4(cmean[0], cmean[1], cmean[2], cmean[3]);
+	stats->stddev = make_float4(cstd[0], cstd[1], cstd[2], cstd[3]);
+	stats->count  = numPixels;
+	stats->range  = make_float2(cmin[0], cmax[0]);
+
+	for( int c=1; c < channels; c++ )
+	{
+		stats->range.x = fminf(stats->range.x, cmin[c]);
+		stats->range.y = fmaxf(stats->range.y, cmax[c]);
+	}
+}
+
+// cudaReduceStatsCPU
+bool cudaReduceStatsCPU( const void* input, size_t width, size_t height, imageFormat format, cudaImageStats* stats )
+{
+	if( !input || !stats || width == 0 || height == 0 )
+		return false;
+
+	const size_t numPixels = width * height;
+	const int channels = reduceColorChannels(format);
+
+	if( format == IMAGE_GRAY8 )
+		cpuReduceStats<uint8_t, 1>((const uint8_t*)input, numPixels, channels, stats);
+	else if( format == IMAGE_GRAY32F )
+		cpuReduceStats<float, 1>((const float*)input, numPixels, channels, stats);
+	else if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		cpuReduceStats<uint8_t, 3>((const uint8_t*)input, numPixels, channels, stats);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		cpuReduceStats<uint8_t, 4>((const uint8_t*)input, numPixels, channels, stats);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		cpuReduceStats<float, 3>((const float*)input, numPixels, channels, stats);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		cpuReduceStats<float, 4>((const float*)input, numPixels, channels, stats);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaReduceStatsCPU()", format);
+		return false;
+	}
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Histogram (each block accumulates a histogram in shared memory,
+// and then adds it to the global histogram)
+//----------------------------------------------------------------------------
+template<typename T, bool Pitched>
+__global__ void gpuHistogram( T* input, size_t width, size_t pitch, size_t numPixels, int channels, uint32_t* histogram, int bins, float offset, float scale )
+{
+	extern __shared__ uint32_t shared_hist[];
+
+	const int histSize = bins * channels;
+
+	for( int i=threadIdx.x; i < histSize; i += blockDim.x )
+		shared_hist[i] = 0;
+
+	__syncthreads();
+
+	for( size_t i=blockIdx.x * blockDim.x + threadIdx.x; i < numPixels; i += blockDim.x * gridDim.x )
+	{
+		const float4 px = reduceLoad(reducePixel<T, Pitched>(input, i, width, pitch));
+
+		atomicAdd(&shared_hist[histogramBin(px.x, bins, offset, scale)], 1);
+
+		if( channels > 1 )
+			atomicAdd(&shared_hist[bins + histogramBin(px.y, bins, offset, scale)], 1);
+
+		if( channels > 2 )
+			atomicAdd(&shared_hist[bins * 2 + histogramBin(px.z, bins, offset, scale)], 1);
+
+		if( channels > 3 )
+			atomicAdd(&shared_hist[bins * 3 + histogramBin(px.w, bins, offset, scale)], 1);
+	}
+
+	__syncthreads();
+
+	for( int i=threadIdx.x; i < histSize; i += blockDim.x )
+	{
+		if( shared_hist[i] > 0 )
+			atomicAdd(&histogram[i], shared_hist[i]);
+	}
+}
+
+// cudaHistogram (image view)
+cudaError_t cudaHistogram( const cudaImageView& input, uint32_t* histogram, uint32_t bins, const float2& range, cudaStream_t stream )
+{
+	if( !input.ptr || !histogram )
+		return cudaErrorInvalidDevicePointer;
+
+	if( !input.IsValid() || bins == 0 || bins > HISTOGRAM_MAX_BINS || range.y <= range.x )
+		return cudaErrorInvalidValue;
+
+	const imageFormat format = input.format;
+	const int channels = imageFormatChannels(format);
+	const size_t numPixels = input.width * input.height;
+	const int numBlocks = (int)((numPixels + REDUCE_THREADS - 1) / REDUCE_THREADS < REDUCE_BLOCKS ? (numPixels + REDUCE_THREADS - 1) / REDUCE_THREADS : REDUCE_BLOCKS);
+
+	const float scale = bins / (range.y - range.x);
+	const size_t sharedMem = bins * channels * sizeof(uint32_t);
+
+	CUDA_ASSERT(cudaMemsetAsync(histogram, 0, sharedMem, stream));
+
+	#define LAUNCH_HISTOGRAM(type) \
+		if( input.IsPacked() ) \
+			gpuHistogram<type, false><<<numBlocks, REDUCE_THREADS, sharedMem, stream>>>((type*)input.ptr, input.width, input.pitch, numPixels, channels, histogram, bins, range.x, scale); \
+		else \
+			gpuHistogram<type, true><<<numBlocks, REDUCE_THREADS, sharedMem, stream>>>((type*)input.ptr, input.width, input.pitch, numPixels, channels, histogram, bins, range.x, scale)
+
+	if( format == IMAGE_GRAY8 )
+		LAUNCH_HISTOGRAM(uchar);
+	else if( format == IMAGE_GRAY32F )
+		LAUNCH_HISTOGRAM(float);
+	else if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		LAUNCH_HISTOGRAM(uchar3);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		LAUNCH_HISTOGRAM(uchar4);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		LAUNCH_HISTOGRAM(float3);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		LAUNCH_HISTOGRAM(float4);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaHistogram()", format);
+		return cudaErrorInvalidValue;
+	}
+
+	return CUDA(cudaGetLastError());
+}
+
+// cudaHistogram
+cudaError_t cudaHistogram( void* input, size_t width, size_t height, imageFormat format, uint32_t* histogram, uint32_t bins, const float2& range, cudaStream_t stream )
+{
+	return cudaHistogram(cudaImageView(input, width, height, format), histogram, bins, range, stream);
+}
+
+
+// cpuHistogram
+template<typename T, int Stride>
+static void cpuHistogram( const T* input, size_t numPixels, uint32_t* histogram, int bins, float offset, float scale )
+{
+	for( size_t i=0; i < numPixels; i++ )
+	{
+		for( int c=0; c < Stride; c++ )
+			histogram[bins * c + histogramBin(input[i * Stride + c], bins, offset, scale)]++;
+	}
+}
+
+// cudaHistogramCPU
+bool cudaHistogramCPU( const void* input, size_t width, size_t height, imageFormat format, uint32_t* histogram, uint32_t bins, const float2& range )
+{
+	if( !input || !histogram || width == 0 || height == 0 || bins == 0 || bins > HISTOGRAM_MAX_BINS || range.y <= range.x )
+		return false;
+
+	const int channels = imageFormatChannels(format);
+	const size_t numPixels = width * height;
+	const float scale = bins / (range.y - range.x);
+
+	memset(histogram, 0, bins * channels * sizeof(uint32_t));
+
+	if( format == IMAGE_GRAY8 )
+		cpuHistogram<uint8_t, 1>((const uint8_t*)input, numPixels, histogram, bins, range.x, scale);
+	else if( format == IMAGE_GRAY32F )
+		cpuHistogram<float, 1>((const float*)input, numPixels, histogram, bins, range.x, scale);
+	else if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		cpuHistogram<uint8_t, 3>((const uint8_t*)input, numPixels, histogram, bins, range.x, scale);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		cpuHistogram<uint8_t, 4>((const uint8_t*)input, numPixels, histogram, bins, range.x, scale);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		cpuHistogram<float, 3>((const float*)input, numPixels, histogram, bins, range.x, scale);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		cpuHistogram<float, 4>((const float*)input, numPixels, histogram, bins, range.x, scale);
+	else
+	{
+		imageFormatErrorMsg(LOG_CUDA, "cudaHistogramCPU()", format);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __CUDA_REDUCE_H__
+#define __CUDA_REDUCE_H__
+
+
+#include "cudaUtility.h"
+#include "imageFormat.h"
+#include "cudaImageView.h"
+
+
+/**
+ * Per-channel statistics of an image, as computed by cudaReduceStats().
+ * For grayscale images, only the first channel (x) is used.
+ * @ingroup reduction
+ */
+struct cudaImageStats
+{
+	float4 min;		/**< Minimum value of each channel */
+	float4 max;		/**< Maximum value of each channel */
+	float4 mean;		/**< Mean value of each channel */
+	float4 stddev;		/**< Standard deviation of each channel */
+	float2 range;		/**< Minimum and maximum value across the color channels (excluding alpha) */
+	uint32_t count;	/**< The number of pixels that were reduced */
+};
+
+/**
+ * Compute the per-channel min/max/mean/stddev of an image with a parallel reduction.
+ *
+ * The statistics are written to `stats`, which can be device memory (so that it can
+ * be passed to the auto-ranging overloads of cudaNormalize() and cudaColormap() without
+ * leaving the GPU), or mapped memory that can be read back by the CPU after the stream
+ * has been synchronized.
+ *
+ * @note this uses an internal scratch buffer for the partial results of each block,
+ *       so it shouldn't be called concurrently from multiple streams.
+ *
+ * @param format the image format - valid formats are gray8, gray32f, rgb8/bgr8,
+ *               rgba8/bgra8, rgb32f/bgr32f, and rgba32f/bgra32f.
+ * @ingroup reduction
+ */
+cudaError_t cudaReduceStats( void* input, size_t width, size_t height, imageFormat format,
+                             cudaImageStats* stats, cudaStream_t stream=0 );
+
+/**
+ * Compute the per-channel min/max/mean/stddev of an image view, which can have padded rows.
+ * @ingroup reduction
+ */
+cudaError_t cudaReduceStats( const cudaImageView& input, cudaImageStats* stats, cudaStream_t stream=0 );
+
+/**
+ * Compute the per-channel min/max/mean/stddev of an image with a parallel reduction.
+ * @ingroup reduction
+ */
+template<typename T> 
+cudaError_t cudaReduceStats( T* input, size_t width, size_t height, cudaImageStats* stats, cudaStream_t stream=0 )
+{
+	return cudaReduceStats(input, width, height, imageFormatFromType<T>(), stats, stream);
+}
+
+/**
+ * Compute the per-channel min/max/mean/stddev of an image on the CPU.
+ * The image should be in CPU-accessible memory, and the result matches cudaReduceStats()
+ * (apart from floating-point rounding of the mean and standard deviation).
+ * @ingroup reduction
+ */
+bool cudaReduceStatsCPU( const void* input, size_t width, size_t height, imageFormat format, cudaImageStats* stats );
+
+/**
+ * Compute the per-channel histogram of an image on the GPU.
+ *
+ * The histogram should be device or mapped memory with `bins * channels` elements,
+ * where the histogram of each channel is stored consecutively.  Values outside of
+ * `range` are clamped to the first or last bin.  The histogram is cleared first.
+ *
+ * @param bins the number of bins per channel (up to 1024)
+ * @param range the minimum and maximum values that map to the first and last bins.
+ * @ingroup reduction
+ */
+cudaError_t cudaHistogram( void* input, size_t width, size_t height, imageFormat format,
+                           uint32_t* histogram, uint32_t bins=256, const float2& range=make_float2(0,255),
+                           cudaStream_t stream=0 );
+
+/**
+ * Compute the per-channel histogram of an image view, which can have padded rows.
+ * @see cudaHistogram() for the layout of the histogram.
+ * @ingroup reduction
+ */
+cudaError_t cudaHistogram( const cudaImageView& input, uint32_t* histogram, uint32_t bins=256,
+                           const float2& range=make_float2(0,255), cudaStream_t stream=0 );
+
+/**
+ * Compute the per-channel histogram of an image on the CPU.
+ * @see cudaHistogram() for the layout of the histogram.
+ * @ingroup reduction
+ */
+bool cudaHistogramCPU( const void* input, size_t width, size_t height, imageFormat format,
+                       uint32_t* histogram, uint32_t bins=256, const float2& range=make_float2(0,255) );
+
+/**
+ * Retrieve the device buffer that the auto-ranging overloads of cudaNormalize()
+ * and cudaColormap() use for statistics when they aren't provided by the caller.
+ * @internal
+ * @ingroup reduction
+ */
+cudaImageStats* cudaReduceStatsBuffer();
+
+
+#endif
@@ -26,7 +26,7 @@
 
 // gpuResize
 template<typename T, cudaFilterMode filter>
-__global__ void gpuResize( T* input, int inputWidth, int inputHeight, T* output, int outputWidth, int outputHeight )
+__global__ void gpuResize( T* input, size_t inputPitch, int inputWidth, int inputHeight, T* output, size_t outputPitch, int outputWidth, int outputHeight )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -34,13 +34,13 @@ __global__ void gpuResize( T* input, int inputWidth, int inputHeight, T* output,
 	if( x >= outputWidth || y >= outputHeight )
 		return;
 
-	output[y * outputWidth + x] = cudaFilterPixel<filter>(input, x, y, inputWidth, inputHeight, outputWidth, outputHeight); 
+	((T*)((uint8_t*)output + y * outputPitch))[x] = cudaFilterPixelPitched<filter>(input, inputPitch, x, y, inputWidth, inputHeight, outputWidth, outputHeight); 
 }
 
 // launchResize
 template<typename T>
-static cudaError_t launchResize( T* input, size_t inputWidth, size_t inputHeight,
-                                 T* output, size_t outputWidth, size_t outputHeight,
+static cudaError_t launchResize( T* input, size_t inputPitch, size_t inputWidth, size_t inputHeight,
+                                 T* output, size_t outputPitch, size_t outputWidth, size_t outputHeight,
                                  cudaFilterMode filter, cudaStream_t stream )
 {
 	if( !input || !output )
@@ -49,6 +49,9 @@ static cudaError_t launchResize( T* input, size_t inputWidth, size_t inputHeight
 	if( inputWidth == 0 || outputWidth == 0 || inputHeight == 0 || outputHeight == 0 )
 		return cudaErrorInvalidValue;
 
+	if( inputPitch < inputWidth * sizeof(T) || outputPitch < outputWidth * sizeof(T) )
+		return cudaErrorInvalidPitchValue;
+
 	if( outputWidth < inputWidth && outputHeight < inputHeight )
 		filter = FILTER_POINT;
 
@@ -57,7 +60,7 @@ static cudaError_t launchResize( T* input, size_t inputWidth, size_t inputHeight
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
 	#define launch_resize(filterMode)	\
-		gpuResize<T, filterMode><<<gridDim, blockDim, 0, stream>>>(input, inputWidth, inputHeight, output, outputWidth, outputHeight)
+		gpuResize<T, filterMode><<<gridDim, blockDim, 0, stream>>>(input, inputPitch, inputWidth, inputHeight, output, outputPitch, outputWidth, outputHeight)
 	
 	if( filter == FILTER_POINT )
 		launch_resize(FILTER_POINT);
@@ -67,6 +70,15 @@ static cudaError_t launchResize( T* input, size_t inputWidth, size_t inputHeight
 	return CUDA(cudaGetLastError());
 }
 
+// launchResize (packed)
+template<typename T>
+static cudaError_t launchResize( T* input, size_t inputWidth, size_t inputHeight,
+                                 T* output, size_t outputWidth, size_t outputHeight,
+                                 cudaFilterMode filter, cudaStream_t stream )
+{
+	return launchResize<T>(input, inputWidth * sizeof(T), inputWidth, inputHeight, output, outputWidth * sizeof(T), outputWidth, outputHeight, filter, stream);
+}
+
 // cudaResize (uint8 grayscale)
 cudaError_t cudaResize( uint8_t* input, size_t inputWidth, size_t inputHeight, uint8_t* output, size_t outputWidth, size_t outputHeight, cudaFilterMode filter, cudaStream_t stream )
 {
@@ -120,6 +132,12 @@ cudaError_t cudaResize( void* input,  size_t inputWidth,  size_t inputHeight,
 		return cudaResize((uint8_t*)input, inputWidth, inputHeight, (uint8_t*)output, outputWidth, outputHeight, filter, stream);
 	else if( format == IMAGE_GRAY32F )
 		return cudaResize((float*)input, inputWidth, inputHeight, (float*)output, outputWidth, outputHeight, filter, stream);
+	else if( format == IMAGE_RGB16 )
+		return launchResize<ushort3>((ushort3*)input, inputWidth, inputHeight, (ushort3*)output, outputWidth, outputHeight, filter, stream);
+	else if( format == IMAGE_RGBA16 )
+		return launchResize<ushort4>((ushort4*)input, inputWidth, inputHeight, (ushort4*)output, outputWidth, outputHeight, filter, stream);
+	else if( format == IMAGE_GRAY16 )
+		return launchResize<ushort>((ushort*)input, inputWidth, inputHeight, (ushort*)output, outputWidth, outputHeight, filter, stream);
 
 	LogError(LOG_CUDA "cudaResize() -- invalid image format '%s'\n", imageFormatToStr(format));
 	LogError(LOG_CUDA "                supported formats are:\n");
@@ -129,10 +147,112 @@ cudaError_t cudaResize( void* input,  size_t inputWidth,  size_t inputHeight,
 	LogError(LOG_CUDA "                    * rgba8, bgra8\n");
 	LogError(LOG_CUDA "                    * rgb32f, bgr32f\n");
 	LogError(LOG_CUDA "                    * rgba32f, bgra32f\n");
+	LogError(LOG_CUDA "                    * gray16, rgb16, rgba16\n");
+
+	return cudaErrorInvalidValue;
+}
+
+
+//-----------------------------------------------------------------------------------
+cudaError_t cudaResize( const cudaImageView& input, const cudaImageView& output, cudaFilterMode filter, cudaStream_t stream )
+{
+	if( input.format != output.format )
+	{
+		LogError(LOG_CUDA "cudaResize() -- input and output views must have the same format (%s vs %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+		return cudaErrorInvalidValue;
+	}
+
+	#define launch_resize_view(type) \
+		launchResize<type>((type*)input.ptr, input.pitch, input.width, input.height, (type*)output.ptr, output.pitch, output.width, output.height, filter, stream)
+
+	const imageFormat format = input.format;
+
+	if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		return launch_resize_view(uchar3);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		return launch_resize_view(uchar4);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		return launch_resize_view(float3);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		return launch_resize_view(float4);
+	else if( format == IMAGE_GRAY8 )
+		return launch_resize_view(uint8_t);
+	else if( format == IMAGE_GRAY32F )
+		return launch_resize_view(float);
+	else if( format == IMAGE_RGB16 )
+		return launch_resize_view(ushort3);
+	else if( format == IMAGE_RGBA16 )
+		return launch_resize_view(ushort4);
+	else if( format == IMAGE_GRAY16 )
+		return launch_resize_view(ushort);
+
+	LogError(LOG_CUDA "cudaResize() -- invalid image format '%s'\n", imageFormatToStr(format));
+	LogError(LOG_CUDA "                supported formats are gray8, gray32f, rgb8/bgr8, rgba8/bgra8, rgb32f/bgr32f, rgba32f/bgra32f, gray16, rgb16, rgba16\n");
 
 	return cudaErrorInvalidValue;
 }
 
 
+//-----------------------------------------------------------------------------------
+template<typename T, cudaFilterMode filter>
+static void cpuResize( const cudaImageView& input, const cudaImageView& output )
+{
+	for( int y=0; y < output.height; y++ )
+	{
+		T* row = output.Row<T>(y);
+
+		for( int x=0; x < output.width; x++ )
+			row[x] = cudaFilterPixelPitched<filter>((T*)input.ptr, input.pitch, x, y, input.width, input.height, output.width, output.height);
+	}
+}
+
+template<typename T>
+static bool cpuResize( const cudaImageView& input, const cudaImageView& output, cudaFilterMode filter )
+{
+	if( input.pitch < input.width * sizeof(T) || output.pitch < output.width * sizeof(T) )
+		return false;
+
+	if( output.width < input.width && output.height < input.height )
+		filter = FILTER_POINT;
 
+	if( filter == FILTER_POINT )
+		cpuResize<T, FILTER_POINT>(input, output);
+	else
+		cpuResize<T, FILTER_LINEAR>(input, output);
 
+	return true;
+}
+
+// cudaResizeCPU
+bool cudaResizeCPU( const cudaImageView& input, const cudaImageView& output, cudaFilterMode filter )
+{
+	if( !input.ptr || !output.ptr || input.width == 0 || input.height == 0 || output.width == 0 || output.height == 0 )
+		return false;
+
+	if( input.format != output.format )
+		return false;
+
+	const imageFormat format = input.format;
+
+	if( format == IMAGE_RGB8 || format == IMAGE_BGR8 )
+		return cpuResize<uchar3>(input, output, filter);
+	else if( format == IMAGE_RGBA8 || format == IMAGE_BGRA8 )
+		return cpuResize<uchar4>(input, output, filter);
+	else if( format == IMAGE_RGB32F || format == IMAGE_BGR32F )
+		return cpuResize<float3>(input, output, filter);
+	else if( format == IMAGE_RGBA32F || format == IMAGE_BGRA32F )
+		return cpuResize<float4>(input, output, filter);
+	else if( format == IMAGE_GRAY8 )
+		return cpuResize<uint8_t>(input, output, filter);
+	else if( format == IMAGE_GRAY32F )
+		return cpuResize<float>(input, output, filter);
+	else if( format == IMAGE_RGB16 )
+		return cpuResize<ushort3>(input, output, filter);
+	else if( format == IMAGE_RGBA16 )
+		return cpuResize<ushort4>(input, output, filter);
+	else if( format == IMAGE_GRAY16 )
+		return cpuResize<ushort>(input, output, filter);
+
+	LogError(LOG_CUDA "cudaResizeCPU() -- invalid image format '%s'\n", imageFormatToStr(format));
+	return false;
+}
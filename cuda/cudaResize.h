@@ -28,6 +28,7 @@
 #include "cudaFilterMode.h"
 
 #include "imageFormat.h"
+#include "cudaImageView.h"
 
 
 /**
@@ -97,7 +98,7 @@ cudaError_t cudaResize( float4* input,  size_t inputWidth,  size_t inputHeight,
                         cudaFilterMode filter=FILTER_POINT, cudaStream_t stream=0 );
 
 /**
- * Rescale an image on the GPU (supports grayscale, RGB/BGR, RGBA/BGRA)
+ * Rescale an image on the GPU (supports grayscale, RGB/BGR, RGBA/BGRA, and 16-bit RGB/RGBA/grayscale)
  * To use bilinear filtering for upscaling, set filter to FILTER_LINEAR.
  * If the image is being downscaled, or if FILTER_POINT is set (default),
  * then nearest-neighbor sampling will be used instead.
@@ -108,5 +109,24 @@ cudaError_t cudaResize( void* input,  size_t inputWidth,  size_t inputHeight,
                         imageFormat format, cudaFilterMode filter=FILTER_POINT,
                         cudaStream_t stream=0 );
 
+/**
+ * Rescale an image view on the GPU (supports grayscale, RGB/BGR, RGBA/BGRA, and the 16-bit formats).
+ * The input and output views can have padded rows (or be ROI's of larger images),
+ * but they must have the same format.  The filtering follows the other versions
+ * of cudaResize() - FILTER_LINEAR is only used for upscaling.
+ * @ingroup resize
+ */
+cudaError_t cudaResize( const cudaImageView& input, const cudaImageView& output,
+                        cudaFilterMode filter=FILTER_POINT, cudaStream_t stream=0 );
+
+/**
+ * Rescale an image view on the CPU, as a reference implementation of cudaResize().
+ * The input and output views should be in CPU-accessible memory (e.g. mapped memory).
+ * @returns true on success, false on an invalid view or unsupported format.
+ * @ingroup resize
+ */
+bool cudaResizeCPU( const cudaImageView& input, const cudaImageView& output,
+                    cudaFilterMode filter=FILTER_POINT );
+
 #endif
 
@@ -39,13 +39,17 @@
 
 ///@{
 
-// get base type (uint8 or float) from vector
+// get base type (uint8, uint16 or float) from vector
 template<class T> struct cudaVectorTypeInfo;
 
 template<> struct cudaVectorTypeInfo<uchar>  { typedef uint8_t Base; };
 template<> struct cudaVectorTypeInfo<uchar3> { typedef uint8_t Base; };
 template<> struct cudaVectorTypeInfo<uchar4> { typedef uint8_t Base; };
 
+template<> struct cudaVectorTypeInfo<ushort>  { typedef uint16_t Base; };
+template<> struct cudaVectorTypeInfo<ushort3> { typedef uint16_t Base; };
+template<> struct cudaVectorTypeInfo<ushort4> { typedef uint16_t Base; };
+
 template<> struct cudaVectorTypeInfo<float>  { typedef float Base; };
 template<> struct cudaVectorTypeInfo<float3> { typedef float Base; };
 template<> struct cudaVectorTypeInfo<float4> { typedef float Base; };
@@ -62,6 +66,10 @@ template<> inline __host__ __device__ uchar  make_vec( uint8_t x, uint8_t y, uin
 template<> inline __host__ __device__ uchar3 make_vec( uint8_t x, uint8_t y, uint8_t z, uint8_t w )	{ return make_uchar3(x,y,z); }
 template<> inline __host__ __device__ uchar4 make_vec( uint8_t x, uint8_t y, uint8_t z, uint8_t w )	{ return make_uchar4(x,y,z,w); }
 
+template<> inline __host__ __device__ ushort  make_vec( uint16_t x, uint16_t y, uint16_t z, uint16_t w )	{ return x; }
+template<> inline __host__ __device__ ushort3 make_vec( uint16_t x, uint16_t y, uint16_t z, uint16_t w )	{ return make_ushort3(x,y,z); }
+template<> inline __host__ __device__ ushort4 make_vec( uint16_t x, uint16_t y, uint16_t z, uint16_t w )	{ return make_ushort4(x,y,z,w); }
+
 template<> inline __host__ __device__ float  make_vec( float x, float y, float z, float w )		{ return x; }
 template<> inline __host__ __device__ float3 make_vec( float x, float y, float z, float w )		{ return make_float3(x,y,z); }
 template<> inline __host__ __device__ float4 make_vec( float x, float y, float z, float w )		{ return make_float4(x,y,z,w); }
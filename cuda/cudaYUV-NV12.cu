@@ -22,6 +22,7 @@
 
 #include "cudaYUV.h"
 #include "cudaVector.h"
+#include "cudaImageView.h"
 
 #define COLOR_COMPONENT_MASK            0x3FF
 #define COLOR_COMPONENT_BIT_SIZE        10
@@ -129,13 +130,15 @@ __global__ void NV12ToRGB(uint32_t* srcImage, size_t nSourcePitch,
 								   ((yuv101010Pel[1] >> (COLOR_COMPONENT_BIT_SIZE << 1)) & COLOR_COMPONENT_MASK));
 								   
 	// YUV to RGB transformation conversion
-	dstImage[y * width + x]     = YUV2RGB<T>(yuvi_0);
-	dstImage[y * width + x + 1] = YUV2RGB<T>(yuvi_1);
+	T* dstRow = (T*)((uint8_t*)dstImage + y * nDestPitch);
+
+	dstRow[x]     = YUV2RGB<T>(yuvi_0);
+	dstRow[x + 1] = YUV2RGB<T>(yuvi_1);
 }
 
 
 template<typename T> 
-static cudaError_t launchNV12ToRGB( void* srcDev, T* dstDev, size_t width, size_t height, cudaStream_t stream )
+static cudaError_t launchNV12ToRGB( void* srcDev, size_t srcPitch, T* dstDev, size_t dstPitch, size_t width, size_t height, cudaStream_t stream )
 {
 	if( !srcDev || !dstDev )
 		return cudaErrorInvalidDevicePointer;
@@ -143,9 +146,9 @@ static cudaError_t launchNV12ToRGB( void* srcDev, T* dstDev, size_t width, size_
 	if( width == 0 || height == 0 )
 		return cudaErrorInvalidValue;
 
-	const size_t srcPitch = width * sizeof(uint8_t);
-	const size_t dstPitch = width * sizeof(T);
-	
+	if( srcPitch < width * sizeof(uint8_t) || dstPitch < width * sizeof(T) )
+		return cudaErrorInvalidPitchValue;
+
 	const dim3 blockDim(32,8,1);
 	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height, blockDim.y), 1);
 
@@ -154,6 +157,12 @@ static cudaError_t launchNV12ToRGB( void* srcDev, T* dstDev, size_t width, size_
 	return CUDA(cudaGetLastError());
 }
 
+template<typename T> 
+static cudaError_t launchNV12ToRGB( void* srcDev, T* dstDev, size_t width, size_t height, cudaStream_t stream )
+{
+	return launchNV12ToRGB<T>(srcDev, width * sizeof(uint8_t), dstDev, width * sizeof(T), width, height, stream);
+}
+
 // cudaNV12ToRGB (uchar3)
 cudaError_t cudaNV12ToRGB( void* srcDev, uchar3* destDev, size_t width, size_t height, cudaStream_t stream )
 {
@@ -179,6 +188,25 @@ cudaError_t cudaNV12ToRGBA( void* srcDev, float4* destDev, size_t width, size_t
 }
 
 
+// cudaNV12ToRGB (image view)
+cudaError_t cudaNV12ToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream )
+{
+	if( input.format != IMAGE_NV12 || input.width != output.width || input.height != output.height )
+		return cudaErrorInvalidValue;
+
+	if( output.format == IMAGE_RGB8 )
+		return launchNV12ToRGB<uchar3>(input.ptr, input.pitch, (uchar3*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGBA8 )
+		return launchNV12ToRGB<uchar4>(input.ptr, input.pitch, (uchar4*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGB32F )
+		return launchNV12ToRGB<float3>(input.ptr, input.pitch, (float3*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGBA32F )
+		return launchNV12ToRGB<float4>(input.ptr, input.pitch, (float4*)output.ptr, output.pitch, input.width, input.height, stream);
+
+	return cudaErrorInvalidValue;
+}
+
+
 #if 0
 // cudaNV12SetupColorspace
 cudaError_t cudaNV12SetupColorspace( float hue )
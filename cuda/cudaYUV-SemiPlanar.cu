@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "cudaYUV.h"
+#include "cudaVector.h"
+#include "cudaImageView.h"
+
+#include "logging.h"
+
+
+//-----------------------------------------------------------------------------------
+// YUV to RGB colorspace conversion (luma in [0,1], chroma centered around 0)
+//-----------------------------------------------------------------------------------
+static inline __device__ __host__ float3 semiPlanarYUV2RGB( float Y, float U, float V )
+{
+	return make_float3(fminf(fmaxf(Y + 1.402f * V, 0.0f), 1.0f),
+				    fminf(fmaxf(Y - 0.344f * U - 0.714f * V, 0.0f), 1.0f),
+				    fminf(fmaxf(Y + 1.772f * U, 0.0f), 1.0f));
+}
+
+// the maximum value of each sample type
+static inline __device__ __host__ float sampleMax( uint8_t )	{ return 255.0f; }
+static inline __device__ __host__ float sampleMax( uint16_t )	{ return 65535.0f; }
+
+// scale the normalized RGB to the range of the output type (integers are rounded)
+template<typename T> inline __device__ __host__ T semiPlanarStore( const float3& rgb );
+
+template<> inline __device__ __host__ uchar3 semiPlanarStore( const float3& rgb )	{ return make_uchar3(rgb.x * 255.0f + 0.5f, rgb.y * 255.0f + 0.5f, rgb.z * 255.0f + 0.5f); }
+template<> inline __device__ __host__ uchar4 semiPlanarStore( const float3& rgb )	{ return make_uchar4(rgb.x * 255.0f + 0.5f, rgb.y * 255.0f + 0.5f, rgb.z * 255.0f + 0.5f, 255); }
+template<> inline __device__ __host__ float3 semiPlanarStore( const float3& rgb )	{ return make_float3(rgb.x * 255.0f, rgb.y * 255.0f, rgb.z * 255.0f); }
+template<> inline __device__ __host__ float4 semiPlanarStore( const float3& rgb )	{ return make_float4(rgb.x * 255.0f, rgb.y * 255.0f, rgb.z * 255.0f, 255.0f); }
+template<> inline __device__ __host__ ushort3 semiPlanarStore( const float3& rgb )	{ return make_ushort3(rgb.x * 65535.0f + 0.5f, rgb.y * 65535.0f + 0.5f, rgb.z * 65535.0f + 0.5f); }
+template<> inline __device__ __host__ ushort4 semiPlanarStore( const float3& rgb )	{ return make_ushort4(rgb.x * 65535.0f + 0.5f, rgb.y * 65535.0f + 0.5f, rgb.z * 65535.0f + 0.5f, 65535); }
+
+// convert one pixel (shared between the GPU and CPU implementations)
+template<typename T_sample, bool subsampleY, typename T_out>
+static inline __device__ __host__ T_out semiPlanarToRGB( uint8_t* src, size_t pitch, int x, int y, int height )
+{
+	const T_sample* lumaRow = (T_sample*)(src + y * pitch);
+	const T_sample* chromaRow = (T_sample*)(src + pitch * height + (subsampleY ? (y >> 1) : y) * pitch);
+
+	const int uv = x & ~1;	// U/V pairs are shared by two horizontal pixels
+
+	const float maxValue = sampleMax(T_sample());
+	const float chromaOffset = (maxValue + 1.0f) * 0.5f;	// 128 or 32768
+	const float scale = 1.0f / maxValue;
+
+	return semiPlanarStore<T_out>(semiPlanarYUV2RGB(lumaRow[x] * scale, 
+										   (chromaRow[uv] - chromaOffset) * scale, 
+										   (chromaRow[uv + 1] - chromaOffset) * scale));
+}
+
+
+//-----------------------------------------------------------------------------------
+// Semi-planar YUV to RGB
+//-----------------------------------------------------------------------------------
+template<typename T_sample, bool subsampleY, typename T_out>
+__global__ void YUVSemiPlanarToRGB( uint8_t* srcImage, size_t srcPitch, T_out* dstImage, size_t dstPitch, int width, int height )
+{
+	const int x = (blockIdx.x * blockDim.x) + threadIdx.x;
+	const int y = (blockIdx.y * blockDim.y) + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	((T_out*)((uint8_t*)dstImage + y * dstPitch))[x] = semiPlanarToRGB<T_sample, subsampleY, T_out>(srcImage, srcPitch, x, y, height);
+}
+
+template<typename T_sample, bool subsampleY, typename T_out>
+static cudaError_t launchYUVSemiPlanarToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream )
+{
+	const dim3 blockDim(32,8,1);
+	const dim3 gridDim(iDivUp(input.width,blockDim.x), iDivUp(input.height,blockDim.y), 1);
+
+	YUVSemiPlanarToRGB<T_sample, subsampleY, T_out><<<gridDim, blockDim, 0, stream>>>((uint8_t*)input.ptr, input.pitch, (T_out*)output.ptr, output.pitch, input.width, input.height);
+
+	return CUDA(cudaGetLastError());
+}
+
+template<typename T_sample, bool subsampleY, typename T_out>
+static bool cpuYUVSemiPlanarToRGB( const cudaImageView& input, const cudaImageView& output )
+{
+	for( size_t y=0; y < input.height; y++ )
+	{
+		T_out* out = output.Row<T_out>(y);
+
+		for( size_t x=0; x < input.width; x++ )
+			out[x] = semiPlanarToRGB<T_sample, subsampleY, T_out>((uint8_t*)input.ptr, input.pitch, x, y, input.height);
+	}
+
+	return true;
+}
+
+// dispatch on the output type, and then on the input type
+#define YUV_SEMI_PLANAR_DISPATCH(function, sample_type, subsample_y, ...)								\
+	if( output.format == IMAGE_RGB8 )														\
+		return function<sample_type, subsample_y, uchar3>(input, output, ##__VA_ARGS__);				\
+	else if( output.format == IMAGE_RGBA8 )													\
+		return function<sample_type, subsample_y, uchar4>(input, output, ##__VA_ARGS__);				\
+	else if( output.format == IMAGE_RGB32F )												\
+		return function<sample_type, subsample_y, float3>(input, output, ##__VA_ARGS__);				\
+	else if( output.format == IMAGE_RGBA32F )												\
+		return function<sample_type, subsample_y, float4>(input, output, ##__VA_ARGS__);				\
+	else if( output.format == IMAGE_RGB16 )													\
+		return function<sample_type, subsample_y, ushort3>(input, output, ##__VA_ARGS__);				\
+	else if( output.format == IMAGE_RGBA16 )												\
+		return function<sample_type, subsample_y, ushort4>(input, output, ##__VA_ARGS__);
+
+#define YUV_SEMI_PLANAR_DISPATCH_INPUT(function, ...)												\
+	if( input.format == IMAGE_NV12 )														\
+		{ YUV_SEMI_PLANAR_DISPATCH(function, uint8_t, true, ##__VA_ARGS__); }						\
+	else if( input.format == IMAGE_NV16 )													\
+		{ YUV_SEMI_PLANAR_DISPATCH(function, uint8_t, false, ##__VA_ARGS__); }						\
+	else if( input.format == IMAGE_P010 || input.format == IMAGE_P016 )							\
+		{ YUV_SEMI_PLANAR_DISPATCH(function, uint16_t, true, ##__VA_ARGS__); }
+
+static bool validateSemiPlanar( const cudaImageView& input, const cudaImageView& output, const char* function )
+{
+	if( !input.IsValid() || !output.IsValid() )
+	{
+		LogError(LOG_CUDA "%s -- invalid image view (NULL pointer, zero size, or pitch smaller than a row)\n", function);
+		return false;
+	}
+
+	if( input.width != output.width || input.height != output.height )
+	{
+		LogError(LOG_CUDA "%s -- input and output views must have the same dimensions (%zux%zu vs %zux%zu)\n", function, input.width, input.height, output.width, output.height);
+		return false;
+	}
+
+	if( input.width % 2 != 0 || (input.format != IMAGE_NV16 && input.height % 2 != 0) )
+	{
+		LogError(LOG_CUDA "%s -- %s images must have an even width%s (%zux%zu)\n", function, imageFormatToStr(input.format), 
+			    (input.format != IMAGE_NV16) ? " and height" : "", input.width, input.height);
+		return false;
+	}
+
+	return true;
+}
+
+// cudaYUVSemiPlanarToRGB
+cudaError_t cudaYUVSemiPlanarToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream )
+{
+	if( !validateSemiPlanar(input, output, "cudaYUVSemiPlanarToRGB()") )
+		return cudaErrorInvalidValue;
+
+	YUV_SEMI_PLANAR_DISPATCH_INPUT(launchYUVSemiPlanarToRGB, stream);
+
+	LogError(LOG_CUDA "cudaYUVSemiPlanarToRGB() -- unsupported image formats (%s -> %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+	return cudaErrorInvalidValue;
+}
+
+// cudaYUVSemiPlanarToRGBCPU
+bool cudaYUVSemiPlanarToRGBCPU( const cudaImageView& input, const cudaImageView& output )
+{
+	if( !validateSemiPlanar(input, output, "cudaYUVSemiPlanarToRGBCPU()") )
+		return false;
+
+	YUV_SEMI_PLANAR_DISPATCH_INPUT(cpuYUVSemiPlanarToRGB);
+
+	LogError(LOG_CUDA "cudaYUVSemiPlanarToRGBCPU() -- unsupported image formats (%s -> %s)\n", imageFormatToStr(input.format), imageFormatToStr(output.format));
+	return false;
+}
+
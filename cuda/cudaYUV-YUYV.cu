@@ -22,6 +22,7 @@
 
 #include "cudaYUV.h"
 #include "imageFormat.h"
+#include "cudaImageView.h"
 
 
 //-----------------------------------------------------------------------------------
@@ -98,7 +99,7 @@ template<> inline __host__ __device__ float8 make_vec( float x0, float y0, float
 // YUYV/UYVY to RGBA
 //-----------------------------------------------------------------------------------
 template <typename T, imageFormat format>
-__global__ void YUYVToRGBA( uchar4* src, T* dst, int halfWidth, int height )
+__global__ void YUYVToRGBA( uchar4* src, size_t srcPitch, T* dst, size_t dstPitch, int halfWidth, int height )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -106,7 +107,7 @@ __global__ void YUYVToRGBA( uchar4* src, T* dst, int halfWidth, int height )
 	if( x >= halfWidth || y >= height )
 		return;
 
-	const uchar4 macroPx = src[y * halfWidth + x];
+	const uchar4 macroPx = ((uchar4*)((uint8_t*)src + y * srcPitch))[x];
 
 	// Y0 is the brightness of pixel 0, Y1 the brightness of pixel 1.
 	// U and V is the color of both pixels.
@@ -141,25 +142,35 @@ __global__ void YUYVToRGBA( uchar4* src, T* dst, int halfWidth, int height )
 	const float3 px0 = YUV2RGB(y0, u, v);
 	const float3 px1 = YUV2RGB(y1, u, v);
 
-	dst[y * halfWidth + x] = make_vec<T>(px0.x, px0.y, px0.z, 255,
+	((T*)((uint8_t*)dst + y * dstPitch))[x] = make_vec<T>(px0.x, px0.y, px0.z, 255,
 								  px1.x, px1.y, px1.z, 255);
 } 
 
 template<typename T, imageFormat format>
-static cudaError_t launchYUYVToRGB( void* input, T* output, size_t width, size_t height, cudaStream_t stream)
+static cudaError_t launchYUYVToRGB( void* input, size_t inputPitch, T* output, size_t outputPitch, size_t width, size_t height, cudaStream_t stream)
 {
 	if( !input || !output || !width || !height )
 		return cudaErrorInvalidValue;
 
 	const int  halfWidth = width / 2;	// two pixels are output at once
+
+	if( inputPitch < halfWidth * sizeof(uchar4) || outputPitch < halfWidth * sizeof(T) )
+		return cudaErrorInvalidPitchValue;
+
 	const dim3 blockDim(8,8);
 	const dim3 gridDim(iDivUp(halfWidth, blockDim.x), iDivUp(height, blockDim.y));
 
-	YUYVToRGBA<T, format><<<gridDim, blockDim, 0, stream>>>((uchar4*)input, output, halfWidth, height);
+	YUYVToRGBA<T, format><<<gridDim, blockDim, 0, stream>>>((uchar4*)input, inputPitch, output, outputPitch, halfWidth, height);
 
 	return CUDA(cudaGetLastError());
 }
 
+template<typename T, imageFormat format>
+static cudaError_t launchYUYVToRGB( void* input, T* output, size_t width, size_t height, cudaStream_t stream)
+{
+	const int halfWidth = width / 2;
+	return launchYUYVToRGB<T, format>(input, halfWidth * sizeof(uchar4), output, halfWidth * sizeof(T), width, height, stream);
+}
 
 // cudaYUYVToRGB (uchar3)
 cudaError_t cudaYUYVToRGB( void* input, uchar3* output, size_t width, size_t height, cudaStream_t stream )
@@ -237,3 +248,36 @@ cudaError_t cudaYVYUToRGBA( void* input, float4* output, size_t width, size_t he
 	return launchYUYVToRGB<float8, IMAGE_YVYU>(input, (float8*)output, width, height, stream);
 }
 
+
+//-----------------------------------------------------------------------------------
+
+template<imageFormat format>
+static cudaError_t launchYUYVToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream )
+{
+	if( output.format == IMAGE_RGB8 )
+		return launchYUYVToRGB<uchar6, format>(input.ptr, input.pitch, (uchar6*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGBA8 )
+		return launchYUYVToRGB<uchar8, format>(input.ptr, input.pitch, (uchar8*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGB32F )
+		return launchYUYVToRGB<float6, format>(input.ptr, input.pitch, (float6*)output.ptr, output.pitch, input.width, input.height, stream);
+	else if( output.format == IMAGE_RGBA32F )
+		return launchYUYVToRGB<float8, format>(input.ptr, input.pitch, (float8*)output.ptr, output.pitch, input.width, input.height, stream);
+
+	return cudaErrorInvalidValue;
+}
+
+// cudaYUYVToRGB (image view)
+cudaError_t cudaYUYVToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream )
+{
+	if( input.width != output.width || input.height != output.height )
+		return cudaErrorInvalidValue;
+
+	if( input.format == IMAGE_YUYV )
+		return launchYUYVToRGB<IMAGE_YUYV>(input, output, stream);
+	else if( input.format == IMAGE_YVYU )
+		return launchYUYVToRGB<IMAGE_YVYU>(input, output, stream);
+	else if( input.format == IMAGE_UYVY )
+		return launchYUYVToRGB<IMAGE_UYVY>(input, output, stream);
+
+	return cudaErrorInvalidValue;
+}
@@ -25,6 +25,7 @@
 
 
 #include "cudaUtility.h"
+#include "cudaImageView.h"
 
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -241,6 +242,13 @@ cudaError_t cudaUYVYToRGBA( void* input, uchar4* output, size_t width, size_t he
  */
 cudaError_t cudaUYVYToRGBA( void* input, float4* output, size_t width, size_t height, cudaStream_t stream=0 );
 
+/**
+ * Convert a YUYV, YVYU, or UYVY 422 packed image view into an RGB/RGBA view (uchar or float),
+ * where the views can have padded rows (for example, V4L2 buffers with `bytesperline`).
+ * The packed format is taken from the input view's format.
+ */
+cudaError_t cudaYUYVToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream=0 );
+
 ///@}
 
 
@@ -276,6 +284,43 @@ cudaError_t cudaNV12ToRGBA( void* input, uchar4* output, size_t width, size_t he
  */
 cudaError_t cudaNV12ToRGBA( void* input, float4* output, size_t width, size_t height, cudaStream_t stream=0 );
 
+/**
+ * Convert an NV12 image view (semi-planar 4:2:0) to an RGB/RGBA view (uchar or float).
+ * The views can have padded rows, and the input's UV plane starts at `ptr + pitch * height`.
+ */
+cudaError_t cudaNV12ToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream=0 );
+
+///@}
+
+
+//////////////////////////////////////////////////////////////////////////////////
+/// @name YUV NV12/NV16/P010/P016 semi-planar to RGB
+/// @see cudaConvertColor() from cudaColorspace.h for automated format conversion
+/// @ingroup colorspace
+//////////////////////////////////////////////////////////////////////////////////
+
+///@{
+
+/**
+ * Convert a semi-planar YUV image view to an RGB/RGBA view (uint8, uint16 or float).
+ *
+ * The input can be NV12 (8-bit 4:2:0), NV16 (8-bit 4:2:2), P010 (10-bit 4:2:0 stored
+ * in the MSBs of 16-bit samples) or P016 (16-bit 4:2:0).  Each has a luma plane followed
+ * by an interleaved U/V plane starting at `ptr + pitch * height`.  The width must be even,
+ * and for the 4:2:0 formats the height must also be even.
+ *
+ * The output can be IMAGE_RGB8, IMAGE_RGBA8, IMAGE_RGB16, IMAGE_RGBA16, IMAGE_RGB32F
+ * or IMAGE_RGBA32F, where the float formats are in the range [0,255].
+ */
+cudaError_t cudaYUVSemiPlanarToRGB( const cudaImageView& input, const cudaImageView& output, cudaStream_t stream=0 );
+
+/**
+ * Convert a semi-planar YUV image view to RGB/RGBA on the CPU, as a reference
+ * implementation of cudaYUVSemiPlanarToRGB().  The views should be in
+ * CPU-accessible memory (e.g. mapped memory).
+ */
+bool cudaYUVSemiPlanarToRGBCPU( const cudaImageView& input, const cudaImageView& output );
+
 ///@}
 
 #endif
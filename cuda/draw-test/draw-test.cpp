@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaDraw.h"
+#include "cudaMappedMemory.h"
+
+#include "logging.h"
+#include "commandLine.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+int usage()
+{
+	printf("usage: draw-test [--help] [--width=W] [--height=H] [--commands=N] [--seed=N]\n\n");
+	printf("Check that cudaDrawList::Render() matches cudaDrawList::RenderCPU().\n");
+	printf("Random circles, lines and rects (some of them partly outside of the image) are\n");
+	printf("drawn with both, in-place and from a separate input image.  The list is also\n");
+	printf("rendered into two images of different sizes back-to-back on one stream, without\n");
+	printf("synchronizing in between, and both must match (returns 1 on failure).\n\n");
+	printf("optional arguments:\n");
+	printf("  --width=W         width of the test images (default is 1280)\n");
+	printf("  --height=H        height of the test images (default is 720)\n");
+	printf("  --commands=N      number of shapes to draw (default is 500)\n");
+	printf("  --seed=N          seed of the random shapes (default is 0)\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// random integer in [min, max]
+static int randInt( int min, int max )
+{
+	return min + rand() % (max - min + 1);
+}
+
+
+// random color, with an alpha that's either opaque or translucent
+static float4 randColor()
+{
+	return make_float4(randInt(0, 255), randInt(0, 255), randInt(0, 255), (rand() % 4 == 0) ? 255 : randInt(1, 254));
+}
+
+
+// queue random shapes that cover (and extend a bit beyond) the image
+static bool addCommands( cudaDrawList* list, int width, int height, uint32_t numCommands )
+{
+	const int margin = 32;
+
+	while( list->GetNumCommands() < numCommands )
+	{
+		const int x = randInt(-margin, width + margin);
+		const int y = randInt(-margin, height + margin);
+
+		// only circles once a rect and its outline (5 commands) might not fit
+		const int type = (list->GetNumCommands() + 5 > list->GetMaxCommands()) ? 0 : rand() % 3;
+		bool result = false;
+
+		if( type == 0 )
+			result = list->AddCircle(x, y, randInt(1, 64), randColor());
+		else if( type == 1 )
+			result = list->AddLine(x, y, randInt(-margin, width + margin), randInt(-margin, height + margin), randColor(), randInt(1, 8));
+		else
+			result = list->AddRect(x, y, x + randInt(1, 200), y + randInt(1, 150), (rand() % 3 == 0) ? make_float4(0,0,0,0) : randColor(),
+							   (rand() % 2 == 0) ? randColor() : make_float4(0,0,0,0), randInt(1, 4));
+
+		if( !result )
+		{
+			LogError("draw-test:  failed to queue command %u\n", list->GetNumCommands());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// allocate an image in mapped memory and fill it with a pattern
+static void* allocImage( int width, int height, imageFormat format, uint32_t seed )
+{
+	void* image = NULL;
+
+	if( !cudaAllocMapped(&image, width, height, format) )
+	{
+		LogError("draw-test:  failed to allocate %ix%i %s image\n", width, height, imageFormatToStr(format));
+		return NULL;
+	}
+
+	const size_t size = imageFormatSize(format, width, height);
+
+	if( imageFormatBaseType(format) == IMAGE_FLOAT )
+	{
+		float* data = (float*)image;
+
+		for( size_t n=0; n < size / sizeof(float); n++ )
+			data[n] = ((n * 7 + n / 13 + seed) % 256);
+	}
+	else
+	{
+		uint8_t* data = (uint8_t*)image;
+
+		for( size_t n=0; n < size; n++ )
+			data[n] = (n * 7 + n / 13 + seed) % 256;
+	}
+
+	return image;
+}
+
+
+// compare the GPU output against the CPU output
+static bool compareImage( const void* gpu, const void* cpu, int width, int height, imageFormat format, const char* name )
+{
+	const size_t size = imageFormatSize(format, width, height);
+
+	double maxDiff = 0.0;
+	size_t numDiff = 0;
+
+	if( imageFormatBaseType(format) == IMAGE_FLOAT )
+	{
+		for( size_t n=0; n < size / sizeof(float); n++ )
+		{
+			const double diff = fabs(((float*)gpu)[n] - ((float*)cpu)[n]);
+
+			if( diff > 0.0 )
+				numDiff++;
+
+			maxDiff = fmax(maxDiff, diff);
+		}
+	}
+	else
+	{
+		for( size_t n=0; n < size; n++ )
+		{
+			const double diff = abs(((uint8_t*)gpu)[n] - ((uint8_t*)cpu)[n]);
+
+			if( diff > 0.0 )
+				numDiff++;
+
+			maxDiff = fmax(maxDiff, diff);
+		}
+	}
+
+	// the CPU and GPU blend in the same order, so only allow for rounding
+	if( maxDiff > 1.0 )
+	{
+		LogError("draw-test:  %s differs from RenderCPU() (max difference %g in %zu values)\n", name, maxDiff, numDiff);
+		return false;
+	}
+
+	LogSuccess("draw-test:  %s passed (max difference %g)\n", name, maxDiff);
+	return true;
+}
+
+
+// test Render() in-place, or from a separate input image
+static bool testRender( cudaDrawList* list, imageFormat format, int width, int height, bool inPlace )
+{
+	char name[256];
+	sprintf(name, "Render(%s, %ix%i, %s)", imageFormatToStr(format), width, height, inPlace ? "in-place" : "input -> output");
+
+	void* input = allocImage(width, height, format, 0);
+	void* output = inPlace ? input : allocImage(width, height, format, 100);
+	void* reference = allocImage(width, height, format, 0);
+
+	bool result = false;
+
+	if( input != NULL && output != NULL && reference != NULL )
+	{
+		if( !CUDA_FAILED(list->Render(input, output, width, height, format)) && !CUDA_FAILED(cudaDeviceSynchronize()) &&
+		    list->RenderCPU(reference, width, height, format) )
+		{
+			result = compareImage(output, reference, width, height, format, name);
+		}
+		else
+		{
+			LogError("draw-test:  %s failed\n", name);
+		}
+	}
+
+	if( output != input )
+		CUDA_FREE_HOST(output);
+
+	CUDA_FREE_HOST(input);
+	CUDA_FREE_HOST(reference);
+
+	return result;
+}
+
+
+// test rendering the list into two images of different sizes on a stream, without synchronizing in between
+static bool testRenderSizes( cudaDrawList* list, imageFormat format, int width, int height, cudaStream_t stream )
+{
+	const int smallWidth = width / 2 + 3;
+	const int smallHeight = height / 3 + 1;
+
+	char name[256];
+	sprintf(name, "Render(%s, %ix%i then %ix%i on a stream)", imageFormatToStr(format), width, height, smallWidth, smallHeight);
+
+	void* large = allocImage(width, height, format, 0);
+	void* small = allocImage(smallWidth, smallHeight, format, 50);
+	void* largeReference = allocImage(width, height, format, 0);
+	void* smallReference = allocImage(smallWidth, smallHeight, format, 50);
+
+	bool result = false;
+
+	if( large != NULL && small != NULL && largeReference != NULL && smallReference != NULL )
+	{
+		if( !CUDA_FAILED(list->Render(large, width, height, format, stream)) &&
+		    !CUDA_FAILED(list->Render(small, smallWidth, smallHeight, format, stream)) &&
+		    !CUDA_FAILED(cudaStreamSynchronize(stream)) &&
+		    list->RenderCPU(largeReference, width, height, format) &&
+		    list->RenderCPU(smallReference, smallWidth, smallHeight, format) )
+		{
+			const bool largeResult = compareImage(large, largeReference, width, height, format, name);
+			const bool smallResult = compareImage(small, smallReference, smallWidth, smallHeight, format, name);
+
+			result = largeResult && smallResult;
+		}
+		else
+		{
+			LogError("draw-test:  %s failed\n", name);
+		}
+	}
+
+	CUDA_FREE_HOST(large);
+	CUDA_FREE_HOST(small);
+	CUDA_FREE_HOST(largeReference);
+	CUDA_FREE_HOST(smallReference);
+
+	return result;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	const int width = cmdLine.GetInt("width", 1280);
+	const int height = cmdLine.GetInt("height", 720);
+	const uint32_t numCommands = cmdLine.GetUnsignedInt("commands", 500);
+
+	if( width < 16 || height < 16 || numCommands == 0 )
+	{
+		LogError("draw-test:  the size needs to be at least 16x16, with at least one command\n");
+		return usage();
+	}
+
+	srand(cmdLine.GetUnsignedInt("seed", 0));
+
+
+	/*
+	 * create the draw list and stream
+	 */
+	cudaDrawList* list = cudaDrawList::Create(numCommands);
+
+	if( !list )
+	{
+		LogError("draw-test:  failed to create draw list\n");
+		return 1;
+	}
+
+	if( !addCommands(list, width, height, numCommands) )
+		return 1;
+
+	cudaStream_t stream = NULL;
+
+	if( CUDA_FAILED(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking)) )
+	{
+		LogError("draw-test:  failed to create CUDA stream\n");
+		return 1;
+	}
+
+	LogInfo("draw-test:  queued %u commands\n", list->GetNumCommands());
+
+
+	/*
+	 * compare against the CPU in each format
+	 */
+	const imageFormat formats[] = { IMAGE_RGB8, IMAGE_RGBA8, IMAGE_RGB32F, IMAGE_RGBA32F };
+	const uint32_t numFormats = sizeof(formats) / sizeof(imageFormat);
+
+	uint32_t numTests = 0;
+	uint32_t numFailed = 0;
+
+	#define RUN_TEST(x)  { numTests++; if( !(x) ) numFailed++; }
+
+	for( uint32_t n=0; n < numFormats; n++ )
+	{
+		RUN_TEST(testRender(list, formats[n], width, height, true));
+		RUN_TEST(testRender(list, formats[n], width, height, false));
+		RUN_TEST(testRenderSizes(list, formats[n], width, height, stream));
+	}
+
+	if( numFailed > 0 )
+		LogError("draw-test:  %u of %u tests failed\n", numFailed, numTests);
+	else
+		LogSuccess("draw-test:  all %u tests passed\n", numTests);
+
+	CUDA(cudaStreamDestroy(stream));
+	delete list;
+
+	return (numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaResize.h"
+#include "cudaCrop.h"
+#include "cudaOverlay.h"
+#include "cudaColorspace.h"
+#include "cudaMappedMemory.h"
+
+#include "logging.h"
+#include "commandLine.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+int usage()
+{
+	printf("usage: pitch-test [--help] [--width=W] [--height=H] [--padding=BYTES]\n\n");
+	printf("Check that the kernels which accept cudaImageView handle padded rows.\n");
+	printf("cudaResize(), cudaCrop(), cudaOverlay() and cudaConvertColor() are run on\n");
+	printf("views whose pitch is larger than the rows, and the output is compared against\n");
+	printf("the tightly-packed versions of them.  The padding of the output rows must also\n");
+	printf("be left untouched (returns 1 on failure).\n\n");
+	printf("optional arguments:\n");
+	printf("  --width=W         width of the test images (default is 640)\n");
+	printf("  --height=H        height of the test images (default is 480)\n");
+	printf("  --padding=BYTES   bytes added to the end of each row (default is 64)\n");
+	printf("                    this should be a multiple of 16 to keep float4 rows aligned\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// value that the row padding is filled with, which the kernels shouldn't overwrite
+#define PADDING_VALUE 0xCD
+
+
+// a tightly-packed image, and a copy of it with padded rows
+struct testImage
+{
+	cudaImageView packed;
+	cudaImageView pitched;
+};
+
+
+// allocate a packed and pitched image in mapped memory
+static bool allocImage( testImage* image, size_t width, size_t height, imageFormat format, size_t padding )
+{
+	const size_t pitch = cudaImageView::PackedPitch(format, width) + padding;
+	const size_t rows = cudaImageView::Rows(format, height);
+
+	void* packed = NULL;
+	void* pitched = NULL;
+
+	if( !cudaAllocMapped(&packed, width, height, format) || !cudaAllocMapped(&pitched, pitch * rows) )
+	{
+		LogError("pitch-test:  failed to allocate %zux%zu %s image\n", width, height, imageFormatToStr(format));
+		return false;
+	}
+
+	memset(pitched, PADDING_VALUE, pitch * rows);
+
+	image->packed  = cudaImageView(packed, width, height, format);
+	image->pitched = cudaImageView(pitched, width, height, pitch, format);
+
+	return true;
+}
+
+
+// free a packed and pitched image
+static void freeImage( testImage* image )
+{
+	CUDA_FREE_HOST(image->packed.ptr);
+	CUDA_FREE_HOST(image->pitched.ptr);
+
+	image->packed = cudaImageView();
+	image->pitched = cudaImageView();
+}
+
+
+// fill the packed image with a pattern, and copy it into the pitched image
+static bool fillImage( testImage* image, uint32_t seed )
+{
+	const imageFormat format = image->packed.format;
+	const size_t size = image->packed.Size();
+
+	if( imageFormatBaseType(format) == IMAGE_FLOAT )
+	{
+		float* data = (float*)image->packed.ptr;
+
+		for( size_t n=0; n < size / sizeof(float); n++ )
+			data[n] = ((n * 7 + n / 13 + seed) % 256);
+	}
+	else if( imageFormatBaseType(format) == IMAGE_UINT16 )
+	{
+		uint16_t* data = (uint16_t*)image->packed.ptr;
+
+		for( size_t n=0; n < size / sizeof(uint16_t); n++ )
+			data[n] = (n * 1031 + n / 13 + seed) % 65536;
+	}
+	else
+	{
+		uint8_t* data = (uint8_t*)image->packed.ptr;
+
+		for( size_t n=0; n < size; n++ )
+			data[n] = (n * 7 + n / 13 + seed) % 256;
+	}
+
+	if( CUDA_FAILED(cudaImageCopy(image->packed, image->pitched)) )
+		return false;
+
+	return !CUDA_FAILED(cudaDeviceSynchronize());
+}
+
+
+// compare the pitched output against the packed output, and check that the padding wasn't touched
+static bool compareImage( const testImage& image, const char* name )
+{
+	const cudaImageView& packed = image.packed;
+	const cudaImageView& pitched = image.pitched;
+
+	const imageBaseType baseType = imageFormatBaseType(packed.format);
+	const size_t rowSize = packed.RowSize();
+	const size_t rows = cudaImageView::Rows(packed.format, packed.height);
+
+	double maxDiff = 0.0;
+
+	for( size_t y=0; y < rows; y++ )
+	{
+		const uint8_t* a = packed.Row<uint8_t>(y);
+		const uint8_t* b = pitched.Row<uint8_t>(y);
+
+		if( baseType == IMAGE_FLOAT )
+		{
+			for( size_t x=0; x < rowSize / sizeof(float); x++ )
+				maxDiff = fmax(maxDiff, fabs(((float*)a)[x] - ((float*)b)[x]));
+		}
+		else if( baseType == IMAGE_UINT16 )
+		{
+			for( size_t x=0; x < rowSize / sizeof(uint16_t); x++ )
+				maxDiff = fmax(maxDiff, abs(((uint16_t*)a)[x] - ((uint16_t*)b)[x]));
+		}
+		else
+		{
+			for( size_t x=0; x < rowSize; x++ )
+				maxDiff = fmax(maxDiff, abs(a[x] - b[x]));
+		}
+
+		for( size_t x=rowSize; x < pitched.pitch; x++ )
+		{
+			if( b[x] != PADDING_VALUE )
+			{
+				LogError("pitch-test:  %s wrote to the padding of row %zu (byte %zu)\n", name, y, x);
+				return false;
+			}
+		}
+	}
+
+	// the packed and pitched paths should give the same result, allowing for rounding
+	if( maxDiff > 1.0 )
+	{
+		LogError("pitch-test:  %s pitched output differs from the packed output (max difference %g)\n", name, maxDiff);
+		return false;
+	}
+
+	LogSuccess("pitch-test:  %s passed (max difference %g)\n", name, maxDiff);
+	return true;
+}
+
+
+// test cudaResize() with a format and filter
+static bool testResize( imageFormat format, int2 inputSize, int2 outputSize, cudaFilterMode filter, size_t padding )
+{
+	testImage input, output;
+	bool result = false;
+
+	char name[256];
+	sprintf(name, "cudaResize(%s, %ix%i -> %ix%i, %s)", imageFormatToStr(format), inputSize.x, inputSize.y,
+		   outputSize.x, outputSize.y, cudaFilterModeToStr(filter));
+
+	if( allocImage(&input, inputSize.x, inputSize.y, format, padding) && allocImage(&output, outputSize.x, outputSize.y, format, padding) && fillImage(&input, 0) )
+	{
+		if( !CUDA_FAILED(cudaResize(input.packed.ptr, inputSize.x, inputSize.y, output.packed.ptr, outputSize.x, outputSize.y, format, filter)) &&
+		    !CUDA_FAILED(cudaResize(input.pitched, output.pitched, filter)) && !CUDA_FAILED(cudaDeviceSynchronize()) )
+		{
+			result = compareImage(output, name);
+		}
+		else
+		{
+			LogError("pitch-test:  %s failed\n", name);
+		}
+	}
+
+	freeImage(&input);
+	freeImage(&output);
+
+	return result;
+}
+
+
+// test cudaCrop() with a format
+static bool testCrop( imageFormat format, int2 inputSize, const int4& roi, size_t padding )
+{
+	testImage input, output;
+	bool result = false;
+
+	char name[256];
+	sprintf(name, "cudaCrop(%s, %ix%i -> (%i, %i, %i, %i))", imageFormatToStr(format), inputSize.x, inputSize.y, roi.x, roi.y, roi.z, roi.w);
+
+	if( allocImage(&input, inputSize.x, inputSize.y, format, padding) && allocImage(&output, roi.z - roi.x, roi.w - roi.y, format, padding) && fillImage(&input, 0) )
+	{
+		if( !CUDA_FAILED(cudaCrop(input.packed.ptr, output.packed.ptr, roi, inputSize.x, inputSize.y, format)) &&
+		    !CUDA_FAILED(cudaCrop(input.pitched, output.pitched, roi)) && !CUDA_FAILED(cudaDeviceSynchronize()) )
+		{
+			result = compareImage(output, name);
+		}
+		else
+		{
+			LogError("pitch-test:  %s failed\n", name);
+		}
+	}
+
+	freeImage(&input);
+	freeImage(&output);
+
+	return result;
+}
+
+
+// test cudaOverlay() with a format
+static bool testOverlay( imageFormat format, int2 inputSize, int2 outputSize, int2 location, size_t padding )
+{
+	testImage input, output;
+	bool result = false;
+
+	char name[256];
+	sprintf(name, "cudaOverlay(%s, %ix%i onto %ix%i at (%i, %i))", imageFormatToStr(format), inputSize.x, inputSize.y,
+		   outputSize.x, outputSize.y, location.x, location.y);
+
+	if( allocImage(&input, inputSize.x, inputSize.y, format, padding) && allocImage(&output, outputSize.x, outputSize.y, format, padding) &&
+	    fillImage(&input, 0) && fillImage(&output, 100) )
+	{
+		if( !CUDA_FAILED(cudaOverlay(input.packed.ptr, inputSize.x, inputSize.y, output.packed.ptr, outputSize.x, outputSize.y, format, location.x, location.y)) &&
+		    !CUDA_FAILED(cudaOverlay(input.pitched, output.pitched, location.x, location.y)) && !CUDA_FAILED(cudaDeviceSynchronize()) )
+		{
+			result = compareImage(output, name);
+		}
+		else
+		{
+			LogError("pitch-test:  %s failed\n", name);
+		}
+	}
+
+	freeImage(&input);
+	freeImage(&output);
+
+	return result;
+}
+
+
+// test cudaConvertColor() between two formats
+static bool testConvert( imageFormat inputFormat, imageFormat outputFormat, int2 size, size_t padding )
+{
+	testImage input, output;
+	bool result = false;
+
+	char name[256];
+	sprintf(name, "cudaConvertColor(%s -> %s, %ix%i)", imageFormatToStr(inputFormat), imageFormatToStr(outputFormat), size.x, size.y);
+
+	if( allocImage(&input, size.x, size.y, inputFormat, padding) && allocImage(&output, size.x, size.y, outputFormat, padding) && fillImage(&input, 0) )
+	{
+		if( !CUDA_FAILED(cudaConvertColor(input.packed.ptr, inputFormat, output.packed.ptr, outputFormat, size.x, size.y)) &&
+		    !CUDA_FAILED(cudaConvertColor(input.pitched, output.pitched)) && !CUDA_FAILED(cudaDeviceSynchronize()) )
+		{
+			result = compareImage(output, name);
+		}
+		else
+		{
+			LogError("pitch-test:  %s failed\n", name);
+		}
+	}
+
+	freeImage(&input);
+	freeImage(&output);
+
+	return result;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	const int width = cmdLine.GetInt("width", 640);
+	const int height = cmdLine.GetInt("height", 480);
+	const size_t padding = cmdLine.GetUnsignedInt("padding", 64);
+
+	// the 4:2:x formats need even dimensions, and the crops/overlays need room
+	if( width < 64 || height < 64 || (width % 2) != 0 || (height % 2) != 0 || padding == 0 )
+	{
+		LogError("pitch-test:  the size needs to be even and at least 64x64, with a non-zero padding\n");
+		return usage();
+	}
+
+	const int2 size = make_int2(width, height);
+	const int2 smaller = make_int2(width / 2 - 5, height / 2 - 3);
+	const int2 larger = make_int2(width + width / 3, height + height / 5);
+
+	uint32_t numTests = 0;
+	uint32_t numFailed = 0;
+
+	#define RUN_TEST(x)  { numTests++; if( !(x) ) numFailed++; }
+
+
+	/*
+	 * resize, crop and overlay (the same formats)
+	 */
+	const imageFormat formats[] = { IMAGE_GRAY8, IMAGE_RGB8, IMAGE_RGBA8, IMAGE_BGR8, IMAGE_GRAY32F, IMAGE_RGB32F, IMAGE_RGBA32F };
+	const uint32_t numFormats = sizeof(formats) / sizeof(imageFormat);
+
+	for( uint32_t n=0; n < numFormats; n++ )
+	{
+		RUN_TEST(testResize(formats[n], size, smaller, FILTER_POINT, padding));
+		RUN_TEST(testResize(formats[n], size, larger, FILTER_LINEAR, padding));
+		RUN_TEST(testCrop(formats[n], size, make_int4(7, 5, 7 + smaller.x, 5 + smaller.y), padding));
+		RUN_TEST(testOverlay(formats[n], smaller, size, make_int2(width / 5, height / 7), padding));
+		RUN_TEST(testOverlay(formats[n], smaller, size, make_int2(width - smaller.x / 2, height - smaller.y / 3), padding));	// clipped
+	}
+
+
+	/*
+	 * color conversions
+	 */
+	const imageFormat conversions[][2] = {
+		{ IMAGE_RGB8, IMAGE_RGBA8 },
+		{ IMAGE_RGBA8, IMAGE_RGB8 },
+		{ IMAGE_RGB8, IMAGE_BGR8 },
+		{ IMAGE_RGBA8, IMAGE_GRAY8 },
+		{ IMAGE_GRAY8, IMAGE_RGBA32F },
+		{ IMAGE_RGBA32F, IMAGE_RGB8 },
+		{ IMAGE_BGR8, IMAGE_RGB32F },
+		{ IMAGE_RGB8, IMAGE_RGB8 },
+		{ IMAGE_YUYV, IMAGE_RGB8 },
+		{ IMAGE_YVYU, IMAGE_RGBA8 },
+		{ IMAGE_UYVY, IMAGE_RGBA32F },
+		{ IMAGE_NV12, IMAGE_RGB8 },
+		{ IMAGE_NV12, IMAGE_RGBA32F }
+	};
+
+	const uint32_t numConversions = sizeof(conversions) / sizeof(conversions[0]);
+
+	for( uint32_t n=0; n < numConversions; n++ )
+		RUN_TEST(testConvert(conversions[n][0], conversions[n][1], size, padding));
+
+
+	if( numFailed > 0 )
+		LogError("pitch-test:  %u of %u tests failed\n", numFailed, numTests);
+	else
+		LogSuccess("pitch-test:  all %u tests passed\n", numTests);
+
+	return (numFailed > 0) ? 1 : 0;
+}
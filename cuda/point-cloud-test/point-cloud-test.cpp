@@ -0,0 +1,605 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaPointCloud.h"
+#include "cudaMappedMemory.h"
+
+#include "logging.h"
+#include "commandLine.h"
+
+#include <string>
+#include <vector>
+#include <set>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+
+int usage()
+{
+	printf("usage: point-cloud-test [--help] [--width=W] [--height=H] [--voxel-size=SIZE]\n");
+	printf("                        [--stride=N] [--prefix=PATH] [--keep]\n\n");
+	printf("Check that cudaPointCloud saves and downsamples the points correctly.\n");
+	printf("A point cloud is extracted from a synthetic depth map and color image, saved\n");
+	printf("as ASCII, binary and compressed PCD and binary PLY (with Save() and SaveAsync()),\n");
+	printf("and each file is read back and compared against the points.  The point counts\n");
+	printf("and bounds are also checked after DownsampleStride() and DownsampleVoxel()\n");
+	printf("(returns 1 on failure).\n\n");
+	printf("optional arguments:\n");
+	printf("  --width=W          width of the depth map (default is 320)\n");
+	printf("  --height=H         height of the depth map (default is 240)\n");
+	printf("  --voxel-size=SIZE  size of the voxels to downsample with (default is 0.05)\n");
+	printf("  --stride=N         stride to downsample with (default is 7)\n");
+	printf("  --prefix=PATH      prefix of the files that are written (default is point-cloud-test)\n");
+	printf("  --keep             keep the files instead of deleting them\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+typedef cudaPointCloud::Vertex Vertex;
+
+
+// fill the depth map and color image with a pattern (with some invalid depths)
+static bool createImages( float** depth, float4** rgba, int width, int height )
+{
+	if( !cudaAllocMapped(depth, width * height * sizeof(float)) || !cudaAllocMapped(rgba, width * height * sizeof(float4)) )
+	{
+		LogError("point-cloud-test:  failed to allocate %ix%i depth map and color image\n", width, height);
+		return false;
+	}
+
+	for( int y=0; y < height; y++ )
+	{
+		for( int x=0; x < width; x++ )
+		{
+			const int i = y * width + x;
+
+			(*depth)[i] = ((i % 97) == 0) ? NAN : 1.0f + 4.0f * x / width + 0.5f * sinf(y * 0.05f);
+			(*rgba)[i] = make_float4(x % 256, y % 256, (x + y) % 256, 255);
+		}
+	}
+
+	return true;
+}
+
+
+// extract the point cloud, and copy the points
+static bool extractPoints( cudaPointCloud* cloud, float* depth, float4* rgba, int width, int height, std::vector<Vertex>* points )
+{
+	if( !cloud->Extract(depth, rgba, width, height) || CUDA_FAILED(cudaDeviceSynchronize()) )
+	{
+		LogError("point-cloud-test:  failed to extract point cloud\n");
+		return false;
+	}
+
+	if( cloud->GetNumPoints() != uint32_t(width * height) )
+	{
+		LogError("point-cloud-test:  extracted %u points (expected %i)\n", cloud->GetNumPoints(), width * height);
+		return false;
+	}
+
+	points->assign(cloud->GetData(), cloud->GetData() + cloud->GetNumPoints());
+	return true;
+}
+
+
+// lzfDecompress (the inverse of the compression used for binary_compressed PCD)
+static bool lzfDecompress( const uint8_t* input, uint32_t inputSize, uint8_t* output, uint32_t outputSize )
+{
+	const uint8_t* ip = input;
+	const uint8_t* inputEnd = input + inputSize;
+
+	uint8_t* op = output;
+	uint8_t* outputEnd = output + outputSize;
+
+	while( ip < inputEnd )
+	{
+		uint32_t ctrl = *ip++;
+
+		if( ctrl < (1 << 5) )
+		{
+			// literal run
+			ctrl++;
+
+			if( op + ctrl > outputEnd || ip + ctrl > inputEnd )
+				return false;
+
+			memcpy(op, ip, ctrl);
+
+			op += ctrl;
+			ip += ctrl;
+		}
+		else
+		{
+			// back-reference
+			uint32_t len = ctrl >> 5;
+
+			if( len == 7 )
+			{
+				if( ip >= inputEnd )
+					return false;
+
+				len += *ip++;
+			}
+
+			if( ip >= inputEnd )
+				return false;
+
+			const uint8_t* ref = op - ((ctrl & 0x1f) << 8) - 1 - *ip++;
+			len += 2;
+
+			if( ref < output || op + len > outputEnd )
+				return false;
+
+			for( uint32_t n=0; n < len; n++ )
+				*op++ = *ref++;
+		}
+	}
+
+	return (op == outputEnd);
+}
+
+
+// unpack the color from 24 bits
+static inline uchar3 unpackRGB( uint32_t rgb )
+{
+	return make_uchar3((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+}
+
+
+// loadPCD
+static bool loadPCD( FILE* file, std::vector<Vertex>* points, bool* hasRGB )
+{
+	char line[512];
+
+	uint32_t numPoints = 0;
+	std::string data;
+
+	*hasRGB = false;
+
+	// read the header up to the DATA line
+	while( fgets(line, sizeof(line), file) != NULL )
+	{
+		char value[512];
+
+		if( strncmp(line, "FIELDS", 6) == 0 )
+			*hasRGB = (strstr(line, " rgb") != NULL);
+		else if( sscanf(line, "POINTS %u", &numPoints) == 1 )
+			continue;
+		else if( sscanf(line, "DATA %511s", value) == 1 )
+		{
+			data = value;
+			break;
+		}
+	}
+
+	const uint32_t numFields = *hasRGB ? 4 : 3;
+	std::vector<uint32_t> fields(numPoints * numFields);
+
+	points->resize(numPoints);
+
+	if( data == "ascii" )
+	{
+		for( uint32_t n=0; n < numPoints; n++ )
+		{
+			Vertex& point = (*points)[n];
+			uint32_t rgb = 0xFFFFFF;
+
+			if( !fgets(line, sizeof(line), file) )
+				return false;
+
+			char* str = line;
+
+			point.pos.x = strtof(str, &str);
+			point.pos.y = strtof(str, &str);
+			point.pos.z = strtof(str, &str);
+
+			if( *hasRGB )
+				rgb = strtoul(str, &str, 10);
+
+			point.color = unpackRGB(rgb);
+		}
+
+		return true;
+	}
+	else if( data == "binary" )
+	{
+		if( fread(fields.data(), sizeof(uint32_t) * numFields, numPoints, file) != numPoints )
+			return false;
+
+		for( uint32_t n=0; n < numPoints; n++ )
+		{
+			Vertex& point = (*points)[n];
+			const uint32_t* record = fields.data() + n * numFields;
+
+			memcpy(&point.pos, record, sizeof(float3));
+			point.color = unpackRGB(*hasRGB ? record[3] : 0xFFFFFF);
+		}
+
+		return true;
+	}
+	else if( data == "binary_compressed" )
+	{
+		uint32_t compressedSize = 0;
+		uint32_t uncompressedSize = 0;
+
+		if( fread(&compressedSize, sizeof(uint32_t), 1, file) != 1 || fread(&uncompressedSize, sizeof(uint32_t), 1, file) != 1 )
+			return false;
+
+		if( uncompressedSize != fields.size() * sizeof(uint32_t) )
+		{
+			LogError("point-cloud-test:  compressed size is %u bytes (expected %zu)\n", uncompressedSize, fields.size() * sizeof(uint32_t));
+			return false;
+		}
+
+		std::vector<uint8_t> compressed(compressedSize);
+
+		if( fread(compressed.data(), 1, compressedSize, file) != compressedSize )
+			return false;
+
+		if( !lzfDecompress(compressed.data(), compressedSize, (uint8_t*)fields.data(), uncompressedSize) )
+		{
+			LogError("point-cloud-test:  failed to decompress the points\n");
+			return false;
+		}
+
+		// the fields are stored contiguously (x x x... y y y...)
+		for( uint32_t n=0; n < numPoints; n++ )
+		{
+			Vertex& point = (*points)[n];
+
+			memcpy(&point.pos.x, &fields[n], sizeof(float));
+			memcpy(&point.pos.y, &fields[numPoints + n], sizeof(float));
+			memcpy(&point.pos.z, &fields[numPoints * 2 + n], sizeof(float));
+
+			point.color = unpackRGB(*hasRGB ? fields[numPoints * 3 + n] : 0xFFFFFF);
+		}
+
+		return true;
+	}
+
+	LogError("point-cloud-test:  unknown PCD data '%s'\n", data.c_str());
+	return false;
+}
+
+
+// loadPLY
+static bool loadPLY( FILE* file, std::vector<Vertex>* points )
+{
+	char line[512];
+	uint32_t numPoints = 0;
+
+	while( fgets(line, sizeof(line), file) != NULL )
+	{
+		if( sscanf(line, "element vertex %u", &numPoints) == 1 )
+			continue;
+		else if( strncmp(line, "end_header", 10) == 0 )
+			break;
+	}
+
+	points->resize(numPoints);
+	return (fread(points->data(), sizeof(Vertex), numPoints, file) == numPoints);
+}
+
+
+// load a point cloud that was saved in a format
+static bool loadPoints( const char* filename, cudaPointCloud::FileFormat format, std::vector<Vertex>* points, bool* hasRGB )
+{
+	FILE* file = fopen(filename, "rb");
+
+	if( !file )
+	{
+		LogError("point-cloud-test:  failed to open %s\n", filename);
+		return false;
+	}
+
+	bool result = false;
+
+	if( format == cudaPointCloud::PLY_BINARY )
+	{
+		result = loadPLY(file, points);
+		*hasRGB = true;
+	}
+	else
+	{
+		result = loadPCD(file, points, hasRGB);
+	}
+
+	fclose(file);
+
+	if( !result )
+		LogError("point-cloud-test:  failed to read %s\n", filename);
+
+	return result;
+}
+
+
+// compare two floats that are both NaN, or within the tolerance
+static inline bool compareFloat( float a, float b, float tolerance )
+{
+	if( isnan(a) || isnan(b) )
+		return isnan(a) && isnan(b);
+
+	return fabsf(a - b) <= tolerance * fmaxf(1.0f, fabsf(b));
+}
+
+
+// compare the points that were read back against the original points
+static bool comparePoints( const std::vector<Vertex>& loaded, const std::vector<Vertex>& points, bool checkClass, float tolerance, const char* name )
+{
+	if( loaded.size() != points.size() )
+	{
+		LogError("point-cloud-test:  %s has %zu points (expected %zu)\n", name, loaded.size(), points.size());
+		return false;
+	}
+
+	for( size_t n=0; n < points.size(); n++ )
+	{
+		const Vertex& a = loaded[n];
+		const Vertex& b = points[n];
+
+		if( !compareFloat(a.pos.x, b.pos.x, tolerance) || !compareFloat(a.pos.y, b.pos.y, tolerance) || !compareFloat(a.pos.z, b.pos.z, tolerance) ||
+		    a.color.x != b.color.x || a.color.y != b.color.y || a.color.z != b.color.z || (checkClass && a.classID != b.classID) )
+		{
+			LogError("point-cloud-test:  %s point %zu is (%f %f %f) rgb(%u %u %u) class %u, expected (%f %f %f) rgb(%u %u %u) class %u\n", name, n,
+				    a.pos.x, a.pos.y, a.pos.z, a.color.x, a.color.y, a.color.z, a.classID,
+				    b.pos.x, b.pos.y, b.pos.z, b.color.x, b.color.y, b.color.z, b.classID);
+			return false;
+		}
+	}
+
+	LogSuccess("point-cloud-test:  %s passed (%zu points)\n", name, points.size());
+	return true;
+}
+
+
+// test saving the point cloud in a format, and reading it back
+static bool testSave( cudaPointCloud* cloud, const std::vector<Vertex>& points, cudaPointCloud::FileFormat format, bool async, const std::string& filename, bool keep )
+{
+	char name[256];
+	sprintf(name, "%s(%s)", async ? "SaveAsync" : "Save", filename.c_str());
+
+	bool result = false;
+
+	if( async )
+		result = cloud->SaveAsync(filename.c_str(), format) && cloud->WaitSave();
+	else
+		result = cloud->Save(filename.c_str(), format);
+
+	if( !result )
+	{
+		LogError("point-cloud-test:  %s failed\n", name);
+		return false;
+	}
+
+	std::vector<Vertex> loaded;
+	bool hasRGB = false;
+
+	result = loadPoints(filename.c_str(), format, &loaded, &hasRGB);
+
+	if( result && !hasRGB )
+	{
+		LogError("point-cloud-test:  %s didn't save the colors\n", name);
+		result = false;
+	}
+
+	// ASCII is printed with 6 decimal places, the binary formats should match exactly
+	if( result )
+		result = comparePoints(loaded, points, format == cudaPointCloud::PLY_BINARY, (format == cudaPointCloud::PCD_ASCII) ? 1e-5f : 0.0f, name);
+
+	if( !keep )
+		unlink(filename.c_str());
+
+	return result;
+}
+
+
+// find the bounds of the finite points
+static void findBounds( const Vertex* points, uint32_t numPoints, float3* minBounds, float3* maxBounds )
+{
+	*minBounds = make_float3(INFINITY, INFINITY, INFINITY);
+	*maxBounds = make_float3(-INFINITY, -INFINITY, -INFINITY);
+
+	for( uint32_t n=0; n < numPoints; n++ )
+	{
+		const float3& pos = points[n].pos;
+
+		if( !isfinite(pos.x) || !isfinite(pos.y) || !isfinite(pos.z) )
+			continue;
+
+		*minBounds = make_float3(fminf(minBounds->x, pos.x), fminf(minBounds->y, pos.y), fminf(minBounds->z, pos.z));
+		*maxBounds = make_float3(fmaxf(maxBounds->x, pos.x), fmaxf(maxBounds->y, pos.y), fmaxf(maxBounds->z, pos.z));
+	}
+}
+
+
+// test DownsampleStride()
+static bool testStride( cudaPointCloud* cloud, const std::vector<Vertex>& points, uint32_t stride )
+{
+	char name[256];
+	sprintf(name, "DownsampleStride(%u)", stride);
+
+	if( !cloud->DownsampleStride(stride) )
+	{
+		LogError("point-cloud-test:  %s failed\n", name);
+		return false;
+	}
+
+	// every N-th point should be kept, in order
+	std::vector<Vertex> expected;
+
+	for( size_t n=0; n < points.size(); n += stride )
+		expected.push_back(points[n]);
+
+	std::vector<Vertex> downsampled(cloud->GetData(), cloud->GetData() + cloud->GetNumPoints());
+	return comparePoints(downsampled, expected, true, 0.0f, name);
+}
+
+
+// test DownsampleVoxel()
+static bool testVoxel( cudaPointCloud* cloud, const std::vector<Vertex>& points, float voxelSize )
+{
+	char name[256];
+	sprintf(name, "DownsampleVoxel(%g)", voxelSize);
+
+	if( !cloud->DownsampleVoxel(voxelSize) )
+	{
+		LogError("point-cloud-test:  %s failed\n", name);
+		return false;
+	}
+
+	// there should be one point for each voxel that has finite points
+	std::set<std::vector<int64_t>> voxels;
+
+	for( size_t n=0; n < points.size(); n++ )
+	{
+		const float3& pos = points[n].pos;
+
+		if( !isfinite(pos.x) || !isfinite(pos.y) || !isfinite(pos.z) )
+			continue;
+
+		std::vector<int64_t> key(3);
+
+		key[0] = (int64_t)floorf(pos.x / voxelSize);
+		key[1] = (int64_t)floorf(pos.y / voxelSize);
+		key[2] = (int64_t)floorf(pos.z / voxelSize);
+
+		voxels.insert(key);
+	}
+
+	const uint32_t numPoints = cloud->GetNumPoints();
+
+	// allow for points that land on the edge of a voxel being rounded differently
+	if( numPoints == 0 || fabs(double(numPoints) - double(voxels.size())) > voxels.size() * 0.001 )
+	{
+		LogError("point-cloud-test:  %s kept %u points (expected %zu voxels)\n", name, numPoints, voxels.size());
+		return false;
+	}
+
+	// the averaged points should be finite, and inside the bounds of the original points
+	float3 minBounds, maxBounds;
+	findBounds(points.data(), points.size(), &minBounds, &maxBounds);
+
+	const float tolerance = 1e-4f;
+
+	for( uint32_t n=0; n < numPoints; n++ )
+	{
+		const float3& pos = cloud->GetData(n)->pos;
+
+		if( !isfinite(pos.x) || !isfinite(pos.y) || !isfinite(pos.z) ||
+		    pos.x < minBounds.x - tolerance || pos.y < minBounds.y - tolerance || pos.z < minBounds.z - tolerance ||
+		    pos.x > maxBounds.x + tolerance || pos.y > maxBounds.y + tolerance || pos.z > maxBounds.z + tolerance )
+		{
+			LogError("point-cloud-test:  %s point %u (%f %f %f) is outside of the bounds (%f %f %f) to (%f %f %f)\n", name, n,
+				    pos.x, pos.y, pos.z, minBounds.x, minBounds.y, minBounds.z, maxBounds.x, maxBounds.y, maxBounds.z);
+			return false;
+		}
+	}
+
+	LogSuccess("point-cloud-test:  %s passed (%zu points to %u points)\n", name, points.size(), numPoints);
+	return true;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	const int width = cmdLine.GetInt("width", 320);
+	const int height = cmdLine.GetInt("height", 240);
+	const float voxelSize = cmdLine.GetFloat("voxel-size", 0.05f);
+	const uint32_t stride = cmdLine.GetUnsignedInt("stride", 7);
+	const std::string prefix = cmdLine.GetString("prefix", "point-cloud-test");
+	const bool keep = cmdLine.GetFlag("keep");
+
+	if( width <= 0 || height <= 0 || voxelSize <= 0.0f || stride == 0 )
+		return usage();
+
+
+	/*
+	 * create the point cloud
+	 */
+	cudaPointCloud* cloud = cudaPointCloud::Create();
+
+	float* depth = NULL;
+	float4* rgba = NULL;
+
+	if( !cloud || !createImages(&depth, &rgba, width, height) )
+	{
+		LogError("point-cloud-test:  failed to create point cloud\n");
+		return 1;
+	}
+
+	std::vector<Vertex> points;
+
+	if( !extractPoints(cloud, depth, rgba, width, height, &points) )
+		return 1;
+
+
+	/*
+	 * save and read back each format
+	 */
+	uint32_t numTests = 0;
+	uint32_t numFailed = 0;
+
+	#define RUN_TEST(x)  { numTests++; if( !(x) ) numFailed++; }
+
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::PCD_ASCII, false, prefix + ".ascii.pcd", keep));
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::PCD_BINARY, false, prefix + ".binary.pcd", keep));
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::PCD_BINARY_COMPRESSED, false, prefix + ".compressed.pcd", keep));
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::PLY_BINARY, false, prefix + ".ply", keep));
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::PCD_BINARY_COMPRESSED, true, prefix + ".async.pcd", keep));
+	RUN_TEST(testSave(cloud, points, cudaPointCloud::FILE_DEFAULT, true, prefix + ".async.ply", keep));
+
+
+	/*
+	 * downsample (re-extracting the points before each)
+	 */
+	RUN_TEST(extractPoints(cloud, depth, rgba, width, height, &points) && testStride(cloud, points, stride));
+	RUN_TEST(extractPoints(cloud, depth, rgba, width, height, &points) && testVoxel(cloud, points, voxelSize));
+
+	if( numFailed > 0 )
+		LogError("point-cloud-test:  %u of %u tests failed\n", numFailed, numTests);
+	else
+		LogSuccess("point-cloud-test:  all %u tests passed\n", numTests);
+
+	CUDA_FREE_HOST(depth);
+	CUDA_FREE_HOST(rgba);
+
+	delete cloud;
+
+	return (numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "cudaReduce.h"
+#include "cudaMappedMemory.h"
+
+#include "logging.h"
+#include "commandLine.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+
+int usage()
+{
+	printf("usage: reduce-test [--help] [--seed=N]\n\n");
+	printf("Check cudaReduceStats() and cudaHistogram() against a per-pixel loop on the CPU.\n");
+	printf("Random images of each format are tested at several sizes (including odd sizes and\n");
+	printf("a single pixel), both packed and with padded rows.  The padding is filled with\n");
+	printf("out-of-range values, so that reading it changes the results.  The min/max and\n");
+	printf("histogram bins must match exactly, and the mean to within rounding (returns 1 on\n");
+	printf("failure).\n\n");
+	printf("optional arguments:\n");
+	printf("  --seed=N          seed of the random images (default is 0)\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// random image in mapped memory, with `padding` extra bytes at the end of each row
+static void* randImage( const cudaImageView& view, size_t padding )
+{
+	void* image = NULL;
+
+	if( !cudaAllocMapped(&image, view.pitch * view.height) )
+	{
+		LogError("reduce-test:  failed to allocate %zux%zu %s image\n", view.width, view.height, imageFormatToStr(view.format));
+		return NULL;
+	}
+
+	const bool isFloat = (imageFormatBaseType(view.format) == IMAGE_FLOAT);
+
+	for( size_t y=0; y < view.height; y++ )
+	{
+		uint8_t* row = (uint8_t*)image + y * view.pitch;
+
+		if( isFloat )
+		{
+			// include values outside of [0,255] to check the clamping of the histogram
+			for( size_t n=0; n < view.RowSize() / sizeof(float); n++ )
+				((float*)row)[n] = (rand() % 32000) / 100.0f - 30.0f;
+
+			for( size_t n=0; n < padding / sizeof(float); n++ )
+				((float*)(row + view.RowSize()))[n] = (n % 2 == 0) ? 1.0e6f : -1.0e6f;
+		}
+		else
+		{
+			for( size_t n=0; n < view.RowSize(); n++ )
+				row[n] = rand() % 256;
+
+			// the padding can't be out of range for uint8, but it can skew the mean
+			memset(row + view.RowSize(), 255, padding);
+		}
+	}
+
+	return image;
+}
+
+
+// read channel c of pixel x in a row
+static float pixelValue( const uint8_t* row, size_t x, int c, int channels, bool isFloat )
+{
+	if( isFloat )
+		return ((const float*)row)[x * channels + c];
+
+	return row[x * channels + c];
+}
+
+
+// compare cudaReduceStats() against a per-pixel loop
+static bool testStats( const cudaImageView& view, const char* name )
+{
+	cudaImageStats* stats = NULL;
+
+	if( !cudaAllocMapped(&stats, sizeof(cudaImageStats)) )
+		return false;
+
+	if( CUDA_FAILED(cudaReduceStats(view, stats)) || CUDA_FAILED(cudaDeviceSynchronize()) )
+	{
+		LogError("reduce-test:  %s cudaReduceStats() failed\n", name);
+		CUDA_FREE_HOST(stats);
+		return false;
+	}
+
+	const int channels = imageFormatChannels(view.format);
+	const bool isFloat = (imageFormatBaseType(view.format) == IMAGE_FLOAT);
+
+	float vmin[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+	float vmax[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	double sum[4] = { 0, 0, 0, 0 };
+
+	for( size_t y=0; y < view.height; y++ )
+	{
+		const uint8_t* row = (const uint8_t*)view.ptr + y * view.pitch;
+
+		for( size_t x=0; x < view.width; x++ )
+		{
+			for( int c=0; c < channels; c++ )
+			{
+				const float value = pixelValue(row, x, c, channels, isFloat);
+
+				vmin[c] = fminf(vmin[c], value);
+				vmax[c] = fmaxf(vmax[c], value);
+				sum[c] += value;
+			}
+		}
+	}
+
+	const float* gpuMin = (const float*)&stats->min;
+	const float* gpuMax = (const float*)&stats->max;
+	const float* gpuMean = (const float*)&stats->mean;
+
+	bool result = true;
+
+	if( stats->count != view.width * view.height )
+	{
+		LogError("reduce-test:  %s count is %u (expected %zu)\n", name, stats->count, view.width * view.height);
+		result = false;
+	}
+
+	for( int c=0; c < channels; c++ )
+	{
+		const double mean = sum[c] / (view.width * view.height);
+
+		if( gpuMin[c] != vmin[c] || gpuMax[c] != vmax[c] )
+		{
+			LogError("reduce-test:  %s channel %i min/max is %g/%g (expected %g/%g)\n", name, c, gpuMin[c], gpuMax[c], vmin[c], vmax[c]);
+			result = false;
+		}
+
+		// the GPU sums each thread's pixels in single precision
+		if( fabs(gpuMean[c] - mean) > 1.0e-4 * fmax(fabs(mean), 1.0) )
+		{
+			LogError("reduce-test:  %s channel %i mean is %g (expected %g)\n", name, c, gpuMean[c], mean);
+			result = false;
+		}
+	}
+
+	if( result )
+		LogSuccess("reduce-test:  %s cudaReduceStats() passed\n", name);
+
+	CUDA_FREE_HOST(stats);
+	return result;
+}
+
+
+// compare cudaHistogram() against a per-pixel loop
+static bool testHistogram( const cudaImageView& view, uint32_t bins, const float2& range, const char* name )
+{
+	const int channels = imageFormatChannels(view.format);
+	const bool isFloat = (imageFormatBaseType(view.format) == IMAGE_FLOAT);
+
+	uint32_t* histogram = NULL;
+
+	if( !cudaAllocMapped(&histogram, bins * channels * sizeof(uint32_t)) )
+		return false;
+
+	if( CUDA_FAILED(cudaHistogram(view, histogram, bins, range)) || CUDA_FAILED(cudaDeviceSynchronize()) )
+	{
+		LogError("reduce-test:  %s cudaHistogram(%u bins) failed\n", name, bins);
+		CUDA_FREE_HOST(histogram);
+		return false;
+	}
+
+	uint32_t* reference = (uint32_t*)calloc(bins * channels, sizeof(uint32_t));
+
+	if( !reference )
+	{
+		CUDA_FREE_HOST(histogram);
+		return false;
+	}
+
+	// out-of-range values go to the first or last bin
+	const float scale = bins / (range.y - range.x);
+
+	for( size_t y=0; y < view.height; y++ )
+	{
+		const uint8_t* row = (const uint8_t*)view.ptr + y * view.pitch;
+
+		for( size_t x=0; x < view.width; x++ )
+		{
+			for( int c=0; c < channels; c++ )
+			{
+				int bin = (int)((pixelValue(row, x, c, channels, isFloat) - range.x) * scale);
+
+				if( bin < 0 )
+					bin = 0;
+				else if( bin >= (int)bins )
+					bin = bins - 1;
+
+				reference[c * bins + bin]++;
+			}
+		}
+	}
+
+	uint32_t numDiff = 0;
+
+	for( uint32_t n=0; n < bins * channels; n++ )
+	{
+		if( histogram[n] != reference[n] )
+		{
+			if( numDiff == 0 )
+				LogError("reduce-test:  %s channel %u bin %u is %u (expected %u)\n", name, n / bins, n % bins, histogram[n], reference[n]);
+
+			numDiff++;
+		}
+	}
+
+	if( numDiff > 0 )
+		LogError("reduce-test:  %s cudaHistogram(%u bins) differs in %u bins\n", name, bins, numDiff);
+	else
+		LogSuccess("reduce-test:  %s cudaHistogram(%u bins) passed\n", name, bins);
+
+	free(reference);
+	CUDA_FREE_HOST(histogram);
+
+	return (numDiff == 0);
+}
+
+
+// test one format and size, either packed or with padded rows
+static bool testImage( imageFormat format, size_t width, size_t height, size_t padding )
+{
+	char name[256];
+	sprintf(name, "%s %zux%zu (%s)", imageFormatToStr(format), width, height, (padding > 0) ? "padded" : "packed");
+
+	cudaImageView view(NULL, width, height, cudaImageView::PackedPitch(format, width) + padding, format);
+	view.ptr = randImage(view, padding);
+
+	if( !view.ptr )
+		return false;
+
+	const bool statsResult = testStats(view, name);
+	const bool histResult = testHistogram(view, 256, make_float2(0,255), name);
+	const bool rangeResult = testHistogram(view, 37, make_float2(10,200), name);
+
+	CUDA_FREE_HOST(view.ptr);
+
+	return statsResult && histResult && rangeResult;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	Log::ParseCmdLine(cmdLine);
+
+	srand(cmdLine.GetUnsignedInt("seed", 0));
+
+
+	/*
+	 * test each format and size, packed and padded
+	 */
+	const imageFormat formats[] = { IMAGE_GRAY8, IMAGE_GRAY32F, IMAGE_RGB8, IMAGE_BGRA8, IMAGE_RGB32F, IMAGE_RGBA32F };
+	const uint32_t numFormats = sizeof(formats) / sizeof(imageFormat);
+
+	const int2 sizes[] = { make_int2(1, 1), make_int2(17, 13), make_int2(333, 211), make_int2(640, 480), make_int2(1921, 1081) };
+	const uint32_t numSizes = sizeof(sizes) / sizeof(int2);
+
+	uint32_t numTests = 0;
+	uint32_t numFailed = 0;
+
+	#define RUN_TEST(x)  { numTests++; if( !(x) ) numFailed++; }
+
+	for( uint32_t f=0; f < numFormats; f++ )
+	{
+		for( uint32_t s=0; s < numSizes; s++ )
+		{
+			// keep the padding a multiple of 4 bytes, so the float rows stay aligned
+			RUN_TEST(testImage(formats[f], sizes[s].x, sizes[s].y, 0));
+			RUN_TEST(testImage(formats[f], sizes[s].x, sizes[s].y, 4 * (1 + rand() % 16)));
+		}
+	}
+
+	if( numFailed > 0 )
+		LogError("reduce-test:  %u of %u tests failed\n", numFailed, numTests);
+	else
+		LogSuccess("reduce-test:  all %u tests passed\n", numTests);
+
+	return (numFailed > 0) ? 1 : 0;
+}
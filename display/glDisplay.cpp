@@ -22,13 +22,19 @@
  
 #include "glDisplay.h"
 #include "cudaNormalize.h"
+#include "cudaColorspace.h"
+#include "cudaResize.h"
+#include "cudaMappedMemory.h"
 #include "timespec.h"
 
+#include <EGL/eglext.h>
+
 #include <X11/Xatom.h>
 #include <X11/cursorfont.h>
 
 #include <algorithm>
 #include <cstdlib>
+#include <strings.h>
 
 
 //--------------------------------------------------------------
@@ -52,6 +58,16 @@ const char* glDisplay::DEFAULT_TITLE = "NVIDIA Jetson";
 
 #define OriginalCursor XC_arrow
 
+
+// timestamps for frame pacing use the monotonic clock, which isn't affected by changes to the system time
+static inline uint64_t monotonicNano()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * uint64_t(1000000000) + (uint64_t)t.tv_nsec;
+}
+
+
 // Constructor
 glDisplay::glDisplay( const videoOptions& options ) : videoOutput(options)
 {
@@ -80,6 +96,51 @@ glDisplay::glDisplay( const videoOptions& options ) : videoOutput(options)
 	mNormalizedCUDA   = NULL;
 	mNormalizedWidth  = 0;
 	mNormalizedHeight = 0;
+	mShadersFailed    = false;
+	mMaxTextures      = 8;
+
+	mTileAtlas   = NULL;
+	mTileMapped  = NULL;
+	mTileStream  = 0;
+	mTileWidth   = 0;
+	mTileHeight  = 0;
+	mTileColumns = 0;
+	mTileRows    = 0;
+
+	mRenderThread       = NULL;
+	mRenderQuit         = false;
+	mFrameReady         = -1;
+	mFramePresenting    = -1;
+	mPresentMode        = PRESENT_DEFAULT;
+	mPresentModeChanged = false;
+	mFramesPresented    = 0;
+	mFramesDropped      = 0;
+	mPresentTime        = 0;
+	mPresentLatency     = 0.0f;
+
+	mOffscreen  = (options.resource.location == "offscreen");
+	mDisplayEGL = EGL_NO_DISPLAY;
+	mSurfaceEGL = EGL_NO_SURFACE;
+	mContextEGL = EGL_NO_CONTEXT;
+
+	mFramebufferTexture = 0;
+	mFramebufferDepth   = 0;
+	mFramebufferFlipped = 0;
+	mFramebufferWidth   = 0;
+	mFramebufferHeight  = 0;
+
+	mReadbackIndex = 0;
+	mReadbackFrame = NULL;
+	mReadbackSize  = 0;
+	mReadbackReady = false;
+	mReadbackCUDA  = false;
+	mReadbackHost  = false;
+
+	memset(mShaders, 0, sizeof(mShaders));
+	memset(mPlanes, 0, sizeof(mPlanes));
+	memset(mFrameSlots, 0, sizeof(mFrameSlots));
+	memset(mFramebuffers, 0, sizeof(mFramebuffers));
+	memset(mReadback, 0, sizeof(mReadback));
 
 	// initial input states
 	mMousePos[0]  = 0;
@@ -99,7 +160,7 @@ glDisplay::glDisplay( const videoOptions& options ) : videoOutput(options)
 	mOptions.deviceType = videoOptions::DEVICE_DISPLAY;
 	
 	// get the starting time for FPS counter
-	clock_gettime(CLOCK_REALTIME, &mLastTime);
+	clock_gettime(CLOCK_MONOTONIC, &mLastTime);
 	
 	// register default event handler
 	AddEventHandler(&onEvent, this);
@@ -109,6 +170,13 @@ glDisplay::glDisplay( const videoOptions& options ) : videoOutput(options)
 // Destructor
 glDisplay::~glDisplay()
 {
+	// take the GL context back from the render thread
+	if( IsThreaded() )
+	{
+		StopRenderThread();
+		makeCurrent();
+	}
+
 	// remove this instance from the global list
 	const size_t numDisplays = gDisplays.size();
 
@@ -125,6 +193,8 @@ glDisplay::~glDisplay()
 	RemoveAllWidgets();
 
 	// release textures used during rendering
+	freeTiles();
+
 	const size_t numTextures = mTextures.size();
 
 	for( size_t n=0; n < numTextures; n++ )
@@ -138,6 +208,12 @@ glDisplay::~glDisplay()
 
 	mTextures.clear();
 
+	for( uint32_t n=0; n < 3; n++ )
+		SAFE_DELETE(mPlanes[n]);
+
+	for( uint32_t n=0; n < SHADER_COUNT; n++ )
+		SAFE_DELETE(mShaders[n]);
+
 	// free CUDA memory used for normalization
 	if( mNormalizedCUDA != NULL )
 	{
@@ -145,8 +221,47 @@ glDisplay::~glDisplay()
 		mNormalizedCUDA = NULL;
 	}
 
+	// free the frames that were posted to the render thread
+	for( int n=0; n < NumFrameSlots; n++ )
+	{
+		if( mFrameSlots[n].ptr != NULL )
+			CUDA(cudaFree(mFrameSlots[n].ptr));
+
+		if( mFrameSlots[n].copied != NULL )
+			CUDA(cudaEventDestroy(mFrameSlots[n].copied));
+	}
+
+	// release the offscreen framebuffer
+	freeFramebuffer();
+
+	if( mReadbackFrame != NULL )
+	{
+		if( mReadbackHost )
+			free(mReadbackFrame);
+		else
+			CUDA(cudaFreeHost(mReadbackFrame));
+
+		mReadbackFrame = NULL;
+	}
+
 	// destroy the OpenGL context
-	glXDestroyContext(mDisplayX, mContextGL);
+	if( mOffscreen )
+	{
+		if( mDisplayEGL != EGL_NO_DISPLAY )
+		{
+			eglMakeCurrent(mDisplayEGL, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+			if( mContextEGL != EGL_NO_CONTEXT )
+				eglDestroyContext(mDisplayEGL, mContextEGL);
+
+			if( mSurfaceEGL != EGL_NO_SURFACE )
+				eglDestroySurface(mDisplayEGL, mSurfaceEGL);
+		}
+	}
+	else
+	{
+		glXDestroyContext(mDisplayX, mContextGL);
+	}
 }
 
 
@@ -187,22 +302,40 @@ glDisplay* glDisplay::Create( const videoOptions& options )
 	if( !vp )
 		return NULL;
 		
-	if( !vp->initWindow() )
+	if( vp->mOffscreen )
 	{
-		LogError(LOG_GL "failed to create X11 Window.\n");
-		delete vp;
-		return NULL;
+		if( !vp->initEGL() )
+		{
+			LogError(LOG_GL "failed to create offscreen EGL context.\n");
+			delete vp;
+			return NULL;
+		}
 	}
-	
-	if( !vp->initGL() )
+	else
 	{
-		LogError(LOG_GL "failed to initialize OpenGL.\n");
-		delete vp;
-		return NULL;
+		if( !vp->initWindow() )
+		{
+			LogError(LOG_GL "failed to create X11 Window.\n");
+			delete vp;
+			return NULL;
+		}
+		
+		if( !vp->initGL() )
+		{
+			LogError(LOG_GL "failed to initialize OpenGL.\n");
+			delete vp;
+			return NULL;
+		}
 	}
 	
 	GLenum err = glewInit();
 	
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	// GLEW 2.1 reports this for EGL contexts, after the GL entry points were loaded
+	if( vp->mOffscreen && err == GLEW_ERROR_NO_GLX_DISPLAY )
+		err = GLEW_OK;
+#endif
+
 	if (GLEW_OK != err)
 	{
 		LogError(LOG_GL "GLEW Error: %s\n", glewGetErrorString(err));
@@ -210,17 +343,45 @@ glDisplay* glDisplay::Create( const videoOptions& options )
 		return NULL;
 	}
 	
+	if( vp->mOffscreen && !vp->allocFramebuffer(vp->GetWidth(), vp->GetHeight()) )
+	{
+		LogError(LOG_GL "failed to allocate offscreen framebuffer.\n");
+		delete vp;
+		return NULL;
+	}
+
 	// release the GL context in case a different thread is used for rendering
-	GL(glXMakeCurrent(vp->mDisplayX, None, NULL));
+	vp->releaseCurrent();
 	
 	vp->mID = gDisplays.size();
 	gDisplays.push_back(vp);
 
-	LogInfo(LOG_GL "glDisplay -- display device initialized (%ux%u)\n", vp->GetWidth(), vp->GetHeight());
+	LogInfo(LOG_GL "glDisplay -- %s initialized (%ux%u)\n", vp->mOffscreen ? "offscreen display" : "display device", vp->GetWidth(), vp->GetHeight());
 	return vp;
 }
 
 
+// CreateOffscreen
+glDisplay* glDisplay::CreateOffscreen( uint32_t width, uint32_t height, videoOutput* output )
+{
+	videoOptions opt;
+
+	opt.resource = "display://offscreen";
+	opt.width    = width;
+	opt.height   = height;
+
+	glDisplay* display = Create(opt);
+
+	if( !display )
+		return NULL;
+
+	if( output != NULL )
+		display->AddOutput(output);
+
+	return display;
+}
+
+
 // Create
 /*glDisplay* glDisplay::Create( float r, float g, float b, float a )
 {
@@ -231,6 +392,9 @@ glDisplay* glDisplay::Create( const videoOptions& options )
 // initWindow
 bool glDisplay::initWindow()
 {
+	// Xlib can be used from both the application's thread and the render thread
+	XInitThreads();
+
 	if( !mDisplayX )
 		mDisplayX = XOpenDisplay(0);
 
@@ -363,9 +527,388 @@ bool glDisplay::initGL()
 }
 
 
+// initEGL
+bool glDisplay::initEGL()
+{
+	if( mOptions.width == 0 )
+		mOptions.width = 1280;
+
+	if( mOptions.height == 0 )
+		mOptions.height = 720;
+
+	// use the default display if there is one, otherwise try a platform that doesn't need a window system
+	EGLint versionMajor = 0;
+	EGLint versionMinor = 0;
+
+	mDisplayEGL = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if( mDisplayEGL == EGL_NO_DISPLAY || !eglInitialize(mDisplayEGL, &versionMajor, &versionMinor) )
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+		mDisplayEGL = EGL_NO_DISPLAY;
+
+		if( getPlatformDisplay != NULL )
+		{
+		#ifdef EGL_PLATFORM_SURFACELESS_MESA
+			mDisplayEGL = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+			if( mDisplayEGL != EGL_NO_DISPLAY && !eglInitialize(mDisplayEGL, &versionMajor, &versionMinor) )
+				mDisplayEGL = EGL_NO_DISPLAY;
+		#endif
+
+			PFNEGLQUERYDEVICESEXTPROC queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+
+			if( mDisplayEGL == EGL_NO_DISPLAY && queryDevices != NULL )
+			{
+				EGLDeviceEXT device = NULL;
+				EGLint numDevices = 0;
+
+				if( queryDevices(1, &device, &numDevices) && numDevices > 0 )
+				{
+					mDisplayEGL = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, NULL);
+
+					if( mDisplayEGL != EGL_NO_DISPLAY && !eglInitialize(mDisplayEGL, &versionMajor, &versionMinor) )
+						mDisplayEGL = EGL_NO_DISPLAY;
+				}
+			}
+		}
+
+		if( mDisplayEGL == EGL_NO_DISPLAY )
+		{
+			LogError(LOG_GL "glDisplay -- failed to initialize EGL display (error=0x%x)\n", eglGetError());
+			return false;
+		}
+	}
+
+	LogVerbose(LOG_GL "glDisplay -- EGL %i.%i (%s)\n", versionMajor, versionMinor, eglQueryString(mDisplayEGL, EGL_VENDOR));
+
+	if( !eglBindAPI(EGL_OPENGL_API) )
+	{
+		LogError(LOG_GL "glDisplay -- EGL doesn't support desktop OpenGL (error=0x%x)\n", eglGetError());
+		return false;
+	}
+
+	// the frame gets rendered to an FBO, so a pbuffer is only needed if surfaceless contexts aren't supported
+	EGLint configAttribs[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config = NULL;
+	EGLint numConfigs = 0;
+
+	if( !eglChooseConfig(mDisplayEGL, configAttribs, &config, 1, &numConfigs) || numConfigs == 0 )
+	{
+		configAttribs[1] = 0;	// any surface type (surfaceless)
+
+		if( !eglChooseConfig(mDisplayEGL, configAttribs, &config, 1, &numConfigs) || numConfigs == 0 )
+		{
+			LogError(LOG_GL "glDisplay -- failed to find an EGL config for OpenGL\n");
+			return false;
+		}
+	}
+
+	mContextEGL = eglCreateContext(mDisplayEGL, config, EGL_NO_CONTEXT, NULL);
+
+	if( mContextEGL == EGL_NO_CONTEXT )
+	{
+		LogError(LOG_GL "glDisplay -- failed to create EGL context (error=0x%x)\n", eglGetError());
+		return false;
+	}
+
+	const char* extensions = eglQueryString(mDisplayEGL, EGL_EXTENSIONS);
+
+	if( !extensions || strstr(extensions, "EGL_KHR_surfaceless_context") == NULL )
+	{
+		const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+
+		mSurfaceEGL = eglCreatePbufferSurface(mDisplayEGL, config, pbufferAttribs);
+
+		if( mSurfaceEGL == EGL_NO_SURFACE )
+		{
+			LogError(LOG_GL "glDisplay -- failed to create EGL pbuffer surface (error=0x%x)\n", eglGetError());
+			return false;
+		}
+	}
+
+	if( !eglMakeCurrent(mDisplayEGL, mSurfaceEGL, mSurfaceEGL, mContextEGL) )
+	{
+		LogError(LOG_GL "glDisplay -- failed to make EGL context current (error=0x%x)\n", eglGetError());
+		return false;
+	}
+
+	const char* vendor = (const char*)glGetString(GL_VENDOR);
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+	LogInfo(LOG_GL "glDisplay -- offscreen OpenGL renderer:  %s (%s)\n", renderer, vendor);
+
+	// without a GPU, the frames are read back into regular memory
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mReadbackHost = true;
+	}
+
+	// CUDA interop is only possible when OpenGL is on the same GPU
+	mReadbackCUDA = !mReadbackHost && vendor != NULL && strstr(vendor, "NVIDIA") != NULL;
+
+	GLint maxSize = 0;
+	GL(glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize));
+
+	mScreenWidth  = maxSize;
+	mScreenHeight = maxSize;
+
+	mViewport[0] = 0;
+	mViewport[1] = 0;
+	mViewport[2] = mOptions.width;
+	mViewport[3] = mOptions.height;
+
+	GL(glEnable(GL_LINE_SMOOTH));
+	GL(glHint(GL_LINE_SMOOTH_HINT, GL_NICEST));
+
+	mStreaming = true;
+	return true;
+}
+
+
+// makeCurrent
+void glDisplay::makeCurrent()
+{
+	if( mOffscreen )
+		eglMakeCurrent(mDisplayEGL, mSurfaceEGL, mSurfaceEGL, mContextEGL);
+	else
+		GL(glXMakeCurrent(mDisplayX, mWindowX, mContextGL));
+}
+
+
+// releaseCurrent
+void glDisplay::releaseCurrent()
+{
+	if( mOffscreen )
+		eglMakeCurrent(mDisplayEGL, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	else
+		GL(glXMakeCurrent(mDisplayX, None, NULL));
+}
+
+
+// allocFramebuffer
+bool glDisplay::allocFramebuffer( uint32_t width, uint32_t height )
+{
+	if( mFramebuffers[0] != 0 && mFramebufferWidth == width && mFramebufferHeight == height )
+		return true;
+
+	freeFramebuffer();
+
+	// the frame is rendered into a texture (with depth/stencil for widgets and glCamera)
+	GL_VERIFY(glGenTextures(1, &mFramebufferTexture));
+	GL_VERIFY(glBindTexture(GL_TEXTURE_2D, mFramebufferTexture));
+	GL_VERIFY(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+	GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL(glBindTexture(GL_TEXTURE_2D, 0));
+
+	GL_VERIFY(glGenRenderbuffers(1, &mFramebufferDepth));
+	GL_VERIFY(glBindRenderbuffer(GL_RENDERBUFFER, mFramebufferDepth));
+	GL_VERIFY(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+
+	// OpenGL's rows are bottom-up, so it gets flipped into a second framebuffer that's read back
+	GL_VERIFY(glGenRenderbuffers(1, &mFramebufferFlipped));
+	GL_VERIFY(glBindRenderbuffer(GL_RENDERBUFFER, mFramebufferFlipped));
+	GL_VERIFY(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+	GL(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+	GL_VERIFY(glGenFramebuffers(2, mFramebuffers));
+
+	GL_VERIFY(glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffers[1]));
+	GL_VERIFY(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mFramebufferFlipped));
+
+	GL_VERIFY(glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffers[0]));
+	GL_VERIFY(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mFramebufferTexture, 0));
+	GL_VERIFY(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mFramebufferDepth));
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	if( status != GL_FRAMEBUFFER_COMPLETE )
+	{
+		LogError(LOG_GL "glDisplay -- offscreen framebuffer is incomplete (status=0x%x)\n", status);
+		return false;
+	}
+
+	// allocate the pixel buffers that frames are read back into asynchronously
+	const size_t size = width * height * 4;
+
+	for( int n=0; n < NumReadbackBuffers; n++ )
+	{
+		mReadback[n].pbo = glBuffer::Create(GL_PIXEL_PACK_BUFFER, size, NULL, mReadbackCUDA ? GL_DYNAMIC_DRAW : GL_STREAM_READ);
+		mReadback[n].pending = false;
+
+		if( !mReadback[n].pbo )
+			return false;
+	}
+
+	if( mReadbackSize < size )
+	{
+		if( mReadbackFrame != NULL )
+		{
+			if( mReadbackHost )
+				free(mReadbackFrame);
+			else
+				CUDA(cudaFreeHost(mReadbackFrame));
+		}
+
+		mReadbackFrame = NULL;
+		mReadbackSize  = 0;
+
+		if( mReadbackHost )
+			mReadbackFrame = malloc(size);
+		else if( !cudaAllocMapped(&mReadbackFrame, size, false) )
+			mReadbackFrame = NULL;
+
+		if( !mReadbackFrame )
+		{
+			LogError(LOG_GL "glDisplay -- failed to allocate %zu bytes for offscreen readback\n", size);
+			return false;
+		}
+
+		mReadbackSize = size;
+	}
+
+	mFramebufferWidth  = width;
+	mFramebufferHeight = height;
+	mReadbackIndex     = 0;
+	mReadbackReady     = false;
+
+	LogVerbose(LOG_GL "glDisplay -- allocated %ux%u offscreen framebuffer\n", width, height);
+	return true;
+}
+
+
+// freeFramebuffer
+void glDisplay::freeFramebuffer()
+{
+	for( int n=0; n < NumReadbackBuffers; n++ )
+	{
+		SAFE_DELETE(mReadback[n].pbo);
+		mReadback[n].pending = false;
+	}
+
+	if( mFramebuffers[0] != 0 )
+	{
+		GL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		GL(glDeleteFramebuffers(2, mFramebuffers));
+
+		mFramebuffers[0] = 0;
+		mFramebuffers[1] = 0;
+	}
+
+	if( mFramebufferTexture != 0 )
+	{
+		GL(glDeleteTextures(1, &mFramebufferTexture));
+		mFramebufferTexture = 0;
+	}
+
+	if( mFramebufferDepth != 0 )
+	{
+		GL(glDeleteRenderbuffers(1, &mFramebufferDepth));
+		mFramebufferDepth = 0;
+	}
+
+	if( mFramebufferFlipped != 0 )
+	{
+		GL(glDeleteRenderbuffers(1, &mFramebufferFlipped));
+		mFramebufferFlipped = 0;
+	}
+
+	mFramebufferWidth  = 0;
+	mFramebufferHeight = 0;
+}
+
+
+// readFramebuffer
+bool glDisplay::readFramebuffer()
+{
+	const uint32_t width  = mFramebufferWidth;
+	const uint32_t height = mFramebufferHeight;
+	const size_t   size   = width * height * 4;
+
+	// flip the frame vertically, so that it's top-down like the other videoOutput's expect
+	GL_VERIFY(glBindFramebuffer(GL_READ_FRAMEBUFFER, mFramebuffers[0]));
+	GL_VERIFY(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFramebuffers[1]));
+	GL_VERIFY(glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+
+	// start reading the frame into a PBO, which returns without waiting for the transfer
+	ReadbackBuffer& next = mReadback[mReadbackIndex];
+
+	GL_VERIFY(glBindFramebuffer(GL_READ_FRAMEBUFFER, mFramebuffers[1]));
+
+	if( !next.pbo->Bind() )
+		return false;
+
+	GL(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+
+	next.pbo->Unbind();
+	next.pending = true;
+
+	GL(glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffers[0]));
+
+	mReadbackIndex = (mReadbackIndex + 1) % NumReadbackBuffers;
+
+	// the other PBO has the previous frame, which has had a whole frame to finish transferring
+	ReadbackBuffer& prev = mReadback[mReadbackIndex];
+
+	if( !prev.pending )
+		return false;
+
+	prev.pending = false;
+
+	if( mReadbackCUDA )
+	{
+		void* ptr = prev.pbo->Map(GL_MAP_CUDA, GL_READ_ONLY);
+
+		if( !ptr )
+			return false;
+
+		const bool result = CUDA_SUCCESS(cudaMemcpy(mReadbackFrame, ptr, size, cudaMemcpyDeviceToDevice));
+		prev.pbo->Unmap();
+
+		if( !result )
+			return false;
+	}
+	else
+	{
+		void* ptr = prev.pbo->Map(GL_MAP_CPU, GL_READ_ONLY);
+
+		if( !ptr )
+			return false;
+
+		memcpy(mReadbackFrame, ptr, size);
+		prev.pbo->Unmap();
+	}
+
+	mReadbackReady = true;
+	return true;
+}
+
+
 // Open
 bool glDisplay::Open()
 {
+	if( mOffscreen )
+	{
+		mStreaming = true;
+		return true;
+	}
+
 	if( mStreaming && mInitialShow )
 		return true;
 
@@ -382,6 +925,9 @@ bool glDisplay::Open()
 // SetTitle
 void glDisplay::SetTitle( const char* str )
 {
+	if( mOffscreen )
+		return;
+
 	XStoreName(mDisplayX, mWindowX, str);
 }
 
@@ -444,7 +990,19 @@ void glDisplay::BeginRender( bool processEvents )
 
 	mRendering = true;
 
-	GL(glXMakeCurrent(mDisplayX, mWindowX, mContextGL));
+	makeCurrent();
+
+	if( mOffscreen )
+	{
+		// render into the offscreen framebuffer (reallocated if the size changed)
+		if( !allocFramebuffer(GetWidth(), GetHeight()) )
+			LogError(LOG_GL "glDisplay -- failed to allocate %ux%u offscreen framebuffer\n", GetWidth(), GetHeight());
+
+		GL(glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffers[0]));
+	}
+
+	if( mPresentModeChanged )
+		applyPresentMode();
 
 	GL(glClearColor(mBgColor[0], mBgColor[1], mBgColor[2], mBgColor[3]));
 	GL(glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT));
@@ -472,12 +1030,24 @@ void glDisplay::EndRender()
 			RenderOutline(x, y, width, height, 1, 1, 1);
 	}
 
-	// present the backbuffer
-	glXSwapBuffers(mDisplayX, mWindowX);
+	// present the backbuffer, or read back the offscreen frame
+	bool readback = false;
+
+	if( mOffscreen )
+		readback = readFramebuffer();
+	else
+		glXSwapBuffers(mDisplayX, mWindowX);
+
+	// on the render thread, wait for the swap so the present timestamp is accurate
+	if( IsThreaded() )
+		GL(glFinish());
+
+	mPresentTime = monotonicNano();
+	mFramesPresented++;
 
 	// measure framerate
 	timespec currTime;
-	clock_gettime(CLOCK_REALTIME, &currTime);
+	clock_gettime(CLOCK_MONOTONIC, &currTime);
 
 	const timespec diffTime = timeDiff(mLastTime, currTime);
 	const float ns = 1000000000 * diffTime.tv_sec + diffTime.tv_nsec;
@@ -487,129 +1057,686 @@ void glDisplay::EndRender()
 	mRendering = false;
 
 	mOptions.frameRate = GetFPS();
+
+	// pass the rendered frame from the offscreen display to the sub-streams
+	if( readback )
+		videoOutput::Render(mReadbackFrame, mFramebufferWidth, mFramebufferHeight, IMAGE_RGBA8, 0);
+}
+
+
+// allocTexture
+glTexture* glDisplay::allocTexture( uint32_t width, uint32_t height, imageFormat format )
+{
+	if( width == 0 || height == 0 )
+		return NULL;
+
+	// convert imageFormat to GL format
+	uint32_t glFormat = 0;
+
+	if( format == IMAGE_RGB8 )
+		glFormat = GL_RGB8;
+	else if( format == IMAGE_RGBA8 )
+		glFormat = GL_RGBA8;
+	else if( format == IMAGE_RGB32F )
+		glFormat = GL_RGB32F_ARB;
+	else if( format == IMAGE_RGBA32F )
+		glFormat = GL_RGBA32F_ARB;
+	else
+	{
+		LogError(LOG_GL "glDisplay::Render() -- unsupported image format (%s)\n", imageFormatToStr(format));
+		LogError(LOG_GL "                       supported formats are:\n");
+		LogError(LOG_GL "                           * rgb8\n");		
+		LogError(LOG_GL "                           * rgba8\n");		
+		LogError(LOG_GL "                           * rgb32\n");		
+		LogError(LOG_GL "                           * rgba32\n");
+
+		return NULL;
+	}
+		
+	// check to see if a compatible texture has already been allocated
+	const size_t numTextures = mTextures.size();
+
+	for( size_t n=0; n < numTextures; n++ )
+	{
+		glTexture* tex = mTextures[n];
+
+		if( tex->GetWidth() == width && tex->GetHeight() == height && tex->GetFormat() == glFormat )
+		{
+			// move it to the front of the list as the most recently used
+			if( n > 0 )
+			{
+				mTextures.erase(mTextures.begin() + n);
+				mTextures.insert(mTextures.begin(), tex);
+			}
+
+			return tex;
+		}
+	}
+
+	// free the least recently used textures to make room
+	while( mTextures.size() > 0 && mTextures.size() >= mMaxTextures )
+	{
+		glTexture* lru = mTextures.back();
+
+		LogVerbose(LOG_GL "glDisplay -- freeing least recently used %ux%u texture\n", lru->GetWidth(), lru->GetHeight());
+
+		delete lru;
+		mTextures.pop_back();
+	}
+
+	glTexture* tex = glTexture::Create(width, height, glFormat);
+
+	if( !tex )
+	{
+		LogError(LOG_GL "glDisplay.Render() failed to create OpenGL interop texture\n");
+		return NULL;
+	}
+
+	mTextures.insert(mTextures.begin(), tex);
+	return tex;
+}
+
+
+// Render
+void glDisplay::Render( glTexture* texture, float x, float y )
+{
+	if( !texture )
+		return;
+
+	texture->Render(x,y);
+}
+
+
+// allocPlane
+glTexture* glDisplay::allocPlane( uint32_t plane, uint32_t width, uint32_t height, uint32_t glFormat )
+{
+	glTexture* tex = mPlanes[plane];
+
+	if( tex != NULL && tex->GetWidth() == width && tex->GetHeight() == height && tex->GetFormat() == glFormat )
+		return tex;
+
+	SAFE_DELETE(mPlanes[plane]);
+
+	tex = glTexture::Create(width, height, glFormat);
+
+	if( !tex )
+	{
+		LogError(LOG_GL "glDisplay.Render() failed to create OpenGL texture for plane %u\n", plane);
+		return NULL;
+	}
+
+	mPlanes[plane] = tex;
+	return tex;
+}
+
+
+// allocNormalized
+bool glDisplay::allocNormalized( uint32_t width, uint32_t height )
+{
+	if( mNormalizedCUDA != NULL && mNormalizedWidth >= width && mNormalizedHeight >= height )
+		return true;
+
+	if( mNormalizedCUDA != NULL )
+	{
+		CUDA(cudaFree(mNormalizedCUDA));
+		mNormalizedCUDA = NULL;
+	}
+
+	if( CUDA_FAILED(cudaMalloc(&mNormalizedCUDA, width * height * sizeof(float) * 4)) )	// just allocate this as float4 for simplicity
+	{
+		LogError(LOG_GL "glDisplay.Render() failed to allocate CUDA memory for normalization\n");
+		return false;
+	}
+
+	mNormalizedWidth = width;
+	mNormalizedHeight = height;
+
+	return true;
+}
+
+
+// vertex shader shared by the programs below
+static const char* gVertexShader =
+	"void main()\n"
+	"{\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+// full-range BT.601, matching the CUDA colorspace conversions
+#define GLSL_YUV_TO_RGB 													\
+	"vec4 yuv2rgb( float y, float u, float v )\n"								\
+	"{\n"																\
+	"	u -= 0.5;\n"														\
+	"	v -= 0.5;\n"														\
+	"	return vec4(clamp(vec3(y + 1.402 * v, y - 0.344 * u - 0.714 * v, y + 1.772 * u), 0.0, 1.0), 1.0);\n"	\
+	"}\n"
+
+static const char* gFragmentShaders[] = {
+
+	// SHADER_NV12
+	"uniform sampler2D planeY;\n"
+	"uniform sampler2D planeUV;\n"
+	GLSL_YUV_TO_RGB
+	"void main()\n"
+	"{\n"
+	"	vec2 uv = gl_TexCoord[0].xy;\n"
+	"	vec2 chroma = texture2D(planeUV, uv).ra;\n"
+	"	gl_FragColor = yuv2rgb(texture2D(planeY, uv).r, chroma.x, chroma.y);\n"
+	"}\n",
+
+	// SHADER_PLANAR
+	"uniform sampler2D planeY;\n"
+	"uniform sampler2D planeU;\n"
+	"uniform sampler2D planeV;\n"
+	GLSL_YUV_TO_RGB
+	"void main()\n"
+	"{\n"
+	"	vec2 uv = gl_TexCoord[0].xy;\n"
+	"	gl_FragColor = yuv2rgb(texture2D(planeY, uv).r, texture2D(planeU, uv).r, texture2D(planeV, uv).r);\n"
+	"}\n",
+
+	// SHADER_PACKED (the masks pick the Y0, Y1, U, V bytes out of each texel)
+	"uniform sampler2D planeYUV;\n"
+	"uniform float width;\n"
+	"uniform vec4 maskY0;\n"
+	"uniform vec4 maskY1;\n"
+	"uniform vec4 maskU;\n"
+	"uniform vec4 maskV;\n"
+	GLSL_YUV_TO_RGB
+	"void main()\n"
+	"{\n"
+	"	vec2 uv = gl_TexCoord[0].xy;\n"
+	"	vec4 texel = texture2D(planeYUV, uv);\n"
+	"	float odd = step(0.5, fract(uv.x * width * 0.5));\n"
+	"	float y = mix(dot(texel, maskY0), dot(texel, maskY1), odd);\n"
+	"	gl_FragColor = yuv2rgb(y, dot(texel, maskU), dot(texel, maskV));\n"
+	"}\n",
+
+	// SHADER_NORMALIZE
+	"uniform sampler2D image;\n"
+	"uniform vec4 scale;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = texture2D(image, gl_TexCoord[0].xy) * scale;\n"
+	"}\n"
+};
+
+
+// initShaders
+bool glDisplay::initShaders()
+{
+	if( mShaders[0] != NULL )
+		return true;
+
+	if( mShadersFailed )
+		return false;
+
+	// only try once, and use CUDA for the conversions if the shaders aren't supported
+	mShadersFailed = true;
+
+	if( !glShader::IsSupported() )
+	{
+		LogWarning(LOG_GL "glDisplay -- GLSL shaders aren't supported, using CUDA for YUV conversion\n");
+		return false;
+	}
+
+	for( uint32_t n=0; n < SHADER_COUNT; n++ )
+	{
+		mShaders[n] = glShader::Create(gVertexShader, gFragmentShaders[n]);
+
+		if( !mShaders[n] )
+		{
+			LogWarning(LOG_GL "glDisplay -- failed to compile shaders, using CUDA for YUV conversion\n");
+
+			for( uint32_t i=0; i < SHADER_COUNT; i++ )
+				SAFE_DELETE(mShaders[i]);
+
+			return false;
+		}
+	}
+
+	// assign the samplers to texture units
+	const char* samplers[SHADER_COUNT][3] = { {"planeY", "planeUV", NULL},
+									  {"planeY", "planeU", "planeV"},
+									  {"planeYUV", NULL, NULL},
+									  {"image", NULL, NULL} };
+
+	for( uint32_t n=0; n < SHADER_COUNT; n++ )
+	{
+		mShaders[n]->Bind();
+
+		for( uint32_t i=0; i < 3 && samplers[n][i] != NULL; i++ )
+			mShaders[n]->SetUniform(samplers[n][i], (int)i);
+
+		mShaders[n]->Unbind();
+	}
+
+	LogVerbose(LOG_GL "glDisplay -- using GLSL shaders for YUV conversion and normalization\n");
+
+	mShadersFailed = false;
+	return true;
+}
+
+
+// uploadTexture
+bool glDisplay::uploadTexture( glTexture* texture, void* image, cudaStream_t stream )
+{
+	// map from CUDA to openGL using GL interop
+	void* tex_map = texture->Map(GL_MAP_CUDA, GL_WRITE_DISCARD, stream);
+
+	if( !tex_map )
+		return false;
+
+	const bool result = CUDA_SUCCESS(cudaMemcpyAsync(tex_map, image, texture->GetSize(), cudaMemcpyDeviceToDevice, stream));
+
+	texture->Unmap(stream);
+	return result;
+}
+
+
+// renderShader
+bool glDisplay::renderShader( void* img, uint32_t width, uint32_t height, imageFormat format, float x, float y, bool normalize, cudaStream_t stream )
+{
+	glShader*  shader = NULL;
+	glTexture* planes[3] = {NULL, NULL, NULL};
+	size_t     offsets[3] = {0, 0, 0};
+	uint32_t   numPlanes = 1;
+
+	// chroma is subsampled by 2, so odd sizes are left to CUDA
+	const uint32_t chromaWidth  = width / 2;
+	const uint32_t chromaHeight = height / 2;
+	const size_t   lumaSize     = width * height;
+
+	if( format == IMAGE_NV12 )
+	{
+		if( width % 2 != 0 || height % 2 != 0 )
+			return false;
+
+		shader    = mShaders[SHADER_NV12];
+		planes[0] = allocPlane(0, width, height, GL_LUMINANCE8);
+		planes[1] = allocPlane(1, chromaWidth, chromaHeight, GL_LUMINANCE8_ALPHA8);
+		offsets[1] = lumaSize;
+		numPlanes = 2;
+	}
+	else if( format == IMAGE_I420 || format == IMAGE_YV12 )
+	{
+		if( width % 2 != 0 || height % 2 != 0 )
+			return false;
+
+		const size_t chromaSize = chromaWidth * chromaHeight;
+
+		shader    = mShaders[SHADER_PLANAR];
+		planes[0] = allocPlane(0, width, height, GL_LUMINANCE8);
+		planes[1] = allocPlane(1, chromaWidth, chromaHeight, GL_LUMINANCE8);
+		planes[2] = allocPlane(2, chromaWidth, chromaHeight, GL_LUMINANCE8);
+		numPlanes = 3;
+
+		// YV12 stores the V plane before the U plane
+		offsets[1] = (format == IMAGE_I420) ? lumaSize : lumaSize + chromaSize;
+		offsets[2] = (format == IMAGE_I420) ? lumaSize + chromaSize : lumaSize;
+	}
+	else if( format == IMAGE_YUYV || format == IMAGE_YVYU || format == IMAGE_UYVY )
+	{
+		if( width % 2 != 0 )
+			return false;
+
+		shader    = mShaders[SHADER_PACKED];
+		planes[0] = allocPlane(0, chromaWidth, height, GL_RGBA8);
+
+		if( !planes[0] )
+			return false;
+
+		// the shader picks between the two pixels of a texel itself, so filtering would mix them
+		planes[0]->Bind();
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+		GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		planes[0]->Unbind();
+	}
+	else if( (format == IMAGE_RGB32F || format == IMAGE_RGBA32F) && normalize )
+	{
+		shader    = mShaders[SHADER_NORMALIZE];
+		planes[0] = allocTexture(width, height, format);
+	}
+	else
+	{
+		return false;	// other YUV formats (NV16, P010, ect) are converted with CUDA
+	}
+
+	// upload each plane straight from the frame
+	for( uint32_t n=0; n < numPlanes; n++ )
+	{
+		if( !planes[n] || !uploadTexture(planes[n], (uint8_t*)img + offsets[n], stream) )
+			return false;
+	}
+
+	if( !shader->Bind() )
+		return false;
+
+	if( format == IMAGE_YUYV )
+	{
+		shader->SetUniform("maskY0", 1.0f, 0.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskU",  0.0f, 1.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskY1", 0.0f, 0.0f, 1.0f, 0.0f);
+		shader->SetUniform("maskV",  0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else if( format == IMAGE_YVYU )
+	{
+		shader->SetUniform("maskY0", 1.0f, 0.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskV",  0.0f, 1.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskY1", 0.0f, 0.0f, 1.0f, 0.0f);
+		shader->SetUniform("maskU",  0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else if( format == IMAGE_UYVY )
+	{
+		shader->SetUniform("maskU",  1.0f, 0.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskY0", 0.0f, 1.0f, 0.0f, 0.0f);
+		shader->SetUniform("maskV",  0.0f, 0.0f, 1.0f, 0.0f);
+		shader->SetUniform("maskY1", 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else if( shader == mShaders[SHADER_NORMALIZE] )
+	{
+		// rescale pixel intensities from [0,255] -> [0,1] (RGB textures already have alpha=1)
+		const float scale = 1.0f / 255.0f;
+		shader->SetUniform("scale", scale, scale, scale, (format == IMAGE_RGBA32F) ? scale : 1.0f);
+	}
+
+	if( shader == mShaders[SHADER_PACKED] )
+		shader->SetUniform("width", (float)width);
+
+	// bind the chroma planes to the other texture units (plane 0 is bound by glTexture::Render)
+	for( uint32_t n=1; n < numPlanes; n++ )
+	{
+		GL(glActiveTextureARB(GL_TEXTURE0_ARB + n));
+		GL(glBindTexture(GL_TEXTURE_2D, planes[n]->GetID()));
+	}
+
+	GL(glActiveTextureARB(GL_TEXTURE0_ARB));
+
+	// draw the quad at the size of the image (the packed texture is half as wide)
+	planes[0]->Render(x, y, width, height);
+
+	for( uint32_t n=1; n < numPlanes; n++ )
+	{
+		GL(glActiveTextureARB(GL_TEXTURE0_ARB + n));
+		GL(glBindTexture(GL_TEXTURE_2D, 0));
+	}
+
+	GL(glActiveTextureARB(GL_TEXTURE0_ARB));
+	shader->Unbind();
+
+	return true;
+}
+
+
+// RenderImage
+void glDisplay::RenderImage( void* img, uint32_t width, uint32_t height, imageFormat format, float x, float y, bool normalize, cudaStream_t stream )
+{
+	if( !img || width == 0 || height == 0 )
+		return;
+	
+	// YUV conversion and normalization are done in a shader when possible
+	const bool isFloat = (format == IMAGE_RGB32F || format == IMAGE_RGBA32F);
+
+	if( imageFormatIsYUV(format) || (isFloat && normalize) )
+	{
+		if( initShaders() && renderShader(img, width, height, format, x, y, normalize, stream) )
+			return;
+	}
+
+	// otherwise convert YUV to RGBA with CUDA first
+	if( imageFormatIsYUV(format) )
+	{
+		if( !allocNormalized(width, height) )
+			return;
+
+		if( CUDA_FAILED(cudaConvertColor(img, format, mNormalizedCUDA, IMAGE_RGBA8, width, height, stream)) )
+		{
+			LogError(LOG_GL "glDisplay.Render() failed to convert %s image to rgba8\n", imageFormatToStr(format));
+			return;
+		}
+
+		img = mNormalizedCUDA;
+		format = IMAGE_RGBA8;
+	}
+
+	// obtain the OpenGL texture to use
+	glTexture* interopTex = allocTexture(width, height, format);
+
+	if( !interopTex )
+		return;
+	
+	// normalize pixels from [0,255] -> [0,1]
+	if( normalize && isFloat )
+	{
+		if( !allocNormalized(width, height) )
+			return;
+
+		// rescale image pixel intensities for display
+		if( CUDA_FAILED(cudaNormalize(img, make_float2(0.0f, 255.0f), 
+							  mNormalizedCUDA, make_float2(0.0f, 1.0f), 
+	 						  width, height, format, stream)) )
+		{
+			LogError(LOG_GL "glDisplay.Render() failed to normalize image\n");
+			return;
+		}
+
+		img = mNormalizedCUDA;
+	}
+
+	// map from CUDA to openGL using GL interop
+	uploadTexture(interopTex, img, stream);
+
+	// draw the texture
+	interopTex->Render(x,y);
+}
+
+
+// SetTileLayout
+bool glDisplay::SetTileLayout( uint32_t numTiles, uint32_t tileWidth, uint32_t tileHeight )
+{
+	if( numTiles == 0 || tileWidth == 0 || tileHeight == 0 )
+	{
+		LogError(LOG_GL "glDisplay::SetTileLayout() -- invalid layout (%u tiles of %ux%u)\n", numTiles, tileWidth, tileHeight);
+		return false;
+	}
+
+	freeTiles();
+
+	// arrange the tiles in a square-ish grid
+	const uint32_t columns = (uint32_t)ceilf(sqrtf((float)numTiles));
+	const uint32_t rows    = (numTiles + columns - 1) / columns;
+
+	GLint maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	if( maxSize > 0 && (columns * tileWidth > (uint32_t)maxSize || rows * tileHeight > (uint32_t)maxSize) )
+	{
+		LogError(LOG_GL "glDisplay::SetTileLayout() -- %ux%u tile atlas is larger than the maximum texture size (%i)\n", columns * tileWidth, rows * tileHeight, maxSize);
+		return false;
+	}
+
+	mTileWidth   = tileWidth;
+	mTileHeight  = tileHeight;
+	mTileColumns = columns;
+	mTileRows    = rows;
+
+	mTileRects.assign(numTiles, make_int4(0,0,0,0));
+
+	LogVerbose(LOG_GL "glDisplay -- tiled layout of %u streams (%ux%u grid, %ux%u atlas)\n", numTiles, columns, rows, columns * tileWidth, rows * tileHeight);
+	return true;
+}
+
+
+// freeTiles
+void glDisplay::freeTiles()
+{
+	if( mTileMapped != NULL )
+	{
+		mTileAtlas->Unmap(mTileStream);
+		mTileMapped = NULL;
+	}
+
+	SAFE_DELETE(mTileAtlas);
+
+	mTileRects.clear();
+	mTileUpdates.clear();
 }
 
 
-// allocTexture
-glTexture* glDisplay::allocTexture( uint32_t width, uint32_t height, imageFormat format )
+// RenderTile
+bool glDisplay::RenderTile( uint32_t tile, void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
 {
-	if( width == 0 || height == 0 )
-		return NULL;
+	if( !image || width == 0 || height == 0 )
+		return false;
 
-	// convert imageFormat to GL format
-	uint32_t glFormat = 0;
+	if( tile >= mTileRects.size() )
+	{
+		LogError(LOG_GL "glDisplay::RenderTile() -- invalid tile %u (the layout has %zu tiles, see SetTileLayout())\n", tile, mTileRects.size());
+		return false;
+	}
 
-	if( format == IMAGE_RGB8 )
-		glFormat = GL_RGB8;
-	else if( format == IMAGE_RGBA8 )
-		glFormat = GL_RGBA8;
-	else if( format == IMAGE_RGB32F )
-		glFormat = GL_RGB32F_ARB;
-	else if( format == IMAGE_RGBA32F )
-		glFormat = GL_RGBA32F_ARB;
-	else
+	const uint32_t atlasWidth  = mTileColumns * mTileWidth;
+	const uint32_t atlasHeight = mTileRows * mTileHeight;
+
+	if( !mTileAtlas )
 	{
-		LogError(LOG_GL "glDisplay::Render() -- unsupported image format (%s)\n", imageFormatToStr(format));
-		LogError(LOG_GL "                       supported formats are:\n");
-		LogError(LOG_GL "                           * rgb8\n");		
-		LogError(LOG_GL "                           * rgba8\n");		
-		LogError(LOG_GL "                           * rgb32\n");		
-		LogError(LOG_GL "                           * rgba32\n");
+		mTileAtlas = glTexture::Create(atlasWidth, atlasHeight, GL_RGBA8);
 
-		return NULL;
+		if( !mTileAtlas )
+			return false;
 	}
-		
-	// check to see if a compatible texture has already been allocated
-	const size_t numTextures = mTextures.size();
 
-	for( size_t n=0; n < numTextures; n++ )
+	// map the atlas once for all of the tiles updated this frame, keeping the other tiles' contents
+	if( !mTileMapped )
 	{
-		glTexture* tex = mTextures[n];
+		mTileMapped = mTileAtlas->Map(GL_MAP_CUDA, GL_WRITE_ONLY, stream);
 
-		if( tex->GetWidth() == width && tex->GetHeight() == height && tex->GetFormat() == glFormat )
-			return tex;
+		if( !mTileMapped )
+			return false;
+
+		mTileAtlas->Unbind();	// so it doesn't affect other drawing until RenderTiles()
+		mTileStream = stream;
 	}
 
-	glTexture* tex = glTexture::Create(width, height, glFormat);
+	// convert the frame to RGBA
+	void* rgba = image;
 
-	if( !tex )
+	if( format != IMAGE_RGBA8 )
 	{
-		LogError(LOG_GL "glDisplay.Render() failed to create OpenGL interop texture\n");
-		return NULL;
+		if( !allocNormalized(width, height) )
+			return false;
+
+		if( CUDA_FAILED(cudaConvertColor(image, format, mNormalizedCUDA, IMAGE_RGBA8, width, height, stream)) )
+		{
+			LogError(LOG_GL "glDisplay::RenderTile() -- failed to convert %s image to rgba8\n", imageFormatToStr(format));
+			return false;
+		}
+
+		rgba = mNormalizedCUDA;
 	}
 
-	mTextures.push_back(tex);
-	return tex;
-}
+	// downscale the frame into the tile's slot of the atlas, keeping its aspect ratio
+	const float scale = fminf(1.0f, fminf(float(mTileWidth) / float(width), float(mTileHeight) / float(height)));
 
+	const int left = (tile % mTileColumns) * mTileWidth;
+	const int top  = (tile / mTileColumns) * mTileHeight;
 
-// Render
-void glDisplay::Render( glTexture* texture, float x, float y )
-{
-	if( !texture )
-		return;
+	const int scaledWidth  = (int)(width * scale);
+	const int scaledHeight = (int)(height * scale);
 
-	texture->Render(x,y);
+	const int4 rect = make_int4(left, top, left + ((scaledWidth > 0) ? scaledWidth : 1), top + ((scaledHeight > 0) ? scaledHeight : 1));
+
+	const cudaImageView atlas(mTileMapped, atlasWidth, atlasHeight, IMAGE_RGBA8);
+
+	if( CUDA_FAILED(cudaResize(cudaImageView(rgba, width, height, IMAGE_RGBA8), atlas.Crop(rect), FILTER_LINEAR, stream)) )
+		return false;
+
+	// the atlas gets unmapped on the stream it was mapped with, and the conversion buffer is shared
+	if( stream != mTileStream )
+		CUDA(cudaStreamSynchronize(stream));
+
+	mTileRects[tile] = rect;
+	mTileUpdates.push_back(rect);
+
+	return true;
 }
 
 
-// RenderImage
-void glDisplay::RenderImage( void* img, uint32_t width, uint32_t height, imageFormat format, float x, float y, bool normalize, cudaStream_t stream )
+// RenderTiles
+void glDisplay::RenderTiles( float x, float y, float width, float height )
 {
-	if( !img || width == 0 || height == 0 )
+	if( !mTileAtlas )
 		return;
-	
-	// obtain the OpenGL texture to use
-	glTexture* interopTex = allocTexture(width, height, format);
 
-	if( !interopTex )
+	// upload only the tiles that changed
+	if( mTileMapped != NULL )
+	{
+		mTileAtlas->Unmap(mTileUpdates.data(), mTileUpdates.size(), mTileStream);
+		mTileMapped = NULL;
+		mTileUpdates.clear();
+	}
+
+	const float cellWidth   = width / mTileColumns;
+	const float cellHeight  = height / mTileRows;
+	const float atlasWidth  = mTileAtlas->GetWidth();
+	const float atlasHeight = mTileAtlas->GetHeight();
+
+	if( !mTileAtlas->Bind() )
 		return;
-	
-	// normalize pixels from [0,255] -> [0,1]
-	if( normalize && (format == IMAGE_RGB32F || format == IMAGE_RGBA32F) )
+
+	// draw all of the tiles at once from the atlas
+	glBegin(GL_QUADS);
+	glColor4f(1.0f,1.0f,1.0f,1.0f);
+
+	const uint32_t numTiles = mTileRects.size();
+
+	for( uint32_t n=0; n < numTiles; n++ )
 	{
-		if( !mNormalizedCUDA || mNormalizedWidth < width || mNormalizedHeight < height )
-		{
-			if( mNormalizedCUDA != NULL )
-			{
-				CUDA(cudaFree(mNormalizedCUDA));
-				mNormalizedCUDA = NULL;
-			}
+		const int4& rect = mTileRects[n];
 
-			if( CUDA_FAILED(cudaMalloc(&mNormalizedCUDA, width * height * sizeof(float) * 4)) )	// just allocate this as float4 for simplicity
-			{
-				LogError(LOG_GL "glDisplay.Render() failed to allocate CUDA memory for normalization\n");
-				return;
-			}
+		if( rect.z <= rect.x || rect.w <= rect.y )
+			continue;	// no frames yet
 
-			mNormalizedWidth = width;
-			mNormalizedHeight = height;
-		}
+		// fit the tile in its cell
+		const float tileWidth  = rect.z - rect.x;
+		const float tileHeight = rect.w - rect.y;
+		const float tileScale  = fminf(cellWidth / tileWidth, cellHeight / tileHeight);
 
-		// rescale image pixel intensities for display
-		if( CUDA_FAILED(cudaNormalize(img, make_float2(0.0f, 255.0f), 
-							  mNormalizedCUDA, make_float2(0.0f, 1.0f), 
-	 						  width, height, format, stream)) )
-		{
-			LogError(LOG_GL "glDisplay.Render() failed to normalize image\n");
-			return;
-		}
+		const float w = tileWidth * tileScale;
+		const float h = tileHeight * tileScale;
 
-		img = mNormalizedCUDA;
-	}
+		const float left = x + (n % mTileColumns) * cellWidth + (cellWidth - w) * 0.5f;
+		const float top  = y + (n / mTileColumns) * cellHeight + (cellHeight - h) * 0.5f;
 
-	// map from CUDA to openGL using GL interop
-	void* tex_map = interopTex->Map(GL_MAP_CUDA, GL_WRITE_DISCARD, stream);
+		// inset by half a texel so that filtering doesn't sample the neighboring tiles
+		const float u0 = (rect.x + 0.5f) / atlasWidth;
+		const float v0 = (rect.y + 0.5f) / atlasHeight;
+		const float u1 = (rect.z - 0.5f) / atlasWidth;
+		const float v1 = (rect.w - 0.5f) / atlasHeight;
 
-    if( tex_map != NULL )
-	{
-		CUDA(cudaMemcpyAsync(tex_map, img, interopTex->GetSize(), cudaMemcpyDeviceToDevice, stream));
-		//CUDA(cudaStreamSynchronize(stream));
-		interopTex->Unmap(stream);
+		glTexCoord2f(u0, v0); 
+		glVertex2f(left, top);
+
+		glTexCoord2f(u1, v0); 
+		glVertex2f(left + w, top);	
+
+		glTexCoord2f(u1, v1); 
+		glVertex2f(left + w, top + h);
+
+		glTexCoord2f(u0, v1); 
+		glVertex2f(left, top + h);
 	}
 
-	// draw the texture
-	interopTex->Render(x,y);
+	glEnd();
+	mTileAtlas->Unbind();
+}
+
+
+// RenderTiles
+void glDisplay::RenderTiles()
+{
+	RenderTiles(0, 0, mViewport[2], mViewport[3]);
 }
 
 
@@ -645,18 +1772,12 @@ bool glDisplay::Render( void* image, uint32_t width, uint32_t height, imageForma
 	bool display_success = true;
 
 	// determine input format
-	if( imageFormatIsRGB(format) )
+	if( (imageFormatIsRGB(format) && imageFormatBaseType(format) != IMAGE_UINT16) || imageFormatIsYUV(format) )
 	{
-		// resize the window once to match the feed, but let the user resize/maximize
-		// only resize again if the window is then smaller than the feed
-		if( !mResizedToFeed || ((GetWidth() < width || GetHeight() < height) && (width < mScreenWidth && height < mScreenHeight)) )
-		{
-			SetSize(width, height);
-			mResizedToFeed = true;
-		}
-
-		// render and present the frame
-		RenderOnce(image, width, height, format, 0, 0, true, stream);
+		if( IsThreaded() )
+			display_success = postFrame(image, width, height, format, stream);
+		else
+			presentFrame(image, width, height, format, stream);
 	}
 	else
 	{
@@ -666,16 +1787,303 @@ bool glDisplay::Render( void* image, uint32_t width, uint32_t height, imageForma
 		LogError(LOG_GL "                           * rgba8\n");		
 		LogError(LOG_GL "                           * rgb32\n");		
 		LogError(LOG_GL "                           * rgba32\n");
+		LogError(LOG_GL "                           * yuv (nv12, i420, yv12, yuyv, yvyu, uyvy)\n");
 		
 		display_success = false;
 	}
 
-	// render sub-streams
+	// render sub-streams (offscreen displays pass them the rendered frame from EndRender() instead)
+	if( mOffscreen )
+		return display_success;
+
 	const bool substreams_success = videoOutput::Render(image, width, height, format, stream);
 	return display_success & substreams_success;
 }
 
 
+// presentFrame
+void glDisplay::presentFrame( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	// resize the window once to match the feed, but let the user resize/maximize
+	// only resize again if the window is then smaller than the feed
+	if( !mResizedToFeed || ((GetWidth() < width || GetHeight() < height) && (width < mScreenWidth && height < mScreenHeight)) )
+	{
+		SetSize(width, height);
+		mResizedToFeed = true;
+	}
+
+	// render and present the frame
+	RenderOnce(image, width, height, format, 0, 0, true, stream);
+}
+
+
+// postFrame
+bool glDisplay::postFrame( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	const size_t size = imageFormatSize(format, width, height);
+
+	// pick a slot that isn't waiting to be presented or being presented
+	mFrameMutex.Lock();
+
+	int slot = 0;
+
+	while( slot == mFrameReady || slot == mFramePresenting )
+		slot++;
+
+	mFrameMutex.Unlock();
+
+	// the render thread doesn't touch this slot until it's posted below
+	FrameSlot& frame = mFrameSlots[slot];
+
+	if( frame.size < size )
+	{
+		CUDA(cudaFree(frame.ptr));
+
+		frame.ptr  = NULL;
+		frame.size = 0;
+
+		if( CUDA_FAILED(cudaMalloc(&frame.ptr, size)) )
+		{
+			LogError(LOG_GL "glDisplay -- failed to allocate %zu bytes for render thread frame\n", size);
+			return false;
+		}
+
+		frame.size = size;
+	}
+
+	// copy the frame, and let the render thread wait for the copy instead of this thread
+	if( CUDA_FAILED(cudaMemcpyAsync(frame.ptr, image, size, cudaMemcpyDeviceToDevice, stream)) )
+		return false;
+
+	if( CUDA_FAILED(cudaEventRecord(frame.copied, stream)) )
+		return false;
+
+	frame.width     = width;
+	frame.height    = height;
+	frame.format    = format;
+	frame.timestamp = monotonicNano();
+
+	// replace the previous frame if it hasn't been presented yet (latest wins)
+	mFrameMutex.Lock();
+
+	if( mFrameReady >= 0 )
+		mFramesDropped++;
+
+	mFrameReady = slot;
+	mFrameMutex.Unlock();
+
+	mFrameEvent.Wake();
+	return true;
+}
+
+
+// renderThread
+void* glDisplay::renderThread( void* user_data )
+{
+	glDisplay* display = (glDisplay*)user_data;
+
+	while( !display->mRenderQuit )
+	{
+		// wait for a new frame, but keep processing window events while idle
+		display->mFrameEvent.Wait(10);
+
+		if( display->mRenderQuit )
+			break;
+
+		display->mFrameMutex.Lock();
+
+		const int slot = display->mFrameReady;
+
+		display->mFrameReady = -1;
+		display->mFramePresenting = slot;
+
+		display->mFrameMutex.Unlock();
+
+		if( slot < 0 )
+		{
+			display->ProcessEvents();
+			continue;
+		}
+
+		FrameSlot& frame = display->mFrameSlots[slot];
+
+		CUDA(cudaEventSynchronize(frame.copied));
+
+		display->presentFrame(frame.ptr, frame.width, frame.height, frame.format, 0);
+		display->mPresentLatency = (display->mPresentTime - frame.timestamp) * 0.000001f;
+
+		display->mFrameMutex.Lock();
+		display->mFramePresenting = -1;
+		display->mFrameMutex.Unlock();
+	}
+
+	// release the GL context so it can be used from other threads again
+	display->releaseCurrent();
+	return NULL;
+}
+
+
+// StartRenderThread
+bool glDisplay::StartRenderThread()
+{
+	if( mRenderThread != NULL )
+		return true;
+
+	// the GL context can't be handed off in the middle of a frame
+	if( mRendering )
+	{
+		LogError(LOG_GL "glDisplay -- can't start the render thread between BeginRender() and EndRender()\n");
+		return false;
+	}
+
+	for( int n=0; n < NumFrameSlots; n++ )
+	{
+		if( mFrameSlots[n].copied != NULL )
+			continue;
+
+		if( CUDA_FAILED(cudaEventCreateWithFlags(&mFrameSlots[n].copied, cudaEventDisableTiming)) )
+			return false;
+	}
+
+	// release the GL context from this thread (the render thread makes it current in BeginRender)
+	releaseCurrent();
+
+	mRenderQuit      = false;
+	mFrameReady      = -1;
+	mFramePresenting = -1;
+	mRenderThread    = new Thread();
+
+	if( !mRenderThread->Start(renderThread, this) )
+	{
+		LogError(LOG_GL "glDisplay -- failed to start the render thread\n");
+		SAFE_DELETE(mRenderThread);
+		return false;
+	}
+
+	LogVerbose(LOG_GL "glDisplay -- started render thread (present mode: %s)\n", PresentModeToStr(mPresentMode));
+	return true;
+}
+
+
+// StopRenderThread
+void glDisplay::StopRenderThread()
+{
+	if( !mRenderThread )
+		return;
+
+	mRenderQuit = true;
+	mFrameEvent.Wake();
+
+	mRenderThread->Stop(true);
+	SAFE_DELETE(mRenderThread);
+
+	mFrameReady      = -1;
+	mFramePresenting = -1;
+
+	LogVerbose(LOG_GL "glDisplay -- stopped render thread (%llu frames presented, %llu dropped)\n", (unsigned long long)mFramesPresented, (unsigned long long)mFramesDropped);
+}
+
+
+// applyPresentMode
+void glDisplay::applyPresentMode()
+{
+	typedef void (*glXSwapIntervalEXTProc)( Display*, GLXDrawable, int );
+	typedef int (*glXSwapIntervalMESAProc)( unsigned int );
+	typedef int (*glXSwapIntervalSGIProc)( int );
+
+	mPresentModeChanged = false;
+
+	if( mPresentMode == PRESENT_DEFAULT || mOffscreen )
+		return;
+
+	const char* extensions = glXQueryExtensionsString(mDisplayX, DefaultScreen(mDisplayX));
+
+	if( !extensions )
+		extensions = "";
+
+	int interval = (mPresentMode == PRESENT_IMMEDIATE) ? 0 : 1;
+
+	if( mPresentMode == PRESENT_ADAPTIVE )
+	{
+		if( strstr(extensions, "GLX_EXT_swap_control_tear") != NULL )
+			interval = -1;
+		else
+			LogWarning(LOG_GL "glDisplay -- adaptive vsync isn't supported (GLX_EXT_swap_control_tear), using vsync\n");
+	}
+
+	// GLX_EXT_swap_control is per-drawable, GLX_MESA_swap_control and GLX_SGI_swap_control are per-context
+	if( strstr(extensions, "GLX_EXT_swap_control") != NULL )
+	{
+		glXSwapIntervalEXTProc swapInterval = (glXSwapIntervalEXTProc)glXGetProcAddress((const GLubyte*)"glXSwapIntervalEXT");
+
+		if( swapInterval != NULL )
+		{
+			swapInterval(mDisplayX, mWindowX, interval);
+			LogVerbose(LOG_GL "glDisplay -- set present mode to %s (swap interval %i)\n", PresentModeToStr(mPresentMode), interval);
+			return;
+		}
+	}
+
+	if( strstr(extensions, "GLX_MESA_swap_control") != NULL && interval >= 0 )
+	{
+		glXSwapIntervalMESAProc swapInterval = (glXSwapIntervalMESAProc)glXGetProcAddress((const GLubyte*)"glXSwapIntervalMESA");
+
+		if( swapInterval != NULL && swapInterval(interval) == 0 )
+		{
+			LogVerbose(LOG_GL "glDisplay -- set present mode to %s (swap interval %i)\n", PresentModeToStr(mPresentMode), interval);
+			return;
+		}
+	}
+
+	if( strstr(extensions, "GLX_SGI_swap_control") != NULL && interval > 0 )
+	{
+		glXSwapIntervalSGIProc swapInterval = (glXSwapIntervalSGIProc)glXGetProcAddress((const GLubyte*)"glXSwapIntervalSGI");
+
+		if( swapInterval != NULL && swapInterval(interval) == 0 )
+		{
+			LogVerbose(LOG_GL "glDisplay -- set present mode to %s (swap interval %i)\n", PresentModeToStr(mPresentMode), interval);
+			return;
+		}
+	}
+
+	LogWarning(LOG_GL "glDisplay -- failed to set present mode to %s (the swap interval can't be changed)\n", PresentModeToStr(mPresentMode));
+}
+
+
+// PresentModeToStr
+const char* glDisplay::PresentModeToStr( PresentMode mode )
+{
+	switch(mode)
+	{
+		case PRESENT_DEFAULT:	return "default";
+		case PRESENT_VSYNC:		return "vsync";
+		case PRESENT_IMMEDIATE:	return "immediate";
+		case PRESENT_ADAPTIVE:	return "adaptive";
+	}
+
+	return "unknown";
+}
+
+
+// PresentModeFromStr
+glDisplay::PresentMode glDisplay::PresentModeFromStr( const char* str )
+{
+	if( !str )
+		return PRESENT_DEFAULT;
+
+	if( strcasecmp(str, "vsync") == 0 )
+		return PRESENT_VSYNC;
+	else if( strcasecmp(str, "immediate") == 0 )
+		return PRESENT_IMMEDIATE;
+	else if( strcasecmp(str, "adaptive") == 0 )
+		return PRESENT_ADAPTIVE;
+	else if( strcasecmp(str, "default") != 0 )
+		LogError(LOG_GL "glDisplay -- unknown present mode '%s' (using default)\n", str);
+
+	return PRESENT_DEFAULT;
+}
+
+
 // RenderLine
 void glDisplay::RenderLine( float x1, float y1, float x2, float y2, float r, float g, float b, float a, float thickness )
 {
@@ -734,6 +2142,9 @@ void glDisplay::SetBackgroundColor( float r, float g, float b, float a )
 // IsMaximied
 bool glDisplay::IsMaximized()
 {
+	if( mOffscreen )
+		return false;
+
 	Atom _NET_WM_STATE = XInternAtom(mDisplayX, "_NET_WM_STATE", False);
 	Atom _NET_WM_STATE_MAXIMIZED_VERT = XInternAtom(mDisplayX, "_NET_WM_STATE_MAXIMIZED_VERT", False);
 	Atom _NET_WM_STATE_MAXIMIZED_HORZ = XInternAtom(mDisplayX, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
@@ -774,6 +2185,9 @@ bool glDisplay::IsMaximized()
 // SetMaximized
 void glDisplay::SetMaximized( bool maximized )
 {
+	if( mOffscreen )
+		return;
+
 	Atom _NET_WM_STATE = XInternAtom(mDisplayX, "_NET_WM_STATE", False);
 	Atom _NET_WM_STATE_MAXIMIZED_VERT = XInternAtom(mDisplayX, "_NET_WM_STATE_MAXIMIZED_VERT", False);
 	Atom _NET_WM_STATE_MAXIMIZED_HORZ = XInternAtom(mDisplayX, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
@@ -802,6 +2216,9 @@ void glDisplay::SetMaximized( bool maximized )
 // IsFullscreen
 bool glDisplay::IsFullscreen()
 {
+	if( mOffscreen )
+		return false;
+
 	Atom _NET_WM_STATE = XInternAtom(mDisplayX, "_NET_WM_STATE", False);
 	Atom _NET_WM_STATE_FULLSCREEN = XInternAtom(mDisplayX, "_NET_WM_STATE_FULLSCREEN", False);
 
@@ -839,6 +2256,9 @@ bool glDisplay::IsFullscreen()
 // SetFullscreen
 void glDisplay::SetFullscreen( bool fullscreen )
 {
+	if( mOffscreen )
+		return;
+
 	Atom _NET_WM_STATE = XInternAtom(mDisplayX, "_NET_WM_STATE", False);
 	Atom _NET_WM_STATE_FULLSCREEN = XInternAtom(mDisplayX, "_NET_WM_STATE_FULLSCREEN", False);
 
@@ -876,6 +2296,18 @@ void glDisplay::SetSize( uint32_t width, uint32_t height )
 	if( height > mScreenHeight )
 		height = mScreenHeight;
 
+	// the offscreen framebuffer gets reallocated by the next BeginRender()
+	if( mOffscreen )
+	{
+		LogVerbose(LOG_GL "glDisplay -- set the offscreen framebuffer size to %ux%u\n", width, height);
+
+		mOptions.width = width;
+		mOptions.height = height;
+
+		ResetViewport();
+		return;
+	}
+
 	// un-maximized the window if new size not fullscreen
 	if( width != mScreenWidth || height != mScreenHeight )
 		SetMaximized(false);
@@ -907,7 +2339,7 @@ void glDisplay::SetCursor( uint32_t cursor )
 		return;
 	}
 
-	if( cursor == mActiveCursor )
+	if( cursor == mActiveCursor || mOffscreen )
 		return;
 
 	//printf(LOG_GL "glDisplay -- SetCursor(%u)\n", cursor);
@@ -1114,6 +2546,9 @@ void glDisplay::ProcessEvents()
 	mMouseWheel     = 0;
 	mKeyText		= 0;*/
 
+	if( mOffscreen )
+		return;
+
 	XEvent evt;
 
 	while( XEventsQueued(mDisplayX, QueuedAlready) > 0 )
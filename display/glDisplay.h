@@ -27,9 +27,17 @@
 
 #include "glUtility.h"
 #include "glTexture.h"
+#include "glBuffer.h"
+#include "glShader.h"
 #include "glEvents.h"
 #include "glWidget.h"
 
+#include "Thread.h"
+#include "Mutex.h"
+#include "Event.h"
+
+#include <EGL/egl.h>
+
 #include <time.h>
 #include <vector>
 
@@ -37,6 +45,25 @@
 /**
  * OpenGL display window and image/video renderer with CUDA interoperability.
  *
+ * Along with RGB/RGBA images, YUV frames (NV12, I420, YV12, YUYV, YVYU, UYVY) can be
+ * rendered directly - their planes are uploaded to textures as-is, and converted to RGB
+ * by a fragment shader while drawing.  Normalization of floating-point images is also
+ * done in the shader.  This avoids the intermediate RGBA/float4 buffers in CUDA, and
+ * roughly halves the memory bandwidth of previewing YUV camera feeds.  If GLSL shaders
+ * aren't available, the conversion falls back to CUDA (cudaConvertColor/cudaNormalize).
+ *
+ * By default, frames are drawn and swapped on the thread that calls Render(), so with vsync
+ * the application runs at the refresh rate of the monitor.  With StartRenderThread() (or the
+ * `--render-thread` command-line flag), frames are handed off to a dedicated render thread
+ * instead, which presents the latest one and drops the rest.  The present mode (vsync,
+ * immediate, or adaptive) can be set with SetPresentMode() or `--present-mode`.
+ *
+ * An offscreen display (`display://offscreen`, CreateOffscreen(), or `--offscreen`) doesn't
+ * need an X server - it uses an EGL context and renders into a framebuffer texture instead of
+ * a window.  Widgets, glCamera, and the drawing functions work the same as in a window, and
+ * the rendered frames are read back and passed to the sub-streams (for example, to burn the
+ * overlays into a video file or network stream).  See CreateOffscreen() for more info.
+ *
  * @note glDisplay implements the videoOutput interface and is intended to
  * be used through that as opposed to directly.  videoOutput implements
  * additional command-line parsing of videoOptions to construct instances.
@@ -66,6 +93,21 @@ public:
 	 */
 	static glDisplay* Create( const videoOptions& options );
 
+	/**
+	 * Create an offscreen display that renders into a framebuffer texture instead of a window.
+	 *
+	 * This uses EGL (with a pbuffer or surfaceless context) so it doesn't need an X server,
+	 * and works with Mesa's software renderer (llvmpipe) as well as the GPU.  After each frame
+	 * is rendered, EndRender() starts an asynchronous readback of it into a pixel buffer, and
+	 * passes the previous frame (which has finished transferring by then) to the sub-streams
+	 * as RGBA8.  So the frames that the sub-streams receive are one frame behind.
+	 *
+	 * @param width the width of the framebuffer (Render() resizes it to match the feed)
+	 * @param height the height of the framebuffer (Render() resizes it to match the feed)
+	 * @param output an optional videoOutput that receives the rendered frames (as a sub-stream)
+	 */
+	static glDisplay* CreateOffscreen( uint32_t width=1280, uint32_t height=720, videoOutput* output=NULL );
+
 	/**
 	 * Destroy window
 	 */
@@ -87,6 +129,22 @@ public:
 	 */
 	inline bool IsClosed() const				{ return !mStreaming; }
 
+	/**
+	 * Returns true if this is an offscreen display (see CreateOffscreen())
+	 */
+	inline bool IsOffscreen() const				{ return mOffscreen; }
+
+	/**
+	 * Retrieve the last frame that was read back from an offscreen display (RGBA8, in mapped
+	 * CPU/GPU memory), or NULL if there isn't one yet.  It has the size of GetWidth()/GetHeight().
+	 */
+	inline void* GetFramebuffer() const			{ return mReadbackReady ? mReadbackFrame : NULL; }
+
+	/**
+	 * Retrieve the OpenGL texture that an offscreen display renders into (or 0 for a window).
+	 */
+	inline uint32_t GetFramebufferTexture() const	{ return mFramebufferTexture; }
+
 	/**
 	 * Returns true if between BeginRender() and EndRender()
 	 */
@@ -162,15 +220,16 @@ public:
 	/**
 	 * Render a CUDA image (uchar3, uchar4, float3, float4) using OpenGL interop.
 	 * This is similar to RenderOnce(), in that it will begin/end the frame also.
+	 * If the render thread is running, the frame is posted to it instead (see StartRenderThread())
 	 * @see videoOutput::Render
 	 */
 	virtual bool Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
 
 	/**
-	 * Render a CUDA image (uchar3, uchar4, float3, float4) using OpenGL interop.
+	 * Render a CUDA image (uchar3, uchar4, float3, float4, or YUV) using OpenGL interop.
 	 * If normalize is true, the image's pixel values will be rescaled from the range of [0-255] to [0-1]
 	 * If normalize is false, the image's pixel values are assumed to already be in the range of [0-1]
-	 * Note that if normalization is selected to be performed, it will be done in-place on the image
+	 * The image itself isn't modified - normalization and YUV conversion are done while drawing.
 	 */
 	void RenderImage( void* image, uint32_t width, uint32_t height, imageFormat format, float x=0.0f, float y=30.0f, bool normalize=true, cudaStream_t stream=0 );
 
@@ -194,6 +253,167 @@ public:
 
 	///@}
 
+	//////////////////////////////////////////////////////////////////////////////////
+	/// @name Tiled Compositing
+	//////////////////////////////////////////////////////////////////////////////////
+
+	///@{
+
+	/**
+	 * Set up a grid of tiles for showing many streams at once (like a wall of cameras).
+	 *
+	 * The tiles share one atlas texture that's reused across frames, with a slot of
+	 * `tileWidth x tileHeight` pixels for each stream.  Call RenderTile() whenever a
+	 * stream has a new frame, and RenderTiles() once per frame to draw all of them:
+	 *
+	 * @code
+	 * display->SetTileLayout(16, 640, 360);
+	 *
+	 * while( display->IsStreaming() )
+	 * {
+	 *     display->BeginRender();
+	 *
+	 *     for( int n=0; n < 16; n++ )
+	 *         if( cameras[n]->Capture(&image, &status, 0) )	// only streams with new frames
+	 *             display->RenderTile(n, image, cameras[n]->GetWidth(), cameras[n]->GetHeight());
+	 *
+	 *     display->RenderTiles();
+	 *     display->EndRender();
+	 * }
+	 * @endcode
+	 *
+	 * @param numTiles the number of tiles in the grid, which has `ceil(sqrt(numTiles))` columns.
+	 * @param tileWidth the width of each tile in the atlas - frames are downscaled to fit.
+	 * @param tileHeight the height of each tile in the atlas - frames are downscaled to fit.
+	 */
+	bool SetTileLayout( uint32_t numTiles, uint32_t tileWidth=640, uint32_t tileHeight=360 );
+
+	/**
+	 * Update the contents of a tile with a new frame from a stream.
+	 * The frame is converted to RGBA and scaled into the tile's slot of the atlas with CUDA,
+	 * and only the tiles that were updated get uploaded to OpenGL by RenderTiles().
+	 * Supports the same formats as RenderImage() - floating-point images are expected to be [0,255].
+	 */
+	bool RenderTile( uint32_t tile, void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
+
+	/**
+	 * Update the contents of a tile with a new frame (uchar3, uchar4, float3, float4).
+	 */
+	template<typename T> bool RenderTile( uint32_t tile, T* image, uint32_t width, uint32_t height, cudaStream_t stream=0 )	{ return RenderTile(tile, (void*)image, width, height, imageFormatFromType<T>(), stream); }
+
+	/**
+	 * Draw all of the tiles in a grid that fills the specified rectangle, in a single draw call.
+	 * Each tile keeps its aspect ratio within its cell, and tiles without a frame yet are left empty.
+	 */
+	void RenderTiles( float x, float y, float width, float height );
+
+	/**
+	 * Draw all of the tiles in a grid that fills the current viewport.
+	 */
+	void RenderTiles();
+
+	/**
+	 * Return the number of tiles from SetTileLayout()
+	 */
+	inline uint32_t GetNumTiles() const					{ return mTileRects.size(); }
+
+	/**
+	 * Set the maximum number of textures that RenderImage() keeps for different image sizes/formats.
+	 * When a new texture is needed and this many are allocated, the least-recently used one is freed.
+	 */
+	inline void SetMaxTextures( uint32_t maxTextures )		{ mMaxTextures = (maxTextures > 0) ? maxTextures : 1; }
+
+	///@}
+
+	//////////////////////////////////////////////////////////////////////////////////
+	/// @name Render Thread + Frame Pacing
+	//////////////////////////////////////////////////////////////////////////////////
+
+	///@{
+
+	/**
+	 * How rendered frames are presented to the screen (i.e. the swap interval).
+	 * This can be set from the command line using `--present-mode=xyz`.
+	 */
+	enum PresentMode
+	{
+		PRESENT_DEFAULT = 0,	/**< Leave the driver's setting alone (usually vsync) */
+		PRESENT_VSYNC,			/**< Wait for the vertical blank before swapping (no tearing) */
+		PRESENT_IMMEDIATE,		/**< Swap right away, without waiting for vsync (may tear) */
+		PRESENT_ADAPTIVE		/**< Vsync, unless the frame is late - then swap right away (GLX_EXT_swap_control_tear) */
+	};
+
+	/**
+	 * Set the present mode, which is applied before the next frame gets rendered.
+	 */
+	inline void SetPresentMode( PresentMode mode )			{ mPresentMode = mode; mPresentModeChanged = true; }
+
+	/**
+	 * Get the present mode.
+	 */
+	inline PresentMode GetPresentMode() const				{ return mPresentMode; }
+
+	/**
+	 * Start presenting frames from a dedicated render thread.
+	 *
+	 * Afterwards, Render() copies the frame into a mailbox and returns without waiting
+	 * for it to be drawn or for vsync, so the capture/processing loop isn't throttled
+	 * by the display.  The render thread always presents the latest frame - if a new
+	 * frame arrives before the previous one was presented, the previous one is dropped
+	 * (see GetFramesDropped()).  Window events are processed by the render thread too.
+	 *
+	 * This can be enabled from the command line using `--render-thread`.
+	 *
+	 * @note while the render thread is running, the OpenGL context belongs to it, so
+	 *       only Render() should be used to draw (not BeginRender()/EndRender() and the
+	 *       other drawing functions), and frames should be rendered from one thread.
+	 */
+	bool StartRenderThread();
+
+	/**
+	 * Stop the render thread, and go back to rendering from the caller's thread.
+	 */
+	void StopRenderThread();
+
+	/**
+	 * Returns true if frames are being presented from a render thread.
+	 */
+	inline bool IsThreaded() const						{ return mRenderThread != NULL; }
+
+	/**
+	 * Get the number of frames that have been presented.
+	 */
+	inline uint64_t GetFramesPresented() const				{ return mFramesPresented; }
+
+	/**
+	 * Get the number of frames that were replaced by a newer frame before the render thread
+	 * got to present them (this is always zero when frames are rendered synchronously).
+	 */
+	inline uint64_t GetFramesDropped() const				{ return mFramesDropped; }
+
+	/**
+	 * Get the time that the last frame was presented, in nanoseconds of `CLOCK_MONOTONIC`.
+	 */
+	inline uint64_t GetPresentTime() const					{ return mPresentTime; }
+
+	/**
+	 * Get the time from Render() being called until the frame was presented (in milliseconds).
+	 * This is only measured when the render thread is used.
+	 */
+	inline float GetPresentLatency() const					{ return mPresentLatency; }
+
+	/**
+	 * Convert a PresentMode enum to a string.
+	 */
+	static const char* PresentModeToStr( PresentMode mode );
+
+	/**
+	 * Parse a PresentMode enum from a string (`default`, `vsync`, `immediate`, or `adaptive`)
+	 */
+	static PresentMode PresentModeFromStr( const char* str );
+
+	///@}
+
 	//////////////////////////////////////////////////////////////////////////////////
 	/// @name Vector Rendering
 	//////////////////////////////////////////////////////////////////////////////////
@@ -590,8 +810,38 @@ protected:
 		
 	bool initWindow();
 	bool initGL();
+	bool initEGL();
+
+	void makeCurrent();
+	void releaseCurrent();
+
+	bool allocFramebuffer( uint32_t width, uint32_t height );
+	bool readFramebuffer();
+	void freeFramebuffer();
 
 	glTexture* allocTexture( uint32_t width, uint32_t height, imageFormat format );	
+	glTexture* allocPlane( uint32_t plane, uint32_t width, uint32_t height, uint32_t glFormat );
+	bool allocNormalized( uint32_t width, uint32_t height );
+
+	bool initShaders();
+	bool renderShader( void* image, uint32_t width, uint32_t height, imageFormat format, float x, float y, bool normalize, cudaStream_t stream );
+	bool uploadTexture( glTexture* texture, void* image, cudaStream_t stream );
+	void freeTiles();
+
+	void presentFrame( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream );
+	bool postFrame( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream );
+	void applyPresentMode();
+
+	static void* renderThread( void* user_data );
+
+	enum ShaderType
+	{
+		SHADER_NV12 = 0,	// Y plane + interleaved UV plane
+		SHADER_PLANAR,		// Y, U, and V planes (I420/YV12)
+		SHADER_PACKED,		// YUYV, YVYU, UYVY (two pixels per RGBA texel)
+		SHADER_NORMALIZE,	// float RGB/RGBA scaled to [0,1]
+		SHADER_COUNT
+	};
 
 	void activateViewport();
 
@@ -639,8 +889,80 @@ protected:
 	uint32_t mNormalizedWidth;
 	uint32_t mNormalizedHeight;
 
+	glShader*  mShaders[SHADER_COUNT];
+	glTexture* mPlanes[3];
+	bool       mShadersFailed;
+
 	std::vector<glWidget*> mWidgets;
-	std::vector<glTexture*> mTextures;
+	std::vector<glTexture*> mTextures;	// ordered from most to least recently used
+	uint32_t                mMaxTextures;
+
+	glTexture*        mTileAtlas;
+	void*             mTileMapped;		// CUDA pointer to the atlas while tiles are being updated
+	cudaStream_t      mTileStream;
+	uint32_t          mTileWidth;
+	uint32_t          mTileHeight;
+	uint32_t          mTileColumns;
+	uint32_t          mTileRows;
+	std::vector<int4> mTileRects;		// region of each tile's frame in the atlas (empty if none yet)
+	std::vector<int4> mTileUpdates;		// regions to upload on the next RenderTiles()
+
+	struct FrameSlot
+	{
+		void*       ptr;
+		size_t      size;
+		uint32_t    width;
+		uint32_t    height;
+		imageFormat format;
+		cudaEvent_t copied;		// recorded after the frame was copied into the slot
+		uint64_t    timestamp;	// when Render() was called (CLOCK_MONOTONIC, in nanoseconds)
+	};
+
+	static const int NumFrameSlots = 3;	// one being written, one waiting, one being presented
+
+	Thread*   mRenderThread;
+	bool      mRenderQuit;
+	Mutex     mFrameMutex;
+	Event     mFrameEvent;
+	FrameSlot mFrameSlots[NumFrameSlots];
+	int       mFrameReady;			// slot of the latest frame waiting to be presented (or -1)
+	int       mFramePresenting;		// slot that the render thread is presenting (or -1)
+
+	PresentMode mPresentMode;
+	bool        mPresentModeChanged;
+	uint64_t    mFramesPresented;
+	uint64_t    mFramesDropped;
+	uint64_t    mPresentTime;
+	float       mPresentLatency;
+
+	struct ReadbackBuffer
+	{
+		glBuffer* pbo;
+		bool      pending;		// a frame is being transferred into this buffer
+	};
+
+	static const int NumReadbackBuffers = 2;
+
+	bool       mOffscreen;
+	EGLDisplay mDisplayEGL;
+	EGLSurface mSurfaceEGL;
+	EGLContext mContextEGL;
+
+	uint32_t   mFramebuffers[2];		// the frame is rendered to the first, then flipped into the second for readback
+	uint32_t   mFramebufferTexture;
+	uint32_t   mFramebufferDepth;
+	uint32_t   mFramebufferFlipped;
+	uint32_t   mFramebufferWidth;
+	uint32_t   mFramebufferHeight;
+
+	ReadbackBuffer mReadback[NumReadbackBuffers];
+	int            mReadbackIndex;		// buffer that the next frame gets read into
+	void*          mReadbackFrame;		// RGBA8 frame in mapped memory
+	size_t         mReadbackSize;
+	bool           mReadbackReady;
+	bool           mReadbackCUDA;		// map the PBOs into CUDA instead of the CPU
+	bool           mReadbackHost;		// no GPU, so the frame is in regular CPU memory
+
 	std::vector<eventHandler> mEventHandlers;
 };
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "glUtility.h"
+#include "glShader.h"
+
+
+// constructor
+glShader::glShader()
+{
+	mID = 0;
+}
+
+
+// destructor
+glShader::~glShader()
+{
+	if( mID != 0 )
+	{
+		GL(glDeleteProgram(mID));
+		mID = 0;
+	}
+}
+
+
+// IsSupported
+bool glShader::IsSupported()
+{
+	return GLEW_VERSION_2_0 ? true : false;
+}
+
+
+// Create
+glShader* glShader::Create( const char* vertexSource, const char* fragmentSource )
+{
+	if( !vertexSource || !fragmentSource )
+		return NULL;
+
+	if( !IsSupported() )
+	{
+		LogError(LOG_GL "failed to create shader (OpenGL 2.0 is required)\n");
+		return NULL;
+	}
+
+	glShader* shader = new glShader();
+
+	if( !shader->init(vertexSource, fragmentSource) )
+	{
+		LogError(LOG_GL "failed to create shader program\n");
+		delete shader;
+		return NULL;
+	}
+
+	return shader;
+}
+
+
+// compile
+uint32_t glShader::compile( uint32_t type, const char* source )
+{
+	const GLuint id = glCreateShader(type);
+
+	if( id == 0 )
+	{
+		GL_CHECK("glCreateShader()");
+		return 0;
+	}
+
+	GL(glShaderSource(id, 1, &source, NULL));
+	GL(glCompileShader(id));
+
+	GLint status = GL_FALSE;
+	GL(glGetShaderiv(id, GL_COMPILE_STATUS, &status));
+
+	if( status != GL_TRUE )
+	{
+		char log[2048];
+		GL(glGetShaderInfoLog(id, sizeof(log), NULL, log));
+
+		LogError(LOG_GL "failed to compile %s shader:\n%s\n", (type == GL_VERTEX_SHADER) ? "vertex" : "fragment", log);
+		GL(glDeleteShader(id));
+		return 0;
+	}
+
+	return id;
+}
+
+
+// init
+bool glShader::init( const char* vertexSource, const char* fragmentSource )
+{
+	const GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+
+	if( !vertexShader )
+		return false;
+
+	const GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+
+	if( !fragmentShader )
+	{
+		GL(glDeleteShader(vertexShader));
+		return false;
+	}
+
+	const GLuint program = glCreateProgram();
+
+	GL(glAttachShader(program, vertexShader));
+	GL(glAttachShader(program, fragmentShader));
+	GL(glLinkProgram(program));
+
+	// the shaders are kept alive by the program until it's deleted
+	GL(glDeleteShader(vertexShader));
+	GL(glDeleteShader(fragmentShader));
+
+	GLint status = GL_FALSE;
+	GL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+
+	if( status != GL_TRUE )
+	{
+		char log[2048];
+		GL(glGetProgramInfoLog(program, sizeof(log), NULL, log));
+
+		LogError(LOG_GL "failed to link shader program:\n%s\n", log);
+		GL(glDeleteProgram(program));
+		return false;
+	}
+
+	mID = program;
+	return true;
+}
+
+
+// Bind
+bool glShader::Bind()
+{
+	if( !mID )
+		return false;
+
+	GL_VERIFY(glUseProgram(mID));
+	return true;
+}
+
+
+// Unbind
+void glShader::Unbind()
+{
+	glUseProgram(0);
+}
+
+
+// SetUniform
+bool glShader::SetUniform( const char* name, int value )
+{
+	const GLint location = glGetUniformLocation(mID, name);
+
+	if( location < 0 )
+		return false;
+
+	GL_VERIFY(glUniform1i(location, value));
+	return true;
+}
+
+
+// SetUniform
+bool glShader::SetUniform( const char* name, float value )
+{
+	const GLint location = glGetUniformLocation(mID, name);
+
+	if( location < 0 )
+		return false;
+
+	GL_VERIFY(glUniform1f(location, value));
+	return true;
+}
+
+
+// SetUniform
+bool glShader::SetUniform( const char* name, float x, float y, float z, float w )
+{
+	const GLint location = glGetUniformLocation(mID, name);
+
+	if( location < 0 )
+		return false;
+
+	GL_VERIFY(glUniform4f(location, x, y, z, w));
+	return true;
+}
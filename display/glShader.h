@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __GL_SHADER_H__
+#define __GL_SHADER_H__
+
+
+#include <stdint.h>
+
+
+/**
+ * GLSL shader program, made from a vertex shader and a fragment shader.
+ *
+ * The shaders are written against the compatibility profile (GLSL 1.10), so they
+ * work alongside the fixed-function drawing that glDisplay and glTexture use,
+ * and can read the texture coordinates from `gl_MultiTexCoord0`.
+ *
+ * @ingroup OpenGL
+ */
+class glShader
+{
+public:
+	/**
+	 * Compile and link a shader program from source code.
+	 * @param vertexSource GLSL source of the vertex shader.
+	 * @param fragmentSource GLSL source of the fragment shader.
+	 * @returns the new shader program, or NULL if there was an error
+	 *          (the compiler and linker logs are printed on failure).
+	 */
+	static glShader* Create( const char* vertexSource, const char* fragmentSource );
+
+	/**
+	 * Free the shader program.
+	 */
+	~glShader();
+
+	/**
+	 * Activate the shader program for the following draw calls.
+	 */
+	bool Bind();
+
+	/**
+	 * Deactivate the shader program (restoring the fixed-function pipeline).
+	 */
+	void Unbind();
+
+	/**
+	 * Set an integer or sampler uniform (the program must be bound).
+	 */
+	bool SetUniform( const char* name, int value );
+
+	/**
+	 * Set a float uniform (the program must be bound).
+	 */
+	bool SetUniform( const char* name, float value );
+
+	/**
+	 * Set a vec4 uniform (the program must be bound).
+	 */
+	bool SetUniform( const char* name, float x, float y, float z, float w );
+
+	/**
+	 * Retrieve the OpenGL resource handle of the shader program.
+	 */
+	inline uint32_t GetID() const		{ return mID; }
+
+	/**
+	 * Return true if the OpenGL context supports GLSL shaders (OpenGL 2.0).
+	 */
+	static bool IsSupported();
+
+private:
+	glShader();
+
+	bool init( const char* vertexSource, const char* fragmentSource );
+
+	static uint32_t compile( uint32_t type, const char* source );
+
+	uint32_t mID;
+};
+
+
+#endif
@@ -546,6 +546,13 @@ void* glTexture::Map( uint32_t device, uint32_t flags, cudaStream_t stream )
 
 // Unmap
 void glTexture::Unmap( cudaStream_t stream )
+{
+	Unmap(NULL, 0, stream);
+}
+
+
+// Unmap
+void glTexture::Unmap( const int4* regions, uint32_t numRegions, cudaStream_t stream )
 {
 	if( mMapDevice != GL_MAP_CPU && mMapDevice != GL_MAP_CUDA )
 		return;
@@ -560,7 +567,7 @@ void glTexture::Unmap( cudaStream_t stream )
 		GL(glUnmapBuffer(dmaType));
 
 		if( mMapFlags != GL_READ_ONLY )
-			GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, glTextureLayout(mFormat), glTextureType(mFormat), NULL));
+			upload(regions, numRegions);
 
 		GL(glBindBuffer(dmaType, 0));
 	}
@@ -576,7 +583,7 @@ void glTexture::Unmap( cudaStream_t stream )
 		if( mMapFlags != GL_READ_ONLY )
 		{
 			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, mUnpackDMA));
-			GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, glTextureLayout(mFormat), glTextureType(mFormat), NULL));
+			upload(regions, numRegions);
 			GL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0));	
 		}
 	}
@@ -586,6 +593,39 @@ void glTexture::Unmap( cudaStream_t stream )
 }
 
 
+// upload (from the bound unpack buffer)
+void glTexture::upload( const int4* regions, uint32_t numRegions )
+{
+	if( !regions )
+	{
+		GL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, glTextureLayout(mFormat), glTextureType(mFormat), NULL));
+		return;
+	}
+
+	// the regions are sub-rectangles of the full-size buffer
+	GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, mWidth));
+
+	for( uint32_t n=0; n < numRegions; n++ )
+	{
+		const int left   = (regions[n].x > 0) ? regions[n].x : 0;
+		const int top    = (regions[n].y > 0) ? regions[n].y : 0;
+		const int right  = (regions[n].z < (int)mWidth) ? regions[n].z : (int)mWidth;
+		const int bottom = (regions[n].w < (int)mHeight) ? regions[n].w : (int)mHeight;
+
+		if( right <= left || bottom <= top )
+			continue;
+
+		GL(glPixelStorei(GL_UNPACK_SKIP_PIXELS, left));
+		GL(glPixelStorei(GL_UNPACK_SKIP_ROWS, top));
+		GL(glTexSubImage2D(GL_TEXTURE_2D, 0, left, top, right - left, bottom - top, glTextureLayout(mFormat), glTextureType(mFormat), NULL));
+	}
+
+	GL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+	GL(glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0));
+	GL(glPixelStorei(GL_UNPACK_SKIP_ROWS, 0));
+}
+
+
 // Copy
 bool glTexture::Copy( void* ptr, uint32_t offset, uint32_t size, uint32_t flags, cudaStream_t stream )
 {
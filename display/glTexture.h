@@ -138,6 +138,18 @@ public:
 	 */
 	void Unmap( cudaStream_t stream=0 );
 
+	/**
+	 * Unmap the texture from CPU/CUDA access, and only update these regions of the
+	 * texture from the mapped buffer (the rest of the texture keeps its old contents).
+	 * This should be used with GL_WRITE_ONLY or GL_READ_WRITE, because the contents
+	 * of the buffer outside of the regions are undefined with GL_WRITE_DISCARD.
+	 *
+	 * @param regions the rectangles to update, as (left, top, right, bottom) in pixels.
+	 * @param numRegions the number of rectangles in the regions array.
+	 * @note the texture will be unbound after calling Unmap()
+	 */
+	void Unmap( const int4* regions, uint32_t numRegions, cudaStream_t stream=0 );
+
 	/**
 	 * Copy entire contents of the texture to/from CPU or CUDA memory.
 	 *
@@ -206,6 +218,8 @@ private:
 	uint32_t allocDMA( uint32_t type );
 	cudaGraphicsResource* allocInterop( uint32_t type, uint32_t flags );
 
+	void upload( const int4* regions, uint32_t numRegions );
+
 	uint32_t mID;
 	uint32_t mPackDMA;
 	uint32_t mUnpackDMA;
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "imageIO.h"
+
+#include "cudaMappedMemory.h"
+#include "timespec.h"
+#include "logging.h"
+#include "commandLine.h"
+
+
+int usage()
+{
+	printf("usage: image-benchmark [--help] [--width=W] [--height=H] [--iterations=N] file.jpg ...\n\n");
+	printf("Measure the time taken to load and save images with loadImage() and saveImage().\n");
+	printf("When jetson-utils was built with ENABLE_TURBOJPEG, JPEG's are tested with both\n");
+	printf("libjpeg-turbo and stb_image so that they can be compared.\n\n");
+	printf("positional arguments:\n");
+	printf("    file.jpg        one or more images to load\n\n");
+	printf("optional arguments:\n");
+	printf("  --width=W         width to load the images at when resizing (default is 640)\n");
+	printf("  --height=H        height to load the images at when resizing (default is 480)\n");
+	printf("  --iterations=N    number of times to load/save each image (default is 10)\n");
+	printf("  --quality=Q       JPEG quality level to save the images with (default is 95)\n");
+	printf("  --save=FILE       path to save the images to (default is /tmp/image-benchmark.jpg)\n\n");
+
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// load an image N times at the given size (or full size if 0), returning the average time in ms
+float benchmarkLoad( const char* filename, int width, int height, uint32_t iterations, int* loadedWidth, int* loadedHeight )
+{
+	float total = 0.0f;
+
+	for( uint32_t n=0; n < iterations; n++ )
+	{
+		uchar3* image = NULL;
+
+		*loadedWidth = width;
+		*loadedHeight = height;
+
+		const timespec begin = timestamp();
+
+		if( !loadImage(filename, &image, loadedWidth, loadedHeight) )
+			return -1.0f;
+
+		total += timeFloat(timeDiff(begin, timestamp()));
+		CUDA(cudaFreeHost(image));
+	}
+
+	return total / iterations;
+}
+
+
+// save an image N times, returning the average time in ms
+float benchmarkSave( const char* filename, uchar3* image, int width, int height, int quality, uint32_t iterations )
+{
+	float total = 0.0f;
+
+	for( uint32_t n=0; n < iterations; n++ )
+	{
+		const timespec begin = timestamp();
+
+		if( !saveImage(filename, image, width, height, quality) )
+			return -1.0f;
+
+		total += timeFloat(timeDiff(begin, timestamp()));
+	}
+
+	return total / iterations;
+}
+
+
+// run the benchmarks on an image with the current JPEG backend
+bool benchmarkImage( const char* filename, const commandLine& cmdLine )
+{
+	const int width = cmdLine.GetInt("width", 640);
+	const int height = cmdLine.GetInt("height", 480);
+	const int quality = cmdLine.GetInt("quality", IMAGE_DEFAULT_SAVE_QUALITY);
+	const uint32_t iterations = cmdLine.GetUnsignedInt("iterations", 10);
+	const char* savePath = cmdLine.GetString("save", "/tmp/image-benchmark.jpg");
+	const char* backend = isTurboJPEGEnabled() ? "libjpeg-turbo" : "stb_image";
+
+	int fullWidth = 0;
+	int fullHeight = 0;
+	int resizedWidth = 0;
+	int resizedHeight = 0;
+
+	const float fullTime = benchmarkLoad(filename, 0, 0, iterations, &fullWidth, &fullHeight);
+	const float resizedTime = benchmarkLoad(filename, width, height, iterations, &resizedWidth, &resizedHeight);
+
+	if( fullTime < 0 || resizedTime < 0 )
+	{
+		LogError("image-benchmark:  failed to load '%s'\n", filename);
+		return false;
+	}
+
+	// the decoder's DCT scaling must never change the size that was asked for
+	if( resizedWidth != width || resizedHeight != height )
+	{
+		LogError("image-benchmark:  %s loaded '%s' at %ix%i instead of %ix%i\n", backend, filename, resizedWidth, resizedHeight, width, height);
+		return false;
+	}
+
+	uchar3* image = NULL;
+
+	if( !loadImage(filename, &image, &fullWidth, &fullHeight) )
+		return false;
+
+	const float saveTime = benchmarkSave(savePath, image, fullWidth, fullHeight, quality, iterations);
+	CUDA(cudaFreeHost(image));
+
+	if( saveTime < 0 )
+	{
+		LogError("image-benchmark:  failed to save '%s'\n", savePath);
+		return false;
+	}
+
+	LogSuccess("image-benchmark:  %-13s  load %ix%i %8.2fms   load %ix%i %8.2fms   save %ix%i %8.2fms   '%s'\n",
+			 backend, fullWidth, fullHeight, fullTime, resizedWidth, resizedHeight, resizedTime,
+			 fullWidth, fullHeight, saveTime, filename);
+
+	return true;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") || cmdLine.GetPositionArgs() == 0 )
+		return usage();
+
+	// keep the per-image logging out of the measurements (unless --verbose or --log-level is used)
+	Log::ParseCmdLine(cmdLine);
+
+	if( !cmdLine.GetFlag("verbose") && !cmdLine.GetString("log-level") )
+		Log::SetLevel(Log::INFO);
+
+
+	/*
+	 * benchmark each image with stb_image, and then libjpeg-turbo (if it's available)
+	 */
+	const uint32_t numImages = cmdLine.GetPositionArgs();
+	int result = 0;
+
+	for( uint32_t n=0; n < numImages; n++ )
+	{
+		const char* filename = cmdLine.GetPosition(n);
+
+		enableTurboJPEG(false);
+
+		if( !benchmarkImage(filename, cmdLine) )
+			result = 1;
+
+		if( enableTurboJPEG(true) && !benchmarkImage(filename, cmdLine) )
+			result = 1;
+	}
+
+	return result;
+}
@@ -30,8 +30,8 @@
 
 /**
  * The imageFormat enum is used to identify the pixel format and colorspace
- * of an image.  Supported data types are based on `uint8` and `float`, with
- * colorspaces including RGB/RGBA, BGR/BGRA, grayscale, YUV, and Bayer.
+ * of an image.  Supported data types are based on `uint8`, `uint16` and `float`,
+ * with colorspaces including RGB/RGBA, BGR/BGRA, grayscale, YUV, and Bayer.
  *
  * There are also a variety of helper functions available that provide info about
  * each format at runtime - for example, the pixel bit depth (imageFormatDepth())
@@ -79,6 +79,16 @@ enum imageFormat
 	IMAGE_GRAY8,					/**< uint8 grayscale  (`'gray8'`)   */
 	IMAGE_GRAY32F,					/**< float grayscale  (`'gray32f'`) */
 
+	// 16-bit
+	IMAGE_RGB16,					/**< ushort3 RGB16  (`'rgb16'`) */
+	IMAGE_RGBA16,					/**< ushort4 RGBA16 (`'rgba16'`) */
+	IMAGE_GRAY16,					/**< uint16 grayscale (`'gray16'`) */
+
+	// YUV (semi-planar)
+	IMAGE_NV16,					/**< YUV NV16 4:2:2 semi-planar (`'nv16'`) */
+	IMAGE_P010,					/**< YUV P010 4:2:0 semi-planar, 10-bit samples in the MSBs of 16 bits (`'p010'`) */
+	IMAGE_P016,					/**< YUV P016 4:2:0 semi-planar, 16-bit samples (`'p016'`) */
+
 	// extras
 	IMAGE_COUNT,					/**< The number of image formats */
 	IMAGE_UNKNOWN=999,				/**< Unknown/undefined format */
@@ -87,8 +97,8 @@ enum imageFormat
 
 /**
  * The imageBaseType enum is used to identify the base data type of an
- * imageFormat - either uint8 or float.  For example, the IMAGE_RGB8 
- * format has a base type of uint8, while IMAGE_RGB32F is float.
+ * imageFormat - either uint8, uint16 or float.  For example, the IMAGE_RGB8 
+ * format has a base type of uint8, IMAGE_RGB16 is uint16, and IMAGE_RGB32F is float.
  *
  * You can retrieve the base type of each format with imageFormatBaseType()
  *
@@ -97,11 +107,12 @@ enum imageFormat
 enum imageBaseType
 {
 	IMAGE_UINT8,
-	IMAGE_FLOAT
+	IMAGE_FLOAT,
+	IMAGE_UINT16
 };
 
 /**
- * Get the base type of an image format (uint8 or float).
+ * Get the base type of an image format (uint8, uint16 or float).
  * @see imageBaseType
  * @ingroup imageFormat
  */
@@ -135,7 +146,8 @@ inline size_t imageFormatChannels( imageFormat format );
  * The bit depth is the size in bits of each pixel in the image. For example,
  * IMAGE_RGB8 has a bit depth of 24.  This function returns bits instead of bytes, 
  * because some formats have a bit depth that's not evenly divisible by 8 (a byte).
- * YUV 4:2:0 formats like I420, YV12, and NV12 have a depth of 12 bits.  
+ * YUV 4:2:0 formats like I420, YV12, and NV12 have a depth of 12 bits, while
+ * P010 and P016 (which use 16-bit samples) have a depth of 24 bits.
  *
  * If you are calculating the overall size of an image, it's recommended to use
  * the imageFormatSize() function instead.  It will automatically convert to bytes.
@@ -154,7 +166,7 @@ inline size_t imageFormatSize( imageFormat format, size_t width, size_t height )
  * Check if an image format is one of the RGB/RGBA formats.
  *
  * @returns true if the imageFormat is a RGB/RGBA format 
- *               (IMAGE_RGB8, IMAGE_RGBA8, IMAGE_RGB32F, IMAGE_RGBA32F)
+ *               (IMAGE_RGB8, IMAGE_RGBA8, IMAGE_RGB32F, IMAGE_RGBA32F, IMAGE_RGB16, IMAGE_RGBA16)
  *               otherwise, returns false.
  * @ingroup imageFormat
  */
@@ -174,7 +186,8 @@ inline bool imageFormatIsBGR( imageFormat format );
  * Check if an image format is one of the YUV formats.
  *
  * @returns true if the imageFormat is a YUV format 
- *               (IMAGE_YUYV, IMAGE_YVYU, IMAGE_UYVY, IMAGE_I420, IMAGE_YV12, IMAGE_NV12)
+ *               (IMAGE_YUYV, IMAGE_YVYU, IMAGE_UYVY, IMAGE_I420, IMAGE_YV12, IMAGE_NV12,
+ *                IMAGE_NV16, IMAGE_P010, IMAGE_P016)
  *               otherwise, returns false.
  * @ingroup imageFormat
  */
@@ -183,7 +196,7 @@ inline bool imageFormatIsYUV( imageFormat format );
 /**
  * Check if an image format is one of the grayscale formats.
  *
- * @returns true if the imageFormat is grayscale (IMAGE_GRAY8, IMAGE_GRAY32)
+ * @returns true if the imageFormat is grayscale (IMAGE_GRAY8, IMAGE_GRAY16, IMAGE_GRAY32F)
  *               otherwise, returns false.
  * @ingroup imageFormat
  */
@@ -217,11 +230,13 @@ inline void imageFormatErrorMsg( const char* module, const char* function, image
 
 ///@{
 
-// get the IMAGE_RGB* formats from uchar3/uchar4/float3/float4
+// get the IMAGE_RGB* formats from uchar3/uchar4/ushort3/ushort4/float3/float4
 template<typename T> inline imageFormat imageFormatFromType();
 
 template<> inline imageFormat imageFormatFromType<uchar3>();
 template<> inline imageFormat imageFormatFromType<uchar4>();
+template<> inline imageFormat imageFormatFromType<ushort3>();
+template<> inline imageFormat imageFormatFromType<ushort4>();
 template<> inline imageFormat imageFormatFromType<float3>();
 template<> inline imageFormat imageFormatFromType<float4>();
 
@@ -231,6 +246,9 @@ template<imageFormat format> struct imageFormatType;
 template<> struct imageFormatType<IMAGE_RGB8>    { typedef uint8_t Base; typedef uchar3 Vector; };
 template<> struct imageFormatType<IMAGE_RGBA8>   { typedef uint8_t Base; typedef uchar4 Vector; };
 
+template<> struct imageFormatType<IMAGE_RGB16>   { typedef uint16_t Base; typedef ushort3 Vector; };
+template<> struct imageFormatType<IMAGE_RGBA16>  { typedef uint16_t Base; typedef ushort4 Vector; };
+
 template<> struct imageFormatType<IMAGE_RGB32F>  { typedef float Base; typedef float3 Vector; };
 template<> struct imageFormatType<IMAGE_RGBA32F> { typedef float Base; typedef float4 Vector; };
 
@@ -52,6 +52,12 @@ inline const char* imageFormatToStr( imageFormat format )
 		case IMAGE_BAYER_RGGB:	return "bayer-rggb";
 		case IMAGE_GRAY8:	 	return "gray8";
 		case IMAGE_GRAY32F:  	return "gray32f";
+		case IMAGE_RGB16:		return "rgb16";
+		case IMAGE_RGBA16:		return "rgba16";
+		case IMAGE_GRAY16:		return "gray16";
+		case IMAGE_NV16:		return "nv16";
+		case IMAGE_P010:		return "p010";
+		case IMAGE_P016:		return "p016";
 		case IMAGE_UNKNOWN: 	return "unknown";
 	};
 	
@@ -65,6 +71,9 @@ inline bool imageFormatIsRGB( imageFormat format )
 	//	return true;
 	if( format >= IMAGE_RGB8 && format <= IMAGE_RGBA32F )
 		return true;
+
+	if( format == IMAGE_RGB16 || format == IMAGE_RGBA16 )
+		return true;
 	
 	return false;
 }
@@ -83,6 +92,9 @@ inline bool imageFormatIsYUV( imageFormat format )
 {
 	if( format >= IMAGE_YUYV && format <= IMAGE_NV12 )
 		return true;
+
+	if( format >= IMAGE_NV16 && format <= IMAGE_P016 )
+		return true;
 		
 	return false;
 }
@@ -90,7 +102,7 @@ inline bool imageFormatIsYUV( imageFormat format )
 // imageFormatIsGray
 inline bool imageFormatIsGray( imageFormat format )
 {
-	if( format == IMAGE_GRAY8 || format == IMAGE_GRAY32F )
+	if( format == IMAGE_GRAY8 || format == IMAGE_GRAY16 || format == IMAGE_GRAY32F )
 		return true;
 	
 	return false;
@@ -129,6 +141,8 @@ inline imageFormat imageFormatFromStr( const char* str )
 		return IMAGE_RGBA32F;
 	else if( strcasecmp(str, "grey8") == 0 )
 		return IMAGE_GRAY8;
+	else if( strcasecmp(str, "grey16") == 0 )
+		return IMAGE_GRAY16;
 	else if( strcasecmp(str, "grey32f") == 0 )
 		return IMAGE_GRAY32F;
 
@@ -146,6 +160,11 @@ inline imageBaseType imageFormatBaseType( imageFormat format )
 		case IMAGE_BGR32F:		
 		case IMAGE_RGBA32F: 
 		case IMAGE_BGRA32F:		return IMAGE_FLOAT;
+		case IMAGE_GRAY16:
+		case IMAGE_RGB16:
+		case IMAGE_RGBA16:
+		case IMAGE_P010:
+		case IMAGE_P016:		return IMAGE_UINT16;
 	}
 
 	return IMAGE_UINT8;
@@ -160,16 +179,22 @@ inline size_t imageFormatChannels( imageFormat format )
 		case IMAGE_RGB8:
 		case IMAGE_RGB32F:
 		case IMAGE_BGR8:
-		case IMAGE_BGR32F:		return 3;
+		case IMAGE_BGR32F:
+		case IMAGE_RGB16:		return 3;
 		case IMAGE_RGBA8:
 		case IMAGE_RGBA32F:
 		case IMAGE_BGRA8:
-		case IMAGE_BGRA32F: 	return 4;
+		case IMAGE_BGRA32F:
+		case IMAGE_RGBA16: 		return 4;
 		case IMAGE_GRAY8:
+		case IMAGE_GRAY16:
 		case IMAGE_GRAY32F:		return 1;
 		case IMAGE_I420:
 		case IMAGE_YV12:
 		case IMAGE_NV12:
+		case IMAGE_NV16:
+		case IMAGE_P010:
+		case IMAGE_P016:
 		case IMAGE_UYVY:
 		case IMAGE_YUYV:		
 		case IMAGE_YVYU:		return 3;
@@ -198,9 +223,15 @@ inline size_t imageFormatDepth( imageFormat format )
 		case IMAGE_BGRA32F:		return sizeof(float4) * 8;
 		case IMAGE_GRAY8:		return sizeof(unsigned char) * 8;
 		case IMAGE_GRAY32F:		return sizeof(float) * 8;
+		case IMAGE_RGB16:		return sizeof(ushort3) * 8;
+		case IMAGE_RGBA16:		return sizeof(ushort4) * 8;
+		case IMAGE_GRAY16:		return sizeof(uint16_t) * 8;
 		case IMAGE_I420:
 		case IMAGE_YV12:
 		case IMAGE_NV12:		return 12;
+		case IMAGE_P010:
+		case IMAGE_P016:		return 24;
+		case IMAGE_NV16:
 		case IMAGE_UYVY:
 		case IMAGE_YUYV:		
 		case IMAGE_YVYU:		return 16;
@@ -231,12 +262,14 @@ template<typename T> struct __image_format_assert_false : std::false_type { };
 // imageFormatFromType
 template<typename T> inline imageFormat imageFormatFromType()	
 { 
-	static_assert(__image_format_assert_false<T>::value, "invalid image format type - supported types are uchar3, uchar4, float3, float4"); 
+	static_assert(__image_format_assert_false<T>::value, "invalid image format type - supported types are uchar3, uchar4, ushort3, ushort4, float3, float4"); 
 	return IMAGE_UNKNOWN;
 }
 
 template<> inline imageFormat imageFormatFromType<uchar3>()	{ return IMAGE_RGB8; }
 template<> inline imageFormat imageFormatFromType<uchar4>()	{ return IMAGE_RGBA8; }
+template<> inline imageFormat imageFormatFromType<ushort3>()	{ return IMAGE_RGB16; }
+template<> inline imageFormat imageFormatFromType<ushort4>()	{ return IMAGE_RGBA16; }
 template<> inline imageFormat imageFormatFromType<float3>()	{ return IMAGE_RGB32F; }
 template<> inline imageFormat imageFormatFromType<float4>()	{ return IMAGE_RGBA32F; }
 
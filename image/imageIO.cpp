@@ -37,7 +37,12 @@
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "stb/stb_image_resize.h"
 
+#ifdef ENABLE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
 #include <memory>
+#include <vector>
 
 
 namespace {
@@ -47,8 +52,225 @@ namespace {
     using StbBuffer = std::unique_ptr<unsigned char[], Deleter>;
 }
 
+
+#ifdef ENABLE_TURBOJPEG
+static bool turboEnabled = true;
+#else
+static bool turboEnabled = false;
+#endif
+
+
+// enableTurboJPEG
+bool enableTurboJPEG( bool enable )
+{
+#ifdef ENABLE_TURBOJPEG
+	turboEnabled = enable;
+#else
+	if( enable )
+		LogWarning(LOG_IMAGE "libjpeg-turbo support wasn't enabled when jetson-utils was built (ENABLE_TURBOJPEG)\n");
+#endif
+	return turboEnabled;
+}
+
+
+// isTurboJPEGEnabled
+bool isTurboJPEGEnabled()
+{
+	return turboEnabled;
+}
+
+
+// isJPEG (internal)
+static bool isJPEG( const char* filename )
+{
+	const std::string ext = fileExtension(filename);
+	return (strcasecmp(ext.c_str(), "jpg") == 0 || strcasecmp(ext.c_str(), "jpeg") == 0);
+}
+
+
+#ifdef ENABLE_TURBOJPEG
+
+// turboPixelFormat (internal)
+static int turboPixelFormat( int channels )
+{
+	switch(channels)
+	{
+		case 1:  return TJPF_GRAY;
+		case 3:  return TJPF_RGB;
+		case 4:  return TJPF_RGBA;
+	}
+
+	return -1;
+}
+
+
+// loadJPEG (internal)
+//  decodes a JPEG with libjpeg-turbo, scaling it down by 1/2, 1/4, or 1/8 while it's decoded
+//  if the image would still be at least as large as the requested size (resizeWidth x resizeHeight)
+static StbBuffer loadJPEG( const char* path, int resizeWidth, int resizeHeight, int* width, int* height, int* channels )
+{
+	std::vector<unsigned char> jpeg;
+
+	FILE* file = fopen(path, "rb");
+
+	if( !file )
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if( size > 0 )
+	{
+		jpeg.resize(size);
+
+		if( fread(jpeg.data(), 1, size, file) != (size_t)size )
+			jpeg.clear();
+	}
+
+	fclose(file);
+
+	if( jpeg.size() == 0 )
+		return NULL;
+
+	tjhandle handle = tjInitDecompress();
+
+	if( !handle )
+		return NULL;
+
+	int jpegWidth = 0;
+	int jpegHeight = 0;
+	int jpegSubsamp = 0;
+	int jpegColorspace = 0;
+
+	if( tjDecompressHeader3(handle, jpeg.data(), jpeg.size(), &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace) != 0 )
+	{
+		LogVerbose(LOG_IMAGE "libjpeg-turbo failed to read header of '%s' (%s)\n", path, tjGetErrorStr2(handle));
+		tjDestroy(handle);
+		return NULL;
+	}
+
+	// keep grayscale JPEG's as 1 channel unless another number was requested
+	int imgChannels = *channels;
+
+	if( imgChannels == 0 )
+		imgChannels = (jpegColorspace == TJCS_GRAY) ? 1 : 3;
+
+	const int pixelFormat = turboPixelFormat(imgChannels);
+
+	if( pixelFormat < 0 )
+	{
+		tjDestroy(handle);
+		return NULL;
+	}
+
+	// pick the smallest DCT scaling factor that's still at least the requested size
+	tjscalingfactor scale = { 1, 1 };
+
+	if( resizeWidth > 0 && resizeHeight > 0 )
+	{
+		for( int denom=8; denom > 1; denom /= 2 )
+		{
+			const tjscalingfactor factor = { 1, denom };
+
+			if( TJSCALED(jpegWidth, factor) >= resizeWidth && TJSCALED(jpegHeight, factor) >= resizeHeight )
+			{
+				scale = factor;
+				break;
+			}
+		}
+	}
+
+	const int imgWidth  = TJSCALED(jpegWidth, scale);
+	const int imgHeight = TJSCALED(jpegHeight, scale);
+
+	auto img = StbBuffer((unsigned char*)STBI_MALLOC(imgWidth * imgHeight * imgChannels));
+
+	if( !img )
+	{
+		tjDestroy(handle);
+		return NULL;
+	}
+
+	if( tjDecompress2(handle, jpeg.data(), jpeg.size(), img.get(), imgWidth, 0, imgHeight, pixelFormat, 0) != 0 )
+	{
+		LogVerbose(LOG_IMAGE "libjpeg-turbo failed to decode '%s' (%s)\n", path, tjGetErrorStr2(handle));
+		tjDestroy(handle);
+		return NULL;
+	}
+
+	tjDestroy(handle);
+
+	if( scale.denom > 1 )
+		LogVerbose(LOG_IMAGE "decoded '%s' at 1/%i scale (%ix%i)\n", path, scale.denom, imgWidth, imgHeight);
+
+	*width = imgWidth;
+	*height = imgHeight;
+	*channels = imgChannels;
+
+	return img;
+}
+
+
+// compressJPEG (internal)
+//  the JPEG returned should be released with tjFree()
+static bool compressJPEG( const unsigned char* img, int width, int height, int channels, int quality, unsigned char** jpeg, unsigned long* jpegSize )
+{
+	const int pixelFormat = turboPixelFormat(channels);
+
+	if( pixelFormat < 0 )
+		return false;
+
+	tjhandle handle = tjInitCompress();
+
+	if( !handle )
+		return false;
+
+	*jpeg = NULL;
+	*jpegSize = 0;
+
+	// use the same chroma subsampling as stb_image_write
+	const int subsamp = (channels == 1) ? TJSAMP_GRAY : (quality <= 90) ? TJSAMP_420 : TJSAMP_444;
+
+	if( tjCompress2(handle, img, width, 0, height, pixelFormat, jpeg, jpegSize, subsamp, quality, 0) != 0 )
+	{
+		LogError(LOG_IMAGE "libjpeg-turbo failed to encode %ix%i image (%s)\n", width, height, tjGetErrorStr2(handle));
+		tjDestroy(handle);
+		return false;
+	}
+
+	tjDestroy(handle);
+	return true;
+}
+
+
+// saveJPEG (internal)
+static bool saveJPEG( const char* filename, const unsigned char* img, int width, int height, int channels, int quality )
+{
+	unsigned char* jpeg = NULL;
+	unsigned long jpegSize = 0;
+
+	if( !compressJPEG(img, width, height, channels, quality, &jpeg, &jpegSize) )
+		return false;
+
+	FILE* file = fopen(filename, "wb");
+	bool result = false;
+
+	if( file != NULL )
+	{
+		result = (fwrite(jpeg, 1, jpegSize, file) == jpegSize);
+		fclose(file);
+	}
+
+	tjFree(jpeg);
+	return result;
+}
+
+#endif
+
 // loadImageIO (internal)
-static StbBuffer loadImageIO( const char* filename, int* width, int* height, int* channels )
+//  if highBitDepth is true, the buffer contains 16-bit samples (8-bit files are expanded to 16-bit)
+static StbBuffer loadImageIO( const char* filename, int* width, int* height, int* channels, bool highBitDepth=false )
 {
 	// validate parameters
 	if( !filename || !width || !height || !channels )
@@ -71,7 +293,22 @@ static StbBuffer loadImageIO( const char* filename, int* width, int* height, int
 	int imgHeight = 0;
 	int imgChannels = 0;
 
-	auto img = StbBuffer(stbi_load(path.c_str(), &imgWidth, &imgHeight, &imgChannels, *channels));
+	const size_t sampleSize = highBitDepth ? sizeof(uint16_t) : sizeof(unsigned char);
+
+	StbBuffer img;
+
+#ifdef ENABLE_TURBOJPEG
+	// decode JPEG's with libjpeg-turbo (falling back to stb_image if it fails)
+	if( turboEnabled && !highBitDepth && isJPEG(path.c_str()) )
+	{
+		imgChannels = *channels;
+		img = loadJPEG(path.c_str(), *width, *height, &imgWidth, &imgHeight, &imgChannels);
+	}
+#endif
+
+	if( !img )
+		img = StbBuffer(highBitDepth ? (unsigned char*)stbi_load_16(path.c_str(), &imgWidth, &imgHeight, &imgChannels, *channels)
+							   : stbi_load(path.c_str(), &imgWidth, &imgHeight, &imgChannels, *channels));
 
 	if( !img )
 	{
@@ -96,14 +333,15 @@ static StbBuffer loadImageIO( const char* filename, int* width, int* height, int
 	const int resizeWidth  = *width;
 	const int resizeHeight = *height;
 
-	if( resizeWidth > 0 && resizeHeight > 0 && resizeWidth != imgWidth && resizeHeight != imgHeight )
+	// (the JPEG decoder may have already scaled it down, so either dimension can still differ)
+	if( resizeWidth > 0 && resizeHeight > 0 && (resizeWidth != imgWidth || resizeHeight != imgHeight) )
 	{
 		const auto img_org = std::move(img);
 
 		LogVerbose(LOG_IMAGE "resizing '%s' to %ix%i\n", filename, resizeWidth, resizeHeight);
 
 		// allocate memory for the resized image
-		img.reset(new unsigned char[resizeWidth * resizeHeight * imgChannels * sizeof(unsigned char)]);
+		img.reset((unsigned char*)STBI_MALLOC(resizeWidth * resizeHeight * imgChannels * sampleSize));
 
 		if( !img )
 		{
@@ -112,8 +350,22 @@ static StbBuffer loadImageIO( const char* filename, int* width, int* height, int
 		}
 
 		// resize the original image
-		if( !stbir_resize_uint8(img_org.get(), imgWidth, imgHeight, 0,
-						    img.get(), resizeWidth, resizeHeight, 0, imgChannels) )
+		int resize_result = 0;
+
+		if( highBitDepth )
+		{
+			resize_result = stbir_resize_uint16_generic((uint16_t*)img_org.get(), imgWidth, imgHeight, 0,
+											    (uint16_t*)img.get(), resizeWidth, resizeHeight, 0, imgChannels,
+											    (imgChannels == 4) ? 3 : STBIR_ALPHA_CHANNEL_NONE, 0,
+											    STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT, STBIR_COLORSPACE_LINEAR, NULL);
+		}
+		else
+		{
+			resize_result = stbir_resize_uint8(img_org.get(), imgWidth, imgHeight, 0,
+									     img.get(), resizeWidth, resizeHeight, 0, imgChannels);
+		}
+
+		if( !resize_result )
 		{
 			LogError(LOG_IMAGE "failed to resize '%s' to %ix%i\n", filename, resizeWidth, resizeHeight);
 			return NULL;
@@ -125,6 +377,12 @@ static StbBuffer loadImageIO( const char* filename, int* width, int* height, int
 
 	}	
 
+	if( resizeWidth > 0 && resizeHeight > 0 && (imgWidth != resizeWidth || imgHeight != resizeHeight) )
+	{
+		LogError(LOG_IMAGE "'%s' was loaded at %ix%i instead of the requested %ix%i\n", filename, imgWidth, imgHeight, resizeWidth, resizeHeight);
+		return NULL;
+	}
+
 	*width = imgWidth;
 	*height = imgHeight;
 	*channels = imgChannels;
@@ -144,24 +402,31 @@ bool loadImage( const char* filename, void** output, int* width, int* height, im
 	}
 
 	// check that the requested format is supported
-	if( !imageFormatIsRGB(format) )
+	if( !imageFormatIsRGB(format) && !imageFormatIsGray(format) )
 	{
 		LogError(LOG_IMAGE "loadImage() -- unsupported output image format requested (%s)\n", imageFormatToStr(format));
 		LogError(LOG_IMAGE "               supported output formats are:\n");
 		LogError(LOG_IMAGE "                   * rgb8\n");		
 		LogError(LOG_IMAGE "                   * rgba8\n");		
+		LogError(LOG_IMAGE "                   * rgb16\n");		
+		LogError(LOG_IMAGE "                   * rgba16\n");		
 		LogError(LOG_IMAGE "                   * rgb32\n");		
 		LogError(LOG_IMAGE "                   * rgba32\n");
+		LogError(LOG_IMAGE "                   * gray8\n");
+		LogError(LOG_IMAGE "                   * gray16\n");
+		LogError(LOG_IMAGE "                   * gray32\n");
 
 		return NULL;
 	}
 
-	// attempt to load the data from disk
+	// attempt to load the data from disk (16-bit formats keep the full bit depth)
+	const imageBaseType baseType = imageFormatBaseType(format);
+
 	int imgWidth = *width;
 	int imgHeight = *height;
 	int imgChannels = imageFormatChannels(format);
 
-	auto img = loadImageIO(filename, &imgWidth, &imgHeight, &imgChannels);
+	auto img = loadImageIO(filename, &imgWidth, &imgHeight, &imgChannels, baseType == IMAGE_UINT16);
 	
 	if( !img )
 		return false;	
@@ -176,9 +441,9 @@ bool loadImage( const char* filename, void** output, int* width, int* height, im
 	}
 
 	// convert from uint8 to float
-	if( format == IMAGE_RGB32F || format == IMAGE_RGBA32F )
+	if( baseType == IMAGE_FLOAT )
 	{
-		const imageFormat inputFormat = (imgChannels == 3) ? IMAGE_RGB8 : IMAGE_RGBA8;
+		const imageFormat inputFormat = (imgChannels == 1) ? IMAGE_GRAY8 : (imgChannels == 3) ? IMAGE_RGB8 : IMAGE_RGBA8;
 		const size_t inputImageSize = imageFormatSize(inputFormat, imgWidth, imgHeight);
 
 		void* inputImgGPU = NULL;
@@ -201,7 +466,7 @@ bool loadImage( const char* filename, void** output, int* width, int* height, im
 	}
 	else
 	{
-		// uint8 output can be straight copied to GPU memory
+		// uint8/uint16 output can be straight copied to GPU memory
 		memcpy(*output, img.get(), imgSize);
 	}
 
@@ -246,6 +511,103 @@ bool loadImageRGBA( const char* filename, float4** cpu, float4** gpu, int* width
 }*/
 
 
+// savePNG16 (internal)
+//  stb_image_write only supports 8-bit PNG, so the 16-bit PNG chunks are assembled here
+//  from the same zlib compression and scanline filters used by stbi_write_png()
+static bool savePNG16( const char* filename, const uint16_t* img, int width, int height, int channels, int compression )
+{
+	const int ctype[5] = { -1, 0, 4, 2, 6 };	// PNG color types (gray, gray+alpha, RGB, RGBA)
+	const int pixelSize = channels * sizeof(uint16_t);
+	const int rowSize = width * pixelSize;
+
+	// PNG stores 16-bit samples as big-endian
+	std::vector<unsigned char> samples(rowSize * height);
+
+	for( size_t n=0; n < samples.size() / 2; n++ )
+	{
+		samples[n * 2 + 0] = img[n] >> 8;
+		samples[n * 2 + 1] = img[n] & 0xFF;
+	}
+
+	// filter each row with the filter that has the lowest estimated entropy
+	std::vector<unsigned char> filtered((rowSize + 1) * height);
+	std::vector<signed char> line(rowSize);
+
+	for( int y=0; y < height; y++ )
+	{
+		int bestFilter = 0;
+		int bestEstimate = 0x7fffffff;
+
+		for( int filter=0; filter < 5; filter++ )
+		{
+			stbiw__encode_png_line(samples.data(), rowSize, width, height, y, pixelSize, filter, line.data());
+
+			int estimate = 0;
+
+			for( int i=0; i < rowSize; i++ )
+				estimate += abs(line[i]);
+
+			if( estimate < bestEstimate )
+			{
+				bestEstimate = estimate;
+				bestFilter = filter;
+			}
+		}
+
+		stbiw__encode_png_line(samples.data(), rowSize, width, height, y, pixelSize, bestFilter, line.data());
+
+		filtered[y * (rowSize + 1)] = bestFilter;
+		memcpy(&filtered[y * (rowSize + 1) + 1], line.data(), rowSize);
+	}
+
+	int zlen = 0;
+	unsigned char* zlib = stbi_zlib_compress(filtered.data(), filtered.size(), &zlen, compression);
+
+	if( !zlib )
+		return false;
+
+	// assemble the PNG signature and IHDR/IDAT/IEND chunks
+	std::vector<unsigned char> png(8 + 12 + 13 + 12 + zlen + 12);
+	unsigned char* o = png.data();
+
+	const unsigned char sig[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+	memcpy(o, sig, 8); o += 8;
+	stbiw__wp32(o, 13);
+	stbiw__wptag(o, "IHDR");
+	stbiw__wp32(o, width);
+	stbiw__wp32(o, height);
+	*o++ = 16;	// bit depth
+	*o++ = ctype[channels];
+	*o++ = 0;
+	*o++ = 0;
+	*o++ = 0;
+	stbiw__wpcrc(&o, 13);
+
+	stbiw__wp32(o, zlen);
+	stbiw__wptag(o, "IDAT");
+	memcpy(o, zlib, zlen);
+	o += zlen;
+	STBIW_FREE(zlib);
+	stbiw__wpcrc(&o, zlen);
+
+	stbiw__wp32(o, 0);
+	stbiw__wptag(o, "IEND");
+	stbiw__wpcrc(&o, 0);
+
+	// write the file
+	FILE* file = fopen(filename, "wb");
+
+	if( !file )
+		return false;
+
+	const bool result = (fwrite(png.data(), 1, png.size(), file) == png.size());
+
+	fclose(file);
+	return result;
+}
+
+
 // saveImage
 bool saveImage( const char* filename, void* ptr, int width, int height, imageFormat format, int quality, const float2& pixel_range, bool sync, cudaStream_t stream )
 {
@@ -269,24 +631,40 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
 		LogError(LOG_IMAGE "               supported input image formats are:\n");
 		LogError(LOG_IMAGE "                   * rgb8\n");		
 		LogError(LOG_IMAGE "                   * rgba8\n");		
+		LogError(LOG_IMAGE "                   * rgb16\n");		
+		LogError(LOG_IMAGE "                   * rgba16\n");		
 		LogError(LOG_IMAGE "                   * rgb32f\n");		
 		LogError(LOG_IMAGE "                   * rgba32f\n");
 		LogError(LOG_IMAGE "                   * gray8\n");
+		LogError(LOG_IMAGE "                   * gray16\n");
 		LogError(LOG_IMAGE "                   * gray32\n");
 
 		return false;
 	}
 	
+	// determine the file extension
+	const std::string ext = fileExtension(filename);
+	const char* extension = ext.c_str();
+
+	if( ext.size() == 0 )
+	{
+		LogError(LOG_IMAGE "invalid filename or extension, '%s'\n", filename);
+		return false;
+	}
+
+	const bool isPNG = (strcasecmp(extension, "png") == 0);
+
 	// allocate memory for the uint8 image
 	const size_t channels = imageFormatChannels(format);
 	const size_t stride   = width * sizeof(unsigned char) * channels;
 	const size_t size     = stride * height;
 	unsigned char* img    = (unsigned char*)ptr;
 
-	// if needed, convert from float to uint8
+	// if needed, convert from float to uint8 (16-bit images are only kept for PNG)
 	const imageBaseType baseType = imageFormatBaseType(format);
+	const bool convert = (baseType == IMAGE_FLOAT) || (baseType == IMAGE_UINT16 && !isPNG);
 
-	if( baseType == IMAGE_FLOAT )
+	if( convert )
 	{
 		imageFormat outputFormat = IMAGE_UNKNOWN;
 
@@ -321,28 +699,23 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
 	}
 	
 	#define release_return(x) 	\
-		if( baseType == IMAGE_FLOAT ) \
+		if( convert ) \
 			CUDA(cudaFreeHost(img)); \
 		return x;
-	
-	// determine the file extension
-	const std::string ext = fileExtension(filename);
-	const char* extension = ext.c_str();
-
-	if( ext.size() == 0 )
-	{
-		LogError(LOG_IMAGE "invalid filename or extension, '%s'\n", filename);
-		release_return(false);
-	}
 
 	// save the image
 	int save_result = 0;
 
-	if( strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0 )
+	if( isJPEG(filename) )
 	{
-		save_result = stbi_write_jpg(filename, width, height, channels, img, quality);
+	#ifdef ENABLE_TURBOJPEG
+		if( turboEnabled && channels != 2 )
+			save_result = saveJPEG(filename, img, width, height, channels, quality);
+	#endif
+		if( !save_result )
+			save_result = stbi_write_jpg(filename, width, height, channels, img, quality);
 	}
-	else if( strcasecmp(extension, "png") == 0 )
+	else if( isPNG )
 	{
 		// convert quality from 1-100 to 0-9 (where 0 is high quality)
 		quality = (100 - quality) / 10;
@@ -356,7 +729,10 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
 		stbi_write_png_compression_level = quality;
 
 		// write the PNG file
-		save_result = stbi_write_png(filename, width, height, channels, img, stride);
+		if( baseType == IMAGE_UINT16 )
+			save_result = savePNG16(filename, (uint16_t*)img, width, height, channels, quality);
+		else
+			save_result = stbi_write_png(filename, width, height, channels, img, stride);
 	}
 	else if( strcasecmp(extension, "tga") == 0 )
 	{
@@ -398,6 +774,65 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
 }
 
 
+// stb_image_write callback for encodeJPEG()
+static void appendJPEG( void* context, void* data, int size )
+{
+	std::vector<unsigned char>* jpeg = (std::vector<unsigned char>*)context;
+	jpeg->insert(jpeg->end(), (unsigned char*)data, (unsigned char*)data + size);
+}
+
+
+// encodeJPEG
+bool encodeJPEG( const void* ptr, int width, int height, imageFormat format, std::vector<unsigned char>& jpeg, int quality )
+{
+	if( !ptr || width <= 0 || height <= 0 )
+	{
+		LogError(LOG_IMAGE "encodeJPEG() -- invalid parameter\n");
+		return false;
+	}
+
+	if( format != IMAGE_RGB8 && format != IMAGE_RGBA8 && format != IMAGE_GRAY8 )
+	{
+		LogError(LOG_IMAGE "encodeJPEG() -- unsupported image format (%s)\n", imageFormatToStr(format));
+		LogError(LOG_IMAGE "                supported formats are rgb8, rgba8, and gray8\n");
+		return false;
+	}
+
+	if( quality < 1 )
+		quality = 1;
+
+	if( quality > 100 )
+		quality = 100;
+
+	const int channels = imageFormatChannels(format);
+
+	jpeg.clear();
+
+#ifdef ENABLE_TURBOJPEG
+	if( turboEnabled )
+	{
+		unsigned char* compressed = NULL;
+		unsigned long compressedSize = 0;
+
+		if( compressJPEG((const unsigned char*)ptr, width, height, channels, quality, &compressed, &compressedSize) )
+		{
+			jpeg.assign(compressed, compressed + compressedSize);
+			tjFree(compressed);
+			return true;
+		}
+	}
+#endif
+
+	if( !stbi_write_jpg_to_func(appendJPEG, &jpeg, width, height, channels, ptr, quality) )
+	{
+		LogError(LOG_IMAGE "encodeJPEG() -- failed to encode %ix%i image\n", width, height);
+		return false;
+	}
+
+	return true;
+}
+
+
 // saveImageRGBA
 bool saveImageRGBA( const char* filename, float4* ptr, int width, int height, float max_pixel, int quality, cudaStream_t stream )
 {
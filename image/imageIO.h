@@ -27,9 +27,12 @@
 #include "cudaUtility.h"
 #include "imageFormat.h"
 
+#include <vector>
+
 
 /**
- * Load a color image from disk into CUDA memory, in uchar3/uchar4/float3/float4 formats with pixel values 0-255.
+ * Load a color image from disk into CUDA memory, in uchar3/uchar4/float3/float4 formats with pixel values 0-255,
+ * or in ushort3/ushort4 formats with pixel values 0-65535 (16-bit PNG files keep their full bit depth).
  *
  * Supported image file formats by loadImage() include:
  * 
@@ -61,7 +64,8 @@
 template<typename T> bool loadImage( const char* filename, T** ptr, int* width, int* height, cudaStream_t stream=0 )		{ return loadImage(filename, (void**)ptr, width, height, imageFormatFromType<T>(), stream); }
 	
 /**
- * Load a color image from disk into CUDA memory, in uchar3/uchar4/float3/float4 formats with pixel values 0-255.
+ * Load a color image from disk into CUDA memory, in uchar3/uchar4/float3/float4 formats with pixel values 0-255,
+ * or in ushort3/ushort4 formats with pixel values 0-65535 (16-bit PNG files keep their full bit depth).
  *
  * Supported image file formats by loadImage() include:
  * 
@@ -125,10 +129,12 @@ bool loadImageRGBA( const char* filename, float4** cpu, float4** gpu, int* width
  * Supported image file formats by saveImage() include:  
  *
  *   - JPG
- *   - PNG
+ *   - PNG (including 16-bit PNG for the IMAGE_RGB16, IMAGE_RGBA16, and IMAGE_GRAY16 formats)
  *   - TGA
  *   - BMP
  *
+ * 16-bit images saved to the other file formats are first converted to 8-bit.
+ *
  * @param filename Desired path of the image file to save to disk.
  * @param ptr Pointer to the buffer containing the image in shared CPU/GPU zero-copy memory.
  * @param width Width of the image in pixels.
@@ -159,10 +165,12 @@ template<typename T> bool saveImage( const char* filename, T* ptr, int width, in
  * Supported image file formats by saveImage() include:  
  *
  *   - JPG
- *   - PNG
+ *   - PNG (including 16-bit PNG for the IMAGE_RGB16, IMAGE_RGBA16, and IMAGE_GRAY16 formats)
  *   - TGA
  *   - BMP
  *
+ * 16-bit images saved to the other file formats are first converted to 8-bit.
+ *
  * @param filename Desired path of the image file to save to disk.
  * @param ptr Pointer to the buffer containing the image in shared CPU/GPU zero-copy memory.
  * @param width Width of the image in pixels.
@@ -192,10 +200,12 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
  * Supported image file formats by saveImage() include:  
  *
  *   - JPG
- *   - PNG
+ *   - PNG (including 16-bit PNG for the IMAGE_RGB16, IMAGE_RGBA16, and IMAGE_GRAY16 formats)
  *   - TGA
  *   - BMP
  *
+ * 16-bit images saved to the other file formats are first converted to 8-bit.
+ *
  * @param filename Desired path of the image file to save to disk.
  * @param ptr Pointer to the buffer containing the image in shared CPU/GPU zero-copy memory.
  * @param width Width of the image in pixels.
@@ -222,6 +232,50 @@ bool saveImage( const char* filename, void* ptr, int width, int height, imageFor
 bool saveImageRGBA( const char* filename, float4* ptr, int width, int height, float max_pixel=255.0f, int quality=100, cudaStream_t stream=0 );
 
 
+/**
+ * Compress an image to JPEG in memory, for example to stream it over the network.
+ *
+ * The image should be in CPU-accessible memory (like mapped CUDA memory) and already
+ * synchronized with the GPU, in one of the `IMAGE_RGB8`, `IMAGE_RGBA8` or `IMAGE_GRAY8`
+ * formats (the alpha channel is dropped).  libjpeg-turbo is used when it's enabled.
+ *
+ * @param ptr the image to compress.
+ * @param width the width of the image (in pixels).
+ * @param height the height of the image (in pixels).
+ * @param format the format of the image (`IMAGE_RGB8`, `IMAGE_RGBA8` or `IMAGE_GRAY8`)
+ * @param jpeg the vector that the compressed JPEG is written to (its contents are replaced).
+ * @param quality the JPEG quality level (1-100).
+ *
+ * @returns true on success, false if an error occurred.
+ * @ingroup image
+ */
+bool encodeJPEG( const void* ptr, int width, int height, imageFormat format, std::vector<unsigned char>& jpeg, int quality=95 );
+
+
+/**
+ * Enable or disable the use of libjpeg-turbo for loading and saving JPEG images.
+ *
+ * When jetson-utils is built with `ENABLE_TURBOJPEG`, JPEG images are decoded and
+ * encoded with libjpeg-turbo's SIMD codec by default (instead of stb_image).  If a
+ * smaller size was requested from loadImage(), the JPEG is also scaled down by 1/2,
+ * 1/4, or 1/8 while it's being decoded (in the DCT domain), which is much faster
+ * than decoding it at full size and then resizing it.
+ *
+ * @returns true if libjpeg-turbo is now being used, or false if it was disabled
+ *          or jetson-utils was built without `ENABLE_TURBOJPEG`.
+ * @ingroup image
+ */
+bool enableTurboJPEG( bool enable=true );
+
+
+/**
+ * Return true if libjpeg-turbo is being used for loading and saving JPEG images.
+ * @see enableTurboJPEG()
+ * @ingroup image
+ */
+bool isTurboJPEGEnabled();
+
+
 /**
  * @internal
  * @ingroup image
@@ -63,9 +63,14 @@ imageLoader::imageLoader( const videoOptions& options ) : videoSource(options)
 {
 	mEOS = false;
 	mNextFile = 0;
+	mLoopCount = 1;
 
 	mBuffers.reserve(options.numBuffers);
 
+	// images are loaded on demand, so the next frame is always ready until EOS
+	if( initReadyFD() )
+		notifyReady();
+
 	// list files to use
 	std::vector<std::string> files;
 
@@ -155,9 +160,9 @@ bool imageLoader::Capture( void** output, imageFormat format, uint64_t timeout,
 		mBuffers.erase(mBuffers.begin());
 	}
 
-	// get the next file to load
+	// get the next file to load (skipping over the stride)
 	const size_t currFile = mNextFile;
-	mNextFile++;
+	mNextFile += mOptions.stride;
 	
 	if( mNextFile >= mFiles.size() )
 	{
@@ -187,10 +192,15 @@ bool imageLoader::Capture( void** output, imageFormat format, uint64_t timeout,
 	// set outputs
 	mOptions.width = imgWidth;
 	mOptions.height = imgHeight;
+	mOptions.frameCount++;
+
+	if( mOptions.frameRate > 0 )
+		mLastTimestamp = currFile * 1000000000.0 / mOptions.frameRate;
 
 	*output = imgPtr;
 	mBuffers.push_back(imgPtr);
 
+	notifyReady();
 	RETURN_STATUS(OK);
 }
 
@@ -216,3 +226,40 @@ void imageLoader::Close()
 }
 
 
+// Seek
+bool imageLoader::Seek( uint64_t position, SeekFormat format, bool accurate )
+{
+	if( format == SEEK_TIME )
+	{
+		if( mOptions.frameRate <= 0 )
+		{
+			LogError(LOG_IMAGE "imageLoader -- seeking by time requires the framerate to be set (--input-rate)\n");
+			return false;
+		}
+
+		position = (position * mOptions.frameRate) / 1000000000.0 + 0.5;
+	}
+
+	if( position >= mFiles.size() )
+	{
+		LogError(LOG_IMAGE "imageLoader -- can't seek to image %llu (the sequence has %zu images)\n", (unsigned long long)position, mFiles.size());
+		return false;
+	}
+
+	mNextFile = position;
+	mEOS = false;
+
+	notifyReady();
+
+	return true;
+}
+
+
+// GetPosition
+uint64_t imageLoader::GetPosition( SeekFormat format ) const
+{
+	if( format == SEEK_TIME )
+		return (mOptions.frameRate > 0) ? mNextFile * 1000000000.0 / mOptions.frameRate : 0;
+
+	return mNextFile;
+}
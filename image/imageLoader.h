@@ -85,6 +85,25 @@ public:
 	 */
 	virtual void Close();
 
+	/**
+	 * Jump to an image in the sequence.  Since each image is stored in its own
+	 * file, any image can be jumped to directly.  Timestamps are converted
+	 * to indices using the framerate from videoOptions.
+	 * @see videoSource::Seek()
+	 */
+	virtual bool Seek( uint64_t position, SeekFormat format=SEEK_FRAME, bool accurate=true );
+
+	/**
+	 * Return the index (or timestamp) of the next image to be loaded.
+	 * @see videoSource::GetPosition()
+	 */
+	virtual uint64_t GetPosition( SeekFormat format=SEEK_FRAME ) const;
+
+	/**
+	 * Return the number of images in the sequence.
+	 */
+	inline size_t GetNumImages() const			{ return mFiles.size(); }
+
 	/**
 	 * Return true if End Of Stream (EOS) has been reached.
 	 * In the context of imageLoader, EOS means that all images
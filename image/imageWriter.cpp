@@ -23,9 +23,12 @@
 #include "imageWriter.h"
 #include "imageIO.h"
 
+#include "cudaMappedMemory.h"
 #include "filesystem.h"
 #include "logging.h"
 
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 
 
@@ -61,6 +64,16 @@ imageWriter::imageWriter( const videoOptions& options ) : videoOutput(options)
 	mFileCount = 0;
 	mStreaming = true;
 
+	mHostMemory    = false;
+	mQuit          = false;
+	mActive        = 0;
+	mFramesQueued  = 0;
+	mFramesWritten = 0;
+	mFramesDropped = 0;
+
+	if( mOptions.queueDepth == 0 )
+		mOptions.queueDepth = 1;
+
 	// replace wildcards with %i
 	const size_t wildcard = mOptions.resource.location.find("*");
 	
@@ -72,14 +85,47 @@ imageWriter::imageWriter( const videoOptions& options ) : videoOutput(options)
 // destructor
 imageWriter::~imageWriter()
 {
+	Close();
+
+	// stop the worker threads
+	mMutex.Lock();
+	mQuit = true;
+	mMutex.Unlock();
+
+	mQueueEvent.Wake();
+
+	for( size_t n=0; n < mThreads.size(); n++ )
+	{
+		mThreads[n]->Stop(true);
+		delete mThreads[n];
+	}
 
+	mThreads.clear();
+
+	// free the buffers
+	for( size_t n=0; n < mQueue.size(); n++ )
+		freeBuffer(mQueue[n].buffer);
+
+	for( size_t n=0; n < mPool.size(); n++ )
+		freeBuffer(mPool[n].buffer);
+
+	mQueue.clear();
+	mPool.clear();
 }
 
 
 // Create
 imageWriter* imageWriter::Create( const videoOptions& options )
 {
-	return new imageWriter(options);
+	imageWriter* writer = new imageWriter(options);
+
+	if( !writer->init() )
+	{
+		delete writer;
+		return NULL;
+	}
+
+	return writer;
 }
 
 
@@ -92,6 +138,203 @@ imageWriter* imageWriter::Create( const char* resource, const videoOptions& opti
 }
 
 
+// init
+bool imageWriter::init()
+{
+	if( mOptions.threads == 0 )
+		return true;
+
+	// without a GPU, frames are copied into the queue with the CPU
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+
+	for( uint32_t n=0; n < mOptions.threads; n++ )
+	{
+		Thread* thread = new Thread();
+
+		if( !thread->Start(workerThread, this) )
+		{
+			LogError(LOG_IMAGE "imageWriter -- failed to start worker thread\n");
+			delete thread;
+			return false;
+		}
+
+		mThreads.push_back(thread);
+	}
+
+	LogVerbose(LOG_IMAGE "imageWriter -- saving images in the background with %u threads (queue depth %u, %s)\n", mOptions.threads, mOptions.queueDepth, videoOptions::QueuePolicyToStr(mOptions.queuePolicy));
+	return true;
+}
+
+
+// freeBuffer
+void imageWriter::freeBuffer( void* buffer )
+{
+	if( mHostMemory )
+		free(buffer);
+	else
+		CUDA(cudaFreeHost(buffer));
+}
+
+
+// enqueue
+bool imageWriter::enqueue( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	const size_t size = imageFormatSize(format, width, height);
+
+	mMutex.Lock();
+
+	// make room in the queue
+	while( mQueue.size() >= mOptions.queueDepth )
+	{
+		if( mOptions.queuePolicy == videoOptions::QUEUE_DROP_NEWEST )
+		{
+			mFramesDropped++;
+			mMutex.Unlock();
+			return true;
+		}
+		else if( mOptions.queuePolicy == videoOptions::QUEUE_DROP_OLDEST )
+		{
+			mPool.push_back(mQueue.front());
+			mQueue.pop_front();
+			mFramesDropped++;
+		}
+		else
+		{
+			mMutex.Unlock();
+			mSpaceEvent.Wait();
+			mMutex.Lock();
+		}
+	}
+
+	// take a buffer from the pool
+	Frame frame;
+
+	frame.buffer = NULL;
+	frame.size   = 0;
+
+	if( mPool.size() > 0 )
+	{
+		frame = mPool.back();
+		mPool.pop_back();
+	}
+
+	mMutex.Unlock();
+
+	if( frame.buffer != NULL && frame.size < size )
+	{
+		freeBuffer(frame.buffer);
+		frame.buffer = NULL;
+	}
+
+	if( !frame.buffer )
+	{
+		if( mHostMemory )
+			frame.buffer = malloc(size);
+		else if( !cudaAllocMapped(&frame.buffer, size, false) )
+			frame.buffer = NULL;
+
+		if( !frame.buffer )
+		{
+			LogError(LOG_IMAGE "imageWriter -- failed to allocate %zu bytes for queued image\n", size);
+			return false;
+		}
+
+		frame.size = size;
+	}
+
+	// snapshot the frame, so the caller can re-use it after Render() returns
+	if( mHostMemory )
+	{
+		memcpy(frame.buffer, image, size);
+	}
+	else
+	{
+		if( CUDA_FAILED(cudaMemcpyAsync(frame.buffer, image, size, cudaMemcpyDefault, stream)) || CUDA_FAILED(cudaStreamSynchronize(stream)) )
+		{
+			freeBuffer(frame.buffer);
+			return false;
+		}
+	}
+
+	frame.width    = width;
+	frame.height   = height;
+	frame.format   = format;
+	frame.filename = mFileOut;
+
+	mMutex.Lock();
+	mQueue.push_back(frame);
+	mFramesQueued++;
+	mMutex.Unlock();
+
+	mQueueEvent.Wake();
+	return true;
+}
+
+
+// workerThread
+void* imageWriter::workerThread( void* param )
+{
+	imageWriter* writer = (imageWriter*)param;
+
+	while( true )
+	{
+		writer->mMutex.Lock();
+
+		if( writer->mQueue.size() == 0 )
+		{
+			const bool quit = writer->mQuit;
+			writer->mMutex.Unlock();
+
+			if( quit )
+				break;
+
+			writer->mQueueEvent.Wait();
+			continue;
+		}
+
+		Frame frame = writer->mQueue.front();
+		writer->mQueue.pop_front();
+		writer->mActive++;
+
+		const bool more = (writer->mQueue.size() > 0);
+		writer->mMutex.Unlock();
+
+		// let Render() know there's space, and another worker that there's more work
+		writer->mSpaceEvent.Wake();
+
+		if( more )
+			writer->mQueueEvent.Wake();
+
+		// the frame was already synchronized when it was queued
+		const bool result = saveImage(frame.filename.c_str(), frame.buffer, frame.width, frame.height, frame.format, IMAGE_DEFAULT_SAVE_QUALITY, make_float2(0,255), false);
+
+		if( !result )
+			LogError(LOG_IMAGE "imageWriter -- failed to save '%s'\n", frame.filename.c_str());
+
+		writer->mMutex.Lock();
+
+		writer->mPool.push_back(frame);
+		writer->mActive--;
+
+		if( result )
+			writer->mFramesWritten++;
+
+		writer->mMutex.Unlock();
+		writer->mSpaceEvent.Wake();
+	}
+
+	// wake the next worker so it can exit too
+	writer->mQueueEvent.Wake();
+	return NULL;
+}
+
+
 // Render
 bool imageWriter::Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
 {
@@ -117,8 +360,13 @@ bool imageWriter::Render( void* image, uint32_t width, uint32_t height, imageFor
 
 	//CUDA(cudaDeviceSynchronize());   // now done in saveImage()
 	
-	// save the image
-	if( !saveImage(mFileOut, image, width, height, format, IMAGE_DEFAULT_SAVE_QUALITY, stream) )
+	// queue the image to be saved in the background
+	if( mThreads.size() > 0 )
+	{
+		if( !enqueue(image, width, height, format, stream) )
+			return false;
+	}
+	else if( !saveImage(mFileOut, image, width, height, format, IMAGE_DEFAULT_SAVE_QUALITY, stream) )
 	{
 		LogError(LOG_IMAGE "imageWriter -- failed to save '%s'\n", mFileOut);
 		return false;
@@ -132,3 +380,64 @@ bool imageWriter::Render( void* image, uint32_t width, uint32_t height, imageFor
 	return substreams_success;
 }
 
+
+// Close
+void imageWriter::Close()
+{
+	// wait for the queued images to be written
+	if( mThreads.size() > 0 )
+	{
+		mMutex.Lock();
+
+		while( mQueue.size() > 0 || mActive > 0 )
+		{
+			mMutex.Unlock();
+			mSpaceEvent.Wait();
+			mMutex.Lock();
+		}
+
+		mMutex.Unlock();
+	}
+
+	mStreaming = false;
+}
+
+
+// GetFramesQueued
+uint64_t imageWriter::GetFramesQueued() const
+{
+	mMutex.Lock();
+	const uint64_t count = mFramesQueued;
+	mMutex.Unlock();
+	return count;
+}
+
+
+// GetFramesWritten
+uint64_t imageWriter::GetFramesWritten() const
+{
+	mMutex.Lock();
+	const uint64_t count = mFramesWritten;
+	mMutex.Unlock();
+	return count;
+}
+
+
+// GetFramesDropped
+uint64_t imageWriter::GetFramesDropped() const
+{
+	mMutex.Lock();
+	const uint64_t count = mFramesDropped;
+	mMutex.Unlock();
+	return count;
+}
+
+
+// GetQueueSize
+uint32_t imageWriter::GetQueueSize() const
+{
+	mMutex.Lock();
+	const uint32_t count = mQueue.size();
+	mMutex.Unlock();
+	return count;
+}
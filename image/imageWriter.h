@@ -26,6 +26,13 @@
 
 #include "videoOutput.h"
 
+#include "Thread.h"
+#include "Mutex.h"
+#include "Event.h"
+
+#include <deque>
+#include <vector>
+
 
 /**
  * Save an image or set of images to disk.
@@ -40,6 +47,16 @@
  * When given just the path of a directory as output, it will default to
  * incremental `%i.jpg` sequencing and save in JPG format.
  *
+ * By default, images are encoded and written synchronously from Render().
+ * Encoding PNG's in particular can take a long time, so the images can be
+ * saved in the background instead by setting `--output-threads=N`.  Then
+ * Render() copies the frame into a pooled buffer and returns immediately,
+ * while N worker threads encode and write the queued images.  When more
+ * than `--output-queue` images are waiting, `--output-queue-policy` either
+ * blocks Render() until there's room, or drops the newest or oldest frame.
+ * The GetFramesQueued(), GetFramesWritten(), and GetFramesDropped() counters
+ * can be used to monitor the queue.
+ *
  * @note imageWriter implements the videoOutput interface and is intended to
  * be used through that as opposed to directly.  videoOutput implements
  * additional command-line parsing of videoOptions to construct instances.
@@ -77,6 +94,33 @@ public:
 	 */
 	virtual bool Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
 
+	/**
+	 * Wait for any queued images to finish being written.
+	 * @see videoOutput::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the number of images that have been added to the queue
+	 * to be written in the background.
+	 */
+	uint64_t GetFramesQueued() const;
+
+	/**
+	 * Return the number of images that have been written to disk.
+	 */
+	uint64_t GetFramesWritten() const;
+
+	/**
+	 * Return the number of frames that were dropped because the queue was full.
+	 */
+	uint64_t GetFramesDropped() const;
+
+	/**
+	 * Return the number of images that are currently waiting to be written.
+	 */
+	uint32_t GetQueueSize() const;
+
 	/**
 	 * Return the interface type (imageWriter::Type)
 	 */
@@ -110,8 +154,39 @@ public:
 protected:
 	imageWriter( const videoOptions& options );
 
+	bool init();
+	bool enqueue( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream );
+	void freeBuffer( void* buffer );
+
+	static void* workerThread( void* param );
+
+	struct Frame
+	{
+		void*       buffer;
+		size_t      size;
+		uint32_t    width;
+		uint32_t    height;
+		imageFormat format;
+		std::string filename;
+	};
+
 	uint32_t mFileCount;
 	char     mFileOut[1024];
+
+	std::vector<Thread*> mThreads;
+	std::deque<Frame>    mQueue;
+	std::vector<Frame>   mPool;
+
+	mutable Mutex mMutex;
+	Event    mQueueEvent;
+	Event    mSpaceEvent;
+	bool     mHostMemory;
+	bool     mQuit;
+	uint32_t mActive;
+
+	uint64_t mFramesQueued;
+	uint64_t mFramesWritten;
+	uint64_t mFramesDropped;
 };
 
 #endif
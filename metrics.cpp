@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "metrics.h"
+#include "timespec.h"
+#include "logging.h"
+#include "Mutex.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+
+// registry of metrics (protected by gMetricsMutex)
+static std::vector<Metric*> gMetrics;
+static Mutex gMetricsMutex;
+
+// collectors (protected by gCollectorMutex, which is held while they run)
+static std::vector< std::pair<Metrics::Collector, void*> > gCollectors;
+static Mutex gCollectorMutex;
+
+// content type of the text exposition format
+const char* Metrics::ContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+
+// format a floating-point value
+static void appendValue( std::string& out, double value )
+{
+	if( isnan(value) )
+		out += "NaN";
+	else if( isinf(value) )
+		out += (value > 0) ? "+Inf" : "-Inf";
+	else
+	{
+		char str[32];
+		snprintf(str, sizeof(str), "%.9g", value);
+		out += str;
+	}
+}
+
+
+// format an integer value
+static void appendValue( std::string& out, uint64_t value )
+{
+	char str[32];
+	snprintf(str, sizeof(str), "%llu", (unsigned long long)value);
+	out += str;
+}
+
+
+// format a sample line:  name{labels,extra} value
+static void appendSample( std::string& out, const std::string& name, const char* suffix, const std::string& labels, const char* extra=NULL )
+{
+	out += name;
+
+	if( suffix != NULL )
+		out += suffix;
+
+	const bool hasLabels = labels.length() > 0;
+	const bool hasExtra = extra != NULL && extra[0] != '\0';
+
+	if( hasLabels || hasExtra )
+	{
+		out += '{';
+		out += labels;
+
+		if( hasLabels && hasExtra )
+			out += ',';
+
+		if( hasExtra )
+			out += extra;
+
+		out += '}';
+	}
+
+	out += ' ';
+}
+
+
+// TypeToStr
+const char* Metric::TypeToStr( Metric::Type type )
+{
+	switch(type)
+	{
+		case COUNTER:	return "counter";
+		case GAUGE:	return "gauge";
+		case HISTOGRAM:return "histogram";
+	}
+
+	return "untyped";
+}
+
+
+// constructor
+Metric::Metric( Type type, const char* name, const char* help, const char* labels )
+{
+	mType     = type;
+	mName     = name;
+	mRefCount = 1;
+
+	if( help != NULL )
+		mHelp = help;
+
+	if( labels != NULL )
+		mLabels = labels;
+}
+
+
+// destructor
+Metric::~Metric()
+{
+
+}
+
+
+// constructor
+MetricCounter::MetricCounter( const char* name, const char* help, const char* labels ) : Metric(COUNTER, name, help, labels)
+{
+	mValue = 0;
+}
+
+
+// render
+void MetricCounter::render( std::string& out ) const
+{
+	appendSample(out, mName, NULL, mLabels);
+	appendValue(out, Get());
+	out += '\n';
+}
+
+
+// constructor
+MetricGauge::MetricGauge( const char* name, const char* help, const char* labels ) : Metric(GAUGE, name, help, labels)
+{
+	mValue = toBits(0.0);
+}
+
+
+// Add
+void MetricGauge::Add( double value )
+{
+	uint64_t expected = __atomic_load_n(&mValue, __ATOMIC_RELAXED);
+
+	while( !__atomic_compare_exchange_n(&mValue, &expected, toBits(fromBits(expected) + value), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+		;
+}
+
+
+// render
+void MetricGauge::render( std::string& out ) const
+{
+	appendSample(out, mName, NULL, mLabels);
+	appendValue(out, Get());
+	out += '\n';
+}
+
+
+// constructor
+MetricHistogram::MetricHistogram( const char* name, const char* help, const char* labels, const std::vector<double>& buckets ) : Metric(HISTOGRAM, name, help, labels)
+{
+	mBounds = buckets;
+	std::sort(mBounds.begin(), mBounds.end());
+
+	mBuckets = new uint64_t[mBounds.size() + 1];
+	memset(mBuckets, 0, sizeof(uint64_t) * (mBounds.size() + 1));
+
+	mCount = 0;
+	mSum   = MetricGauge::toBits(0.0);
+}
+
+
+// destructor
+MetricHistogram::~MetricHistogram()
+{
+	delete[] mBuckets;
+}
+
+
+// Observe
+void MetricHistogram::Observe( double value )
+{
+	const size_t numBounds = mBounds.size();
+	size_t n = 0;
+
+	while( n < numBounds && value > mBounds[n] )
+		n++;
+
+	__atomic_add_fetch(&mBuckets[n], 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&mCount, 1, __ATOMIC_RELAXED);
+
+	uint64_t expected = __atomic_load_n(&mSum, __ATOMIC_RELAXED);
+
+	while( !__atomic_compare_exchange_n(&mSum, &expected, MetricGauge::toBits(MetricGauge::fromBits(expected) + value), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+		;
+}
+
+
+// ObserveSince
+void MetricHistogram::ObserveSince( const timespec& start )
+{
+	timespec elapsed;
+	timeDiff(start, timestamp(), &elapsed);
+	Observe(elapsed.tv_sec + elapsed.tv_nsec * 1e-9);
+}
+
+
+// render
+void MetricHistogram::render( std::string& out ) const
+{
+	const size_t numBounds = mBounds.size();
+	uint64_t cumulative = 0;
+
+	for( size_t n=0; n <= numBounds; n++ )
+	{
+		cumulative += __atomic_load_n(&mBuckets[n], __ATOMIC_RELAXED);
+
+		std::string le = "le=\"";
+		appendValue(le, (n < numBounds) ? mBounds[n] : INFINITY);
+		le += '"';
+
+		appendSample(out, mName, "_bucket", mLabels, le.c_str());
+		appendValue(out, cumulative);
+		out += '\n';
+	}
+
+	appendSample(out, mName, "_sum", mLabels);
+	appendValue(out, GetSum());
+	out += '\n';
+
+	appendSample(out, mName, "_count", mLabels);
+	appendValue(out, cumulative);
+	out += '\n';
+}
+
+
+// find (the caller should hold gMetricsMutex)
+Metric* Metrics::find( Metric::Type type, const char* name, const char* labels )
+{
+	if( !labels )
+		labels = "";
+
+	const size_t numMetrics = gMetrics.size();
+
+	for( size_t n=0; n < numMetrics; n++ )
+	{
+		Metric* metric = gMetrics[n];
+
+		if( metric->mName != name || metric->mLabels != labels )
+			continue;
+
+		if( metric->mType != type )
+		{
+			LogError(LOG_METRICS "'%s' was already registered as a %s\n", name, Metric::TypeToStr(metric->mType));
+			return NULL;
+		}
+
+		metric->mRefCount++;
+		return metric;
+	}
+
+	return NULL;
+}
+
+
+// add (the caller should hold gMetricsMutex)
+void Metrics::add( Metric* metric )
+{
+	gMetrics.push_back(metric);
+	LogDebug(LOG_METRICS "registered %s %s{%s}\n", Metric::TypeToStr(metric->mType), metric->GetName(), metric->GetLabels());
+}
+
+
+// Counter
+MetricCounter* Metrics::Counter( const char* name, const char* help, const char* labels )
+{
+	if( !name )
+		return NULL;
+
+	gMetricsMutex.Lock();
+
+	MetricCounter* metric = (MetricCounter*)find(Metric::COUNTER, name, labels);
+
+	if( !metric )
+	{
+		metric = new MetricCounter(name, help, labels);
+		add(metric);
+	}
+
+	gMetricsMutex.Unlock();
+	return metric;
+}
+
+
+// Gauge
+MetricGauge* Metrics::Gauge( const char* name, const char* help, const char* labels )
+{
+	if( !name )
+		return NULL;
+
+	gMetricsMutex.Lock();
+
+	MetricGauge* metric = (MetricGauge*)find(Metric::GAUGE, name, labels);
+
+	if( !metric )
+	{
+		metric = new MetricGauge(name, help, labels);
+		add(metric);
+	}
+
+	gMetricsMutex.Unlock();
+	return metric;
+}
+
+
+// Histogram
+MetricHistogram* Metrics::Histogram( const char* name, const char* help, const char* labels, const std::vector<double>& buckets )
+{
+	if( !name )
+		return NULL;
+
+	gMetricsMutex.Lock();
+
+	MetricHistogram* metric = (MetricHistogram*)find(Metric::HISTOGRAM, name, labels);
+
+	if( !metric )
+	{
+		metric = new MetricHistogram(name, help, labels, (buckets.size() > 0) ? buckets : LatencyBuckets());
+		add(metric);
+	}
+
+	gMetricsMutex.Unlock();
+	return metric;
+}
+
+
+// Release
+void Metrics::Release( Metric* metric )
+{
+	if( !metric )
+		return;
+
+	gMetricsMutex.Lock();
+
+	metric->mRefCount--;
+
+	if( metric->mRefCount == 0 )
+	{
+		gMetrics.erase(std::find(gMetrics.begin(), gMetrics.end(), metric));
+		delete metric;
+	}
+
+	gMetricsMutex.Unlock();
+}
+
+
+// AddCollector
+void Metrics::AddCollector( Metrics::Collector collector, void* user_data )
+{
+	if( !collector )
+		return;
+
+	gCollectorMutex.Lock();
+	gCollectors.push_back(std::make_pair(collector, user_data));
+	gCollectorMutex.Unlock();
+}
+
+
+// RemoveCollector
+void Metrics::RemoveCollector( Metrics::Collector collector, void* user_data )
+{
+	gCollectorMutex.Lock();
+
+	for( size_t n=0; n < gCollectors.size(); n++ )
+	{
+		if( gCollectors[n].first == collector && gCollectors[n].second == user_data )
+		{
+			gCollectors.erase(gCollectors.begin() + n);
+			break;
+		}
+	}
+
+	gCollectorMutex.Unlock();
+}
+
+
+// sort the metrics by name, keeping the order they were registered in otherwise
+static bool compareMetrics( const Metric* a, const Metric* b )
+{
+	return strcmp(a->GetName(), b->GetName()) < 0;
+}
+
+
+// Render
+std::string Metrics::Render()
+{
+	// let the collectors update their metrics
+	gCollectorMutex.Lock();
+
+	const size_t numCollectors = gCollectors.size();
+
+	for( size_t n=0; n < numCollectors; n++ )
+		gCollectors[n].first(gCollectors[n].second);
+
+	gCollectorMutex.Unlock();
+
+	// group the metrics into families with the same name
+	gMetricsMutex.Lock();
+
+	std::vector<Metric*> metrics = gMetrics;
+	std::stable_sort(metrics.begin(), metrics.end(), compareMetrics);
+
+	std::string out;
+	out.reserve(metrics.size() * 128);
+
+	const size_t numMetrics = metrics.size();
+
+	for( size_t n=0; n < numMetrics; n++ )
+	{
+		const Metric* metric = metrics[n];
+
+		if( n == 0 || metric->mName != metrics[n-1]->mName )
+		{
+			if( metric->mHelp.length() > 0 )
+			{
+				out += "# HELP " + metric->mName + " ";
+
+				for( size_t i=0; i < metric->mHelp.length(); i++ )
+				{
+					const char c = metric->mHelp[i];
+
+					if( c == '\\' )
+						out += "\\\\";
+					else if( c == '\n' )
+						out += "\\n";
+					else
+						out += c;
+				}
+
+				out += '\n';
+			}
+
+			out += "# TYPE " + metric->mName + " " + Metric::TypeToStr(metric->mType) + "\n";
+		}
+
+		metric->render(out);
+	}
+
+	gMetricsMutex.Unlock();
+	return out;
+}
+
+
+// Label
+std::string Metrics::Label( const char* key, const char* value )
+{
+	std::string label = key;
+
+	label += "=\"";
+
+	if( value != NULL )
+	{
+		for( const char* c = value; *c != '\0'; c++ )
+		{
+			if( *c == '\\' || *c == '"' )
+				label += '\\';
+
+			if( *c == '\n' )
+				label += "\\n";
+			else
+				label += *c;
+		}
+	}
+
+	label += '"';
+	return label;
+}
+
+
+// LatencyBuckets
+const std::vector<double>& Metrics::LatencyBuckets()
+{
+	static const double bounds[] = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+	static const std::vector<double> buckets(bounds, bounds + sizeof(bounds) / sizeof(bounds[0]));
+
+	return buckets;
+}
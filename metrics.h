@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __METRICS_H_
+#define __METRICS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Metrics logging prefix
+ * @ingroup metrics
+ */
+#define LOG_METRICS "[metrics] "
+
+
+/**
+ * Base class of the metrics that are kept in the Metrics registry.
+ *
+ * Each metric has a name (like `jetson_video_source_frames_total`) and an
+ * optional set of labels that distinguish the streams it's reporting on,
+ * formatted like `uri="csi://0",ring="yuv"` (see Metrics::Label()).
+ *
+ * Updating a metric only takes an atomic operation, so they can be used
+ * from the hot path of capture/render loops and from any thread.
+ *
+ * @ingroup metrics
+ */
+class Metric
+{
+public:
+	/**
+	 * The type of metric.
+	 */
+	enum Type
+	{
+		COUNTER = 0,	/**< Monotonically increasing count (see MetricCounter) */
+		GAUGE,		/**< Value that can go up and down (see MetricGauge) */
+		HISTOGRAM		/**< Distribution of observed values (see MetricHistogram) */
+	};
+
+	/**
+	 * Return the type of metric.
+	 */
+	inline Type GetType() const				{ return mType; }
+
+	/**
+	 * Return the name of the metric.
+	 */
+	inline const char* GetName() const			{ return mName.c_str(); }
+
+	/**
+	 * Return the labels of the metric.
+	 */
+	inline const char* GetLabels() const			{ return mLabels.c_str(); }
+
+	/**
+	 * Return the description of the metric.
+	 */
+	inline const char* GetHelp() const			{ return mHelp.c_str(); }
+
+	/**
+	 * Convert a metric type to the string used by the text exposition format.
+	 */
+	static const char* TypeToStr( Type type );
+
+protected:
+	friend class Metrics;
+
+	Metric( Type type, const char* name, const char* help, const char* labels );
+	virtual ~Metric();
+
+	virtual void render( std::string& out ) const = 0;
+
+	Type        mType;
+	std::string mName;
+	std::string mHelp;
+	std::string mLabels;
+	uint32_t    mRefCount;
+};
+
+
+/**
+ * Counter that only ever increases (like the number of frames captured).
+ * Create these with Metrics::Counter()
+ * @ingroup metrics
+ */
+class MetricCounter : public Metric
+{
+public:
+	/**
+	 * Increment the counter.
+	 */
+	inline void Increment( uint64_t count=1 )		{ __atomic_add_fetch(&mValue, count, __ATOMIC_RELAXED); }
+
+	/**
+	 * Set the counter to a count that's kept elsewhere, like videoOptions::frameCount
+	 * (this is typically done from a collector - see Metrics::AddCollector())
+	 */
+	inline void Set( uint64_t count )			{ __atomic_store_n(&mValue, count, __ATOMIC_RELAXED); }
+
+	/**
+	 * Return the current count.
+	 */
+	inline uint64_t Get() const				{ return __atomic_load_n(&mValue, __ATOMIC_RELAXED); }
+
+protected:
+	friend class Metrics;
+
+	MetricCounter( const char* name, const char* help, const char* labels );
+	virtual void render( std::string& out ) const;
+
+	uint64_t mValue;
+};
+
+
+/**
+ * Gauge that can be set to any value (like the number of queued buffers).
+ * Create these with Metrics::Gauge()
+ * @ingroup metrics
+ */
+class MetricGauge : public Metric
+{
+public:
+	/**
+	 * Set the value of the gauge.
+	 */
+	inline void Set( double value )			{ __atomic_store_n(&mValue, toBits(value), __ATOMIC_RELAXED); }
+
+	/**
+	 * Add to the value of the gauge (the value can be negative).
+	 */
+	void Add( double value );
+
+	/**
+	 * Return the current value of the gauge.
+	 */
+	inline double Get() const				{ return fromBits(__atomic_load_n(&mValue, __ATOMIC_RELAXED)); }
+
+protected:
+	friend class Metrics;
+	friend class MetricHistogram;
+
+	MetricGauge( const char* name, const char* help, const char* labels );
+	virtual void render( std::string& out ) const;
+
+	static inline uint64_t toBits( double value )	{ uint64_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+	static inline double fromBits( uint64_t bits )	{ double value; memcpy(&value, &bits, sizeof(value)); return value; }
+
+	uint64_t mValue;	// bits of a double, so it can be updated atomically
+};
+
+
+/**
+ * Histogram of observed values (like latencies, in seconds), which are
+ * counted in buckets with fixed upper bounds.
+ * Create these with Metrics::Histogram()
+ * @ingroup metrics
+ */
+class MetricHistogram : public Metric
+{
+public:
+	/**
+	 * Record a value in the histogram.
+	 */
+	void Observe( double value );
+
+	/**
+	 * Record the time that's elapsed since `start` (from timestamp()), in seconds.
+	 */
+	void ObserveSince( const timespec& start );
+
+	/**
+	 * Return the number of values that have been recorded.
+	 */
+	inline uint64_t GetCount() const			{ return __atomic_load_n(&mCount, __ATOMIC_RELAXED); }
+
+	/**
+	 * Return the sum of the values that have been recorded.
+	 */
+	inline double GetSum() const				{ return MetricGauge::fromBits(__atomic_load_n(&mSum, __ATOMIC_RELAXED)); }
+
+	/**
+	 * Return the upper bounds of the buckets.
+	 */
+	inline const std::vector<double>& GetBuckets() const	{ return mBounds; }
+
+protected:
+	friend class Metrics;
+
+	MetricHistogram( const char* name, const char* help, const char* labels, const std::vector<double>& buckets );
+	virtual ~MetricHistogram();
+	virtual void render( std::string& out ) const;
+
+	std::vector<double> mBounds;
+	uint64_t* mBuckets;	// one per bound, plus +Inf
+	uint64_t  mCount;
+	uint64_t  mSum;
+};
+
+
+/**
+ * Registry of the metrics reported by videoSource, videoOutput, gstBufferManager,
+ * gstEncoder and RingBuffer, which can be scraped by Prometheus from the `/metrics`
+ * HTTP endpoint served by MetricsServer (or WebRTCServer).
+ *
+ * Metrics are created (or looked up if they already exist) by their name and labels,
+ * and are reference-counted - each call to Counter(), Gauge() or Histogram() should
+ * be balanced with a call to Release() when the stream is closed:
+ *
+ * @code
+ * MetricCounter* drops = Metrics::Counter("jetson_frames_dropped_total", "Frames dropped", Metrics::Label("uri", uri).c_str());
+ * drops->Increment();
+ * Metrics::Release(drops);
+ * @endcode
+ *
+ * Counts that are already kept elsewhere can be copied into metrics when they
+ * get scraped, by registering a collector function with AddCollector().
+ *
+ * @ingroup metrics
+ */
+class Metrics
+{
+public:
+	/**
+	 * Function that's called before the metrics are rendered, for updating them.
+	 */
+	typedef void (*Collector)( void* user_data );
+
+	/**
+	 * Create a counter, or return the existing counter with the same name and labels.
+	 */
+	static MetricCounter* Counter( const char* name, const char* help, const char* labels=NULL );
+
+	/**
+	 * Create a gauge, or return the existing gauge with the same name and labels.
+	 */
+	static MetricGauge* Gauge( const char* name, const char* help, const char* labels=NULL );
+
+	/**
+	 * Create a histogram, or return the existing histogram with the same name and labels.
+	 * If the buckets aren't specified, LatencyBuckets() are used.
+	 */
+	static MetricHistogram* Histogram( const char* name, const char* help, const char* labels=NULL, const std::vector<double>& buckets=std::vector<double>() );
+
+	/**
+	 * Release a reference to a metric, which is removed when there are no references left.
+	 * It's safe to call this with NULL.
+	 */
+	static void Release( Metric* metric );
+
+	/**
+	 * Register a function that gets called before the metrics are rendered.
+	 */
+	static void AddCollector( Collector collector, void* user_data=NULL );
+
+	/**
+	 * Unregister a collector function.
+	 */
+	static void RemoveCollector( Collector collector, void* user_data=NULL );
+
+	/**
+	 * Render all of the metrics in the Prometheus text exposition format.
+	 */
+	static std::string Render();
+
+	/**
+	 * Format a label, escaping the value as needed (for example `uri="csi://0"`).
+	 * Multiple labels can be joined together with commas.
+	 */
+	static std::string Label( const char* key, const char* value );
+
+	/**
+	 * The default histogram buckets, for latencies from 100us to 10s.
+	 */
+	static const std::vector<double>& LatencyBuckets();
+
+	/**
+	 * The content type of the text returned by Render()
+	 */
+	static const char* ContentType;
+
+protected:
+	static Metric* find( Metric::Type type, const char* name, const char* labels );
+	static void add( Metric* metric );
+};
+
+
+#endif
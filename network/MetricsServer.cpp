@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "MetricsServer.h"
+#include "Networking.h"
+#include "Thread.h"
+
+#include "metrics.h"
+#include "logging.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+
+// list of existing server instances
+static std::vector<MetricsServer*> gMetricsServers;
+
+
+// send all of the data, retrying partial writes
+static bool sendAll( int fd, const char* data, size_t size )
+{
+	while( size > 0 )
+	{
+		const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+
+		if( sent < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+
+			return false;
+		}
+
+		data += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+
+// send an HTTP response
+static bool sendResponse( int fd, const char* status, const char* contentType, const std::string& body, bool sendBody=true )
+{
+	char header[256];
+
+	const int headerSize = snprintf(header, sizeof(header),
+		"HTTP/1.0 %s\r\n"
+		"Content-Type: %s\r\n"
+		"Content-Length: %zu\r\n"
+		"Connection: close\r\n"
+		"\r\n", status, contentType, body.length());
+
+	if( !sendAll(fd, header, headerSize) )
+		return false;
+
+	if( sendBody && body.length() > 0 )
+		return sendAll(fd, body.c_str(), body.length());
+
+	return true;
+}
+
+
+// constructor
+MetricsServer::MetricsServer( uint16_t port )
+{
+	mPort        = port;
+	mSocket      = -1;
+	mRefCount    = 1;
+	mNumRequests = 0;
+	mQuit        = false;
+	mThread      = new Thread();
+}
+
+
+// destructor
+MetricsServer::~MetricsServer()
+{
+	mQuit = true;
+
+	if( mThread != NULL )
+	{
+		mThread->Stop(true);
+		delete mThread;
+		mThread = NULL;
+	}
+
+	if( mSocket >= 0 )
+	{
+		close(mSocket);
+		mSocket = -1;
+	}
+}
+
+
+// Release
+void MetricsServer::Release()
+{
+	mRefCount--;
+
+	if( mRefCount == 0 )
+	{
+		LogInfo(LOG_METRICS "metrics server on port %hu is shutting down\n", mPort);
+		gMetricsServers.erase(std::find(gMetricsServers.begin(), gMetricsServers.end(), this));
+		delete this;
+	}
+}
+
+
+// Create
+MetricsServer* MetricsServer::Create( uint16_t port )
+{
+	// see if a server on this port already exists
+	const uint32_t numServers = gMetricsServers.size();
+
+	for( uint32_t n=0; n < numServers; n++ )
+	{
+		if( gMetricsServers[n]->mPort == port )
+		{
+			gMetricsServers[n]->mRefCount++;
+			return gMetricsServers[n];
+		}
+	}
+
+	// create a new server
+	MetricsServer* server = new MetricsServer(port);
+
+	if( !server->init() )
+	{
+		LogError(LOG_METRICS "failed to create metrics server on port %hu\n", port);
+		delete server;
+		return NULL;
+	}
+
+	gMetricsServers.push_back(server);
+	return server;
+}
+
+
+// init
+bool MetricsServer::init()
+{
+	mSocket = socket(AF_INET, SOCK_STREAM, 0);
+
+	if( mSocket < 0 )
+	{
+		LogError(LOG_METRICS "failed to create socket (%s)\n", strerror(errno));
+		return false;
+	}
+
+	const int reuse = 1;
+	setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family      = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port        = htons(mPort);
+
+	if( bind(mSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 )
+	{
+		LogError(LOG_METRICS "failed to bind to port %hu (%s)\n", mPort, strerror(errno));
+		return false;
+	}
+
+	if( listen(mSocket, 8) < 0 )
+	{
+		LogError(LOG_METRICS "failed to listen on port %hu (%s)\n", mPort, strerror(errno));
+		return false;
+	}
+
+	if( !mThread->Start(runThread, this) )
+	{
+		LogError(LOG_METRICS "failed to start thread for running metrics server\n");
+		return false;
+	}
+
+	LogSuccess(LOG_METRICS "metrics server started @ http://%s:%hu/metrics\n", getHostname().c_str(), mPort);
+	return true;
+}
+
+
+// runThread
+void* MetricsServer::runThread( void* user_data )
+{
+	MetricsServer* server = (MetricsServer*)user_data;
+
+	struct pollfd fds;
+
+	fds.fd     = server->mSocket;
+	fds.events = POLLIN;
+
+	while( !server->mQuit )
+	{
+		// wake up periodically to check if the server is shutting down
+		const int result = poll(&fds, 1, 250);
+
+		if( result <= 0 )
+			continue;
+
+		const int client = accept(server->mSocket, NULL, NULL);
+
+		if( client < 0 )
+			continue;
+
+		// don't let a stalled client block the scrapes
+		struct timeval timeout;
+
+		timeout.tv_sec  = 2;
+		timeout.tv_usec = 0;
+
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+		server->handleRequest(client);
+		close(client);
+	}
+
+	return NULL;
+}
+
+
+// handleRequest
+void MetricsServer::handleRequest( int fd )
+{
+	// read until the end of the request headers
+	std::string request;
+	char buffer[1024];
+
+	while( request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos )
+	{
+		const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+
+		if( received < 0 && errno == EINTR )
+			continue;
+
+		if( received <= 0 )
+			break;
+
+		request.append(buffer, received);
+
+		if( request.length() > 16384 )
+		{
+			sendResponse(fd, "431 Request Header Fields Too Large", "text/plain", "request too large\n");
+			return;
+		}
+	}
+
+	// parse the request line:  METHOD PATH VERSION
+	const size_t methodEnd = request.find(' ');
+	const size_t pathEnd = (methodEnd != std::string::npos) ? request.find_first_of(" \r\n", methodEnd + 1) : std::string::npos;
+
+	if( pathEnd == std::string::npos )
+	{
+		sendResponse(fd, "400 Bad Request", "text/plain", "bad request\n");
+		return;
+	}
+
+	const std::string method = request.substr(0, methodEnd);
+	std::string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+
+	const size_t query = path.find('?');
+
+	if( query != std::string::npos )
+		path.resize(query);
+
+	LogDebug(LOG_METRICS "HTTP %s '%s'\n", method.c_str(), path.c_str());
+
+	if( method != "GET" && method != "HEAD" )
+	{
+		sendResponse(fd, "405 Method Not Allowed", "text/plain", "method not allowed\n");
+		return;
+	}
+
+	if( path == "/metrics" )
+	{
+		mNumRequests++;
+		sendResponse(fd, "200 OK", Metrics::ContentType, Metrics::Render(), method == "GET");
+	}
+	else if( path == "/" )
+	{
+		sendResponse(fd, "200 OK", "text/html", "<html><body><a href='/metrics'>metrics</a></body></html>\n", method == "GET");
+	}
+	else
+	{
+		sendResponse(fd, "404 Not Found", "text/plain", "not found\n", method == "GET");
+	}
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __METRICS_SERVER_H__
+#define __METRICS_SERVER_H__
+
+#include <stdint.h>
+
+
+// forward declarations
+class Thread;
+
+
+/**
+ * Default HTTP port used by the metrics server.
+ * @ingroup network
+ */
+#define METRICS_DEFAULT_PORT 9410
+
+
+/**
+ * Minimal HTTP server that runs in its own thread and serves the Metrics
+ * registry from the `/metrics` path, in the text format that Prometheus scrapes:
+ *
+ * @code
+ * MetricsServer* server = MetricsServer::Create(9410);
+ * // curl http://localhost:9410/metrics
+ * server->Release();
+ * @endcode
+ *
+ * Requests are handled one at a time, which is plenty for periodic scrapes.
+ * If the application already runs a WebRTCServer, the metrics are also
+ * available from `/metrics` on its port.
+ *
+ * @see Metrics
+ * @ingroup network
+ */
+class MetricsServer
+{
+public:
+	/**
+	 * Create a metrics server on this port.
+	 * If this port is already in use, the existing server instance will be returned.
+	 */
+	static MetricsServer* Create( uint16_t port=METRICS_DEFAULT_PORT );
+
+	/**
+	 * Release a reference to the server instance.
+	 * Server will be shut down when the reference count reaches zero.
+	 */
+	void Release();
+
+	/**
+	 * Return the port that the server is listening on.
+	 */
+	inline uint16_t GetPort() const		{ return mPort; }
+
+	/**
+	 * Return the number of requests that have been served.
+	 */
+	inline uint64_t GetNumRequests() const	{ return mNumRequests; }
+
+protected:
+
+	MetricsServer( uint16_t port );
+	~MetricsServer();
+
+	bool init();
+	void handleRequest( int fd );
+
+	static void* runThread( void* user_data );
+
+	int      mSocket;
+	uint16_t mPort;
+	uint32_t mRefCount;
+	uint64_t mNumRequests;
+	bool     mQuit;
+
+	Thread* mThread;
+};
+
+#endif
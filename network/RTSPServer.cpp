@@ -25,27 +25,33 @@
 #include "gstUtility.h"
 
 #include "Thread.h"
+#include "metrics.h"
 #include "logging.h"
 
 #include <gst/rtsp-server/rtsp-server.h>
 
+#include <string.h>
+
 
 // list of existing server instances
 std::vector<RTSPServer*> gRTSPServers;
 
-// map of media factories to pipeline elements
-std::vector<std::pair<GstRTSPMediaFactory*, GstElement*>> gMediaFactoryMap;
-
 
 // constructor
 RTSPServer::RTSPServer( uint16_t port )
 {	
 	mPort = port;
 	mRefCount = 1;
+	mNumClients = 0;
 	mThread = new Thread();
 	mRunning = false;
 	mMainLoop = NULL;
 	mServer = NULL;
+	
+	char port_str[16];
+	sprintf(port_str, "%hu", port);
+	
+	mClientsMetric = Metrics::Gauge("jetson_rtsp_clients", "Number of clients connected to the RTSP server", Metrics::Label("port", port_str).c_str());
 }
 
 
@@ -77,6 +83,8 @@ RTSPServer::~RTSPServer()
 		delete mThread;
 		mThread = NULL;
 	}
+	
+	Metrics::Release(mClientsMetric);
 }
 
 
@@ -188,6 +196,9 @@ bool RTSPServer::init()
 	sprintf(port_str, "%hu", mPort);
 	gst_rtsp_server_set_service(mServer, port_str);
 	
+	// keep track of the clients
+	g_signal_connect(mServer, "client-connected", G_CALLBACK(onClientConnected), this);
+	
 	// attach the server to the default maincontext
      if( gst_rtsp_server_attach(mServer, NULL) == 0 )
 	{
@@ -225,25 +236,129 @@ void* RTSPServer::runThread( void* user_data )
 }
 
 
-// custom implementation of GstRTSPMediaFactory::create_element()
-static GstElement* gst_rtsp_media_factory_custom_element( GstRTSPMediaFactory* factory, const GstRTSPUrl* url )
+// onClientConnected
+void RTSPServer::onClientConnected( GstRTSPServer* rtsp_server, GstRTSPClient* client, void* user_data )
+{
+	RTSPServer* server = (RTSPServer*)user_data;
+	
+	if( !server )
+		return;
+	
+	// this relies on GstRTSPClient's default of drop-backlog=TRUE, so that a client which
+	// falls behind on TCP drops its own data once gst-rtsp-server's send backlog is full,
+	// instead of blocking the shared media (and the other clients) until it catches up
+	g_signal_connect(client, "closed", G_CALLBACK(onClientClosed), server);
+	
+	// mNumClients is read from other threads by GetNumClients()
+	const uint32_t numClients = __atomic_add_fetch(&server->mNumClients, 1, __ATOMIC_RELAXED);
+	server->mClientsMetric->Set(numClients);
+	
+	GstRTSPConnection* connection = gst_rtsp_client_get_connection(client);
+	LogVerbose(LOG_RTSP "client connected from %s (%u clients)\n", connection != NULL ? gst_rtsp_connection_get_ip(connection) : "unknown", numClients);
+}
+
+
+// onClientClosed
+void RTSPServer::onClientClosed( GstRTSPClient* client, void* user_data )
+{
+	RTSPServer* server = (RTSPServer*)user_data;
+	
+	if( !server || __atomic_load_n(&server->mNumClients, __ATOMIC_RELAXED) == 0 )
+		return;
+	
+	const uint32_t numClients = __atomic_sub_fetch(&server->mNumClients, 1, __ATOMIC_RELAXED);
+	server->mClientsMetric->Set(numClients);
+	
+	LogVerbose(LOG_RTSP "client disconnected (%u clients)\n", numClients);
+}
+
+
+// media factory that serves an existing pipeline element from one shared media
+typedef struct _RTSPSharedFactory
+{
+	GstRTSPMediaFactory parent;
+	GstElement* element;
+	uint32_t numMedia;
+} RTSPSharedFactory;
+
+typedef struct _RTSPSharedFactoryClass
+{
+	GstRTSPMediaFactoryClass parent_class;
+} RTSPSharedFactoryClass;
+
+G_DEFINE_TYPE(RTSPSharedFactory, rtsp_shared_factory, GST_TYPE_RTSP_MEDIA_FACTORY);
+
+#define RTSP_SHARED_FACTORY(obj) ((RTSPSharedFactory*)(obj))
+
+
+// RTSPSharedFactory::create_element()
+static GstElement* rtsp_shared_factory_create_element( GstRTSPMediaFactory* factory, const GstRTSPUrl* url )
 {
-	const uint32_t numFactories = gMediaFactoryMap.size();
+	GstElement* element = RTSP_SHARED_FACTORY(factory)->element;
 	
-	for( uint32_t n=0; n < numFactories; n++ )
+	// the element can only be in one media's pipeline at a time
+	if( GST_OBJECT_PARENT(element) != NULL )
 	{
-		if( factory == gMediaFactoryMap[n].first )
-			return gMediaFactoryMap[n].second;
+		LogError(LOG_RTSP "pipeline is still being used by another media\n");
+		return NULL;
 	}
 	
-	LogError(LOG_RTSP "failed to lookup media factory pipeline element\n");
-	return NULL;
+	return GST_ELEMENT(gst_object_ref(element));
 }
-    
+
+
+// RTSPSharedFactory::gen_key()
+static gchar* rtsp_shared_factory_gen_key( GstRTSPMediaFactory* factory, const GstRTSPUrl* url )
+{
+	// the default key includes the host and query of the URL, so clients that connect
+	// with a different hostname/IP would get their own media - use the same key for all
+	return g_strdup("shared");
+}
+
+
+// RTSPSharedFactory::finalize()
+static void rtsp_shared_factory_finalize( GObject* object )
+{
+	RTSPSharedFactory* factory = RTSP_SHARED_FACTORY(object);
+	
+	if( factory->element != NULL )
+	{
+		gst_object_unref(factory->element);
+		factory->element = NULL;
+	}
+	
+	G_OBJECT_CLASS(rtsp_shared_factory_parent_class)->finalize(object);
+}
+
+
+// RTSPSharedFactory class init
+static void rtsp_shared_factory_class_init( RTSPSharedFactoryClass* klass )
+{
+	GstRTSPMediaFactoryClass* factoryClass = GST_RTSP_MEDIA_FACTORY_CLASS(klass);
+	
+	factoryClass->create_element = rtsp_shared_factory_create_element;
+	factoryClass->gen_key = rtsp_shared_factory_gen_key;
+	
+	G_OBJECT_CLASS(klass)->finalize = rtsp_shared_factory_finalize;
+}
+
+
+// RTSPSharedFactory instance init
+static void rtsp_shared_factory_init( RTSPSharedFactory* factory )
+{
+	factory->element = NULL;
+	factory->numMedia = 0;
+}
+
     
 // apply some additional settings on each GstRTSPMedia object
-static void gst_rtsp_media_factory_custom_configure( GstRTSPMediaFactory* factory, GstRTSPMedia* media, gpointer user_data )
+static void rtsp_shared_factory_configure( GstRTSPMediaFactory* factory, GstRTSPMedia* media, gpointer user_data )
 {
+	// numMedia is read from other threads by RTSPServer::GetNumMedia()
+	const uint32_t numMedia = __atomic_add_fetch(&RTSP_SHARED_FACTORY(factory)->numMedia, 1, __ATOMIC_RELAXED);
+	
+	LogVerbose(LOG_RTSP "setting up shared media for pipeline (%u times so far)\n", numMedia);
+	
 	gst_rtsp_media_set_reusable(media, true);
 	gst_rtsp_media_prepare(media, NULL);
 	gst_rtsp_media_set_pipeline_state(media, GST_STATE_PLAYING);
@@ -251,8 +366,11 @@ static void gst_rtsp_media_factory_custom_configure( GstRTSPMediaFactory* factor
 
     
 // AddRoute
-bool RTSPServer::AddRoute( const char* path, GstElement* pipeline )
+bool RTSPServer::AddRoute( const char* path, GstElement* pipeline, uint32_t transports )
 {
+	if( !path || !pipeline )
+		return false;
+	
 	// get the mount points for the server
 	GstRTSPMountPoints* mounts = gst_rtsp_server_get_mount_points(mServer);
 	
@@ -262,12 +380,13 @@ bool RTSPServer::AddRoute( const char* path, GstElement* pipeline )
 		return false;
 	}
 	
-	// redirect the media factory create_element() to our function
-	GstRTSPMediaFactory* factory = gst_rtsp_media_factory_new();
-	GstRTSPMediaFactoryClass* factoryFunctions = GST_RTSP_MEDIA_FACTORY_GET_CLASS(factory);
+	// a newly-created pipeline is floating, so make the caller's reference a normal one
+	if( g_object_is_floating(pipeline) )
+		gst_object_ref_sink(pipeline);
 	
-	factoryFunctions->create_element = gst_rtsp_media_factory_custom_element;
-	gMediaFactoryMap.push_back( std::pair<GstRTSPMediaFactory*, GstElement*>(factory, pipeline) );
+	// the factory keeps a reference to the pipeline and serves it from one shared media
+	GstRTSPMediaFactory* factory = GST_RTSP_MEDIA_FACTORY(g_object_new(rtsp_shared_factory_get_type(), NULL));
+	RTSP_SHARED_FACTORY(factory)->element = GST_ELEMENT(gst_object_ref(pipeline));
 	
 	// setup media streaming options
 	gst_rtsp_media_factory_set_latency(factory, 0);
@@ -282,19 +401,58 @@ bool RTSPServer::AddRoute( const char* path, GstElement* pipeline )
 	gst_rtsp_media_factory_set_do_retransmission(factory, false);
 #endif
 
-	g_signal_connect(factory, "media-configure", (GCallback)gst_rtsp_media_factory_custom_configure, NULL);
+	// set the transports that clients can request
+	int protocols = 0;
+	
+	if( transports & RTSP_UDP )
+		protocols |= GST_RTSP_LOWER_TRANS_UDP;
+	
+	if( transports & RTSP_MULTICAST )
+		protocols |= GST_RTSP_LOWER_TRANS_UDP_MCAST;
+	
+	if( transports & RTSP_TCP )
+		protocols |= GST_RTSP_LOWER_TRANS_TCP;
+	
+	if( protocols == 0 )
+	{
+		LogError(LOG_RTSP "AddRoute() -- no transports were enabled for route %s\n", path);
+		g_object_unref(factory);
+		g_object_unref(mounts);
+		return false;
+	}
+	
+	gst_rtsp_media_factory_set_protocols(factory, (GstRTSPLowerTrans)protocols);
+	
+	// multicast clients get their group address and ports from a pool
+	if( transports & RTSP_MULTICAST )
+	{
+		GstRTSPAddressPool* pool = gst_rtsp_address_pool_new();
+		
+		if( !gst_rtsp_address_pool_add_range(pool, RTSP_MULTICAST_ADDRESS_MIN, RTSP_MULTICAST_ADDRESS_MAX, 
+									  RTSP_MULTICAST_PORT_MIN, RTSP_MULTICAST_PORT_MAX, RTSP_MULTICAST_TTL) )
+		{
+			LogWarning(LOG_RTSP "AddRoute() -- failed to add multicast address range, multicast will be unavailable\n");
+		}
+		
+		gst_rtsp_media_factory_set_address_pool(factory, pool);
+		g_object_unref(pool);
+	}
+	
+	g_signal_connect(factory, "media-configure", (GCallback)rtsp_shared_factory_configure, NULL);
 	 
-	// attach the factory to the url
+	// attach the factory to the url (the mount points take ownership of the factory)
 	gst_rtsp_mount_points_add_factory(mounts, path, factory);
 	g_object_unref(mounts);
 	
-	LogVerbose(LOG_RTSP "RTSP route added %s @ rtsp://%s:%hu\n", path, getHostname().c_str(), mPort);
+	LogVerbose(LOG_RTSP "RTSP route added %s @ rtsp://%s:%hu (%s%s%s)\n", path, getHostname().c_str(), mPort,
+			 (transports & RTSP_UDP) ? "udp " : "", (transports & RTSP_MULTICAST) ? "multicast " : "", (transports & RTSP_TCP) ? "tcp" : "");
+	
 	return true;
 }
 
 
 // AddRoute
-bool RTSPServer::AddRoute( const char* path, const char* pipeline_str )
+bool RTSPServer::AddRoute( const char* path, const char* pipeline_str, uint32_t transports )
 {
 	GError* err = NULL;
 	GstElement* pipeline = gst_parse_launch_full(pipeline_str, NULL, GST_PARSE_FLAG_PLACE_IN_BIN, &err);
@@ -308,5 +466,37 @@ bool RTSPServer::AddRoute( const char* path, const char* pipeline_str )
 		return false;
 	}
 	
-	return AddRoute(path, pipeline);
-}
\ No newline at end of file
+	// the route holds its own reference to the pipeline
+	gst_object_ref_sink(pipeline);
+	const bool result = AddRoute(path, pipeline, transports);
+	gst_object_unref(pipeline);
+	return result;
+} 
+
+
+// GetNumMedia
+uint32_t RTSPServer::GetNumMedia( const char* path ) const
+{
+	if( !path || !mServer )
+		return 0;
+	
+	GstRTSPMountPoints* mounts = gst_rtsp_server_get_mount_points(mServer);
+	
+	if( !mounts )
+		return 0;
+	
+	gint matched = 0;
+	GstRTSPMediaFactory* factory = gst_rtsp_mount_points_match(mounts, path, &matched);
+	g_object_unref(mounts);
+	
+	if( !factory )
+		return 0;
+	
+	uint32_t numMedia = 0;
+	
+	if( G_TYPE_CHECK_INSTANCE_TYPE(factory, rtsp_shared_factory_get_type()) && matched == (gint)strlen(path) )
+		numMedia = __atomic_load_n(&RTSP_SHARED_FACTORY(factory)->numMedia, __ATOMIC_RELAXED);
+	
+	g_object_unref(factory);
+	return numMedia;
+}
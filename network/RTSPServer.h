@@ -28,9 +28,11 @@
 
 // forward declarations
 class Thread;
+class MetricGauge;
 
 struct _GMainLoop;
 struct _GstRTSPServer;
+struct _GstRTSPClient;
 struct _GstElement;
 
 
@@ -46,10 +48,41 @@ struct _GstElement;
  */
 #define LOG_RTSP "[rtsp]   "
 
+/**
+ * Range of multicast addresses and ports that are given out to
+ * clients that request the RTSP_MULTICAST transport.
+ * @ingroup network
+ */
+#define RTSP_MULTICAST_ADDRESS_MIN "239.255.42.1"
+#define RTSP_MULTICAST_ADDRESS_MAX "239.255.42.254"	/**< @see RTSP_MULTICAST_ADDRESS_MIN */
+#define RTSP_MULTICAST_PORT_MIN    5000			/**< @see RTSP_MULTICAST_ADDRESS_MIN */
+#define RTSP_MULTICAST_PORT_MAX    5999			/**< @see RTSP_MULTICAST_ADDRESS_MIN */
+#define RTSP_MULTICAST_TTL         16			/**< @see RTSP_MULTICAST_ADDRESS_MIN */
+
+
+/**
+ * Transports that clients can receive a route's RTP stream over (see RTSPServer::AddRoute())
+ * @ingroup network
+ */
+enum RTSPTransport
+{
+	RTSP_UDP       = (1 << 0),	// RTP over UDP unicast
+	RTSP_MULTICAST = (1 << 1),	// RTP over UDP multicast (one group shared by the clients)
+	RTSP_TCP       = (1 << 2),	// RTP interleaved in the client's RTSP/TCP connection
+	
+	RTSP_TRANSPORT_DEFAULT = RTSP_UDP|RTSP_MULTICAST|RTSP_TCP
+};
+
 
 /**
  * RTSP server for transmitting encoded GStreamer pipelines to client devices.
  * This is integrated into videoOutput/gstEncoder, but can be used standalone (@see rtsp-server example)
+ *
+ * Each route is served from one shared media, so the pipeline (and its encoder) only runs once
+ * no matter how many clients are connected - each client just gets its own RTP session.
+ * Clients that fall behind on TCP drop their own data when their send queue fills up
+ * (the queue depth is fixed by gst-rtsp-server), instead of stalling the other clients.
+ *
  * @ingroup network
  */
 class RTSPServer
@@ -70,14 +103,33 @@ public:
 	/**
 	 * Register a GStreamer pipeline to be served at the specified path.
 	 * It will be able to be viewed from clients at `rtsp://hostname:port/path`
+	 * The pipeline's payloaders should be named pay0, pay1, ect.
+	 * @param transports the RTSPTransport flags that clients are allowed to use.
 	 */
-	bool AddRoute( const char* path, _GstElement* pipeline );
+	bool AddRoute( const char* path, _GstElement* pipeline, uint32_t transports=RTSP_TRANSPORT_DEFAULT );
 	
 	/**
 	 * Create a GStreamer pipeline and register it to be served at the specified path.
 	 * It will be able to be viewed from clients at `rtsp://hostname:port/path`
+	 * @param transports the RTSPTransport flags that clients are allowed to use.
+	 */
+	bool AddRoute( const char* path, const char* pipeline, uint32_t transports=RTSP_TRANSPORT_DEFAULT );
+	
+	/**
+	 * Return the number of times that the pipeline of a route has been set up
+	 * to be streamed, which stays at 1 while it's being shared by the clients.
+	 */
+	uint32_t GetNumMedia( const char* path ) const;
+	
+	/**
+	 * Return the number of clients that are connected to the server.
+	 */
+	inline uint32_t GetNumClients() const		{ return __atomic_load_n(&mNumClients, __ATOMIC_RELAXED); }
+	
+	/**
+	 * Return the port that the server is listening on.
 	 */
-	bool AddRoute( const char* path, const char* pipeline );
+	inline uint16_t GetPort() const			{ return mPort; }
 	
 protected:
 	RTSPServer( uint16_t port );
@@ -87,8 +139,14 @@ protected:
 	
 	static void* runThread( void* user_data );
 	
+	static void onClientConnected( _GstRTSPServer* server, _GstRTSPClient* client, void* user_data );
+	static void onClientClosed( _GstRTSPClient* client, void* user_data );
+	
 	uint16_t mPort;
 	uint32_t mRefCount;
+	uint32_t mNumClients;
+	
+	MetricGauge* mClientsMetric;
 	
 	Thread* mThread;
 	bool    mRunning;
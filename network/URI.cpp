@@ -148,6 +148,14 @@ bool URI::Parse( const char* uri )
 	{
 		extension = fileExtension(location);
 	}
+	else if( protocol == "test" )
+	{
+		// the location is the test pattern and its options (see videoTestSource)
+	}
+	else if( protocol == "shm" )
+	{
+		// the location is the name of the shared memory ring (see shmSource/shmOutput)
+	}
 	else
 	{		
 		// search for ip/port format
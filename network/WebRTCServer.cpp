@@ -26,6 +26,7 @@
 #include "Thread.h"
 
 #include "json.hpp"
+#include "metrics.h"
 #include "logging.h"
 
 #include <sstream>
@@ -708,6 +709,16 @@ void WebRTCServer::onHttpDefault( SoupServer* soup_server, SoupMessage* message,
 	
 	LogVerbose(LOG_WEBRTC "%s\n", path);
 	
+	// Prometheus metrics
+	if( strcmp(path, "/metrics") == 0 )
+	{
+		const std::string metrics = Metrics::Render();
+
+		soup_message_set_response(message, Metrics::ContentType, SOUP_MEMORY_COPY, metrics.c_str(), metrics.length());
+		soup_message_set_status(message, SOUP_STATUS_OK);
+		return;
+	}
+
 	// JSON REST API
 	if( strcmp(path, "/api/streams") == 0 )
 	{
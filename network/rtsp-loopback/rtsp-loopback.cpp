@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "videoSource.h"
+#include "videoOutput.h"
+
+#include "RTSPServer.h"
+#include "gstPipelineManager.h"
+
+#include "timespec.h"
+#include "logging.h"
+#include "commandLine.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+int usage()
+{
+	printf("usage: rtsp-loopback [--help] [--clients=N] [--duration=SECONDS] [--port=PORT]\n");
+	printf("                     [--protocols=udp,tcp] [input_URI]\n\n");
+	printf("Check that an RTSP stream is only encoded once, no matter how many clients connect.\n");
+	printf("The input is encoded to rtsp://@:PORT/loopback, and rtspsrc clients connect to it\n");
+	printf("over the loopback interface.  Each client must receive RTP packets, and the\n");
+	printf("server must set up the encoder's pipeline once (returns 1 on failure).\n");
+	printf("See below for additional arguments that may not be shown above.\n\n");
+	printf("positional arguments:\n");
+	printf("    input_URI       resource URI of input stream (default is test://gradient)\n\n");
+	printf("optional arguments:\n");
+	printf("  --clients=N       number of clients to connect (default is 4)\n");
+	printf("  --duration=SEC    number of seconds to stream for (default is 10)\n");
+	printf("  --port=PORT       port of the RTSP server (default is 8554)\n");
+	printf("  --protocols=LIST  transports that the clients use, in turn (default is udp,tcp)\n");
+	printf("                    any of udp, tcp, or udp-mcast\n\n");
+
+	printf("%s", videoSource::Usage());
+	printf("%s", videoOutput::Usage());
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// client that receives the RTP stream without decoding it
+struct loopbackClient
+{
+	GstElement* pipeline;
+	std::string protocol;
+	uint64_t packets;
+	uint32_t id;
+};
+
+
+// count the packets received by a client
+static void onHandoff( GstElement* sink, GstBuffer* buffer, GstPad* pad, void* user_data )
+{
+	loopbackClient* client = (loopbackClient*)user_data;
+	__atomic_add_fetch(&client->packets, 1, __ATOMIC_RELAXED);
+}
+
+
+// connect a client to the stream
+static bool startClient( loopbackClient* client, const std::string& location )
+{
+	std::ostringstream ss;
+
+	ss << "rtspsrc location=" << location << " protocols=" << client->protocol << " latency=0 ! ";
+	ss << "fakesink name=sink sync=false signal-handoffs=true";
+
+	GError* err = NULL;
+	client->pipeline = gst_parse_launch(ss.str().c_str(), &err);
+
+	if( err != NULL )
+	{
+		LogError("rtsp-loopback:  failed to create client pipeline\n");
+		LogError("rtsp-loopback:     (%s)\n", err->message);
+		g_error_free(err);
+		return false;
+	}
+
+	GstElement* sink = gst_bin_get_by_name(GST_BIN(client->pipeline), "sink");
+
+	if( !sink )
+	{
+		LogError("rtsp-loopback:  failed to find fakesink in client pipeline\n");
+		return false;
+	}
+
+	g_signal_connect(sink, "handoff", G_CALLBACK(onHandoff), client);
+	gst_object_unref(sink);
+
+	std::ostringstream name;
+	name << "rtsp-loopback-client-" << client->id;
+
+	gstPipelineManager::Register(client->pipeline, name.str().c_str());
+
+	if( gst_element_set_state(client->pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE )
+	{
+		LogError("rtsp-loopback:  failed to start %s client\n", client->protocol.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+// disconnect a client
+static void stopClient( loopbackClient* client )
+{
+	if( !client->pipeline )
+		return;
+
+	gstPipelineManager::Unregister(client->pipeline);
+	gst_element_set_state(client->pipeline, GST_STATE_NULL);
+	gst_object_unref(client->pipeline);
+	client->pipeline = NULL;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	const uint32_t numClients = cmdLine.GetUnsignedInt("clients", 4);
+	const float duration = cmdLine.GetFloat("duration", 10.0f);
+	const uint32_t port = cmdLine.GetUnsignedInt("port", RTSP_DEFAULT_PORT);
+
+	std::vector<std::string> protocols;
+	std::istringstream protocolStream(cmdLine.GetString("protocols", "udp,tcp"));
+	std::string protocol;
+
+	while( std::getline(protocolStream, protocol, ',') )
+	{
+		if( protocol.length() > 0 )
+			protocols.push_back(protocol);
+	}
+
+	if( numClients == 0 || protocols.size() == 0 )
+		return usage();
+
+
+	/*
+	 * create input and RTSP streams
+	 */
+	videoSource* input = videoSource::Create(cmdLine.GetPosition(0, "test://gradient"), cmdLine, -1);
+
+	if( !input )
+	{
+		LogError("rtsp-loopback:  failed to create input stream\n");
+		return 1;
+	}
+
+	std::ostringstream outputURI;
+	outputURI << "rtsp://@:" << port << "/loopback";
+
+	videoOutput* output = videoOutput::Create(outputURI.str().c_str(), cmdLine);
+
+	if( !output )
+	{
+		LogError("rtsp-loopback:  failed to create RTSP stream\n");
+		return 1;
+	}
+
+	// get a reference to the server that the encoder created on this port
+	RTSPServer* server = RTSPServer::Create(port);
+
+	if( !server )
+	{
+		LogError("rtsp-loopback:  failed to get RTSP server on port %u\n", port);
+		return 1;
+	}
+
+
+	/*
+	 * stream for the duration, connecting the clients after the first second
+	 */
+	std::ostringstream location;
+	location << "rtsp://127.0.0.1:" << port << "/loopback";
+
+	std::vector<loopbackClient*> clients;
+
+	const timespec begin = timestamp();
+	uint64_t numFrames = 0;
+	int result = 0;
+
+	while( timeFloat(timeDiff(begin, timestamp())) < duration * 1000.0f )
+	{
+		void* image = NULL;
+		int status = 0;
+
+		if( !input->Capture(&image, IMAGE_UNKNOWN, 1000, &status) )
+		{
+			if( status == videoSource::TIMEOUT )
+				continue;
+
+			break; // EOS
+		}
+
+		if( !output->Render(image, input->GetWidth(), input->GetHeight(), input->GetRawFormat()) )
+			break;
+
+		numFrames++;
+
+		if( clients.size() == 0 && timeFloat(timeDiff(begin, timestamp())) > 1000.0f )
+		{
+			for( uint32_t n=0; n < numClients; n++ )
+			{
+				loopbackClient* client = new loopbackClient();
+
+				client->pipeline = NULL;
+				client->protocol = protocols[n % protocols.size()];
+				client->packets  = 0;
+				client->id       = n;
+
+				clients.push_back(client);
+
+				if( !startClient(client, location.str()) )
+					result = 1;
+			}
+		}
+	}
+
+	const float elapsed = timeFloat(timeDiff(begin, timestamp())) * 0.001f;
+	LogInfo("rtsp-loopback:  encoded %llu frames in %.2fs -- %.1f FPS\n", (unsigned long long)numFrames, elapsed, numFrames / elapsed);
+
+
+	/*
+	 * check that every client received the stream from the one shared media
+	 */
+	const uint32_t numMedia = server->GetNumMedia("/loopback");
+	const uint32_t connected = server->GetNumClients();
+
+	for( size_t n=0; n < clients.size(); n++ )
+	{
+		const uint64_t packets = __atomic_load_n(&clients[n]->packets, __ATOMIC_RELAXED);
+
+		if( packets > 0 )
+			LogSuccess("rtsp-loopback:  client %zu (%s) received %llu packets\n", n, clients[n]->protocol.c_str(), (unsigned long long)packets);
+		else
+		{
+			LogError("rtsp-loopback:  client %zu (%s) didn't receive any packets\n", n, clients[n]->protocol.c_str());
+			result = 1;
+		}
+	}
+
+	if( clients.size() != numClients )
+	{
+		LogError("rtsp-loopback:  only %zu of %u clients were started\n", clients.size(), numClients);
+		result = 1;
+	}
+
+	if( connected < numClients )
+	{
+		LogError("rtsp-loopback:  only %u of %u clients were connected to the server\n", connected, numClients);
+		result = 1;
+	}
+
+	if( numMedia == 1 )
+		LogSuccess("rtsp-loopback:  the encoder pipeline was set up once for %u clients\n", numClients);
+	else
+	{
+		LogError("rtsp-loopback:  the encoder pipeline was set up %u times for %u clients (expected once)\n", numMedia, numClients);
+		result = 1;
+	}
+
+
+	/*
+	 * destroy resources
+	 */
+	for( size_t n=0; n < clients.size(); n++ )
+	{
+		stopClient(clients[n]);
+		delete clients[n];
+	}
+
+	server->Release();
+
+	SAFE_DELETE(output);
+	SAFE_DELETE(input);
+
+	LogInfo("rtsp-loopback:  %s\n", (result == 0) ? "passed" : "failed");
+	return result;
+}
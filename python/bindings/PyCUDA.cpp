@@ -301,6 +301,11 @@ bool PyCudaMemory_RegisterType( PyObject* module )
 }
 
 //-------------------------------------------------------------------------------
+static PyTypeObject pyCudaImage_Type = 
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
 // PyCudaImage_New
 static PyObject* PyCudaImage_New( PyTypeObject *type, PyObject *args, PyObject *kwds )
 {
@@ -330,11 +335,23 @@ static PyObject* PyCudaImage_New( PyTypeObject *type, PyObject *args, PyObject *
 	
 	self->format = IMAGE_UNKNOWN;
 	self->timestamp = 0;
+	self->parent = NULL;
 	self->cudaArrayInterfaceDict = NULL;
 	
 	return (PyObject*)self;
 }
 
+// PyCudaImage_Dealloc
+static void PyCudaImage_Dealloc( PyCudaImage* self )
+{
+	Py_CLEAR(self->cudaArrayInterfaceDict);
+	
+	// views have freeOnDelete=false, so the memory stays with the parent
+	Py_CLEAR(self->parent);
+	
+	PyCudaMemory_Dealloc((PyCudaMemory*)self);
+}
+
 // PyCudaImage_Config
 static void PyCudaImage_Config( PyCudaImage* self, void* ptr, uint32_t width, uint32_t height, imageFormat format, uint64_t timestamp, bool mapped, bool freeOnDelete )
 {
@@ -360,6 +377,7 @@ static void PyCudaImage_Config( PyCudaImage* self, void* ptr, uint32_t width, ui
 
 	self->format = format;
 	self->timestamp = timestamp;
+	self->parent = NULL;
 	self->cudaArrayInterfaceDict = NULL;
 }
 
@@ -529,6 +547,34 @@ static PyObject* PyCudaImage_GetShape( PyCudaImage* self, void* closure )
 	return tuple;
 }
 
+// PyCudaImage_GetStrides
+static PyObject* PyCudaImage_GetStrides( PyCudaImage* self, void* closure )
+{
+	PyObject* rows     = PYLONG_FROM_LONG(self->strides[0]);
+	PyObject* pixels   = PYLONG_FROM_LONG(self->strides[1]);
+	PyObject* channels = PYLONG_FROM_LONG(self->strides[2]);
+
+	PyObject* tuple = PyTuple_Pack(3, rows, pixels, channels);
+
+	Py_DECREF(rows);
+	Py_DECREF(pixels);
+	Py_DECREF(channels);
+
+	return tuple;
+}
+
+// PyCudaImage_GetPitch
+static PyObject* PyCudaImage_GetPitch( PyCudaImage* self, void* closure )
+{
+	return PYLONG_FROM_UNSIGNED_LONG(self->strides[0]);
+}
+
+// PyCudaImage_GetContiguous
+static PyObject* PyCudaImage_GetContiguous( PyCudaImage* self, void* closure )
+{
+	PY_RETURN_BOOL(PyCUDA_IsContiguous(self));
+}
+
 // PyCudaImage_GetFormat
 static PyObject* PyCudaImage_GetFormat( PyCudaImage* self, void* closure )
 {
@@ -552,6 +598,8 @@ static const char* imageFormatToNumpyTypeStr( imageFormat format )
 		return "<f4";
 	else if( baseType == IMAGE_UINT8 )
 		return "<u1";
+	else if( baseType == IMAGE_UINT16 )
+		return "<u2";
 
 	return "V";
 }
@@ -585,9 +633,18 @@ static PyObject* PyCudaImage_GetCudaArrayInterface( PyCudaImage* self, void* clo
 	
 	Py_DECREF(data_ptr);
 
+	// strides are only given for views (None means C-contiguous)
+	PyObject* strides = Py_None;
+	
+	if( PyCUDA_IsContiguous(self) )
+		Py_INCREF(strides);
+	else
+		strides = PyCudaImage_GetStrides(self, closure);
+
 	// set dictionary keys
 	DICT_SET(dict, "shape", shape);
 	DICT_SET(dict, "typestr", typestr);
+	DICT_SET(dict, "strides", strides);
 	DICT_SET(dict, "data", data_tuple);
 	DICT_SET(dict, "version", version);
 	
@@ -626,9 +683,8 @@ static int PyCudaImage_ParseSubscriptTuple(PyCudaImage* self, PyObject* tuple, i
 	if( tupleSize <= 0 || tupleSize > 3 )
 		return -1;
 
-	const size_t imgChannels = imageFormatChannels(self->format);
-	const size_t dimSize[] = { self->height, self->width, imgChannels };
-	int dims[] = {-1, -1, -1};
+	const long dimSize[] = { (long)self->shape[0], (long)self->shape[1], (long)self->shape[2] };
+	long dims[] = {-1, -1, -1};
 
 	for( int n=0; n < tupleSize; n++ )
 	{
@@ -656,26 +712,24 @@ static int PyCudaImage_ParseSubscriptTuple(PyCudaImage* self, PyObject* tuple, i
 		}
 	}
 	
-	const size_t pixelDepth = imageFormatDepth(self->format);
-	const size_t baseDepth = pixelDepth / imgChannels;
-	
+	// the byte offsets use the strides, so that views with a pitch work too
 	if( tupleSize == 1 )
 	{
 		// pixel index - img[y * img.width + x]
-		*numComponents = imageFormatChannels(self->format);
-		return (dims[0] * pixelDepth) / 8;
+		*numComponents = self->shape[2];
+		return (dims[0] / self->width) * self->strides[0] + (dims[0] % self->width) * self->strides[1];
 	}
 	else if( tupleSize == 2 )
 	{
 		// y, x index - img[y,x]
-		*numComponents = imageFormatChannels(self->format);
-		return ((dims[0] * self->width + dims[1]) * pixelDepth) / 8;
+		*numComponents = self->shape[2];
+		return dims[0] * self->strides[0] + dims[1] * self->strides[1];
 	}
 	else if( tupleSize == 3 )
 	{
 		// individual component index - img[y,x,channel]
 		*numComponents = 1;
-		return (((dims[0] * self->width + dims[1]) * pixelDepth) + dims[2] * baseDepth) / 8;	// return byte offset
+		return dims[0] * self->strides[0] + dims[1] * self->strides[1] + dims[2] * self->strides[2];	// return byte offset
 	}
 
 	return -1;
@@ -715,14 +769,188 @@ static int PyCudaImage_ParseSubscript(PyCudaImage* self, PyObject* key, int* num
 		return -1;
 	}
 
-	*numComponents = imageFormatChannels(self->format);
-	offset = (offset * imageFormatDepth(self->format)) / 8;
-	return offset;
+	*numComponents = self->shape[2];
+	return (offset / self->width) * self->strides[0] + (offset % self->width) * self->strides[1];
+}
+
+// PyCudaImage_IsSliceKey
+static bool PyCudaImage_IsSliceKey( PyObject* key )
+{
+	if( PySlice_Check(key) )
+		return true;
+
+	if( !PyTuple_Check(key) )
+		return false;
+
+	const Py_ssize_t tupleSize = PyTuple_Size(key);
+
+	for( Py_ssize_t n=0; n < tupleSize; n++ )
+	{
+		if( PySlice_Check(PyTuple_GetItem(key, n)) )
+			return true;
+	}
+
+	return false;
+}
+
+// PyCudaImage_ParseSliceRange
+static bool PyCudaImage_ParseSliceRange( PyObject* item, Py_ssize_t dimSize, Py_ssize_t* start, Py_ssize_t* step, Py_ssize_t* length )
+{
+	if( PySlice_Check(item) )
+	{
+		Py_ssize_t stop = 0;
+
+	#if PY_MAJOR_VERSION >= 3
+		if( PySlice_GetIndicesEx(item, dimSize, start, &stop, step, length) < 0 )
+	#else
+		if( PySlice_GetIndicesEx((PySliceObject*)item, dimSize, start, &stop, step, length) < 0 )
+	#endif
+			return false;
+
+		if( *step <= 0 )
+		{
+			PyErr_SetString(PyExc_ValueError, LOG_PY_UTILS "cudaImage slices need to have a positive step");
+			return false;
+		}
+
+		if( *length <= 0 )
+		{
+			PyErr_SetString(PyExc_IndexError, LOG_PY_UTILS "cudaImage slice was empty");
+			return false;
+		}
+
+		return true;
+	}
+
+	// integers select a single row/column/channel (the dimension is kept)
+	const long index = PYLONG_AS_LONG(item);
+
+	if( index == -1 && PyErr_Occurred() != NULL )
+	{
+		PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "cudaImage subscript had invalid element in key tuple");
+		return false;
+	}
+
+	*start = (index < 0) ? index + dimSize : index;
+	*step = 1;
+	*length = 1;
+
+	if( *start < 0 || *start >= dimSize )
+	{
+		PyErr_SetString(PyExc_IndexError, LOG_PY_UTILS "cudaImage subscript was out of range");
+		return false;
+	}
+
+	return true;
+}
+
+// PyCudaImage_FormatFromChannels
+static imageFormat PyCudaImage_FormatFromChannels( imageFormat format, size_t channels )
+{
+	if( channels == imageFormatChannels(format) )
+		return format;
+
+	if( channels == 1 )
+	{
+		const imageBaseType baseType = imageFormatBaseType(format);
+
+		if( baseType == IMAGE_FLOAT )
+			return IMAGE_GRAY32F;
+		else if( baseType == IMAGE_UINT16 )
+			return IMAGE_GRAY16;
+		else
+			return IMAGE_GRAY8;
+	}
+	else if( channels == 3 )
+	{
+		switch(format)
+		{
+			case IMAGE_RGBA8:	return IMAGE_RGB8;
+			case IMAGE_BGRA8:	return IMAGE_BGR8;
+			case IMAGE_RGBA16:	return IMAGE_RGB16;
+			case IMAGE_RGBA32F:	return IMAGE_RGB32F;
+			case IMAGE_BGRA32F:	return IMAGE_BGR32F;
+			default:			break;
+		}
+	}
+
+	return IMAGE_UNKNOWN;
+}
+
+// PyCudaImage_Slice
+static PyObject* PyCudaImage_Slice( PyCudaImage* self, PyObject* key )
+{
+	if( self->format == IMAGE_UNKNOWN || imageFormatIsYUV(self->format) )
+	{
+		PyErr_Format(PyExc_TypeError, LOG_PY_UTILS "cudaImage slicing isn't supported for %s images", imageFormatToStr(self->format));
+		return NULL;
+	}
+
+	// support between 1 and 3 slices:
+	//    1. img[y0:y1]
+	//    2. img[y0:y1, x0:x1]
+	//    3. img[y0:y1, x0:x1, c0:c1]
+	const bool isTuple = PyTuple_Check(key);
+	const Py_ssize_t numKeys = isTuple ? PyTuple_Size(key) : 1;
+
+	if( numKeys <= 0 || numKeys > 3 )
+	{
+		PyErr_SetString(PyExc_IndexError, LOG_PY_UTILS "cudaImage slices can have up to 3 dimensions (y, x, channel)");
+		return NULL;
+	}
+
+	Py_ssize_t start[] = { 0, 0, 0 };
+	Py_ssize_t step[] = { 1, 1, 1 };
+	Py_ssize_t length[] = { self->shape[0], self->shape[1], self->shape[2] };
+
+	for( Py_ssize_t n=0; n < numKeys; n++ )
+	{
+		if( !PyCudaImage_ParseSliceRange(isTuple ? PyTuple_GetItem(key, n) : key, self->shape[n], &start[n], &step[n], &length[n]) )
+			return NULL;
+	}
+
+	const imageFormat format = PyCudaImage_FormatFromChannels(self->format, length[2]);
+
+	if( format == IMAGE_UNKNOWN )
+	{
+		PyErr_Format(PyExc_IndexError, LOG_PY_UTILS "cudaImage channel slice of %s image needs to select 1, 3, or all of the channels", imageFormatToStr(self->format));
+		return NULL;
+	}
+
+	PyCudaImage* view = PyObject_New(PyCudaImage, &pyCudaImage_Type);
+
+	if( !view )
+	{
+		PyErr_SetString(PyExc_MemoryError, LOG_PY_UTILS "cudaImage slice failed to create a new cudaImage object");
+		return NULL;
+	}
+
+	// the view references the parent's memory, with the parent's strides
+	uint8_t* ptr = (uint8_t*)self->base.ptr + start[0] * self->strides[0] + start[1] * self->strides[1] + start[2] * self->strides[2];
+
+	PyCudaImage_Config(view, ptr, length[1], length[0], format, self->timestamp, self->base.mapped, false);
+
+	const Py_ssize_t channelSize = view->strides[2];
+
+	for( int n=0; n < 3; n++ )
+		view->strides[n] = self->strides[n] * step[n];
+
+	view->base.size = (length[0] - 1) * view->strides[0] + (length[1] - 1) * view->strides[1] + (length[2] - 1) * view->strides[2] + channelSize;
+	view->base.stream = self->base.stream;
+
+	// keep the image that owns the memory alive for as long as the view
+	view->parent = (self->parent != NULL) ? self->parent : (PyObject*)self;
+	Py_INCREF(view->parent);
+
+	return (PyObject*)view;
 }
 
 // PyCudaImage_GetItem
 static PyObject* PyCudaImage_GetItem(PyCudaImage *self, PyObject *key)
 {
+	if( PyCudaImage_IsSliceKey(key) )
+		return PyCudaImage_Slice(self, key);
+
 	if( !self->base.mapped )
 	{
 		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "cudaImage subscript operator can only operate on mapped/zeroCopy memory");
@@ -747,11 +975,14 @@ static PyObject* PyCudaImage_GetItem(PyCudaImage *self, PyObject *key)
 		for( int n=0; n < numComponents; n++ )
 		{
 			PyObject* component = NULL;
+			uint8_t* channel = ptr + n * self->strides[2];
 
 			if( baseType == IMAGE_FLOAT )
-				component = PyFloat_FromDouble(((float*)ptr)[n]);
+				component = PyFloat_FromDouble(*(float*)channel);
 			else if( baseType == IMAGE_UINT8 )
-				component = PYLONG_FROM_UNSIGNED_LONG(ptr[n]);
+				component = PYLONG_FROM_UNSIGNED_LONG(*channel);
+			else if( baseType == IMAGE_UINT16 )
+				component = PYLONG_FROM_UNSIGNED_LONG(*(uint16_t*)channel);
 			
 			PyTuple_SetItem(tuple, n, component);
 		}
@@ -764,6 +995,8 @@ static PyObject* PyCudaImage_GetItem(PyCudaImage *self, PyObject *key)
 			return PyFloat_FromDouble(((float*)ptr)[0]);
 		else if( baseType == IMAGE_UINT8 )
 			return PYLONG_FROM_UNSIGNED_LONG(ptr[0]);
+		else if( baseType == IMAGE_UINT16 )
+			return PYLONG_FROM_UNSIGNED_LONG(((uint16_t*)ptr)[0]);
 		else
 			return NULL;  // suppress compiler return warning
 	}
@@ -772,6 +1005,12 @@ static PyObject* PyCudaImage_GetItem(PyCudaImage *self, PyObject *key)
 // PyCudaImage_SetItem
 static int PyCudaImage_SetItem( PyCudaImage* self, PyObject* key, PyObject* value )
 {
+	if( PyCudaImage_IsSliceKey(key) )
+	{
+		PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "cudaImage slices can't be assigned to (use cudaMemcpy(img[y0:y1,x0:x1], src) instead)");
+		return -1;
+	}
+
 	if( !self->base.mapped )
 	{
 		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "cudaImage subscript operator can only operate on mapped/zeroCopy memory");
@@ -786,7 +1025,6 @@ static int PyCudaImage_SetItem( PyCudaImage* self, PyObject* key, PyObject* valu
 	
 	// apply offset to the data pointer
 	uint8_t* ptr = ((uint8_t*)self->base.ptr) + offset;
-	const size_t imgChannels = imageFormatChannels(self->format);
 	const imageBaseType baseType = imageFormatBaseType(self->format);
 	
 	// if this is a list, convert it to tuple
@@ -809,10 +1047,14 @@ static int PyCudaImage_SetItem( PyCudaImage* self, PyObject* key, PyObject* valu
 			return -1; 								\
 		} 											\
 													\
+		uint8_t* dst = ptr + (channel) * self->strides[2];	\
+													\
 		if( baseType == IMAGE_FLOAT )				\
-			((float*)ptr)[channel] = val;			\
+			*(float*)dst = val;						\
 		else if( baseType == IMAGE_UINT8 )			\
-			ptr[channel] = val;						\
+			*dst = val;								\
+		else if( baseType == IMAGE_UINT16 )			\
+			*(uint16_t*)dst = val;					\
 	}
 	
 	// check if this is a tuple
@@ -879,11 +1121,19 @@ static int PyCudaImage_GetBuffer(PyCudaImage* self, Py_buffer* view, int flags)
 		return -1;
 	}	
 	
+	const bool contiguous = PyCUDA_IsContiguous(self);
+
+	if( !contiguous && (flags & PyBUF_STRIDES) != PyBUF_STRIDES )
+	{
+		PyErr_SetString(PyExc_BufferError, "cudaImage - view isn't contiguous, so the buffer needs to be requested with strides");
+		return -1;
+	}
+
 	view->obj = (PyObject*)self;
 	view->buf = (void*)self->base.ptr;
-	view->len = self->base.size;
 	view->readonly = 0;
-	view->itemsize = (imageFormatDepth(self->format) / 8) / imageFormatChannels(self->format);
+	view->itemsize = (imageFormatBaseType(self->format) == IMAGE_UINT16) ? sizeof(uint16_t) : (imageFormatDepth(self->format) / 8) / imageFormatChannels(self->format);
+	view->len = contiguous ? self->base.size : self->shape[0] * self->shape[1] * self->shape[2] * view->itemsize;
 	
 	view->ndim = 3; //(self->shape[2] > 1) ? 3 : 2;
 	view->shape = self->shape;  // length-1 sequence of dimensions
@@ -910,6 +1160,12 @@ static int PyCudaImage_GetBuffer(PyCudaImage* self, Py_buffer* view, int flags)
 		case IMAGE_RGB32F:		
 		case IMAGE_RGBA32F: 	
 		case IMAGE_GRAY32F:		view->format = "f"; break;
+		case IMAGE_NV16:		view->format = "B";	break;
+		case IMAGE_RGB16:
+		case IMAGE_RGBA16:
+		case IMAGE_GRAY16:
+		case IMAGE_P010:
+		case IMAGE_P016:		view->format = "H";	break;
 	}
 	
 	Py_INCREF(self);
@@ -930,6 +1186,9 @@ static PyGetSetDef pyCudaImage_GetSet[] =
 	{ "height", (getter)PyCudaImage_GetHeight, NULL, "Height of the image (in pixels)", NULL},
 	{ "channels", (getter)PyCudaImage_GetChannels, NULL, "Number of color channels in the image", NULL},
 	{ "shape", (getter)PyCudaImage_GetShape, NULL, "Image dimensions in (height, width, channels) tuple", NULL},
+	{ "strides", (getter)PyCudaImage_GetStrides, NULL, "Byte strides between rows, pixels, and channels in (y, x, channel) tuple", NULL},
+	{ "pitch", (getter)PyCudaImage_GetPitch, NULL, "Byte stride between rows of the image", NULL},
+	{ "contiguous", (getter)PyCudaImage_GetContiguous, NULL, "False if the image is a view with padded rows or strided pixels/channels", NULL},
 	{ "format", (getter)PyCudaImage_GetFormat, NULL, "Pixel format of the image", NULL},
 	{ "timestamp", (getter)PyCudaImage_GetTimestamp, NULL, "Timestamp of the image (in nanoseconds)", NULL},
 	{ "__array_interface__", (getter)PyCudaImage_GetArrayInterface, NULL, "Numpy __array_interface__ dict", NULL},
@@ -937,11 +1196,6 @@ static PyGetSetDef pyCudaImage_GetSet[] =
 	{ NULL } /* Sentinel */
 };
 
-static PyTypeObject pyCudaImage_Type = 
-{
-    PyVarObject_HEAD_INIT(NULL, 0)
-};
-
 // PyCudaImage_RegisterType
 bool PyCudaImage_RegisterType( PyObject* module )
 {
@@ -957,7 +1211,7 @@ bool PyCudaImage_RegisterType( PyObject* module )
 	pyCudaImage_Type.tp_as_mapping = &pyCudaImage_AsMapping;
 	pyCudaImage_Type.tp_new     = PyCudaImage_New;
 	pyCudaImage_Type.tp_init    = (initproc)PyCudaImage_Init;
-	pyCudaImage_Type.tp_dealloc	= NULL; /*(destructor)PyCudaMemory_Dealloc*/;
+	pyCudaImage_Type.tp_dealloc	= (destructor)PyCudaImage_Dealloc;
 	pyCudaImage_Type.tp_str		= (reprfunc)PyCudaImage_ToString;
 	pyCudaImage_Type.tp_doc  	= "CUDA image";
 	
@@ -1090,6 +1344,9 @@ void* PyCUDA_GetImage( PyObject* capsule, int* width, int* height, imageFormat*
 
 	if( img != NULL )
 	{
+		if( !PyCUDA_CheckContiguous(img, NULL) )
+			return NULL;
+
 		ptr = img->base.ptr;
 		*width = img->width;
 		*height = img->height;
@@ -1132,6 +1389,52 @@ void* PyCUDA_GetImage( PyObject* capsule, int* width, int* height, imageFormat*
 }
 
 
+// PyCUDA_IsContiguous
+bool PyCUDA_IsContiguous( PyCudaImage* image )
+{
+	if( !image )
+		return false;
+
+	const size_t bitDepth = imageFormatDepth(image->format);
+
+	return image->strides[0] == (image->width * bitDepth) / 8 && 
+		  image->strides[1] == bitDepth / 8 && 
+		  image->shape[2] == imageFormatChannels(image->format);
+}
+
+// PyCUDA_CheckContiguous
+bool PyCUDA_CheckContiguous( PyCudaImage* image, const char* function )
+{
+	if( PyCUDA_IsContiguous(image) )
+		return true;
+
+	PyErr_Format(PyExc_Exception, LOG_PY_UTILS "%s%s was passed a cudaImage view that isn't contiguous (make a contiguous copy of it with cudaMemcpy() first)", 
+			   function != NULL ? function : "function", function != NULL ? "()" : "");
+
+	return false;
+}
+
+// PyCudaImage_GetView
+static bool PyCudaImage_GetView( PyCudaImage* image, cudaImageView* view, const char* function )
+{
+	if( PyCUDA_IsContiguous(image) )
+	{
+		*view = cudaImageView(image->base.ptr, image->width, image->height, image->format);
+		return true;
+	}
+
+	// views with a row pitch are supported, but the pixels need to be packed
+	if( image->strides[1] != imageFormatDepth(image->format) / 8 || image->shape[2] != imageFormatChannels(image->format) )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_UTILS "%s() doesn't support cudaImage views with strided pixels or channels", function);
+		return false;
+	}
+
+	*view = cudaImageView(image->base.ptr, image->width, image->height, image->strides[0], image->format);
+	return true;
+}
+
+
 //-------------------------------------------------------------------------------
 // PyCUDA_Malloc
 PyObject* PyCUDA_Malloc( PyObject* self, PyObject* args, PyObject* kwds )
@@ -1317,14 +1620,17 @@ PyObject* PyCUDA_Memcpy( PyObject* self, PyObject* args, PyObject* kwds )
 	if( !dst_capsule )
 	{
 	    void* dst_ptr = NULL;
+	    
+	    // views get copied into a contiguous image
+	    const size_t dst_size = (src_img != NULL) ? imageFormatSize(src_img->format, src_img->width, src_img->height) : src_mem->size;
 
 	    if( mapped )
 	    {
-	        PYCUDA_ASSERT_NOGIL(cudaMallocMapped(&dst_ptr, src_mem->size, false));
+	        PYCUDA_ASSERT_NOGIL(cudaMallocMapped(&dst_ptr, dst_size, false));
 		}
 		else
 		{
-		    PYCUDA_ASSERT_NOGIL(cudaMalloc(&dst_ptr, src_mem->size));
+		    PYCUDA_ASSERT_NOGIL(cudaMalloc(&dst_ptr, dst_size));
 		}
 
 		if( src_img != NULL )
@@ -1344,16 +1650,48 @@ PyObject* PyCUDA_Memcpy( PyObject* self, PyObject* args, PyObject* kwds )
         return NULL;
     }
     
-    if( src_mem->size != dst_mem->size )
+    if( (src_img != NULL && !PyCUDA_IsContiguous(src_img)) || (dst_img != NULL && !PyCUDA_IsContiguous(dst_img)) )
     {
-        PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "src and dst need to have the same size");
-        return NULL;
-    }
-    
-    if( src_img && dst_img )
+        // copy row-by-row to/from views with a pitch
+        cudaImageView src_view;
+        cudaImageView dst_view;
+        
+        if( !src_img || !dst_img )
+        {
+            PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "src and dst both need to be cudaImage when copying a view");
+            return NULL;
+        }
+        
+        if( !PyCudaImage_GetView(src_img, &src_view, "cudaMemcpy") || !PyCudaImage_GetView(dst_img, &dst_view, "cudaMemcpy") )
+        {
+            if( dst_allocated )
+                Py_DECREF(dst_capsule);
+            
+            return NULL;
+        }
+        
+        if( src_img->width != dst_img->width || src_img->height != dst_img->height || src_img->format != dst_img->format )
+        {
+            PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "src and dst need to have the same dimensions and format");
+            return NULL;
+        }
+        
         dst_img->timestamp = src_img->timestamp;
+        PYCUDA_ASSERT(cudaImageCopy(src_view, dst_view, stream));
+    }
+    else
+    {
+        if( src_mem->size != dst_mem->size )
+        {
+            PyErr_SetString(PyExc_TypeError, LOG_PY_UTILS "src and dst need to have the same size");
+            return NULL;
+        }
+        
+        if( src_img && dst_img )
+            dst_img->timestamp = src_img->timestamp;
 
-	PYCUDA_ASSERT(cudaMemcpyAsync(dst_mem->ptr, src_mem->ptr, src_mem->size, cudaMemcpyDeviceToDevice, stream));
+        PYCUDA_ASSERT(cudaMemcpyAsync(dst_mem->ptr, src_mem->ptr, src_mem->size, cudaMemcpyDeviceToDevice, stream));
+    }
 
 	if( dst_allocated )
 		return dst_capsule;
@@ -1590,7 +1928,19 @@ PyObject* PyCUDA_ConvertColor( PyObject* self, PyObject* args, PyObject* kwds )
 	}
 
 	// run the CUDA function
-	PYCUDA_ASSERT_NOGIL(cudaConvertColor(input->base.ptr, input->format, output->base.ptr, output->format, input->width, input->height, stream));
+	if( PyCUDA_IsContiguous(input) && PyCUDA_IsContiguous(output) )
+	{
+		PYCUDA_ASSERT_NOGIL(cudaConvertColor(input->base.ptr, input->format, output->base.ptr, output->format, input->width, input->height, stream));
+	}
+	else
+	{
+		cudaImageView inputView, outputView;
+
+		if( !PyCudaImage_GetView(input, &inputView, "cudaConvertColor") || !PyCudaImage_GetView(output, &outputView, "cudaConvertColor") )
+			return NULL;
+
+		PYCUDA_ASSERT_NOGIL(cudaConvertColor(inputView, outputView, make_float2(0,255), stream));
+	}
 
 	output->timestamp = input->timestamp;
 
@@ -1632,7 +1982,19 @@ PyObject* PyCUDA_Resize( PyObject* self, PyObject* args, PyObject* kwds )
 	}
 
 	// run the CUDA function
-	PYCUDA_ASSERT_NOGIL(cudaResize(input->base.ptr, input->width, input->height, output->base.ptr, output->width, output->height, output->format, filter_mode, stream));
+	if( PyCUDA_IsContiguous(input) && PyCUDA_IsContiguous(output) )
+	{
+		PYCUDA_ASSERT_NOGIL(cudaResize(input->base.ptr, input->width, input->height, output->base.ptr, output->width, output->height, output->format, filter_mode, stream));
+	}
+	else
+	{
+		cudaImageView inputView, outputView;
+
+		if( !PyCudaImage_GetView(input, &inputView, "cudaResize") || !PyCudaImage_GetView(output, &outputView, "cudaResize") )
+			return NULL;
+
+		PYCUDA_ASSERT_NOGIL(cudaResize(inputView, outputView, filter_mode, stream));
+	}
 
 	output->timestamp = input->timestamp;
 
@@ -1685,7 +2047,19 @@ PyObject* PyCUDA_Crop( PyObject* self, PyObject* args, PyObject* kwds )
 	}
 
 	// run the CUDA function
-	PYCUDA_ASSERT_NOGIL(cudaCrop(input->base.ptr, output->base.ptr, make_int4(left, top, right, bottom), input->width, input->height, input->format, stream));
+	if( PyCUDA_IsContiguous(input) && PyCUDA_IsContiguous(output) )
+	{
+		PYCUDA_ASSERT_NOGIL(cudaCrop(input->base.ptr, output->base.ptr, make_int4(left, top, right, bottom), input->width, input->height, input->format, stream));
+	}
+	else
+	{
+		cudaImageView inputView, outputView;
+
+		if( !PyCudaImage_GetView(input, &inputView, "cudaCrop") || !PyCudaImage_GetView(output, &outputView, "cudaCrop") )
+			return NULL;
+
+		PYCUDA_ASSERT_NOGIL(cudaCrop(inputView, outputView, make_int4(left, top, right, bottom), stream));
+	}
 
 	output->timestamp = input->timestamp;
 
@@ -1733,6 +2107,9 @@ PyObject* PyCUDA_Normalize( PyObject* self, PyObject* args, PyObject* kwds )
 		return NULL;
 	}
 
+	if( !PyCUDA_CheckContiguous(input, "cudaNormalize") || !PyCUDA_CheckContiguous(output, "cudaNormalize") )
+		return NULL;
+
 	// run the CUDA function
 	PYCUDA_ASSERT_NOGIL(cudaNormalize(input->base.ptr, make_float2(input_min, input_max), output->base.ptr, make_float2(output_min, output_max), output->width, output->height, output->format, stream));
 
@@ -1777,7 +2154,19 @@ PyObject* PyCUDA_Overlay( PyObject* self, PyObject* args, PyObject* kwds )
 	}
 
 	// run the CUDA function
-	PYCUDA_ASSERT_NOGIL(cudaOverlay(input->base.ptr, input->width, input->height, output->base.ptr, output->width, output->height, output->format, x, y, stream));
+	if( PyCUDA_IsContiguous(input) && PyCUDA_IsContiguous(output) )
+	{
+		PYCUDA_ASSERT_NOGIL(cudaOverlay(input->base.ptr, input->width, input->height, output->base.ptr, output->width, output->height, output->format, x, y, stream));
+	}
+	else
+	{
+		cudaImageView inputView, outputView;
+
+		if( !PyCudaImage_GetView(input, &inputView, "cudaOverlay") || !PyCudaImage_GetView(output, &outputView, "cudaOverlay") )
+			return NULL;
+
+		PYCUDA_ASSERT_NOGIL(cudaOverlay(inputView, outputView, x, y, stream));
+	}
 
 	output->timestamp = input->timestamp;
 
@@ -1836,6 +2225,9 @@ PyObject* PyCUDA_DrawCircle( PyObject* self, PyObject* args, PyObject* kwds )
 	if( !PyArg_ParseTuple(pyColor, "fff|f", &color.x, &color.y, &color.z, &color.w) )
 		return NULL;
 
+	if( !PyCUDA_CheckContiguous(input, "cudaDrawCircle") || !PyCUDA_CheckContiguous(output, "cudaDrawCircle") )
+		return NULL;
+
 	// run the CUDA function
 	PYCUDA_ASSERT_NOGIL(cudaDrawCircle(input->base.ptr, output->base.ptr, input->width, input->height,
 							           input->format, x, y, radius, color, stream));
@@ -1898,6 +2290,9 @@ PyObject* PyCUDA_DrawLine( PyObject* self, PyObject* args, PyObject* kwds )
 	if( !PyArg_ParseTuple(pyColor, "fff|f", &color.x, &color.y, &color.z, &color.w) )
 		return NULL;
 
+	if( !PyCUDA_CheckContiguous(input, "cudaDrawLine") || !PyCUDA_CheckContiguous(output, "cudaDrawLine") )
+		return NULL;
+
 	// run the CUDA function
 	PYCUDA_ASSERT_NOGIL(cudaDrawLine(input->base.ptr, output->base.ptr, input->width, input->height,
 						             input->format, x1, y1, x2, y2, color, line_width, stream));
@@ -1977,6 +2372,9 @@ PyObject* PyCUDA_DrawRect( PyObject* self, PyObject* args, PyObject* kwds )
 		return NULL;
 	}
 
+	if( !PyCUDA_CheckContiguous(input, "cudaDrawRect") || !PyCUDA_CheckContiguous(output, "cudaDrawRect") )
+		return NULL;
+
 	// run the CUDA function
 	PYCUDA_ASSERT_NOGIL(cudaDrawRect(input->base.ptr, output->base.ptr, input->width, input->height, input->format,
 						             left, top, right, bottom, color, line_color, line_width, stream));
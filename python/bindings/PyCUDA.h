@@ -45,7 +45,8 @@ typedef struct {
 	uint32_t    width;
 	uint32_t    height;
 	Py_ssize_t  shape[3];
-	Py_ssize_t  strides[3];
+	Py_ssize_t  strides[3];  // in bytes (the row stride is the pitch)
+	PyObject*   parent;      // image that owns the memory (when this is a view, otherwise NULL)
 	PyObject*   cudaArrayInterfaceDict;  // https://numba.readthedocs.io/en/stable/cuda/cuda_array_interface.html
 } PyCudaImage;
 
@@ -68,6 +69,12 @@ PyCudaImage* PyCUDA_GetImage( PyObject* object );
 // retrieve from capsule
 void* PyCUDA_GetImage( PyObject* object, int* width, int* height, imageFormat* format, uint64_t* timestamp=NULL );
 
+// check if the pixels and rows are tightly packed (views from slicing may not be)
+bool PyCUDA_IsContiguous( PyCudaImage* image );
+
+// raise an exception from the named function if the image isn't contiguous
+bool PyCUDA_CheckContiguous( PyCudaImage* image, const char* function );
+
 // Register functions
 PyMethodDef* PyCUDA_RegisterFunctions();
 
@@ -167,6 +167,9 @@ PyObject* PyImageIO_Save( PyObject* self, PyObject* args, PyObject* kwds )
 		return NULL;
 	}
 
+	if( !PyCUDA_CheckContiguous(img, "saveImage") )
+		return NULL;
+
 	// save the image
     bool result = false;
 	Py_BEGIN_ALLOW_THREADS
@@ -213,6 +216,9 @@ PyObject* PyImageIO_SaveRGBA( PyObject* self, PyObject* args, PyObject* kwds )
 			return NULL;
 		}
 
+		if( !PyCUDA_CheckContiguous(img, "saveImageRGBA") )
+			return NULL;
+
         Py_BEGIN_ALLOW_THREADS
 		save_result = saveImage(filename, img->base.ptr, img->width, img->height, img->format, quality, make_float2(0,max_pixel), true, stream);
 		Py_END_ALLOW_THREADS
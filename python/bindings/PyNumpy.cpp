@@ -44,6 +44,8 @@ static int PyNumpy_ConvertFormat( imageFormat format )
 		return NPY_FLOAT32;
 	else if( baseType == IMAGE_UINT8 )
 		return NPY_UINT8;
+	else if( baseType == IMAGE_UINT16 )
+		return NPY_UINT16;
 
 	return NPY_VOID;
 }
@@ -78,6 +80,9 @@ PyObject* PyNumpy_FromCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 	int type = NPY_FLOAT32;	// float is assumed for PyCudaMemory case, but inferred for PyCudaImage case
 	bool mapped = false;
 	
+	npy_intp strides[] = { 0, 0, 0 };
+	bool strided = false;	// views from slicing a cudaImage keep the parent's strides
+	
 	if( !img )
 	{
 		PyCudaMemory* mem = PyCUDA_GetMemory(capsule);
@@ -99,7 +104,7 @@ PyObject* PyNumpy_FromCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 			mapped = img->base.mapped;
 			width  = 1;
 			height = 1;
-			depth  = img->base.size;
+			depth  = img->base.size / ((imageFormatBaseType(img->format) == IMAGE_UINT16) ? sizeof(uint16_t) : sizeof(uint8_t));
 			type   = PyNumpy_ConvertFormat(img->format);
 		}
 		else
@@ -110,6 +115,14 @@ PyObject* PyNumpy_FromCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 			height = img->height;
 			depth  = imageFormatChannels(img->format);
 			type   = PyNumpy_ConvertFormat(img->format);
+			
+			if( !PyCUDA_IsContiguous(img) )
+			{
+				for( int n=0; n < 3; n++ )
+					strides[n] = img->strides[n];
+				
+				strided = true;
+			}
 		}
 	}
 	
@@ -123,7 +136,8 @@ PyObject* PyNumpy_FromCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 	npy_intp dims[] = { height, width, depth };
 
 	// create numpy array
-	PyObject* array = PyArray_SimpleNewFromData(3, dims, type, src);
+	PyObject* array = strided ? PyArray_New(&PyArray_Type, 3, dims, type, strides, src, 0, NPY_ARRAY_WRITEABLE, NULL)
+						 : PyArray_SimpleNewFromData(3, dims, type, src);
 
 	if( !array )
 	{
@@ -167,7 +181,7 @@ PyObject* PyNumpy_ToCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 
 	const bool isBGR = (pyBGR > 0);
 
-	// detect uint8 array - otherwise cast to float
+	// detect uint8/uint16 array - otherwise cast to float
 	const int inputType = PyArray_TYPE((PyArrayObject*)object);
 	int outputType = NPY_FLOAT32;
 	int typeSize = sizeof(float);
@@ -177,6 +191,11 @@ PyObject* PyNumpy_ToCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 		outputType = NPY_UINT8;
 		typeSize = sizeof(uint8_t);
 	}
+	else if( inputType == NPY_UINT16 )
+	{
+		outputType = NPY_UINT16;
+		typeSize = sizeof(uint16_t);
+	}
 	
 	// cast to numpy array
 	PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OTF(object, outputType, NPY_ARRAY_IN_ARRAY|NPY_ARRAY_FORCECAST);
@@ -265,6 +284,22 @@ PyObject* PyNumpy_ToCUDA( PyObject* self, PyObject* args, PyObject* kwds )
 				format = isBGR ? IMAGE_BGRA8 : IMAGE_RGBA8;
 		}
 	}
+	else if( outputType == NPY_UINT16 )
+	{
+		if( ndim == 2 )
+		{
+			format = IMAGE_GRAY16;
+		}
+		else if( ndim == 3 && !isBGR )
+		{
+			if( dims[2] == 1 )
+				format = IMAGE_GRAY16;
+			else if( dims[2] == 3 )
+				format = IMAGE_RGB16;
+			else if( dims[2] == 4 )
+				format = IMAGE_RGBA16;
+		}
+	}
 
 	// register CUDA memory capsule
 	PyObject* capsule = NULL;
@@ -25,14 +25,18 @@
 
 #include "videoSource.h"
 #include "videoOutput.h"
+#include "gstUtility.h"
 
 #include "logging.h"
 
+#include <strings.h>
+
 
 // object containers
 typedef struct {
     PyObject_HEAD
     videoSource* source;
+    PyObject*    capture;  // pending capture_async() request (borrowed reference)
 } PyVideoSource_Object;
 
 typedef struct {
@@ -97,12 +101,21 @@ static PyObject* PyVideoOptions_ToDict( const videoOptions& options )
 	PYDICT_SET_STRING(dict, "codec", videoOptions::CodecToStr(options.codec));
 	
 	if( options.ioType == videoOptions::OUTPUT )
+	{
 		PYDICT_SET_UINT(dict, "bitrate", options.bitRate);
+		PYDICT_SET_UINT(dict, "minBitrate", options.minBitRate);
+		PYDICT_SET_UINT(dict, "threads", options.threads);
+		PYDICT_SET_UINT(dict, "queueDepth", options.queueDepth);
+		PYDICT_SET_STRING(dict, "queuePolicy", videoOptions::QueuePolicyToStr(options.queuePolicy));
+	}
 	
 	if( options.ioType == videoOptions::INPUT )
 	{
 		PYDICT_SET_INT(dict, "loop", options.loop);
+		PYDICT_SET_UINT(dict, "stride", options.stride);
+		PYDICT_SET_BOOL(dict, "keyframesOnly", options.keyframesOnly);
 		PYDICT_SET_STRING(dict, "flipMethod", videoOptions::FlipMethodToStr(options.flipMethod));
+		PYDICT_SET_STRING(dict, "discovery", videoOptions::DiscoveryToStr(options.discovery));
 	}
 
 	PYDICT_SET_UINT(dict, "numBuffers", options.numBuffers);
@@ -145,12 +158,17 @@ static bool PyVideoOptions_FromDict( PyObject* dict, videoOptions& options )
 	PYDICT_GET_UINT(dict, "width", options.width);
 	PYDICT_GET_UINT(dict, "height", options.height);
 	PYDICT_GET_UINT(dict, "bitrate", options.bitRate);
+	PYDICT_GET_UINT(dict, "minBitrate", options.minBitRate);
 	PYDICT_GET_UINT(dict, "numBuffers", options.numBuffers);
+	PYDICT_GET_UINT(dict, "stride", options.stride);
+	PYDICT_GET_UINT(dict, "threads", options.threads);
+	PYDICT_GET_UINT(dict, "queueDepth", options.queueDepth);
 	
 	PYDICT_GET_INT(dict, "loop", options.loop);
 	PYDICT_GET_INT(dict, "latency", options.latency);
 	
 	PYDICT_GET_BOOL(dict, "zeroCopy", options.zeroCopy);
+	PYDICT_GET_BOOL(dict, "keyframesOnly", options.keyframesOnly);
 	PYDICT_GET_FLOAT(dict, "framerate", options.frameRate);
 
 	PYDICT_GET_STRING(dict, "stunServer", options.stunServer);
@@ -160,6 +178,8 @@ static bool PyVideoOptions_FromDict( PyObject* dict, videoOptions& options )
 	PYDICT_GET_ENUM(dict, "codec", options.codec, videoOptions::CodecFromStr);
 	PYDICT_GET_ENUM(dict, "codecType", options.codecType, videoOptions::CodecTypeFromStr);
 	PYDICT_GET_ENUM(dict, "flipMethod", options.flipMethod, videoOptions::FlipMethodFromStr);
+	PYDICT_GET_ENUM(dict, "discovery", options.discovery, videoOptions::DiscoveryFromStr);
+	PYDICT_GET_ENUM(dict, "queuePolicy", options.queuePolicy, videoOptions::QueuePolicyFromStr);
 
 	return true;
 }
@@ -180,6 +200,7 @@ static PyObject* PyVideoSource_New( PyTypeObject *type, PyObject *args, PyObject
 	}
 	
     self->source = NULL;
+    self->capture = NULL;
     return (PyObject*)self;
 }
 
@@ -313,6 +334,20 @@ static PyObject* PyVideoSource_Close( PyVideoSource_Object* self )
 	Py_RETURN_NONE; 
 }
 
+// PyVideoSource_RegisterFrame
+static PyObject* PyVideoSource_RegisterFrame( PyVideoSource_Object* self, void* ptr, imageFormat format )
+{
+	// expect raw image if conversion format is unknown
+	if( format == IMAGE_UNKNOWN )
+	{
+		// register memory capsule (videoSource will free the underlying memory when source is deleted)
+		return PyCUDA_RegisterImage(ptr, self->source->GetWidth(), self->source->GetHeight(), self->source->GetRawFormat(), self->source->GetLastTimestamp(), self->source->GetOptions().zeroCopy, false);
+	}
+
+	// register memory capsule (videoSource will free the underlying memory when source is deleted)
+	return PyCUDA_RegisterImage(ptr, self->source->GetWidth(), self->source->GetHeight(), format, self->source->GetLastTimestamp(), self->source->GetOptions().zeroCopy, false);
+}
+
 // PyVideoSource_Capture
 static PyObject* PyVideoSource_Capture( PyVideoSource_Object* self, PyObject* args, PyObject* kwds )
 {
@@ -361,15 +396,7 @@ static PyObject* PyVideoSource_Capture( PyVideoSource_Object* self, PyObject* ar
 		return NULL;
 	}
 
-	// expect raw image if conversion format is unknown
-	if( format == IMAGE_UNKNOWN )
-	{
-		// register memory capsule (videoSource will free the underlying memory when source is deleted)
-		return PyCUDA_RegisterImage(ptr, self->source->GetWidth(), self->source->GetHeight(), self->source->GetRawFormat(), self->source->GetLastTimestamp(), self->source->GetOptions().zeroCopy, false);
-	}
-
-	// register memory capsule (videoSource will free the underlying memory when source is deleted)
-	return PyCUDA_RegisterImage(ptr, self->source->GetWidth(), self->source->GetHeight(), format, self->source->GetLastTimestamp(), self->source->GetOptions().zeroCopy, false);
+	return PyVideoSource_RegisterFrame(self, ptr, format);
 }
 
 
@@ -421,6 +448,70 @@ static PyObject* PyVideoSource_GetFrameCount( PyVideoSource_Object* self )
 	return PYLONG_FROM_UNSIGNED_LONG(self->source->GetFrameCount());
 }
 
+// PyVideoSource_Seek
+static PyObject* PyVideoSource_Seek( PyVideoSource_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	// parse arguments
+	long long frame = -1;
+	long long time = -1;
+	int accurate = 1;
+	
+	static char* kwlist[] = {"frame", "time", "accurate", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|LLi", kwlist, &frame, &time, &accurate) )
+		return NULL;
+
+	if( (frame < 0) == (time < 0) )
+	{
+		PyErr_SetString(PyExc_ValueError, LOG_PY_UTILS "videoSource.Seek() expects either a frame index or time (in nanoseconds)");
+		return NULL;
+	}
+	
+	bool result = false;
+	
+	Py_BEGIN_ALLOW_THREADS
+	
+	if( frame >= 0 )
+		result = self->source->Seek(frame, videoSource::SEEK_FRAME, accurate != 0);
+	else
+		result = self->source->Seek(time, videoSource::SEEK_TIME, accurate != 0);
+	
+	Py_END_ALLOW_THREADS
+	
+	PY_RETURN_BOOL(result);
+}
+
+// PyVideoSource_GetPosition
+static PyObject* PyVideoSource_GetPosition( PyVideoSource_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	// parse arguments
+	const char* format = "frame";
+	static char* kwlist[] = {"format", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|s", kwlist, &format) )
+		return NULL;
+
+	if( strcasecmp(format, "frame") == 0 )
+		return PyLong_FromUnsignedLongLong(self->source->GetPosition(videoSource::SEEK_FRAME));
+	else if( strcasecmp(format, "time") == 0 )
+		return PyLong_FromUnsignedLongLong(self->source->GetPosition(videoSource::SEEK_TIME));
+	
+	PyErr_SetString(PyExc_ValueError, LOG_PY_UTILS "videoSource.GetPosition() format should be 'frame' or 'time'");
+	return NULL;
+}
+
 // PyVideoSource_GetOptions
 static PyObject* PyVideoSource_GetOptions( PyVideoSource_Object* self )
 {
@@ -445,12 +536,491 @@ static PyObject* PyVideoSource_IsStreaming( PyVideoSource_Object* self )
 	PY_RETURN_BOOL(self->source->IsStreaming());
 }
 
+// PyVideoSource_IsKeyframe
+static PyObject* PyVideoSource_IsKeyframe( PyVideoSource_Object* self )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	PY_RETURN_BOOL(self->source->IsKeyframe());
+}
+
 // Usage
 static PyObject* PyVideoSource_Usage( PyVideoSource_Object* self )
 {
 	return Py_BuildValue("s", videoSource::Usage());
 }
 
+#if PY_MAJOR_VERSION >= 3
+//-------------------------------------------------------------------------------
+// asyncio support
+//
+// capture_async() waits for the source's ready descriptor (videoSource::GetReadyFD)
+// with loop.add_reader(), so that a single event loop can service many streams.
+// Sources without a descriptor (and sources that haven't been opened yet, because
+// opening can block) run Capture() on the event loop's default executor instead.
+
+static PyObject* pyAsyncioModule = NULL;
+static PyObject* pyFunctoolsModule = NULL;
+
+// PyVideo_GetRunningLoop
+static PyObject* PyVideo_GetRunningLoop()
+{
+	if( !pyAsyncioModule )
+	{
+		pyAsyncioModule = PyImport_ImportModule("asyncio");
+
+		if( !pyAsyncioModule )
+			return NULL;
+	}
+
+	// raises RuntimeError if there isn't a running event loop
+	return PyObject_CallMethod(pyAsyncioModule, "get_running_loop", NULL);
+}
+
+// a pending capture_async() request
+typedef struct {
+	PyObject_HEAD
+	PyVideoSource_Object* source;
+	PyObject*    loop;
+	PyObject*    future;	 // the future returned to the caller
+	PyObject*    timer;	 // loop.call_later() handle that ends the wait (or NULL)
+	imageFormat  format;
+	cudaStream_t stream;
+	uint64_t     timeout;	 // timeout of Capture() when it runs on the executor
+	bool         iterating; // from 'async for' (wait until a frame or EOS, without timing out)
+	bool         reading;	 // loop.add_reader() is active
+	bool         running;	 // Capture() was submitted to the executor, and _on_executed hasn't run yet
+	void*        ptr;		 // result of Capture() from the executor
+	int          status;
+} PyVideoCapture_Object;
+
+static PyTypeObject pyVideoCapture_Type = 
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+// PyVideoCapture_Dealloc
+static void PyVideoCapture_Dealloc( PyVideoCapture_Object* self )
+{
+	Py_XDECREF(self->timer);
+	Py_XDECREF(self->future);
+	Py_XDECREF(self->loop);
+	Py_XDECREF(self->source);
+
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// PyVideoCapture_Bind (bound method of the request, to schedule as a callback)
+static PyObject* PyVideoCapture_Bind( PyVideoCapture_Object* self, const char* name )
+{
+	return PyObject_GetAttrString((PyObject*)self, name);
+}
+
+// PyVideoCapture_Cleanup
+static void PyVideoCapture_Cleanup( PyVideoCapture_Object* self )
+{
+	if( self->reading && self->loop != NULL )
+	{
+		PyObject* result = PyObject_CallMethod(self->loop, "remove_reader", "i", self->source->source->GetReadyFD());
+
+		if( !result )
+			PyErr_Clear();
+
+		Py_XDECREF(result);
+		self->reading = false;
+	}
+
+	if( self->timer != NULL )
+	{
+		PyObject* result = PyObject_CallMethod(self->timer, "cancel", NULL);
+
+		if( !result )
+			PyErr_Clear();
+
+		Py_XDECREF(result);
+		Py_CLEAR(self->timer);
+	}
+
+	// if Capture() is still running on the executor, the source stays busy until _on_executed
+	if( !self->running && self->source->capture == (PyObject*)self )
+		self->source->capture = NULL;
+
+	Py_CLEAR(self->future);
+	Py_CLEAR(self->loop);
+}
+
+// PyVideoCapture_Finish
+// resolves the future from the status of Capture(), and returns false to keep waiting
+static bool PyVideoCapture_Finish( PyVideoCapture_Object* self, void* ptr, int status, bool final )
+{
+	if( !self->future )
+		return true;	// already resolved or cancelled
+
+	if( status == videoSource::TIMEOUT && (!final || self->iterating) )
+		return false;
+
+	PyObject* done = PyObject_CallMethod(self->future, "done", NULL);
+	const bool isDone = (done == Py_True);
+
+	Py_XDECREF(done);
+
+	if( isDone )
+		return true;
+
+	PyObject* result = NULL;
+
+	if( status == videoSource::OK )
+	{
+		result = PyVideoSource_RegisterFrame(self->source, ptr, self->format);
+	}
+	else if( status == videoSource::TIMEOUT )
+	{
+		Py_INCREF(Py_None);
+		result = Py_None;
+	}
+	else if( status == videoSource::EOS && self->iterating )
+	{
+		PyErr_SetNone(PyExc_StopAsyncIteration);
+	}
+	else
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource failed to capture image");
+	}
+
+	PyObject* ret = NULL;
+
+	if( result != NULL )
+	{
+		ret = PyObject_CallMethod(self->future, "set_result", "O", result);
+		Py_DECREF(result);
+	}
+	else
+	{
+		PyObject* type = NULL;
+		PyObject* value = NULL;
+		PyObject* traceback = NULL;
+
+		PyErr_Fetch(&type, &value, &traceback);
+		PyErr_NormalizeException(&type, &value, &traceback);
+
+		ret = PyObject_CallMethod(self->future, "set_exception", "O", value);
+
+		Py_XDECREF(type);
+		Py_XDECREF(value);
+		Py_XDECREF(traceback);
+	}
+
+	if( !ret )
+		PyErr_WriteUnraisable(self->future);
+
+	Py_XDECREF(ret);
+	return true;
+}
+
+// PyVideoCapture_Submit (run Capture() on the executor)
+static bool PyVideoCapture_Submit( PyVideoCapture_Object* self )
+{
+	PyObject* run = PyVideoCapture_Bind(self, "_run");
+	PyObject* onExecuted = PyVideoCapture_Bind(self, "_on_executed");
+	PyObject* task = NULL;
+	PyObject* ret = NULL;
+
+	if( run != NULL && onExecuted != NULL )
+		task = PyObject_CallMethod(self->loop, "run_in_executor", "OO", Py_None, run);
+
+	if( task != NULL )
+		ret = PyObject_CallMethod(task, "add_done_callback", "O", onExecuted);
+
+	Py_XDECREF(run);
+	Py_XDECREF(onExecuted);
+	Py_XDECREF(task);
+
+	if( !ret )
+		return false;
+
+	self->running = true;
+
+	Py_DECREF(ret);
+	return true;
+}
+
+// PyVideoCapture_Run (called from the executor's thread)
+static PyObject* PyVideoCapture_Run( PyVideoCapture_Object* self )
+{
+	void* ptr = NULL;
+	int status = videoSource::ERROR;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->source->source->Capture(&ptr, self->format, self->timeout, &status, self->stream);
+	Py_END_ALLOW_THREADS
+
+	self->ptr = ptr;
+	self->status = status;
+
+	Py_RETURN_NONE;
+}
+
+// PyVideoCapture_OnExecuted (called from the event loop after _run)
+static PyObject* PyVideoCapture_OnExecuted( PyVideoCapture_Object* self, PyObject* task )
+{
+	self->running = false;
+
+	if( !PyVideoCapture_Finish(self, self->ptr, self->status, true) )
+	{
+		// 'async for' keeps waiting after a timeout
+		if( !PyVideoCapture_Submit(self) )
+			PyErr_WriteUnraisable((PyObject*)self);
+	}
+
+	// if the request was cancelled while Capture() was running, the source is free now
+	if( !self->running && !self->future && self->source->capture == (PyObject*)self )
+		self->source->capture = NULL;
+
+	Py_RETURN_NONE;
+}
+
+// PyVideoCapture_OnReady (called from the event loop when the ready descriptor is readable)
+static PyObject* PyVideoCapture_OnReady( PyVideoCapture_Object* self )
+{
+	if( !self->future )
+		Py_RETURN_NONE;
+
+	void* ptr = NULL;
+	int status = videoSource::ERROR;
+
+	self->source->source->ResetReadyFD();
+	self->source->source->Capture(&ptr, self->format, 0, &status, self->stream);
+
+	PyVideoCapture_Finish(self, ptr, status, false);
+	Py_RETURN_NONE;
+}
+
+// PyVideoCapture_OnTimeout
+static PyObject* PyVideoCapture_OnTimeout( PyVideoCapture_Object* self )
+{
+	PyVideoCapture_Finish(self, NULL, videoSource::TIMEOUT, true);
+	Py_RETURN_NONE;
+}
+
+// PyVideoCapture_OnDone (called when the future is resolved or cancelled)
+static PyObject* PyVideoCapture_OnDone( PyVideoCapture_Object* self, PyObject* future )
+{
+	PyVideoCapture_Cleanup(self);
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef pyVideoCapture_Methods[] = 
+{
+	{ "_run", (PyCFunction)PyVideoCapture_Run, METH_NOARGS, NULL},
+	{ "_on_executed", (PyCFunction)PyVideoCapture_OnExecuted, METH_O, NULL},
+	{ "_on_ready", (PyCFunction)PyVideoCapture_OnReady, METH_NOARGS, NULL},
+	{ "_on_timeout", (PyCFunction)PyVideoCapture_OnTimeout, METH_NOARGS, NULL},
+	{ "_on_done", (PyCFunction)PyVideoCapture_OnDone, METH_O, NULL},
+	{NULL}  /* Sentinel */
+};
+
+// PyVideoCapture_Start
+static PyObject* PyVideoCapture_Start( PyVideoSource_Object* source, imageFormat format, int timeout, cudaStream_t stream, bool iterating )
+{
+	if( source->capture != NULL )
+	{
+		PyErr_SetString(PyExc_RuntimeError, LOG_PY_UTILS "videoSource already has a pending capture_async() (await it before capturing again)");
+		return NULL;
+	}
+
+	PyObject* loop = PyVideo_GetRunningLoop();
+
+	if( !loop )
+		return NULL;
+
+	PyObject* future = PyObject_CallMethod(loop, "create_future", NULL);
+
+	if( !future )
+	{
+		Py_DECREF(loop);
+		return NULL;
+	}
+
+	PyVideoCapture_Object* self = PyObject_New(PyVideoCapture_Object, &pyVideoCapture_Type);
+
+	if( !self )
+	{
+		Py_DECREF(future);
+		Py_DECREF(loop);
+		return NULL;
+	}
+
+	Py_INCREF(source);
+
+	self->source    = source;
+	self->loop      = loop;
+	self->future    = future;
+	self->timer     = NULL;
+	self->format    = format;
+	self->stream    = stream;
+	self->iterating = iterating;
+	self->reading   = false;
+	self->running   = false;
+	self->ptr       = NULL;
+	self->status    = videoSource::ERROR;
+
+	if( iterating )
+		self->timeout = videoSource::DEFAULT_TIMEOUT;
+	else
+		self->timeout = (timeout >= 0) ? timeout : UINT64_MAX;
+
+	source->capture = (PyObject*)self;
+
+	// the future keeps the request alive until it's resolved
+	bool success = false;
+	PyObject* onDone = PyVideoCapture_Bind(self, "_on_done");
+	PyObject* ret = (onDone != NULL) ? PyObject_CallMethod(future, "add_done_callback", "O", onDone) : NULL;
+
+	Py_XDECREF(onDone);
+	Py_XDECREF(ret);
+
+	const int fd = source->source->GetReadyFD();
+
+	if( !ret )
+	{
+		success = false;
+	}
+	else if( fd >= 0 && source->source->IsStreaming() )
+	{
+		// check for a frame that's already waiting before going to sleep
+		void* ptr = NULL;
+		int status = videoSource::ERROR;
+
+		source->source->ResetReadyFD();
+		source->source->Capture(&ptr, format, 0, &status, stream);
+
+		if( PyVideoCapture_Finish(self, ptr, status, false) )
+		{
+			success = true;
+		}
+		else
+		{
+			PyObject* onReady = PyVideoCapture_Bind(self, "_on_ready");
+			ret = (onReady != NULL) ? PyObject_CallMethod(loop, "add_reader", "iO", fd, onReady) : NULL;
+			success = (ret != NULL);
+			self->reading = success;
+
+			Py_XDECREF(onReady);
+			Py_XDECREF(ret);
+
+			if( success && !iterating && timeout >= 0 )
+			{
+				PyObject* onTimeout = PyVideoCapture_Bind(self, "_on_timeout");
+				self->timer = (onTimeout != NULL) ? PyObject_CallMethod(loop, "call_later", "dO", timeout / 1000.0, onTimeout) : NULL;
+				success = (self->timer != NULL);
+				Py_XDECREF(onTimeout);
+			}
+		}
+	}
+	else
+	{
+		success = PyVideoCapture_Submit(self);
+	}
+
+	if( !success )
+	{
+		PyObject* type = NULL;
+		PyObject* value = NULL;
+		PyObject* traceback = NULL;
+
+		PyErr_Fetch(&type, &value, &traceback);
+		PyVideoCapture_Cleanup(self);
+		PyErr_Restore(type, value, traceback);
+
+		Py_DECREF(self);
+		return NULL;
+	}
+
+	// the request is kept alive by the callbacks that were scheduled
+	Py_INCREF(future);
+	Py_DECREF(self);
+
+	return future;
+}
+
+// PyVideoSource_CaptureAsync
+static PyObject* PyVideoSource_CaptureAsync( PyVideoSource_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	// parse arguments (the same as Capture)
+	const char* pyFormat = "rgb8";
+	int pyTimeout = videoSource::DEFAULT_TIMEOUT;
+	cudaStream_t stream = 0;
+	
+	static char* kwlist[] = {"format", "timeout", "stream", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|siK", kwlist, &pyFormat, &pyTimeout, &stream) )
+		return NULL;
+
+	return PyVideoCapture_Start(self, imageFormatFromStr(pyFormat), pyTimeout, stream, false);
+}
+
+// PyVideoSource_AsyncIter
+static PyObject* PyVideoSource_AsyncIter( PyVideoSource_Object* self )
+{
+	Py_INCREF(self);
+	return (PyObject*)self;
+}
+
+// PyVideoSource_AsyncNext
+static PyObject* PyVideoSource_AsyncNext( PyVideoSource_Object* self )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	return PyVideoCapture_Start(self, IMAGE_RGB8, -1, 0, true);
+}
+
+static PyAsyncMethods pyVideoSource_AsyncMethods = 
+{
+	NULL,								/* am_await */
+	(unaryfunc)PyVideoSource_AsyncIter,	/* am_aiter */
+	(unaryfunc)PyVideoSource_AsyncNext,	/* am_anext */
+};
+#endif
+
+// PyVideoSource_GetReadyFD
+static PyObject* PyVideoSource_GetReadyFD( PyVideoSource_Object* self )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_LONG(self->source->GetReadyFD());
+}
+
+// PyVideoSource_ResetReadyFD
+static PyObject* PyVideoSource_ResetReadyFD( PyVideoSource_Object* self )
+{
+	if( !self || !self->source )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoSource invalid object instance");
+		return NULL;
+	}
+
+	self->source->ResetReadyFD();
+	Py_RETURN_NONE;
+}
+
 static PyTypeObject pyVideoSource_Type = 
 {
     PyVarObject_HEAD_INIT(NULL, 0)
@@ -461,12 +1031,20 @@ static PyMethodDef pyVideoSource_Methods[] =
 	{ "Open", (PyCFunction)PyVideoSource_Open, METH_NOARGS, "Open the video source for streaming frames"},
 	{ "Close", (PyCFunction)PyVideoSource_Close, METH_NOARGS, "Stop streaming video frames"},
 	{ "Capture", (PyCFunction)PyVideoSource_Capture, METH_VARARGS|METH_KEYWORDS, "Capture a frame and return the cudaImage"},
+#if PY_MAJOR_VERSION >= 3
+	{ "capture_async", (PyCFunction)PyVideoSource_CaptureAsync, METH_VARARGS|METH_KEYWORDS, "Return an awaitable for the next frame, without blocking the asyncio event loop (the arguments are the same as Capture)"},
+#endif
+	{ "GetReadyFD", (PyCFunction)PyVideoSource_GetReadyFD, METH_NOARGS, "Return a file descriptor that becomes readable when a frame is ready, or -1 if the source doesn't support it"},
+	{ "ResetReadyFD", (PyCFunction)PyVideoSource_ResetReadyFD, METH_NOARGS, "Clear the ready file descriptor before checking for the next frame with Capture(timeout=0)"},
 	{ "GetWidth", (PyCFunction)PyVideoSource_GetWidth, METH_NOARGS, "Return the width of the video source (in pixels)"},
 	{ "GetHeight", (PyCFunction)PyVideoSource_GetHeight, METH_NOARGS, "Return the height of the video source (in pixels)"},
 	{ "GetFrameRate", (PyCFunction)PyVideoSource_GetFrameRate, METH_NOARGS, "Return the frames per second of the video source"},	
 	{ "GetFrameCount", (PyCFunction)PyVideoSource_GetFrameCount, METH_NOARGS, "Return the number of frames captured so far"},
+	{ "Seek", (PyCFunction)PyVideoSource_Seek, METH_VARARGS|METH_KEYWORDS, "Seek to a frame index (frame=N) or timestamp in nanoseconds (time=N), with optional accurate=False for keyframe seeking"},
+	{ "GetPosition", (PyCFunction)PyVideoSource_GetPosition, METH_VARARGS|METH_KEYWORDS, "Return the frame index (format='frame') or timestamp (format='time') of the next frame to be captured"},
 	{ "GetOptions", (PyCFunction)PyVideoSource_GetOptions, METH_NOARGS, "Return a dict representing the videoOptions of the source"},	
 	{ "IsStreaming", (PyCFunction)PyVideoSource_IsStreaming, METH_NOARGS, "Return true if the stream is open, return false if closed"},
+	{ "IsKeyframe", (PyCFunction)PyVideoSource_IsKeyframe, METH_NOARGS, "Return true if the last captured frame was a keyframe"},
 	{ "Usage", (PyCFunction)PyVideoSource_Usage, METH_NOARGS|METH_STATIC, "Return help text describing the command line options"},		
 	{NULL}  /* Sentinel */
 };
@@ -481,7 +1059,24 @@ static bool PyVideoSource_RegisterType( PyObject* module )
 	pyVideoSource_Type.tp_init	  = (initproc)PyVideoSource_Init;
 	pyVideoSource_Type.tp_dealloc = (destructor)PyVideoSource_Dealloc;
 	pyVideoSource_Type.tp_doc  	  = "videoSource interface for cameras, video streams, and images";
-	 
+	
+#if PY_MAJOR_VERSION >= 3
+	pyVideoSource_Type.tp_as_async = &pyVideoSource_AsyncMethods;
+
+	pyVideoCapture_Type.tp_name      = PY_UTILS_MODULE_NAME ".videoSourceCapture";
+	pyVideoCapture_Type.tp_basicsize = sizeof(PyVideoCapture_Object);
+	pyVideoCapture_Type.tp_flags     = Py_TPFLAGS_DEFAULT;
+	pyVideoCapture_Type.tp_methods   = pyVideoCapture_Methods;
+	pyVideoCapture_Type.tp_dealloc   = (destructor)PyVideoCapture_Dealloc;
+	pyVideoCapture_Type.tp_doc       = "Pending videoSource.capture_async() request";
+
+	if( PyType_Ready(&pyVideoCapture_Type) < 0 )
+	{
+		LogError(LOG_PY_UTILS "videoSourceCapture PyType_Ready() failed\n");
+		return false;
+	}
+#endif
+	
 	if( PyType_Ready(&pyVideoSource_Type) < 0 )
 	{
 		LogError(LOG_PY_UTILS "videoSource PyType_Ready() failed\n");
@@ -678,6 +1273,9 @@ static PyObject* PyVideoOutput_Render( PyVideoOutput_Object* self, PyObject* arg
 		return NULL;
 	}
 
+	if( !PyCUDA_CheckContiguous(img, "videoOutput.Render") )
+		return NULL;
+
 	// render the image
 	bool result = false;
 	Py_BEGIN_ALLOW_THREADS
@@ -693,6 +1291,69 @@ static PyObject* PyVideoOutput_Render( PyVideoOutput_Object* self, PyObject* arg
 	Py_RETURN_NONE;
 }
 
+#if PY_MAJOR_VERSION >= 3
+// PyVideoOutput_RenderAsync
+static PyObject* PyVideoOutput_RenderAsync( PyVideoOutput_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->output )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "videoOutput invalid object instance");
+		return NULL;
+	}
+
+	if( !pyFunctoolsModule )
+	{
+		pyFunctoolsModule = PyImport_ImportModule("functools");
+
+		if( !pyFunctoolsModule )
+			return NULL;
+	}
+
+	PyObject* loop = PyVideo_GetRunningLoop();
+
+	if( !loop )
+		return NULL;
+
+	// outputs don't have a ready descriptor, and Render() usually just queues the
+	// frame, so it runs on the event loop's default executor with the same arguments
+	PyObject* render = PyObject_GetAttrString((PyObject*)self, "Render");
+	PyObject* partial = NULL;
+	PyObject* future = NULL;
+
+	if( render != NULL )
+	{
+		PyObject* partialArgs = PyTuple_New(PyTuple_Size(args) + 1);
+
+		Py_INCREF(render);
+		PyTuple_SET_ITEM(partialArgs, 0, render);
+
+		for( Py_ssize_t n=0; n < PyTuple_Size(args); n++ )
+		{
+			PyObject* arg = PyTuple_GET_ITEM(args, n);
+			Py_INCREF(arg);
+			PyTuple_SET_ITEM(partialArgs, n + 1, arg);
+		}
+
+		PyObject* partialType = PyObject_GetAttrString(pyFunctoolsModule, "partial");
+
+		if( partialType != NULL )
+			partial = PyObject_Call(partialType, partialArgs, kwds);
+
+		Py_XDECREF(partialType);
+		Py_DECREF(partialArgs);
+	}
+
+	if( partial != NULL )
+		future = PyObject_CallMethod(loop, "run_in_executor", "OO", Py_None, partial);
+
+	Py_XDECREF(partial);
+	Py_XDECREF(render);
+	Py_DECREF(loop);
+
+	return future;
+}
+#endif
+
 // PyVideoOutput_GetWidth
 static PyObject* PyVideoOutput_GetWidth( PyVideoOutput_Object* self )
 {
@@ -793,6 +1454,9 @@ static PyMethodDef pyVideoOutput_Methods[] =
 	{ "Open", (PyCFunction)PyVideoOutput_Open, METH_NOARGS, "Open the video output for streaming frames"},
 	{ "Close", (PyCFunction)PyVideoOutput_Close, METH_NOARGS, "Stop streaming video frames"},
 	{ "Render", (PyCFunction)PyVideoOutput_Render, METH_VARARGS|METH_KEYWORDS, "Render a frame (supplied as a cudaImage)"},
+#if PY_MAJOR_VERSION >= 3
+	{ "render_async", (PyCFunction)PyVideoOutput_RenderAsync, METH_VARARGS|METH_KEYWORDS, "Return an awaitable that renders a frame on the asyncio event loop's executor (the arguments are the same as Render)"},
+#endif
 	{ "GetWidth", (PyCFunction)PyVideoOutput_GetWidth, METH_NOARGS, "Return the width of the video output (in pixels)"},
 	{ "GetHeight", (PyCFunction)PyVideoOutput_GetHeight, METH_NOARGS, "Return the height of the video output (in pixels)"},
 	{ "GetFrameRate", (PyCFunction)PyVideoOutput_GetFrameRate, METH_NOARGS, "Return the frames per second of the video output"},	
@@ -847,8 +1511,22 @@ bool PyVideo_RegisterTypes( PyObject* module )
 	return true;
 }
 
+//-------------------------------------------------------------------------------
+// PyVideo_Prewarm
+static PyObject* PyVideo_Prewarm( PyObject* self )
+{
+	if( !gstreamerPrewarm() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_UTILS "failed to start pre-warming the GStreamer plugins");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
 static PyMethodDef pyVideo_Functions[] = 
 {
+	{ "gstreamerPrewarm", (PyCFunction)PyVideo_Prewarm, METH_NOARGS, "Initialize GStreamer and load the commonly-used plugins in a background thread, to reduce the startup time of the first videoSource/videoOutput"},
 	{NULL}  /* Sentinel */
 };
 
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+#
+
+import sys
+import asyncio
+import argparse
+
+from jetson_utils import videoSource, videoOutput, Log
+
+# parse command line
+parser = argparse.ArgumentParser(description="View several video streams from one asyncio event loop", 
+                                 formatter_class=argparse.RawTextHelpFormatter, 
+                                 epilog=videoSource.Usage() + videoOutput.Usage() + Log.Usage())
+
+parser.add_argument("inputs", type=str, nargs='+', help="URIs of the input streams")
+parser.add_argument("--outputs", type=str, nargs='*', default=[], help="URIs of the output streams (one per input)")
+
+args = parser.parse_known_args()[0]
+
+
+async def stream(index, input, output):
+    numFrames = 0
+    
+    # 'async for' waits for each frame without blocking the other streams, and ends on EOS
+    async for img in input:
+        if numFrames % 25 == 0 or numFrames < 15:
+            Log.Verbose(f"video-async:  stream {index} captured {numFrames} frames ({img.width} x {img.height})")
+            
+        numFrames += 1
+        
+        if output is not None:
+            await output.render_async(img)
+            
+            if not output.IsStreaming():
+                break
+            
+
+async def main():
+    tasks = []
+    
+    for n, uri in enumerate(args.inputs):
+        input = videoSource(uri, argv=sys.argv)
+        output = videoOutput(args.outputs[n], argv=sys.argv) if n < len(args.outputs) else None
+        tasks.append(stream(n, input, output))
+        
+    await asyncio.gather(*tasks)
+    
+    
+asyncio.run(main())
@@ -25,8 +25,12 @@
 #include "filesystem.h"
 #include "logging.h"
 
+#include <sys/wait.h>
+
+#include <signal.h>
 #include <string.h>
 #include <limits.h>
+#include <errno.h>
 
 
 // readLink
@@ -127,8 +131,45 @@ std::string Process::GetWorkingDir( pid_t pid )
 }
 
 
+// IsRunning
+bool Process::IsRunning( pid_t pid )
+{
+	if( pid <= 0 )
+		return false;
+
+	// signal 0 only checks if the process exists (EPERM means it belongs to another user)
+	return (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+
 // Fork
-void Process::Fork()
+pid_t Process::Fork()
+{
+	const pid_t pid = fork();
+
+	if( pid < 0 )
+		LogError("failed to fork process (%s)\n", strerror(errno));
+
+	return pid;
+}
+
+
+// Wait
+int Process::Wait( pid_t pid )
 {
-	fork();
+	int status = 0;
+
+	while( waitpid(pid, &status, 0) < 0 )
+	{
+		if( errno != EINTR )
+		{
+			LogError("failed to wait for process %i (%s)\n", pid, strerror(errno));
+			return -1;
+		}
+	}
+
+	if( !WIFEXITED(status) )
+		return -1;
+
+	return WEXITSTATUS(status);
 }
@@ -73,9 +73,21 @@ public:
 	static std::string GetWorkingDir( pid_t pid=-1 );
 	
 	/**
-	 * Duplicate the calling process
+	 * Return true if a process with the specified PID is running.
 	 */
-	static void Fork();
+	static bool IsRunning( pid_t pid );
+
+	/**
+	 * Duplicate the calling process.  Returns the PID of the child process
+	 * to the parent, `0` to the child, or `-1` if an error occurred.
+	 */
+	static pid_t Fork();
+
+	/**
+	 * Wait for a child process to exit, and return its exit status
+	 * (or `-1` if an error occurred or the child was terminated by a signal).
+	 */
+	static int Wait( pid_t pid );
 };
 
 
@@ -26,6 +26,11 @@
 #include "Mutex.h"
 
 
+// forward declarations
+class MetricCounter;
+class MetricGauge;
+
+
 /**
  * Thread-safe circular ring buffer queue
  * @ingroup threads
@@ -99,6 +104,14 @@ public:
 	 */
 	inline void SetThreaded( bool threaded );
 
+	/**
+	 * Report the usage of the ring to the Metrics registry under the given labels,
+	 * for example `uri="csi://0",ring="yuv"` (see Metrics::Label).  This counts
+	 * the buffers that get written, read, and dropped (i.e. they were overwritten
+	 * or skipped by ReadLatest before being read), and the number that are queued.
+	 */
+	inline void EnableMetrics( const char* labels );
+
 protected:
 
 	uint32_t mNumBuffers;
@@ -110,6 +123,13 @@ protected:
 	size_t mBufferSize;
 	bool   mReadOnce;
 	Mutex  mMutex;
+
+	uint32_t mNumQueued;	// buffers written but not read yet
+
+	MetricCounter* mWrittenMetric;
+	MetricCounter* mReadMetric;
+	MetricCounter* mDroppedMetric;
+	MetricGauge*   mQueuedMetric;
 };
 
 // inline implementations
@@ -26,6 +26,7 @@
 
 #include "cudaMappedMemory.h"
 #include "logging.h"
+#include "metrics.h"
 
 
 // constructor
@@ -38,6 +39,12 @@ RingBuffer::RingBuffer( uint32_t flags )
 	mReadOnce = false;
 	mLatestRead = 0;
 	mLatestWrite = 0;
+	mNumQueued = 0;
+
+	mWrittenMetric = NULL;
+	mReadMetric = NULL;
+	mDroppedMetric = NULL;
+	mQueuedMetric = NULL;
 }
 
 
@@ -51,6 +58,11 @@ RingBuffer::~RingBuffer()
 		free(mBuffers);
 		mBuffers = NULL;
 	}
+
+	Metrics::Release(mWrittenMetric);
+	Metrics::Release(mReadMetric);
+	Metrics::Release(mDroppedMetric);
+	Metrics::Release(mQueuedMetric);
 }
 
 
@@ -175,11 +187,18 @@ inline void* RingBuffer::Next( uint32_t flags )
 
 	int bufferIndex = -1;
 
+	uint32_t dropped = 0;
+
 	if( flags & Write )
 	{
 		mLatestWrite = (mLatestWrite + 1) % mNumBuffers;
 		bufferIndex  = mLatestWrite;
 		mReadOnce    = false;
+
+		if( mNumQueued < mNumBuffers )
+			mNumQueued++;
+		else
+			dropped = 1;	// overwrote the oldest unread buffer
 	}
 	else if( (flags & ReadOnce) && mReadOnce )
 	{
@@ -193,14 +212,35 @@ inline void* RingBuffer::Next( uint32_t flags )
 		mLatestRead = mLatestWrite;
 		bufferIndex = mLatestWrite;
 		mReadOnce   = true;
+
+		if( mNumQueued > 1 )
+			dropped = mNumQueued - 1;	// skipped over the older buffers
+
+		mNumQueued = 0;
 	}
 	else if( flags & Read )
 	{
 		mLatestRead = (mLatestRead + 1) % mNumBuffers;
 		bufferIndex = mLatestRead;
 		mReadOnce   = true;
+
+		if( mNumQueued > 0 )
+			mNumQueued--;
 	}
 	
+	if( mQueuedMetric != NULL && bufferIndex >= 0 )
+	{
+		if( flags & Write )
+			mWrittenMetric->Increment();
+		else
+			mReadMetric->Increment();
+
+		if( dropped > 0 )
+			mDroppedMetric->Increment(dropped);
+
+		mQueuedMetric->Set(mNumQueued);
+	}
+
 	if( flags & Threaded )
 		mMutex.Unlock();
 
@@ -238,4 +278,17 @@ inline void RingBuffer::SetThreaded( bool threaded )
 }
 
 
+// EnableMetrics
+inline void RingBuffer::EnableMetrics( const char* labels )
+{
+	if( mQueuedMetric != NULL )
+		return;
+
+	mWrittenMetric = Metrics::Counter("jetson_ringbuffer_written_total", "Number of buffers written to the ring", labels);
+	mReadMetric    = Metrics::Counter("jetson_ringbuffer_read_total", "Number of buffers read from the ring", labels);
+	mDroppedMetric = Metrics::Counter("jetson_ringbuffer_dropped_total", "Number of buffers overwritten or skipped before being read", labels);
+	mQueuedMetric  = Metrics::Gauge("jetson_ringbuffer_queued", "Number of buffers written that haven't been read yet", labels);
+}
+
+
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __FRAME_ARCHIVE_H_
+#define __FRAME_ARCHIVE_H_
+
+
+#include <stdint.h>
+
+
+/**
+ * Frame archives (`.frames` files) store a sequence of uncompressed (or
+ * LZ4-compressed) video frames, so that recorded sessions can be replayed
+ * without decoding them.  They're written by frameArchiveWriter and read
+ * by frameArchiveReader, which memory-maps the file.
+ *
+ * The layout of the file is as follows:
+ *
+ *    - frameArchiveHeader (64 bytes)
+ *    - for each frame, a frameArchiveEntry (64 bytes) followed by the
+ *      frame's payload, padded to FRAME_ARCHIVE_ALIGNMENT bytes
+ *    - the index, which is an array of the frameArchiveEntry's
+ *
+ * The header records the location of the index when the archive is closed.
+ * If the writer didn't get to close it (i.e. the process crashed), the
+ * index can be rebuilt by scanning the entries that precede each frame.
+ *
+ * All fields are little-endian.
+ *
+ * @ingroup video
+ */
+struct frameArchiveHeader
+{
+	uint32_t magic;		/**< FRAME_ARCHIVE_MAGIC */
+	uint32_t version;		/**< FRAME_ARCHIVE_VERSION */
+	uint64_t numFrames;		/**< Number of frames in the index (0 if the archive wasn't closed) */
+	uint64_t indexOffset;	/**< Offset of the index from the start of the file (0 if the archive wasn't closed) */
+	float    frameRate;		/**< Average framerate of the frames */
+	uint32_t reserved[9];
+};
+
+
+/**
+ * Describes a frame in a frame archive.  This precedes each frame's payload,
+ * and the index at the end of the archive is an array of them.
+ * @ingroup video
+ */
+struct frameArchiveEntry
+{
+	uint32_t magic;		/**< FRAME_ARCHIVE_ENTRY_MAGIC */
+	uint32_t compression;	/**< FRAME_ARCHIVE_RAW or FRAME_ARCHIVE_LZ4 */
+	uint64_t offset;		/**< Offset of the payload from the start of the file */
+	uint64_t timestamp;		/**< Time since the first frame (in nanoseconds) */
+	uint32_t size;			/**< Size of the payload (in bytes) */
+	uint32_t rawSize;		/**< Size of the frame after decompression (in bytes) */
+	uint32_t width;		/**< Width of the frame (in pixels) */
+	uint32_t height;		/**< Height of the frame (in pixels) */
+	uint32_t format;		/**< imageFormat of the frame */
+	uint32_t reserved[5];
+};
+
+
+#define FRAME_ARCHIVE_MAGIC       0x4152464A	/**< 'JFRA' */
+#define FRAME_ARCHIVE_ENTRY_MAGIC 0x304D5246	/**< 'FRM0' */
+#define FRAME_ARCHIVE_VERSION     1
+#define FRAME_ARCHIVE_ALIGNMENT   64		/**< Alignment of each frame in the file (in bytes) */
+#define FRAME_ARCHIVE_EXTENSION   "frames"	/**< File extension of frame archives */
+
+#define FRAME_ARCHIVE_RAW         0		/**< The payload is uncompressed */
+#define FRAME_ARCHIVE_LZ4         1		/**< The payload is compressed with LZ4 */
+
+
+#endif
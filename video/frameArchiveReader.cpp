@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "frameArchiveReader.h"
+
+#include "cudaMappedMemory.h"
+#include "cudaColorspace.h"
+
+#include "logging.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#ifdef ENABLE_LZ4
+#include <lz4.h>
+#endif
+
+
+// round up to a multiple of the alignment
+static inline uint64_t alignUp( uint64_t size, uint64_t alignment )
+{
+	return ((size + alignment - 1) / alignment) * alignment;
+}
+
+
+// IsSupportedExtension
+bool frameArchiveReader::IsSupportedExtension( const char* ext )
+{
+	if( !ext )
+		return false;
+
+	return (strcasecmp(ext, FRAME_ARCHIVE_EXTENSION) == 0);
+}
+
+
+// constructor
+frameArchiveReader::frameArchiveReader( const videoOptions& options ) : videoSource(options)
+{
+	mMapping          = NULL;
+	mMappingSize      = 0;
+	mHostMemory       = false;
+	mEOS              = false;
+	mNextFrame        = 0;
+	mLoopCount        = 1;
+	mBufferSize       = 0;
+	mNextBuffer       = 0;
+	mScratch          = NULL;
+
+	if( mOptions.numBuffers == 0 )
+		mOptions.numBuffers = 1;
+
+	if( mOptions.stride == 0 )
+		mOptions.stride = 1;
+
+	// without a GPU, frames are loaded into host memory
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+frameArchiveReader::~frameArchiveReader()
+{
+	freeBuffers();
+
+	if( mMapping != NULL )
+	{
+		munmap(mMapping, mMappingSize);
+		mMapping = NULL;
+	}
+}
+
+
+// Create
+frameArchiveReader* frameArchiveReader::Create( const videoOptions& options )
+{
+	frameArchiveReader* reader = new frameArchiveReader(options);
+
+	if( !reader->init() )
+	{
+		delete reader;
+		return NULL;
+	}
+
+	return reader;
+}
+
+
+// Create
+frameArchiveReader* frameArchiveReader::Create( const char* path, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = path;
+	return Create(opt);
+}
+
+
+// validEntry
+static bool validEntry( const frameArchiveEntry& entry, uint64_t end )
+{
+	if( entry.magic != FRAME_ARCHIVE_ENTRY_MAGIC || entry.offset + entry.size > end )
+		return false;
+
+	if( entry.compression != FRAME_ARCHIVE_RAW && entry.compression != FRAME_ARCHIVE_LZ4 )
+		return false;
+
+	if( entry.compression == FRAME_ARCHIVE_RAW && entry.size != entry.rawSize )
+		return false;
+
+	return (entry.width > 0 && entry.height > 0 && entry.rawSize == imageFormatSize((imageFormat)entry.format, entry.width, entry.height));
+}
+
+
+// init
+bool frameArchiveReader::init()
+{
+	const char* path = mOptions.resource.location.c_str();
+	const int fd = open(path, O_RDONLY);
+
+	if( fd < 0 )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- failed to open '%s' (%s)\n", path, strerror(errno));
+		return false;
+	}
+
+	struct stat info;
+
+	if( fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(frameArchiveHeader) )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- '%s' is too small to be a frame archive\n", path);
+		close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if( mapping == MAP_FAILED )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- failed to map '%s' (%s)\n", path, strerror(errno));
+		return false;
+	}
+
+	mMapping = (uint8_t*)mapping;
+	mMappingSize = info.st_size;
+
+	const frameArchiveHeader* header = (const frameArchiveHeader*)mMapping;
+
+	if( header->magic != FRAME_ARCHIVE_MAGIC )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- '%s' isn't a frame archive\n", path);
+		return false;
+	}
+
+	if( header->version != FRAME_ARCHIVE_VERSION )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- '%s' has version %u (expected version %u)\n", path, header->version, FRAME_ARCHIVE_VERSION);
+		return false;
+	}
+
+	// load the index from the end of the file
+	const uint64_t indexSize = header->numFrames * sizeof(frameArchiveEntry);
+
+	if( header->indexOffset == 0 || header->indexOffset + indexSize > mMappingSize )
+	{
+		LogWarning(LOG_VIDEO "frameArchiveReader -- '%s' wasn't closed properly, rebuilding the index\n", path);
+
+		if( !rebuildIndex() )
+			return false;
+	}
+	else
+	{
+		const frameArchiveEntry* index = (const frameArchiveEntry*)(mMapping + header->indexOffset);
+
+		mIndex.assign(index, index + header->numFrames);
+
+		for( size_t n=0; n < mIndex.size(); n++ )
+		{
+			if( !validEntry(mIndex[n], header->indexOffset) )
+			{
+				LogError(LOG_VIDEO "frameArchiveReader -- '%s' has an invalid index (frame %zu)\n", path, n);
+				return false;
+			}
+		}
+	}
+
+	if( mIndex.size() == 0 )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- '%s' doesn't contain any frames\n", path);
+		return false;
+	}
+
+	mOptions.width  = mIndex[0].width;
+	mOptions.height = mIndex[0].height;
+	mOptions.codec  = (mIndex[0].compression == FRAME_ARCHIVE_LZ4) ? videoOptions::CODEC_LZ4 : videoOptions::CODEC_RAW;
+	mRawFormat      = (imageFormat)mIndex[0].format;
+
+	if( header->frameRate > 0 )
+		mOptions.frameRate = header->frameRate;
+
+	LogVerbose(LOG_VIDEO "frameArchiveReader -- opened '%s' (%zu frames, %ux%u %s)\n", path, mIndex.size(), mOptions.width, mOptions.height, imageFormatToStr(mRawFormat));
+	return true;
+}
+
+
+// rebuildIndex
+bool frameArchiveReader::rebuildIndex()
+{
+	uint64_t offset = sizeof(frameArchiveHeader);
+
+	mIndex.clear();
+
+	// walk the entries until one is missing or truncated
+	while( offset + sizeof(frameArchiveEntry) <= mMappingSize )
+	{
+		const frameArchiveEntry* entry = (const frameArchiveEntry*)(mMapping + offset);
+
+		if( entry->offset != offset + sizeof(frameArchiveEntry) || !validEntry(*entry, mMappingSize) )
+			break;
+
+		mIndex.push_back(*entry);
+		offset = alignUp(entry->offset + entry->size, FRAME_ARCHIVE_ALIGNMENT);
+	}
+
+	LogVerbose(LOG_VIDEO "frameArchiveReader -- recovered %zu frames from '%s'\n", mIndex.size(), mOptions.resource.location.c_str());
+	return true;
+}
+
+
+// allocBuffers
+bool frameArchiveReader::allocBuffers( size_t size )
+{
+	if( size <= mBufferSize && mBuffers.size() > 0 )
+		return true;
+
+	freeBuffers();
+
+	for( uint32_t n=0; n <= mOptions.numBuffers; n++ )
+	{
+		void* ptr = NULL;
+
+		if( mHostMemory )
+			ptr = malloc(size);
+		else if( !cudaAllocMapped(&ptr, size, false) )
+			ptr = NULL;
+
+		if( !ptr )
+		{
+			LogError(LOG_VIDEO "frameArchiveReader -- failed to allocate %zu bytes for frame buffers\n", size);
+			return false;
+		}
+
+		// the last buffer is used as scratch space for frames that need converted
+		if( n == mOptions.numBuffers )
+			mScratch = ptr;
+		else
+			mBuffers.push_back(ptr);
+	}
+
+	mBufferSize = size;
+	mNextBuffer = 0;
+
+	return true;
+}
+
+
+// freeBuffers
+void frameArchiveReader::freeBuffers()
+{
+	if( mScratch != NULL )
+		mBuffers.push_back(mScratch);
+
+	const size_t numBuffers = mBuffers.size();
+
+	for( size_t n=0; n < numBuffers; n++ )
+	{
+		if( mHostMemory )
+			free(mBuffers[n]);
+		else
+			CUDA(cudaFreeHost(mBuffers[n]));
+	}
+
+	mBuffers.clear();
+	mBufferSize = 0;
+
+	mScratch = NULL;
+}
+
+
+// GetPayload
+const void* frameArchiveReader::GetPayload( uint64_t index, frameArchiveEntry* entry ) const
+{
+	if( index >= mIndex.size() )
+		return NULL;
+
+	if( entry != NULL )
+		*entry = mIndex[index];
+
+	return mMapping + mIndex[index].offset;
+}
+
+
+#define RETURN_STATUS(code)  { if( status != NULL ) { *status=(code); } return ((code) == videoSource::OK ? true : false); }
+
+
+// Capture
+bool frameArchiveReader::Capture( void** output, imageFormat format, uint64_t timeout, int* status, cudaStream_t stream )
+{
+	// verify the output pointer exists
+	if( !output )
+		RETURN_STATUS(ERROR);
+
+	// confirm the stream is open
+	if( !mStreaming )
+	{
+		if( !Open() )
+			RETURN_STATUS(EOS);
+	}
+
+	// get the next frame to load (skipping over the stride)
+	const uint64_t currFrame = mNextFrame;
+	mNextFrame += mOptions.stride;
+
+	if( mNextFrame >= mIndex.size() )
+	{
+		if( isLooping() )
+		{
+			mNextFrame = 0;
+			mLoopCount++;
+		}
+		else
+		{
+			mEOS = true;
+			mStreaming = false;
+		}
+	}
+
+	const frameArchiveEntry& entry = mIndex[currFrame];
+	const imageFormat frameFormat = (imageFormat)entry.format;
+	const uint8_t* payload = mMapping + entry.offset;
+
+	// start paging in the next frame while this one is copied
+	if( mNextFrame != currFrame && mNextFrame < mIndex.size() )
+	{
+		const size_t pageSize = sysconf(_SC_PAGESIZE);
+		const uint64_t begin  = (mIndex[mNextFrame].offset / pageSize) * pageSize;
+
+		madvise(mMapping + begin, mIndex[mNextFrame].offset + mIndex[mNextFrame].size - begin, MADV_WILLNEED);
+	}
+
+	if( format == IMAGE_UNKNOWN )
+		format = frameFormat;
+
+	const size_t outputSize = imageFormatSize(format, entry.width, entry.height);
+
+	if( !allocBuffers(std::max(outputSize, (size_t)entry.rawSize)) )
+		RETURN_STATUS(ERROR);
+
+	void* buffer = mBuffers[mNextBuffer];
+
+	// frames that need converted are loaded into the scratch buffer first
+	void* frame = (format == frameFormat) ? buffer : mScratch;
+
+	if( entry.compression == FRAME_ARCHIVE_LZ4 )
+	{
+	#ifdef ENABLE_LZ4
+		const int decompressed = LZ4_decompress_safe((const char*)payload, (char*)frame, entry.size, entry.rawSize);
+
+		if( decompressed != (int)entry.rawSize )
+		{
+			LogError(LOG_VIDEO "frameArchiveReader -- failed to decompress frame %llu of '%s'\n", (unsigned long long)currFrame, mOptions.resource.location.c_str());
+			RETURN_STATUS(ERROR);
+		}
+	#else
+		LogError(LOG_VIDEO "frameArchiveReader -- '%s' contains LZ4-compressed frames, but LZ4 support wasn't enabled when jetson-utils was built (ENABLE_LZ4)\n", mOptions.resource.location.c_str());
+		RETURN_STATUS(ERROR);
+	#endif
+	}
+	else
+	{
+		memcpy(frame, payload, entry.rawSize);
+	}
+
+	if( format != frameFormat )
+	{
+		const cudaImageView input(frame, entry.width, entry.height, frameFormat);
+		const cudaImageView converted(buffer, entry.width, entry.height, format);
+
+		if( mHostMemory )
+		{
+			if( !cudaConvertColorCPU(input, converted) )
+				RETURN_STATUS(ERROR);
+		}
+		else
+		{
+			if( CUDA_FAILED(cudaConvertColor(input, converted, make_float2(0,255), stream)) )
+				RETURN_STATUS(ERROR);
+
+			if( CUDA_FAILED(cudaStreamSynchronize(stream)) )
+				RETURN_STATUS(ERROR);
+		}
+	}
+
+	mNextBuffer = (mNextBuffer + 1) % mBuffers.size();
+
+	// set outputs
+	mLastTimestamp = entry.timestamp;
+	mRawFormat = frameFormat;
+
+	mOptions.width  = entry.width;
+	mOptions.height = entry.height;
+	mOptions.frameCount++;
+
+	*output = buffer;
+	RETURN_STATUS(OK);
+}
+
+
+// Open
+bool frameArchiveReader::Open()
+{
+	if( mEOS )
+	{
+		LogWarning(LOG_VIDEO "frameArchiveReader -- End of Stream (EOS) has been reached, stream has been closed\n");
+		return false;
+	}
+
+	mStreaming = true;
+	return true;
+}
+
+
+// Close
+void frameArchiveReader::Close()
+{
+	mStreaming = false;
+}
+
+
+// Seek
+bool frameArchiveReader::Seek( uint64_t position, SeekFormat format, bool accurate )
+{
+	if( format == SEEK_TIME )
+	{
+		// find the first frame at or after the timestamp
+		struct compare
+		{
+			bool operator()( const frameArchiveEntry& entry, uint64_t time ) const	{ return entry.timestamp < time; }
+		};
+
+		position = std::lower_bound(mIndex.begin(), mIndex.end(), position, compare()) - mIndex.begin();
+	}
+
+	if( position >= mIndex.size() )
+	{
+		LogError(LOG_VIDEO "frameArchiveReader -- can't seek to frame %llu (the archive has %zu frames)\n", (unsigned long long)position, mIndex.size());
+		return false;
+	}
+
+	mNextFrame = position;
+	mEOS = false;
+
+	return true;
+}
+
+
+// GetPosition
+uint64_t frameArchiveReader::GetPosition( SeekFormat format ) const
+{
+	if( format == SEEK_TIME )
+		return (mNextFrame < mIndex.size()) ? mIndex[mNextFrame].timestamp : mIndex.back().timestamp;
+
+	return mNextFrame;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __FRAME_ARCHIVE_READER_H_
+#define __FRAME_ARCHIVE_READER_H_
+
+
+#include "videoSource.h"
+#include "frameArchive.h"
+
+#include <vector>
+
+
+/**
+ * Replay frames from a frame archive (`.frames` files) that was recorded
+ * with frameArchiveWriter.  The archive is memory-mapped, so frames are
+ * loaded without decoding them (other than LZ4 decompression, if they were
+ * compressed), and any frame can be accessed in constant time with Seek().
+ *
+ * Frames are copied from the mapping into `--num-buffers` buffers of
+ * mapped CUDA memory, and converted if Capture() requests a different
+ * format than they were recorded in.  The frames are returned as fast as
+ * they're requested - GetLastTimestamp() returns the time (in nanoseconds)
+ * of each frame relative to the first one, which can be used for pacing.
+ * `--loop` and `--input-stride` are supported like other file-based inputs.
+ *
+ * An archive that wasn't closed (for example, if the recording process
+ * crashed) is missing its index, in which case the index gets rebuilt
+ * by scanning through the frames that were written.
+ *
+ * @note frameArchiveReader implements the videoSource interface and is intended
+ * to be used through that as opposed to directly.  videoSource implements
+ * additional command-line parsing of videoOptions to construct instances.
+ *
+ * @see frameArchive.h for the file format.
+ * @see frameArchiveWriter
+ * @ingroup video
+ */
+class frameArchiveReader : public videoSource
+{
+public:
+	/**
+	 * Create a frameArchiveReader instance from a path and optional videoOptions.
+	 */
+	static frameArchiveReader* Create( const char* path, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Create a frameArchiveReader instance from the provided video options.
+	 */
+	static frameArchiveReader* Create( const videoOptions& options );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~frameArchiveReader();
+
+	/**
+	 * Load the next frame.
+	 * @see videoSource::Capture()
+	 */
+	virtual bool Capture( void** image, imageFormat format, uint64_t timeout=DEFAULT_TIMEOUT, int* status=NULL, cudaStream_t stream=0 );
+
+	/**
+	 * Open the stream.
+	 * @see videoSource::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * Close the stream.
+	 * @see videoSource::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Jump to a frame index or timestamp (this doesn't need to decode anything,
+	 * so seeks are always accurate).
+	 * @see videoSource::Seek()
+	 */
+	virtual bool Seek( uint64_t position, SeekFormat format=SEEK_FRAME, bool accurate=true );
+
+	/**
+	 * Return the position of the next frame that Capture() will return.
+	 * @see videoSource::GetPosition()
+	 */
+	virtual uint64_t GetPosition( SeekFormat format=SEEK_FRAME ) const;
+
+	/**
+	 * Return the number of frames in the archive.
+	 */
+	inline uint64_t GetNumFrames() const			{ return mIndex.size(); }
+
+	/**
+	 * Return a pointer to the payload of a frame inside the memory mapping,
+	 * without copying it.  If `entry` isn't NULL, it's filled out with the
+	 * frame's description (which indicates if the payload is compressed).
+	 * Returns NULL if the index is out of range.
+	 */
+	const void* GetPayload( uint64_t index, frameArchiveEntry* entry=NULL ) const;
+
+	/**
+	 * Return true if End Of Stream (EOS) has been reached.
+	 */
+	inline bool IsEOS() const				{ return mEOS; }
+
+	/**
+	 * Return the interface type (frameArchiveReader::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of frameArchiveReader class.
+	 */
+	static const uint32_t Type = (1 << 10);
+
+	/**
+	 * Return true if the extension is for a frame archive (`frames`)
+	 */
+	static bool IsSupportedExtension( const char* ext );
+
+protected:
+	frameArchiveReader( const videoOptions& options );
+
+	bool init();
+	bool rebuildIndex();
+	bool allocBuffers( size_t size );
+	void freeBuffers();
+
+	inline bool isLooping() const { return (mOptions.loop < 0) || ((mOptions.loop > 0) && (mLoopCount < mOptions.loop)); }
+
+	uint8_t* mMapping;
+	size_t   mMappingSize;
+	bool     mHostMemory;
+	bool     mEOS;
+
+	uint64_t mNextFrame;
+	int      mLoopCount;
+
+	std::vector<frameArchiveEntry> mIndex;
+
+	std::vector<void*> mBuffers;
+	size_t   mBufferSize;
+	uint32_t mNextBuffer;
+	void*    mScratch;
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "frameArchiveWriter.h"
+
+#include "cudaUtility.h"
+#include "timespec.h"
+#include "logging.h"
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#ifdef ENABLE_LZ4
+#include <lz4.h>
+#endif
+
+
+// round up to a multiple of the alignment
+static inline uint64_t alignUp( uint64_t size, uint64_t alignment )
+{
+	return ((size + alignment - 1) / alignment) * alignment;
+}
+
+
+// IsSupportedExtension
+bool frameArchiveWriter::IsSupportedExtension( const char* ext )
+{
+	if( !ext )
+		return false;
+
+	return (strcasecmp(ext, FRAME_ARCHIVE_EXTENSION) == 0);
+}
+
+
+// constructor
+frameArchiveWriter::frameArchiveWriter( const videoOptions& options ) : videoOutput(options)
+{
+	mFile           = -1;
+	mOffset         = 0;
+	mFirstTimestamp = 0;
+	mLastTimestamp  = 0;
+	mCompress       = false;
+	mHostMemory     = false;
+
+	if( mOptions.codec == videoOptions::CODEC_LZ4 )
+	{
+	#ifdef ENABLE_LZ4
+		mCompress = true;
+	#else
+		LogWarning(LOG_VIDEO "frameArchiveWriter -- LZ4 support wasn't enabled when jetson-utils was built (ENABLE_LZ4)\n");
+		LogWarning(LOG_VIDEO "frameArchiveWriter -- frames will be stored uncompressed\n");
+	#endif
+	}
+
+	mOptions.codec = mCompress ? videoOptions::CODEC_LZ4 : videoOptions::CODEC_RAW;
+
+	// without a GPU, there's nothing to synchronize with
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+frameArchiveWriter::~frameArchiveWriter()
+{
+	Close();
+}
+
+
+// Create
+frameArchiveWriter* frameArchiveWriter::Create( const videoOptions& options )
+{
+	frameArchiveWriter* writer = new frameArchiveWriter(options);
+
+	if( !writer->init() )
+	{
+		delete writer;
+		return NULL;
+	}
+
+	return writer;
+}
+
+
+// Create
+frameArchiveWriter* frameArchiveWriter::Create( const char* path, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = path;
+	return Create(opt);
+}
+
+
+// init
+bool frameArchiveWriter::init()
+{
+	const char* path = mOptions.resource.location.c_str();
+
+	mFile = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+
+	if( mFile < 0 )
+	{
+		LogError(LOG_VIDEO "frameArchiveWriter -- failed to create '%s' (%s)\n", path, strerror(errno));
+		return false;
+	}
+
+	// the header gets rewritten when the archive is closed
+	frameArchiveHeader header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic   = FRAME_ARCHIVE_MAGIC;
+	header.version = FRAME_ARCHIVE_VERSION;
+
+	if( !write(&header, sizeof(header), 0) )
+		return false;
+
+	mOffset = sizeof(header);
+	mBuffer.reserve(FlushSize);
+
+	return true;
+}
+
+
+// write
+bool frameArchiveWriter::write( const void* data, size_t size, uint64_t offset )
+{
+	const uint8_t* ptr = (const uint8_t*)data;
+
+	while( size > 0 )
+	{
+		const ssize_t written = pwrite(mFile, ptr, size, offset);
+
+		if( written < 0 )
+		{
+			if( errno == EINTR )
+				continue;
+
+			LogError(LOG_VIDEO "frameArchiveWriter -- failed to write to '%s' (%s)\n", mOptions.resource.location.c_str(), strerror(errno));
+			return false;
+		}
+
+		ptr += written;
+		size -= written;
+		offset += written;
+	}
+
+	return true;
+}
+
+
+// flush
+bool frameArchiveWriter::flush()
+{
+	if( mBuffer.size() == 0 )
+		return true;
+
+	const bool result = write(mBuffer.data(), mBuffer.size(), mOffset - mBuffer.size());
+	mBuffer.clear();
+	return result;
+}
+
+
+// Render
+bool frameArchiveWriter::Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	if( !image || width == 0 || height == 0 )
+		return false;
+
+	if( mFile < 0 )
+	{
+		LogError(LOG_VIDEO "frameArchiveWriter -- '%s' has already been closed\n", mOptions.resource.location.c_str());
+		return false;
+	}
+
+	const bool substreams_success = videoOutput::Render(image, width, height, format, stream);
+
+	if( !mStreaming && !Open() )
+		return false;
+
+	// wait for the GPU to finish with the frame
+	if( !mHostMemory && CUDA_FAILED(cudaStreamSynchronize(stream)) )
+		return false;
+
+	const timespec time = timestamp();
+	const uint64_t now = (uint64_t)time.tv_sec * uint64_t(1000000000) + (uint64_t)time.tv_nsec;
+
+	if( mIndex.size() == 0 )
+		mFirstTimestamp = now;
+
+	mLastTimestamp = now;
+
+	// fill out the entry that precedes the payload
+	frameArchiveEntry entry;
+	memset(&entry, 0, sizeof(entry));
+
+	entry.magic       = FRAME_ARCHIVE_ENTRY_MAGIC;
+	entry.compression = FRAME_ARCHIVE_RAW;
+	entry.offset      = mOffset + sizeof(frameArchiveEntry);
+	entry.timestamp   = now - mFirstTimestamp;
+	entry.rawSize     = imageFormatSize(format, width, height);
+	entry.size        = entry.rawSize;
+	entry.width       = width;
+	entry.height      = height;
+	entry.format      = format;
+
+	const uint8_t* payload = (const uint8_t*)image;
+
+#ifdef ENABLE_LZ4
+	if( mCompress )
+	{
+		const int bound = LZ4_compressBound(entry.rawSize);
+
+		if( mCompressed.size() < (size_t)bound )
+			mCompressed.resize(bound);
+
+		const int compressed = LZ4_compress_default((const char*)image, (char*)mCompressed.data(), entry.rawSize, bound);
+
+		// keep the frame uncompressed if it didn't get any smaller
+		if( compressed > 0 && (uint32_t)compressed < entry.rawSize )
+		{
+			entry.compression = FRAME_ARCHIVE_LZ4;
+			entry.size = compressed;
+			payload = mCompressed.data();
+		}
+	}
+#endif
+
+	// append the entry and payload to the write buffer
+	const uint64_t end = alignUp(entry.offset + entry.size, FRAME_ARCHIVE_ALIGNMENT);
+
+	mBuffer.insert(mBuffer.end(), (const uint8_t*)&entry, (const uint8_t*)(&entry + 1));
+	mBuffer.insert(mBuffer.end(), payload, payload + entry.size);
+	mBuffer.resize(mBuffer.size() + (end - entry.offset - entry.size), 0);
+
+	mOffset = end;
+	mIndex.push_back(entry);
+
+	if( mBuffer.size() >= FlushSize && !flush() )
+		return false;
+
+	mOptions.width  = width;
+	mOptions.height = height;
+	mOptions.frameCount++;
+
+	return substreams_success;
+}
+
+
+// Close
+void frameArchiveWriter::Close()
+{
+	if( mFile < 0 )
+		return;
+
+	const uint64_t numFrames = mIndex.size();
+
+	// the index goes at the end of the file, followed by the final header
+	if( flush() && write(mIndex.data(), numFrames * sizeof(frameArchiveEntry), mOffset) )
+	{
+		frameArchiveHeader header;
+		memset(&header, 0, sizeof(header));
+
+		header.magic       = FRAME_ARCHIVE_MAGIC;
+		header.version     = FRAME_ARCHIVE_VERSION;
+		header.numFrames   = numFrames;
+		header.indexOffset = mOffset;
+		header.frameRate   = mOptions.frameRate;
+
+		if( numFrames > 1 && mLastTimestamp > mFirstTimestamp )
+			header.frameRate = double(numFrames - 1) * 1000000000.0 / double(mLastTimestamp - mFirstTimestamp);
+
+		if( write(&header, sizeof(header), 0) )
+			LogVerbose(LOG_VIDEO "frameArchiveWriter -- wrote %llu frames to '%s' (%.1f MB)\n", (unsigned long long)numFrames, mOptions.resource.location.c_str(), double(mOffset + numFrames * sizeof(frameArchiveEntry)) / (1024.0 * 1024.0));
+	}
+
+	close(mFile);
+
+	mFile = -1;
+	mStreaming = false;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __FRAME_ARCHIVE_WRITER_H_
+#define __FRAME_ARCHIVE_WRITER_H_
+
+
+#include "videoOutput.h"
+#include "frameArchive.h"
+
+#include <vector>
+
+
+/**
+ * Record frames to a frame archive on disk (`.frames` files), which can be
+ * replayed with frameArchiveReader without having to decode them.
+ *
+ * Frames are stored in the format that they're rendered in (for example,
+ * recording the raw format of a camera avoids any conversions).  To save
+ * space, they can be losslessly compressed with LZ4 by using the
+ * `--output-codec=lz4` option (this requires jetson-utils to be built
+ * with `ENABLE_LZ4`).  Frames that don't compress well are stored as-is.
+ *
+ * The frames are accumulated in memory and written to disk in large
+ * sequential writes of FlushSize bytes, and the index is appended when
+ * the archive is closed.
+ *
+ * @note frameArchiveWriter implements the videoOutput interface and is intended
+ * to be used through that as opposed to directly.  videoOutput implements
+ * additional command-line parsing of videoOptions to construct instances.
+ *
+ * @see frameArchive.h for the file format.
+ * @see frameArchiveReader
+ * @ingroup video
+ */
+class frameArchiveWriter : public videoOutput
+{
+public:
+	/**
+	 * Create a frameArchiveWriter instance from a path and optional videoOptions.
+	 */
+	static frameArchiveWriter* Create( const char* path, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Create a frameArchiveWriter instance from the provided video options.
+	 */
+	static frameArchiveWriter* Create( const videoOptions& options );
+
+	/**
+	 * Destructor (this closes the archive)
+	 */
+	virtual ~frameArchiveWriter();
+
+	/**
+	 * Record the next frame.
+	 * @see videoOutput::Render()
+	 */
+	template<typename T> bool Render( T* image, uint32_t width, uint32_t height, cudaStream_t stream=0 )		{ return Render((void**)image, width, height, imageFormatFromType<T>(), stream); }
+
+	/**
+	 * Record the next frame.
+	 * @see videoOutput::Render()
+	 */
+	virtual bool Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
+
+	/**
+	 * Close the archive by flushing the remaining frames and writing the index.
+	 * @see videoOutput::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the number of frames that have been recorded.
+	 */
+	inline uint64_t GetNumFrames() const			{ return mIndex.size(); }
+
+	/**
+	 * Return the interface type (frameArchiveWriter::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of frameArchiveWriter class.
+	 */
+	static const uint32_t Type = (1 << 9);
+
+	/**
+	 * Return true if the extension is for a frame archive (`frames`)
+	 */
+	static bool IsSupportedExtension( const char* ext );
+
+	/**
+	 * The amount of data that's buffered before writing it to disk (in bytes).
+	 */
+	static const size_t FlushSize = 16 * 1024 * 1024;
+
+protected:
+	frameArchiveWriter( const videoOptions& options );
+
+	bool init();
+	bool flush();
+	bool write( const void* data, size_t size, uint64_t offset );
+
+	int      mFile;
+	uint64_t mOffset;
+	uint64_t mFirstTimestamp;
+	uint64_t mLastTimestamp;
+	bool     mCompress;
+	bool     mHostMemory;
+
+	std::vector<uint8_t> mBuffer;
+	std::vector<uint8_t> mCompressed;
+	std::vector<frameArchiveEntry> mIndex;
+};
+
+#endif
@@ -0,0 +1,846 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mjpegOutput.h"
+
+#include "Networking.h"
+#include "Thread.h"
+
+#include "cudaMappedMemory.h"
+#include "cudaColorspace.h"
+#include "cudaResize.h"
+
+#include "imageIO.h"
+#include "metrics.h"
+#include "timespec.h"
+#include "logging.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+
+
+// multipart boundary between the JPEG frames
+#define MJPEG_BOUNDARY "jetsonframe"
+
+
+// allocate a buffer that both the CPU and GPU can access
+static bool allocBuffer( void** ptr, size_t* allocated, size_t size, bool hostMemory )
+{
+	if( *ptr != NULL && *allocated >= size )
+		return true;
+
+	if( *ptr != NULL )
+	{
+		if( hostMemory )
+			free(*ptr);
+		else
+			CUDA(cudaFreeHost(*ptr));
+	}
+
+	*ptr = NULL;
+	*allocated = 0;
+
+	if( hostMemory )
+		*ptr = malloc(size);
+	else if( !cudaAllocMapped(ptr, size, false) )
+		*ptr = NULL;
+
+	if( !*ptr )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to allocate %zu bytes\n", size);
+		return false;
+	}
+
+	*allocated = size;
+	return true;
+}
+
+
+// free a buffer from allocBuffer()
+static void freeBuffer( void** ptr, size_t* allocated, bool hostMemory )
+{
+	if( *ptr != NULL )
+	{
+		if( hostMemory )
+			free(*ptr);
+		else
+			CUDA(cudaFreeHost(*ptr));
+	}
+
+	*ptr = NULL;
+	*allocated = 0;
+}
+
+
+// constructor
+mjpegOutput::mjpegOutput( const videoOptions& options ) : videoOutput(options)
+{
+	mPath          = "/";
+	mQuality       = DefaultQuality;
+	mScaleWidth    = options.width;
+	mScaleHeight   = options.height;
+	mMaxRate       = options.frameRate;
+	mHostMemory    = false;
+	mSocket        = -1;
+	mWakePipe[0]   = -1;
+	mWakePipe[1]   = -1;
+	mQuit          = false;
+	mThread        = NULL;
+	mNumStreaming  = 0;
+	mConverted     = NULL;
+	mConvertedSize = 0;
+	mResized       = NULL;
+	mResizedSize   = 0;
+	mLastEncode    = 0;
+	mFramesEncoded = 0;
+
+	mClientsMetric = NULL;
+	mBytesMetric   = NULL;
+	mDroppedMetric = NULL;
+	mEncodeMetric  = NULL;
+
+	mOptions.codec = videoOptions::CODEC_MJPEG;
+
+	if( mOptions.queueDepth == 0 )
+		mOptions.queueDepth = 1;
+
+	// without a GPU, frames are converted and resized with the CPU
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+mjpegOutput::~mjpegOutput()
+{
+	Close();
+
+	freeBuffer(&mConverted, &mConvertedSize, mHostMemory);
+	freeBuffer(&mResized, &mResizedSize, mHostMemory);
+
+	Metrics::Release(mClientsMetric);
+	Metrics::Release(mBytesMetric);
+	Metrics::Release(mDroppedMetric);
+	Metrics::Release(mEncodeMetric);
+}
+
+
+// Create
+mjpegOutput* mjpegOutput::Create( const videoOptions& options )
+{
+	mjpegOutput* output = new mjpegOutput(options);
+
+	if( !output->init() )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to create HTTP MJPEG server for %s\n", options.resource.string.c_str());
+		delete output;
+		return NULL;
+	}
+
+	return output;
+}
+
+
+// Create
+mjpegOutput* mjpegOutput::Create( const char* resource, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = resource;
+	return Create(opt);
+}
+
+
+// init
+bool mjpegOutput::init()
+{
+	if( mOptions.resource.port == 0 )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- the port was missing from the URI (expected http://@:8090/my_stream)\n");
+		return false;
+	}
+
+	if( !parseOptions() )
+		return false;
+
+	const std::string labels = Metrics::Label("uri", mOptions.resource.string.c_str());
+
+	mClientsMetric = Metrics::Gauge("jetson_mjpeg_clients", "Number of clients receiving the MJPEG stream", labels.c_str());
+	mBytesMetric   = Metrics::Counter("jetson_mjpeg_sent_bytes_total", "Bytes sent to the MJPEG clients", labels.c_str());
+	mDroppedMetric = Metrics::Counter("jetson_mjpeg_dropped_total", "Frames dropped because an MJPEG client couldn't keep up", labels.c_str());
+	mEncodeMetric  = Metrics::Histogram("jetson_mjpeg_encode_seconds", "Time spent converting and encoding each MJPEG frame", labels.c_str());
+
+	return Open();
+}
+
+
+// parseOptions
+bool mjpegOutput::parseOptions()
+{
+	// http://@:8090/my_stream?quality=75 is parsed with the path and query together
+	const std::string& location = mOptions.resource.location;
+	std::string path = mOptions.resource.path;
+
+	if( path.size() == 0 || path == location || path[0] != '/' )
+		path = "/";
+
+	const size_t query = path.find('?');
+
+	mPath = path.substr(0, query);
+
+	if( query == std::string::npos )
+		return true;
+
+	// parse the key=value pairs after the '?'
+	size_t pos = query + 1;
+
+	while( pos < path.size() )
+	{
+		size_t end = path.find('&', pos);
+
+		if( end == std::string::npos )
+			end = path.size();
+
+		const std::string param = path.substr(pos, end - pos);
+		const size_t eq = param.find('=');
+
+		const std::string key   = param.substr(0, eq);
+		const std::string value = (eq != std::string::npos) ? param.substr(eq + 1) : "";
+
+		if( key == "quality" )
+		{
+			mQuality = atoi(value.c_str());
+
+			if( mQuality < 1 || mQuality > 100 )
+			{
+				LogError(LOG_VIDEO "mjpegOutput -- invalid JPEG quality '%s' (should be between 1 and 100)\n", value.c_str());
+				return false;
+			}
+		}
+		else if( key.size() > 0 )
+		{
+			LogWarning(LOG_VIDEO "mjpegOutput -- ignoring unknown option '%s'\n", key.c_str());
+		}
+
+		pos = end + 1;
+	}
+
+	return true;
+}
+
+
+// Open
+bool mjpegOutput::Open()
+{
+	if( mStreaming )
+		return true;
+
+	if( pipe(mWakePipe) < 0 )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to create pipe (%s)\n", strerror(errno));
+		return false;
+	}
+
+	fcntl(mWakePipe[0], F_SETFL, O_NONBLOCK);
+	fcntl(mWakePipe[1], F_SETFL, O_NONBLOCK);
+
+	mSocket = socket(AF_INET, SOCK_STREAM, 0);
+
+	if( mSocket < 0 )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to create socket (%s)\n", strerror(errno));
+		Close();
+		return false;
+	}
+
+	const int reuse = 1;
+	setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family      = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port        = htons(mOptions.resource.port);
+
+	if( bind(mSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to bind to port %i (%s)\n", mOptions.resource.port, strerror(errno));
+		Close();
+		return false;
+	}
+
+	if( listen(mSocket, 16) < 0 )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to listen on port %i (%s)\n", mOptions.resource.port, strerror(errno));
+		Close();
+		return false;
+	}
+
+	fcntl(mSocket, F_SETFL, O_NONBLOCK);
+
+	mQuit = false;
+	mThread = new Thread();
+
+	if( !mThread->Start(serverThread, this) )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to start server thread\n");
+		Close();
+		return false;
+	}
+
+	LogSuccess(LOG_VIDEO "mjpegOutput -- MJPEG stream available @ http://%s:%i%s\n", getHostname().c_str(), mOptions.resource.port, mPath.c_str());
+
+	mStreaming = true;
+	return true;
+}
+
+
+// Close
+void mjpegOutput::Close()
+{
+	if( mThread != NULL )
+	{
+		mQuit = true;
+
+		if( mWakePipe[1] >= 0 )
+			write(mWakePipe[1], "q", 1);
+
+		mThread->Stop(true);
+		delete mThread;
+		mThread = NULL;
+	}
+
+	mMutex.Lock();
+
+	while( mClients.size() > 0 )
+		removeClient(mClients.size() - 1);
+
+	mMutex.Unlock();
+
+	if( mSocket >= 0 )
+	{
+		close(mSocket);
+		mSocket = -1;
+	}
+
+	for( int n=0; n < 2; n++ )
+	{
+		if( mWakePipe[n] >= 0 )
+		{
+			close(mWakePipe[n]);
+			mWakePipe[n] = -1;
+		}
+	}
+
+	mStreaming = false;
+}
+
+
+// GetNumClients
+uint32_t mjpegOutput::GetNumClients() const
+{
+	mMutex.Lock();
+	const uint32_t numClients = mNumStreaming;
+	mMutex.Unlock();
+
+	return numClients;
+}
+
+
+// Render
+bool mjpegOutput::Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	if( !image || width == 0 || height == 0 )
+		return false;
+
+	const bool substreams_success = videoOutput::Render(image, width, height, format, stream);
+
+	if( !mStreaming && !Open() )
+		return false;
+
+	// only encode when someone is watching
+	if( GetNumClients() == 0 )
+		return substreams_success;
+
+	// limit the rate that frames are sent at
+	const uint64_t now = apptime_nano();
+
+	if( mMaxRate > 0 && mLastEncode != 0 && (now - mLastEncode) < uint64_t(1e9f / mMaxRate) )
+		return substreams_success;
+
+	mLastEncode = now;
+
+	if( !encode(image, width, height, format, stream) )
+		return false;
+
+	return substreams_success;
+}
+
+
+// encode
+bool mjpegOutput::encode( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	const timespec encodeStart = timestamp();
+
+	// the scaled size keeps the aspect ratio if only one dimension was set
+	uint32_t scaleWidth  = mScaleWidth;
+	uint32_t scaleHeight = mScaleHeight;
+
+	if( scaleWidth == 0 && scaleHeight == 0 )
+	{
+		scaleWidth  = width;
+		scaleHeight = height;
+	}
+	else if( scaleWidth == 0 )
+	{
+		scaleWidth = (width * scaleHeight) / height;
+	}
+	else if( scaleHeight == 0 )
+	{
+		scaleHeight = (height * scaleWidth) / width;
+	}
+
+	if( scaleWidth == 0 || scaleHeight == 0 || scaleWidth > width || scaleHeight > height )
+	{
+		scaleWidth  = width;
+		scaleHeight = height;
+	}
+
+	// grayscale can be encoded directly, everything else gets converted to RGB8
+	const imageFormat encodeFormat = (format == IMAGE_GRAY8) ? IMAGE_GRAY8 : IMAGE_RGB8;
+
+	if( !allocBuffer(&mConverted, &mConvertedSize, imageFormatSize(encodeFormat, width, height), mHostMemory) )
+		return false;
+
+	const cudaImageView input(image, width, height, format);
+	const cudaImageView converted(mConverted, width, height, encodeFormat);
+
+	// the frame is always copied into mapped memory, because the input may only be accessible from the GPU
+	if( mHostMemory )
+	{
+		if( !cudaConvertColorCPU(input, converted) )
+		{
+			LogError(LOG_VIDEO "mjpegOutput -- unsupported image format (%s)\n", imageFormatToStr(format));
+			return false;
+		}
+	}
+	else if( CUDA_FAILED(cudaConvertColor(input, converted, make_float2(0,255), stream)) )
+	{
+		LogError(LOG_VIDEO "mjpegOutput -- failed to convert %s frame to %s\n", imageFormatToStr(format), imageFormatToStr(encodeFormat));
+		return false;
+	}
+
+	void* frame = mConverted;
+
+	if( scaleWidth != width || scaleHeight != height )
+	{
+		if( !allocBuffer(&mResized, &mResizedSize, imageFormatSize(encodeFormat, scaleWidth, scaleHeight), mHostMemory) )
+			return false;
+
+		const cudaImageView resized(mResized, scaleWidth, scaleHeight, encodeFormat);
+
+		if( mHostMemory )
+		{
+			if( !cudaResizeCPU(converted, resized) )
+				return false;
+		}
+		else if( CUDA_FAILED(cudaResize(converted, resized, FILTER_POINT, stream)) )
+		{
+			return false;
+		}
+
+		frame = mResized;
+	}
+
+	if( !mHostMemory && CUDA_FAILED(cudaStreamSynchronize(stream)) )
+		return false;
+
+	if( !encodeJPEG(frame, scaleWidth, scaleHeight, encodeFormat, mJPEG, mQuality) )
+		return false;
+
+	// wrap the JPEG in a multipart section that's shared by all of the clients
+	char header[128];
+
+	const int headerSize = snprintf(header, sizeof(header),
+		"--" MJPEG_BOUNDARY "\r\n"
+		"Content-Type: image/jpeg\r\n"
+		"Content-Length: %zu\r\n"
+		"\r\n", mJPEG.size());
+
+	Packet packet(new std::vector<unsigned char>());
+
+	packet->reserve(headerSize + mJPEG.size() + 2);
+	packet->insert(packet->end(), header, header + headerSize);
+	packet->insert(packet->end(), mJPEG.begin(), mJPEG.end());
+	packet->push_back('\r');
+	packet->push_back('\n');
+
+	mEncodeMetric->ObserveSince(encodeStart);
+
+	mOptions.width  = scaleWidth;
+	mOptions.height = scaleHeight;
+	mFramesEncoded++;
+
+	publish(packet);
+	return true;
+}
+
+
+// publish
+void mjpegOutput::publish( const Packet& packet )
+{
+	mMutex.Lock();
+
+	const size_t numClients = mClients.size();
+
+	for( size_t n=0; n < numClients; n++ )
+	{
+		Client* client = mClients[n];
+
+		if( !client->streaming )
+			continue;
+
+		// the front packet can't be dropped if it's already partially sent
+		const size_t pinned = (client->offset > 0) ? 1 : 0;
+
+		if( client->queue.size() >= mOptions.queueDepth + pinned )
+		{
+			client->framesDropped++;
+			mDroppedMetric->Increment();
+
+			if( mOptions.queuePolicy == videoOptions::QUEUE_DROP_NEWEST || client->queue.size() <= pinned )
+				continue;
+
+			client->queue.erase(client->queue.begin() + pinned);
+		}
+
+		client->queue.push_back(packet);
+	}
+
+	mMutex.Unlock();
+
+	// wake up the server thread so it starts sending
+	write(mWakePipe[1], "f", 1);
+}
+
+
+// serverThread
+void* mjpegOutput::serverThread( void* user_data )
+{
+	mjpegOutput* output = (mjpegOutput*)user_data;
+
+	std::vector<struct pollfd> fds;
+
+	while( !output->mQuit )
+	{
+		// poll the wake pipe, the listening socket, and the clients
+		output->mMutex.Lock();
+
+		const size_t numClients = output->mClients.size();
+
+		fds.resize(numClients + 2);
+
+		fds[0].fd     = output->mWakePipe[0];
+		fds[0].events = POLLIN;
+		fds[1].fd     = output->mSocket;
+		fds[1].events = POLLIN;
+
+		for( size_t n=0; n < numClients; n++ )
+		{
+			Client* client = output->mClients[n];
+
+			fds[n+2].fd     = client->fd;
+			fds[n+2].events = POLLIN;
+
+			if( client->queue.size() > 0 )
+				fds[n+2].events |= POLLOUT;
+		}
+
+		output->mMutex.Unlock();
+
+		for( size_t n=0; n < fds.size(); n++ )
+			fds[n].revents = 0;
+
+		const int result = poll(&fds[0], fds.size(), 250);
+
+		if( result < 0 && errno != EINTR )
+		{
+			LogError(LOG_VIDEO "mjpegOutput -- failed to poll sockets (%s)\n", strerror(errno));
+			break;
+		}
+
+		if( result <= 0 )
+			continue;
+
+		// drain the wake pipe
+		if( fds[0].revents & POLLIN )
+		{
+			char buffer[64];
+			while( read(output->mWakePipe[0], buffer, sizeof(buffer)) > 0 );
+		}
+
+		if( fds[1].revents & POLLIN )
+			output->acceptClient();
+
+		// service the clients (new clients from acceptClient() are at the end, and get polled next time)
+		output->mMutex.Lock();
+
+		for( size_t n=numClients; n > 0; n-- )
+		{
+			const size_t index = n - 1;
+			Client* client = output->mClients[index];
+			const short revents = fds[index+2].revents;
+
+			bool keep = true;
+
+			if( revents & (POLLERR|POLLHUP|POLLNVAL) )
+				keep = false;
+			else if( (revents & POLLIN) && !client->streaming )
+				keep = output->readRequest(client);
+			else if( revents & POLLIN )
+			{
+				// streaming clients don't send anything else, so this is a disconnect
+				char buffer[256];
+				const ssize_t received = recv(client->fd, buffer, sizeof(buffer), 0);
+
+				if( received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) )
+					keep = false;
+			}
+
+			if( keep && client->queue.size() > 0 )
+				keep = output->sendQueued(client);
+
+			// clients that got a single response are closed once it's sent
+			if( keep && client->closing && client->queue.size() == 0 )
+				keep = false;
+
+			if( !keep )
+				output->removeClient(index);
+		}
+
+		output->mMutex.Unlock();
+	}
+
+	return NULL;
+}
+
+
+// acceptClient
+void mjpegOutput::acceptClient()
+{
+	struct sockaddr_in addr;
+	socklen_t addrLen = sizeof(addr);
+
+	const int fd = accept(mSocket, (struct sockaddr*)&addr, &addrLen);
+
+	if( fd < 0 )
+		return;
+
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+
+	Client* client = new Client();
+
+	client->fd            = fd;
+	client->streaming     = false;
+	client->closing       = false;
+	client->offset        = 0;
+	client->framesSent    = 0;
+	client->framesDropped = 0;
+
+	char address[INET_ADDRSTRLEN] = {0};
+	inet_ntop(AF_INET, &addr.sin_addr, address, sizeof(address));
+	client->address = address;
+
+	mMutex.Lock();
+	mClients.push_back(client);
+	mMutex.Unlock();
+
+	LogVerbose(LOG_VIDEO "mjpegOutput -- new connection from %s\n", client->address.c_str());
+}
+
+
+// readRequest
+bool mjpegOutput::readRequest( Client* client )
+{
+	char buffer[1024];
+
+	const ssize_t received = recv(client->fd, buffer, sizeof(buffer), 0);
+
+	if( received < 0 )
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+
+	if( received == 0 )
+		return false;
+
+	client->request.append(buffer, received);
+
+	if( client->request.size() > 16384 )
+		return false;
+
+	// wait for the end of the request headers
+	if( client->request.find("\r\n\r\n") == std::string::npos && client->request.find("\n\n") == std::string::npos )
+		return true;
+
+	// parse the request line:  METHOD PATH VERSION
+	const size_t methodEnd = client->request.find(' ');
+	const size_t pathEnd = (methodEnd != std::string::npos) ? client->request.find_first_of(" \r\n", methodEnd + 1) : std::string::npos;
+
+	if( pathEnd == std::string::npos )
+		return false;
+
+	const std::string method = client->request.substr(0, methodEnd);
+	std::string path = client->request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+
+	const size_t query = path.find('?');
+
+	if( query != std::string::npos )
+		path.resize(query);
+
+	client->request.clear();
+
+	LogVerbose(LOG_VIDEO "mjpegOutput -- HTTP %s '%s' from %s\n", method.c_str(), path.c_str(), client->address.c_str());
+
+	// queue the response, which gets sent when the socket is writable
+	std::string status = "200 OK";
+	std::string body;
+	std::string contentType = "text/html";
+
+	if( method != "GET" )
+	{
+		status = "405 Method Not Allowed";
+		contentType = "text/plain";
+		body = "method not allowed\n";
+	}
+	else if( path == mPath )
+	{
+		const char* header =
+			"HTTP/1.0 200 OK\r\n"
+			"Content-Type: multipart/x-mixed-replace; boundary=" MJPEG_BOUNDARY "\r\n"
+			"Cache-Control: no-cache, no-store, must-revalidate\r\n"
+			"Pragma: no-cache\r\n"
+			"Connection: close\r\n"
+			"\r\n";
+
+		// the header is sent right away, so the queue only ever holds frames that can be dropped
+		if( send(client->fd, header, strlen(header), MSG_NOSIGNAL) != (ssize_t)strlen(header) )
+			return false;
+
+		client->streaming = true;
+
+		mNumStreaming++;
+		mClientsMetric->Set(mNumStreaming);
+
+		LogInfo(LOG_VIDEO "mjpegOutput -- %s started streaming %s (%u clients)\n", client->address.c_str(), mPath.c_str(), mNumStreaming);
+		return true;
+	}
+	else if( path == "/" )
+	{
+		body = "<html><body style='margin:0; background:black'><img src='" + mPath + "' style='max-width:100%'></body></html>\n";
+	}
+	else
+	{
+		status = "404 Not Found";
+		contentType = "text/plain";
+		body = "not found\n";
+	}
+
+	char header[256];
+
+	const int headerSize = snprintf(header, sizeof(header),
+		"HTTP/1.0 %s\r\n"
+		"Content-Type: %s\r\n"
+		"Content-Length: %zu\r\n"
+		"Connection: close\r\n"
+		"\r\n", status.c_str(), contentType.c_str(), body.size());
+
+	Packet response(new std::vector<unsigned char>(header, header + headerSize));
+	response->insert(response->end(), body.begin(), body.end());
+
+	client->queue.push_back(response);
+	client->closing = true;
+
+	return true;
+}
+
+
+// sendQueued
+bool mjpegOutput::sendQueued( Client* client )
+{
+	while( client->queue.size() > 0 )
+	{
+		const Packet& packet = client->queue.front();
+		const size_t remaining = packet->size() - client->offset;
+
+		const ssize_t sent = send(client->fd, &(*packet)[client->offset], remaining, MSG_NOSIGNAL);
+
+		if( sent < 0 )
+		{
+			if( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+				return true;	// the socket is full, wait until it's writable again
+
+			return false;
+		}
+
+		mBytesMetric->Increment(sent);
+		client->offset += sent;
+
+		if( client->offset < packet->size() )
+			return true;
+
+		client->queue.pop_front();
+		client->offset = 0;
+		client->framesSent++;
+	}
+
+	return true;
+}
+
+
+// removeClient
+void mjpegOutput::removeClient( size_t index )
+{
+	Client* client = mClients[index];
+
+	if( client->streaming )
+	{
+		mNumStreaming--;
+		mClientsMetric->Set(mNumStreaming);
+
+		LogInfo(LOG_VIDEO "mjpegOutput -- %s stopped streaming (%lu frames sent, %lu dropped)\n", client->address.c_str(), client->framesSent, client->framesDropped);
+	}
+
+	close(client->fd);
+	delete client;
+
+	mClients.erase(mClients.begin() + index);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __MJPEG_OUTPUT_H_
+#define __MJPEG_OUTPUT_H_
+
+
+#include "videoOutput.h"
+#include "Mutex.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// forward declarations
+class Thread;
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+
+
+/**
+ * Serve a Motion JPEG (MJPEG) stream over HTTP (`http://@:8090/my_stream`), which
+ * browsers can display directly with an `<img>` tag, without any WebRTC negotiation.
+ *
+ * Each frame is encoded to JPEG only once, no matter how many clients are connected,
+ * and the same bytes are sent to all of them as a `multipart/x-mixed-replace` stream.
+ * When no clients are connected, frames aren't encoded at all.  Navigating to the root
+ * of the server (`http://<hostname>:8090/`) shows a page with the stream embedded.
+ *
+ * Each client has its own queue of frames waiting to be sent, which holds up to
+ * `--output-queue` frames.  When a client can't keep up, frames are dropped from its
+ * queue (the oldest ones, unless `--output-queue-policy=drop-newest`) so that other
+ * clients and the application are never blocked by it.
+ *
+ * The stream can be downscaled with `--output-width` and `--output-height` (if only one
+ * is set, the aspect ratio is kept), and rate-limited with `--output-rate`.  The JPEG
+ * quality can be set in the URI, for example `http://@:8090/my_stream?quality=75`.
+ *
+ * The frames are served from a small HTTP server thread on the given port, so other
+ * servers like WebRTC and RTSP should use different ports.
+ *
+ * @note mjpegOutput implements the videoOutput interface and is intended to be used
+ * through that as opposed to directly.  videoOutput implements additional command-line
+ * parsing of videoOptions to construct instances.
+ *
+ * @see videoOutput
+ * @ingroup video
+ */
+class mjpegOutput : public videoOutput
+{
+public:
+	/**
+	 * Create an mjpegOutput instance from the provided video options.
+	 */
+	static mjpegOutput* Create( const videoOptions& options );
+
+	/**
+	 * Create an mjpegOutput instance from an http:// URI and optional videoOptions.
+	 */
+	static mjpegOutput* Create( const char* resource, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~mjpegOutput();
+
+	/**
+	 * Encode the next frame and send it to the clients.
+	 * @see videoOutput::Render()
+	 */
+	template<typename T> bool Render( T* image, uint32_t width, uint32_t height, cudaStream_t stream=0 )		{ return Render((void**)image, width, height, imageFormatFromType<T>(), stream); }
+
+	/**
+	 * Encode the next frame and send it to the clients.
+	 * @see videoOutput::Render()
+	 */
+	virtual bool Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
+
+	/**
+	 * Start the HTTP server.
+	 * @see videoOutput::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * Stop the HTTP server and disconnect the clients.
+	 * @see videoOutput::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the number of clients that are streaming.
+	 */
+	uint32_t GetNumClients() const;
+
+	/**
+	 * Return the number of frames that have been encoded.
+	 */
+	inline uint64_t GetFramesEncoded() const		{ return mFramesEncoded; }
+
+	/**
+	 * Return the interface type (mjpegOutput::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of mjpegOutput class.
+	 */
+	static const uint32_t Type = (1 << 11);
+
+	/**
+	 * The default JPEG quality level.
+	 */
+	static const int DefaultQuality = 85;
+
+protected:
+	mjpegOutput( const videoOptions& options );
+
+	bool init();
+	bool parseOptions();
+	bool encode( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream );
+	void publish( const std::shared_ptr< std::vector<unsigned char> >& frame );
+
+	static void* serverThread( void* user_data );
+
+	typedef std::shared_ptr< std::vector<unsigned char> > Packet;
+
+	struct Client
+	{
+		int         fd;
+		bool        streaming;		// false while the request is being read
+		bool        closing;		// close after the queued response is sent
+		std::string request;
+		std::string address;
+
+		std::deque<Packet> queue;	// data waiting to be sent
+		size_t             offset;	// bytes of the front packet already sent
+
+		uint64_t framesSent;
+		uint64_t framesDropped;
+	};
+
+	void acceptClient();
+	bool readRequest( Client* client );
+	bool sendQueued( Client* client );
+	void removeClient( size_t index );
+
+	std::string mPath;
+	int         mQuality;
+	uint32_t    mScaleWidth;
+	uint32_t    mScaleHeight;
+	float       mMaxRate;
+	bool        mHostMemory;
+
+	int         mSocket;
+	int         mWakePipe[2];
+	bool        mQuit;
+	Thread*     mThread;
+
+	mutable Mutex        mMutex;
+	std::vector<Client*> mClients;
+	uint32_t             mNumStreaming;
+
+	void*    mConverted;		// RGB8 frame in mapped memory
+	size_t   mConvertedSize;
+	void*    mResized;			// downscaled RGB8 frame in mapped memory
+	size_t   mResizedSize;
+	uint64_t mLastEncode;		// time of the last encoded frame (in nanoseconds)
+	uint64_t mFramesEncoded;
+
+	std::vector<unsigned char> mJPEG;
+
+	MetricGauge*     mClientsMetric;
+	MetricCounter*   mBytesMetric;
+	MetricCounter*   mDroppedMetric;
+	MetricHistogram* mEncodeMetric;
+};
+
+#endif
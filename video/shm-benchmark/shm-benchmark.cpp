@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "videoSource.h"
+#include "videoOutput.h"
+#include "shmSource.h"
+
+#include "Process.h"
+#include "timespec.h"
+#include "logging.h"
+#include "commandLine.h"
+
+#include <algorithm>
+#include <signal.h>
+#include <vector>
+
+
+int usage()
+{
+	printf("usage: shm-benchmark [--help] [--readers=N] [--duration=SECONDS] [input_URI]\n\n");
+	printf("Measure the latency and throughput of sharing frames between processes over shm://\n");
+	printf("The input stream is published to a shared memory ring and received by reader processes.\n");
+	printf("See below for additional arguments that may not be shown above.\n\n");
+	printf("positional arguments:\n");
+	printf("    input_URI       resource URI of input stream (default is test://gradient)\n\n");
+	printf("optional arguments:\n");
+	printf("  --readers=N       number of reader processes to run (default is 2)\n");
+	printf("  --duration=SEC    number of seconds to run the benchmark for (default is 10)\n");
+	printf("  --shm=NAME        name of the shared memory ring (default is shm-benchmark)\n\n");
+
+	printf("%s", videoSource::Usage());
+	printf("%s", Log::Usage());
+
+	return 0;
+}
+
+
+// receive frames until the writer closes the stream, then print the statistics
+int runReader( uint32_t id, const std::string& uri )
+{
+	videoSource* input = shmSource::Create(uri.c_str());
+
+	if( !input )
+		return 1;
+
+	std::vector<uint64_t> latencies;
+	latencies.reserve(100000);
+
+	timespec begin = timeZero();
+
+	while( true )
+	{
+		void* image = NULL;
+		int status = 0;
+
+		if( !input->Capture(&image, IMAGE_UNKNOWN, 5000, &status) )
+		{
+			if( status == videoSource::TIMEOUT )
+				continue;
+
+			break; // EOS
+		}
+
+		const timespec now = timestamp();
+		const uint64_t nanoseconds = (uint64_t)now.tv_sec * uint64_t(1000000000) + (uint64_t)now.tv_nsec;
+
+		if( latencies.size() == 0 )
+			begin = now;
+
+		latencies.push_back(nanoseconds - input->GetLastTimestamp());
+	}
+
+	const float elapsed = timeFloat(timeDiff(begin, timestamp())) * 0.001f;
+	const size_t count = latencies.size();
+
+	if( count == 0 )
+	{
+		LogError("shm-benchmark:  reader %u didn't receive any frames\n", id);
+		SAFE_DELETE(input);
+		return 1;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	uint64_t total = 0;
+
+	for( size_t n=0; n < count; n++ )
+		total += latencies[n];
+
+	LogSuccess("shm-benchmark:  reader %u received %zu frames (%ux%u %s) in %.2fs -- %.1f FPS, %llu dropped\n",
+			 id, count, input->GetWidth(), input->GetHeight(), imageFormatToStr(input->GetRawFormat()),
+			 elapsed, (elapsed > 0) ? count / elapsed : 0.0f, (unsigned long long)((shmSource*)input)->GetDroppedFrames());
+
+	LogSuccess("shm-benchmark:  reader %u latency -- mean %.1fus  p50 %.1fus  p99 %.1fus  max %.1fus\n", id,
+			 total / count * 0.001, latencies[count / 2] * 0.001, latencies[(count * 99) / 100] * 0.001, latencies[count - 1] * 0.001);
+
+	SAFE_DELETE(input);
+	return 0;
+}
+
+
+// terminate the readers if the writer failed to start
+void stopReaders( const std::vector<pid_t>& readers )
+{
+	for( size_t n=0; n < readers.size(); n++ )
+	{
+		kill(readers[n], SIGTERM);
+		Process::Wait(readers[n]);
+	}
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	const uint32_t numReaders = cmdLine.GetUnsignedInt("readers", 2);
+	const float duration = cmdLine.GetFloat("duration", 10.0f);
+	const std::string uri = std::string("shm://") + cmdLine.GetString("shm", "shm-benchmark");
+
+
+	/*
+	 * fork the readers (before the writer initializes CUDA)
+	 */
+	std::vector<pid_t> readers;
+
+	for( uint32_t n=0; n < numReaders; n++ )
+	{
+		const pid_t pid = Process::Fork();
+
+		if( pid == 0 )
+			return runReader(n, uri);
+		else if( pid > 0 )
+			readers.push_back(pid);
+	}
+
+
+	/*
+	 * create input and shared memory streams
+	 */
+	videoSource* input = videoSource::Create(cmdLine.GetPosition(0, "test://gradient"), cmdLine, -1);
+
+	if( !input )
+	{
+		LogError("shm-benchmark:  failed to create input stream\n");
+		stopReaders(readers);
+		return 1;
+	}
+
+	videoOutput* output = videoOutput::Create(uri.c_str());
+
+	if( !output )
+	{
+		LogError("shm-benchmark:  failed to create shared memory stream\n");
+		stopReaders(readers);
+		return 1;
+	}
+
+
+	/*
+	 * publish frames for the duration
+	 */
+	const timespec begin = timestamp();
+	uint64_t numFrames = 0;
+
+	while( timeFloat(timeDiff(begin, timestamp())) < duration * 1000.0f )
+	{
+		void* image = NULL;
+		int status = 0;
+
+		if( !input->Capture(&image, IMAGE_UNKNOWN, 1000, &status) )
+		{
+			if( status == videoSource::TIMEOUT )
+				continue;
+
+			break; // EOS
+		}
+
+		if( !output->Render(image, input->GetWidth(), input->GetHeight(), input->GetRawFormat()) )
+			break;
+
+		numFrames++;
+	}
+
+	const float elapsed = timeFloat(timeDiff(begin, timestamp())) * 0.001f;
+	LogSuccess("shm-benchmark:  writer published %llu frames in %.2fs -- %.1f FPS\n", (unsigned long long)numFrames, elapsed, numFrames / elapsed);
+
+
+	/*
+	 * close the stream (signalling EOS to the readers) and wait for them
+	 */
+	SAFE_DELETE(output);
+	SAFE_DELETE(input);
+
+	int result = 0;
+
+	for( size_t n=0; n < readers.size(); n++ )
+	{
+		if( Process::Wait(readers[n]) != 0 )
+			result = 1;
+	}
+
+	return result;
+}
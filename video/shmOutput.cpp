@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "shmOutput.h"
+
+#include "cudaUtility.h"
+#include "logging.h"
+
+#include <string.h>
+
+
+// constructor
+shmOutput::shmOutput( const videoOptions& options ) : videoOutput(options)
+{
+	mRing       = NULL;
+	mRegistered = false;
+	mHostMemory = false;
+
+	if( mOptions.numBuffers < 3 )
+		mOptions.numBuffers = 3;
+
+	// without a GPU, frames are copied into the ring with the CPU
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+shmOutput::~shmOutput()
+{
+	Close();
+}
+
+
+// Create
+shmOutput* shmOutput::Create( const videoOptions& options )
+{
+	if( options.resource.location.size() == 0 )
+	{
+		LogError(LOG_VIDEO "shmOutput -- the name of the shared memory stream was empty (expected shm://name)\n");
+		return NULL;
+	}
+
+	return new shmOutput(options);
+}
+
+
+// Create
+shmOutput* shmOutput::Create( const char* resource, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = resource;
+	return Create(opt);
+}
+
+
+// createRing
+bool shmOutput::createRing( uint32_t size )
+{
+	mRing = shmRing::Create(mOptions.resource.location.c_str(), mOptions.numBuffers, size);
+
+	if( !mRing )
+		return false;
+
+	// pin the mapping so copies from the GPU can use DMA
+	if( !mHostMemory )
+	{
+		if( cudaHostRegister(mRing->GetMapping(), mRing->GetMappingSize(), cudaHostRegisterDefault) == cudaSuccess )
+			mRegistered = true;
+		else
+			LogWarning(LOG_VIDEO "shmOutput -- failed to register shared memory with CUDA, copies will be slower\n");
+
+		cudaGetLastError();	// clear any errors
+	}
+
+	return true;
+}
+
+
+// destroyRing
+void shmOutput::destroyRing()
+{
+	if( !mRing )
+		return;
+
+	if( mRegistered )
+	{
+		CUDA(cudaHostUnregister(mRing->GetMapping()));
+		mRegistered = false;
+	}
+
+	delete mRing;
+	mRing = NULL;
+}
+
+
+// Render
+bool shmOutput::Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream )
+{
+	if( !image || width == 0 || height == 0 )
+		return false;
+
+	const bool substreams_success = videoOutput::Render(image, width, height, format, stream);
+
+	if( !mStreaming && !Open() )
+		return false;
+
+	const size_t size = imageFormatSize(format, width, height);
+
+	if( !mRing && !createRing(size) )
+		return false;
+
+	if( size > mRing->GetSlotSize() )
+	{
+		LogError(LOG_VIDEO "shmOutput -- %ux%u %s frame (%zu bytes) is larger than the ring was created for (%u bytes)\n", width, height, imageFormatToStr(format), size, mRing->GetSlotSize());
+		return false;
+	}
+
+	// copy the frame into the next slot and publish it
+	void* slot = mRing->Acquire();
+
+	if( mHostMemory )
+	{
+		memcpy(slot, image, size);
+	}
+	else
+	{
+		if( CUDA_FAILED(cudaMemcpyAsync(slot, image, size, cudaMemcpyDefault, stream)) )
+			return false;
+
+		if( CUDA_FAILED(cudaStreamSynchronize(stream)) )
+			return false;
+	}
+
+	mRing->Publish(width, height, format, size);
+
+	mOptions.width  = width;
+	mOptions.height = height;
+
+	return substreams_success;
+}
+
+
+// Open
+bool shmOutput::Open()
+{
+	mStreaming = true;
+	return true;
+}
+
+
+// Close
+void shmOutput::Close()
+{
+	destroyRing();
+	mStreaming = false;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SHM_OUTPUT_H_
+#define __SHM_OUTPUT_H_
+
+
+#include "videoOutput.h"
+#include "shmRing.h"
+
+
+/**
+ * Publish frames into a shared memory ring (`shm://name`) that any number
+ * of other processes can read from with shmSource, without re-encoding.
+ *
+ * The ring is created on the first call to Render(), and sized for that
+ * frame - later frames can change format or resolution, as long as they
+ * aren't any larger.  The number of frames in the ring is set by the
+ * `--num-buffers` option (with a minimum of 3).  Readers that are too
+ * slow simply skip frames, so the writer is never blocked by them.
+ *
+ * Only one process can write to a ring at a time.  Closing or deleting
+ * the shmOutput signals End Of Stream (EOS) to the readers.
+ *
+ * @note shmOutput implements the videoOutput interface and is intended to
+ * be used through that as opposed to directly.  videoOutput implements
+ * additional command-line parsing of videoOptions to construct instances.
+ *
+ * @see shmSource
+ * @see videoOutput
+ * @ingroup video
+ */
+class shmOutput : public videoOutput
+{
+public:
+	/**
+	 * Create an shmOutput instance from the provided video options.
+	 */
+	static shmOutput* Create( const videoOptions& options );
+
+	/**
+	 * Create an shmOutput instance from a shm:// URI and optional videoOptions.
+	 */
+	static shmOutput* Create( const char* resource, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~shmOutput();
+
+	/**
+	 * Publish the next frame.
+	 * @see videoOutput::Render()
+	 */
+	template<typename T> bool Render( T* image, uint32_t width, uint32_t height, cudaStream_t stream=0 )		{ return Render((void**)image, width, height, imageFormatFromType<T>(), stream); }
+
+	/**
+	 * Publish the next frame.
+	 * @see videoOutput::Render()
+	 */
+	virtual bool Render( void* image, uint32_t width, uint32_t height, imageFormat format, cudaStream_t stream=0 );
+
+	/**
+	 * Open the stream.
+	 * @see videoOutput::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * Close the stream, which signals EOS to the readers.
+	 * @see videoOutput::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the number of reader processes attached to the ring.
+	 */
+	inline uint32_t GetNumReaders() const			{ return mRing != NULL ? mRing->GetNumReaders() : 0; }
+
+	/**
+	 * Return the interface type (shmOutput::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of shmOutput class.
+	 */
+	static const uint32_t Type = (1 << 7);
+
+protected:
+	shmOutput( const videoOptions& options );
+
+	bool createRing( uint32_t size );
+	void destroyRing();
+
+	shmRing* mRing;
+	bool     mRegistered;
+	bool     mHostMemory;
+};
+
+#endif
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "shmRing.h"
+#include "videoOptions.h"
+#include "Process.h"
+
+#include "timespec.h"
+#include "logging.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// readers wake up at least this often to check if the writer is still alive
+#define SHM_POLL_INTERVAL 100
+
+
+// shm_open() names need a leading slash, and can't contain any others
+static std::string shmPath( const char* name )
+{
+	std::string path = name;
+
+	while( path.size() > 0 && path[0] == '/' )
+		path.erase(0, 1);
+
+	for( size_t n=0; n < path.size(); n++ )
+	{
+		if( path[n] == '/' )
+			path[n] = '_';
+	}
+
+	return "/" + path;
+}
+
+
+// round up to a multiple of the alignment
+static inline size_t alignUp( size_t size, size_t alignment )
+{
+	return ((size + alignment - 1) / alignment) * alignment;
+}
+
+
+// futexWake
+static inline void futexWake( uint32_t* addr )
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
+// futexWait
+static inline void futexWait( uint32_t* addr, uint32_t value, uint64_t timeout )
+{
+	const timespec duration = timeNew(0, timeout * 1000 * 1000);
+	syscall(SYS_futex, addr, FUTEX_WAIT, value, &duration, NULL, 0);
+}
+
+
+// constructor
+shmRing::shmRing()
+{
+	mHeader   = NULL;
+	mWriter   = false;
+	mSequence = 0;
+}
+
+
+// destructor
+shmRing::~shmRing()
+{
+	if( !mHeader )
+		return;
+
+	if( mWriter )
+	{
+		__atomic_store_n(&mHeader->closed, 1, __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&mHeader->futex, 1, __ATOMIC_SEQ_CST);
+		futexWake(&mHeader->futex);
+
+		shm_unlink(mName.c_str());
+	}
+	else
+	{
+		__atomic_sub_fetch(&mHeader->readers, 1, __ATOMIC_RELAXED);
+	}
+
+	munmap(mHeader, mHeader->mappingSize);
+	mHeader = NULL;
+}
+
+
+// Create
+shmRing* shmRing::Create( const char* name, uint32_t numSlots, uint32_t slotSize )
+{
+	if( !name || numSlots == 0 || slotSize == 0 )
+		return NULL;
+
+	const std::string path = shmPath(name);
+
+	// compute the layout of the segment (the pixels of each slot are page-aligned)
+	const size_t pageSize   = sysconf(_SC_PAGESIZE);
+	const size_t dataOffset = alignUp(sizeof(shmHeader) + numSlots * sizeof(shmSlot), pageSize);
+	const size_t dataStride = alignUp(slotSize, pageSize);
+	const size_t size       = dataOffset + dataStride * numSlots;
+
+	int fd = shm_open(path.c_str(), O_RDWR|O_CREAT|O_EXCL, 0666);
+
+	if( fd < 0 && errno == EEXIST )
+	{
+		// a ring with this name exists - replace it if the old writer is gone
+		shmRing* existing = Open(name);
+
+		if( existing != NULL && !existing->IsClosed() )
+		{
+			LogError(LOG_VIDEO "shmRing -- '%s' is already being written by process %i\n", path.c_str(), existing->mHeader->writerPID);
+			delete existing;
+			return NULL;
+		}
+
+		delete existing;
+		LogVerbose(LOG_VIDEO "shmRing -- replacing stale shared memory segment '%s'\n", path.c_str());
+
+		shm_unlink(path.c_str());
+		fd = shm_open(path.c_str(), O_RDWR|O_CREAT|O_EXCL, 0666);
+	}
+
+	if( fd < 0 )
+	{
+		LogError(LOG_VIDEO "shmRing -- failed to create shared memory segment '%s' (%s)\n", path.c_str(), strerror(errno));
+		return NULL;
+	}
+
+	if( ftruncate(fd, size) != 0 )
+	{
+		LogError(LOG_VIDEO "shmRing -- failed to allocate %zu bytes for '%s' (%s)\n", size, path.c_str(), strerror(errno));
+		close(fd);
+		shm_unlink(path.c_str());
+		return NULL;
+	}
+
+	void* mapping = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if( mapping == MAP_FAILED )
+	{
+		LogError(LOG_VIDEO "shmRing -- failed to map shared memory segment '%s' (%s)\n", path.c_str(), strerror(errno));
+		shm_unlink(path.c_str());
+		return NULL;
+	}
+
+	// initialize the header (the magic number is set last, once it's valid)
+	shmHeader* header = (shmHeader*)mapping;
+
+	header->version     = SHM_RING_VERSION;
+	header->numSlots    = numSlots;
+	header->slotSize    = slotSize;
+	header->mappingSize = size;
+	header->writerPID   = Process::GetID();
+
+	shmSlot* slots = (shmSlot*)(header + 1);
+
+	for( uint32_t n=0; n < numSlots; n++ )
+		slots[n].offset = dataOffset + dataStride * n;
+
+	__atomic_store_n(&header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+	shmRing* ring = new shmRing();
+
+	ring->mHeader = header;
+	ring->mName   = path;
+	ring->mWriter = true;
+
+	LogVerbose(LOG_VIDEO "shmRing -- created '%s' (%u slots, %u bytes per slot)\n", path.c_str(), numSlots, slotSize);
+	return ring;
+}
+
+
+// Open
+shmRing* shmRing::Open( const char* name )
+{
+	if( !name )
+		return NULL;
+
+	const std::string path = shmPath(name);
+	const int fd = shm_open(path.c_str(), O_RDWR, 0);
+
+	if( fd < 0 )
+	{
+		if( errno != ENOENT )
+			LogError(LOG_VIDEO "shmRing -- failed to open shared memory segment '%s' (%s)\n", path.c_str(), strerror(errno));
+
+		return NULL;
+	}
+
+	struct stat info;
+
+	if( fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(shmHeader) )
+	{
+		close(fd);
+		return NULL;	// the writer is still initializing it
+	}
+
+	void* mapping = mmap(NULL, info.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if( mapping == MAP_FAILED )
+	{
+		LogError(LOG_VIDEO "shmRing -- failed to map shared memory segment '%s' (%s)\n", path.c_str(), strerror(errno));
+		return NULL;
+	}
+
+	shmHeader* header = (shmHeader*)mapping;
+
+	if( __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC || header->mappingSize != (uint64_t)info.st_size )
+	{
+		munmap(mapping, info.st_size);
+		return NULL;
+	}
+
+	if( header->version != SHM_RING_VERSION )
+	{
+		LogError(LOG_VIDEO "shmRing -- '%s' has version %u (expected version %u)\n", path.c_str(), header->version, SHM_RING_VERSION);
+		munmap(mapping, info.st_size);
+		return NULL;
+	}
+
+	__atomic_add_fetch(&header->readers, 1, __ATOMIC_RELAXED);
+
+	shmRing* ring = new shmRing();
+
+	ring->mHeader = header;
+	ring->mName   = path;
+	ring->mWriter = false;
+
+	return ring;
+}
+
+
+// slot
+shmSlot* shmRing::slot( uint64_t sequence ) const
+{
+	return ((shmSlot*)(mHeader + 1)) + (sequence % mHeader->numSlots);
+}
+
+
+// Acquire
+void* shmRing::Acquire()
+{
+	shmSlot* next = slot(mSequence + 1);
+
+	// invalidate the slot before its pixels start changing
+	__atomic_store_n(&next->sequence, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	return GetData(next);
+}
+
+
+// Publish
+uint64_t shmRing::Publish( uint32_t width, uint32_t height, imageFormat format, uint32_t size )
+{
+	const uint64_t sequence = ++mSequence;
+	const timespec time = timestamp();
+
+	shmSlot* next = slot(sequence);
+
+	next->timestamp = (uint64_t)time.tv_sec * uint64_t(1000000000) + (uint64_t)time.tv_nsec;
+	next->size      = size;
+	next->width     = width;
+	next->height    = height;
+	next->format    = format;
+
+	__atomic_store_n(&next->sequence, sequence, __ATOMIC_RELEASE);
+	__atomic_store_n(&mHeader->sequence, sequence, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&mHeader->futex, 1, __ATOMIC_SEQ_CST);
+
+	// only make the syscall if a reader is blocked
+	if( __atomic_load_n(&mHeader->waiters, __ATOMIC_SEQ_CST) > 0 )
+		futexWake(&mHeader->futex);
+
+	return sequence;
+}
+
+
+// Wait
+uint64_t shmRing::Wait( uint64_t sequence, uint64_t timeout )
+{
+	const timespec start = timestamp();
+
+	while( true )
+	{
+		const uint64_t latest = GetSequence();
+
+		if( latest > sequence )
+			return latest;
+
+		if( IsClosed() )
+			return 0;
+
+		uint64_t interval = SHM_POLL_INTERVAL;
+
+		if( timeout != UINT64_MAX )
+		{
+			const uint64_t elapsed = timeFloat(timeDiff(start, timestamp()));
+
+			if( elapsed >= timeout )
+				return 0;
+
+			if( timeout - elapsed < interval )
+				interval = timeout - elapsed;
+		}
+
+		// register as a waiter before sampling the futex, so the writer can't miss us
+		__atomic_add_fetch(&mHeader->waiters, 1, __ATOMIC_SEQ_CST);
+
+		const uint32_t value = __atomic_load_n(&mHeader->futex, __ATOMIC_SEQ_CST);
+
+		if( GetSequence() <= sequence )
+			futexWait(&mHeader->futex, value, interval);
+
+		__atomic_sub_fetch(&mHeader->waiters, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+
+// GetSlot
+const shmSlot* shmRing::GetSlot( uint64_t sequence ) const
+{
+	const shmSlot* s = slot(sequence);
+
+	if( __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE) != sequence )
+		return NULL;
+
+	return s;
+}
+
+
+// Validate
+bool shmRing::Validate( const shmSlot* s, uint64_t sequence ) const
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return (__atomic_load_n(&s->sequence, __ATOMIC_RELAXED) == sequence);
+}
+
+
+// GetSequence
+uint64_t shmRing::GetSequence() const
+{
+	return __atomic_load_n(&mHeader->sequence, __ATOMIC_SEQ_CST);
+}
+
+
+// IsClosed
+bool shmRing::IsClosed() const
+{
+	if( __atomic_load_n(&mHeader->closed, __ATOMIC_SEQ_CST) != 0 )
+		return true;
+
+	if( !mWriter && !Process::IsRunning(mHeader->writerPID) )
+		return true;	// the writer exited without closing the ring
+
+	return false;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SHM_RING_H_
+#define __SHM_RING_H_
+
+
+#include "imageFormat.h"
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+
+
+/**
+ * Metadata of a frame in the shared memory ring.
+ * @ingroup video
+ */
+struct shmSlot
+{
+	uint64_t sequence;		/**< Frame number (starting at 1), or 0 while the slot is being written */
+	uint64_t timestamp;		/**< Realtime clock when the frame was published (in nanoseconds) */
+	uint64_t offset;		/**< Offset of the pixels from the start of the mapping (in bytes) */
+	uint32_t size;			/**< Size of the pixels (in bytes) */
+	uint32_t width;		/**< Width of the frame (in pixels) */
+	uint32_t height;		/**< Height of the frame (in pixels) */
+	uint32_t format;		/**< imageFormat of the frame */
+};
+
+
+/**
+ * Layout of the shared memory segment, which is followed by the array
+ * of slots and then the page-aligned pixel data of each slot.
+ * @ingroup video
+ */
+struct shmHeader
+{
+	uint32_t magic;		/**< SHM_RING_MAGIC */
+	uint32_t version;		/**< SHM_RING_VERSION */
+	uint32_t numSlots;		/**< Number of frames in the ring */
+	uint32_t slotSize;		/**< Maximum size of each frame (in bytes) */
+	uint64_t mappingSize;	/**< Total size of the segment (in bytes) */
+	int32_t  writerPID;		/**< Process ID of the writer */
+	uint32_t closed;		/**< Set to 1 when the writer has closed the stream */
+	uint32_t futex;		/**< Incremented each time a frame is published (readers wait on it) */
+	uint32_t waiters;		/**< Number of readers currently blocked on the futex */
+	uint32_t readers;		/**< Number of readers attached to the ring */
+	uint32_t reserved;
+	uint64_t sequence;		/**< Sequence number of the latest published frame */
+};
+
+#define SHM_RING_MAGIC    0x4D48534A	/**< 'JSHM' */
+#define SHM_RING_VERSION  1
+
+
+/**
+ * Ring of video frames in POSIX shared memory, with one writer process
+ * and any number of reader processes.  This is used by shmOutput and
+ * shmSource to implement the `shm://` protocol.
+ *
+ * Each slot has its own sequence number that acts like a seqlock - the
+ * writer zeroes it before overwriting the pixels and sets it once the new
+ * frame is complete, so readers can detect if a frame changed underneath
+ * them.  The writer never waits on readers, and readers that fall behind
+ * skip ahead to the latest frame.  Readers sleep on a futex in the header
+ * until the next frame is published (or the writer closes the stream).
+ *
+ * The segment is named `/dev/shm/<name>`.  If the writer exits without
+ * closing the ring, readers detect that its process is gone, and the next
+ * writer with the same name will replace the stale segment.
+ *
+ * @ingroup video
+ */
+class shmRing
+{
+public:
+	/**
+	 * Create a new ring as the writer.  This fails if another writer
+	 * process is already publishing to a ring with the same name.
+	 */
+	static shmRing* Create( const char* name, uint32_t numSlots, uint32_t slotSize );
+
+	/**
+	 * Attach to an existing ring as a reader.  Returns NULL (without
+	 * logging an error) if the ring doesn't exist yet.
+	 */
+	static shmRing* Open( const char* name );
+
+	/**
+	 * Detach from the ring.  If this is the writer, the ring gets closed
+	 * (waking up any readers) and the name is unlinked.
+	 */
+	~shmRing();
+
+	/**
+	 * Begin writing the next frame, returning a pointer to the slot's
+	 * pixels (which are at least GetSlotSize() bytes).  The slot stays
+	 * invalid to readers until Publish() is called.
+	 */
+	void* Acquire();
+
+	/**
+	 * Publish the frame that was written since Acquire(), and wake up
+	 * the readers.  Returns the sequence number of the frame.
+	 */
+	uint64_t Publish( uint32_t width, uint32_t height, imageFormat format, uint32_t size );
+
+	/**
+	 * Wait until a frame newer than `sequence` is published.
+	 * Returns the sequence number of the latest frame, or 0 if the timeout
+	 * (in milliseconds) expired or the writer is gone (check IsClosed()).
+	 */
+	uint64_t Wait( uint64_t sequence, uint64_t timeout );
+
+	/**
+	 * Look up the slot holding a frame.  If the frame was already overwritten
+	 * (or is being overwritten), NULL is returned.
+	 */
+	const shmSlot* GetSlot( uint64_t sequence ) const;
+
+	/**
+	 * Return true if the frame is still intact after being read (i.e. the
+	 * writer hasn't started overwriting its slot since GetSlot() was called).
+	 */
+	bool Validate( const shmSlot* slot, uint64_t sequence ) const;
+
+	/**
+	 * Return a pointer to the pixels of a slot.
+	 */
+	inline void* GetData( const shmSlot* slot ) const		{ return (uint8_t*)mHeader + slot->offset; }
+
+	/**
+	 * Return true if the writer closed the ring or its process has exited.
+	 */
+	bool IsClosed() const;
+
+	/**
+	 * Return true if this instance is the writer.
+	 */
+	inline bool IsWriter() const					{ return mWriter; }
+
+	/**
+	 * Return the sequence number of the latest frame (or 0 if none yet).
+	 */
+	uint64_t GetSequence() const;
+
+	/**
+	 * Return the number of frames in the ring.
+	 */
+	inline uint32_t GetNumSlots() const			{ return mHeader->numSlots; }
+
+	/**
+	 * Return the maximum size of a frame (in bytes).
+	 */
+	inline uint32_t GetSlotSize() const			{ return mHeader->slotSize; }
+
+	/**
+	 * Return the number of readers that are attached.
+	 */
+	inline uint32_t GetNumReaders() const			{ return __atomic_load_n(&mHeader->readers, __ATOMIC_RELAXED); }
+
+	/**
+	 * Return the base address and size of the mapping (for registering with CUDA).
+	 */
+	inline void* GetMapping() const				{ return mHeader; }
+	inline size_t GetMappingSize() const			{ return mHeader->mappingSize; }
+
+	/**
+	 * Return the name of the ring.
+	 */
+	inline const char* GetName() const				{ return mName.c_str(); }
+
+protected:
+	shmRing();
+
+	shmSlot* slot( uint64_t sequence ) const;
+
+	shmHeader*  mHeader;
+	std::string mName;
+	bool        mWriter;
+	uint64_t    mSequence;
+};
+
+#endif
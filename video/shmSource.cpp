@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "shmSource.h"
+
+#include "cudaMappedMemory.h"
+#include "cudaColorspace.h"
+
+#include "timespec.h"
+#include "logging.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// how often to check if the writer has created the ring yet (in milliseconds)
+#define SHM_ATTACH_INTERVAL 10
+
+
+// constructor
+shmSource::shmSource( const videoOptions& options ) : videoSource(options)
+{
+	mRing          = NULL;
+	mDeviceMapping = NULL;
+	mRegistered    = false;
+	mHostMemory    = false;
+	mCopy          = false;
+	mEOS           = false;
+	mSequence      = 0;
+	mDroppedFrames = 0;
+	mBufferFormat  = IMAGE_UNKNOWN;
+	mBufferSize    = 0;
+	mNextBuffer    = 0;
+
+	if( mOptions.numBuffers == 0 )
+		mOptions.numBuffers = 1;
+
+	// parse the name and options from the URI (shm://name?copy=1)
+	const std::string& location = mOptions.resource.location;
+	const size_t query = location.find('?');
+
+	mName = location.substr(0, query);
+
+	if( query != std::string::npos )
+	{
+		const std::string params = location.substr(query + 1);
+
+		if( params == "copy" || params == "copy=1" )
+			mCopy = true;
+		else if( params != "copy=0" )
+			LogWarning(LOG_VIDEO "shmSource -- ignoring unknown options '%s'\n", params.c_str());
+	}
+
+	// without a GPU, frames are accessed from the CPU
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+shmSource::~shmSource()
+{
+	Close();
+	freeBuffers();
+}
+
+
+// Create
+shmSource* shmSource::Create( const videoOptions& options )
+{
+	shmSource* src = new shmSource(options);
+
+	if( src->mName.size() == 0 )
+	{
+		LogError(LOG_VIDEO "shmSource -- the name of the shared memory stream was empty (expected shm://name)\n");
+		delete src;
+		return NULL;
+	}
+
+	return src;
+}
+
+
+// Create
+shmSource* shmSource::Create( const char* resource, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = resource;
+	return Create(opt);
+}
+
+
+// attach
+bool shmSource::attach( uint64_t timeout )
+{
+	const timespec start = timestamp();
+
+	while( !mRing )
+	{
+		mRing = shmRing::Open(mName.c_str());
+
+		// a closed ring is left over from a writer that's gone, so wait for a new one
+		if( mRing != NULL && mRing->IsClosed() )
+		{
+			delete mRing;
+			mRing = NULL;
+		}
+
+		if( mRing != NULL )
+			break;
+
+		if( timeout != UINT64_MAX && timeFloat(timeDiff(start, timestamp())) >= timeout )
+			return false;
+
+		sleepMs(SHM_ATTACH_INTERVAL);
+	}
+
+	// map the ring into the GPU's address space for zero-copy access
+	if( mHostMemory )
+	{
+		mDeviceMapping = (uint8_t*)mRing->GetMapping();
+	}
+	else
+	{
+		void* devicePtr = NULL;
+
+		if( cudaHostRegister(mRing->GetMapping(), mRing->GetMappingSize(), cudaHostRegisterMapped) == cudaSuccess )
+		{
+			mRegistered = true;
+
+			if( cudaHostGetDevicePointer(&devicePtr, mRing->GetMapping(), 0) != cudaSuccess )
+				devicePtr = NULL;
+		}
+
+		cudaGetLastError();	// clear any errors
+
+		if( devicePtr != NULL )
+		{
+			mDeviceMapping = (uint8_t*)devicePtr;
+		}
+		else
+		{
+			LogError(LOG_VIDEO "shmSource -- failed to map shared memory stream '%s' into GPU address space\n", mName.c_str());
+			Close();
+			return false;
+		}
+	}
+
+	mSequence = 0;
+
+	LogVerbose(LOG_VIDEO "shmSource -- attached to '%s' (%u slots, %u bytes per slot)\n", mRing->GetName(), mRing->GetNumSlots(), mRing->GetSlotSize());
+	return true;
+}
+
+
+// allocBuffers
+bool shmSource::allocBuffers( imageFormat format, uint32_t width, uint32_t height )
+{
+	const size_t size = imageFormatSize(format, width, height);
+
+	if( format == mBufferFormat && size <= mBufferSize && mBuffers.size() > 0 )
+		return true;
+
+	freeBuffers();
+
+	for( uint32_t n=0; n < mOptions.numBuffers; n++ )
+	{
+		void* ptr = NULL;
+
+		if( mHostMemory )
+			ptr = malloc(size);
+		else if( !cudaAllocMapped(&ptr, size) )
+			ptr = NULL;
+
+		if( !ptr )
+		{
+			LogError(LOG_VIDEO "shmSource -- failed to allocate %zu bytes for %ux%u %s frame\n", size, width, height, imageFormatToStr(format));
+			return false;
+		}
+
+		mBuffers.push_back(ptr);
+	}
+
+	mBufferFormat = format;
+	mBufferSize = size;
+	mNextBuffer = 0;
+
+	return true;
+}
+
+
+// freeBuffers
+void shmSource::freeBuffers()
+{
+	const size_t numBuffers = mBuffers.size();
+
+	for( size_t n=0; n < numBuffers; n++ )
+	{
+		if( mHostMemory )
+			free(mBuffers[n]);
+		else
+			CUDA(cudaFreeHost(mBuffers[n]));
+	}
+
+	mBuffers.clear();
+	mBufferFormat = IMAGE_UNKNOWN;
+	mBufferSize = 0;
+}
+
+
+#define RETURN_STATUS(code)  { if( status != NULL ) { *status=(code); } return ((code) == videoSource::OK ? true : false); }
+
+
+// Capture
+bool shmSource::Capture( void** output, imageFormat format, uint64_t timeout, int* status, cudaStream_t stream )
+{
+	// verify the output pointer exists
+	if( !output )
+		RETURN_STATUS(ERROR);
+
+	// confirm the stream is open
+	if( !mStreaming )
+	{
+		if( !Open() )
+			RETURN_STATUS(EOS);
+	}
+
+	// wait for the writer to create the ring
+	if( !mRing && !attach(timeout) )
+		RETURN_STATUS(TIMEOUT);
+
+	while( true )
+	{
+		const uint64_t sequence = mRing->Wait(mSequence, timeout);
+
+		if( sequence == 0 )
+		{
+			if( mRing->IsClosed() )
+			{
+				LogVerbose(LOG_VIDEO "shmSource -- the writer of '%s' has closed the stream (EOS)\n", mName.c_str());
+				mEOS = true;
+				Close();
+				RETURN_STATUS(EOS);
+			}
+
+			RETURN_STATUS(TIMEOUT);
+		}
+
+		// skip ahead to the latest frame
+		if( mSequence > 0 && sequence > mSequence + 1 )
+			mDroppedFrames += sequence - mSequence - 1;
+
+		mSequence = sequence;
+
+		const shmSlot* slot = mRing->GetSlot(sequence);
+
+		if( !slot )
+		{
+			mDroppedFrames++;	// it was already overwritten
+			continue;
+		}
+
+		const imageFormat frameFormat = (imageFormat)slot->format;
+		const uint32_t frameWidth  = slot->width;
+		const uint32_t frameHeight = slot->height;
+		const uint32_t frameSize   = slot->size;
+		const uint64_t frameTime   = slot->timestamp;
+
+		void* frame = mDeviceMapping + slot->offset;
+
+		if( format == IMAGE_UNKNOWN )
+			format = frameFormat;
+
+		if( format == frameFormat && !mCopy )
+		{
+			// return the frame in-place
+			if( !mRing->Validate(slot, sequence) )
+			{
+				mDroppedFrames++;
+				continue;
+			}
+
+			*output = frame;
+		}
+		else
+		{
+			// copy (or convert) the frame out of the ring
+			if( !allocBuffers(format, frameWidth, frameHeight) )
+				RETURN_STATUS(ERROR);
+
+			void* buffer = mBuffers[mNextBuffer];
+
+			if( format == frameFormat )
+			{
+				if( mHostMemory )
+					memcpy(buffer, frame, frameSize);
+				else if( CUDA_FAILED(cudaMemcpyAsync(buffer, frame, frameSize, cudaMemcpyDeviceToDevice, stream)) )
+					RETURN_STATUS(ERROR);
+			}
+			else
+			{
+				const cudaImageView input(frame, frameWidth, frameHeight, frameFormat);
+				const cudaImageView converted(buffer, frameWidth, frameHeight, format);
+
+				if( mHostMemory )
+				{
+					if( !cudaConvertColorCPU(input, converted) )
+						RETURN_STATUS(ERROR);
+				}
+				else if( CUDA_FAILED(cudaConvertColor(input, converted, make_float2(0,255), stream)) )
+				{
+					RETURN_STATUS(ERROR);
+				}
+			}
+
+			if( !mHostMemory && CUDA_FAILED(cudaStreamSynchronize(stream)) )
+				RETURN_STATUS(ERROR);
+
+			// make sure the writer didn't overwrite it while it was being copied
+			if( !mRing->Validate(slot, sequence) )
+			{
+				mDroppedFrames++;
+				continue;
+			}
+
+			mNextBuffer = (mNextBuffer + 1) % mBuffers.size();
+			*output = buffer;
+		}
+
+		mLastTimestamp = frameTime;
+		mRawFormat = frameFormat;
+
+		mOptions.width  = frameWidth;
+		mOptions.height = frameHeight;
+		mOptions.frameCount++;
+
+		RETURN_STATUS(OK);
+	}
+}
+
+
+// Open
+bool shmSource::Open()
+{
+	if( mEOS )
+	{
+		LogWarning(LOG_VIDEO "shmSource -- End of Stream (EOS) has been reached, stream has been closed\n");
+		return false;
+	}
+
+	if( !mRing )
+		attach(0);
+
+	mStreaming = true;
+	return true;
+}
+
+
+// Close
+void shmSource::Close()
+{
+	if( mRing != NULL )
+	{
+		LogVerbose(LOG_VIDEO "shmSource -- received %llu frames from '%s' (%llu dropped)\n", (unsigned long long)mOptions.frameCount, mName.c_str(), (unsigned long long)mDroppedFrames);
+
+		if( mRegistered )
+		{
+			CUDA(cudaHostUnregister(mRing->GetMapping()));
+			mRegistered = false;
+		}
+
+		delete mRing;
+
+		mRing = NULL;
+		mDeviceMapping = NULL;
+	}
+
+	mStreaming = false;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SHM_SOURCE_H_
+#define __SHM_SOURCE_H_
+
+
+#include "videoSource.h"
+#include "shmRing.h"
+
+#include <vector>
+
+
+/**
+ * Receive frames from another process that is publishing them to a
+ * shared memory ring with shmOutput (`shm://name`).
+ *
+ * By default, Capture() returns a pointer directly into the shared memory
+ * (which is mapped into the GPU's address space), so no copies are made.
+ * The frame remains valid until the writer wraps around the ring, which
+ * takes `--num-buffers - 1` frames on the writer's side.  If you need to
+ * hold onto frames for longer, append `?copy=1` to the URI to have them
+ * copied out of the ring into buffers owned by the shmSource.  Frames are
+ * also copied when Capture() requests a different format than the writer
+ * published, in order to convert them.
+ *
+ * Capture() always returns the latest frame - if the reader falls behind,
+ * the older frames are skipped and counted by GetDroppedFrames().  The
+ * writer doesn't need to exist yet when the shmSource is created (Capture()
+ * will time out until it does), and End Of Stream (EOS) is returned once
+ * the writer closes the ring or its process exits.
+ *
+ * GetLastTimestamp() returns the realtime clock (in nanoseconds) at which
+ * the frame was published, for measuring the latency between processes.
+ *
+ * @note shmSource implements the videoSource interface and is intended to
+ * be used through that as opposed to directly.  videoSource implements
+ * additional command-line parsing of videoOptions to construct instances.
+ *
+ * @see shmOutput
+ * @see videoSource
+ * @ingroup video
+ */
+class shmSource : public videoSource
+{
+public:
+	/**
+	 * Create an shmSource instance from the provided video options.
+	 */
+	static shmSource* Create( const videoOptions& options );
+
+	/**
+	 * Create an shmSource instance from a shm:// URI and optional videoOptions.
+	 */
+	static shmSource* Create( const char* resource, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~shmSource();
+
+	/**
+	 * Receive the latest frame.
+	 * @see videoSource::Capture()
+	 */
+	virtual bool Capture( void** image, imageFormat format, uint64_t timeout=DEFAULT_TIMEOUT, int* status=NULL, cudaStream_t stream=0 );
+
+	/**
+	 * Attach to the ring (if the writer has created it yet).
+	 * @see videoSource::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * Detach from the ring.
+	 * @see videoSource::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the number of frames that were skipped because the reader
+	 * fell behind the writer.
+	 */
+	inline uint64_t GetDroppedFrames() const		{ return mDroppedFrames; }
+
+	/**
+	 * Return true if End Of Stream (EOS) has been reached.
+	 */
+	inline bool IsEOS() const				{ return mEOS; }
+
+	/**
+	 * Return the interface type (shmSource::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of shmSource class.
+	 */
+	static const uint32_t Type = (1 << 8);
+
+protected:
+	shmSource( const videoOptions& options );
+
+	bool attach( uint64_t timeout );
+	bool allocBuffers( imageFormat format, uint32_t width, uint32_t height );
+	void freeBuffers();
+
+	shmRing* mRing;
+	uint8_t* mDeviceMapping;
+	bool     mRegistered;
+	bool     mHostMemory;
+	bool     mCopy;
+	bool     mEOS;
+
+	std::string mName;
+	uint64_t    mSequence;
+	uint64_t    mDroppedFrames;
+
+	std::vector<void*> mBuffers;
+	imageFormat mBufferFormat;
+	size_t      mBufferSize;
+	uint32_t    mNextBuffer;
+};
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "videoSource.h"
 #include "videoOutput.h"
+#include "MetricsServer.h"
 
 #include "logging.h"
 #include "commandLine.h"
@@ -42,12 +43,14 @@ void sig_handler(int signo)
 
 int usage()
 {
-	printf("usage: video-viewer [--help] input_URI [output_URI]\n\n");
+	printf("usage: video-viewer [--help] [--metrics-port=PORT] input_URI [output_URI]\n\n");
 	printf("View/output a video or image stream.\n");
 	printf("See below for additional arguments that may not be shown above.\n\n");
 	printf("positional arguments:\n");
 	printf("    input_URI       resource URI of input stream  (see videoSource below)\n");
 	printf("    output_URI      resource URI of output stream (see videoOutput below)\n\n");
+	printf("optional arguments:\n");
+	printf("  --metrics-port=PORT  serve Prometheus metrics from http://0.0.0.0:PORT/metrics\n\n");
 
 	printf("%s", videoSource::Usage());
 	printf("%s", videoOutput::Usage());
@@ -74,6 +77,15 @@ int main( int argc, char** argv )
 		LogError("can't catch SIGINT\n");
 
 
+	/*
+	 * start the metrics server
+	 */
+	MetricsServer* metrics = NULL;
+
+	if( cmdLine.GetInt("metrics-port") > 0 )
+		metrics = MetricsServer::Create(cmdLine.GetInt("metrics-port"));
+
+
 	/*
 	 * create input video stream
 	 */
@@ -145,6 +157,9 @@ int main( int argc, char** argv )
 	SAFE_DELETE(input);
 	SAFE_DELETE(output);
 
+	if( metrics != NULL )
+		metrics->Release();
+
 	printf("video-viewer:  shutdown complete\n");
 }
 
@@ -35,15 +35,22 @@ videoOptions::videoOptions()
 	frameRate   = 0;
 	frameCount  = 0;
 	bitRate     = 0;
+	minBitRate  = 0;
 	numBuffers  = 4;
 	loop        = 0;
+	stride      = 1;
+	keyframesOnly = false;
 	latency     = 10;
+	threads     = 0;
+	queueDepth  = 8;
+	queuePolicy = QUEUE_DEFAULT;
 	zeroCopy    = true;
 	ioType      = INPUT;
 	deviceType  = DEVICE_DEFAULT;
 	flipMethod  = FLIP_DEFAULT;
 	codec       = CODEC_UNKNOWN;
 	codecType   = gst_default_codec();
+	discovery   = DISCOVERY_DEFAULT;
 }
 
 
@@ -68,7 +75,7 @@ void videoOptions::Print( const char* prefix ) const
 	if( save.path.length() > 0 )
 		LogInfo("  -- save:       %s\n", save.path.c_str());
 
-	if( deviceType != DEVICE_CSI && deviceType != DEVICE_DISPLAY )
+	if( deviceType != DEVICE_CSI && deviceType != DEVICE_DISPLAY && deviceType != DEVICE_TEST && deviceType != DEVICE_SHM )
 	{
 		LogInfo("  -- codec:      %s\n", CodecToStr(codec));
 		LogInfo("  -- codecType:  %s\n", CodecTypeToStr(codecType));
@@ -83,7 +90,12 @@ void videoOptions::Print( const char* prefix ) const
 	LogInfo("  -- frameRate:  %g\n", frameRate);
 	
 	if( ioType == OUTPUT && (deviceType == DEVICE_IP || deviceType == DEVICE_FILE) )
+	{
 		LogInfo("  -- bitRate:    %u\n", bitRate);
+
+		if( minBitRate > 0 )
+			LogInfo("  -- minBitRate: %u\n", minBitRate);
+	}
 	
 	LogInfo("  -- numBuffers: %u\n", numBuffers);
 	LogInfo("  -- zeroCopy:   %s\n", zeroCopy ? "true" : "false");	
@@ -93,9 +105,26 @@ void videoOptions::Print( const char* prefix ) const
 		LogInfo("  -- flipMethod: %s\n", FlipMethodToStr(flipMethod));
 	
 		if( deviceType != DEVICE_CSI && deviceType != DEVICE_V4L2 )
+		{
 			LogInfo("  -- loop:       %i\n", loop);
+
+			if( stride > 1 )
+				LogInfo("  -- stride:     %u\n", stride);
+
+			if( keyframesOnly )
+				LogInfo("  -- keyframes:  only\n");
+
+			LogInfo("  -- discovery:  %s\n", DiscoveryToStr(discovery));
+		}
 	}
 	
+	if( ioType == OUTPUT && threads > 0 )
+	{
+		LogInfo("  -- threads:    %u\n", threads);
+		LogInfo("  -- queueDepth: %u\n", queueDepth);
+		LogInfo("  -- queuePolicy: %s\n", QueuePolicyToStr(queuePolicy));
+	}
+
 	if( deviceType == DEVICE_IP )
 		LogInfo("  -- latency     %i\n", latency);
 	
@@ -228,14 +257,54 @@ bool videoOptions::Parse( const char* URI, const commandLine& cmdLine, videoOpti
 	if( codecTypeStr != NULL )	
 		codecType = videoOptions::CodecTypeFromStr(codecTypeStr);
 
+	// discovery
+	if( type == INPUT )
+	{
+		const char* discoveryStr = cmdLine.GetString("input-discovery");
+
+		if( discoveryStr != NULL )
+			discovery = videoOptions::DiscoveryFromStr(discoveryStr);
+	}
+
 	// bitrate
 	if( type == OUTPUT )
+	{
 		bitRate = cmdLine.GetUnsignedInt("bitrate", bitRate);
+		minBitRate = cmdLine.GetUnsignedInt("min-bitrate", minBitRate);
+	}
 
 	// loop
 	if( type == INPUT )
 		loop = cmdLine.GetInt("input-loop", cmdLine.GetInt("loop", loop));
 
+	// stride
+	if( type == INPUT )
+	{
+		stride = cmdLine.GetUnsignedInt("input-stride", stride);
+
+		if( stride == 0 )
+			stride = 1;
+	}
+
+	// keyframes only
+	if( type == INPUT && cmdLine.GetFlag("input-keyframes-only") )
+		keyframesOnly = true;
+
+	// asynchronous output
+	if( type == OUTPUT )
+	{
+		threads = cmdLine.GetUnsignedInt("output-threads", threads);
+		queueDepth = cmdLine.GetUnsignedInt("output-queue", queueDepth);
+
+		if( queueDepth == 0 )
+			queueDepth = 1;
+
+		const char* policyStr = cmdLine.GetString("output-queue-policy");
+
+		if( policyStr != NULL )
+			queuePolicy = videoOptions::QueuePolicyFromStr(policyStr);
+	}
+
 	// latency
 	latency = (type == INPUT) ? cmdLine.GetUnsignedInt("input-latency", cmdLine.GetUnsignedInt("input-rtsp-latency", latency))
 						 : cmdLine.GetUnsignedInt("output-latency", latency);
@@ -322,6 +391,8 @@ const char* videoOptions::DeviceTypeToStr( videoOptions::DeviceType type )
 		case DEVICE_IP:		return "ip";
 		case DEVICE_FILE:		return "file";
 		case DEVICE_DISPLAY:	return "display";
+		case DEVICE_TEST:		return "test";
+		case DEVICE_SHM:		return "shm";
 	}
 	return nullptr;
 }
@@ -333,7 +404,7 @@ videoOptions::DeviceType videoOptions::DeviceTypeFromStr( const char* str )
 	if( !str )
 		return DEVICE_DEFAULT;
 
-	for( int n=0; n <= DEVICE_DISPLAY; n++ )
+	for( int n=0; n <= DEVICE_SHM; n++ )
 	{
 		const DeviceType value = (DeviceType)n;
 
@@ -341,7 +412,7 @@ videoOptions::DeviceType videoOptions::DeviceTypeFromStr( const char* str )
 			return value;
 	}
 
-	if( strcasecmp(str, "rtp") == 0 || strcasecmp(str, "rtsp") == 0 || strcasecmp(str, "rtmp") == 0 || strcasecmp(str, "rtpmp2ts") == 0 || strcasecmp(str, "webrtc") == 0 )
+	if( strcasecmp(str, "rtp") == 0 || strcasecmp(str, "rtsp") == 0 || strcasecmp(str, "rtmp") == 0 || strcasecmp(str, "rtpmp2ts") == 0 || strcasecmp(str, "webrtc") == 0 || strcasecmp(str, "http") == 0 )
 		return DEVICE_IP;
 
 	return DEVICE_DEFAULT;
@@ -403,6 +474,7 @@ const char* videoOptions::CodecToStr( videoOptions::Codec codec )
 		case CODEC_MPEG2:	return "MPEG2";
 		case CODEC_MPEG4:	return "MPEG4";
 		case CODEC_MJPEG:	return "MJPEG";
+		case CODEC_LZ4:	return "LZ4";
 	}
 	
 	return nullptr;
@@ -415,7 +487,7 @@ videoOptions::Codec videoOptions::CodecFromStr( const char* str )
 	if( !str )
 		return CODEC_UNKNOWN;
 
-	for( int n=0; n <= CODEC_MJPEG; n++ )
+	for( int n=0; n <= CODEC_LZ4; n++ )
 	{
 		const Codec value = (Codec)n;
 
@@ -460,3 +532,66 @@ videoOptions::CodecType videoOptions::CodecTypeFromStr( const char* str )
 	return gst_default_codec();
 }
 
+
+// DiscoveryToStr
+const char* videoOptions::DiscoveryToStr( videoOptions::Discovery discovery )
+{
+	switch(discovery)
+	{
+		case DISCOVERY_CACHE: return "cache";
+		case DISCOVERY_PROBE: return "probe";
+		case DISCOVERY_SKIP:  return "skip";
+	}
+	
+	return nullptr;
+}
+
+
+// DiscoveryFromStr
+videoOptions::Discovery videoOptions::DiscoveryFromStr( const char* str )
+{
+	if( !str )
+		return DISCOVERY_DEFAULT;
+
+	for( int n=0; n <= DISCOVERY_SKIP; n++ )
+	{
+		const Discovery value = (Discovery)n;
+
+		if( strcasecmp(str, DiscoveryToStr(value)) == 0 )
+			return value;
+	}
+	
+	return DISCOVERY_DEFAULT;
+}
+
+
+// QueuePolicyToStr
+const char* videoOptions::QueuePolicyToStr( videoOptions::QueuePolicy policy )
+{
+	switch(policy)
+	{
+		case QUEUE_BLOCK:       return "block";
+		case QUEUE_DROP_NEWEST: return "drop-newest";
+		case QUEUE_DROP_OLDEST: return "drop-oldest";
+	}
+
+	return nullptr;
+}
+
+
+// QueuePolicyFromStr
+videoOptions::QueuePolicy videoOptions::QueuePolicyFromStr( const char* str )
+{
+	if( !str )
+		return QUEUE_DEFAULT;
+
+	for( int n=0; n <= QUEUE_DROP_OLDEST; n++ )
+	{
+		const QueuePolicy value = (QueuePolicy)n;
+
+		if( strcasecmp(str, QueuePolicyToStr(value)) == 0 )
+			return value;
+	}
+
+	return QUEUE_DEFAULT;
+}
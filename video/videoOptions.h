@@ -89,6 +89,15 @@ public:
 	 */
 	uint32_t bitRate;
 
+	/**
+	 * The lowest bitrate that adaptive bitrate control can lower the encoder to.
+	 * If set, RTSP and WebRTC output streams adapt their bitrate between this and bitRate
+	 * from the packet loss and round-trip times that the clients report (see gstBitrateController).
+	 * This option can be set from the command line using `--min-bitrate=N`.
+	 * @note the default is 0, which disables adaptive bitrate control.
+	 */
+	uint32_t minBitRate;
+
 	/**
 	 * The number of ring buffers used for threading.
 	 * This option can be set from the command line using `--num-buffers=N`.
@@ -118,6 +127,25 @@ public:
 	 */
 	int loop;
 
+	/**
+	 * For videoSource disk-based inputs (video files and image sequences), capture every
+	 * Nth frame and skip the frames in between.  Video files drop them after decoding
+	 * (before they're converted), and seek to the nearest keyframe when the stride is
+	 * at least two GOPs long, so the captured frames may not be exactly N apart.
+	 * This option can be set from the command line using `--input-stride=N`.
+	 * @note by default, the stride is `1` (every frame is captured).
+	 */
+	uint32_t stride;
+
+	/**
+	 * If true, compressed video inputs only decode keyframes (I-frames) and skip the
+	 * rest, which is much faster for scanning through long videos (e.g. for thumbnails).
+	 * Video files are also read as fast as possible instead of at their playback rate.
+	 * This option can be set from the command line using `--input-keyframes-only`.
+	 * @note by default, this is disabled (every frame is decoded).
+	 */
+	bool keyframesOnly;
+
 	/**
 	 * Number of milliseconds of video to buffer for network RTSP or WebRTC streams.
 	 * The default setting is 10ms (which is lower than GStreamer's default settings).
@@ -126,6 +154,47 @@ public:
 	 */
 	int latency;
 
+	/**
+	 * Policies for when the queue of an asynchronous output is full.
+	 */
+	enum QueuePolicy
+	{
+		QUEUE_BLOCK = 0,		/**< Wait for space in the queue (backpressure) */
+		QUEUE_DROP_NEWEST,		/**< Drop the frame that's being output */
+		QUEUE_DROP_OLDEST,		/**< Drop the oldest frame in the queue to make room */
+		QUEUE_DEFAULT = QUEUE_BLOCK	/**< Default setting (block) */
+	};
+
+	/**
+	 * The number of worker threads used to write frames in the background for
+	 * image outputs (imageWriter).  When this is `0`, frames are encoded and
+	 * written synchronously from Render().  Otherwise, Render() copies the frame
+	 * into a queue and returns, while the worker threads encode and save them.
+	 * This option can be set from the command line using `--output-threads=N`.
+	 * @note by default, this is `0` (frames are written synchronously).
+	 */
+	uint32_t threads;
+
+	/**
+	 * The maximum number of frames that can be waiting in the queue of an
+	 * asynchronous output (see `threads`).  This option can be set from the
+	 * command line using `--output-queue=N`.
+	 * @note the default queue depth is 8.
+	 */
+	uint32_t queueDepth;
+
+	/**
+	 * What happens when the queue of an asynchronous output is full.  It can be set
+	 * from the command line using `--output-queue-policy=xyz`, where `xyz` is one of:
+	 *
+	 *   - `block`       (wait for the workers to make room in the queue)
+	 *   - `drop-newest` (skip the frame that's being output)
+	 *   - `drop-oldest` (discard the oldest frame from the queue)
+	 *
+	 * @note by default, this is `block`.
+	 */
+	QueuePolicy queuePolicy;
+
 	/**
 	 * Device interface types.
 	 */
@@ -136,7 +205,9 @@ public:
 		DEVICE_CSI,			/**< MIPI CSI camera */
 		DEVICE_IP,			/**< IP-based network stream (e.g. RTP/RTSP) */
 		DEVICE_FILE,			/**< Disk-based stream from a file or directory of files */
-		DEVICE_DISPLAY			/**< OpenGL output stream rendered to an attached display */
+		DEVICE_DISPLAY,		/**< OpenGL output stream rendered to an attached display */
+		DEVICE_TEST,			/**< Synthetic test pattern generator (see videoTestSource) */
+		DEVICE_SHM			/**< Shared memory ring between processes (see shmSource and shmOutput) */
 	};
 
 	/**
@@ -205,7 +276,8 @@ public:
 		CODEC_VP9,			/**< VP9 */
 		CODEC_MPEG2,			/**< MPEG2 (decode only) */
 		CODEC_MPEG4,			/**< MPEG4 (decode only) */
-		CODEC_MJPEG			/**< MJPEG */
+		CODEC_MJPEG,			/**< MJPEG */
+		CODEC_LZ4			/**< LZ4 (lossless, frame archives only) */
 	};
 
 	/**
@@ -240,6 +312,33 @@ public:
 	 * The default setting is to use hardware-acceleration on Jetson (aarch64) and CPU on x86.
 	 */
 	CodecType codecType;
+
+	/**
+	 * Stream discovery modes for compressed video inputs.
+	 */
+	enum Discovery
+	{
+		DISCOVERY_CACHE = 0,	/**< Probe the stream, caching the results on disk for video files */
+		DISCOVERY_PROBE,		/**< Always probe the stream, without using the on-disk cache */
+		DISCOVERY_SKIP,		/**< Skip probing when the codec and resolution are already known */
+		DISCOVERY_DEFAULT = DISCOVERY_CACHE	/**< Default setting (cache) */
+	};
+
+	/**
+	 * Controls how the properties of compressed video inputs (codec, resolution, framerate)
+	 * are discovered before the decoder pipeline gets created.  It can be set from the command
+	 * line using `--input-discovery=xyz`, where `xyz` is one of the strings below:
+	 *
+	 *   - `cache` (probe video files once, and re-use the results until the file changes)
+	 *   - `probe` (probe the stream every time it's opened)
+	 *   - `skip`  (use the `--input-codec`, `--input-width`, and `--input-height` options
+	 *              as the stream's properties instead of probing it)
+	 *
+	 * The cache is stored in `$XDG_CACHE_HOME/jetson-utils/gst-discovery.cache`
+	 * (or `~/.cache/jetson-utils/gst-discovery.cache`), and can be relocated
+	 * with the `JETSON_UTILS_DISCOVERY_CACHE` environment variable.
+	 */
+	Discovery discovery;
 		
 
 	/**
@@ -341,6 +440,26 @@ public:
 	 * Parse a Codec enum from a string.
 	 */
 	static CodecType CodecTypeFromStr( const char* str );
+
+	/**
+	 * Convert a Discovery enum to a string.
+	 */
+	static const char* DiscoveryToStr( Discovery discovery );
+
+	/**
+	 * Parse a Discovery enum from a string.
+	 */
+	static Discovery DiscoveryFromStr( const char* str );
+
+	/**
+	 * Convert a QueuePolicy enum to a string.
+	 */
+	static const char* QueuePolicyToStr( QueuePolicy policy );
+
+	/**
+	 * Parse a QueuePolicy enum from a string.
+	 */
+	static QueuePolicy QueuePolicyFromStr( const char* str );
 };
 
 
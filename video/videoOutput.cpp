@@ -22,17 +22,29 @@
  
 #include "videoOutput.h"
 #include "imageWriter.h"
+#include "shmOutput.h"
+#include "frameArchiveWriter.h"
+#include "mjpegOutput.h"
 
 #include "glDisplay.h"
 #include "gstEncoder.h"
 
 #include "logging.h"
+#include "metrics.h"
 
 
 // constructor
 videoOutput::videoOutput( const videoOptions& options ) : mOptions(options)
 {
 	mStreaming = false;
+
+	const std::string labels = Metrics::Label("uri", mOptions.resource.string.c_str());
+
+	mFramesMetric    = Metrics::Counter("jetson_video_output_frames_total", "Number of frames rendered", labels.c_str());
+	mStreamingMetric = Metrics::Gauge("jetson_video_output_streaming", "Whether the stream is open (1) or closed (0)", labels.c_str());
+	mFrameRateMetric = Metrics::Gauge("jetson_video_output_frame_rate", "Framerate of the stream (in FPS)", labels.c_str());
+
+	Metrics::AddCollector(collectMetrics, this);
 }
 
 
@@ -43,17 +55,36 @@ videoOutput::~videoOutput()
 
 	for( uint32_t n=0; n < numOutputs; n++ )
 		SAFE_DELETE(mOutputs[n]);
+
+	Metrics::RemoveCollector(collectMetrics, this);
+
+	Metrics::Release(mFramesMetric);
+	Metrics::Release(mStreamingMetric);
+	Metrics::Release(mFrameRateMetric);
+}
+
+
+// collectMetrics (called by Metrics::Render() before the metrics are scraped)
+void videoOutput::collectMetrics( void* user_data )
+{
+	videoOutput* stream = (videoOutput*)user_data;
+
+	stream->mFramesMetric->Set(stream->mOptions.frameCount);
+	stream->mStreamingMetric->Set(stream->mStreaming ? 1.0 : 0.0);
+	stream->mFrameRateMetric->Set(stream->mOptions.frameRate);
 }
 
 
 // create secondary display stream (if needed)
 static videoOutput* createDisplaySubstream( videoOutput* output, videoOptions& options, const commandLine& cmdLine )
 {
-	const bool headless = cmdLine.GetFlag("no-display") | cmdLine.GetFlag("headless");
+	const bool headless  = cmdLine.GetFlag("no-display") | cmdLine.GetFlag("headless");
+	const bool offscreen = cmdLine.GetFlag("offscreen");
 
-	if( options.resource.protocol != "display" && !headless )
+	// an offscreen display renders without a window, and passes the rendered frames to the output
+	if( options.resource.protocol != "display" && (!headless || offscreen) )
 	{
-		options.resource = "display://0";
+		options.resource = offscreen ? "display://offscreen" : "display://0";
 		videoOutput* display = videoOutput::Create(options);
 
 		if( !display )
@@ -82,6 +113,12 @@ static void applyDisplayFlags( videoOutput* output, const commandLine& cmdLine )
 		
 		if( cmdLine.GetFlag("fullscreen") )
 			display->SetFullscreen(true);
+
+		if( cmdLine.GetFlag("present-mode") )
+			display->SetPresentMode(glDisplay::PresentModeFromStr(cmdLine.GetString("present-mode")));
+
+		if( cmdLine.GetFlag("render-thread") )
+			display->StartRenderThread();
 	}
 	
 	for( uint32_t n=0; n < output->GetNumOutputs(); n++ )
@@ -98,7 +135,9 @@ videoOutput* videoOutput::Create( const videoOptions& options )
 	
 	if( uri.protocol == "file" )
 	{
-		if( gstEncoder::IsSupportedExtension(uri.extension.c_str()) )
+		if( frameArchiveWriter::IsSupportedExtension(uri.extension.c_str()) )
+			output = frameArchiveWriter::Create(options);
+		else if( gstEncoder::IsSupportedExtension(uri.extension.c_str()) )
 			output = gstEncoder::Create(options);
 		else
 			output = imageWriter::Create(options);
@@ -111,6 +150,14 @@ videoOutput* videoOutput::Create( const videoOptions& options )
 	{
 		output = glDisplay::Create(options);
 	}
+	else if( uri.protocol == "shm" )
+	{
+		output = shmOutput::Create(options);
+	}
+	else if( uri.protocol == "http" )
+	{
+		output = mjpegOutput::Create(options);
+	}
 	else
 	{
 		LogError(LOG_VIDEO "videoOutput -- unsupported protocol (%s)\n", uri.protocol.size() > 0 ? uri.protocol.c_str() : "null");
@@ -239,6 +286,12 @@ const char* videoOutput::TypeToStr( uint32_t type )
 		return "gstEncoder";
 	else if( type == imageWriter::Type )
 		return "imageWriter";
+	else if( type == shmOutput::Type )
+		return "shmOutput";
+	else if( type == frameArchiveWriter::Type )
+		return "frameArchiveWriter";
+	else if( type == mjpegOutput::Type )
+		return "mjpegOutput";
 
 	LogWarning(LOG_VIDEO "unknown videoOutput type - %u\n", type);
 	return "(unknown)";
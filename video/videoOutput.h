@@ -31,6 +31,11 @@
 #include <vector>
 
 
+// forward declarations
+class MetricCounter;
+class MetricGauge;
+
+
 /**
  * Standard command-line options able to be passed to videoOutput::Create()
  * @ingroup video
@@ -40,15 +45,20 @@
 		  "                             * file://my_image.jpg       (image file)\n"		\
 		  "                             * file://my_video.mp4       (video file)\n"		\
 		  "                             * file://my_directory/      (directory of images)\n"	\
+		  "                             * file://my_session.frames  (frame archive)\n"		\
 		  "                             * rtp://<remote-ip>:1234    (RTP stream)\n"		\
 		  "                             * rtsp://@:8554/my_stream   (RTSP stream)\n"		\
 		  "                             * webrtc://@:1234/my_stream (WebRTC stream)\n"      	\
+		  "                             * http://@:8090/my_stream   (MJPEG over HTTP)\n"		\
 		  "                             * display://0               (OpenGL window)\n" 		\
+		  "                             * display://offscreen       (OpenGL offscreen)\n" 	\
+		  "                             * shm://my_stream           (shared memory ring)\n"	\
 		  "  --output-codec=CODEC   desired codec for compressed output streams:\n"		\
 		  "                            * h264 (default), h265\n"						\
 		  "                            * vp8, vp9\n"									\
 		  "                            * mpeg2, mpeg4\n"								\
 		  "                            * mjpeg\n"        								\
+		  "                            * lz4  (frame archives only)\n"					\
 		  "  --output-encoder=TYPE  the encoder engine to use, one of these:\n"              \
 		  "                            * cpu\n"                                              \
 		  "                            * omx  (aarch64/JetPack4 only)\n"                     \
@@ -57,15 +67,27 @@
 		  "                         to disk, in addition to the primary output above\n"      \
 		  "  --bitrate=BITRATE      desired target VBR bitrate for compressed streams,\n"    \
 		  "                         in bits per second. The default is 4000000 (4 Mbps)\n"	\
+		  "  --min-bitrate=BITRATE  adapt the bitrate of RTSP/WebRTC streams to the network,\n" \
+		  "                         between this and --bitrate (disabled by default)\n"	\
+		  "  --output-threads=N     save images in the background with N worker threads\n"   \
+		  "  --output-queue=N       max number of images waiting to be saved (default 8)\n"  \
+		  "  --output-queue-policy  when the queue is full, one of these:\n"               \
+		  "                            * block (default), drop-newest, drop-oldest\n"     \
 		  "  --stun-server=URL      WebRTC connection STUN server (set to 'disabled' for LAN)\n" \
-		  "  --headless             don't create a default OpenGL GUI window\n\n"
+		  "  --render-thread        present frames to the display from a separate thread,\n" \
+		  "                         dropping frames instead of waiting for vsync\n"         \
+		  "  --present-mode=MODE    display swap mode, one of these:\n"                    \
+		  "                            * default, vsync, immediate, adaptive\n"          \
+		  "  --headless             don't create a default OpenGL GUI window\n"              \
+		  "  --offscreen            render with OpenGL offscreen (no X server needed), and\n" \
+		  "                         send the rendered frames with overlays to the output\n\n"
 
 
 /**
  * The videoOutput API is for rendering and transmitting frames to video input devices such as display windows, 
  * broadcasting RTP network streams to remote hosts over UDP/IP, and saving videos/images/directories to disk. 
  *
- * videoOutput interfaces are implemented by glDisplay, gstEncoder, and imageWriter.  
+ * videoOutput interfaces are implemented by glDisplay, gstEncoder, imageWriter, shmOutput, and mjpegOutput.  
  * The specific implementation is selected at runtime based on the type of resource URI.
  * An instance can have multiple sub-streams, for example simultaneously outputting to 
  * a display and encoded video on disk or RTP stream.
@@ -75,6 +97,10 @@
  *     - `display://0` for rendering to display using OpenGL, where `0` corresponds to the display number.
  *        By default, an OpenGL window will be created, unless the `--headless` command line option is used.
  *
+ *     - `display://offscreen` for rendering with OpenGL without a window or X server (see glDisplay::CreateOffscreen()).
+ *        The rendered frames (including widgets and overlays) are passed to the sub-streams, and with the
+ *        `--offscreen` command line option, an offscreen display is put in front of the output stream.
+ *
  *     - `rtp://<remote-host>:1234` to broadcast a compressed RTP stream to a remote host, where you should
  *        substitute `<remote-host>` with the remote host's IP address or hostname, and `1234` is the port.
  *
@@ -96,7 +122,19 @@
  *        specified, then by default it will create a sequence of the form `%i.jpg` in that directory.
  *        Supported video formats for saving include MKV, MP4, AVI, and FLV. Supported codecs for 
  *        encoding include H.264, H.265, VP8, VP9, and MJPEG. Supported image formats for saving 
- *        include JPG, PNG, TGA, and BMP.
+ *        include JPG, PNG, TGA, and BMP.  Saving to a `.frames` file records the raw frames into
+ *        a frame archive, which videoSource can replay without decoding (use `--output-codec=lz4`
+ *        to compress them losslessly).  @see frameArchiveWriter
+ *
+ *     - `shm://my_stream` to publish frames to a ring in shared memory, which other processes can
+ *        receive from by opening a videoSource with the same `shm://my_stream` URI (see shmOutput).
+ *
+ *     - `http://@:8090/my_stream` to serve a Motion JPEG stream that browsers can show in an `<img>`
+ *        tag, without the overhead of WebRTC.  Each frame is encoded once and shared by all of the
+ *        clients, and slow clients drop frames instead of holding up the others (see mjpegOutput).
+ *
+ * The number of frames rendered to each output is kept in the Metrics registry under
+ * the output's URI (see MetricsServer for scraping them over HTTP).
  *
  * @see URI for info about resource URI formats.
  * @see videoOptions for additional options and command-line arguments.
@@ -329,6 +367,12 @@ protected:
 	videoOptions mOptions;
 
 	std::vector<videoOutput*> mOutputs;
+
+	MetricCounter* mFramesMetric;
+	MetricGauge*   mStreamingMetric;
+	MetricGauge*   mFrameRateMetric;
+
+	static void collectMetrics( void* user_data );
 };
 
 #endif
@@ -22,11 +22,20 @@
  
 #include "videoSource.h"
 #include "imageLoader.h"
+#include "videoTestSource.h"
+#include "shmSource.h"
+#include "frameArchiveReader.h"
 
 #include "gstCamera.h"
 #include "gstDecoder.h"
 
 #include "logging.h"
+#include "metrics.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
 
 
 // constructor
@@ -34,14 +43,91 @@ videoSource::videoSource( const videoOptions& options ) : mOptions(options)
 {
 	mStreaming = false;
 	mLastTimestamp = 0;
+	mLastKeyframe = true;
 	mRawFormat = IMAGE_UNKNOWN;
+	mReadyFD = -1;
+
+	const std::string labels = Metrics::Label("uri", mOptions.resource.string.c_str());
+
+	mFramesMetric    = Metrics::Counter("jetson_video_source_frames_total", "Number of frames captured", labels.c_str());
+	mStreamingMetric = Metrics::Gauge("jetson_video_source_streaming", "Whether the stream is open (1) or closed (0)", labels.c_str());
+	mFrameRateMetric = Metrics::Gauge("jetson_video_source_frame_rate", "Framerate of the stream (in FPS)", labels.c_str());
+
+	Metrics::AddCollector(collectMetrics, this);
 }
 
 
 // destructor
 videoSource::~videoSource()
 {
+	Metrics::RemoveCollector(collectMetrics, this);
+
+	Metrics::Release(mFramesMetric);
+	Metrics::Release(mStreamingMetric);
+	Metrics::Release(mFrameRateMetric);
+
+	if( mReadyFD >= 0 )
+	{
+		close(mReadyFD);
+		mReadyFD = -1;
+	}
+}
+
+
+// initReadyFD
+bool videoSource::initReadyFD()
+{
+	if( mReadyFD >= 0 )
+		return true;
+
+	mReadyFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if( mReadyFD < 0 )
+	{
+		LogWarning(LOG_VIDEO "videoSource -- failed to create eventfd for frame notifications (%s)\n", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+
+// notifyReady
+void videoSource::notifyReady()
+{
+	if( mReadyFD < 0 )
+		return;
+
+	// the eventfd counter just needs to be non-zero (EAGAIN means it's already raised)
+	const uint64_t value = 1;
 
+	if( write(mReadyFD, &value, sizeof(value)) < 0 && errno != EAGAIN )
+		LogVerbose(LOG_VIDEO "videoSource -- failed to raise frame notification (%s)\n", strerror(errno));
+}
+
+
+// ResetReadyFD
+void videoSource::ResetReadyFD()
+{
+	if( mReadyFD < 0 )
+		return;
+
+	// reading an eventfd returns the counter and resets it to zero
+	uint64_t value = 0;
+
+	if( read(mReadyFD, &value, sizeof(value)) < 0 && errno != EAGAIN )
+		LogVerbose(LOG_VIDEO "videoSource -- failed to reset frame notification (%s)\n", strerror(errno));
+}
+
+
+// collectMetrics (called by Metrics::Render() before the metrics are scraped)
+void videoSource::collectMetrics( void* user_data )
+{
+	videoSource* stream = (videoSource*)user_data;
+
+	stream->mFramesMetric->Set(stream->mOptions.frameCount);
+	stream->mStreamingMetric->Set(stream->mStreaming ? 1.0 : 0.0);
+	stream->mFrameRateMetric->Set(stream->mOptions.frameRate);
 }
 
 // Create
@@ -53,7 +139,9 @@ videoSource* videoSource::Create( const videoOptions& options )
 
 	if( uri.protocol == "file" )
 	{
-		if( gstDecoder::IsSupportedExtension(uri.extension.c_str()) )
+		if( frameArchiveReader::IsSupportedExtension(uri.extension.c_str()) )
+			src = frameArchiveReader::Create(options);
+		else if( gstDecoder::IsSupportedExtension(uri.extension.c_str()) )
 			src = gstDecoder::Create(options);
 		else
 			src = imageLoader::Create(options);
@@ -66,6 +154,14 @@ videoSource* videoSource::Create( const videoOptions& options )
 	{
 		src = gstCamera::Create(options);
 	}
+	else if( uri.protocol == "test" )
+	{
+		src = videoTestSource::Create(options);
+	}
+	else if( uri.protocol == "shm" )
+	{
+		src = shmSource::Create(options);
+	}
 	else
 	{
 		LogError(LOG_VIDEO "videoSource -- unsupported protocol (%s)\n", uri.protocol.size() > 0 ? uri.protocol.c_str() : "null");
@@ -130,6 +226,22 @@ void videoSource::Close()
 	mStreaming = false;
 }
 
+// Seek
+bool videoSource::Seek( uint64_t position, SeekFormat format, bool accurate )
+{
+	LogError(LOG_VIDEO "videoSource -- %s doesn't support seeking (%s)\n", TypeToStr(), GetResource().string.c_str());
+	return false;
+}
+
+// GetPosition
+uint64_t videoSource::GetPosition( SeekFormat format ) const
+{
+	if( format == SEEK_TIME )
+		return mLastTimestamp;
+	
+	return mOptions.frameCount;
+}
+
 // TypeToStr
 const char* videoSource::TypeToStr( uint32_t type )
 {
@@ -139,6 +251,12 @@ const char* videoSource::TypeToStr( uint32_t type )
 		return "gstDecoder";
 	else if( type == imageLoader::Type )
 		return "imageLoader";
+	else if( type == videoTestSource::Type )
+		return "videoTestSource";
+	else if( type == shmSource::Type )
+		return "shmSource";
+	else if( type == frameArchiveReader::Type )
+		return "frameArchiveReader";
 
 	return "(unknown)";
 }
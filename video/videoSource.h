@@ -29,6 +29,11 @@
 #include "commandLine.h"
 
 
+// forward declarations
+class MetricCounter;
+class MetricGauge;
+
+
 /**
  * Standard command-line options able to be passed to videoSource::Create()
  * @ingroup video
@@ -43,6 +48,9 @@
 		  "                             * file://my_image.jpg       (image file)\n"			\
 		  "                             * file://my_video.mp4       (video file)\n"			\
 		  "                             * file://my_directory/      (directory of images)\n"		\
+		  "                             * file://my_session.frames  (frame archive)\n"			\
+		  "                             * test://gradient           (synthetic test pattern)\n"	\
+		  "                             * shm://my_stream           (shared memory from shmOutput)\n" \
 		  "  --input-width=WIDTH    explicitly request a width of the stream (optional)\n"   	\
 		  "  --input-height=HEIGHT  explicitly request a height of the stream (optional)\n"  	\
 		  "  --input-rate=RATE      explicitly request a framerate of the stream (optional)\n"	\
@@ -56,6 +64,10 @@
 		  "                             * cpu\n"                                                  \
 		  "                             * omx  (aarch64/JetPack4 only)\n"                         \
 		  "                             * v4l2 (aarch64/JetPack5 only)\n"                         \
+		  "  --input-discovery=MODE how video files are probed before decoding:\n"               \
+		  "                             * cache (re-use results until the file changes)\n"      \
+		  "                             * probe (always probe the stream)\n"                   \
+		  "                             * skip  (use --input-codec/width/height instead)\n"     \
 		  "  --input-flip=FLIP      flip method to apply to input:\n" 						\
 		  "                             * none (default)\n" 								\
 		  "                             * counterclockwise\n" 								\
@@ -65,6 +77,9 @@
 		  "                             * vertical\n" 									\
 		  "                             * upper-right-diagonal\n" 							\
 		  "                             * upper-left-diagonal\n" 							\
+		  "  --input-stride=N       for file-based inputs, capture every Nth frame and skip\n"	\
+		  "                         the frames in between (the default is 1)\n"			\
+		  "  --input-keyframes-only only decode keyframes from compressed video (for scanning)\n"	\
 		  "  --input-loop=LOOP      for file-based inputs, the number of loops to run:\n"		\
 		  "                             * -1 = loop forever\n"								\
 		  "                             *  0 = don't loop (default)\n"						\
@@ -76,7 +91,7 @@
  * V4L2 cameras, video/images files from disk, directories containing a sequence of images, 
  * and from RTP/RTSP network video streams over UDP/IP.
  *
- * videoSource interfaces are implemented by gstCamera, gstDecoder, and imageLoader.
+ * videoSource interfaces are implemented by gstCamera, gstDecoder, imageLoader, videoTestSource, and shmSource.
  * The specific implementation is selected at runtime based on the type of resource URI.
  *
  * videoSource supports the following protocols and resource URI's:
@@ -110,7 +125,21 @@
  *        Supported video formats for loading include MKV, MP4, AVI, and FLV. Supported codecs for 
  *        decoding include H.264, H.265, VP8, VP9, MPEG-2, MPEG-4, and MJPEG. Supported image formats
  *        for loading include JPG, PNG, TGA, BMP, GIF, PSD, HDR, PIC, and PNM (PPM/PGM binary).
+ *        Frame archives (`.frames` files) recorded by videoOutput are replayed without any
+ *        decoding, and support fast seeking.  @see frameArchiveReader
+ *
+ *     - `test://gradient` for a synthetic test pattern, which is useful for benchmarking without
+ *        a camera.  The patterns are `solid`, `gradient`, `box`, and `noise`, and options can be
+ *        appended to the URI (for example `test://box?format=nv12&free=1`).
+ *        @see videoTestSource for the list of patterns and options.
+ *
+ *     - `shm://my_stream` to receive frames from another process that is outputting them to
+ *        the same `shm://my_stream` URI, through a ring of frames in shared memory.
+ *        Any number of processes can read from the same stream.  @see shmSource
  *  
+ * Each stream reports its frame count to the Metrics registry, labelled with its URI,
+ * which can be scraped from the `/metrics` endpoint of MetricsServer.
+ *
  * @see URI for info about resource URI formats.
  * @see videoOptions for additional options and command-line arguments.
  * @ingroup video
@@ -284,6 +313,57 @@ public:
 	 */
 	virtual void Close();
 
+	/**
+	 * Units of the position passed to Seek() and returned from GetPosition().
+	 */
+	enum SeekFormat
+	{
+		SEEK_FRAME = 0,	/**< The position is a frame index (starting from 0) */
+		SEEK_TIME		/**< The position is a timestamp (in nanoseconds) */
+	};
+
+	/**
+	 * Jump to a position in the stream, so that the next call to Capture()
+	 * returns the frame at that position.  Seeking is supported by video files
+	 * (gstDecoder), image sequences (imageLoader) and frame archives
+	 * (frameArchiveReader), but not by cameras or network streams.  Frame indices are converted to/from timestamps using
+	 * the framerate of the stream.
+	 *
+	 * @param position the frame index or timestamp to seek to (@see SeekFormat)
+	 * @param format whether `position` is a frame index or a timestamp in nanoseconds.
+	 * @param accurate if true, decode up to the exact frame requested.  Otherwise,
+	 *                 jump to the closest keyframe before it, which is faster.
+	 *
+	 * @returns `true` on success, `false` if the stream doesn't support seeking
+	 *          or the position was out of range.
+	 */
+	virtual bool Seek( uint64_t position, SeekFormat format=SEEK_FRAME, bool accurate=true );
+
+	/**
+	 * Return the position of the next frame that Capture() will return,
+	 * as either a frame index or timestamp in nanoseconds (@see SeekFormat).
+	 * For streams that don't support seeking, this is the number of frames captured.
+	 */
+	virtual uint64_t GetPosition( SeekFormat format=SEEK_FRAME ) const;
+
+	/**
+	 * Return a file descriptor that becomes readable when a new frame can be captured
+	 * without blocking, or `-1` if the stream doesn't support it.  This allows an event
+	 * loop (i.e. `poll()`, `epoll`, or Python's asyncio) to wait on many streams from one
+	 * thread, instead of dedicating a thread to each stream that blocks in Capture().
+	 *
+	 * After the descriptor becomes readable, call ResetReadyFD() and then Capture() with
+	 * a timeout of 0.  For streams whose Capture() reports EOS (gstDecoder and imageLoader),
+	 * the descriptor is also raised at the end of the stream, so that Capture() can report it.
+	 * This is supported by gstCamera, gstDecoder and imageLoader.
+	 */
+	inline int GetReadyFD() const					{ return mReadyFD; }
+
+	/**
+	 * Clear the descriptor returned by GetReadyFD(), before checking for the next frame.
+	 */
+	void ResetReadyFD();
+
 	/**
 	 * Check if the device is actively streaming or not.
 	 *
@@ -317,6 +397,11 @@ public:
  	 */
 	uint64_t GetLastTimestamp() const { return mLastTimestamp; }
 
+	/**
+	 * Return true if the last captured frame was a keyframe (or an uncompressed frame).
+	 */
+	inline bool IsKeyframe() const			{ return mLastKeyframe; }
+
 	/**
 	 * Get raw image format.
  	 */
@@ -376,11 +461,22 @@ protected:
 	//videoSource();
 	videoSource( const videoOptions& options );
 
+	bool initReadyFD();	// called by the constructors of streams that support GetReadyFD()
+	void notifyReady();	// raise the descriptor when a frame was recieved (or EOS)
+
 	bool         mStreaming;
 	videoOptions mOptions;
 
 	uint64_t     mLastTimestamp;
+	bool         mLastKeyframe;
 	imageFormat  mRawFormat;
+	int          mReadyFD;
+
+	MetricCounter* mFramesMetric;
+	MetricGauge*   mStreamingMetric;
+	MetricGauge*   mFrameRateMetric;
+
+	static void collectMetrics( void* user_data );
 };
 
 #endif
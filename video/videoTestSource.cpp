@@ -0,0 +1,685 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "videoTestSource.h"
+
+#include "cudaMappedMemory.h"
+#include "cudaRGB.h"
+#include "cudaImageView.h"
+
+#include "logging.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <strings.h>
+
+
+// the barcode has a white start cell, a black guard cell, then the counter bits (MSB first)
+#define COUNTER_BITS  32
+#define COUNTER_CELLS (COUNTER_BITS + 2)
+
+
+// constructor
+videoTestSource::videoTestSource( const videoOptions& options ) : videoSource(options)
+{
+	mPattern         = PATTERN_GRADIENT;
+	mColor           = make_uchar4(255, 255, 255, 255);
+	mCounter         = true;
+	mFreeRun         = false;
+	mHostMemory      = false;
+	mBufferFormat    = IMAGE_UNKNOWN;
+	mNextBuffer      = 0;
+	mNextFrame       = 0;
+	mDroppedFrames   = 0;
+	mFramesGenerated = 0;
+	mStartTime       = timeZero();
+	mRawFormat       = IMAGE_RGB8;
+
+	if( mOptions.width == 0 || mOptions.height == 0 )
+	{
+		mOptions.width  = 1280;
+		mOptions.height = 720;
+	}
+
+	if( mOptions.frameRate <= 0 )
+		mOptions.frameRate = 30;
+
+	if( mOptions.numBuffers == 0 )
+		mOptions.numBuffers = 1;
+
+	// without a GPU, keep the frames in host memory so the source still works
+	int numDevices = 0;
+
+	if( cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0 )
+	{
+		cudaGetLastError();	// clear the error
+		LogWarning(LOG_VIDEO "videoTestSource -- no CUDA device found, generating frames in host memory\n");
+		mHostMemory = true;
+	}
+}
+
+
+// destructor
+videoTestSource::~videoTestSource()
+{
+	Close();
+	freeBuffers();
+}
+
+
+// Create
+videoTestSource* videoTestSource::Create( const videoOptions& options )
+{
+	videoTestSource* src = new videoTestSource(options);
+
+	if( !src->parseOptions() )
+	{
+		delete src;
+		return NULL;
+	}
+
+	return src;
+}
+
+
+// Create
+videoTestSource* videoTestSource::Create( const char* resource, const videoOptions& options )
+{
+	videoOptions opt = options;
+	opt.resource = resource;
+	return Create(opt);
+}
+
+
+// parseOptions
+bool videoTestSource::parseOptions()
+{
+	const std::string& location = mOptions.resource.location;
+	const size_t query = location.find('?');
+
+	const std::string pattern = location.substr(0, query);
+
+	if( pattern.size() > 0 )
+	{
+		mPattern = PatternFromStr(pattern.c_str());
+
+		if( strcasecmp(pattern.c_str(), PatternToStr(mPattern)) != 0 )
+		{
+			LogError(LOG_VIDEO "videoTestSource -- invalid test pattern '%s' (valid patterns are solid, gradient, box, noise)\n", pattern.c_str());
+			return false;
+		}
+	}
+
+	if( query == std::string::npos )
+		return true;
+
+	// parse the key=value pairs after the '?'
+	size_t pos = query + 1;
+
+	while( pos < location.size() )
+	{
+		size_t end = location.find('&', pos);
+
+		if( end == std::string::npos )
+			end = location.size();
+
+		const std::string param = location.substr(pos, end - pos);
+		const size_t eq = param.find('=');
+
+		const std::string key   = param.substr(0, eq);
+		const std::string value = (eq != std::string::npos) ? param.substr(eq + 1) : "1";
+
+		if( key == "format" )
+		{
+			mRawFormat = imageFormatFromStr(value.c_str());
+
+			if( mRawFormat == IMAGE_UNKNOWN )
+			{
+				LogError(LOG_VIDEO "videoTestSource -- invalid image format '%s'\n", value.c_str());
+				return false;
+			}
+		}
+		else if( key == "color" )
+		{
+			const unsigned long rgb = strtoul(value.c_str(), NULL, 16);
+			mColor = make_uchar4((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, 255);
+		}
+		else if( key == "counter" )
+		{
+			mCounter = (atoi(value.c_str()) != 0);
+		}
+		else if( key == "free" )
+		{
+			mFreeRun = (atoi(value.c_str()) != 0);
+		}
+		else if( key.size() > 0 )
+		{
+			LogWarning(LOG_VIDEO "videoTestSource -- ignoring unknown option '%s'\n", key.c_str());
+		}
+
+		pos = end + 1;
+	}
+
+	return true;
+}
+
+
+// allocBuffers
+bool videoTestSource::allocBuffers( imageFormat format )
+{
+	if( format == mBufferFormat && mBuffers.size() > 0 )
+		return true;
+
+	freeBuffers();
+
+	const size_t size = imageFormatSize(format, mOptions.width, mOptions.height);
+
+	for( uint32_t n=0; n < mOptions.numBuffers; n++ )
+	{
+		void* ptr = NULL;
+
+		if( mHostMemory )
+			ptr = malloc(size);
+		else if( !cudaAllocMapped(&ptr, size) )
+			ptr = NULL;
+
+		if( !ptr )
+		{
+			LogError(LOG_VIDEO "videoTestSource -- failed to allocate %zu bytes for %ux%u %s frame\n", size, mOptions.width, mOptions.height, imageFormatToStr(format));
+			return false;
+		}
+
+		mBuffers.push_back(ptr);
+	}
+
+	mBufferFormat = format;
+	mNextBuffer = 0;
+
+	return true;
+}
+
+
+// freeBuffers
+void videoTestSource::freeBuffers()
+{
+	const size_t numBuffers = mBuffers.size();
+
+	for( size_t n=0; n < numBuffers; n++ )
+	{
+		if( mHostMemory )
+			free(mBuffers[n]);
+		else
+			CUDA(cudaFreeHost(mBuffers[n]));
+	}
+
+	mBuffers.clear();
+	mBufferFormat = IMAGE_UNKNOWN;
+}
+
+
+#define RETURN_STATUS(code)  { if( status != NULL ) { *status=(code); } return ((code) == videoSource::OK ? true : false); }
+
+
+// Capture
+bool videoTestSource::Capture( void** output, imageFormat format, uint64_t timeout, int* status, cudaStream_t stream )
+{
+	// verify the output pointer exists
+	if( !output )
+		RETURN_STATUS(ERROR);
+
+	// confirm the stream is open
+	if( !mStreaming )
+	{
+		if( !Open() )
+			RETURN_STATUS(ERROR);
+	}
+
+	if( format == IMAGE_UNKNOWN )
+		format = mRawFormat;
+
+	// wait until the next frame is due (or skip ahead if it's late)
+	uint64_t frame = mNextFrame;
+
+	if( !mFreeRun )
+	{
+		const uint64_t period = 1000000000.0 / mOptions.frameRate;
+		const timespec elapsedTime = timeDiff(mStartTime, timestamp());
+		const uint64_t elapsed = (uint64_t)elapsedTime.tv_sec * uint64_t(1000000000) + (uint64_t)elapsedTime.tv_nsec;
+		const uint64_t due = frame * period;
+
+		if( elapsed < due )
+		{
+			const uint64_t wait = due - elapsed;
+
+			if( timeout != UINT64_MAX && wait > timeout * 1000000 )
+			{
+				sleepTime(timeNew((long int)(timeout * 1000000)));
+				RETURN_STATUS(TIMEOUT);
+			}
+
+			sleepTime(timeNew((long int)wait));
+		}
+		else
+		{
+			const uint64_t latest = elapsed / period;
+
+			if( latest > frame )
+			{
+				mDroppedFrames += latest - frame;
+				frame = latest;
+			}
+		}
+	}
+
+	mNextFrame = frame + 1;
+
+	// generate the frame
+	const timespec captureTime = timestamp();
+
+	if( !allocBuffers(format) )
+		RETURN_STATUS(ERROR);
+
+	void* buffer = mBuffers[mNextBuffer];
+	mNextBuffer = (mNextBuffer + 1) % mBuffers.size();
+
+	if( format == IMAGE_RGBA8 )
+	{
+		render((uchar4*)buffer, frame);
+	}
+	else
+	{
+		mScratch.resize(mOptions.width * mOptions.height);
+		render(mScratch.data(), frame);
+
+		if( !convert(mScratch.data(), buffer, format) )
+			RETURN_STATUS(ERROR);
+	}
+
+	mLastTimestamp = (uint64_t)captureTime.tv_sec * uint64_t(1000000000) + (uint64_t)captureTime.tv_nsec;
+	mOptions.frameCount++;
+	mFramesGenerated++;
+
+	*output = buffer;
+	RETURN_STATUS(OK);
+}
+
+
+// Open
+bool videoTestSource::Open()
+{
+	if( mStreaming )
+		return true;
+
+	mStartTime = timestamp();
+	mNextFrame = 0;
+	mDroppedFrames = 0;
+	mFramesGenerated = 0;
+	mStreaming = true;
+
+	return true;
+}
+
+
+// Close
+void videoTestSource::Close()
+{
+	if( !mStreaming )
+		return;
+
+	const float elapsed = timeFloat(timeDiff(mStartTime, timestamp())) * 0.001f;
+
+	LogVerbose(LOG_VIDEO "videoTestSource -- generated %llu frames in %.2f seconds (%.1f FPS), %llu dropped\n",
+			 (unsigned long long)mFramesGenerated, elapsed, (elapsed > 0) ? mFramesGenerated / elapsed : 0.0f,
+			 (unsigned long long)mDroppedFrames);
+
+	mStreaming = false;
+}
+
+
+// bounce a position back and forth over a range
+static inline uint32_t bounce( uint64_t t, uint32_t range )
+{
+	if( range == 0 )
+		return 0;
+
+	const uint32_t p = t % (2 * range);
+	return (p < range) ? p : (2 * range - p);
+}
+
+
+// size of the barcode cells (or 0 if the frame is too small)
+static inline uint32_t counterCellSize( uint32_t width, uint32_t height )
+{
+	uint32_t cell = (width / 2) / COUNTER_CELLS;
+
+	if( cell > 16 )
+		cell = 16;
+
+	cell &= ~1;	// keep the cells aligned to the chroma subsampling
+
+	if( cell < 4 || height < cell )
+		return 0;
+
+	return cell;
+}
+
+
+// render
+void videoTestSource::render( uchar4* rgba, uint64_t frame )
+{
+	const uint32_t width  = mOptions.width;
+	const uint32_t height = mOptions.height;
+
+	if( mPattern == PATTERN_SOLID )
+	{
+		for( uint32_t n=0; n < width * height; n++ )
+			rgba[n] = mColor;
+	}
+	else if( mPattern == PATTERN_GRADIENT )
+	{
+		for( uint32_t y=0; y < height; y++ )
+		{
+			const uint8_t g = (y * 255) / height;
+
+			for( uint32_t x=0; x < width; x++ )
+			{
+				const uint8_t r = (((x + frame * 4) % width) * 255) / width;
+				rgba[y * width + x] = make_uchar4(r, g, 255 - r, 255);
+			}
+		}
+	}
+	else if( mPattern == PATTERN_BOX )
+	{
+		const uint32_t size = ((width < height) ? width : height) / 4;
+		const uint32_t left = bounce(frame * ((width / 160) + 1), width - size);
+		const uint32_t top  = bounce(frame * ((height / 120) + 1), height - size);
+
+		for( uint32_t y=0; y < height; y++ )
+		{
+			for( uint32_t x=0; x < width; x++ )
+			{
+				const bool inside = (x >= left && x < left + size && y >= top && y < top + size);
+				rgba[y * width + x] = inside ? mColor : make_uchar4(32, 32, 32, 255);
+			}
+		}
+	}
+	else if( mPattern == PATTERN_NOISE )
+	{
+		uint32_t state = (uint32_t)(frame * 2654435761u) | 1;	// xorshift32 seeded per-frame
+
+		for( uint32_t n=0; n < width * height; n++ )
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+
+			rgba[n] = make_uchar4(state & 0xFF, (state >> 8) & 0xFF, (state >> 16) & 0xFF, 255);
+		}
+	}
+
+	// stamp the frame counter
+	const uint32_t cell = mCounter ? counterCellSize(width, height) : 0;
+
+	if( cell == 0 )
+		return;
+
+	for( uint32_t c=0; c < COUNTER_CELLS; c++ )
+	{
+		bool white = false;
+
+		if( c == 0 )
+			white = true;
+		else if( c >= 2 )
+			white = (frame >> (COUNTER_BITS - 1 - (c - 2))) & 1;
+
+		const uchar4 color = white ? make_uchar4(255, 255, 255, 255) : make_uchar4(0, 0, 0, 255);
+
+		for( uint32_t y=0; y < cell; y++ )
+			for( uint32_t x=c * cell; x < (c + 1) * cell; x++ )
+				rgba[y * width + x] = color;
+	}
+}
+
+
+// RGB->YUV (same integer coefficients as the CUDA RGB->YUV kernels)
+static inline uint8_t clampByte( int value )		{ return (value < 0) ? 0 : (value > 255) ? 255 : value; }
+
+static inline uint8_t rgbToY( int r, int g, int b )	{ return clampByte((30 * r + 59 * g + 11 * b) / 100); }
+static inline uint8_t rgbToU( int r, int g, int b )	{ return clampByte((-17 * r - 33 * g + 50 * b + 12800) / 100); }
+static inline uint8_t rgbToV( int r, int g, int b )	{ return clampByte((50 * r - 42 * g - 8 * b + 12800) / 100); }
+
+
+// average the chroma over a block of pixels
+static inline void blockUV( const uchar4* rgba, uint32_t width, uint32_t x, uint32_t y, uint32_t rows, uint8_t* u, uint8_t* v )
+{
+	int r = 0, g = 0, b = 0;
+
+	for( uint32_t j=0; j < rows; j++ )
+	{
+		for( uint32_t i=0; i < 2; i++ )
+		{
+			const uchar4 px = rgba[(y + j) * width + x + i];
+			r += px.x; g += px.y; b += px.z;
+		}
+	}
+
+	const int count = rows * 2;
+
+	*u = rgbToU(r / count, g / count, b / count);
+	*v = rgbToV(r / count, g / count, b / count);
+}
+
+
+// convert
+bool videoTestSource::convert( const uchar4* rgba, void* output, imageFormat format )
+{
+	const uint32_t width  = mOptions.width;
+	const uint32_t height = mOptions.height;
+
+	if( imageFormatIsRGB(format) || imageFormatIsGray(format) )
+		return cudaRGBToRGBCPU(cudaImageView((void*)rgba, width, height, IMAGE_RGBA8), cudaImageView(output, width, height, format));
+
+	if( !imageFormatIsYUV(format) )
+	{
+		LogError(LOG_VIDEO "videoTestSource -- unsupported image format (%s)\n", imageFormatToStr(format));
+		return false;
+	}
+
+	if( width % 2 != 0 || height % 2 != 0 )
+	{
+		LogError(LOG_VIDEO "videoTestSource -- %s requires the width and height to be even (%ux%u)\n", imageFormatToStr(format), width, height);
+		return false;
+	}
+
+	// packed 4:2:2
+	if( format == IMAGE_YUYV || format == IMAGE_YVYU || format == IMAGE_UYVY )
+	{
+		uint8_t* out = (uint8_t*)output;
+
+		for( uint32_t y=0; y < height; y++ )
+		{
+			for( uint32_t x=0; x < width; x += 2, out += 4 )
+			{
+				const uchar4 p0 = rgba[y * width + x];
+				const uchar4 p1 = rgba[y * width + x + 1];
+
+				const uint8_t y0 = rgbToY(p0.x, p0.y, p0.z);
+				const uint8_t y1 = rgbToY(p1.x, p1.y, p1.z);
+
+				uint8_t u, v;
+				blockUV(rgba, width, x, y, 1, &u, &v);
+
+				if( format == IMAGE_YUYV )
+					{ out[0] = y0; out[1] = u; out[2] = y1; out[3] = v; }
+				else if( format == IMAGE_YVYU )
+					{ out[0] = y0; out[1] = v; out[2] = y1; out[3] = u; }
+				else
+					{ out[0] = u; out[1] = y0; out[2] = v; out[3] = y1; }
+			}
+		}
+
+		return true;
+	}
+
+	// planar and semi-planar
+	const bool wide = (format == IMAGE_P010 || format == IMAGE_P016);
+	const uint32_t chromaRows = (format == IMAGE_NV16) ? height : height / 2;
+	const uint32_t vsub = height / chromaRows;
+
+	uint8_t* planeU = (uint8_t*)output + width * height;
+	uint8_t* planeV = planeU + (width / 2) * chromaRows;
+
+	if( format == IMAGE_YV12 )
+		std::swap(planeU, planeV);
+
+	for( uint32_t n=0; n < width * height; n++ )
+	{
+		const uint8_t y = rgbToY(rgba[n].x, rgba[n].y, rgba[n].z);
+
+		if( wide )
+			((uint16_t*)output)[n] = y << 8;
+		else
+			((uint8_t*)output)[n] = y;
+	}
+
+	for( uint32_t cy=0; cy < chromaRows; cy++ )
+	{
+		for( uint32_t cx=0; cx < width / 2; cx++ )
+		{
+			uint8_t u, v;
+			blockUV(rgba, width, cx * 2, cy * vsub, vsub, &u, &v);
+
+			if( format == IMAGE_I420 || format == IMAGE_YV12 )
+			{
+				planeU[cy * (width / 2) + cx] = u;
+				planeV[cy * (width / 2) + cx] = v;
+			}
+			else if( wide )
+			{
+				uint16_t* uv = (uint16_t*)output + width * height + cy * width + cx * 2;
+				uv[0] = u << 8;
+				uv[1] = v << 8;
+			}
+			else
+			{
+				uint8_t* uv = (uint8_t*)output + width * height + cy * width + cx * 2;
+				uv[0] = u;
+				uv[1] = v;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// ReadCounter
+int64_t videoTestSource::ReadCounter( const void* image, imageFormat format, uint32_t width, uint32_t height )
+{
+	const uint32_t cell = counterCellSize(width, height);
+
+	if( !image || cell == 0 )
+		return -1;
+
+	if( imageFormatBaseType(format) != IMAGE_UINT8 || imageFormatIsBayer(format) || format == IMAGE_P010 || format == IMAGE_P016 )
+	{
+		LogError(LOG_VIDEO "videoTestSource::ReadCounter() -- unsupported image format (%s)\n", imageFormatToStr(format));
+		return -1;
+	}
+
+	const uint8_t* img = (const uint8_t*)image;
+	const uint32_t y = cell / 2;
+
+	uint64_t counter = 0;
+
+	for( uint32_t c=0; c < COUNTER_CELLS; c++ )
+	{
+		const uint32_t x = c * cell + cell / 2;
+		uint32_t luma = 0;
+
+		if( imageFormatIsRGB(format) || imageFormatIsGray(format) )
+		{
+			const uint32_t channels = imageFormatChannels(format);
+			const uint8_t* px = img + (y * width + x) * channels;
+
+			for( uint32_t i=0; i < channels && i < 3; i++ )
+				luma += px[i];
+
+			luma /= (channels < 3) ? channels : 3;
+		}
+		else if( format == IMAGE_YUYV || format == IMAGE_YVYU )
+		{
+			luma = img[(y * width + x) * 2];
+		}
+		else if( format == IMAGE_UYVY )
+		{
+			luma = img[(y * width + x) * 2 + 1];
+		}
+		else
+		{
+			luma = img[y * width + x];	// planar luma
+		}
+
+		const bool white = (luma >= 128);
+
+		if( (c == 0 && !white) || (c == 1 && white) )
+			return -1;	// missing start/guard cells
+
+		if( c >= 2 )
+			counter = (counter << 1) | (white ? 1 : 0);
+	}
+
+	return counter;
+}
+
+
+// PatternToStr
+const char* videoTestSource::PatternToStr( Pattern pattern )
+{
+	switch(pattern)
+	{
+		case PATTERN_SOLID:		return "solid";
+		case PATTERN_GRADIENT:	return "gradient";
+		case PATTERN_BOX:		return "box";
+		case PATTERN_NOISE:		return "noise";
+	}
+
+	return "unknown";
+}
+
+
+// PatternFromStr
+videoTestSource::Pattern videoTestSource::PatternFromStr( const char* str )
+{
+	if( !str )
+		return PATTERN_GRADIENT;
+
+	for( int n=0; n <= PATTERN_NOISE; n++ )
+	{
+		const Pattern value = (Pattern)n;
+
+		if( strcasecmp(str, PatternToStr(value)) == 0 )
+			return value;
+	}
+
+	return PATTERN_GRADIENT;
+}
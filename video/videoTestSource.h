@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VIDEO_TEST_SOURCE_H_
+#define __VIDEO_TEST_SOURCE_H_
+
+
+#include "videoSource.h"
+#include "timespec.h"
+
+#include <vector>
+
+
+/**
+ * Synthetic video source that generates test patterns at a configurable
+ * resolution, format, and framerate, without requiring a camera or file.
+ * It's intended for benchmarking and testing pipelines (including on
+ * machines without a GPU, where the frames are kept in host memory).
+ *
+ * The resource URI takes the form `test://<pattern>?<key>=<value>&...`
+ * where the pattern is one of the following:
+ *
+ *    - `solid`    (a solid color, set with `color=RRGGBB`)
+ *    - `gradient` (a scrolling color gradient, the default)
+ *    - `box`      (a box bouncing over a dark background)
+ *    - `noise`    (random pixels, which are the worst-case for encoders)
+ *
+ * The optional keys in the URI are:
+ *
+ *    - `format=FORMAT` the raw imageFormat that gets returned when
+ *                      Capture() is called with IMAGE_UNKNOWN (rgb8 by default)
+ *    - `color=RRGGBB`  the hex color of the solid pattern or box (white by default)
+ *    - `counter=0|1`   stamp the frame number as a barcode in the top-left
+ *                      corner of each frame (enabled by default)
+ *    - `free=0|1`      generate frames as fast as possible instead of
+ *                      at the framerate (disabled by default)
+ *
+ * The resolution and framerate come from videoOptions (`--input-width`,
+ * `--input-height`, `--input-rate`), and default to 1280x720 at 30 FPS.
+ * Capture() supports the RGB/BGR, grayscale, and YUV formats (including
+ * NV12, I420/YV12, and YUYV/YVYU/UYVY) at any of their bit depths.
+ *
+ * When running at a fixed framerate, frames are produced on a schedule
+ * like a camera would - if Capture() isn't called fast enough to keep up,
+ * the frames that were missed are skipped over and counted by
+ * GetDroppedFrames(), and show up as gaps in the embedded frame counter.
+ * The timestamp of each frame (GetLastTimestamp()) is taken from the
+ * realtime clock when it was generated, so latency can be measured by
+ * comparing it against the current time after the frame is processed.
+ *
+ * @note videoTestSource implements the videoSource interface and is intended
+ * to be used through that as opposed to directly.  videoSource implements
+ * additional command-line parsing of videoOptions to construct instances.
+ *
+ * @see videoSource
+ * @ingroup video
+ */
+class videoTestSource : public videoSource
+{
+public:
+	/**
+	 * Test patterns that can be generated.
+	 */
+	enum Pattern
+	{
+		PATTERN_SOLID = 0,	/**< Solid color */
+		PATTERN_GRADIENT,	/**< Scrolling color gradient */
+		PATTERN_BOX,		/**< Bouncing box */
+		PATTERN_NOISE		/**< Random noise */
+	};
+
+	/**
+	 * Create a videoTestSource instance from the provided video options.
+	 */
+	static videoTestSource* Create( const videoOptions& options );
+
+	/**
+	 * Create a videoTestSource instance from a test:// URI and optional videoOptions.
+	 */
+	static videoTestSource* Create( const char* resource, const videoOptions& options=videoOptions() );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~videoTestSource();
+
+	/**
+	 * Generate the next frame.
+	 * @see videoSource::Capture()
+	 */
+	virtual bool Capture( void** image, imageFormat format, uint64_t timeout=DEFAULT_TIMEOUT, int* status=NULL, cudaStream_t stream=0 );
+
+	/**
+	 * Open the stream (this resets the frame schedule).
+	 * @see videoSource::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * Close the stream.
+	 * @see videoSource::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * Return the test pattern being generated.
+	 */
+	inline Pattern GetPattern() const			{ return mPattern; }
+
+	/**
+	 * Return true if frames are generated as fast as possible.
+	 */
+	inline bool IsFreeRunning() const			{ return mFreeRun; }
+
+	/**
+	 * Return the number of frames that were skipped because Capture()
+	 * wasn't called in time (this is always zero when free-running).
+	 */
+	inline uint64_t GetDroppedFrames() const		{ return mDroppedFrames; }
+
+	/**
+	 * Read the frame number back from the barcode that gets stamped on the
+	 * frames (this works on any image that was derived from a test frame,
+	 * as long as it wasn't resized or cropped).  8-bit RGB/BGR, grayscale,
+	 * and YUV formats are supported.  Returns -1 if the barcode is missing.
+	 */
+	static int64_t ReadCounter( const void* image, imageFormat format, uint32_t width, uint32_t height );
+
+	/**
+	 * Convert a Pattern enum to a string.
+	 */
+	static const char* PatternToStr( Pattern pattern );
+
+	/**
+	 * Parse a Pattern enum from a string (returns PATTERN_GRADIENT if unrecognized).
+	 */
+	static Pattern PatternFromStr( const char* str );
+
+	/**
+	 * Return the interface type (videoTestSource::Type)
+	 */
+	virtual inline uint32_t GetType() const		{ return Type; }
+
+	/**
+	 * Unique type identifier of videoTestSource class.
+	 */
+	static const uint32_t Type = (1 << 6);
+
+protected:
+	videoTestSource( const videoOptions& options );
+
+	bool parseOptions();
+	bool allocBuffers( imageFormat format );
+	void freeBuffers();
+
+	void render( uchar4* rgba, uint64_t frame );
+	bool convert( const uchar4* rgba, void* output, imageFormat format );
+
+	Pattern mPattern;
+	uchar4  mColor;
+	bool    mCounter;
+	bool    mFreeRun;
+	bool    mHostMemory;
+
+	std::vector<void*> mBuffers;
+	std::vector<uchar4> mScratch;
+
+	imageFormat mBufferFormat;
+	uint32_t    mNextBuffer;
+
+	timespec mStartTime;
+	uint64_t mNextFrame;
+	uint64_t mDroppedFrames;
+	uint64_t mFramesGenerated;
+};
+
+#endif